@@ -0,0 +1,270 @@
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/incremental_topological_order.h"
+#include "Paker/dependency/reachability_index.h"
+#include "Paker/dependency/graph_snapshot.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <queue>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <filesystem>
+
+using namespace Paker;
+
+// 性能测试函数
+template<typename Func>
+double measure_time(Func func, const std::string& operation_name) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    double time_ms = duration.count() / 1000.0;
+
+    std::cout << operation_name << " 耗时: " << time_ms << " ms" << std::endl;
+    return time_ms;
+}
+
+// 合成依赖图：节点 i 只依赖编号更大的节点，保证无环；
+// 依赖目标集中在较近的"层"内，模拟大量共享的传递依赖（菱形结构）
+struct SyntheticGraph {
+    std::vector<std::string> names;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+};
+
+SyntheticGraph generate_graph(size_t node_count, size_t avg_degree, uint32_t seed = 42) {
+    SyntheticGraph g;
+    g.names.reserve(node_count);
+    for (size_t i = 0; i < node_count; ++i) {
+        g.names.push_back("pkg-" + std::to_string(i));
+    }
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> degree_dis(0, avg_degree * 2);
+    std::geometric_distribution<size_t> distance_dis(0.01);
+
+    g.edges.reserve(node_count * avg_degree);
+    for (size_t i = 0; i + 1 < node_count; ++i) {
+        size_t degree = degree_dis(gen);
+        for (size_t k = 0; k < degree; ++k) {
+            size_t target = i + 1 + distance_dis(gen);
+            if (target < node_count) {
+                g.edges.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(target));
+            }
+        }
+    }
+    return g;
+}
+
+void benchmark_size(size_t node_count, bool include_legacy) {
+    std::cout << "\n=== " << node_count << " 节点 ===" << std::endl;
+
+    auto synthetic = generate_graph(node_count, 4);
+    std::cout << "边数: " << synthetic.edges.size() << std::endl;
+
+    // CSR 构建与遍历
+    CSRDependencyGraph csr;
+    measure_time([&]() {
+        CSRGraphBuilder builder;
+        builder.reserve(synthetic.names.size(), synthetic.edges.size());
+        for (const auto& name : synthetic.names) {
+            builder.add_node(name);
+        }
+        for (const auto& [from, to] : synthetic.edges) {
+            builder.add_edge(from, to);
+        }
+        csr = builder.build();
+    }, "CSR构建");
+
+    size_t ordered = 0;
+    double csr_topo = measure_time([&]() {
+        ordered = csr.topological_order().size();
+    }, "CSR拓扑排序");
+
+    size_t cycles = 0;
+    measure_time([&]() {
+        cycles = csr.find_cycles().size();
+    }, "CSR环检测");
+
+    size_t reachable = 0;
+    measure_time([&]() {
+        reachable = csr.reachable_from(0).size();
+    }, "CSR可达性(BFS)");
+
+    std::cout << "拓扑序节点: " << ordered << ", 环: " << cycles
+              << ", 根可达节点: " << reachable << std::endl;
+    std::cout << "CSR内存: " << (csr.get_memory_usage() / 1024) << " KB" << std::endl;
+
+    // 增量编辑：逐条插入新边并在线维护拓扑序，对比每次编辑后整图重排
+    IncrementalTopologicalOrder topo;
+    measure_time([&]() {
+        topo.rebuild(csr);
+    }, "在线拓扑序初始化");
+
+    const size_t edit_count = 1000;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint32_t> node_dis(0, static_cast<uint32_t>(node_count - 1));
+    double incremental = measure_time([&]() {
+        for (size_t i = 0; i < edit_count; ++i) {
+            uint32_t a = node_dis(gen), b = node_dis(gen);
+            if (a == b) continue;
+            // 保持节点编号方向，模拟不引入环的依赖新增
+            topo.add_edge(std::min(a, b), std::max(a, b));
+        }
+    }, "增量插入" + std::to_string(edit_count) + "条边");
+
+    std::cout << "单次编辑平均: " << (incremental * 1000.0 / edit_count) << " us (整图重排约 "
+              << (csr_topo * 1000.0) << " us), 累计访问节点: " << topo.get_stats().nodes_visited << std::endl;
+
+    // 可达性索引：一次构建后回答"谁依赖 X"，对比每次查询做反向BFS
+    auto shared_csr = std::make_shared<const CSRDependencyGraph>(std::move(csr));
+    // 位集闭包的内存随分量数平方增长，只在较小规模下额外测试位集模式
+    std::vector<size_t> bitset_limits{ReachabilityIndex::DEFAULT_MAX_BITSET_COMPONENTS};
+    if (node_count <= 20000) {
+        bitset_limits.push_back(node_count);
+    }
+
+    const size_t query_count = 1000;
+    for (size_t limit : bitset_limits) {
+        std::unique_ptr<ReachabilityIndex> index;
+        measure_time([&]() {
+            index = std::make_unique<ReachabilityIndex>(shared_csr, limit);
+        }, "可达性索引构建");
+        std::cout << "索引模式: " << (index->mode() == ReachabilityIndex::Mode::BITSET ? "位集" : "区间标号")
+                  << ", 内存: " << (index->get_memory_usage() / 1024) << " KB" << std::endl;
+
+        size_t index_total = 0;
+        measure_time([&]() {
+            for (size_t i = 0; i < query_count; ++i) {
+                index_total += index->count_transitive_dependents(node_dis(gen));
+            }
+        }, "索引查询" + std::to_string(query_count) + "次传递被依赖计数");
+
+        size_t positive = 0;
+        measure_time([&]() {
+            for (size_t i = 0; i < query_count; ++i) {
+                positive += index->reaches(node_dis(gen), node_dis(gen)) ? 1 : 0;
+            }
+        }, "索引查询" + std::to_string(query_count) + "次可达性");
+        std::cout << "传递被依赖合计: " << index_total << ", 可达对: " << positive << "/" << query_count << std::endl;
+    }
+
+    size_t bfs_total = 0;
+    measure_time([&]() {
+        for (size_t i = 0; i < query_count; ++i) {
+            bfs_total += shared_csr->reachable_to(node_dis(gen)).size();
+        }
+    }, "反向BFS" + std::to_string(query_count) + "次");
+    std::cout << "BFS被依赖合计: " << bfs_total << std::endl;
+
+    if (!include_legacy) {
+        return;
+    }
+
+    // 旧版 map/set 图上的同等遍历（遍历基于字符串比较）
+    DependencyGraph graph;
+    measure_time([&]() {
+        for (const auto& name : synthetic.names) {
+            graph.add_node(DependencyNode(name));
+        }
+        for (const auto& [from, to] : synthetic.edges) {
+            graph.add_dependency(synthetic.names[from], synthetic.names[to]);
+        }
+    }, "DependencyGraph构建");
+
+    measure_time([&]() {
+        graph.freeze();
+    }, "DependencyGraph冻结为CSR");
+
+    double legacy_topo = measure_time([&]() {
+        // 按旧实现的方式：基于字符串的 Kahn 算法
+        std::map<std::string, int> in_degree;
+        for (const auto& [node, deps] : graph.get_adjacency_list()) {
+            in_degree.emplace(node, 0);
+            for (const auto& dep : deps) {
+                in_degree[dep]++;
+            }
+        }
+        std::queue<std::string> q;
+        for (const auto& [node, degree] : in_degree) {
+            if (degree == 0) q.push(node);
+        }
+        size_t count = 0;
+        while (!q.empty()) {
+            auto current = q.front();
+            q.pop();
+            ++count;
+            for (const auto& dep : graph.get_adjacency_list().at(current)) {
+                if (--in_degree[dep] == 0) q.push(dep);
+            }
+        }
+        ordered = count;
+    }, "字符串拓扑排序");
+
+    std::cout << "拓扑排序加速比: " << (legacy_topo / csr_topo) << "x" << std::endl;
+
+    // 持久化：JSON 文本与二进制快照
+    OptimizedDependencyGraph optimized(node_count + 1, node_count + 1);
+    for (const auto& name : synthetic.names) {
+        LightweightDependencyNode node(name, "1.0.0");
+        node.repository = "https://github.com/example/" + name.substr(0, 5) + ".git";
+        optimized.add_node(node);
+    }
+    for (const auto& [from, to] : synthetic.edges) {
+        optimized.add_dependency(synthetic.names[from], synthetic.names[to]);
+    }
+
+    auto dir = std::filesystem::temp_directory_path();
+    std::string json_file = (dir / "paker_graph_benchmark.json").string();
+    std::string snapshot_file = (dir / "paker_graph_benchmark.snapshot").string();
+
+    double json_save = measure_time([&]() { optimized.save_to_file(json_file); }, "JSON保存");
+    double snapshot_save = measure_time([&]() { optimized.save_to_snapshot(snapshot_file); }, "快照保存");
+    std::cout << "文件大小: JSON " << (std::filesystem::file_size(json_file) / 1024) << " KB, 快照 "
+              << (std::filesystem::file_size(snapshot_file) / 1024) << " KB" << std::endl;
+
+    OptimizedDependencyGraph from_json(node_count + 1, node_count + 1);
+    OptimizedDependencyGraph from_snapshot(node_count + 1, node_count + 1);
+    double json_load = measure_time([&]() { from_json.load_from_file(json_file); }, "JSON加载");
+    double snapshot_load = measure_time([&]() { from_snapshot.load_from_snapshot(snapshot_file); }, "快照加载到可变图");
+
+    GraphSnapshot view;
+    measure_time([&]() { view.open(snapshot_file); }, "快照mmap映射(含校验)");
+    measure_time([&]() {
+        GraphSnapshot unchecked;
+        unchecked.open(snapshot_file, false);
+    }, "快照mmap映射(跳过CRC)");
+
+    std::cout << "保存加速比: " << (json_save / snapshot_save) << "x, 加载加速比: "
+              << (json_load / snapshot_load) << "x" << std::endl;
+    std::filesystem::remove(json_file);
+    std::filesystem::remove(snapshot_file);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Paker 依赖图CSR性能测试 ===" << std::endl;
+
+    // 传入 --full 时运行 1M 节点规模
+    bool full = argc > 1 && std::string(argv[1]) == "--full";
+
+    try {
+        benchmark_size(10000, true);
+        benchmark_size(100000, true);
+        if (full) {
+            benchmark_size(1000000, false);
+        }
+
+        std::cout << "\n=== 测试完成 ===" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "测试过程中发生错误: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
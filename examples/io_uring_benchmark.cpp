@@ -0,0 +1,71 @@
+#include "Paker/core/io_uring_engine.h"
+#include "Paker/core/openmp_io.h"
+#include <dirent.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+// 模拟安装后扫描清单与头文件：2 万个 1~8KB 的小文件
+constexpr size_t kFileCount = 20000;
+
+// 当前进程的线程数（含 io_uring 的内核工作线程 iou-wrk）
+size_t thread_count() {
+    size_t count = 0;
+    for (const auto& entry : fs::directory_iterator("/proc/self/task")) {
+        (void)entry;
+        count++;
+    }
+    return count;
+}
+
+template <typename F>
+double measure(F&& run, size_t& peak_threads) {
+    auto start = std::chrono::high_resolution_clock::now();
+    run();
+    auto end = std::chrono::high_resolution_clock::now();
+    peak_threads = thread_count();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "paker_io_uring_benchmark";
+    fs::remove_all(dir);
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < kFileCount; ++i) {
+        fs::path sub = dir / ("pkg" + std::to_string(i / 500));
+        fs::create_directories(sub);
+        std::string path = (sub / ("header_" + std::to_string(i) + ".h")).string();
+        std::ofstream(path) << std::string(1024 + (i * 37) % 7168, 'x');
+        paths.push_back(path);
+    }
+
+    std::cout << "=== Paker 批量小文件读取（" << kFileCount << " 个文件，页缓存已热） ===" << std::endl;
+    std::cout << "io_uring 可用: " << (IoUringEngine::is_supported() ? "是" : "否") << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    OpenMPIOManager manager;
+    for (IOBackend backend : {IOBackend::THREAD_POOL, IOBackend::IO_URING}) {
+        manager.set_io_backend(backend);
+        manager.read_text_files_parallel(paths);  // 预热
+        size_t threads = 0;
+        double ms = measure([&]() { manager.read_text_files_parallel(paths); }, threads);
+        std::cout << std::setw(9) << io_backend_name(backend) << ": " << ms << " ms, 进程线程数 " << threads
+                  << std::endl;
+    }
+
+    if (IoUringEngine* engine = IoUringEngine::for_current_thread()) {
+        const auto& stats = engine->get_stats();
+        std::cout << "io_uring: " << stats.submit_calls << " 次 io_uring_enter, " << stats.sqes_submitted
+                  << " 个 SQE, " << stats.fixed_buffer_reads << " 次注册缓冲区读取" << std::endl;
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "Paker/cache/lru_cache_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+// 模拟并行安装和预热线程：大多数调用是命中查询，少量是加入新版本
+constexpr size_t kPackages = 4096;
+constexpr size_t kOperationsPerThread = 200000;
+
+double run(size_t shard_count, size_t threads, const std::string& directory) {
+    LRUCacheManager cache(directory, 1ULL << 40, kPackages * 4, std::chrono::hours(24 * 30),
+                          CacheEvictionPolicy::LRU, shard_count);
+    for (size_t i = 0; i < kPackages; ++i) {
+        cache.add_item("package-" + std::to_string(i), "1.0.0", directory + "/missing");
+    }
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            uint64_t state = t * 0x9E3779B97F4A7C15ULL + 1;
+            for (size_t i = 0; i < kOperationsPerThread; ++i) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                std::string name = "package-" + std::to_string(state % kPackages);
+                if (i % 64 == 0) {
+                    cache.add_item(name, "2.0." + std::to_string(t), directory + "/missing");
+                } else {
+                    cache.get_item_path(name, "1.0.0");
+                }
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return threads * kOperationsPerThread / seconds / 1e6;
+}
+
+int main() {
+    std::string directory = (fs::temp_directory_path() / "paker_lru_contention").string();
+    fs::create_directories(directory);
+
+    size_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "LRU cache contention benchmark (" << kPackages << " packages, "
+              << kOperationsPerThread << " ops/thread, 1/64 inserts)\n\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(18) << "1 shard (Mops/s)"
+              << std::setw(18) << "16 shards (Mops/s)" << "\n";
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double single = run(1, threads, directory);
+        double sharded = run(16, threads, directory);
+        std::cout << std::left << std::setw(10) << threads << std::setw(18) << std::fixed << std::setprecision(2)
+                  << single << std::setw(18) << sharded << "\n";
+    }
+
+    fs::remove_all(directory);
+    return 0;
+}
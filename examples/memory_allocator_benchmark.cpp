@@ -0,0 +1,164 @@
+#include "Paker/core/slab_allocator.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+
+using namespace Paker;
+
+// 模拟多线程安装负载：
+// - 每个工作线程处理一批包，为每个包分配文件路径、元数据等小对象（16B ~ 2KB）
+// - 解压缓冲区（8KB）由工作线程分配，交给写盘线程使用后释放，产生跨线程释放
+struct Allocator {
+    const char* name;
+    void* (*allocate)(size_t);
+    void (*deallocate)(void*);
+};
+
+void* malloc_allocate(size_t size) { return std::malloc(size); }
+void malloc_deallocate(void* ptr) { std::free(ptr); }
+void* slab_allocate(size_t size) { return SlabAllocator::instance().allocate(size); }
+void slab_deallocate(void* ptr) { SlabAllocator::instance().deallocate(ptr); }
+
+// 跨线程传递缓冲区的队列
+class BufferQueue {
+public:
+    void push(void* ptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.push_back(ptr);
+        cv_.notify_one();
+    }
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        cv_.notify_all();
+    }
+    bool pop(void*& ptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        ptr = items_.front();
+        items_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<void*> items_;
+    bool closed_ = false;
+};
+
+double run_install_workload(const Allocator& allocator, size_t threads, size_t packages_per_thread,
+                            size_t files_per_package) {
+    BufferQueue queue;
+    std::thread writer([&]() {
+        void* buffer;
+        while (queue.pop(buffer)) {
+            allocator.deallocate(buffer);
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(static_cast<uint32_t>(t + 1));
+            std::uniform_int_distribution<size_t> small_size(16, 256);
+            std::uniform_int_distribution<size_t> medium_size(256, 2048);
+            std::vector<void*> live;
+            for (size_t p = 0; p < packages_per_thread; ++p) {
+                for (size_t f = 0; f < files_per_package; ++f) {
+                    void* path = allocator.allocate(small_size(rng));
+                    std::memset(path, 'p', 16);
+                    live.push_back(path);
+                    if (f % 8 == 0) {
+                        live.push_back(allocator.allocate(medium_size(rng)));
+                    }
+                }
+                void* buffer = allocator.allocate(8 * 1024);
+                std::memset(buffer, 0, 64);
+                queue.push(buffer);
+
+                // 包处理完成，释放临时对象
+                for (void* ptr : live) {
+                    allocator.deallocate(ptr);
+                }
+                live.clear();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    queue.close();
+    writer.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double run_pmr_workload(std::pmr::memory_resource* resource, size_t threads, size_t iterations) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([resource, iterations]() {
+            for (size_t i = 0; i < iterations; ++i) {
+                std::pmr::vector<std::pmr::string> files(resource);
+                for (size_t f = 0; f < 64; ++f) {
+                    files.emplace_back("include/package/detail/header_file_" + std::to_string(f) + ".hpp");
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "=== Paker 分配器性能测试 ===" << std::endl;
+
+    const Allocator allocators[] = {
+        {"glibc malloc", malloc_allocate, malloc_deallocate},
+        {"SlabAllocator", slab_allocate, slab_deallocate},
+    };
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\n--- 安装负载（每线程 2000 个包，每包 64 个文件） ---" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << threads << " 线程:";
+        for (const auto& allocator : allocators) {
+            double ms = run_install_workload(allocator, threads, 2000, 64);
+            std::cout << "  " << allocator.name << " " << std::fixed << std::setprecision(1) << ms << " ms";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "\n--- pmr 容器（vector<string>，每线程 5000 轮） ---" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double heap_ms = run_pmr_workload(std::pmr::new_delete_resource(), threads, 5000);
+        double slab_ms = run_pmr_workload(get_slab_memory_resource(), threads, 5000);
+        std::cout << threads << " 线程:  new_delete_resource " << std::fixed << std::setprecision(1)
+                  << heap_ms << " ms  SlabMemoryResource " << slab_ms << " ms" << std::endl;
+    }
+
+    auto stats = SlabAllocator::instance().get_statistics();
+    std::cout << "\nslab 统计: 分配 " << stats.allocation_count << " 次，跨线程释放 "
+              << stats.remote_free_count << " 次，使用中 slab " << stats.slabs_in_use
+              << "，缓存 slab " << stats.slabs_cached << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "Paker/cache/prefetch_model.h"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+// 模拟 CI：5 类项目轮流构建，每个作业按固定顺序安装该类项目的依赖，
+// 约 20% 的作业额外安装一个临时包，项目之间共享一部分基础库
+std::vector<PrefetchEvent> synthesize_ci_trace(int jobs) {
+    const std::vector<std::vector<std::string>> projects = {
+        {"fmt", "spdlog", "gtest", "benchmark"},
+        {"zlib", "openssl", "curl", "nlohmann-json"},
+        {"boost", "eigen", "fmt", "catch2"},
+        {"protobuf", "grpc", "abseil", "zlib", "openssl"},
+        {"opencv", "eigen", "tbb", "gtest"},
+    };
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<PrefetchEvent> events;
+    int64_t clock = 0;
+    for (int job = 0; job < jobs; ++job) {
+        // 项目顺序大体固定，偶尔跳过一个
+        size_t project = (job + (percent(rng) < 10 ? 1 : 0)) % projects.size();
+        std::string session = "ci-job-" + std::to_string(job);
+        for (const auto& package : projects[project]) {
+            events.push_back(PrefetchEvent{clock += 1000, session, package, 512 * 1024 + package.size() * 65536});
+        }
+        if (percent(rng) < 20) {
+            events.push_back(PrefetchEvent{clock += 1000, session, "tmp-" + std::to_string(job), 4 * 1024 * 1024});
+        }
+    }
+    return events;
+}
+
+int main(int argc, char** argv) {
+    std::vector<PrefetchEvent> events;
+    std::string source;
+    if (argc > 1) {
+        // 参数为记录所在目录，例如 ~/.paker/cache/prefetch
+        PrefetchTrace(argv[1]).read(events);
+        source = std::string(argv[1]) + "/trace-*.log";
+    }
+    if (events.empty()) {
+        events = synthesize_ci_trace(500);
+        source = "synthetic CI workload";
+    }
+    std::cout << "Replaying " << events.size() << " requests from " << source << std::endl;
+
+    std::cout << std::left << std::setw(12) << "threshold" << std::setw(12) << "prefetched" << std::setw(12)
+              << "precision" << std::setw(12) << "recall" << std::setw(16) << "wasted (MB)" << std::endl;
+    for (double threshold : {0.2, 0.3, 0.5, 0.7, 0.9}) {
+        PrefetchOptions options;
+        options.min_confidence = threshold;
+        PrefetchReplayResult result = PrefetchModel::replay(events, options);
+        std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(12) << threshold
+                  << std::setw(12) << result.prefetched << std::setw(12) << result.precision() << std::setw(12)
+                  << result.recall() << std::setw(16) << result.wasted_bytes / (1024.0 * 1024.0) << std::endl;
+    }
+
+    fs::path model_path = fs::temp_directory_path() / "paker_prefetch_replay_model.bin";
+    PrefetchModel model;
+    model.train(events);
+    if (model.save(model_path.string())) {
+        std::cout << "Model: " << model.package_count() << " packages, " << model.edge_count() << " edges, "
+                  << fs::file_size(model_path) << " bytes on disk" << std::endl;
+        fs::remove(model_path);
+    }
+    return 0;
+}
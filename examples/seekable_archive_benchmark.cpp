@@ -0,0 +1,80 @@
+#include "Paker/cache/seekable_archive.h"
+#include <zlib.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+// 模拟一个中等规模的头文件库：3000 个头文件，约 12MB
+constexpr int kHeaderCount = 3000;
+
+template <typename F>
+double measure(F&& run) {
+    auto start = std::chrono::high_resolution_clock::now();
+    run();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "paker_seekable_archive_benchmark";
+    fs::remove_all(dir);
+    fs::path source = dir / "boost" / "source";
+    std::string whole;
+    for (int i = 0; i < kHeaderCount; ++i) {
+        fs::path path = source / ("module_" + std::to_string(i / 100)) / ("header_" + std::to_string(i) + ".hpp");
+        fs::create_directories(path.parent_path());
+        std::string content;
+        for (int line = 0; line < 100; ++line) {
+            content += "template <typename T> struct trait_" + std::to_string(i) + "_" + std::to_string(line) +
+                       " { static constexpr int value = " + std::to_string(i * line % 97) + "; };\n";
+        }
+        std::ofstream(path) << content;
+        whole += content;
+    }
+
+    std::cout << "=== 从压缩包中读取单个头文件（" << kHeaderCount << " 个文件，" << whole.size() / 1024 / 1024
+              << " MB） ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    // 旧方式：整包 zlib，读取任何文件都要先解压全部内容
+    uLongf bound = compressBound(whole.size());
+    std::string packed(bound, '\0');
+    compress2(reinterpret_cast<Bytef*>(&packed[0]), &bound, reinterpret_cast<const Bytef*>(whole.data()),
+              whole.size(), Z_DEFAULT_COMPRESSION);
+    packed.resize(bound);
+    double whole_ms = measure([&]() {
+        std::string out(whole.size(), '\0');
+        uLongf length = out.size();
+        uncompress(reinterpret_cast<Bytef*>(&out[0]), &length, reinterpret_cast<const Bytef*>(packed.data()),
+                   packed.size());
+    });
+    std::cout << "整包 zlib:     " << packed.size() / 1024 << " KB, 读取一个文件 " << whole_ms << " ms" << std::endl;
+
+    // 分帧归档：只解压覆盖目标文件的一帧
+    std::string archive = (dir / "boost" / "1.84.0.pkar").string();
+    ArchiveWriteOptions options;
+    ArchiveWriteStats stats;
+    double create_ms = measure([&]() { SeekableArchiveWriter::create(source.string(), archive, options, &stats); });
+
+    SeekableArchiveReader reader;
+    reader.open(archive);
+    std::string content;
+    double read_ms = measure([&]() { reader.read_file("module_17/header_1742.hpp", content); });
+    std::cout << "分帧归档 (" << (reader.codec() == ArchiveCodec::ZSTD ? "zstd" : "zlib") << "): "
+              << stats.archive_bytes / 1024 << " KB, 读取一个文件 " << read_ms << " ms, 解压 "
+              << reader.frames_decompressed() << "/" << stats.frames << " 帧, 创建耗时 " << create_ms << " ms"
+              << std::endl;
+
+    double extract_ms = measure([&]() { reader.extract_all((dir / "extracted").string()); });
+    std::cout << "分帧归档全量并行解压: " << extract_ms << " ms" << std::endl;
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "Paker/core/string_interner.h"
+#include <malloc.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Paker;
+
+// 模拟 LRU 缓存索引：2000 个包，每个包 50 个版本，共 10 万项
+// 每项保存键、包名、版本、路径，并同时出现在 LRU 链表与两个哈希表中
+constexpr size_t kPackages = 2000;
+constexpr size_t kVersionsPerPackage = 50;
+
+struct StringItem {
+    std::string key;
+    std::string package_name;
+    std::string version;
+    std::string cache_path;
+    size_t size_bytes = 0;
+};
+
+struct SymbolItem {
+    Symbol key;
+    Symbol package_name;
+    Symbol version;
+    Symbol cache_path;
+    size_t size_bytes = 0;
+};
+
+std::string package_name(size_t p) { return "org-example-package-" + std::to_string(p); }
+std::string version(size_t v) { return std::to_string(v / 10) + "." + std::to_string(v % 10) + ".0"; }
+std::string cache_path(const std::string& name, const std::string& ver) {
+    return "/home/user/.paker/cache/packages/" + name + "/" + ver;
+}
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+template <typename Item, typename Key, typename MakeKey>
+double build_index(std::unordered_map<Key, Item>& items, std::list<Key>& lru,
+                   std::unordered_map<Key, typename std::list<Key>::iterator>& lru_map, MakeKey make_key) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t p = 0; p < kPackages; ++p) {
+        for (size_t v = 0; v < kVersionsPerPackage; ++v) {
+            std::string name = package_name(p);
+            std::string ver = version(v);
+            Key key = make_key(name + ":" + ver);
+            Item item;
+            item.key = key;
+            item.package_name = make_key(name);
+            item.version = make_key(ver);
+            item.cache_path = make_key(cache_path(name, ver));
+            items.emplace(key, std::move(item));
+            lru.push_front(key);
+            lru_map.emplace(key, lru.begin());
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template <typename Key, typename Item, typename MakeKey>
+double lookup_all(const std::unordered_map<Key, Item>& items, MakeKey make_key) {
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t found = 0;
+    for (size_t round = 0; round < 5; ++round) {
+        for (size_t p = 0; p < kPackages; ++p) {
+            for (size_t v = 0; v < kVersionsPerPackage; v += 5) {
+                found += items.count(make_key(package_name(p) + ":" + version(v)));
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    if (found == 0) std::cout << "";
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "=== Paker 字符串驻留内存测试（" << kPackages * kVersionsPerPackage << " 个缓存项） ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    {
+        size_t before = heap_in_use();
+        std::unordered_map<std::string, StringItem> items;
+        std::list<std::string> lru;
+        std::unordered_map<std::string, std::list<std::string>::iterator> lru_map;
+        double build_ms = build_index(items, lru, lru_map, [](std::string s) { return s; });
+        size_t used = heap_in_use() - before;
+        double lookup_ms = lookup_all(items, [](std::string s) { return s; });
+        std::cout << "std::string: " << used / 1024.0 / 1024.0 << " MB, 构建 " << build_ms
+                  << " ms, 查找 " << lookup_ms << " ms" << std::endl;
+    }
+
+    {
+        size_t before = heap_in_use();
+        std::unordered_map<Symbol, SymbolItem> items;
+        std::list<Symbol> lru;
+        std::unordered_map<Symbol, std::list<Symbol>::iterator> lru_map;
+        double build_ms = build_index(items, lru, lru_map, [](const std::string& s) { return Symbol(s); });
+        size_t used = heap_in_use() - before;
+        // 查询路径只查找已驻留的键
+        double lookup_ms = lookup_all(items, [](const std::string& s) {
+            return StringInterner::instance().find(s).value_or(Symbol());
+        });
+        auto stats = StringInterner::instance().get_statistics();
+        std::cout << "Symbol:      " << used / 1024.0 / 1024.0 << " MB（其中驻留表 "
+                  << (stats.arena_bytes + stats.table_bytes) / 1024.0 / 1024.0 << " MB，"
+                  << stats.symbol_count << " 个字符串）, 构建 " << build_ms << " ms, 查找 " << lookup_ms
+                  << " ms" << std::endl;
+    }
+    return 0;
+}
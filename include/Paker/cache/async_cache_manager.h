@@ -9,6 +9,7 @@
 #include <atomic>
 #include "Paker/core/async_io.h"
 #include "Paker/cache/cache_manager.h"
+#include "Paker/cache/cache_write_combiner.h"
 
 namespace Paker {
 
@@ -62,6 +63,10 @@ private:
     // 缓存目录和路径管理
     std::string cache_directory_;
     
+    // 小文件写合并
+    WriteCombinerConfig write_combiner_config_;
+    std::unique_ptr<CacheWriteCombiner> write_combiner_;
+    
     // 统计信息
     std::atomic<size_t> total_read_operations_{0};
     std::atomic<size_t> total_write_operations_{0};
@@ -96,6 +101,14 @@ public:
     std::vector<std::future<std::shared_ptr<AsyncCacheWriteResult>>> write_multiple_cache_async(
         const std::vector<std::pair<std::string, std::string>>& cache_data);
     
+#if defined(PAKER_HAVE_COROUTINES)
+    // 协程版本：读写交给 I/O 工作线程，完成后恢复调用者，不为每个操作占用一个线程
+    task<std::shared_ptr<AsyncCacheReadResult>> read_cache_task(std::string cache_key, bool read_as_text = true);
+    task<std::shared_ptr<AsyncCacheWriteResult>> write_cache_task(std::string cache_key, std::string content);
+    task<std::vector<std::shared_ptr<AsyncCacheReadResult>>> read_multiple_cache_task(
+        std::vector<std::string> cache_keys, bool read_as_text = true);
+#endif
+    
     // 异步缓存清理
     std::future<bool> clear_cache_async();
     std::future<bool> remove_cache_async(const std::string& cache_key);
@@ -123,11 +136,25 @@ public:
     // 缓存管理器访问
     CacheManager* get_cache_manager() const { return cache_manager_.get(); }
     
+    // 缓存文件的根目录
+    void set_cache_directory(const std::string& directory) { cache_directory_ = directory; }
+    const std::string& get_cache_directory() const { return cache_directory_; }
+    
+    // 写合并：不超过 max_entry_size 的写入在 max_delay 窗口内攒批，整批落盘后一次刷盘
+    void set_write_combiner_config(const WriteCombinerConfig& config);
+    WriteCombinerConfig get_write_combiner_config() const { return write_combiner_config_; }
+    WriteCombinerStats get_write_combiner_stats() const;
+    // 等待已提交的合并写入全部落盘
+    void flush_pending_writes();
+    
 private:
     // 内部方法
     std::string get_cache_path(const std::string& cache_key) const;
     void update_read_stats(const std::chrono::milliseconds& duration, bool hit);
     void update_write_stats(const std::chrono::milliseconds& duration);
+    // 交给写合并器，落盘后兑现 future
+    std::future<std::shared_ptr<AsyncCacheWriteResult>> combine_cache_write(
+        const std::string& cache_key, std::string content);
 };
 
 // 异步缓存工具类
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Paker {
+
+// 版本树中一个文件对应的 blob
+struct BlobManifestEntry {
+    std::string path;   // 相对版本目录的路径
+    std::string blob;   // 内容 SHA-256，可执行文件追加 "-x"
+    size_t size = 0;
+};
+
+// 内容存储统计
+struct BlobStoreStats {
+    size_t manifests = 0;         // 已纳入存储的版本数
+    size_t blobs = 0;             // 不同内容的文件数
+    size_t stored_bytes = 0;      // 磁盘上实际占用（每个 blob 一份）
+    size_t tree_bytes = 0;        // 其中被版本树引用的部分，不含只由快照等外部引用保留的 blob
+    size_t logical_bytes = 0;     // 所有版本树文件大小之和
+    size_t unreferenced_blobs = 0;
+
+    size_t deduplicated_bytes() const { return logical_bytes > stored_bytes ? logical_bytes - stored_bytes : 0; }
+};
+
+// 单次纳入的结果
+struct BlobIngestResult {
+    bool success = false;
+    size_t files = 0;
+    size_t new_blobs = 0;         // 首次出现、直接成为 blob 的文件
+    size_t deduplicated = 0;      // 内容已存在、替换为指向 blob 链接的文件
+    size_t unlinked = 0;          // 无法链接或克隆、保留原样的文件
+    size_t bytes_reclaimed = 0;
+};
+
+// 全局包缓存的内容寻址存储
+// 布局：<root>/blobs/ab/cdef... 每种内容只存一份；<root>/manifests/<包>/<版本>.json 记录版本树文件与 blob 的对应。
+// 版本目录仍是完整的目录树，其中的文件是 blob 的硬链接（跨设备或链接数满时退回 reflink），
+// 因此按路径访问缓存的代码无需改动。开启 set_read_only_blobs 时 blob 去掉写权限，
+// 防止通过某个版本改写共享内容；默认保留原权限，已有用户的缓存目录不会突然变成只读。
+// 引用计数在首次使用时由全部清单重建，不单独落盘，清单即唯一事实来源。
+// 快照等版本树以外的使用方通过 <root>/refs/ 下的引用清单登记所用的 blob，同样计入引用计数。
+// 多个进程共用同一存储：登记引用时持有 <root>/gc.lock 的共享锁，回收时持有独占锁并重新读取
+// 全部清单，其他进程在本实例加载之后登记的引用不会被漏算。
+class BlobStore {
+public:
+    explicit BlobStore(const std::string& root);
+
+    const std::string& get_root() const { return root_; }
+
+    // 纳入版本树时是否去掉文件写权限（硬链接共享权限位，版本目录里的文件随之只读）
+    void set_read_only_blobs(bool enable) { read_only_blobs_ = enable; }
+
+    // 流式计算文件内容的 SHA-256（十六进制），失败返回空串；同 core/content_hash.h 的 sha256_file
+    static std::string hash_file(const std::string& path);
+    // 内存数据的 SHA-256（十六进制）
+    static std::string hash_data(const std::string& data);
+
+    // 把已下载的版本目录纳入存储：逐个文件计算哈希，已有内容替换为链接，新内容登记为 blob。
+    // 重复纳入同一版本时先释放旧清单。
+    BlobIngestResult ingest_tree(const std::string& package, const std::string& version,
+                                 const std::string& tree_path);
+
+    // 删除版本清单并递减其引用的 blob 计数；版本目录本身由调用方删除。
+    // 与 ingest_tree 一样持有存储级共享锁，不会与其他进程的回收交错
+    bool release_tree(const std::string& package, const std::string& version);
+
+    // 把文件复制为 blob，源文件保持原样（适合会被原地改写的工程文件）；blob 已存在时不复制
+    bool store_copy(const std::string& source, const std::string& blob, bool& created);
+
+    // 以 owner（如快照清单的绝对路径）登记引用的 blob，重复登记时替换旧引用
+    bool retain(const std::string& owner, const std::vector<BlobManifestEntry>& entries);
+    // 撤销 owner 的全部引用；blob 本身由 collect_garbage 删除
+    bool release(const std::string& owner);
+    // 当前登记了引用的 owner
+    std::vector<std::string> list_owners() const;
+
+    bool has_manifest(const std::string& package, const std::string& version) const;
+    std::vector<BlobManifestEntry> load_manifest(const std::string& package, const std::string& version) const;
+
+    // 删除引用计数为 0 且没有其他硬链接的 blob，返回释放的字节数。
+    // 持有存储级独占锁并按磁盘上的清单重建引用计数后才删除。
+    // full_scan 时还会遍历 blobs 目录清理崩溃遗留的孤立 blob。
+    size_t collect_garbage(bool full_scan = false);
+
+    // 只被该版本引用的字节数，即删除该版本并回收后能释放的空间
+    size_t exclusive_bytes(const std::string& package, const std::string& version) const;
+
+    size_t get_refcount(const std::string& blob) const;
+    std::string blob_path(const std::string& blob) const;
+    BlobStoreStats get_stats() const;
+
+private:
+    struct BlobInfo {
+        size_t refs = 0;
+        size_t tree_refs = 0;     // refs 中来自版本清单的部分
+        size_t size = 0;
+    };
+
+    std::string manifest_path(const std::string& package, const std::string& version) const;
+    std::string refs_path(const std::string& owner) const;
+    std::vector<BlobManifestEntry> load_refs(const std::string& path, std::string* owner = nullptr) const;
+    bool write_manifest(const std::string& package, const std::string& version,
+                        const std::vector<BlobManifestEntry>& entries) const;
+    void ensure_loaded() const;
+    void reload() const;
+    std::string lock_path() const;
+    // from_tree 区分版本清单与 refs/ 下的外部引用
+    void add_refs(const std::vector<BlobManifestEntry>& entries, bool from_tree) const;
+    void drop_refs(const std::vector<BlobManifestEntry>& entries, bool from_tree) const;
+    bool remove_blob_if_unreferenced(const std::string& blob, size_t& freed) const;
+
+    std::string root_;
+    bool read_only_blobs_;
+    mutable std::mutex mutex_;
+    mutable bool loaded_;
+    mutable size_t manifest_count_;
+    mutable std::unordered_map<std::string, BlobInfo> blobs_;
+    mutable std::unordered_set<std::string> zero_ref_;   // 计数降为 0、等待回收的 blob
+};
+
+} // namespace Paker
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace Paker {
+
+// 基于 flock 的跨进程文件锁；进程退出或崩溃时由内核自动释放
+class FileLock {
+public:
+    enum class Mode {
+        SHARED,
+        EXCLUSIVE
+    };
+
+    FileLock() = default;
+    ~FileLock();
+    FileLock(FileLock&& other) noexcept;
+    FileLock& operator=(FileLock&& other) noexcept;
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    // 阻塞直到获得锁，锁文件不存在时创建
+    bool lock(const std::string& path, Mode mode = Mode::EXCLUSIVE);
+    // 不等待，锁被其他进程持有时返回 false
+    bool try_lock(const std::string& path, Mode mode = Mode::EXCLUSIVE);
+    void unlock();
+    bool is_locked() const { return fd_ >= 0; }
+
+private:
+    bool acquire(const std::string& path, Mode mode, bool wait);
+
+    int fd_ = -1;
+};
+
+// 单飞安装锁：同一包版本同时只有一个进程安装，后来的进程等待它结束后复用结果
+class InstallLock {
+public:
+    // 锁文件为 cache_path + ".lock"，与版本目录放在一起，各缓存根目录互不干扰
+    explicit InstallLock(const std::string& cache_path);
+
+    // 获得锁；已有进程在安装时阻塞等待，此时 waited() 为 true
+    bool acquire();
+    // 获得锁之前是否等待过其他进程，等待者应先检查对方的安装结果
+    bool waited() const { return waited_; }
+    void release() { lock_.unlock(); }
+
+    static std::string lock_path(const std::string& cache_path) { return cache_path + ".lock"; }
+
+private:
+    std::string path_;
+    FileLock lock_;
+    bool waited_ = false;
+};
+
+// 多进程共享的索引文件，文档带单调递增的代数。
+// 读者直接读取原子改名后的完整快照，从不加锁；写者在锁外基于读到的快照生成新文档，
+// 只在提交那一刻短暂持有 path + ".lock"，代数未变才改名替换，否则重新读取再生成。
+// 不带代数的旧格式文件按第 0 代读取。
+class SharedIndexFile {
+public:
+    explicit SharedIndexFile(const std::string& path);
+
+    // 读取当前快照，文件不存在时得到空对象和第 0 代
+    bool read(nlohmann::json& data, uint64_t& generation) const;
+    // 自上次 read/commit 以来文件是否被其他写者替换（只做一次 stat）
+    bool changed() const;
+    // 乐观提交：rebase 在最新快照上应用本进程的修改；committed 返回实际写入的文档
+    bool commit(const std::function<void(nlohmann::json&)>& rebase, nlohmann::json* committed = nullptr);
+
+    const std::string& get_path() const { return path_; }
+    uint64_t get_generation() const;
+    // 因其他写者抢先提交而重做的次数
+    uint64_t get_conflicts() const;
+
+private:
+    bool read_locked(nlohmann::json& data, uint64_t& generation) const;
+    void remember_identity() const;
+
+    std::string path_;
+    mutable std::mutex mutex_;
+    mutable uint64_t generation_ = 0;
+    mutable uint64_t identity_inode_ = 0;
+    mutable int64_t identity_mtime_ns_ = -1;
+    uint64_t conflicts_ = 0;
+};
+
+} // namespace Paker
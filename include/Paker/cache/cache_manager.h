@@ -2,9 +2,15 @@
 
 #include "Paker/common.h"
 #include "Paker/core/memory_pool.h"
+#include "Paker/cache/blob_store.h"
+#include "Paker/cache/generation_manager.h"
+#include "Paker/cache/seekable_archive.h"
 
 namespace Paker {
 
+class RemoteCache;
+class SharedIndexFile;
+
 // 缓存策略
 enum class CacheStrategy {
     GLOBAL_ONLY,      // 仅全局缓存
@@ -42,10 +48,11 @@ struct CacheStats {
     size_t total_size_bytes;
     size_t duplicate_packages;
     size_t unused_packages;
+    size_t deduplicated_bytes;   // 内容存储中多个版本共享而省下的字节数
     std::chrono::system_clock::time_point last_cleanup;
     
     CacheStats() : total_packages(0), total_size_bytes(0), 
-                   duplicate_packages(0), unused_packages(0) {}
+                   duplicate_packages(0), unused_packages(0), deduplicated_bytes(0) {}
 };
 
 // 全局缓存管理器
@@ -59,6 +66,9 @@ private:
     
     // 缓存索引
     std::map<std::string, std::map<std::string, PackageCacheInfo>> package_index_;
+    // 多个 paker 进程共享的索引文件；index_base_ 是上次与磁盘同步时的内容，保存时只提交相对它的修改
+    std::unique_ptr<SharedIndexFile> index_file_;
+    std::map<std::string, std::map<std::string, PackageCacheInfo>> index_base_;
     
     // 配置
     size_t max_cache_size_;
@@ -70,6 +80,18 @@ private:
     bool compression_enabled_;
     bool preallocation_enabled_;
     
+    // 内容寻址存储，位于缓存根目录下的 .store
+    std::unique_ptr<BlobStore> blob_store_;
+    bool content_store_enabled_;
+    bool read_only_store_;          // 配置项 read_only_store：纳入存储的文件去掉写权限
+    
+    // 已打开的压缩归档（COMPRESSED 存储），按归档路径缓存索引
+    std::map<std::string, std::unique_ptr<SeekableArchiveReader>> open_archives_;
+    
+    // 跨机器共享的远程缓存层（配置项 remote_cache 或环境变量 PAKER_REMOTE_CACHE）
+    std::string remote_cache_location_;
+    std::unique_ptr<RemoteCache> remote_cache_;
+    
     // 状态管理
     bool initialized_;
     
@@ -101,13 +123,22 @@ public:
     bool is_package_cached(const std::string& package, const std::string& version = "") const;
     std::string get_cached_package_path(const std::string& package, const std::string& version = "") const;
     bool remove_package_from_cache(const std::string& package, const std::string& version = "");
+    // 读取缓存版本中的单个文件；压缩存储时只解压覆盖该文件的帧
+    bool read_cached_file(const std::string& package, const std::string& version,
+                          const std::string& relative_path, std::string& content);
     
     // 项目链接管理
     bool create_project_link(const std::string& package, const std::string& version, 
                            const std::string& project_path);
     bool remove_project_link(const std::string& package, const std::string& project_path);
+    // 批处理期间尚未提交的链接返回其目标目录
     std::string get_project_package_path(const std::string& package, const std::string& project_path) const;
     
+    // 合并一次命令内的链接变更：begin 与 end 之间对该工程的 create/remove_project_link 只登记，
+    // 最外层 end 时建一代、切换并回收一次；可嵌套。通常经 ProjectLinkBatch 使用
+    void begin_link_batch(const std::string& project_path);
+    bool end_link_batch();
+    
     // 缓存维护
     bool cleanup_unused_packages();
     bool cleanup_old_versions();
@@ -130,6 +161,17 @@ public:
     
     // 缓存索引管理
     bool save_cache_index();
+    // 其他进程提交过新索引时重新读取，本进程未保存的修改保留在其上
+    bool refresh_cache_index();
+    
+    // 内容存储：当前缓存根目录下的 blob 存储，关闭时返回 nullptr
+    BlobStore* get_blob_store();
+    void enable_content_store(bool enable) { content_store_enabled_ = enable; }
+    size_t collect_store_garbage(bool full_scan = false);
+    
+    // 远程缓存：location 为 http(s):// 地址或共享目录，为空时关闭
+    bool set_remote_cache(const std::string& location);
+    RemoteCache* get_remote_cache() { return remote_cache_.get(); }
     
 private:
     // 内部辅助方法
@@ -137,6 +179,9 @@ private:
     void scan_installed_packages();
     void scan_installed_packages_fast();
     bool update_package_info(const std::string& package, const std::string& version);
+    // 把已有目录纳入缓存（迁移旧项目时使用），优先改名，避免复制
+    bool adopt_directory_into_cache(const std::string& package, const std::string& version,
+                                    const std::string& source_dir);
     std::string generate_cache_key(const std::string& package, const std::string& version) const;
     bool create_symbolic_link(const std::string& target, const std::string& link_path);
     bool remove_symbolic_link(const std::string& link_path);
@@ -148,6 +193,7 @@ private:
     bool save_configuration(const std::string& config_path);
     
     // 路径解析
+    std::string resolve_cache_root() const;
     std::string resolve_cache_path(const std::string& package, const std::string& version) const;
     std::string resolve_project_path(const std::string& package, const std::string& project_path) const;
     
@@ -155,6 +201,8 @@ private:
     bool install_shallow_clone(const std::string& repo_url, const std::string& cache_path, const std::string& version);
     bool install_archive_only(const std::string& repo_url, const std::string& cache_path, const std::string& version);
     bool install_compressed(const std::string& repo_url, const std::string& cache_path, const std::string& version);
+    // 把版本目录打包为 COMPRESSED 存储的归档
+    bool archive_version_tree(const std::string& tree_path, const std::string& cache_path);
     
     // 内存管理
     void enable_compression(bool enable = true);
@@ -165,6 +213,22 @@ private:
     std::string get_memory_report() const;
     
 private:
+    // 批处理中登记的链接变更
+    struct PendingLinks {
+        std::string project_path;
+        std::map<std::string, GenerationEntry> changes;
+        std::vector<std::string> removals;
+        std::vector<std::string> reasons;
+        int depth = 0;
+    };
+    PendingLinks pending_links_;
+    
+    bool batching_links_for(const std::string& project_path) const;
+    // 以 changes/removals 建一代并切换，之后按工程的保留策略回收旧代
+    bool commit_project_links(const std::string& project_path,
+                              const std::map<std::string, GenerationEntry>& changes,
+                              const std::vector<std::string>& removals, const std::string& reason);
+    
     // 压缩相关方法
     bool compress_file_zlib(const std::string& input_path, const std::string& output_path);
     bool decompress_file_zlib(const std::string& input_path, const std::string& output_path);
@@ -174,6 +238,18 @@ private:
 // 全局缓存管理器实例
 extern std::unique_ptr<CacheManager> g_cache_manager;
 
+// 作用域内对 manager（默认 g_cache_manager）的链接变更合并为一代，析构时提交；manager 为空时不做任何事
+class ProjectLinkBatch {
+public:
+    explicit ProjectLinkBatch(const std::string& project_path, CacheManager* manager = g_cache_manager.get());
+    ~ProjectLinkBatch();
+    ProjectLinkBatch(const ProjectLinkBatch&) = delete;
+    ProjectLinkBatch& operator=(const ProjectLinkBatch&) = delete;
+
+private:
+    CacheManager* manager_;
+};
+
 // 便捷函数
 bool initialize_cache_manager();
 void cleanup_cache_manager();
@@ -38,15 +38,31 @@ struct CachePerformance {
                         avg_access_time(0.0), concurrent_operations(0) {}
 };
 
+// 单个缓存层（本地、远程）的命中统计
+struct CacheTierStats {
+    size_t hits;
+    size_t misses;
+    size_t errors;             // 下载失败或校验不通过
+    size_t bytes_served;
+    
+    CacheTierStats() : hits(0), misses(0), errors(0), bytes_served(0) {}
+    
+    double hit_rate() const {
+        size_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
 // 缓存监控器
 class CacheMonitor {
 private:
     std::atomic<bool> monitoring_active_;
     std::thread monitor_thread_;
-    std::mutex metrics_mutex_;
+    mutable std::mutex metrics_mutex_;
     
     CacheMetrics current_metrics_;
     CachePerformance current_performance_;
+    std::map<std::string, CacheTierStats> tier_stats_;
     
     std::map<std::string, std::chrono::system_clock::time_point> operation_times_;
     std::vector<double> install_times_;
@@ -71,10 +87,15 @@ public:
     void record_package_install(const std::string& package, double duration_ms);
     void record_package_remove(const std::string& package);
     void record_package_access(const std::string& package, double duration_ms);
+    // 按层记录查找结果，tier 如 "local"、"remote"
+    void record_tier_hit(const std::string& tier, const std::string& package, size_t bytes = 0);
+    void record_tier_miss(const std::string& tier, const std::string& package);
+    void record_tier_error(const std::string& tier, const std::string& package);
     
     // 指标获取
     CacheMetrics get_current_metrics() const;
     CachePerformance get_current_performance() const;
+    std::map<std::string, CacheTierStats> get_tier_stats() const;
     
     // 性能分析
     std::string generate_performance_report() const;
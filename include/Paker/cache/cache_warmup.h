@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <memory>
 #include <chrono>
 #include <atomic>
@@ -77,6 +78,9 @@ using WarmupProgressCallback = std::function<void(const std::string& package,
                                                 size_t total, 
                                                 bool success)>;
 
+class WarmupScheduler;
+struct WarmupTask;
+
 // 缓存预热服务
 class CacheWarmupService : public IService {
 private:
@@ -90,8 +94,10 @@ private:
     std::vector<PackageWarmupInfo> packages_to_preload_;
     std::map<std::string, PackageWarmupInfo> package_registry_;
     std::map<WarmupPriority, std::vector<std::string>> priority_queues_;
+    std::set<std::string> preloaded_keys_;   // 已预热的 包@版本
     
-    // 异步控制
+    // 异步控制：工作线程从调度器按优先级取任务，受带宽、磁盘写入预算和前台安装约束
+    std::unique_ptr<WarmupScheduler> scheduler_;
     std::atomic<bool> is_preloading_;
     std::atomic<bool> should_stop_;
     std::vector<std::thread> preload_threads_;
@@ -125,6 +131,9 @@ public:
     void set_max_preload_size(size_t max) { max_preload_size_ = max; }
     void set_preload_timeout(std::chrono::seconds timeout) { preload_timeout_ = timeout; }
     void set_default_strategy(WarmupStrategy strategy) { default_strategy_ = strategy; }
+    // 预热的下载带宽和缓存写入速率上限（字节/秒），0 表示不限
+    void set_bandwidth_limit(uint64_t bytes_per_second);
+    void set_disk_write_limit(uint64_t bytes_per_second);
     
     // 包注册和管理
     bool register_package(const std::string& package, const std::string& version,
@@ -135,12 +144,16 @@ public:
     // 预热控制
     bool start_preload(WarmupStrategy strategy = WarmupStrategy::ASYNC);
     bool stop_preload();
+    // 取消尚未开始的预热任务
+    bool cancel_preload(const std::string& package, const std::string& version);
     bool is_preloading() const { return is_preloading_.load(); }
     
     // 智能预热
     bool start_smart_preload(const std::vector<std::string>& project_dependencies = {});
     bool preload_essential_packages();
     bool preload_popular_packages(size_t count = 10);
+    // 按请求记录训练的预取模型注册接下来最可能用到的包，context 为当前已知要用的包
+    bool preload_predicted_packages(const std::vector<std::string>& context, size_t count = 10);
     
     // 进度监控
     void set_progress_callback(WarmupProgressCallback callback) { progress_callback_ = callback; }
@@ -166,9 +179,10 @@ public:
 private:
     // 内部预热逻辑
     void preload_worker_thread();
-    bool preload_single_package(const PackageWarmupInfo& package_info);
+    bool preload_single_package(const WarmupTask& task);
     void update_preload_progress(const std::string& package, const std::string& version, bool success);
-    bool copy_installed_package_to_cache(const PackageWarmupInfo& package_info);
+    void schedule_pending_packages(std::chrono::steady_clock::time_point deadline);
+    bool copy_installed_package_to_cache(const WarmupTask& task);
     
     // 优先级管理
     void rebuild_priority_queues();
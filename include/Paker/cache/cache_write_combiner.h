@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Paker {
+
+// 写合并配置：max_delay 越大批次越满、吞吐越高，单次写入的延迟也越大
+struct WriteCombinerConfig {
+    bool enabled = true;
+    std::chrono::microseconds max_delay{2000};      // 第一条写入进入批次后最多等待多久
+    size_t max_batch_entries = 256;                 // 攒够条数立即落盘
+    size_t max_batch_bytes = 8 * 1024 * 1024;       // 攒够字节数立即落盘
+    size_t max_entry_size = 256 * 1024;             // 更大的写入不合并，走原有单文件路径
+    bool durable = false;                           // 开启后本批写入的每个文件在回调前 fdatasync
+};
+
+// 写合并统计
+struct WriteCombinerStats {
+    size_t writes_submitted = 0;
+    size_t writes_coalesced = 0;    // 同一批内被后来的写入覆盖的旧写入
+    size_t files_written = 0;
+    size_t failed_writes = 0;
+    size_t bytes_written = 0;
+    size_t batches = 0;
+    size_t io_uring_batches = 0;
+    size_t durable_batches = 0;     // durable 模式下落盘的批次
+    size_t files_flushed = 0;       // 逐个 fdatasync 的文件数；走 io_uring 时与写入同轮提交
+    size_t max_batch_size = 0;
+    std::chrono::microseconds total_latency{0};     // 提交到回调之间的累计时间
+    std::chrono::microseconds max_latency{0};
+
+    double average_batch_size() const {
+        return batches > 0 ? static_cast<double>(files_written + failed_writes) / batches : 0.0;
+    }
+    double average_latency_ms() const {
+        return writes_submitted > 0 ? total_latency.count() / 1000.0 / writes_submitted : 0.0;
+    }
+};
+
+// 缓存小文件写合并器
+// 短时间内到达的写入攒成一批，由后台线程一次提交（io_uring 可用时整批一次 io_uring_enter），
+// 整批写完后（durable 时每个文件写后刷写，io_uring 上与写入同轮提交）再逐个回调。同一路径在批内多次写入只落盘最后一次。
+class CacheWriteCombiner {
+public:
+    // success 为最终写入是否成功，bytes 为最终写入的字节数
+    using Callback = std::function<void(bool success, size_t bytes)>;
+
+    explicit CacheWriteCombiner(WriteCombinerConfig config = WriteCombinerConfig());
+    ~CacheWriteCombiner();
+
+    CacheWriteCombiner(const CacheWriteCombiner&) = delete;
+    CacheWriteCombiner& operator=(const CacheWriteCombiner&) = delete;
+
+    // 该大小的写入是否走合并路径
+    bool accepts(size_t size) const;
+    // 截断写入 path；回调在后台线程上执行，不要在回调里阻塞
+    void submit(std::string path, std::string content, Callback done);
+    // 阻塞直到此前提交的写入全部落盘并回调完毕；在回调里调用时就地写完剩余批次
+    void flush();
+    // 写完剩余批次后停止后台线程，之后的写入在调用线程上直接完成
+    void stop();
+
+    void set_config(const WriteCombinerConfig& config);
+    WriteCombinerConfig get_config() const;
+    WriteCombinerStats get_stats() const;
+
+private:
+    struct PendingWrite {
+        std::string path;
+        std::string content;
+        std::vector<Callback> callbacks;
+        std::vector<std::chrono::steady_clock::time_point> submit_times;
+    };
+
+    void run();
+    // 批次已满、超时或有人等待刷盘
+    bool batch_ready(std::chrono::steady_clock::time_point now) const;
+    // 取走待写批次，调用方持有 mutex_
+    std::vector<PendingWrite> take_pending();
+    std::vector<bool> write_batch(const std::vector<PendingWrite>& batch);
+    // 回调在不持锁、writing_ 已清除时执行，回调里可以再次提交或 flush
+    static void dispatch(std::vector<PendingWrite>& batch, const std::vector<bool>& results);
+
+    WriteCombinerConfig config_;
+    WriteCombinerStats stats_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable drained_cv_;
+    std::vector<PendingWrite> pending_;
+    std::unordered_map<std::string, size_t> pending_index_;
+    size_t pending_bytes_ = 0;
+    std::chrono::steady_clock::time_point batch_started_;
+    size_t flush_waiters_ = 0;
+    bool writing_ = false;      // 后台线程正在落盘
+    bool dispatching_ = false;  // 后台线程正在执行回调
+    bool stopping_ = false;
+    std::thread::id worker_id_;
+    std::thread worker_;
+};
+
+} // namespace Paker
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Paker {
+
+// 一代中某个包的链接
+struct GenerationEntry {
+    std::string version;
+    std::string target;     // 缓存中的版本目录，或工程内物化出的目录
+};
+
+// 工程包链接的一代
+struct Generation {
+    uint64_t id = 0;
+    std::chrono::system_clock::time_point created;
+    std::string reason;
+    std::map<std::string, GenerationEntry> packages;
+};
+
+// 一次切换的结果
+struct GenerationSwitchResult {
+    bool success = false;
+    uint64_t from = 0;
+    uint64_t to = 0;
+    std::chrono::microseconds switch_latency{0};   // 只含原子替换本身
+};
+
+// 旧代回收策略：当前代和上一代总是保留
+struct GenerationRetention {
+    size_t keep_last = 10;                                  // 保留最新的若干代
+    std::chrono::hours max_age{24 * 30};                    // 超过该时间的旧代即使在 keep_last 内也回收
+};
+
+// 工程包目录按代管理
+// 布局：.paker/generations/<N>/<包> 是指向缓存（或物化目录）的软链接，.paker/generations/<N>.json 记录版本；
+// .paker/links 是指向当前代的软链接，切换时先建好新链接，再用 renameat2(RENAME_EXCHANGE) 原子替换，
+// 因此升级、回滚都只是一次指针切换，失败时工程仍停留在完整的旧代上。
+// 物化策略下的包目录放在 .paker/trees/<包>@<版本>~<策略>，同一策略的各代共用；
+// 策略改变后按新策略另建目录，旧目录不再被任何代引用时由 collect_garbage 回收。
+class GenerationManager {
+public:
+    explicit GenerationManager(const std::string& project_path);
+
+    // 当前代，0 表示尚未启用
+    uint64_t current() const;
+    std::vector<Generation> list() const;
+    bool load(uint64_t id, Generation& generation) const;
+
+    // 把旧式的真实 .paker/links 目录转换为第 1 代并切换
+    bool ensure_initialized();
+
+    // 以当前代为基础创建新一代（不切换）；changes 中的包被设置或替换，removals 中的包被去掉。失败返回 0
+    uint64_t create_generation(const std::map<std::string, GenerationEntry>& changes,
+                               const std::vector<std::string>& removals, const std::string& reason);
+
+    // 原子切换到指定代
+    GenerationSwitchResult switch_to(uint64_t id);
+
+    // 包处于指定版本的最近一代（链接目标仍存在），没有时返回 0
+    uint64_t find_generation_with(const std::string& package, const std::string& version) const;
+
+    // 按策略删除旧代及不再被任何代引用的物化目录，返回删除的代数
+    size_t collect_garbage(const GenerationRetention& retention = GenerationRetention());
+
+    std::string generation_path(uint64_t id) const;
+    // policy 为物化策略名，非空时记录在目录名中
+    std::string tree_path(const std::string& package, const std::string& version,
+                          const std::string& policy = "") const;
+
+private:
+    uint64_t write_generation(Generation generation);
+    bool write_metadata(const Generation& generation) const;
+    bool swap_links(const std::string& target, std::chrono::microseconds& latency);
+
+    std::string paker_dir_;
+    std::string links_path_;
+    std::string generations_dir_;
+};
+
+// 工程的回收策略记录在 Paker.json 的 "generations" 字段：{"keep": 10, "max_age_days": 30}
+GenerationRetention load_project_generation_retention(const std::string& project_path);
+
+} // namespace Paker
@@ -9,16 +9,43 @@
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
-#include <list>
 #include <filesystem>
+#include <optional>
+#include "Paker/core/string_interner.h"
 
 namespace Paker {
 
+// 缓存键：包名与版本两个驻留句柄
+// "包名:版本" 组合串随版本发布不断出现，不进入驻留表；只在序列化和日志中拼出
+struct LRUCacheKey {
+    Symbol package_name;
+    Symbol version;
+    
+    std::string str() const { return package_name.str() + ":" + version.str(); }
+    
+    friend bool operator==(const LRUCacheKey& a, const LRUCacheKey& b) {
+        return a.package_name == b.package_name && a.version == b.version;
+    }
+    friend bool operator!=(const LRUCacheKey& a, const LRUCacheKey& b) { return !(a == b); }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LRUCacheKey& key) {
+    return os << key.package_name << ':' << key.version;
+}
+
+struct LRUCacheKeyHash {
+    size_t operator()(const LRUCacheKey& key) const {
+        return (static_cast<uint64_t>(key.package_name.id()) << 32) | key.version.id();
+    }
+};
+
 // LRU缓存项
+// 包名和版本是驻留句柄，同名包、同版本号在所有缓存项之间只存一份；
+// 缓存路径各不相同，驻留只会让只增不减的驻留表随安装次数增长，保持普通字符串
 struct LRUCacheItem {
-    std::string key;
-    std::string package_name;
-    std::string version;
+    LRUCacheKey key;
+    Symbol package_name;
+    Symbol version;
     std::string cache_path;
     size_t size_bytes;
     std::chrono::system_clock::time_point last_access;
@@ -27,8 +54,9 @@ struct LRUCacheItem {
     bool is_pinned; // 是否被固定（不会被清理）
     
     LRUCacheItem() : size_bytes(0), access_count(0), is_pinned(false) {}
-    LRUCacheItem(const std::string& key, const std::string& package_name, const std::string& version)
-        : key(key), package_name(package_name), version(version), size_bytes(0), access_count(0), is_pinned(false) {}
+    LRUCacheItem(std::string_view package_name, std::string_view version)
+        : key{Symbol(package_name), Symbol(version)}, package_name(key.package_name), version(key.version),
+          size_bytes(0), access_count(0), is_pinned(false) {}
 };
 
 // 缓存策略
@@ -43,7 +71,7 @@ enum class CacheEvictionPolicy {
 
 // 访问模式分析
 struct AccessPattern {
-    std::string package_name;
+    Symbol package_name;
     size_t access_count;
     std::chrono::steady_clock::time_point first_access;
     std::chrono::steady_clock::time_point last_access;
@@ -71,7 +99,7 @@ struct FragmentationInfo {
 // 自适应缓存策略
 class AdaptiveCacheStrategy {
 private:
-    std::map<std::string, AccessPattern> access_patterns_;
+    std::unordered_map<Symbol, AccessPattern> access_patterns_;
     mutable std::mutex patterns_mutex_;
     std::chrono::steady_clock::time_point last_analysis_;
     std::chrono::milliseconds analysis_interval_;
@@ -117,14 +145,19 @@ struct CacheStatistics {
 };
 
 // LRU缓存管理器
+// 缓存项按键的哈希分到多个分片，每个分片有自己的读写锁。查询只持有分片的共享锁，命中时
+// 以 relaxed 原子操作置访问位（CLOCK）并抽样更新访问时间，不再移动共享的 LRU 链表；
+// 淘汰时各分片的时钟指针跳过并清除访问位已置位的项。命中、未命中和容量按分片原子计数，
+// 读取统计时汇总。
 class LRUCacheManager {
 private:
-    // LRU链表：最近使用的在头部，最少使用的在尾部
-    mutable std::list<std::string> lru_list_;
-    mutable std::unordered_map<std::string, std::list<std::string>::iterator> lru_map_;
+    struct Shard;
     
-    // 缓存项存储
-    std::unordered_map<std::string, LRUCacheItem> cache_items_;
+    // 分片数为 2 的幂
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shard_mask_;
+    // 淘汰时轮流从各分片取牺牲者
+    size_t eviction_cursor_;
     
     // 配置
     size_t max_cache_size_;
@@ -135,21 +168,29 @@ private:
     // 自适应缓存策略
     std::unique_ptr<AdaptiveCacheStrategy> adaptive_strategy_;
     
-    // 统计信息
+    // 清理和碎片整理的时间与次数；计数类统计在分片中
     mutable CacheStatistics statistics_;
     
-    // 线程安全
-    mutable std::mutex cache_mutex_;
+    // 清理、淘汰、碎片整理等整体维护操作之间互斥；单项读写只锁所在分片
+    mutable std::mutex maintenance_mutex_;
     
     // 缓存目录
     std::string cache_directory_;
     
+    // 上次与索引文件同步时各缓存项的序列化结果，保存时只提交相对它的修改，
+    // 其他进程同时写入的缓存项不会被覆盖
+    mutable std::unordered_map<std::string, std::string> index_base_;
+    
     // 内部方法
-    void update_lru(const std::string& key) const;
-    void evict_item(const std::string& key);
+    Shard& shard_for(const LRUCacheKey& key) const;
+    // 所有缓存项的快照，访问时间和次数取自原子计数
+    std::vector<LRUCacheItem> snapshot_items() const;
+    bool evict_item(const LRUCacheKey& key);
+    // 在分片上运行时钟算法淘汰一项，没有可淘汰的项时返回 false
+    bool evict_clock_victim(Shard& shard);
+    bool over_capacity() const;
     bool should_evict(const LRUCacheItem& item) const;
     size_t calculate_item_size(const std::string& cache_path) const;
-    void update_statistics(const std::string& key, bool hit) const;
     
     // 清理策略
     void evict_by_lru();
@@ -173,7 +214,8 @@ public:
                    size_t max_cache_size = 10ULL * 1024 * 1024 * 1024, // 10GB
                    size_t max_cache_items = 1000,
                    std::chrono::hours max_age = std::chrono::hours(24 * 30), // 30天
-                   CacheEvictionPolicy policy = CacheEvictionPolicy::HYBRID);
+                   CacheEvictionPolicy policy = CacheEvictionPolicy::HYBRID,
+                   size_t shard_count = 16);
     
     ~LRUCacheManager();
     
@@ -232,6 +274,8 @@ public:
     
 private:
     std::string generate_cache_key(const std::string& package_name, const std::string& version) const;
+    // 查询路径只查找已驻留的包名和版本，未命中的名字不进入驻留表
+    std::optional<LRUCacheKey> find_cache_key(const std::string& package_name, const std::string& version) const;
     void perform_eviction();
     void update_cache_statistics();
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace Paker {
+
+// 工程中包目录的物化策略
+enum class MaterializePolicy {
+    SYMLINK,    // 整个目录软链接到缓存（默认，零拷贝但工程内不是真实文件）
+    HARDLINK,   // 硬链接树（与缓存共用 inode，见 set_protect_source）；跨文件系统时退回复制
+    REFLINK,    // 写时复制克隆（btrfs/XFS 等），不支持时退回内核复制
+    COPY,       // 真实复制，优先 copy_file_range/sendfile 在内核完成
+    AUTO        // 按文件系统能力依次尝试 reflink、硬链接、内核复制、用户态复制
+};
+
+MaterializePolicy parse_materialize_policy(const std::string& name, MaterializePolicy fallback = MaterializePolicy::SYMLINK);
+const char* materialize_policy_name(MaterializePolicy policy);
+
+// 工程的物化策略记录在 Paker.json 的 "materialize" 字段，未设置时为 symlink
+MaterializePolicy load_project_materialize_policy(const std::string& project_path);
+bool save_project_materialize_policy(const std::string& project_path, MaterializePolicy policy);
+
+// 一次物化的统计
+struct MaterializeResult {
+    bool success = false;
+    size_t files = 0;
+    size_t reflinked = 0;
+    size_t hardlinked = 0;
+    size_t kernel_copied = 0;   // copy_file_range / sendfile
+    size_t user_copied = 0;     // read/write 经过用户态缓冲区
+    size_t bytes_total = 0;
+    size_t bytes_copied = 0;    // 实际复制的数据量
+
+    // 借助链接/克隆而免于复制的字节数
+    size_t bytes_avoided() const { return bytes_total - bytes_copied; }
+    std::string summary() const;
+};
+
+// 缓存目录到工程目录的物化
+// 按策略为每个文件选择最便宜的方式；某种方式在当前源/目标文件系统上失败一次后，
+// 同一次物化中不再尝试。
+class FileMaterializer {
+public:
+    explicit FileMaterializer(MaterializePolicy policy = MaterializePolicy::AUTO);
+
+    MaterializePolicy get_policy() const { return policy_; }
+
+    // 硬链接时去掉缓存源文件的写权限，防止工程内的原地写入改到缓存；默认不修改源文件
+    void set_protect_source(bool enable) { protect_source_ = enable; }
+
+    // 每个普通文件物化前以其字节数调用；返回 false 时中止并丢弃临时目录（预热用它按块限速）
+    using FileHook = std::function<bool(size_t bytes)>;
+    void set_file_hook(FileHook hook) { file_hook_ = std::move(hook); }
+
+    // 把 source 目录树物化到 dest：先写入同级临时目录，完成后替换 dest
+    MaterializeResult materialize_tree(const std::string& source, const std::string& dest);
+
+    // 复制单个文件：reflink -> copy_file_range -> sendfile -> 用户态；保留权限位
+    static bool copy_file(const std::string& source, const std::string& dest, MaterializeResult* result = nullptr);
+
+    // 目标所在文件系统是否通常支持 reflink（btrfs、XFS、bcachefs）
+    static bool filesystem_supports_reflink(const std::string& path);
+
+private:
+    MaterializePolicy policy_;
+    bool protect_source_ = false;
+    FileHook file_hook_;
+};
+
+} // namespace Paker
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paker {
+
+// 一次安装/解析请求
+struct PrefetchEvent {
+    int64_t timestamp_ms = 0;
+    std::string session;        // 同一次命令（或 CI 作业，见 PAKER_PREFETCH_SESSION）中的请求属于同一会话
+    std::string package;
+    uint64_t bytes = 0;         // 包在缓存中的大小，未知时为 0
+};
+
+// 按时间顺序的一个会话
+struct PrefetchSession {
+    std::string id;
+    std::vector<PrefetchEvent> events;
+};
+
+// 请求记录：每行一个事件（时间\t会话\t包\t字节数），只追加
+// 布局与历史日志相同按段存放：<dir>/trace-000001.log 写满 segment_bytes 后新记录写入下一段，
+// 只保留最新的 max_segments 段，更早的整段删除。旧版本的 <dir>/trace.log 视为第 0 段，只读不写。
+// 读取位置为 (段号 << 32) | 段内偏移，所在段已被删除时从现存最早的段继续。
+class PrefetchTrace {
+public:
+    static constexpr uint64_t kSegmentBytes = 1024 * 1024;
+    static constexpr size_t kMaxSegments = 8;
+
+    explicit PrefetchTrace(const std::string& dir, uint64_t segment_bytes = kSegmentBytes,
+                           size_t max_segments = kMaxSegments);
+
+    bool append(const std::string& package, uint64_t bytes);
+    bool append(const PrefetchEvent& event);
+
+    // 从 position 起读取事件，返回读到的末尾位置
+    uint64_t read(std::vector<PrefetchEvent>& events, uint64_t position = 0) const;
+
+    // 当前写入的段
+    std::string trace_path() const;
+    std::string segment_path(uint32_t segment) const;
+    std::vector<uint32_t> list_segments() const;
+    std::string model_path() const { return dir_ + "/model.bin"; }
+
+    // 本进程的会话标识：环境变量 PAKER_PREFETCH_SESSION，否则为进程号和启动时间
+    static std::string current_session();
+    static std::vector<PrefetchSession> group_sessions(const std::vector<PrefetchEvent>& events);
+
+private:
+    uint64_t read_segment(uint32_t segment, uint64_t offset, std::vector<PrefetchEvent>& events) const;
+
+    std::string dir_;
+    uint64_t segment_bytes_;
+    size_t max_segments_;
+};
+
+struct PrefetchCandidate {
+    std::string package;
+    double confidence = 0.0;
+    double markov = 0.0;            // 由最近一个请求转移到该包的概率
+    double association = 0.0;       // 与当前会话已请求的包同时出现的最大置信度
+    uint64_t expected_bytes = 0;
+};
+
+struct PrefetchOptions {
+    size_t max_candidates = 10;
+    double min_confidence = 0.3;
+};
+
+// 离线重放指标
+struct PrefetchReplayResult {
+    size_t sessions = 0;
+    size_t requests = 0;
+    size_t prefetched = 0;          // 发出的预取
+    size_t useful = 0;              // 预取后在同一会话中确实被请求
+    size_t covered = 0;             // 请求时已被预取的请求数
+    uint64_t prefetched_bytes = 0;
+    uint64_t wasted_bytes = 0;      // 预取了但未被请求的包的大小
+
+    double precision() const { return prefetched ? static_cast<double>(useful) / prefetched : 0.0; }
+    double recall() const { return requests ? static_cast<double>(covered) / requests : 0.0; }
+};
+
+// 由请求记录训练的预取模型
+// 一阶马尔可夫链：统计整个请求流中 a 之后紧接着请求 b 的次数（跨会话，CI 中前一个作业的末尾可以预测下一个作业的开头）；
+// 关联规则：统计同一会话中 a、b 同时出现的会话数，置信度为 count(a,b) / count(a)。
+// 候选包的置信度按噪声或合并两者：1 - (1 - P_markov)(1 - conf_assoc)。
+// 模型以变长整数编码的稀疏边表保存，每个包只保留计数最高的 max_edges 条出边。
+class PrefetchModel {
+public:
+    explicit PrefetchModel(size_t max_edges = 64);
+
+    // 按时间顺序学习事件
+    void observe(const PrefetchEvent& event);
+    void observe_session(const PrefetchSession& session);
+    void train(const std::vector<PrefetchEvent>& events);
+
+    // context 为当前会话中已请求的包（按顺序），为空时从上一个会话的最后一个请求出发
+    std::vector<PrefetchCandidate> predict(const std::vector<std::string>& context,
+                                           const PrefetchOptions& options = PrefetchOptions()) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // 读取记录中 trained_offset（PrefetchTrace::read 的位置）之后的新事件并学习，返回新学到的事件数
+    size_t update_from_trace(const PrefetchTrace& trace);
+
+    size_t package_count() const;
+    size_t edge_count() const;
+    uint64_t trained_offset() const { return trained_offset_; }
+
+    // 按时间重放：每个请求到来前用已有模型预测并“预取”，会话结束后再学习该会话
+    static PrefetchReplayResult replay(const std::vector<PrefetchEvent>& events, const PrefetchOptions& options,
+                                       size_t max_edges = 64);
+
+private:
+    struct Edge {
+        uint32_t next = 0;      // 马尔可夫转移计数
+        uint32_t together = 0;  // 同一会话中共同出现的会话数
+    };
+    struct Node {
+        std::string package;
+        uint32_t requests = 0;  // 作为转移起点的次数
+        uint32_t sessions = 0;  // 出现过的会话数
+        uint64_t bytes = 0;     // 最近记录的大小
+        std::unordered_map<uint32_t, Edge> edges;
+    };
+
+    uint32_t intern(const std::string& package);
+    void prune(Node& node) const;
+    void finish_session();
+
+    size_t max_edges_;
+    std::vector<Node> nodes_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    int64_t last_package_;                  // 请求流中最后一个包，-1 表示没有
+    std::string current_session_;
+    std::vector<uint32_t> session_packages_;
+    uint64_t trained_offset_;
+};
+
+// 机器级的预取模型目录：用户缓存下的 prefetch
+std::string get_prefetch_dir();
+
+} // namespace Paker
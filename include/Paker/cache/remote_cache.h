@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Paker {
+
+// 远程缓存后端：按键读写整个文件
+// 键的布局：objects/<sha256 前两位>/<sha256> 为按内容寻址的归档，
+// refs/<包>/<版本> 为该版本归档的 sha256。对象一经写入不再改变，引用最后写入，
+// 因此读者要么看不到某个版本，要么看到完整的对象。
+class RemoteCacheBackend {
+public:
+    virtual ~RemoteCacheBackend() = default;
+
+    virtual std::string describe() const = 0;
+    // 下载到 dest_path；键不存在或出错时返回 false
+    virtual bool fetch(const std::string& key, const std::string& dest_path) = 0;
+    virtual bool store(const std::string& key, const std::string& src_path) = 0;
+    virtual bool contains(const std::string& key) = 0;
+};
+
+// 共享目录（如 NFS 挂载）：先写入同目录的临时文件再改名，其他机器不会读到半个文件
+class FilesystemRemoteBackend : public RemoteCacheBackend {
+public:
+    explicit FilesystemRemoteBackend(const std::string& root);
+
+    std::string describe() const override { return "file://" + root_; }
+    bool fetch(const std::string& key, const std::string& dest_path) override;
+    bool store(const std::string& key, const std::string& src_path) override;
+    bool contains(const std::string& key) override;
+
+private:
+    std::string root_;
+};
+
+// HTTP：GET/PUT/HEAD <base_url>/<键>，任何能按路径存取文件的服务器都可以作为远程缓存
+class HttpRemoteBackend : public RemoteCacheBackend {
+public:
+    explicit HttpRemoteBackend(const std::string& base_url, long timeout_seconds = 60);
+
+    std::string describe() const override { return base_url_; }
+    bool fetch(const std::string& key, const std::string& dest_path) override;
+    bool store(const std::string& key, const std::string& src_path) override;
+    bool contains(const std::string& key) override;
+
+private:
+    std::string url_for(const std::string& key) const { return base_url_ + "/" + key; }
+
+    std::string base_url_;
+    long timeout_seconds_;
+};
+
+// http:// 或 https:// 使用 HTTP 后端，file:// 或普通路径使用共享目录
+std::unique_ptr<RemoteCacheBackend> create_remote_cache_backend(const std::string& location);
+
+struct RemoteCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t integrity_failures = 0;   // 下载内容与 sha256 不符
+    size_t uploads = 0;
+    size_t upload_failures = 0;
+    size_t already_present = 0;      // 远程已有同样内容，只更新引用
+    uint64_t bytes_downloaded = 0;
+    uint64_t bytes_uploaded = 0;
+};
+
+// 跨机器共享的远程缓存层
+// 读穿：本地未命中时按引用取得 sha256，下载对象到暂存目录并校验后解压到本地缓存路径；
+// 回写：新安装的版本打包为可随机读取归档（.pkar），由后台线程上传对象后再写引用。
+class RemoteCache {
+public:
+    RemoteCache(std::unique_ptr<RemoteCacheBackend> backend, const std::string& staging_dir);
+    ~RemoteCache();
+
+    RemoteCache(const RemoteCache&) = delete;
+    RemoteCache& operator=(const RemoteCache&) = delete;
+
+    // 下载并解压到 dest_dir（不能已存在）；未命中或校验失败时返回 false，不留下半成品
+    bool fetch(const std::string& package, const std::string& version, const std::string& dest_dir);
+
+    // source 为版本目录或 .pkar 归档
+    bool publish(const std::string& package, const std::string& version, const std::string& source);
+    void publish_async(const std::string& package, const std::string& version, const std::string& source);
+    // 等待已排队的回写完成
+    void flush();
+
+    RemoteCacheStats get_stats() const;
+    std::string describe() const { return backend_->describe(); }
+
+    static bool valid_name(const std::string& name);
+    static std::string ref_key(const std::string& package, const std::string& version);
+    static std::string object_key(const std::string& digest);
+
+private:
+    struct Upload {
+        std::string package;
+        std::string version;
+        std::string source;
+    };
+
+    std::string staging_path(const std::string& name);
+    bool pack(const std::string& source, const std::string& archive_path);
+    void upload_loop();
+
+    std::unique_ptr<RemoteCacheBackend> backend_;
+    std::string staging_dir_;
+    std::atomic<uint64_t> staging_serial_;
+
+    mutable std::mutex stats_mutex_;
+    RemoteCacheStats stats_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Upload> uploads_;
+    size_t uploads_in_flight_;
+    bool stopping_;
+    std::thread uploader_;
+};
+
+} // namespace Paker
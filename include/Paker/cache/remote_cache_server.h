@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Paker {
+
+// 远程缓存的本地 HTTP 服务：把 root 目录按 GET/PUT/HEAD 暴露出来，布局与共享目录后端相同。
+// 用于测试，也可以把一台机器上的共享目录提供给没有挂载它的 CI 机器。
+// 每个连接只处理一个请求（Connection: close），不支持分块传输。
+class RemoteCacheServer {
+public:
+    explicit RemoteCacheServer(const std::string& root);
+    ~RemoteCacheServer();
+    RemoteCacheServer(const RemoteCacheServer&) = delete;
+    RemoteCacheServer& operator=(const RemoteCacheServer&) = delete;
+
+    // 监听 address:port，port 为 0 时由系统分配
+    bool bind(uint16_t port = 0, const std::string& address = "127.0.0.1");
+    // 进入服务循环，直到 request_stop()
+    void run();
+    void request_stop() { stop_requested_ = true; }
+
+    uint16_t get_port() const { return port_; }
+    std::string get_url() const;
+    uint64_t get_requests_served() const { return requests_served_.load(); }
+
+private:
+    void handle_connection(int client_fd);
+    std::string resolve_key(const std::string& target) const;
+
+    std::string root_;
+    std::string address_;
+    uint16_t port_ = 0;
+    int listen_fd_ = -1;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<uint64_t> requests_served_{0};
+};
+
+} // namespace Paker
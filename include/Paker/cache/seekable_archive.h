@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paker {
+
+// 归档帧的压缩算法
+enum class ArchiveCodec : uint32_t {
+    ZLIB = 1,   // 未编译 zstd 时使用
+    ZSTD = 2
+};
+
+// 编译时是否带有 zstd（定义 PAKER_HAVE_ZSTD）
+bool archive_codec_available(ArchiveCodec codec);
+ArchiveCodec default_archive_codec();
+
+// 归档中的一个条目
+struct ArchiveEntry {
+    enum class Type : uint8_t { FILE = 0, DIRECTORY = 1, SYMLINK = 2 };
+
+    std::string path;           // 相对归档根目录
+    Type type = Type::FILE;
+    uint32_t mode = 0644;
+    uint64_t size = 0;
+    uint64_t stream_offset = 0; // 在未压缩数据流中的起点
+    std::string link_target;
+};
+
+struct ArchiveWriteOptions {
+    ArchiveCodec codec = default_archive_codec();
+    size_t frame_size = 256 * 1024;   // 每帧未压缩大小，决定随机读取的粒度
+    int level = 0;                    // 0 表示按算法取默认级别
+    std::string dictionary;           // zstd 字典，只记录 ID，不写入归档
+    int threads = 0;                  // 0 表示 OpenMP 默认线程数
+};
+
+struct ArchiveWriteStats {
+    size_t files = 0;
+    size_t frames = 0;
+    size_t uncompressed_bytes = 0;
+    size_t archive_bytes = 0;
+};
+
+// 可随机读取的分帧压缩归档（.pkar）
+// 所有文件按路径排序后拼接成一条数据流，按 frame_size 切成独立压缩的帧，末尾是帧表、
+// 条目索引和定长尾部。读取单个文件只需解压覆盖它的帧；全量解压时各帧并行处理。
+// 使用字典时字典保存在包目录下的 .zdict，同一包的各版本共用，尾部记录字典 ID 用于校验。
+class SeekableArchiveWriter {
+public:
+    static bool create(const std::string& source_dir, const std::string& archive_path,
+                       const ArchiveWriteOptions& options = ArchiveWriteOptions(),
+                       ArchiveWriteStats* stats = nullptr);
+
+    // 以目录中的小文件为样本训练 zstd 字典；不支持或样本不足时返回空串
+    static std::string train_dictionary(const std::string& source_dir, size_t max_dict_size = 64 * 1024);
+};
+
+class SeekableArchiveReader {
+public:
+    SeekableArchiveReader();
+    ~SeekableArchiveReader();
+
+    SeekableArchiveReader(const SeekableArchiveReader&) = delete;
+    SeekableArchiveReader& operator=(const SeekableArchiveReader&) = delete;
+
+    // dictionary_path 为空时按归档旁的 .zdict 查找
+    bool open(const std::string& archive_path, const std::string& dictionary_path = "");
+    bool is_open() const { return fd_ >= 0; }
+
+    const std::vector<ArchiveEntry>& entries() const { return entries_; }
+    const ArchiveEntry* find(const std::string& path) const;
+    ArchiveCodec codec() const { return codec_; }
+
+    // 只解压覆盖该文件的帧；最近解压的帧会保留，连续读取同一目录下的小文件不重复解压
+    bool read_file(const std::string& path, std::string& out);
+
+    // 全量解压到目录，按帧分组并行
+    bool extract_all(const std::string& dest_dir, int threads = 0);
+
+    size_t frames_decompressed() const { return frames_decompressed_.load(); }
+
+    class FrameCodec;
+
+private:
+    struct Frame {
+        uint64_t offset = 0;
+        uint32_t compressed_size = 0;
+        uint32_t size = 0;
+    };
+
+    bool decompress_frame(size_t index, FrameCodec& codec, std::string& out);
+    bool read_range(uint64_t offset, uint64_t size, FrameCodec& codec, std::string& out,
+                    size_t* cached_index, std::string* cached_frame);
+
+    int fd_;
+    ArchiveCodec codec_;
+    uint32_t frame_size_;
+    std::string dictionary_;
+    std::vector<Frame> frames_;
+    std::vector<ArchiveEntry> entries_;
+    std::unordered_map<std::string, size_t> lookup_;
+
+    // read_file 共用的解压上下文与最近一帧
+    std::mutex read_mutex_;
+    std::unique_ptr<FrameCodec> read_codec_;
+    size_t cached_index_;
+    std::string cached_frame_;
+    std::atomic<size_t> frames_decompressed_;
+};
+
+} // namespace Paker
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Paker/cache/cache_warmup.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paker {
+
+// 令牌桶：令牌按 rate 每秒补充，最多积累 capacity 个；rate 为 0 表示不限
+class TokenBucket {
+public:
+    explicit TokenBucket(uint64_t rate_per_second = 0, uint64_t capacity = 0);
+
+    void set_rate(uint64_t rate_per_second, uint64_t capacity = 0);
+    uint64_t rate() const;
+
+    // 等待并消费 amount 个令牌。超过 capacity 的请求在桶满时放行并记为欠账，
+    // 由之后的请求偿还。无法在 deadline 前满足或 cancelled 置位时返回 false，不消费
+    bool acquire(uint64_t amount, std::chrono::steady_clock::time_point deadline,
+                 const std::atomic<bool>* cancelled = nullptr);
+    bool try_acquire(uint64_t amount);
+
+private:
+    void refill(std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex mutex_;
+    uint64_t rate_;
+    uint64_t capacity_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_refill_;
+};
+
+// 前台操作标记：交互式安装期间在标记目录下留有 <pid>.<序号> 文件，
+// 同机的预热进程看到存活进程的标记时退避
+class ForegroundActivity {
+public:
+    class Scope {
+    public:
+        explicit Scope(const std::string& reason, const std::string& dir = "");
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::string marker_;
+    };
+
+    // 本进程或同机其他进程是否有进行中的前台操作；顺带清理已退出进程留下的标记
+    static bool active(const std::string& dir = "");
+    static std::string default_dir();
+};
+
+// 调度器限额
+struct WarmupBudget {
+    uint64_t network_bytes_per_second = 0;      // 下载带宽，0 表示不限
+    uint64_t disk_write_bytes_per_second = 0;   // 写入缓存的速率，0 表示不限
+    std::chrono::milliseconds backoff_initial{50};
+    std::chrono::milliseconds backoff_max{2000};
+};
+
+struct WarmupTask {
+    PackageWarmupInfo info;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    uint64_t sequence = 0;
+
+    std::string key() const { return info.package_name + "@" + info.version; }
+};
+
+struct WarmupSchedulerStats {
+    size_t scheduled = 0;
+    size_t started = 0;
+    size_t cancelled = 0;
+    size_t expired = 0;                         // 到期前未能开始
+    size_t backoffs = 0;                        // 因前台操作退避的次数
+    std::chrono::milliseconds backoff_time{0};
+};
+
+// 预热调度器
+// 待预热的包放在按 (优先级, 流行度, 加入顺序) 排序的堆中，取任务为 O(log n)；
+// 取消和更新采用惰性删除，堆中过时的条目在弹出时丢弃。
+// 任务开始前等待前台操作结束（指数退避）；开始后由执行方随数据传输调用 charge，
+// 每块先确认前台空闲，再从带宽和磁盘写入两个令牌桶中扣除该块的字节数。
+class WarmupScheduler {
+public:
+    explicit WarmupScheduler(const WarmupBudget& budget = WarmupBudget(), const std::string& foreground_dir = "");
+
+    void set_budget(const WarmupBudget& budget);
+    WarmupBudget get_budget() const;
+
+    // 加入任务；同一包版本已在队列中时以新的信息替换
+    void schedule(const PackageWarmupInfo& info,
+                  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+    bool cancel(const std::string& key);
+    void cancel_all();
+
+    // 取出下一个可以开始的任务，必要时等待前台空闲；队列为空或已停止时返回 false
+    bool next(WarmupTask& task);
+
+    // 为进行中的任务扣除 bytes 字节的预算，按 kChunkSize 分块，每块之前检查前台操作并退避。
+    // network 为 false 时只扣磁盘写入预算；调度器停止时返回 false，调用方应中止传输
+    bool charge(const WarmupTask& task, uint64_t bytes, bool network);
+
+    // 让等待中的 next 立即返回 false；reset 清空队列并恢复
+    void stop();
+    void reset();
+    bool stopped() const { return stopped_.load(); }
+
+    size_t pending() const;
+    WarmupSchedulerStats get_stats() const;
+
+    // 无法得知实际大小时按此估计扣除预算
+    static constexpr uint64_t kDefaultEstimate = 1024 * 1024;
+    static constexpr uint64_t kChunkSize = 1024 * 1024;
+
+private:
+    struct Order {
+        bool operator()(const WarmupTask& a, const WarmupTask& b) const;
+    };
+
+    bool pop(WarmupTask& task);
+    bool still_live(const WarmupTask& task) const;
+    bool wait_for_foreground(const WarmupTask& task, std::chrono::steady_clock::time_point deadline);
+
+    mutable std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    std::priority_queue<WarmupTask, std::vector<WarmupTask>, Order> heap_;
+    std::unordered_map<std::string, uint64_t> live_;    // 包版本 -> 有效条目的序号
+    uint64_t next_sequence_;
+    std::atomic<bool> stopped_;
+
+    WarmupBudget budget_;
+    TokenBucket network_;
+    TokenBucket disk_;
+    std::string foreground_dir_;
+    WarmupSchedulerStats stats_;
+};
+
+} // namespace Paker
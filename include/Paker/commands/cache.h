@@ -14,6 +14,7 @@ int pm_cache_stats();
 int pm_cache_status();
 int pm_cache_optimize();
 int pm_cache_migrate(const std::string& project_path = "");
+int pm_cache_link_mode(const std::string& mode = "");
 
 // 缓存配置命令
 int pm_cache_config_set(const std::string& key, const std::string& value);
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace Paker {
+
+// 守护进程管理命令
+void pm_daemon_start(bool foreground, int idle_timeout_minutes);
+void pm_daemon_stop();
+void pm_daemon_status();
+
+// 转发命令前调用：工作目录换到另一个工程时，丢弃绑定在旧工程上的服务（解析器、缓存、历史等）
+void prepare_daemon_project_services();
+
+} // namespace Paker
@@ -12,5 +12,7 @@ void pm_incremental_parse_config();
 void pm_incremental_parse_clear_cache();
 void pm_incremental_parse_optimize();
 void pm_incremental_parse_validate();
+// 监视清单与 packages/，有变化时只重新解析变化的包，直到被中断
+void pm_incremental_parse_watch(int interval_ms = 500);
 
 } // namespace Paker
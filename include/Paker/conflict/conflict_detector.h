@@ -2,17 +2,30 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <memory_resource>
 #include "dependency/dependency_graph.h"
+#include "dependency/csr_dependency_graph.h"
 
 namespace Paker {
 
 // 冲突检测器
 class ConflictDetector {
+public:
+    // 版本 -> 提出该要求的直接依赖者；在命令 arena 上分配，随解析过程一起释放
+    using VersionRequirements = std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>>;
+    
 private:
     const DependencyGraph& graph_;
     
+    // 每个冲突版本最多给出的解释路径数
+    size_t max_explanation_paths_;
+    
 public:
-    explicit ConflictDetector(const DependencyGraph& graph);
+    explicit ConflictDetector(const DependencyGraph& graph, size_t max_explanation_paths = 3);
+    
+    void set_max_explanation_paths(size_t count) { max_explanation_paths_ = count; }
+    size_t get_max_explanation_paths() const { return max_explanation_paths_; }
     
     // 检测所有类型的冲突
     std::vector<ConflictInfo> detect_all_conflicts();
@@ -39,6 +52,16 @@ private:
     // 计算路径中要求的版本
     std::string calculate_required_version(const std::vector<std::string>& path) const;
     
+    // 收集包的版本要求：版本 -> 提出该要求的直接依赖者
+    // 版本要求只取决于路径最后一跳，因此无需枚举全部路径
+    VersionRequirements collect_version_requirements(const CSRDependencyGraph& csr,
+                                                     const std::string& package) const;
+    
+    // 为某个版本要求生成从根包出发的最短依赖路径
+    std::vector<std::vector<std::string>> explain_requirement(const CSRDependencyGraph& csr,
+                                                              const std::pmr::vector<std::pmr::string>& requesters,
+                                                              const std::string& package) const;
+    
     // 检查版本兼容性
     bool is_version_compatible(const std::string& version1, const std::string& version2) const;
     
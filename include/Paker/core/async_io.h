@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Paker/common.h"
+#include "Paker/core/io_uring_engine.h"
+#include "Paker/core/task.h"
 #include <future>
 #include <queue>
 #include <condition_variable>
@@ -10,6 +12,10 @@
 
 namespace Paker {
 
+// 预取模型属于缓存层，这里只持有指针，避免核心头文件依赖缓存头文件
+class PrefetchModel;
+struct PrefetchCandidate;
+
 // I/O操作类型
 enum class IOOperationType {
     READ_FILE,
@@ -20,7 +26,8 @@ enum class IOOperationType {
     MOVE_FILE,
     CREATE_DIRECTORY,
     NETWORK_DOWNLOAD,
-    NETWORK_UPLOAD
+    NETWORK_UPLOAD,
+    USER_CALLBACK
 };
 
 // I/O操作状态
@@ -89,11 +96,32 @@ public:
     using ProgressCallback = std::function<void(size_t current, size_t total)>;
     void set_progress_callback(ProgressCallback callback) { progress_callback_ = callback; }
     
+    // 完成回调：无论成功、失败还是取消，执行结束后由工作线程调用一次
+    using CompletionCallback = std::function<void()>;
+    void set_completion_callback(CompletionCallback callback) { completion_callback_ = std::move(callback); }
+    void notify_completion() {
+        if (completion_callback_) {
+            auto callback = std::move(completion_callback_);
+            completion_callback_ = nullptr;
+            callback();
+        }
+    }
+    // 未执行就被移出队列：标记取消并通知等待者，回调持有的引用随之释放
+    void abandon() {
+        cancelled_ = true;
+        if (error_message_.empty()) {
+            error_message_ = "Operation cancelled before execution";
+        }
+        status_ = IOOperationStatus::CANCELLED;
+        notify_completion();
+    }
+    
 protected:
     std::atomic<IOOperationStatus> status_{IOOperationStatus::PENDING};
     std::string error_message_;
     std::chrono::milliseconds duration_{0};
     ProgressCallback progress_callback_;
+    CompletionCallback completion_callback_;
     std::atomic<bool> cancelled_{false};
     
     void set_status(IOOperationStatus status) { status_ = status; }
@@ -106,6 +134,19 @@ public:
     }
 };
 
+// 取出操作结果并以操作状态为准回填：部分失败路径提前返回，不会自己写结果状态
+template<typename Operation>
+auto take_operation_result(const Operation& operation) {
+    auto result = operation.get_result();
+    if (result && result->status != operation.get_status()) {
+        result->status = operation.get_status();
+        if (result->error_message.empty()) {
+            result->error_message = operation.get_error_message();
+        }
+    }
+    return result;
+}
+
 // 异步文件读取操作
 class AsyncFileReadOperation : public AsyncIOOperation {
 private:
@@ -163,6 +204,39 @@ public:
     std::shared_ptr<NetworkDownloadResult> get_result() const { return result_; }
 };
 
+// 批量文件读取操作
+// 整批文件由一个工作线程通过 io_uring 提交，每个文件仍有独立的 future
+class AsyncBatchReadOperation : public AsyncIOOperation {
+private:
+    std::vector<std::string> file_paths_;
+    std::vector<std::promise<std::shared_ptr<FileReadResult>>> promises_;
+    bool read_as_text_;
+    
+public:
+    AsyncBatchReadOperation(std::vector<std::string> file_paths, bool read_as_text = true);
+    
+    IOOperationType get_type() const override { return IOOperationType::READ_FILE; }
+    std::string get_description() const override;
+    void execute() override;
+    void cancel() override;
+    
+    std::vector<std::future<std::shared_ptr<FileReadResult>>> get_futures();
+};
+
+// 在工作线程上执行任意函数，供协程执行器切换线程
+class AsyncCallbackOperation : public AsyncIOOperation {
+private:
+    std::function<void()> function_;
+    
+public:
+    explicit AsyncCallbackOperation(std::function<void()> function) : function_(std::move(function)) {}
+    
+    IOOperationType get_type() const override { return IOOperationType::USER_CALLBACK; }
+    std::string get_description() const override { return "Callback"; }
+    void execute() override;
+    void cancel() override { cancelled_ = true; }
+};
+
 // 缓冲区类型
 enum class BufferType {
     FILE_READ,
@@ -290,14 +364,23 @@ private:
     };
     std::map<std::string, PackageUsageInfo> package_frequency_;
     
+    // 由请求记录训练的转移/关联模型，以及本会话已使用的包
+    std::unique_ptr<PrefetchModel> model_;
+    std::vector<std::string> session_context_;
+    
 public:
     PredictivePreloadStrategy(double confidence_threshold = 0.7,
                              size_t max_predictions = 10,
                              double freq_weight = 0.4,
                              double rec_weight = 0.3,
                              double dep_weight = 0.3);
+    ~PredictivePreloadStrategy();
     
     void record_package_usage(const std::string& package_name);
+    // 加载 dir 下保存的模型并学习其后新增的请求记录，dir 为空时使用 get_prefetch_dir()
+    bool load_model(const std::string& dir = "");
+    // 根据本会话已使用的包预测接下来的请求
+    std::vector<PrefetchCandidate> predict_next() const;
     void update_dependency_graph(const std::string& package, const std::vector<std::string>& dependencies);
     std::vector<DependencyPrediction> predict_dependencies(const std::string& package_name) const;
     void preload_predicted_packages();
@@ -495,6 +578,7 @@ private:
     std::atomic<bool> running_{false};
     std::atomic<size_t> active_operations_count_{0};
     size_t max_concurrent_operations_;
+    std::atomic<int> io_backend_override_{-1};  // -1 表示跟随进程级默认后端
     
     // 统计信息
     std::atomic<size_t> total_operations_{0};
@@ -553,6 +637,8 @@ private:
     // 内部方法
     void worker_thread_function();
     void process_operation(std::shared_ptr<AsyncIOOperation> operation);
+    // 取消队列中尚未执行的操作并逐个通知完成
+    void abandon_queued_operations();
     
     // 缓冲区管理
     std::vector<char> get_optimal_buffer(BufferType type, size_t preferred_size = 0);
@@ -607,9 +693,29 @@ public:
     std::vector<std::future<std::shared_ptr<FileWriteResult>>> write_files_async(
         const std::vector<std::pair<std::string, std::string>>& file_contents);
     
+    // 提交任意操作，结束后调用其完成回调；管理器未运行时在调用线程上直接执行
+    void submit_operation(std::shared_ptr<AsyncIOOperation> operation);
+    // 在工作线程上执行函数
+    void post(std::function<void()> function);
+    
+#if defined(PAKER_HAVE_COROUTINES)
+    // 协程接口：co_await 时提交操作，完成后直接在工作线程上恢复调用者，不阻塞任何线程
+    task<std::shared_ptr<FileReadResult>> read_file_task(std::string file_path, bool read_as_text = true);
+    task<std::shared_ptr<FileWriteResult>> write_file_task(std::string file_path, std::string content);
+    task<std::shared_ptr<FileWriteResult>> write_file_task(std::string file_path, std::vector<char> data);
+    task<std::shared_ptr<NetworkDownloadResult>> download_task(std::string url, std::string local_path = "");
+#endif
+    
     // 配置管理
     void set_max_concurrent_operations(size_t max_concurrent);
     size_t get_max_concurrent_operations() const { return max_concurrent_operations_; }
+    // 批量读取的后端：io_uring 时整批只占用少量工作线程
+    // 未显式设置时每次操作都读取 default_io_backend()，守护进程中随每条命令的 --io-backend 变化
+    void set_io_backend(IOBackend backend) { io_backend_override_ = static_cast<int>(backend); }
+    IOBackend get_io_backend() const {
+        int value = io_backend_override_.load();
+        return value < 0 ? default_io_backend() : static_cast<IOBackend>(value);
+    }
     
     // 统计信息
     size_t get_total_operations() const { return total_operations_; }
@@ -625,6 +731,7 @@ public:
     
     // 队列管理
     size_t get_queue_size() const;
+    // 两者都取消尚未执行的操作，等待中的 future 和协程收到 CANCELLED 结果
     void clear_queue();
     void cancel_all_operations();
     
@@ -707,6 +814,34 @@ public:
         AsyncIOManager& manager, const std::string& file_path);
 };
 
+#if defined(PAKER_HAVE_COROUTINES)
+// 绑定到 AsyncIOManager 工作线程的协程执行器
+class IOExecutor {
+public:
+    explicit IOExecutor(AsyncIOManager& manager) : manager_(manager) {}
+    
+    // co_await executor.schedule() 把当前协程切换到工作线程上继续执行
+    struct ScheduleAwaiter {
+        AsyncIOManager& manager;
+        
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            manager.post([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{manager_}; }
+    
+    // 在工作线程上启动任务，不等待结果；任务抛出的异常记录日志后丢弃
+    void spawn(task<void> work);
+    
+    AsyncIOManager& get_manager() const { return manager_; }
+    
+private:
+    AsyncIOManager& manager_;
+};
+#endif
+
 // 全局异步I/O管理器实例
 extern std::unique_ptr<AsyncIOManager> g_async_io_manager;
 
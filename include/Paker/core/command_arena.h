@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace Paker {
+
+// 命令级 arena 的统计
+struct ArenaStats {
+    size_t allocation_count = 0;      // 从 arena 分配的次数
+    size_t bytes_requested = 0;       // 请求的总字节数
+    size_t peak_bytes = 0;            // arena 向上游申请的内存峰值
+    size_t upstream_allocations = 0;  // 向上游申请的块数
+};
+
+// 计数包装：转发给上游资源，并统计分配次数、字节数和在用峰值
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    size_t allocation_count() const { return allocation_count_; }
+    size_t bytes_requested() const { return bytes_requested_; }
+    size_t bytes_in_use() const { return bytes_in_use_; }
+    size_t peak_bytes() const { return peak_bytes_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource* upstream_;
+    size_t allocation_count_ = 0;
+    size_t bytes_requested_ = 0;
+    size_t bytes_in_use_ = 0;
+    size_t peak_bytes_ = 0;
+};
+
+// 单次解析/冲突检测过程使用的单调 arena
+// 解析器、增量解析器与冲突检测的临时字符串、列表与映射通过 current_arena_resource() 从这里分配，
+// 逐个释放是空操作。依赖图的节点与边集合会写入图快照、在守护进程中跨命令复用，
+// 解析缓存同样跨过程存活，二者都比 arena 活得久，和 JSON 文档一样留在普通堆上。
+// arena 析构时整体归还上游。arena 不是线程安全的，只在创建它的线程上通过 ArenaScope 使用。
+class CommandArena {
+public:
+    explicit CommandArena(std::string name, size_t initial_size = 64 * 1024,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~CommandArena();
+    CommandArena(const CommandArena&) = delete;
+    CommandArena& operator=(const CommandArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &counter_; }
+    const std::string& name() const { return name_; }
+    ArenaStats get_stats() const;
+
+    // 命令结束时输出统计（--arena-stats）
+    static void set_reporting_enabled(bool enabled);
+    static bool is_reporting_enabled();
+
+private:
+    std::string name_;
+    CountingMemoryResource upstream_counter_;
+    std::pmr::monotonic_buffer_resource monotonic_;
+    CountingMemoryResource counter_;
+};
+
+// 在当前线程上启用 arena，作用域结束时恢复之前的 arena（可嵌套）
+class ArenaScope {
+public:
+    explicit ArenaScope(CommandArena& arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    CommandArena* previous_;
+};
+
+// 当前线程的 arena；没有启用时为 nullptr
+CommandArena* current_arena();
+
+// 供解析过程的临时容器使用：启用了 arena 时返回 arena，否则返回默认资源
+std::pmr::memory_resource* current_arena_resource();
+
+} // namespace Paker
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+namespace Paker {
+
+// 内容哈希：缓存存储、清单监视等各层共用的 SHA-256 实现
+
+// 流式计算文件内容的 SHA-256（十六进制），失败返回空串
+std::string sha256_file(const std::string& path);
+// 内存数据的 SHA-256（十六进制），失败返回空串
+std::string sha256_data(const std::string& data);
+
+} // namespace Paker
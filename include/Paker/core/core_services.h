@@ -124,10 +124,13 @@ public:
     static std::shared_ptr<IncrementalUpdaterService> create_incremental_updater_service();
     static std::shared_ptr<CacheWarmupServiceWrapper> create_cache_warmup_service();
     
-    // 注册所有核心服务
+    // 注册所有核心服务（延迟创建，首次访问时按依赖顺序初始化）
     static bool register_all_core_services();
 };
 
+// 启动耗时报告（paker --startup-profile）
+void print_startup_profile();
+
 // 便捷的访问函数
 DependencyResolver* get_dependency_resolver();
 DependencyGraph* get_dependency_graph();
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+namespace Paker {
+
+// 常驻守护进程
+// 每个用户一个实例，通过 Unix 域套接字接收 CLI 请求。服务（缓存管理器、增量解析器、
+// 依赖解析器、网络连接池等）只在守护进程启动时初始化一次，之后的命令复用热状态。
+// 客户端通过 SCM_RIGHTS 把自己的 stdin/stdout/stderr 交给守护进程，命令执行期间
+// 守护进程将其 dup2 到 0/1/2，输出直接流向客户端终端（isatty 等行为保持不变）。
+// 请求串行处理：chdir 与标准描述符重定向都是进程级状态。
+
+// 套接字路径：$PAKER_DAEMON_SOCKET，否则 $XDG_RUNTIME_DIR/paker-<uid>.sock，
+// 否则 /tmp/paker-<uid>/daemon.sock（目录权限 0700）
+std::string get_daemon_socket_path();
+
+// 守护进程状态
+struct DaemonStatus {
+    bool running = false;
+    int64_t pid = 0;
+    uint64_t requests_served = 0;
+    std::chrono::seconds uptime{0};
+    std::string socket_path;
+};
+
+class DaemonServer {
+public:
+    // 在守护进程内执行一条命令；args 不含程序名，返回退出码
+    using CommandHandler = std::function<int(const std::vector<std::string>& args)>;
+
+    DaemonServer(CommandHandler handler, const std::string& socket_path = get_daemon_socket_path());
+    ~DaemonServer();
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    // 绑定套接字；已有存活的守护进程时返回 false
+    bool bind();
+    // 进入服务循环，直到收到 stop 请求、request_stop() 或空闲超时
+    void run();
+    void request_stop() { stop_requested_ = true; }
+
+    void set_idle_timeout(std::chrono::seconds timeout) { idle_timeout_ = timeout; }
+    uint64_t get_requests_served() const { return requests_served_.load(); }
+    const std::string& get_socket_path() const { return socket_path_; }
+
+private:
+    void handle_connection(int client_fd);
+    int execute(const std::vector<std::string>& args, const std::string& cwd, const int fds[3]);
+    void close_socket();
+
+    CommandHandler handler_;
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<uint64_t> requests_served_{0};
+    std::chrono::seconds idle_timeout_{std::chrono::minutes(30)};
+    std::chrono::steady_clock::time_point started_at_;
+};
+
+class DaemonClient {
+public:
+    explicit DaemonClient(const std::string& socket_path = get_daemon_socket_path());
+
+    // 守护进程是否在监听
+    bool is_available() const;
+
+    // 转发命令；连接失败、套接字目录或对端不属于当前用户时返回 false（调用方应回退到进程内执行），
+    // 成功时 exit_code 为命令在守护进程中的退出码
+    bool forward(const std::vector<std::string>& args, int& exit_code,
+                 int in_fd = 0, int out_fd = 1, int err_fd = 2) const;
+
+    bool stop() const;
+    DaemonStatus status() const;
+
+    // 判断命令行是否适合转发（守护进程管理命令、--watch 等总在本进程执行；
+    // 设置 PAKER_NO_DAEMON 时不转发）
+    static bool should_forward(int argc, char* argv[]);
+
+    // main 入口使用：可转发且守护进程可用时转发并返回 true
+    static bool try_forward(int argc, char* argv[], int& exit_code);
+
+private:
+    int connect_socket() const;
+    // 发送控制请求并读取应答（stop/status）
+    bool call(const std::string& payload, std::string& response) const;
+
+    std::string socket_path_;
+};
+
+// 以后台进程启动守护进程（fork + setsid）；on_ready 在子进程绑定套接字后执行（用于预热服务），
+// 父进程等到子进程绑定成功或失败后返回
+bool spawn_daemon(const DaemonServer::CommandHandler& handler, std::chrono::seconds idle_timeout,
+                  const std::function<void()>& on_ready = nullptr);
+
+} // namespace Paker
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Paker/core/version_history.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paker {
+
+// 历史日志的汇总信息，由索引直接得出，不读取记录
+struct HistoryLogStats {
+    size_t entries = 0;
+    size_t packages = 0;
+    size_t rollbacks = 0;
+    size_t segments = 0;
+    size_t backup_bytes = 0;
+    std::chrono::system_clock::time_point first;
+    std::chrono::system_clock::time_point last;
+};
+
+// 只追加的分段版本历史
+// 布局：<dir>/segment-000001.log 每行一条 JSON 记录；写满 segment_capacity 条后封存，
+// 并写出二进制索引 segment-000001.idx（时间、包名、偏移、长度），之后新记录写入下一段。
+// 打开时只读取各封存段的索引和活动段本身，内存中维护按时间和按包排序的位置表，
+// 查询先二分定位再按偏移读取所需的记录。受影响文件列表压缩后按内容存为 <dir>/files/<ref>.z，
+// 记录中只保存引用，相同的列表只存一份。清理旧记录时写入保留起点 <dir>/retention，整段过期的段直接删除。
+// 多个进程可以同时写同一目录：打开、追加、封存和清理都持有 <dir>/lock，持锁后先并入其他进程的改动；
+// 查询只读本进程的内存索引，看不到打开之后其他进程追加的记录。
+class HistoryLog {
+public:
+    explicit HistoryLog(const std::string& dir, size_t segment_capacity = 4096);
+    ~HistoryLog();
+
+    HistoryLog(const HistoryLog&) = delete;
+    HistoryLog& operator=(const HistoryLog&) = delete;
+
+    bool open();
+
+    // 追加一条记录；entry.affected_files 非空时写入文件列表并回填 entry.affected_files_ref
+    bool append(VersionHistoryEntry& entry);
+
+    size_t size() const { return by_time_.size(); }
+    bool empty() const { return by_time_.empty(); }
+    std::vector<std::string> packages() const;
+
+    // 包的历史，按时间先后；limit 非零时只返回最新的 limit 条
+    std::vector<VersionHistoryEntry> package_history(const std::string& package, size_t limit = 0) const;
+    std::vector<VersionHistoryEntry> recent(size_t count) const;
+    // [from, to] 时间段内的记录
+    std::vector<VersionHistoryEntry> range(const std::chrono::system_clock::time_point& from,
+                                           const std::chrono::system_clock::time_point& to) const;
+    // 不晚于 timestamp 的最新一条记录，package 为空时不限包
+    bool find_at_or_before(const std::chrono::system_clock::time_point& timestamp, VersionHistoryEntry& entry,
+                           const std::string& package = "") const;
+    // 按时间顺序逐条读取，回调返回 false 时停止
+    void for_each(const std::function<bool(const VersionHistoryEntry&)>& visit) const;
+
+    // 读取记录引用的受影响文件列表
+    std::vector<std::string> load_affected_files(const VersionHistoryEntry& entry) const;
+
+    HistoryLogStats stats() const;
+
+    // 只保留最新追加的 keep 条记录，返回删除的条数；dropped 收集被删记录本身
+    size_t retain_latest(size_t keep, std::vector<VersionHistoryEntry>* dropped = nullptr);
+
+    const std::string& get_dir() const { return dir_; }
+
+private:
+    // 记录在段文件中的位置及用于过滤的字段
+    struct Location {
+        uint64_t seq = 0;
+        int64_t ts_ms = 0;
+        uint32_t segment = 0;
+        uint32_t length = 0;
+        uint64_t offset = 0;
+        uint32_t package = 0;
+        uint32_t files = 0;         // 文件列表引用编号，0 表示没有
+        bool rollback = false;
+        uint64_t backup_size = 0;
+    };
+
+    struct Segment {
+        uint64_t first_seq = 0;
+        uint64_t last_seq = 0;
+        size_t records = 0;
+        uint64_t bytes = 0;
+    };
+
+    std::string segment_path(uint32_t segment, const char* extension) const;
+    std::vector<uint32_t> list_segments() const;
+    bool load();
+    void reset();
+    // 持有目录锁时调用：读入其他进程追加的尾部和新开的段，历史被清理过时整体重新加载
+    bool refresh();
+    bool load_segment(uint32_t segment, bool sealed);
+    // 从 from 字节处开始扫描段文件
+    bool scan_segment(uint32_t segment, uint64_t from, std::vector<Location>& locations);
+    void add_locations(uint32_t segment, const std::vector<Location>& locations);
+    bool write_index(uint32_t segment) const;
+    bool seal_active();
+    bool open_active();
+    void insert(const Location& location);
+    bool read(const Location& location, VersionHistoryEntry& entry, std::map<uint32_t, int>& fds) const;
+    std::vector<VersionHistoryEntry> read_all(const std::vector<const Location*>& locations) const;
+    uint32_t intern_package(const std::string& package);
+    uint32_t intern_files(const std::string& ref);
+    std::string store_files(const std::vector<std::string>& files);
+    bool save_retention() const;
+
+    std::string dir_;
+    size_t segment_capacity_;
+    uint64_t next_seq_;
+    uint64_t first_seq_;            // 保留起点，之前的记录视为已删除
+
+    std::map<uint32_t, Segment> segments_;
+    uint32_t active_segment_;
+    int active_fd_;
+
+    std::vector<Location> by_time_;                     // 按 (时间, 序号) 排序
+    std::vector<std::vector<Location>> by_package_;     // 下标为包编号，排序同上
+    std::vector<std::string> package_names_;
+    std::unordered_map<std::string, uint32_t> package_ids_;
+    std::vector<std::string> file_refs_;                // 下标 0 保留
+    std::unordered_map<std::string, uint32_t> file_ref_ids_;
+    size_t rollbacks_;
+    uint64_t backup_bytes_;
+};
+
+} // namespace Paker
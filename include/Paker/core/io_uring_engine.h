@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Paker {
+
+// 批量文件 I/O 后端
+enum class IOBackend {
+    AUTO,         // io_uring 可用时使用，否则退回线程池
+    IO_URING,     // 强制 io_uring；不可用时仍退回线程池并记录警告
+    THREAD_POOL   // 原有的 OpenMP / 工作线程阻塞 I/O
+};
+
+// 解析 "auto" / "io_uring" / "threads"，无法识别时返回 AUTO
+IOBackend parse_io_backend(const std::string& name);
+const char* io_backend_name(IOBackend backend);
+
+// 进程级默认后端，初始值取自环境变量 PAKER_IO_BACKEND
+IOBackend default_io_backend();
+void set_default_io_backend(IOBackend backend);
+
+// 在作用域内覆盖进程级默认后端，离开时恢复原值；守护进程里每条命令各自生效
+class ScopedIOBackend {
+public:
+    ScopedIOBackend() : previous_(default_io_backend()) {}
+    explicit ScopedIOBackend(IOBackend backend) : ScopedIOBackend() { set_default_io_backend(backend); }
+    ~ScopedIOBackend() { set_default_io_backend(previous_); }
+    ScopedIOBackend(const ScopedIOBackend&) = delete;
+    ScopedIOBackend& operator=(const ScopedIOBackend&) = delete;
+
+private:
+    IOBackend previous_;
+};
+
+// 按给定后端与运行环境决定批量操作是否走 io_uring
+bool should_use_io_uring(IOBackend backend);
+
+// 单个文件的读取结果
+struct IoUringReadResult {
+    bool success = false;
+    int error = 0;          // 失败时的 errno
+    std::string data;
+};
+
+// 引擎统计
+struct IoUringStats {
+    size_t submit_calls = 0;        // io_uring_enter 调用次数
+    size_t sqes_submitted = 0;
+    size_t files_read = 0;
+    size_t files_written = 0;
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    size_t fixed_buffer_reads = 0;  // 直接读入注册缓冲区的次数
+    size_t fallback_operations = 0; // 超出单轮缓冲区、在调用线程上同步补完的文件数
+    size_t files_synced = 0;        // 写入后 fdatasync 的文件数
+};
+
+// 基于 io_uring 的批量文件引擎
+// 每个文件提交一条 open -> read/write -> close 链接请求，打开结果直接放入注册文件表，
+// 读取优先使用注册缓冲区；一轮最多 kSlotCount 条链，整轮一次 io_uring_enter 提交并收割。
+// 直接使用系统调用，不依赖 liburing。引擎不是线程安全的，每个线程使用自己的实例。
+class IoUringEngine {
+public:
+    static constexpr unsigned kSlotCount = 64;
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    IoUringEngine();
+    ~IoUringEngine();
+
+    IoUringEngine(const IoUringEngine&) = delete;
+    IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+    // 内核是否支持所需特性（进程内只探测一次）
+    static bool is_supported();
+    bool is_ready() const { return ring_ != nullptr; }
+
+    // 当前线程的引擎；不支持时返回 nullptr
+    static IoUringEngine* for_current_thread();
+
+    // 结果与输入一一对应；大于 kBufferSize 的文件在首轮读完前缀后同步补读剩余部分
+    std::vector<IoUringReadResult> read_files(const std::vector<std::string>& paths);
+
+    // 截断写入，必要时先创建父目录；sync 时每条链在 write 与 close 之间加一个 fdatasync（IORING_OP_FSYNC），
+    // 刷写与写入在同一轮提交中完成，刷写失败的文件视为写入失败
+    std::vector<bool> write_files(const std::vector<std::pair<std::string, std::string_view>>& files,
+                                  bool sync = false);
+
+    // 小文件经环读入后再写出；超出单轮缓冲区的文件交给 FileMaterializer::copy_file
+    std::vector<bool> copy_files(const std::vector<std::pair<std::string, std::string>>& source_dest_pairs);
+
+    const IoUringStats& get_stats() const { return stats_; }
+
+private:
+    struct Ring;
+
+    // 提交已准备的请求并等待全部完成，results 按 (槽位, 操作序号) 存放 CQE 结果
+    void submit_and_wait(std::vector<int>& results);
+
+    std::unique_ptr<Ring> ring_;
+    IoUringStats stats_;
+};
+
+} // namespace Paker
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Paker/common.h"
+#include "Paker/core/slab_allocator.h"
 #include <unordered_map>
+#include <condition_variable>
 
 namespace Paker {
 
@@ -50,18 +52,23 @@ private:
     size_t large_block_size_;
     size_t huge_block_size_;
     
-    // 内存块管理
-    std::vector<MemoryBlock> memory_blocks_;
-    std::unordered_map<size_t, std::vector<size_t>> free_blocks_by_size_;
-    std::unordered_map<MemoryBlockType, std::vector<size_t>> free_blocks_by_type_;
+    // 块的分配与回收交给线程本地的 slab 分配器，池本身只记账，不再加全局锁
+    SlabAllocator& allocator_;
     
     // 统计信息
-    MemoryPoolStats stats_;
-    
-    // 线程安全
+    std::atomic<size_t> total_allocated_;
+    std::atomic<size_t> total_freed_;
+    std::atomic<size_t> current_usage_;
+    std::atomic<size_t> peak_usage_;
+    std::atomic<size_t> allocation_count_;
+    std::atomic<size_t> free_count_;
+    std::chrono::steady_clock::time_point last_cleanup_;
+    
+    // 线程安全（保护预分配配置和清理时间）
     mutable std::mutex pool_mutex_;
     std::atomic<bool> cleanup_enabled_;
     std::thread cleanup_thread_;
+    std::condition_variable cleanup_cv_;
     
     // 内存预分配
     std::unordered_map<MemoryBlockType, size_t> preallocated_blocks_;
@@ -69,9 +76,6 @@ private:
     
     // 内部方法
     MemoryBlockType get_block_type(size_t size) const;
-    size_t find_free_block(size_t size, MemoryBlockType type);
-    void* allocate_block(size_t size, MemoryBlockType type);
-    void deallocate_block(void* ptr);
     void cleanup_unused_blocks();
     void preallocate_blocks();
     void update_statistics(size_t allocated_size, bool is_allocation);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Paker/common.h"
+#include "Paker/core/io_uring_engine.h"
 #include <omp.h>
 #include <filesystem>
 #include <vector>
@@ -106,6 +107,18 @@ public:
      */
     void set_thread_count(int thread_count);
     
+    /**
+     * @brief 设置批量读写/复制使用的I/O后端
+     * @param backend AUTO 时在 io_uring 可用的情况下使用 io_uring，否则使用 OpenMP 线程
+     */
+    void set_io_backend(IOBackend backend);
+    
+    /**
+     * @brief 获取I/O后端设置
+     * @return 显式设置的后端；未设置时为当前的进程级默认后端
+     */
+    IOBackend get_io_backend() const;
+    
     /**
      * @brief 获取性能统计信息
      * @return 性能统计信息
@@ -128,6 +141,7 @@ public:
 
 private:
     int max_threads_;
+    int io_backend_override_ = -1;  // -1 表示每次操作读取 default_io_backend()
     mutable std::mutex stats_mutex_;
     PerformanceStats stats_;
     
@@ -150,6 +164,23 @@ private:
     bool write_single_text_file(const std::string& file_path, const std::string& content);
     bool write_single_binary_file(const std::string& file_path, const std::vector<char>& data);
     
+    /**
+     * @brief 复制单个文件，必要时先创建目标目录
+     * @param source 源文件路径
+     * @param dest 目标文件路径
+     * @return 复制是否成功
+     */
+    bool copy_single_file(const std::string& source, const std::string& dest);
+    
+    /**
+     * @brief 按 io_uring 单轮缓冲区大小划分文件
+     * @param file_paths 文件路径
+     * @param small 能在一轮内读完的文件下标（含 stat 失败的，由引擎报告错误）
+     * @param large 其余文件下标，交给 OpenMP 线程并行处理
+     */
+    static void split_by_ring_buffer(const std::vector<std::string>& file_paths,
+                                     std::vector<size_t>& small, std::vector<size_t>& large);
+    
     /**
      * @brief 更新性能统计
      * @param operation_time 操作时间（毫秒）
@@ -158,6 +189,12 @@ private:
      */
     void update_stats(double operation_time, bool success, size_t data_size = 0);
     
+    /**
+     * @brief 获取批量操作使用的 io_uring 引擎
+     * @return 当前线程的引擎；后端为线程池或 io_uring 不可用时返回 nullptr
+     */
+    IoUringEngine* batch_engine() const;
+    
     /**
      * @brief 计算文件哈希值
      * @param file_path 文件路径
@@ -89,6 +89,8 @@ public:
 class ParallelExecutor {
 private:
     std::vector<std::thread> workers_;
+    std::mutex workers_mutex_;
+    std::atomic<bool> started_;
     std::queue<std::shared_ptr<Task>> task_queue_;
     mutable std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
@@ -149,6 +151,8 @@ private:
     void adjust_worker_count();
     
 private:
+    // 首个任务到达时才创建工作线程
+    void ensure_workers();
     void worker_loop();
     void process_task(std::shared_ptr<Task> task);
 };
@@ -7,6 +7,8 @@
 #include <mutex>
 #include <functional>
 #include <string>
+#include <vector>
+#include <chrono>
 #include <glog/logging.h>
 
 namespace Paker {
@@ -17,16 +19,27 @@ public:
     virtual ~IServiceContainer() = default;
     virtual void register_singleton(const std::type_index& type, std::shared_ptr<void> instance) = 0;
     virtual void register_factory(const std::type_index& type, std::function<std::shared_ptr<void>()> factory) = 0;
+    // 延迟单例：首次 get 时调用工厂创建，之后一直复用同一实例
+    virtual void register_lazy_singleton(const std::type_index& type, std::function<std::shared_ptr<void>()> factory) = 0;
     virtual std::shared_ptr<void> get(const std::type_index& type) = 0;
     virtual bool has(const std::type_index& type) const = 0;
+    // 丢弃已创建的延迟单例，下次 get 时重新调用工厂
+    virtual void reset(const std::type_index& type) = 0;
     virtual void clear() = 0;
 };
 
 // 服务容器实现
 class ServiceContainer : public IServiceContainer {
 private:
+    struct LazyEntry {
+        std::function<std::shared_ptr<void>()> factory;
+        std::mutex mutex;   // 串行化创建；工厂抛异常或返回空时不记录结果，下次 get 重试
+        std::shared_ptr<void> instance;
+    };
+
     std::unordered_map<std::type_index, std::shared_ptr<void>> singletons_;
     std::unordered_map<std::type_index, std::function<std::shared_ptr<void>()>> factories_;
+    std::unordered_map<std::type_index, std::shared_ptr<LazyEntry>> lazy_singletons_;
     mutable std::mutex mutex_;
 
 public:
@@ -42,8 +55,16 @@ public:
         LOG(INFO) << "Registered factory service: " << type.name();
     }
 
-    std::shared_ptr<void> get(const std::type_index& type) override {
+    void register_lazy_singleton(const std::type_index& type, std::function<std::shared_ptr<void>()> factory) override {
         std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = std::make_shared<LazyEntry>();
+        entry->factory = std::move(factory);
+        lazy_singletons_[type] = entry;
+        LOG(INFO) << "Registered lazy singleton service: " << type.name();
+    }
+
+    std::shared_ptr<void> get(const std::type_index& type) override {
+        std::unique_lock<std::mutex> lock(mutex_);
         
         // 首先检查单例
         auto singleton_it = singletons_.find(type);
@@ -51,6 +72,26 @@ public:
             return singleton_it->second;
         }
         
+        // 延迟单例：解锁后创建，工厂内部可以继续解析自己的依赖
+        auto lazy_it = lazy_singletons_.find(type);
+        if (lazy_it != lazy_singletons_.end()) {
+            auto entry = lazy_it->second;
+            lock.unlock();
+            std::shared_ptr<void> instance;
+            {
+                std::lock_guard<std::mutex> create_lock(entry->mutex);
+                if (!entry->instance) {
+                    entry->instance = entry->factory();
+                }
+                instance = entry->instance;
+            }
+            if (instance) {
+                lock.lock();
+                singletons_[type] = instance;
+            }
+            return instance;
+        }
+        
         // 然后检查工厂
         auto factory_it = factories_.find(type);
         if (factory_it != factories_.end()) {
@@ -66,13 +107,28 @@ public:
     bool has(const std::type_index& type) const override {
         std::lock_guard<std::mutex> lock(mutex_);
         return singletons_.find(type) != singletons_.end() || 
-               factories_.find(type) != factories_.end();
+               factories_.find(type) != factories_.end() ||
+               lazy_singletons_.find(type) != lazy_singletons_.end();
+    }
+
+    void reset(const std::type_index& type) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto lazy_it = lazy_singletons_.find(type);
+        if (lazy_it == lazy_singletons_.end()) {
+            return;
+        }
+        auto entry = std::make_shared<LazyEntry>();
+        entry->factory = lazy_it->second->factory;
+        lazy_it->second = entry;
+        singletons_.erase(type);
+        LOG(INFO) << "Reset lazy singleton service: " << type.name();
     }
 
     void clear() override {
         std::lock_guard<std::mutex> lock(mutex_);
         singletons_.clear();
         factories_.clear();
+        lazy_singletons_.clear();
         LOG(INFO) << "Service container cleared";
     }
 };
@@ -114,6 +170,13 @@ public:
             [factory]() -> std::shared_ptr<void> { return factory(); });
     }
 
+    template<typename T>
+    static void register_lazy_singleton(std::function<std::shared_ptr<T>()> factory) {
+        auto container = get_container();
+        container->register_lazy_singleton(std::type_index(typeid(T)),
+            [factory]() -> std::shared_ptr<void> { return factory(); });
+    }
+
     // 获取服务
     template<typename T>
     static std::shared_ptr<T> get() {
@@ -147,10 +210,19 @@ public:
     virtual std::string get_name() const = 0;
 };
 
+// 服务初始化耗时（构造 + initialize，不含依赖自身的耗时）
+struct ServiceInitRecord {
+    std::string name;
+    std::chrono::microseconds duration{0};
+    bool success = false;
+};
+
 // 服务管理器
 class ServiceManager {
 private:
-    std::vector<std::shared_ptr<IService>> services_;
+    std::vector<std::shared_ptr<IService>> services_;   // 已初始化的服务，按初始化顺序
+    std::vector<ServiceInitRecord> init_profile_;
+    size_t registered_count_ = 0;
     mutable std::mutex services_mutex_;
 
 public:
@@ -160,6 +232,7 @@ public:
         
         std::lock_guard<std::mutex> lock(services_mutex_);
         services_.push_back(service);
+        ++registered_count_;
         
         // 注册到服务容器
         ServiceLocator::register_singleton<T>(service);
@@ -167,11 +240,88 @@ public:
         LOG(INFO) << "Registered service: " << service->get_name();
     }
 
+    // 延迟注册：首次 ServiceLocator::get<T>() 时先解析 dependencies，再构造并初始化自身。
+    // 初始化顺序即依赖顺序，shutdown_all 逆序关闭；从未被请求的服务不会被创建
+    template<typename T>
+    void register_lazy_service(std::function<std::shared_ptr<T>()> factory,
+                               std::vector<std::type_index> dependencies = {}) {
+        static_assert(std::is_base_of_v<IService, T>, "Service must inherit from IService");
+        
+        {
+            std::lock_guard<std::mutex> lock(services_mutex_);
+            ++registered_count_;
+        }
+        
+        ServiceLocator::register_lazy_singleton<T>([this, factory, dependencies]() -> std::shared_ptr<T> {
+            for (const auto& dependency : dependencies) {
+                if (!ServiceLocator::get_container()->get(dependency)) {
+                    LOG(ERROR) << "Dependency " << dependency.name() << " unavailable for " << typeid(T).name();
+                    return nullptr;
+                }
+            }
+            
+            auto start = std::chrono::steady_clock::now();
+            std::shared_ptr<T> service = factory();
+            bool success = service && service->initialize();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            
+            std::lock_guard<std::mutex> lock(services_mutex_);
+            init_profile_.push_back({service ? service->get_name() : typeid(T).name(), duration, success});
+            if (!success) {
+                LOG(ERROR) << "Failed to initialize service: " << init_profile_.back().name;
+                return nullptr;
+            }
+            services_.push_back(service);
+            LOG(INFO) << "Lazily initialized service: " << service->get_name()
+                      << " in " << duration.count() << "us";
+            return service;
+        });
+    }
+
+    // 关闭已创建的延迟服务 T，下次取用时按注册的工厂重新创建和初始化
+    // （例如守护进程切换到另一个工程时重建与工程目录绑定的服务）
+    template<typename T>
+    void reset_service() {
+        std::shared_ptr<IService> service;
+        {
+            std::lock_guard<std::mutex> lock(services_mutex_);
+            for (auto it = services_.begin(); it != services_.end(); ++it) {
+                if (typeid(**it) == typeid(T)) {
+                    service = *it;
+                    services_.erase(it);
+                    break;
+                }
+            }
+        }
+        if (service) {
+            try {
+                service->shutdown();
+            } catch (const std::exception& e) {
+                LOG(ERROR) << "Exception during service shutdown: " << e.what();
+            }
+        }
+        ServiceLocator::get_container()->reset(std::type_index(typeid(T)));
+    }
+
     bool initialize_all() {
-        std::lock_guard<std::mutex> lock(services_mutex_);
+        // 不持锁调用 initialize，服务初始化时可能解析其他延迟服务
+        std::vector<std::shared_ptr<IService>> services;
+        {
+            std::lock_guard<std::mutex> lock(services_mutex_);
+            services = services_;
+        }
         
-        for (auto& service : services_) {
-            if (!service->initialize()) {
+        for (auto& service : services) {
+            auto start = std::chrono::steady_clock::now();
+            bool success = service->initialize();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            {
+                std::lock_guard<std::mutex> lock(services_mutex_);
+                init_profile_.push_back({service->get_name(), duration, success});
+            }
+            if (!success) {
                 LOG(ERROR) << "Failed to initialize service: " << service->get_name();
                 return false;
             }
@@ -182,10 +332,14 @@ public:
     }
 
     void shutdown_all() {
-        std::lock_guard<std::mutex> lock(services_mutex_);
+        std::vector<std::shared_ptr<IService>> services;
+        {
+            std::lock_guard<std::mutex> lock(services_mutex_);
+            services.swap(services_);
+        }
         
         // 逆序关闭服务
-        for (auto it = services_.rbegin(); it != services_.rend(); ++it) {
+        for (auto it = services.rbegin(); it != services.rend(); ++it) {
             try {
                 (*it)->shutdown();
             } catch (const std::exception& e) {
@@ -193,10 +347,20 @@ public:
             }
         }
         
-        services_.clear();
         LOG(INFO) << "All services shut down";
     }
 
+    // 已注册（含尚未创建的延迟服务）的数量
+    size_t get_registered_count() const {
+        std::lock_guard<std::mutex> lock(services_mutex_);
+        return registered_count_;
+    }
+
+    std::vector<ServiceInitRecord> get_init_profile() const {
+        std::lock_guard<std::mutex> lock(services_mutex_);
+        return init_profile_;
+    }
+
     std::vector<std::string> get_service_names() const {
         std::lock_guard<std::mutex> lock(services_mutex_);
         std::vector<std::string> names;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace Paker {
+
+// 线程本地、按尺寸分级的 slab 分配器
+// - 尺寸类为 16B ~ 8KB 的 2 的幂；更大的请求单独分配（带同样的块头）
+// - slab 是 64KB 对齐的内存块，块头记录尺寸类和空闲位图（两级：摘要字 + 位图字），
+//   释放时用指针掩码直接找到块头，分配时两次 ctz 找到空闲块，均为 O(1)
+// - 每个线程有自己的 slab 链表，本线程的分配和释放不加锁；其他线程释放的块压入
+//   slab 的无锁远程释放栈，由所属线程在 slab 用尽时批量收回
+// - 线程退出时仍有存活块的 slab 成为孤儿，之后由同尺寸类的其他线程接管
+struct SlabAllocatorStats {
+    // 计数由各线程批量汇总，是近似值
+    uint64_t allocation_count = 0;
+    uint64_t free_count = 0;
+    uint64_t remote_free_count = 0;
+    uint64_t large_allocation_count = 0;
+    size_t slabs_in_use = 0;        // 已分给线程（含孤儿）的 slab
+    size_t slabs_cached = 0;        // 全局缓存中的空闲 slab
+    size_t orphan_slabs = 0;
+    size_t large_bytes_in_use = 0;
+};
+
+class SlabAllocator {
+public:
+    static constexpr size_t kSlabSize = 64 * 1024;
+    static constexpr size_t kMinBlockSize = 16;
+    static constexpr size_t kMaxBlockSize = 8 * 1024;
+    static constexpr size_t kSizeClassCount = 10;
+    // 小块最多保证 64 字节对齐，更高的对齐要求走大块路径
+    static constexpr size_t kMaxSmallAlignment = 64;
+
+    // 进程级单例，从不析构（线程退出和静态析构期间仍可释放）
+    static SlabAllocator& instance();
+
+    // 分配至少 size 字节；alignment 须为 2 的幂且小于 kSlabSize，失败抛 std::bad_alloc
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    // 可以在任意线程释放。不是块起始地址或已空闲的块记录警告并忽略，返回 false；
+    // 跨线程释放的块在所属线程收回时才能检查是否重复释放
+    bool deallocate(void* ptr);
+    // 块的实际可用大小
+    size_t usable_size(const void* ptr) const;
+    // ptr（块起始地址）是否由本分配器分配；不属于本分配器的指针不能传给 deallocate / usable_size
+    bool owns(const void* ptr) const;
+
+    // 预先向全局缓存放入 slab_count 个空闲 slab
+    void reserve(size_t slab_count);
+    // 释放全局缓存中的空闲 slab，返回释放的数量
+    size_t trim();
+
+    // 汇总统计（会先把调用线程的计数合并进去）
+    SlabAllocatorStats get_statistics() const;
+
+    static size_t size_class_of(size_t size);
+    static size_t class_block_size(size_t size_class) { return kMinBlockSize << size_class; }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+private:
+    SlabAllocator() = default;
+    ~SlabAllocator() = default;
+};
+
+// std::pmr 适配器：解析器、依赖图和 I/O 层的 pmr 容器可以用它接入 slab 分配器
+class SlabMemoryResource : public std::pmr::memory_resource {
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+// 进程级共享的适配器实例
+std::pmr::memory_resource* get_slab_memory_resource();
+
+} // namespace Paker
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Paker {
+
+class BlobStore;
+
+// 快照中的一个条目
+struct SnapshotEntry {
+    enum class Type : uint8_t { FILE = 0, DIRECTORY = 1, SYMLINK = 2 };
+
+    std::string path;           // 相对包目录
+    Type type = Type::FILE;
+    std::string hash;           // 文件内容 SHA-256，即内容存储中的 blob 名
+    uint64_t size = 0;
+    uint32_t mode = 0644;
+    int64_t mtime_ns = 0;       // 用于判断文件是否变化，避免重复计算哈希
+    std::string link_target;
+};
+
+// 两份清单之间的差异
+struct SnapshotDiff {
+    std::vector<std::string> added;
+    std::vector<std::string> modified;
+    std::vector<std::string> removed;
+
+    bool empty() const { return added.empty() && modified.empty() && removed.empty(); }
+    size_t total() const { return added.size() + modified.size() + removed.size(); }
+};
+
+struct SnapshotCaptureResult {
+    bool success = false;
+    size_t files = 0;
+    size_t hashed = 0;          // 大小或修改时间变化、重新计算哈希的文件
+    size_t new_objects = 0;     // 新写入内容存储的文件
+    size_t bytes_stored = 0;    // 本次快照新增占用
+};
+
+struct SnapshotRestoreResult {
+    bool success = false;
+    size_t written = 0;         // 新建或内容变化而重写的文件
+    size_t removed = 0;
+    size_t unchanged = 0;
+    size_t bytes_written = 0;
+};
+
+// 包目录的增量快照
+// 文件内容存放在全局缓存的内容存储（BlobStore）中，与缓存的版本树共用 blob；每个快照是 <root> 下的一份
+// JSON 清单，记录各文件的哈希、大小、权限和修改时间，并以清单路径为 owner 在内容存储中登记引用。
+// <root>/state.json 记录每个目录最近一次快照/恢复对应的清单，大小和修改时间都没变的文件直接沿用清单中的哈希，
+// 因此快照只读取变化的文件。恢复时比较目标清单与目录现状，只重写内容不同的文件、删除多余的文件。
+class SnapshotStore {
+public:
+    // blobs 为空时使用全局缓存管理器的内容存储，未启用时使用用户缓存下的 .store
+    explicit SnapshotStore(const std::string& root, BlobStore* blobs = nullptr);
+    ~SnapshotStore();
+
+    const std::string& get_root() const { return root_; }
+
+    // 为目录生成快照，清单写到 manifest_path（通常位于 root 下）
+    SnapshotCaptureResult capture(const std::string& source_dir, const std::string& manifest_path);
+
+    // 把目录恢复到清单记录的状态
+    SnapshotRestoreResult restore(const std::string& manifest_path, const std::string& target_dir, int threads = 0);
+
+    // 清单存在且引用的对象齐全
+    bool verify(const std::string& manifest_path) const;
+
+    // 撤销 root 下已删除清单的引用并回收不再被引用的 blob，返回释放的字节数
+    size_t collect_garbage();
+
+    std::string object_path(const std::string& hash) const;
+
+    static bool load_manifest(const std::string& manifest_path, std::vector<SnapshotEntry>& entries);
+    static bool is_snapshot(const std::string& path);
+
+    // 扫描目录；known 中大小和修改时间一致的文件沿用其哈希，其余并行计算
+    static bool scan_tree(const std::string& dir, std::vector<SnapshotEntry>& entries,
+                          const std::map<std::string, SnapshotEntry>* known = nullptr, size_t* hashed = nullptr);
+    static SnapshotDiff diff(const std::vector<SnapshotEntry>& from, const std::vector<SnapshotEntry>& to);
+
+private:
+    std::map<std::string, SnapshotEntry> known_entries(const std::string& dir) const;
+    void remember(const std::string& dir, const std::string& manifest_path) const;
+
+    std::string root_;
+    std::unique_ptr<BlobStore> owned_blobs_;
+    BlobStore* blobs_;
+};
+
+} // namespace Paker
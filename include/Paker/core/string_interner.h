@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Paker {
+
+// 驻留字符串的 32 位句柄
+// 相同内容的字符串共享同一个 ID 和同一份存储；相等比较和哈希只看 ID。
+// ID 0 固定表示空字符串，因此默认构造的 Symbol 可以直接使用。
+class Symbol {
+public:
+    using Id = uint32_t;
+
+    constexpr Symbol() noexcept = default;
+    // 驻留 text 并返回其句柄
+    explicit Symbol(std::string_view text);
+
+    Id id() const { return id_; }
+    bool empty() const { return id_ == 0; }
+
+    std::string_view view() const;
+    const char* c_str() const;
+    std::string str() const { return std::string(view()); }
+    size_t size() const { return view().size(); }
+
+    operator std::string_view() const { return view(); }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.id_ == b.id_; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.id_ != b.id_; }
+    friend bool operator==(Symbol a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, std::string_view b) { return a.view() != b; }
+    friend bool operator==(std::string_view a, Symbol b) { return a == b.view(); }
+    friend bool operator!=(std::string_view a, Symbol b) { return a != b.view(); }
+    // 按字典序排序，保证 std::map/std::set 的遍历顺序与 std::string 一致
+    friend bool operator<(Symbol a, Symbol b) { return a.id_ != b.id_ && a.view() < b.view(); }
+
+private:
+    explicit constexpr Symbol(Id id, bool) noexcept : id_(id) {}
+    Id id_ = 0;
+
+    friend class StringInterner;
+};
+
+inline std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+    return os << symbol.view();
+}
+
+// 驻留器统计
+struct StringInternerStats {
+    size_t symbol_count = 0;    // 不同字符串个数
+    size_t bytes_stored = 0;    // 字符串内容字节数（含结尾 '\0'）
+    size_t arena_bytes = 0;     // 为字符串内容分配的总字节数
+    size_t table_bytes = 0;     // ID 表与哈希索引占用的估算字节数
+};
+
+// 全局并发字符串驻留器
+// 字符串按哈希分片，每个分片一把读写锁，查找命中只取共享锁；ID -> 字符串的反查无锁。
+// 已驻留的字符串在进程生命周期内不会释放，返回的 string_view / c_str 始终有效。
+// 因此只驻留取值有限的字符串（包名、版本号）；路径、缓存键这类随运行不断出现的新字符串不要驻留，
+// 否则守护进程的内存只增不减。
+class StringInterner {
+public:
+    static StringInterner& instance();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    Symbol intern(std::string_view text);
+
+    // 仅查找，不驻留；适合查询路径，避免未命中的键撑大驻留表
+    std::optional<Symbol> find(std::string_view text) const;
+
+    std::string_view view(Symbol::Id id) const {
+        const Entry& entry = entry_at(id);
+        return std::string_view(entry.data, entry.size);
+    }
+    const char* c_str(Symbol::Id id) const { return entry_at(id).data; }
+
+    StringInternerStats get_statistics() const;
+
+    // ID 表分段：第 k 段容纳 kFirstSegmentSize << k 个条目
+    static constexpr size_t kFirstSegmentSize = 1024;
+    static constexpr size_t kSegmentCount = 23;
+    static constexpr size_t kShardCount = 64;
+    static constexpr size_t kArenaBlockSize = 64 * 1024;
+
+private:
+    StringInterner();
+    ~StringInterner() = default;
+
+    struct Entry {
+        const char* data;
+        uint32_t size;
+    };
+
+    // 开放寻址索引槽：id 为 0 表示空槽，tag 为哈希高 32 位，用于跳过大部分字符串比较
+    struct Slot {
+        Symbol::Id id;
+        uint32_t tag;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::vector<Slot> slots;
+        size_t used = 0;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* cursor = nullptr;
+        size_t remaining = 0;
+    };
+
+    static size_t segment_of(Symbol::Id id, size_t& offset) {
+        size_t n = id / kFirstSegmentSize + 1;
+        size_t segment = 63 - static_cast<size_t>(__builtin_clzll(n));
+        offset = id - ((size_t(1) << segment) - 1) * kFirstSegmentSize;
+        return segment;
+    }
+
+    const Entry& entry_at(Symbol::Id id) const {
+        size_t offset;
+        size_t segment = segment_of(id, offset);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    // 分片取哈希最高 6 位，槽位取低位，两者互不相关
+    Shard& shard_for(size_t hash) const { return shards_[(hash >> 58) % kShardCount]; }
+    Symbol::Id probe(const Shard& shard, std::string_view text, size_t hash) const;
+    void insert_slot(Shard& shard, Symbol::Id id, size_t hash);
+    void grow(Shard& shard);
+    const char* store(Shard& shard, std::string_view text);
+    Entry* ensure_segment(size_t segment);
+
+    mutable std::array<Shard, kShardCount> shards_;
+    std::array<std::atomic<Entry*>, kSegmentCount> segments_;
+    std::atomic<Symbol::Id> next_id_;
+    std::atomic<size_t> bytes_stored_;
+    std::atomic<size_t> arena_bytes_;
+};
+
+inline Symbol::Symbol(std::string_view text) : id_(StringInterner::instance().intern(text).id_) {}
+
+inline std::string_view Symbol::view() const {
+    return StringInterner::instance().view(id_);
+}
+
+inline const char* Symbol::c_str() const {
+    return StringInterner::instance().c_str(id_);
+}
+
+} // namespace Paker
+
+namespace std {
+template <>
+struct hash<Paker::Symbol> {
+    size_t operator()(Paker::Symbol symbol) const noexcept { return symbol.id(); }
+};
+} // namespace std
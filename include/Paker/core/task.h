@@ -0,0 +1,383 @@
+#pragma once
+
+// C++20 协程任务类型，仅在 PAKER_ENABLE_COROUTINES 构建时可用；C++17 构建继续使用 std::future 接口
+#if defined(PAKER_HAVE_COROUTINES)
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Paker {
+
+template<typename T = void>
+class task;
+
+namespace detail {
+
+// 任务结束时对称转移到等待者，没有等待者时直接挂起
+struct task_promise_base {
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+};
+
+template<typename T>
+struct task_promise : task_promise_base {
+    task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T take_result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template<>
+struct task_promise<void> : task_promise_base {
+    task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+
+    void take_result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+// 立即开始、结束后自行销毁的协程，用于把任务接到同步等待或组合器上
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+// 惰性协程任务：创建时不执行，被 co_await 时才开始，结束后恢复等待者。
+// 协程形参应按值传递，引用形参在任务真正开始前可能已经失效。
+template<typename T>
+class [[nodiscard]] task {
+public:
+    using promise_type = detail::task_promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+    explicit task(handle_type handle) noexcept : handle_(handle) {}
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool valid() const noexcept { return static_cast<bool>(handle_); }
+    bool done() const noexcept { return handle_ && handle_.done(); }
+
+    struct awaiter {
+        handle_type handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        T await_resume() { return handle.promise().take_result(); }
+    };
+
+    awaiter operator co_await() const noexcept { return awaiter{handle_}; }
+
+private:
+    handle_type handle_;
+};
+
+namespace detail {
+
+template<typename T>
+task<T> task_promise<T>::get_return_object() noexcept {
+    return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept {
+    return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+}
+
+template<typename T>
+struct sync_wait_state {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::optional<T> value;
+    std::exception_ptr exception;
+};
+
+template<>
+struct sync_wait_state<void> {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr exception;
+};
+
+// 任务按值进入驱动协程，结果写回后才通知等待线程
+template<typename T>
+detached_task run_sync_wait(task<T> work, sync_wait_state<T>& state) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await work;
+        } else {
+            state.value.emplace(co_await work);
+        }
+    } catch (...) {
+        state.exception = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.cv.notify_all();
+}
+
+// 计数从 n + 1 开始，多出的一次由挂起方扣除，全部子任务同步完成时等待者不必挂起
+template<typename T>
+struct when_all_state {
+    explicit when_all_state(size_t count) : remaining(count + 1), values(count), errors(count) {}
+
+    void arrive() {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            awaiting.resume();
+        }
+    }
+
+    std::atomic<size_t> remaining;
+    std::coroutine_handle<> awaiting;
+    std::vector<std::optional<T>> values;
+    std::vector<std::exception_ptr> errors;
+};
+
+template<>
+struct when_all_state<void> {
+    explicit when_all_state(size_t count) : remaining(count + 1), errors(count) {}
+
+    void arrive() {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            awaiting.resume();
+        }
+    }
+
+    std::atomic<size_t> remaining;
+    std::coroutine_handle<> awaiting;
+    std::vector<std::exception_ptr> errors;
+};
+
+template<typename T>
+detached_task run_when_all_child(task<T> child, when_all_state<T>& state, size_t index) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await child;
+        } else {
+            state.values[index].emplace(co_await child);
+        }
+    } catch (...) {
+        state.errors[index] = std::current_exception();
+    }
+    state.arrive();
+}
+
+template<typename T>
+struct when_all_awaiter {
+    std::vector<task<T>>& children;
+    when_all_state<T>& state;
+
+    bool await_ready() const noexcept { return children.empty(); }
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        state.awaiting = awaiting;
+        for (size_t i = 0; i < children.size(); ++i) {
+            run_when_all_child(std::move(children[i]), state, i);
+        }
+        return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+};
+
+// 输掉的子任务会在等待者恢复之后才结束，状态由所有驱动协程共同持有
+template<typename T>
+struct when_any_state {
+    std::atomic<bool> decided{false};
+    std::atomic<int> pending_resume{2};
+    std::coroutine_handle<> awaiting;
+    size_t index = 0;
+    std::optional<T> value;
+    std::exception_ptr exception;
+};
+
+template<>
+struct when_any_state<void> {
+    std::atomic<bool> decided{false};
+    std::atomic<int> pending_resume{2};
+    std::coroutine_handle<> awaiting;
+    size_t index = 0;
+    std::exception_ptr exception;
+};
+
+template<typename T>
+detached_task run_when_any_child(task<T> child, std::shared_ptr<when_any_state<T>> state, size_t index) {
+    std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> value{};
+    std::exception_ptr exception;
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await child;
+        } else {
+            value.emplace(co_await child);
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    if (state->decided.exchange(true, std::memory_order_acq_rel)) {
+        co_return;
+    }
+    state->index = index;
+    state->exception = exception;
+    if constexpr (!std::is_void_v<T>) {
+        state->value = std::move(value);
+    }
+    if (state->pending_resume.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        state->awaiting.resume();
+    }
+}
+
+// 等待器只持有引用：GCC 12 在 await_suspend 返回 false 时会重复析构 co_await 临时对象
+template<typename T>
+struct when_any_awaiter {
+    std::vector<task<T>>& children;
+    const std::shared_ptr<when_any_state<T>>& state;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        state->awaiting = awaiting;
+        for (size_t i = 0; i < children.size(); ++i) {
+            run_when_any_child(std::move(children[i]), state, i);
+        }
+        return state->pending_resume.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+// 在当前线程阻塞等待任务完成，供命令入口和测试把协程接回同步代码
+template<typename T>
+T sync_wait(task<T> work) {
+    detail::sync_wait_state<T> state;
+    detail::run_sync_wait(std::move(work), state);
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&state] { return state.done; });
+    }
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*state.value);
+    }
+}
+
+// 同时开始所有任务，全部完成后按输入顺序返回结果；有任务抛出时重新抛出第一个异常
+template<typename T>
+task<std::vector<T>> when_all(std::vector<task<T>> children) {
+    detail::when_all_state<T> state(children.size());
+    co_await detail::when_all_awaiter<T>{children, state};
+    for (auto& error : state.errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    std::vector<T> results;
+    results.reserve(state.values.size());
+    for (auto& value : state.values) {
+        results.push_back(std::move(*value));
+    }
+    co_return results;
+}
+
+inline task<void> when_all(std::vector<task<void>> children) {
+    detail::when_all_state<void> state(children.size());
+    co_await detail::when_all_awaiter<void>{children, state};
+    for (auto& error : state.errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// 同时开始所有任务，返回最先完成者的序号和结果；其余任务不会被取消，
+// 会继续运行到结束并丢弃结果，它们引用的对象必须活到那时
+template<typename T>
+task<std::pair<size_t, T>> when_any(std::vector<task<T>> children) {
+    if (children.empty()) {
+        throw std::invalid_argument("when_any requires at least one task");
+    }
+    auto state = std::make_shared<detail::when_any_state<T>>();
+    co_await detail::when_any_awaiter<T>{children, state};
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+    co_return std::pair<size_t, T>(state->index, std::move(*state->value));
+}
+
+inline task<size_t> when_any(std::vector<task<void>> children) {
+    if (children.empty()) {
+        throw std::invalid_argument("when_any requires at least one task");
+    }
+    auto state = std::make_shared<detail::when_any_state<void>>();
+    co_await detail::when_any_awaiter<void>{children, state};
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+    co_return state->index;
+}
+
+} // namespace Paker
+
+#endif // PAKER_HAVE_COROUTINES
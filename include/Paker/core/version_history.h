@@ -25,6 +25,7 @@ struct VersionHistoryEntry {
     // 备份信息
     std::string backup_path;
     std::vector<std::string> affected_files;
+    std::string affected_files_ref;   // 历史日志中压缩存放的文件列表，按需用 HistoryLog::load_affected_files 读取
     size_t backup_size_bytes;
     
     VersionHistoryEntry() : is_rollback(false), backup_size_bytes(0) {}
@@ -60,22 +61,28 @@ struct RollbackResult {
     std::string backup_location;
     size_t total_files_affected;
     std::chrono::milliseconds duration;
+    uint64_t generation;                         // 切换到的链接代，0 表示未经由链接代回滚
+    std::chrono::microseconds switch_latency;    // 原子切换本身的耗时
     
-    RollbackResult() : success(false), total_files_affected(0), duration(0) {}
+    RollbackResult() : success(false), total_files_affected(0), duration(0), generation(0), switch_latency(0) {}
 };
 
+class HistoryLog;
+
 // 版本历史管理器
 class VersionHistoryManager {
 private:
-    std::string history_file_path_;
+    std::string history_file_path_;   // 旧版整体 JSON 历史，首次打开时迁移到 history_log_
     std::string backup_dir_;
-    std::vector<VersionHistoryEntry> history_;
-    std::map<std::string, std::vector<VersionHistoryEntry>> package_history_;
+    std::unique_ptr<HistoryLog> history_log_;
     
     // 私有方法
     bool load_history();
-    bool save_history();
-    bool create_backup(const std::string& package_name, const std::string& version);
+    // 读取整体 JSON 格式的历史（旧版历史文件与导出文件）并追加到历史日志
+    bool append_json_history(const std::string& path, size_t& appended);
+    // 返回快照清单路径，失败时为空；stored_bytes 为本次新增占用
+    std::string create_backup(const std::string& package_name, const std::string& version,
+                              size_t* stored_bytes = nullptr);
     bool restore_backup(const std::string& backup_path, const std::string& target_path);
     std::string generate_backup_path(const std::string& package_name, const std::string& version);
     bool validate_rollback_safety(const std::string& package_name, const std::string& target_version);
@@ -83,6 +90,7 @@ private:
     
 public:
     explicit VersionHistoryManager(const std::string& project_path = "");
+    ~VersionHistoryManager();
     
     // 记录版本变更
     bool record_version_change(const std::string& package_name, 
@@ -107,6 +115,9 @@ public:
     // 获取版本历史
     std::vector<VersionHistoryEntry> get_package_history(const std::string& package_name) const;
     std::vector<VersionHistoryEntry> get_recent_history(size_t count = 10) const;
+    std::vector<VersionHistoryEntry> get_history_between(const std::chrono::system_clock::time_point& from,
+                                                         const std::chrono::system_clock::time_point& to) const;
+    std::vector<std::string> get_affected_files(const VersionHistoryEntry& entry) const;
     
     // 智能回滚建议
     std::vector<std::string> get_rollback_suggestions(const std::string& package_name) const;
@@ -159,20 +170,21 @@ public:
     // 验证备份完整性
     static bool validate_backup_integrity(const std::string& backup_path);
     
-    // 计算文件差异
+    // 计算文件差异（进程内比较两个目录，每行形如 "added: path"）
     static std::vector<std::string> calculate_file_differences(const std::string& path1, 
                                                               const std::string& path2);
     
-    // 创建差异备份
+    // 创建差异备份：backup_path 为快照清单，文件内容存放在缓存的内容存储中
     static bool create_differential_backup(const std::string& source_path, 
                                          const std::string& backup_path);
     
-    // 应用差异备份
+    // 应用差异备份：只重写与快照不同的文件
     static bool apply_differential_backup(const std::string& backup_path, 
                                         const std::string& target_path);
 };
 
 // 全局函数
 VersionHistoryManager* get_history_manager();
+void cleanup_history_manager();
 
 } // namespace Paker 
\ No newline at end of file
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <memory_resource>
+#include "Paker/core/slab_allocator.h"
+#include "Paker/core/string_interner.h"
+
+namespace Paker {
+
+class DependencyGraph;
+class OptimizedDependencyGraph;
+
+// 节点名称驻留器：为包名分配稠密的 uint32 ID
+// 名称只在构建器内保存，随构建器释放；不写入全局 StringInterner，
+// 否则基准与测试生成的合成图、守护进程里反复构建的图会让驻留表只增不减
+class NodeInterner {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId INVALID_ID = std::numeric_limits<NodeId>::max();
+
+    // 获取或分配ID
+    NodeId intern(std::string_view name);
+
+    // 仅查找，不存在时返回 INVALID_ID
+    NodeId find(std::string_view name) const;
+
+    std::string_view name(NodeId id) const { return names_[id]; }
+    const std::deque<std::string>& names() const { return names_; }
+    size_t size() const { return names_.size(); }
+    void reserve(size_t count);
+    void clear();
+
+private:
+    // deque 保证扩容时已有字符串地址不变，index_ 的键直接引用它们
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, NodeId> index_;
+};
+
+// 冻结的压缩稀疏行(CSR)依赖图
+// 正向边 = 依赖，反向边 = 被依赖；构建后只读，可在多线程间共享
+class CSRDependencyGraph {
+public:
+    using NodeId = NodeInterner::NodeId;
+    static constexpr NodeId INVALID_NODE = NodeInterner::INVALID_ID;
+    // 路径枚举的默认结果上限：菱形依赖下简单路径数随深度指数增长
+    static constexpr size_t DEFAULT_MAX_PATHS = 1024;
+
+    // 连续边区间
+    class EdgeRange {
+    public:
+        EdgeRange(const NodeId* first, const NodeId* last) : first_(first), last_(last) {}
+        const NodeId* begin() const { return first_; }
+        const NodeId* end() const { return last_; }
+        size_t size() const { return static_cast<size_t>(last_ - first_); }
+        bool empty() const { return first_ == last_; }
+        NodeId operator[](size_t i) const { return first_[i]; }
+
+    private:
+        const NodeId* first_;
+        const NodeId* last_;
+    };
+
+    CSRDependencyGraph();
+    CSRDependencyGraph(const CSRDependencyGraph&) = delete;
+    CSRDependencyGraph& operator=(const CSRDependencyGraph&) = delete;
+    CSRDependencyGraph(CSRDependencyGraph&&) = default;
+    CSRDependencyGraph& operator=(CSRDependencyGraph&&) = default;
+
+    // 从现有图构建
+    static CSRDependencyGraph from_graph(const DependencyGraph& graph);
+    static CSRDependencyGraph from_graph(const OptimizedDependencyGraph& graph);
+
+    // 基本信息
+    size_t node_count() const { return name_offsets_.empty() ? 0 : name_offsets_.size() - 1; }
+    size_t edge_count() const { return out_edges_.size(); }
+    bool empty() const { return node_count() == 0; }
+
+    // 名称 <-> ID
+    NodeId find(std::string_view name) const;
+    std::string_view name(NodeId id) const;
+    // 节点名已在全局驻留表中时返回其符号；只查找，不驻留
+    std::optional<Symbol> find_symbol(NodeId id) const;
+
+    // 邻接访问
+    EdgeRange dependencies(NodeId id) const {
+        return EdgeRange(out_edges_.data() + out_offsets_[id], out_edges_.data() + out_offsets_[id + 1]);
+    }
+    EdgeRange dependents(NodeId id) const {
+        return EdgeRange(in_edges_.data() + in_offsets_[id], in_edges_.data() + in_offsets_[id + 1]);
+    }
+    size_t out_degree(NodeId id) const { return out_offsets_[id + 1] - out_offsets_[id]; }
+    size_t in_degree(NodeId id) const { return in_offsets_[id + 1] - in_offsets_[id]; }
+
+    // 整数版图算法
+    // Kahn 拓扑序（依赖者在前）；存在环时结果不完整
+    std::vector<NodeId> topological_order() const;
+    std::vector<std::string> topological_sort() const;
+
+    // 基于强连通分量的环检测：每个含环分量输出一个最短代表环（首尾相同），O(V+E)
+    std::vector<std::vector<NodeId>> find_cycles() const;
+    std::vector<std::vector<std::string>> detect_cycles() const;
+
+    // 枚举简单路径，max_paths 限制结果数量；只沿能到达 to 的节点搜索，工作量随结果数增长
+    std::vector<std::vector<NodeId>> find_paths(NodeId from, NodeId to,
+                                                size_t max_paths = DEFAULT_MAX_PATHS) const;
+
+    // BFS 可达集合（不含起点）
+    std::vector<NodeId> reachable_from(NodeId id) const;
+    std::vector<NodeId> reachable_to(NodeId id) const;
+
+    // 工具
+    std::vector<std::string> to_names(const std::vector<NodeId>& ids) const;
+    size_t get_memory_usage() const;
+
+    // 原始数组（序列化/基准测试使用）
+    const std::vector<uint32_t>& out_offsets() const { return out_offsets_; }
+    const std::vector<NodeId>& out_edges() const { return out_edges_; }
+    const std::vector<uint32_t>& in_offsets() const { return in_offsets_; }
+    const std::vector<NodeId>& in_edges() const { return in_edges_; }
+
+private:
+    friend class CSRGraphBuilder;
+
+    std::vector<NodeId> bfs(NodeId start, bool forward) const;
+
+    // 名称池：所有名称连续存放，name_offsets_ 共 node_count()+1 项
+    std::vector<char> name_pool_;
+    std::vector<uint32_t> name_offsets_;
+    // 每个节点一个小哈希节点，走 slab 分配器
+    std::pmr::unordered_map<std::string_view, NodeId> name_index_{get_slab_memory_resource()};
+
+    // 正向/反向 CSR
+    std::vector<uint32_t> out_offsets_;
+    std::vector<NodeId> out_edges_;
+    std::vector<uint32_t> in_offsets_;
+    std::vector<NodeId> in_edges_;
+};
+
+// CSR 图构建器
+class CSRGraphBuilder {
+public:
+    using NodeId = CSRDependencyGraph::NodeId;
+
+    void reserve(size_t nodes, size_t edges);
+
+    // 添加节点（重复添加返回同一ID）
+    NodeId add_node(std::string_view name);
+
+    // 添加边，端点不存在时自动创建
+    void add_edge(NodeId from, NodeId to);
+    void add_edge(std::string_view from, std::string_view to);
+
+    size_t node_count() const { return interner_.size(); }
+
+    // 生成冻结图，边按目标ID排序并去重；构建后 builder 被清空
+    CSRDependencyGraph build();
+
+private:
+    NodeInterner interner_;
+    std::vector<std::pair<NodeId, NodeId>> edges_;
+};
+
+} // namespace Paker
@@ -6,9 +6,17 @@
 #include <vector>
 #include <memory>
 #include <unordered_set>
+#include <unordered_map>
+#include <string_view>
+#include <cstdint>
+#include <mutex>
+#include "Paker/dependency/incremental_topological_order.h"
 
 namespace Paker {
 
+class CSRDependencyGraph;
+class ReachabilityIndex;
+
 // 版本约束操作符
 enum class VersionOp {
     EQ,     // 等于
@@ -61,6 +69,7 @@ struct ConflictInfo {
     std::string package_name;
     std::vector<std::string> conflicting_versions;
     std::vector<std::string> conflict_path;  // 冲突路径
+    std::vector<std::vector<std::string>> explanation_paths;  // 各版本要求的最短依赖路径
     std::string suggested_solution;
     
     ConflictInfo(Type type, const std::string& package_name)
@@ -73,13 +82,47 @@ private:
     std::map<std::string, DependencyNode> nodes_;
     std::map<std::string, std::set<std::string>> adjacency_list_;
     
+    // 结构版本号，节点或边变化时递增
+    uint64_t version_ = 0;
+    
+    // 冻结的CSR快照，按版本号惰性重建；并发的 const 读者通过 frozen_mutex_ 串行重建
+    mutable std::mutex frozen_mutex_;
+    mutable std::shared_ptr<const CSRDependencyGraph> frozen_;
+    mutable uint64_t frozen_version_ = 0;
+    
+    // 可达性索引，同样按版本号惰性重建；持有 reachability_mutex_ 时可再获取 frozen_mutex_
+    mutable std::mutex reachability_mutex_;
+    mutable std::shared_ptr<const ReachabilityIndex> reachability_;
+    mutable uint64_t reachability_version_ = 0;
+    
+    // 在线维护的拓扑序，键引用 nodes_ 中的名称
+    IncrementalTopologicalOrder topo_order_;
+    std::unordered_map<std::string_view, uint32_t> topo_ids_;
+    std::vector<const std::string*> topo_names_;
+    
+    // 按 source 的拓扑序编号重建 topo_ids_ / topo_names_，使其指向本对象的 nodes_
+    void rebuild_topo_index(const std::vector<const std::string*>& source_names);
+    
 public:
+    DependencyGraph() = default;
+    DependencyGraph(const DependencyGraph& other);
+    DependencyGraph(DependencyGraph&& other) noexcept;
+    DependencyGraph& operator=(const DependencyGraph& other);
+    DependencyGraph& operator=(DependencyGraph&& other) noexcept;
+    
     // 添加节点
     void add_node(const DependencyNode& node);
     
-    // 添加边（依赖关系）
+    // 添加边（依赖关系）；引入循环依赖时仍会记录该边
     void add_dependency(const std::string& from, const std::string& to);
     
+    // 仅在不引入循环依赖时添加边，失败时 cycle 返回将形成的环
+    bool try_add_dependency(const std::string& from, const std::string& to,
+                            std::vector<std::string>* cycle = nullptr);
+    
+    // 删除边
+    bool remove_dependency(const std::string& from, const std::string& to);
+    
     // 获取节点
     const DependencyNode* get_node(const std::string& name) const;
     DependencyNode* get_node(const std::string& name);
@@ -87,24 +130,46 @@ public:
     // 获取所有节点
     const std::map<std::string, DependencyNode>& get_nodes() const { return nodes_; }
     
+    // 获取邻接表
+    const std::map<std::string, std::set<std::string>>& get_adjacency_list() const { return adjacency_list_; }
+    
     // 检查节点是否存在
     bool has_node(const std::string& name) const;
     
     // 获取节点的直接依赖
     std::set<std::string> get_dependencies(const std::string& name) const;
     
-    // 拓扑排序
+    // 拓扑排序（无环时直接读取在线维护的顺序，O(V)）
+    // 只保证依赖方在被依赖方之前：无约束的节点保持加入顺序，重排时受影响区间内保持相对顺序。
+    // 不再是按节点ID分层的 Kahn 序，同层节点的先后与旧版本可能不同；有环时退回 Kahn 序
     std::vector<std::string> topological_sort() const;
     
+    // 当前图是否无环（由在线拓扑序维护，O(1)）
+    bool is_acyclic() const { return topo_order_.is_acyclic(); }
+    
+    // 在线拓扑序统计
+    const IncrementalTopologicalOrder::Stats& get_topological_order_stats() const { return topo_order_.get_stats(); }
+    
     // 检测循环依赖
     std::vector<std::vector<std::string>> detect_cycles() const;
     
-    // 获取所有路径
+    // 获取依赖路径，按长度递增，至多 CSRDependencyGraph::DEFAULT_MAX_PATHS 条
     std::vector<std::vector<std::string>> get_all_paths(const std::string& from, const std::string& to) const;
     
-    // 获取到指定包的所有路径
+    // 获取从各依赖者到指定包的路径（每个依赖者按长度递增，总数同样受上限约束）
     std::vector<std::vector<std::string>> get_all_paths_to_package(const std::string& package) const;
     
+    // 获取至多 k 条最短依赖路径，按长度递增
+    std::vector<std::vector<std::string>> get_shortest_paths(const std::string& from, const std::string& to,
+                                                             size_t k) const;
+    
+    // from 是否（传递地）依赖 to，由可达性索引回答
+    bool depends_on(const std::string& from, const std::string& to) const;
+    
+    // 传递依赖 / 传递被依赖（不含自身，按名称排序）
+    std::vector<std::string> get_transitive_dependencies(const std::string& name) const;
+    std::vector<std::string> get_transitive_dependents(const std::string& name) const;
+    
     // 清空图
     void clear();
     
@@ -114,20 +179,14 @@ public:
     // 检查图是否为空
     bool empty() const { return nodes_.empty(); }
     
-private:
-    // DFS 循环检测
-    void dfs_cycle_detection(const std::string& node,
-                           std::unordered_set<std::string>& visited,
-                           std::unordered_set<std::string>& rec_stack,
-                           std::vector<std::string>& path,
-                           std::vector<std::vector<std::string>>& cycles) const;
-    
-    // DFS 路径查找
-    void dfs_find_paths(const std::string& current,
-                      const std::string& target,
-                      std::unordered_set<std::string>& visited,
-                      std::vector<std::string>& current_path,
-                      std::vector<std::vector<std::string>>& paths) const;
+    // 结构版本号
+    uint64_t version() const { return version_; }
+    
+    // 获取当前结构的CSR快照（未变化时复用）
+    std::shared_ptr<const CSRDependencyGraph> freeze() const;
+    
+    // 获取当前结构的可达性索引（未变化时复用）
+    std::shared_ptr<const ReachabilityIndex> reachability_index() const;
 };
 
 } // namespace Paker 
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <cstdint>
+#include <nlohmann/json.hpp>
 #include "dependency/dependency_graph.h"
 
 namespace Paker {
@@ -13,6 +15,7 @@ class IncrementalParser;
 // 依赖解析器
 class DependencyResolver {
 private:
+    // 图的节点与边跨命令存活（写入快照、守护进程复用），留在普通堆上，不从命令 arena 分配
     DependencyGraph graph_;
     std::map<std::string, std::string> repositories_;
     bool recursive_mode_;
@@ -20,6 +23,11 @@ private:
     
     // 内部辅助方法
     void scan_installed_packages();
+    void load_remotes_from_json(const nlohmann::json& j);
+    
+    // 项目清单内容与已安装包目录状态的指纹，用于判断快照缓存是否有效
+    uint64_t compute_project_fingerprint(const std::string& json_file) const;
+    std::string get_snapshot_file(const std::string& json_file) const;
     
 public:
     DependencyResolver();
@@ -28,6 +36,9 @@ public:
     // 解析单个包的依赖
     bool resolve_package(const std::string& package, const std::string& version = "");
     
+    // 按包目录中当前的清单重新读取已解析包的依赖（包内容变化后使用）
+    bool reload_package(const std::string& package, const std::string& version = "");
+    
     // 解析整个项目的依赖树
     bool resolve_project_dependencies();
     
@@ -65,6 +76,10 @@ public:
     // 保存依赖到JSON文件
     bool save_dependencies_to_json(const std::string& json_file) const;
     
+    // 解析结果的二进制快照缓存：指纹不匹配时加载失败
+    bool save_graph_snapshot(const std::string& snapshot_file, uint64_t fingerprint) const;
+    bool load_graph_snapshot(const std::string& snapshot_file, uint64_t expected_fingerprint);
+    
     // 增量解析功能
     bool enable_incremental_parsing(bool enable = true);
     bool is_incremental_parsing_enabled() const;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Paker/dependency/csr_dependency_graph.h"
+#include <vector>
+#include <cstdint>
+
+namespace Paker {
+
+// 强连通分量分解与缩点DAG
+// 迭代式 Tarjan 算法，O(V+E)，不依赖递归深度
+// 分量编号满足逆拓扑序：若分量 a 依赖分量 b，则 b < a（编号 0 是最底层的依赖）
+class GraphCondensation {
+public:
+    using NodeId = CSRDependencyGraph::NodeId;
+    using ComponentId = uint32_t;
+
+    explicit GraphCondensation(const CSRDependencyGraph& graph);
+
+    const CSRDependencyGraph& graph() const { return graph_; }
+
+    // 分量信息
+    size_t component_count() const { return member_offsets_.size() - 1; }
+    ComponentId component_of(NodeId node) const { return component_[node]; }
+    CSRDependencyGraph::EdgeRange members(ComponentId comp) const {
+        return CSRDependencyGraph::EdgeRange(members_.data() + member_offsets_[comp],
+                                             members_.data() + member_offsets_[comp + 1]);
+    }
+
+    // 分量内存在环（多个节点或自环）
+    bool is_cyclic(ComponentId comp) const { return cyclic_[comp] != 0; }
+    std::vector<ComponentId> cyclic_components() const;
+    bool has_cycles() const;
+
+    // 缩点DAG的邻接
+    CSRDependencyGraph::EdgeRange component_dependencies(ComponentId comp) const {
+        return CSRDependencyGraph::EdgeRange(dag_out_edges_.data() + dag_out_offsets_[comp],
+                                             dag_out_edges_.data() + dag_out_offsets_[comp + 1]);
+    }
+    CSRDependencyGraph::EdgeRange component_dependents(ComponentId comp) const {
+        return CSRDependencyGraph::EdgeRange(dag_in_edges_.data() + dag_in_offsets_[comp],
+                                             dag_in_edges_.data() + dag_in_offsets_[comp + 1]);
+    }
+    size_t dag_edge_count() const { return dag_out_edges_.size(); }
+
+    // 分量内的一个代表环（最短环，首尾相同），非环分量返回空
+    std::vector<NodeId> representative_cycle(ComponentId comp) const;
+
+    // 可达性查询：from 是否（传递地）依赖 to
+    // 利用分量编号的拓扑性质剪枝，只访问编号位于 [to, from] 之间的分量
+    bool reaches(NodeId from, NodeId to) const;
+
+    // 传递依赖 / 传递被依赖（不含自身，同分量的其他节点计入）
+    std::vector<NodeId> transitive_dependencies(NodeId node) const;
+    std::vector<NodeId> transitive_dependents(NodeId node) const;
+
+private:
+    void run_tarjan();
+    void build_dag();
+    std::vector<NodeId> collect(NodeId node, bool forward) const;
+
+    const CSRDependencyGraph& graph_;
+
+    std::vector<ComponentId> component_;
+    std::vector<uint32_t> member_offsets_;
+    std::vector<NodeId> members_;
+    std::vector<uint8_t> cyclic_;
+
+    std::vector<uint32_t> dag_out_offsets_;
+    std::vector<ComponentId> dag_out_edges_;
+    std::vector<uint32_t> dag_in_offsets_;
+    std::vector<ComponentId> dag_in_edges_;
+};
+
+// 有界 K 最短路径
+// 返回从 sources 中任一节点到 target 的至多 k 条最短简单路径（按长度递增）
+// 以正向BFS距离作为精确启发值做反向 A* 搜索，max_expansions 限制最坏情况的工作量
+std::vector<std::vector<CSRDependencyGraph::NodeId>> k_shortest_paths(
+    const CSRDependencyGraph& graph,
+    const std::vector<CSRDependencyGraph::NodeId>& sources,
+    CSRDependencyGraph::NodeId target,
+    size_t k,
+    size_t max_expansions = 100000);
+
+} // namespace Paker
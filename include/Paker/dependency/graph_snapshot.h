@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Paker/dependency/csr_dependency_graph.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace Paker {
+
+class DependencyGraph;
+class OptimizedDependencyGraph;
+
+// 二进制依赖图快照
+// 文件布局（各段 8 字节对齐，本机字节序）：
+//   头部 | 字符串池 | 节点表 | 出边 CSR | 入边 CSR | 边约束 | 声明依赖 | 名称哈希表
+// 头部与数据区分别带 CRC32 校验；相同字符串（版本、仓库地址等）在池中只存一份。
+// 读取时整个文件以只读 mmap 映射，所有访问器直接返回映射区内的视图，不为节点分配内存。
+class GraphSnapshot {
+public:
+    using NodeId = CSRDependencyGraph::NodeId;
+    static constexpr NodeId INVALID_NODE = CSRDependencyGraph::INVALID_NODE;
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    // 节点清单中声明的依赖：依赖方不一定是图中的节点，也不一定有对应的出边
+    struct DeclaredDependency {
+        std::string_view name;
+        std::string_view constraint;   // 版本约束，has_constraint 为 false 时为空
+        bool listed = false;           // 在 DependencyNode::dependencies 中
+        bool has_constraint = false;   // 在 DependencyNode::version_constraints 中
+    };
+
+    GraphSnapshot() = default;
+    ~GraphSnapshot();
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+    GraphSnapshot(GraphSnapshot&& other) noexcept;
+    GraphSnapshot& operator=(GraphSnapshot&& other) noexcept;
+
+    // 映射并校验快照；verify_checksum 为 false 时跳过数据区 CRC，只做结构检查
+    bool open(const std::string& path, bool verify_checksum = true);
+    void close();
+    bool is_open() const { return data_ != nullptr; }
+
+    // 写入方提供的来源指纹，用于判断缓存是否仍然有效
+    uint64_t fingerprint() const;
+    size_t node_count() const;
+    size_t edge_count() const;
+    size_t file_size() const { return size_; }
+
+    // 按名称查找（文件内置开放寻址哈希表）
+    NodeId find(std::string_view name) const;
+
+    // 节点属性
+    std::string_view name(NodeId id) const;
+    std::string_view version(NodeId id) const;
+    std::string_view repository(NodeId id) const;
+    std::string_view install_path(NodeId id) const;
+    bool is_installed(NodeId id) const;
+
+    // 邻接（按目标ID升序）
+    CSRDependencyGraph::EdgeRange dependencies(NodeId id) const;
+    CSRDependencyGraph::EdgeRange dependents(NodeId id) const;
+
+    // 边 dependencies(id)[index] 上的版本约束，无约束时为空
+    std::string_view constraint(NodeId id, size_t index) const;
+
+    // 节点的声明依赖（按名称升序），用于还原 DependencyNode 的依赖列表与版本约束
+    size_t declared_count(NodeId id) const;
+    DeclaredDependency declared(NodeId id, size_t index) const;
+
+    // 写出快照（先写临时文件再原子重命名）
+    static bool write(const DependencyGraph& graph, const std::string& path, uint64_t fingerprint = 0);
+    static bool write(const OptimizedDependencyGraph& graph, const std::string& path, uint64_t fingerprint = 0);
+
+    // 快速判断文件是否为快照格式（只读取魔数）
+    static bool is_snapshot_file(const std::string& path);
+
+    struct Header;
+    struct NodeRecord;
+    struct DeclaredRecord;
+
+private:
+    bool validate(bool verify_checksum) const;
+    const Header& header() const;
+    const NodeRecord& record(NodeId id) const;
+    std::string_view pool_string(uint32_t offset, uint32_t length) const;
+    template<typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(data_ + offset);
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace Paker
@@ -11,18 +11,22 @@
 #include <mutex>
 #include <future>
 #include <atomic>
+#include <memory_resource>
 #include "dependency_graph.h"
 #include "dependency_resolver.h"
+#include "manifest_watcher.h"
+#include "Paker/core/string_interner.h"
 
 namespace Paker {
 
 // 解析结果缓存项
+// 包名、版本和依赖名是驻留句柄，同一个依赖被多个包引用时只存一份
 struct ParseCacheEntry {
-    std::string package_name;
-    std::string version;
+    Symbol package_name;
+    Symbol version;
     std::string hash;  // 依赖内容的哈希值
-    std::vector<std::string> dependencies;
-    std::vector<std::string> dev_dependencies;
+    std::vector<Symbol> dependencies;
+    std::vector<Symbol> dev_dependencies;
     std::map<std::string, std::string> metadata;
     std::chrono::system_clock::time_point last_parsed;
     std::chrono::system_clock::time_point last_accessed;
@@ -66,6 +70,7 @@ struct ParseConfig {
     bool enable_incremental;
     bool enable_parallel;
     bool enable_prediction;
+    bool enable_watch_mode;  // 通过文件系统监视维护脏集合，避免每次全量校验
     size_t max_cache_size;
     size_t max_parallel_tasks;
     std::chrono::minutes cache_ttl;
@@ -73,7 +78,7 @@ struct ParseConfig {
     
     ParseConfig() : enable_caching(true), enable_incremental(true), 
                     enable_parallel(true), enable_prediction(true),
-                    max_cache_size(1000), max_parallel_tasks(4),
+                    enable_watch_mode(false), max_cache_size(1000), max_parallel_tasks(4),
                     cache_ttl(std::chrono::minutes(60)),
                     prediction_window(std::chrono::minutes(30)) {}
 };
@@ -82,9 +87,12 @@ struct ParseConfig {
 class IncrementalParser {
 private:
     // 缓存管理
+    // 键为 "包名@版本"；条目会被淘汰，而驻留表只增不减，所以键用普通字符串
     std::unordered_map<std::string, ParseCacheEntry> parse_cache_;
     std::string cache_file_path_;
     mutable std::mutex cache_mutex_;
+    // 包名 -> 缓存键；插入时更新，查找时校验，允许残留已删除的键
+    std::unordered_map<Symbol, std::string> cache_keys_by_name_;
     
     // 解析统计
     ParseStats stats_;
@@ -100,6 +108,11 @@ private:
     std::vector<std::future<void>> parallel_tasks_;
     std::atomic<size_t> active_tasks_;
     
+    // 监视模式
+    std::unique_ptr<ManifestWatcher> watcher_;
+    std::set<std::string> project_packages_;   // 最近一次读取的清单依赖，由 cache_mutex_ 保护
+    bool project_packages_loaded_ = false;     // 同上
+    
     // 预测模型
     std::map<std::string, std::vector<std::string>> dependency_patterns_;
     std::map<std::string, std::chrono::system_clock::time_point> last_change_times_;
@@ -116,11 +129,22 @@ private:
     bool save_cache_to_disk() const;
     void update_cache_stats(bool hit);
     
+    // 单次解析过程的包名列表：列表存储与每个名字都从命令 arena 分配
+    using ScratchPackageList = std::pmr::vector<std::pmr::string>;
+    
     // 变更检测
     ChangeDetectionResult detect_changes(const std::vector<std::string>& packages) const;
+    ChangeDetectionResult detect_changes(const ScratchPackageList& packages) const;
+    template <typename PackageList>
+    ChangeDetectionResult detect_changes_in(const PackageList& packages) const;
     bool has_package_changed(const std::string& package, const std::string& version) const;
+    const ParseCacheEntry* find_cache_entry(const std::string& package) const;
+    ChangeDetectionResult scan_project_changes();
     
     // 并行解析
+    bool parse_packages(const ScratchPackageList& packages);
+    template <typename PackageList>
+    bool parse_package_list(const PackageList& packages);
     void parse_package_parallel(const std::string& package, const std::string& version);
     void wait_for_parallel_tasks();
     
@@ -147,7 +171,17 @@ public:
     
     // 增量解析
     bool incremental_parse(const std::vector<std::string>& packages);
+    // 监视模式下只检查上次调用以来变脏的包；清单变化、未开启监视或首次调用时全量扫描
     ChangeDetectionResult detect_project_changes();
+    // 丢弃变化的包的缓存结果并重新读取其清单，已移除的包只移出缓存；返回重新解析的包数
+    size_t apply_project_changes(const ChangeDetectionResult& changes);
+    
+    // 监视模式（监视当前目录下的清单与 packages/）
+    bool enable_watch_mode();
+    void disable_watch_mode();
+    bool is_watch_mode_active() const;
+    // 阻塞等待监视器报告事件（最长 timeout），有事件时返回 true；未开启监视时睡眠 timeout 后返回 false
+    bool wait_for_project_changes(std::chrono::milliseconds timeout) const;
     
     // 缓存管理
     void clear_cache();
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace Paker {
+
+class CSRDependencyGraph;
+
+// 在线拓扑序维护（Pearce-Kelly 算法）
+// 对边 from -> to 始终保持 position(from) < position(to)，与 topological_sort 的输出方向一致。
+// 插入一条违反当前顺序的边时，只在 [position(to), position(from)] 区间内做前向/后向搜索并重排，
+// 代价与受影响区域成正比；若搜索发现 from 可由 to 到达，则该边会引入循环依赖。
+class IncrementalTopologicalOrder {
+public:
+    using NodeId = uint32_t;
+
+    // 更新统计
+    struct Stats {
+        size_t edges_added = 0;           // 实际进入顺序的边（挂起的边在重新插入成功时计入）
+        size_t reorders = 0;              // 需要重排的插入次数
+        size_t nodes_visited = 0;         // 重排搜索累计访问的节点数
+        size_t cycles_detected = 0;
+        size_t last_affected_nodes = 0;   // 最近一次插入受影响的节点数
+    };
+
+    IncrementalTopologicalOrder() = default;
+
+    // 新节点追加到顺序末尾
+    NodeId add_node();
+    size_t node_count() const { return position_.size(); }
+
+    // 插入边。若会引入环：边记录为"挂起"（不参与排序约束），返回 false 并在 cycle 中给出环（首尾相同）。
+    // 挂起边在之后删除其他边时会重新尝试插入。
+    bool add_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle = nullptr);
+
+    // 仅在不引入环时插入，否则不做任何修改
+    bool try_add_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle = nullptr);
+
+    // 删除边（删除不会破坏已有顺序）
+    bool remove_edge(NodeId from, NodeId to);
+
+    bool has_edge(NodeId from, NodeId to) const;
+
+    // 当前图无环（没有挂起边）时顺序是完整有效的拓扑序
+    bool is_acyclic() const { return pending_edges_.empty(); }
+    const std::vector<std::pair<NodeId, NodeId>>& pending_edges() const { return pending_edges_; }
+
+    // 节点在顺序中的位置；位置 -> 节点
+    size_t position(NodeId node) const { return position_[node]; }
+    const std::vector<NodeId>& order() const { return node_at_; }
+
+    // 从冻结图整体重建（节点ID与CSR一致）
+    void rebuild(const CSRDependencyGraph& graph);
+
+    void clear();
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    // 返回 false 表示发现环；成功时完成重排
+    bool insert_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle);
+    bool discover_forward(NodeId start, uint32_t upper_bound, NodeId target, std::vector<NodeId>* cycle);
+    void discover_backward(NodeId start, uint32_t lower_bound);
+    void reorder();
+    void reset_marks();
+    void record_insert(bool inserted);
+    void retry_pending_edges();
+    static bool erase_from(std::vector<NodeId>& list, NodeId value);
+
+    std::vector<uint32_t> position_;
+    std::vector<NodeId> node_at_;
+    std::vector<std::vector<NodeId>> out_;
+    std::vector<std::vector<NodeId>> in_;
+    std::vector<std::pair<NodeId, NodeId>> pending_edges_;
+
+    // 搜索用的临时状态，跨调用复用避免重复分配
+    std::vector<uint8_t> mark_;
+    std::vector<NodeId> delta_forward_;
+    std::vector<NodeId> delta_backward_;
+    std::vector<NodeId> parent_;
+    std::vector<NodeId> stack_;
+
+    Stats stats_;
+};
+
+} // namespace Paker
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace Paker {
+
+// 一次轮询得到的变更集合
+struct WatchChanges {
+    std::set<std::string> dirty_packages;   // packages/ 下内容发生变化的包
+    bool manifest_changed = false;          // 项目清单被修改、创建或删除
+    bool overflowed = false;                // 事件队列溢出，本次结果来自 stat 重新校验
+
+    bool empty() const { return dirty_packages.empty() && !manifest_changed; }
+};
+
+// 项目清单与 packages/ 目录监视器
+// Linux 下基于 inotify：监视项目根目录（清单文件、packages 目录的创建删除）、
+// packages/ 目录本身及其每个一级子目录，事件在 poll_changes 时非阻塞地读取并归并为脏集合。
+// 同时维护各包清单的 stat 快照（mtime + 大小）：事件队列溢出或重新监视时，
+// 通过对比快照恢复出准确的脏集合，而不必重新哈希所有清单。
+// 非 Linux 平台上 start() 返回 false，调用方应回退到常规变更检测。
+class ManifestWatcher {
+public:
+    explicit ManifestWatcher(const std::string& project_root = ".",
+                             const std::string& manifest_name = "Paker.json");
+    ~ManifestWatcher();
+    ManifestWatcher(const ManifestWatcher&) = delete;
+    ManifestWatcher& operator=(const ManifestWatcher&) = delete;
+
+    // 建立监视并记录初始 stat 快照
+    bool start();
+    void stop();
+    bool is_active() const;
+
+    // 非阻塞读取所有待处理事件，返回自上次调用以来的变更并清空脏集合
+    WatchChanges poll_changes();
+
+    // 等待事件到达（最长 timeout），有事件可读时返回 true
+    // 可与 poll_changes/stop 在其他线程并发调用：重新监视或停止会唤醒等待者，
+    // 旧的 inotify 描述符由最后一个离开的等待者关闭，不会在 poll 期间被复用
+    bool wait_for_events(std::chrono::milliseconds timeout) const;
+
+    // 强制下一次 poll_changes 走 stat 重新校验（用于测试及外部检测到事件丢失时）
+    void mark_overflow();
+
+    size_t get_watch_count() const;
+    const std::string& get_project_root() const { return project_root_; }
+
+private:
+    // 清单文件的 stat 指纹
+    struct FileStamp {
+        int64_t mtime_ns = 0;
+        uint64_t size = 0;
+        bool exists = false;
+
+        bool operator==(const FileStamp& other) const {
+            return mtime_ns == other.mtime_ns && size == other.size && exists == other.exists;
+        }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    bool add_watches();
+    void remove_watches();
+    void release_retired_fds() const;
+    void watch_packages_directory();
+    void watch_package(const std::string& package);
+    void drain_events();
+    void handle_event(int wd, uint32_t mask, const std::string& name);
+
+    // stat 快照
+    FileStamp stat_file(const std::string& path) const;
+    FileStamp stat_package(const std::string& package) const;
+    std::map<std::string, FileStamp> scan_packages() const;
+    void resync(WatchChanges& changes);
+
+    std::string project_root_;
+    std::string manifest_name_;
+    std::string packages_dir_;
+
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;                          // 与对象同生命周期的 eventfd，与 inotify_fd_ 一起 poll
+    mutable size_t waiters_ = 0;                // 正在 poll 的 wait_for_events 调用数
+    mutable std::vector<int> retired_fds_;      // 等待者离开前不能关闭的旧 inotify 描述符
+    int root_wd_ = -1;
+    int packages_wd_ = -1;
+    std::unordered_map<int, std::string> package_wds_;  // wd -> 包名
+
+    std::set<std::string> dirty_packages_;
+    bool manifest_changed_ = false;
+    bool overflowed_ = false;
+
+    FileStamp manifest_stamp_;
+    std::map<std::string, FileStamp> package_stamps_;
+
+    mutable std::mutex mutex_;
+};
+
+} // namespace Paker
@@ -8,9 +8,15 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "Paker/dependency/incremental_topological_order.h"
 
 namespace Paker {
 
+class CSRDependencyGraph;
+class ReachabilityIndex;
+
 // 轻量级依赖节点
 struct LightweightDependencyNode {
     std::string name;
@@ -55,6 +61,28 @@ private:
     size_t max_cached_nodes_;
     size_t cache_cleanup_threshold_;
     
+    // 结构版本号与CSR快照；并发的 const 读者通过各自的互斥量串行惰性重建，
+    // 持有 reachability_mutex_ 或 topo_mutex_ 时可再获取 frozen_mutex_
+    uint64_t graph_version_ = 0;
+    mutable std::mutex frozen_mutex_;
+    mutable std::shared_ptr<const CSRDependencyGraph> frozen_;
+    mutable uint64_t frozen_version_ = 0;
+    mutable std::mutex reachability_mutex_;
+    mutable std::shared_ptr<const ReachabilityIndex> reachability_;
+    mutable uint64_t reachability_version_ = 0;
+    
+    // 在线维护的拓扑序（节点ID即索引）；删除节点会使索引整体移动，此时标记失效并惰性重建
+    mutable std::mutex topo_mutex_;
+    mutable IncrementalTopologicalOrder topo_order_;
+    mutable bool topo_dirty_ = false;
+    // 按值返回当前顺序，调用方在锁外使用不会与其他线程的重建竞争
+    struct TopologicalOrderSnapshot {
+        std::vector<uint32_t> order;
+        bool acyclic = true;
+    };
+    TopologicalOrderSnapshot ensure_topological_order() const;
+    void refresh_topological_order_locked() const;  // 需持有 topo_mutex_
+    
     // 内存管理
     void cleanup_cache();
     void update_access_time(size_t index) const;
@@ -79,15 +107,30 @@ public:
     // 依赖关系管理
     bool add_dependency(const std::string& from, const std::string& to);
     bool remove_dependency(const std::string& from, const std::string& to);
+    // 仅在不引入循环依赖时添加边，失败时 cycle 返回将形成的环
+    bool try_add_dependency(const std::string& from, const std::string& to,
+                            std::vector<std::string>* cycle = nullptr);
     std::vector<std::string> get_dependencies(const std::string& name) const;
     std::vector<std::string> get_dependents(const std::string& name) const;
     
+    // 传递依赖 / 传递被依赖与可达性查询（基于可达性索引）
+    std::vector<std::string> get_transitive_dependencies(const std::string& name) const;
+    std::vector<std::string> get_transitive_dependents(const std::string& name) const;
+    bool depends_on(const std::string& from, const std::string& to) const;
+    
     // 图算法
+    // 顺序保证同 DependencyGraph::topological_sort（在线维护，同层节点的先后不再按索引分层）
     std::vector<std::string> topological_sort() const;
+    bool is_acyclic() const;
     std::vector<std::vector<std::string>> detect_cycles() const;
     std::vector<std::vector<std::string>> get_all_paths(const std::string& from, 
                                                        const std::string& to) const;
     
+    // CSR快照（结构未变化时复用）
+    std::shared_ptr<const CSRDependencyGraph> freeze() const;
+    std::shared_ptr<const ReachabilityIndex> reachability_index() const;
+    uint64_t get_graph_version() const { return graph_version_; }
+    
     // 内存管理
     void optimize_memory();
     void clear_cache();
@@ -99,26 +142,23 @@ public:
     size_t get_edge_count() const;
     std::map<std::string, size_t> get_access_statistics() const;
     
-    // 序列化
+    // 序列化（load_from_file 会自动识别二进制快照）
     bool save_to_file(const std::string& filename) const;
     bool load_from_file(const std::string& filename);
     
+    // 二进制快照（见 graph_snapshot.h），适合跨进程缓存大图
+    bool save_to_snapshot(const std::string& filename, uint64_t fingerprint = 0) const;
+    bool load_from_snapshot(const std::string& filename);
+    
     // 批量操作
     void add_nodes_batch(const std::vector<LightweightDependencyNode>& nodes);
     void remove_nodes_batch(const std::vector<std::string>& names);
     
 private:
+    friend class CSRDependencyGraph;
+    
     // 内部辅助方法
     size_t get_node_index(const std::string& name) const;
-    void dfs_cycle_detection(size_t node_index, 
-                           std::unordered_set<size_t>& visited,
-                           std::unordered_set<size_t>& rec_stack,
-                           std::vector<size_t>& path,
-                           std::vector<std::vector<std::string>>& cycles) const;
-    void dfs_path_finding(size_t from_index, size_t to_index,
-                         std::unordered_set<size_t>& visited,
-                         std::vector<size_t>& current_path,
-                         std::vector<std::vector<std::string>>& all_paths) const;
 };
 
 // 依赖图构建器
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/graph_condensation.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Paker {
+
+// 可达性索引：在缩点DAG上预计算传递闭包，回答"谁（传递地）依赖 X"
+// 分量数不超过 max_bitset_components 时为每个分量保存后代/祖先位集，
+// 可达性查询为一次位测试，计数为 popcount，交集为按字 AND；
+// 更大的图改用区间标号（多次随机后序DFS），不包含关系可在 O(k) 内直接否定，其余情况做剪枝DFS。
+class ReachabilityIndex {
+public:
+    using NodeId = CSRDependencyGraph::NodeId;
+    using ComponentId = GraphCondensation::ComponentId;
+
+    enum class Mode {
+        BITSET,     // 位集传递闭包
+        INTERVAL    // 区间标号 + 剪枝搜索
+    };
+
+    // 8192 个分量时两组位集共约 16MB
+    static constexpr size_t DEFAULT_MAX_BITSET_COMPONENTS = 8192;
+    static constexpr size_t INTERVAL_LABELS = 3;
+
+    explicit ReachabilityIndex(std::shared_ptr<const CSRDependencyGraph> graph,
+                               size_t max_bitset_components = DEFAULT_MAX_BITSET_COMPONENTS);
+
+    const CSRDependencyGraph& graph() const { return *graph_; }
+    const GraphCondensation& condensation() const { return *condensation_; }
+    Mode mode() const { return mode_; }
+
+    // from 是否（传递地）依赖 to
+    bool reaches(NodeId from, NodeId to) const;
+
+    // 传递依赖 / 传递被依赖（不含自身，按节点ID升序）
+    std::vector<NodeId> transitive_dependencies(NodeId node) const;
+    std::vector<NodeId> transitive_dependents(NodeId node) const;
+    size_t count_transitive_dependencies(NodeId node) const;
+    size_t count_transitive_dependents(NodeId node) const;
+
+    // a 与 b 共同的传递依赖
+    std::vector<NodeId> common_dependencies(NodeId a, NodeId b) const;
+
+    // 按包名查询，未知包返回空结果
+    bool reaches(const std::string& from, const std::string& to) const;
+    std::vector<std::string> transitive_dependencies(const std::string& name) const;
+    std::vector<std::string> transitive_dependents(const std::string& name) const;
+
+    size_t get_memory_usage() const;
+
+private:
+    const uint64_t* descendants_row(ComponentId comp) const { return descendants_.data() + comp * words_; }
+    const uint64_t* ancestors_row(ComponentId comp) const { return ancestors_.data() + comp * words_; }
+
+    void build_bitsets();
+    void build_intervals();
+    bool interval_may_reach(ComponentId from, ComponentId to) const;
+    bool component_reaches(ComponentId from, ComponentId to) const;
+    std::vector<ComponentId> reachable_components(ComponentId start, bool forward) const;
+    std::vector<NodeId> expand(const std::vector<ComponentId>& components, NodeId exclude) const;
+    size_t count_members(const std::vector<ComponentId>& components, NodeId exclude) const;
+
+    std::shared_ptr<const CSRDependencyGraph> graph_;
+    std::unique_ptr<GraphCondensation> condensation_;
+    Mode mode_;
+
+    // 位集模式：每行 words_ 个 64 位字，行内包含分量自身
+    size_t words_ = 0;
+    std::vector<uint64_t> descendants_;
+    std::vector<uint64_t> ancestors_;
+
+    // 区间模式：每个分量 INTERVAL_LABELS 组 [low, post]
+    std::vector<uint32_t> interval_low_;
+    std::vector<uint32_t> interval_post_;
+};
+
+} // namespace Paker
@@ -32,11 +32,20 @@ bool AsyncCacheManager::initialize() {
         cache_manager_ = std::make_unique<CacheManager>();
     }
     
+    if (!write_combiner_) {
+        write_combiner_ = std::make_unique<CacheWriteCombiner>(write_combiner_config_);
+    }
+    
     LOG(INFO) << "AsyncCacheManager initialized";
     return true;
 }
 
 void AsyncCacheManager::shutdown() {
+    // 先写完剩余批次，之后的写入回到单文件路径；再次 initialize 时重新创建
+    if (write_combiner_) {
+        write_combiner_->stop();
+        write_combiner_.reset();
+    }
     LOG(INFO) << "AsyncCacheManager shutdown";
 }
 
@@ -98,6 +107,10 @@ std::future<std::shared_ptr<AsyncCacheReadResult>> AsyncCacheManager::read_cache
 std::future<std::shared_ptr<AsyncCacheWriteResult>> AsyncCacheManager::write_cache_async(
     const std::string& cache_key, const std::vector<char>& data) {
     
+    if (write_combiner_ && write_combiner_->accepts(data.size())) {
+        return combine_cache_write(cache_key, std::string(data.begin(), data.end()));
+    }
+    
     return std::async(std::launch::async, [this, cache_key, data]() -> std::shared_ptr<AsyncCacheWriteResult> {
         auto result = std::make_shared<AsyncCacheWriteResult>();
         auto start_time = std::chrono::high_resolution_clock::now();
@@ -141,6 +154,10 @@ std::future<std::shared_ptr<AsyncCacheWriteResult>> AsyncCacheManager::write_cac
 std::future<std::shared_ptr<AsyncCacheWriteResult>> AsyncCacheManager::write_cache_async(
     const std::string& cache_key, const std::string& content) {
     
+    if (write_combiner_ && write_combiner_->accepts(content.size())) {
+        return combine_cache_write(cache_key, content);
+    }
+    
     return std::async(std::launch::async, [this, cache_key, content]() -> std::shared_ptr<AsyncCacheWriteResult> {
         auto result = std::make_shared<AsyncCacheWriteResult>();
         auto start_time = std::chrono::high_resolution_clock::now();
@@ -207,6 +224,168 @@ std::vector<std::future<std::shared_ptr<AsyncCacheWriteResult>>> AsyncCacheManag
     return futures;
 }
 
+std::future<std::shared_ptr<AsyncCacheWriteResult>> AsyncCacheManager::combine_cache_write(
+    const std::string& cache_key, std::string content) {
+    
+    total_writes_++;
+    async_operations_++;
+    
+    auto promise = std::make_shared<std::promise<std::shared_ptr<AsyncCacheWriteResult>>>();
+    auto future = promise->get_future();
+    std::string cache_path = get_cache_path(cache_key);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    write_combiner_->submit(cache_path, std::move(content),
+        [this, promise, cache_key, cache_path, start_time](bool success, size_t bytes) {
+            auto result = std::make_shared<AsyncCacheWriteResult>();
+            result->success = success;
+            if (success) {
+                result->cache_key = cache_key;
+                result->cache_path = cache_path;
+                result->bytes_written = bytes;
+                result->bytes_processed = bytes;
+            } else {
+                result->error_message = "Failed to write cache file: " + cache_path;
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            result->duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+            update_write_stats(result->duration);
+            promise->set_value(std::move(result));
+        });
+    
+    return future;
+}
+
+void AsyncCacheManager::set_write_combiner_config(const WriteCombinerConfig& config) {
+    write_combiner_config_ = config;
+    if (write_combiner_) {
+        write_combiner_->set_config(config);
+    }
+}
+
+WriteCombinerStats AsyncCacheManager::get_write_combiner_stats() const {
+    return write_combiner_ ? write_combiner_->get_stats() : WriteCombinerStats();
+}
+
+void AsyncCacheManager::flush_pending_writes() {
+    if (write_combiner_) {
+        write_combiner_->flush();
+    }
+}
+
+#if defined(PAKER_HAVE_COROUTINES)
+namespace {
+
+// 交给写合并器，落盘回调里恢复协程
+struct CombinedWriteAwaiter {
+    CacheWriteCombiner& combiner;
+    std::string path;
+    std::string content;
+    bool success = false;
+    size_t bytes = 0;
+    
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        combiner.submit(path, std::move(content), [this, handle](bool ok, size_t written) {
+            success = ok;
+            bytes = written;
+            handle.resume();
+        });
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace
+
+task<std::shared_ptr<AsyncCacheReadResult>> AsyncCacheManager::read_cache_task(
+    std::string cache_key, bool read_as_text) {
+    
+    auto result = std::make_shared<AsyncCacheReadResult>();
+    auto start_time = std::chrono::high_resolution_clock::now();
+    total_reads_++;
+    async_operations_++;
+    
+    std::string cache_path = get_cache_path(cache_key);
+    if (!fs::exists(cache_path)) {
+        result->error_message = "Cache key not found: " + cache_key;
+        update_read_stats(std::chrono::milliseconds(0), false);
+        co_return result;
+    }
+    
+    auto io_result = co_await async_io_manager_->read_file_task(cache_path, read_as_text);
+    if (!io_result || io_result->status != IOOperationStatus::COMPLETED) {
+        result->error_message = "Failed to read cache file: " + cache_path;
+    } else {
+        result->success = true;
+        result->data = std::move(io_result->data);
+        result->content = std::move(io_result->content);
+        result->cache_size = io_result->file_size;
+        result->bytes_processed = io_result->bytes_processed;
+        result->last_modified = std::chrono::system_clock::now();
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result->duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    update_read_stats(result->duration, result->success);
+    co_return result;
+}
+
+task<std::shared_ptr<AsyncCacheWriteResult>> AsyncCacheManager::write_cache_task(
+    std::string cache_key, std::string content) {
+    
+    auto result = std::make_shared<AsyncCacheWriteResult>();
+    auto start_time = std::chrono::high_resolution_clock::now();
+    total_writes_++;
+    async_operations_++;
+    
+    std::string cache_path = get_cache_path(cache_key);
+    if (write_combiner_ && write_combiner_->accepts(content.size())) {
+        CombinedWriteAwaiter write{*write_combiner_, cache_path, std::move(content)};
+        co_await write;
+        result->success = write.success;
+        if (write.success) {
+            result->cache_key = cache_key;
+            result->cache_path = cache_path;
+            result->bytes_written = write.bytes;
+            result->bytes_processed = write.bytes;
+        } else {
+            result->error_message = "Failed to write cache file: " + cache_path;
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        result->duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        update_write_stats(result->duration);
+        co_return result;
+    }
+    
+    auto io_result = co_await async_io_manager_->write_file_task(cache_path, std::move(content));
+    if (!io_result || io_result->status != IOOperationStatus::COMPLETED) {
+        result->error_message = "Failed to write cache file: " + cache_path;
+    } else {
+        result->success = true;
+        result->cache_key = cache_key;
+        result->cache_path = cache_path;
+        result->bytes_written = io_result->bytes_written;
+        result->bytes_processed = io_result->bytes_written;
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result->duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    update_write_stats(result->duration);
+    co_return result;
+}
+
+task<std::vector<std::shared_ptr<AsyncCacheReadResult>>> AsyncCacheManager::read_multiple_cache_task(
+    std::vector<std::string> cache_keys, bool read_as_text) {
+    
+    std::vector<task<std::shared_ptr<AsyncCacheReadResult>>> reads;
+    reads.reserve(cache_keys.size());
+    for (auto& cache_key : cache_keys) {
+        reads.push_back(read_cache_task(std::move(cache_key), read_as_text));
+    }
+    co_return co_await when_all(std::move(reads));
+}
+#endif
+
 std::future<bool> AsyncCacheManager::clear_cache_async() {
     return std::async(std::launch::async, [this]() -> bool {
         try {
@@ -426,6 +605,22 @@ std::string AsyncCacheManager::get_performance_report() const {
     ss << "  Average read time: " << get_average_read_time() << "ms\n";
     ss << "  Average write time: " << get_average_write_time() << "ms\n";
     
+    if (write_combiner_) {
+        WriteCombinerStats combined = write_combiner_->get_stats();
+        WriteCombinerConfig config = write_combiner_->get_config();
+        ss << "  Write combining: " << (config.enabled ? "enabled" : "disabled")
+           << " (window " << config.max_delay.count() << "us, up to " << config.max_batch_entries << " files)\n";
+        ss << "    Combined writes: " << combined.writes_submitted
+           << " (" << combined.writes_coalesced << " overwritten within a batch)\n";
+        ss << "    Batches: " << combined.batches << ", average " << combined.average_batch_size()
+           << " files, max " << combined.max_batch_size << ", io_uring " << combined.io_uring_batches << "\n";
+        ss << "    Durable flushes: " << combined.files_flushed << " files in " << combined.durable_batches
+           << " batches\n";
+        ss << "    Failed writes: " << combined.failed_writes << "\n";
+        ss << "    Average combined write latency: " << combined.average_latency_ms() << "ms (max "
+           << combined.max_latency.count() / 1000.0 << "ms)\n";
+    }
+    
     return ss.str();
 }
 
@@ -0,0 +1,566 @@
+#include "Paker/cache/blob_store.h"
+#include "Paker/cache/cache_lock.h"
+#include "Paker/cache/materializer.h"
+#include "Paker/core/content_hash.h"
+#include <glog/logging.h>
+#include "nlohmann/json.hpp"
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+bool same_inode(const struct stat& a, const struct stat& b) {
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+// 用指向 blob 的硬链接原子替换 path；链接数已满或跨设备时失败
+bool replace_with_link(const std::string& blob_path, const std::string& path) {
+    std::string temp = path + ".paker-blob";
+    ::unlink(temp.c_str());
+    if (::link(blob_path.c_str(), temp.c_str()) != 0) {
+        return false;
+    }
+    if (::rename(temp.c_str(), path.c_str()) != 0) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+BlobStore::BlobStore(const std::string& root)
+    : root_(root), read_only_blobs_(false), loaded_(false), manifest_count_(0) {}
+
+std::string BlobStore::hash_file(const std::string& path) {
+    return sha256_file(path);
+}
+
+std::string BlobStore::hash_data(const std::string& data) {
+    return sha256_data(data);
+}
+
+std::string BlobStore::blob_path(const std::string& blob) const {
+    // 按哈希前两位分目录，避免单个目录下文件过多
+    return root_ + "/blobs/" + blob.substr(0, 2) + "/" + blob.substr(2);
+}
+
+std::string BlobStore::manifest_path(const std::string& package, const std::string& version) const {
+    return root_ + "/manifests/" + package + "/" + (version.empty() ? "latest" : version) + ".json";
+}
+
+std::string BlobStore::refs_path(const std::string& owner) const {
+    // owner 通常是路径，取其哈希作文件名
+    return root_ + "/refs/" + hash_data(owner) + ".json";
+}
+
+std::string BlobStore::lock_path() const {
+    std::error_code ec;
+    fs::create_directories(root_, ec);
+    return root_ + "/gc.lock";
+}
+
+bool BlobStore::has_manifest(const std::string& package, const std::string& version) const {
+    std::error_code ec;
+    return fs::exists(manifest_path(package, version), ec);
+}
+
+std::vector<BlobManifestEntry> BlobStore::load_manifest(const std::string& package, const std::string& version) const {
+    std::vector<BlobManifestEntry> entries;
+    std::string path = manifest_path(package, version);
+    try {
+        std::ifstream file(path);
+        if (!file) {
+            return entries;
+        }
+        json j;
+        file >> j;
+        for (const auto& item : j["files"]) {
+            BlobManifestEntry entry;
+            entry.path = item["path"].get<std::string>();
+            entry.blob = item["blob"].get<std::string>();
+            entry.size = item["size"].get<size_t>();
+            entries.push_back(std::move(entry));
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read blob manifest " << path << ": " << e.what();
+        entries.clear();
+    }
+    return entries;
+}
+
+std::vector<BlobManifestEntry> BlobStore::load_refs(const std::string& path, std::string* owner) const {
+    std::vector<BlobManifestEntry> entries;
+    try {
+        std::ifstream file(path);
+        if (!file) {
+            return entries;
+        }
+        json j;
+        file >> j;
+        if (owner) {
+            *owner = j.value("owner", "");
+        }
+        for (const auto& item : j["files"]) {
+            BlobManifestEntry entry;
+            entry.path = item.value("path", "");
+            entry.blob = item["blob"].get<std::string>();
+            entry.size = item["size"].get<size_t>();
+            entries.push_back(std::move(entry));
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read blob references " << path << ": " << e.what();
+        entries.clear();
+    }
+    return entries;
+}
+
+bool BlobStore::write_manifest(const std::string& package, const std::string& version,
+                               const std::vector<BlobManifestEntry>& entries) const {
+    std::string path = manifest_path(package, version);
+    std::string temp = path + ".tmp";
+    try {
+        json files = json::array();
+        for (const auto& entry : entries) {
+            files.push_back({{"path", entry.path}, {"blob", entry.blob}, {"size", entry.size}});
+        }
+        json j = {{"package", package}, {"version", version}, {"files", std::move(files)}};
+
+        fs::create_directories(fs::path(path).parent_path());
+        {
+            std::ofstream file(temp);
+            file << j.dump();
+            if (!file) {
+                return false;
+            }
+        }
+        fs::rename(temp, path);
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to write blob manifest " << path << ": " << e.what();
+        std::error_code ec;
+        fs::remove(temp, ec);
+        return false;
+    }
+}
+
+void BlobStore::ensure_loaded() const {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+
+    std::error_code ec;
+    fs::path manifests = fs::path(root_) / "manifests";
+    for (const auto& package_entry : fs::directory_iterator(manifests, ec)) {
+        if (!package_entry.is_directory()) {
+            continue;
+        }
+        for (const auto& entry : fs::directory_iterator(package_entry.path(), ec)) {
+            if (entry.path().extension() != ".json") {
+                continue;
+            }
+            add_refs(load_manifest(package_entry.path().filename().string(), entry.path().stem().string()), true);
+            manifest_count_++;
+        }
+    }
+    // 外部引用计入引用计数，但不算作版本
+    for (const auto& entry : fs::directory_iterator(fs::path(root_) / "refs", ec)) {
+        if (entry.path().extension() == ".json") {
+            add_refs(load_refs(entry.path().string()), false);
+        }
+    }
+    LOG(INFO) << "Blob store " << root_ << ": " << manifest_count_ << " manifests, " << blobs_.size() << " blobs";
+}
+
+void BlobStore::reload() const {
+    loaded_ = false;
+    manifest_count_ = 0;
+    blobs_.clear();
+    zero_ref_.clear();
+    ensure_loaded();
+}
+
+void BlobStore::add_refs(const std::vector<BlobManifestEntry>& entries, bool from_tree) const {
+    for (const auto& entry : entries) {
+        BlobInfo& info = blobs_[entry.blob];
+        info.refs++;
+        if (from_tree) {
+            info.tree_refs++;
+        }
+        info.size = entry.size;
+        zero_ref_.erase(entry.blob);
+    }
+}
+
+void BlobStore::drop_refs(const std::vector<BlobManifestEntry>& entries, bool from_tree) const {
+    for (const auto& entry : entries) {
+        auto it = blobs_.find(entry.blob);
+        if (it == blobs_.end() || it->second.refs == 0) {
+            continue;
+        }
+        if (from_tree && it->second.tree_refs > 0) {
+            it->second.tree_refs--;
+        }
+        if (--it->second.refs == 0) {
+            zero_ref_.insert(entry.blob);
+        }
+    }
+}
+
+BlobIngestResult BlobStore::ingest_tree(const std::string& package, const std::string& version,
+                                        const std::string& tree_path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 共享锁期间其他进程不会回收，刚确认存在的 blob 不会在链接前被删除
+    FileLock store_lock;
+    store_lock.lock(lock_path(), FileLock::Mode::SHARED);
+    ensure_loaded();
+
+    BlobIngestResult result;
+    bool replacing = has_manifest(package, version);
+    if (replacing) {
+        drop_refs(load_manifest(package, version), true);
+    }
+
+    std::vector<BlobManifestEntry> entries;
+    bool reflink_fallback = FileMaterializer::filesystem_supports_reflink(root_);
+    try {
+        fs::create_directories(fs::path(root_) / "blobs");
+        for (auto it = fs::recursive_directory_iterator(tree_path); it != fs::recursive_directory_iterator(); ++it) {
+            // .git 中的元数据会被 git 原地改写（如 FETCH_HEAD），不纳入存储
+            if (it->is_directory() && it->path().filename() == ".git") {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if (it->is_symlink() || !it->is_regular_file()) {
+                continue;
+            }
+            std::string path = it->path().string();
+            struct stat st;
+            if (::lstat(path.c_str(), &st) != 0) {
+                continue;
+            }
+            result.files++;
+
+            std::string hash = hash_file(path);
+            if (hash.empty()) {
+                result.unlinked++;
+                continue;
+            }
+            // 硬链接共享权限位，可执行文件单独成 blob
+            std::string blob = (st.st_mode & S_IXUSR) ? hash + "-x" : hash;
+            std::string target = blob_path(blob);
+            fs::create_directories(fs::path(target).parent_path());
+
+            bool stored = false;
+            for (int attempt = 0; attempt < 2 && !stored; ++attempt) {
+                struct stat blob_st;
+                if (::lstat(target.c_str(), &blob_st) == 0) {
+                    // 内容已存在：替换为链接，释放这一份数据
+                    if (same_inode(st, blob_st) || replace_with_link(target, path) ||
+                        (reflink_fallback && FileMaterializer::copy_file(target, path))) {
+                        if (!same_inode(st, blob_st)) {
+                            result.deduplicated++;
+                            result.bytes_reclaimed += static_cast<size_t>(st.st_size);
+                        }
+                        stored = true;
+                    }
+                    break;
+                }
+
+                // 新内容：文件本身成为 blob
+                if (read_only_blobs_) {
+                    ::chmod(path.c_str(), st.st_mode & 07555);
+                }
+                if (::link(path.c_str(), target.c_str()) == 0) {
+                    result.new_blobs++;
+                    stored = true;
+                } else if (errno == EEXIST) {
+                    continue;  // 并发写入了同一内容，按已存在处理
+                } else if (reflink_fallback && FileMaterializer::copy_file(path, target)) {
+                    result.new_blobs++;
+                    stored = true;
+                }
+            }
+            if (!stored) {
+                result.unlinked++;
+                continue;
+            }
+
+            BlobManifestEntry entry;
+            entry.path = it->path().lexically_relative(tree_path).string();
+            entry.blob = blob;
+            entry.size = static_cast<size_t>(st.st_size);
+            entries.push_back(std::move(entry));
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to ingest " << tree_path << " into blob store: " << e.what();
+    }
+
+    if (!write_manifest(package, version, entries)) {
+        // 已链接的文件仍是完整内容，只是这些 blob 暂时没有清单引用，由全量回收处理
+        if (replacing) {
+            std::error_code ec;
+            fs::remove(manifest_path(package, version), ec);
+            manifest_count_--;
+        }
+        return result;
+    }
+    add_refs(entries, true);
+    if (!replacing) {
+        manifest_count_++;
+    }
+    result.success = true;
+
+    LOG(INFO) << "Ingested " << package << "@" << version << " into blob store: " << result.files << " files, "
+              << result.new_blobs << " new blobs, " << result.deduplicated << " deduplicated ("
+              << result.bytes_reclaimed << " bytes reclaimed)";
+    return result;
+}
+
+bool BlobStore::release_tree(const std::string& package, const std::string& version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 回收持有独占锁并按磁盘上的清单重建计数，删除清单必须与之互斥
+    FileLock store_lock;
+    store_lock.lock(lock_path(), FileLock::Mode::SHARED);
+    ensure_loaded();
+    if (!has_manifest(package, version)) {
+        return false;
+    }
+
+    drop_refs(load_manifest(package, version), true);
+    std::error_code ec;
+    fs::path path = manifest_path(package, version);
+    fs::remove(path, ec);
+    if (fs::is_empty(path.parent_path(), ec)) {
+        fs::remove(path.parent_path(), ec);
+    }
+    manifest_count_--;
+    return true;
+}
+
+bool BlobStore::store_copy(const std::string& source, const std::string& blob, bool& created) {
+    created = false;
+    FileLock store_lock;
+    store_lock.lock(lock_path(), FileLock::Mode::SHARED);
+    std::string target = blob_path(blob);
+    struct stat st;
+    if (::lstat(target.c_str(), &st) == 0) {
+        return true;
+    }
+    std::error_code ec;
+    fs::create_directories(fs::path(target).parent_path(), ec);
+    // 先写临时文件再改名，其他进程不会看到不完整的 blob；临时文件不会被回收误删
+    std::string temp = target + ".tmp" + std::to_string(::getpid());
+    if (!FileMaterializer::copy_file(source, temp)) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    ::chmod(temp.c_str(), 0444);
+    if (::rename(temp.c_str(), target.c_str()) != 0) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    created = true;
+    return true;
+}
+
+bool BlobStore::retain(const std::string& owner, const std::vector<BlobManifestEntry>& entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FileLock store_lock;
+    store_lock.lock(lock_path(), FileLock::Mode::SHARED);
+    ensure_loaded();
+
+    std::string path = refs_path(owner);
+    std::string temp = path + ".tmp";
+    try {
+        json files = json::array();
+        for (const auto& entry : entries) {
+            files.push_back({{"path", entry.path}, {"blob", entry.blob}, {"size", entry.size}});
+        }
+        fs::create_directories(fs::path(path).parent_path());
+        {
+            std::ofstream file(temp);
+            file << json({{"owner", owner}, {"files", std::move(files)}}).dump();
+            if (!file) {
+                fs::remove(temp);
+                return false;
+            }
+        }
+        // 先计入新引用再撤销旧引用，两者共有的 blob 计数不会短暂降为 0
+        std::vector<BlobManifestEntry> previous = load_refs(path);
+        fs::rename(temp, path);
+        add_refs(entries, false);
+        drop_refs(previous, false);
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to write blob references " << path << ": " << e.what();
+        std::error_code ec;
+        fs::remove(temp, ec);
+        return false;
+    }
+}
+
+bool BlobStore::release(const std::string& owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FileLock store_lock;
+    store_lock.lock(lock_path(), FileLock::Mode::SHARED);
+    ensure_loaded();
+
+    std::string path = refs_path(owner);
+    std::vector<BlobManifestEntry> entries = load_refs(path);
+    std::error_code ec;
+    if (!fs::remove(path, ec)) {
+        return false;
+    }
+    drop_refs(entries, false);
+    return true;
+}
+
+std::vector<std::string> BlobStore::list_owners() const {
+    std::vector<std::string> owners;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(root_) / "refs", ec)) {
+        if (entry.path().extension() != ".json") {
+            continue;
+        }
+        std::string owner;
+        load_refs(entry.path().string(), &owner);
+        if (!owner.empty()) {
+            owners.push_back(std::move(owner));
+        }
+    }
+    return owners;
+}
+
+bool BlobStore::remove_blob_if_unreferenced(const std::string& blob, size_t& freed) const {
+    auto it = blobs_.find(blob);
+    if (it != blobs_.end() && it->second.refs > 0) {
+        return false;
+    }
+    std::string path = blob_path(blob);
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) {
+        blobs_.erase(blob);
+        return true;
+    }
+    // 仍有未登记的硬链接（版本目录尚未删除、工程中的硬链接树）时保留
+    if (st.st_nlink > 1) {
+        return false;
+    }
+    if (::unlink(path.c_str()) != 0) {
+        return false;
+    }
+    freed += static_cast<size_t>(st.st_size);
+    blobs_.erase(blob);
+    return true;
+}
+
+size_t BlobStore::collect_garbage(bool full_scan) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FileLock store_lock;
+    if (!store_lock.lock(lock_path(), FileLock::Mode::EXCLUSIVE)) {
+        LOG(WARNING) << "Skipping blob store garbage collection: cannot lock " << root_;
+        return 0;
+    }
+    // 本实例加载之后其他进程可能新增了清单或引用，以磁盘上的清单为准重建计数；
+    // 本进程已知的候选保留下来，重建后仍无引用的才删除
+    ensure_loaded();
+    std::unordered_set<std::string> candidates = std::move(zero_ref_);
+    reload();
+    for (const auto& blob : candidates) {
+        auto found = blobs_.find(blob);
+        if (found == blobs_.end() || found->second.refs == 0) {
+            zero_ref_.insert(blob);
+        }
+    }
+
+    size_t freed = 0;
+    size_t removed = 0;
+    for (auto it = zero_ref_.begin(); it != zero_ref_.end();) {
+        if (remove_blob_if_unreferenced(*it, freed)) {
+            removed++;
+            it = zero_ref_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (full_scan) {
+        std::error_code ec;
+        fs::path blobs_dir = fs::path(root_) / "blobs";
+        for (const auto& prefix : fs::directory_iterator(blobs_dir, ec)) {
+            for (const auto& entry : fs::directory_iterator(prefix.path(), ec)) {
+                std::string blob = prefix.path().filename().string() + entry.path().filename().string();
+                // 其他进程正在写入的 *.tmp<pid> 不是 blob
+                if (blob.find(".tmp") != std::string::npos) {
+                    continue;
+                }
+                if (remove_blob_if_unreferenced(blob, freed)) {
+                    removed++;
+                    zero_ref_.erase(blob);
+                }
+            }
+        }
+    }
+
+    if (removed > 0) {
+        LOG(INFO) << "Blob store garbage collection removed " << removed << " blobs, freed " << freed << " bytes";
+    }
+    return freed;
+}
+
+size_t BlobStore::exclusive_bytes(const std::string& package, const std::string& version) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ensure_loaded();
+
+    std::unordered_map<std::string, size_t> uses;
+    size_t total = 0;
+    for (const auto& entry : load_manifest(package, version)) {
+        uses[entry.blob]++;
+    }
+    for (const auto& [blob, count] : uses) {
+        auto it = blobs_.find(blob);
+        if (it != blobs_.end() && it->second.refs == count) {
+            total += it->second.size;
+        }
+    }
+    return total;
+}
+
+size_t BlobStore::get_refcount(const std::string& blob) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ensure_loaded();
+    auto it = blobs_.find(blob);
+    return it == blobs_.end() ? 0 : it->second.refs;
+}
+
+BlobStoreStats BlobStore::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ensure_loaded();
+
+    BlobStoreStats stats;
+    stats.manifests = manifest_count_;
+    stats.unreferenced_blobs = zero_ref_.size();
+    for (const auto& [blob, info] : blobs_) {
+        stats.blobs++;
+        stats.stored_bytes += info.size;
+        if (info.tree_refs > 0) {
+            stats.tree_bytes += info.size;
+        }
+        stats.logical_bytes += info.size * info.refs;
+    }
+    return stats;
+}
+
+} // namespace Paker
@@ -0,0 +1,218 @@
+#include "Paker/cache/cache_lock.h"
+#include <glog/logging.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 乐观重试的次数上限，之后在锁内读取并提交，保证有进展
+constexpr int kMaxOptimisticAttempts = 8;
+
+} // namespace
+
+FileLock::~FileLock() {
+    unlock();
+}
+
+FileLock::FileLock(FileLock&& other) noexcept : fd_(other.fd_) {
+    other.fd_ = -1;
+}
+
+FileLock& FileLock::operator=(FileLock&& other) noexcept {
+    if (this != &other) {
+        unlock();
+        fd_ = other.fd_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool FileLock::lock(const std::string& path, Mode mode) {
+    return acquire(path, mode, true);
+}
+
+bool FileLock::try_lock(const std::string& path, Mode mode) {
+    return acquire(path, mode, false);
+}
+
+bool FileLock::acquire(const std::string& path, Mode mode, bool wait) {
+    unlock();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG(WARNING) << "Failed to open lock file " << path << ": " << std::strerror(errno);
+        return false;
+    }
+    int operation = (mode == Mode::SHARED ? LOCK_SH : LOCK_EX) | (wait ? 0 : LOCK_NB);
+    int ret;
+    do {
+        ret = ::flock(fd, operation);
+    } while (ret != 0 && errno == EINTR);
+    if (ret != 0) {
+        if (errno != EWOULDBLOCK) {
+            LOG(WARNING) << "Failed to lock " << path << ": " << std::strerror(errno);
+        }
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    return true;
+}
+
+void FileLock::unlock() {
+    if (fd_ >= 0) {
+        ::flock(fd_, LOCK_UN);
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+InstallLock::InstallLock(const std::string& cache_path) : path_(lock_path(cache_path)) {
+}
+
+bool InstallLock::acquire() {
+    std::error_code ec;
+    fs::create_directories(fs::path(path_).parent_path(), ec);
+    if (lock_.try_lock(path_)) {
+        waited_ = false;
+        return true;
+    }
+    waited_ = true;
+    LOG(INFO) << "Waiting for another process holding " << path_;
+    return lock_.lock(path_);
+}
+
+SharedIndexFile::SharedIndexFile(const std::string& path) : path_(path) {
+}
+
+bool SharedIndexFile::read(json& data, uint64_t& generation) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_locked(data, generation);
+}
+
+bool SharedIndexFile::read_locked(json& data, uint64_t& generation) const {
+    // 先记下文件身份再读取：中途被替换只会让下一次 changed() 多报一次
+    remember_identity();
+    data = json::object();
+    generation = 0;
+    if (identity_inode_ == 0) {
+        generation_ = 0;
+        return true;
+    }
+    try {
+        std::ifstream file(path_);
+        json document;
+        file >> document;
+        if (document.is_object() && document.contains("generation") && document.contains("data")) {
+            generation = document["generation"].get<uint64_t>();
+            data = std::move(document["data"]);
+        } else {
+            data = std::move(document);
+        }
+        generation_ = generation;
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Error reading index " << path_ << ": " << e.what();
+        return false;
+    }
+}
+
+void SharedIndexFile::remember_identity() const {
+    struct stat st;
+    if (::stat(path_.c_str(), &st) != 0) {
+        identity_inode_ = 0;
+        identity_mtime_ns_ = -1;
+        return;
+    }
+    identity_inode_ = static_cast<uint64_t>(st.st_ino);
+    identity_mtime_ns_ = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+bool SharedIndexFile::changed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    struct stat st;
+    if (::stat(path_.c_str(), &st) != 0) {
+        return identity_inode_ != 0;
+    }
+    int64_t mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return static_cast<uint64_t>(st.st_ino) != identity_inode_ || mtime_ns != identity_mtime_ns_;
+}
+
+bool SharedIndexFile::commit(const std::function<void(json&)>& rebase, json* committed) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::error_code ec;
+    fs::create_directories(fs::path(path_).parent_path(), ec);
+
+    for (int attempt = 0;; ++attempt) {
+        // 锁外读取快照并生成新文档
+        json data;
+        uint64_t base = 0;
+        if (!read_locked(data, base)) {
+            data = json::object();
+        }
+        uint64_t base_inode = identity_inode_;
+        int64_t base_mtime_ns = identity_mtime_ns_;
+        rebase(data);
+
+        FileLock lock;
+        if (!lock.lock(path_ + ".lock")) {
+            return false;
+        }
+        // 文件被替换过说明其他写者已提交了新的一代
+        remember_identity();
+        if (identity_inode_ != base_inode || identity_mtime_ns_ != base_mtime_ns) {
+            conflicts_++;
+            if (attempt + 1 < kMaxOptimisticAttempts) {
+                continue;
+            }
+            if (!read_locked(data, base)) {
+                data = json::object();
+            }
+            rebase(data);
+        }
+
+        std::string temp = path_ + ".tmp." + std::to_string(::getpid());
+        {
+            std::ofstream file(temp, std::ios::trunc);
+            file << json{{"generation", base + 1}, {"data", data}}.dump(2);
+            if (!file) {
+                LOG(ERROR) << "Failed to write index " << temp;
+                fs::remove(temp, ec);
+                return false;
+            }
+        }
+        if (::rename(temp.c_str(), path_.c_str()) != 0) {
+            LOG(ERROR) << "Failed to replace index " << path_ << ": " << std::strerror(errno);
+            fs::remove(temp, ec);
+            return false;
+        }
+        remember_identity();
+        generation_ = base + 1;
+        if (committed) {
+            *committed = std::move(data);
+        }
+        return true;
+    }
+}
+
+uint64_t SharedIndexFile::get_generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+uint64_t SharedIndexFile::get_conflicts() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conflicts_;
+}
+
+} // namespace Paker
@@ -1,5 +1,12 @@
 #include "Paker/cache/cache_manager.h"
+#include "Paker/cache/cache_lock.h"
+#include "Paker/cache/cache_monitor.h"
 #include "Paker/cache/cache_path_resolver.h"
+#include "Paker/cache/generation_manager.h"
+#include "Paker/cache/materializer.h"
+#include "Paker/cache/prefetch_model.h"
+#include "Paker/cache/remote_cache.h"
+#include "Paker/cache/seekable_archive.h"
 #include "Paker/core/output.h"
 #include "Paker/core/utils.h"
 #include "Paker/core/memory_pool.h"
@@ -19,6 +26,95 @@ namespace fs = std::filesystem;
 
 namespace Paker {
 
+namespace {
+
+// COMPRESSED 存储的版本保存为版本目录旁的可随机读取归档
+std::string archive_path_for(const std::string& cache_path) {
+    return cache_path + ".pkar";
+}
+
+using PackageIndex = std::map<std::string, std::map<std::string, PackageCacheInfo>>;
+
+json package_info_to_json(const PackageCacheInfo& info) {
+    return {
+        {"cache_path", info.cache_path},
+        {"repository_url", info.repository_url},
+        {"size_bytes", info.size_bytes},
+        {"access_count", info.access_count},
+        {"is_active", info.is_active},
+        {"install_time", std::chrono::system_clock::to_time_t(info.install_time)},
+        {"last_access", std::chrono::system_clock::to_time_t(info.last_access)}
+    };
+}
+
+PackageIndex parse_package_index(const json& data) {
+    PackageIndex index;
+    for (const auto& [package, versions] : data.items()) {
+        for (const auto& [version, info] : versions.items()) {
+            PackageCacheInfo pkg_info;
+            pkg_info.package_name = package;
+            pkg_info.version = version;
+            pkg_info.cache_path = info["cache_path"];
+            pkg_info.repository_url = info["repository_url"];
+            pkg_info.size_bytes = info["size_bytes"];
+            pkg_info.access_count = info["access_count"];
+            pkg_info.is_active = info["is_active"];
+            
+            // 解析时间戳
+            if (info.contains("install_time")) {
+                pkg_info.install_time = std::chrono::system_clock::from_time_t(info["install_time"]);
+            }
+            if (info.contains("last_access")) {
+                pkg_info.last_access = std::chrono::system_clock::from_time_t(info["last_access"]);
+            }
+            
+            index[package][version] = pkg_info;
+        }
+    }
+    return index;
+}
+
+// 本进程相对 base 的修改：{包: {版本: 条目}}，条目为 null 表示删除
+json diff_package_index(const PackageIndex& base, const PackageIndex& current) {
+    json delta = json::object();
+    for (const auto& [package, versions] : current) {
+        auto base_pkg = base.find(package);
+        for (const auto& [version, info] : versions) {
+            json entry = package_info_to_json(info);
+            if (base_pkg == base.end() || !base_pkg->second.count(version) ||
+                package_info_to_json(base_pkg->second.at(version)) != entry) {
+                delta[package][version] = std::move(entry);
+            }
+        }
+    }
+    for (const auto& [package, versions] : base) {
+        auto current_pkg = current.find(package);
+        for (const auto& [version, info] : versions) {
+            if (current_pkg == current.end() || !current_pkg->second.count(version)) {
+                delta[package][version] = nullptr;
+            }
+        }
+    }
+    return delta;
+}
+
+void apply_package_index_delta(json& data, const json& delta) {
+    for (const auto& [package, versions] : delta.items()) {
+        for (const auto& [version, entry] : versions.items()) {
+            if (!entry.is_null()) {
+                data[package][version] = entry;
+            } else if (data.contains(package)) {
+                data[package].erase(version);
+                if (data[package].empty()) {
+                    data.erase(package);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
 // 全局缓存管理器实例
 std::unique_ptr<CacheManager> g_cache_manager;
 
@@ -31,6 +127,8 @@ CacheManager::CacheManager()
     , memory_pool_(std::make_unique<SmartMemoryPool>(256 * 1024 * 1024))  // 256MB内存池
     , compression_enabled_(true)
     , preallocation_enabled_(true)
+    , content_store_enabled_(true)
+    , read_only_store_(false)
     , initialized_(false) {
     
     // 初始化内存池
@@ -42,6 +140,8 @@ CacheManager::CacheManager()
 
 CacheManager::~CacheManager() {
     save_cache_index();
+    // 等待远程回写完成
+    remote_cache_.reset();
 }
 
 bool CacheManager::initialize(const std::string& config_path) {
@@ -79,6 +179,23 @@ bool CacheManager::initialize(const std::string& config_path) {
         if (!config_path.empty()) {
             load_configuration(config_path);
         }
+        // 配置可能改写 user_cache_path_，索引文件要在其后按最终路径创建
+        index_file_ = std::make_unique<SharedIndexFile>(user_cache_path_ + "/cache_index.json");
+        
+        // 远程缓存层，环境变量优先于配置文件
+        const char* remote = std::getenv("PAKER_REMOTE_CACHE");
+        if (remote && *remote) {
+            remote_cache_location_ = remote;
+        }
+        if (!remote_cache_location_.empty()) {
+            set_remote_cache(remote_cache_location_);
+        }
+        
+        // 内容存储在首次使用时才读取清单
+        if (content_store_enabled_) {
+            blob_store_ = std::make_unique<BlobStore>(resolve_cache_root() + "/.store");
+            blob_store_->set_read_only_blobs(read_only_store_);
+        }
         
         // 加载缓存索引
         if (!load_cache_index()) {
@@ -110,9 +227,19 @@ bool CacheManager::initialize(const std::string& config_path) {
 bool CacheManager::install_package_to_cache(const std::string& package, const std::string& version, 
                                           const std::string& repository_url) {
     try {
-        // 检查是否已缓存
+        auto record_local_hit = [&]() {
+            if (g_cache_monitor) {
+                g_cache_monitor->record_cache_hit(package);
+                g_cache_monitor->record_tier_hit("local", package);
+            }
+            PrefetchTrace(user_cache_path_ + "/prefetch").append(package, package_index_[package][version].size_bytes);
+        };
+        
+        // 检查是否已缓存（包括其他进程刚装好的版本）
+        refresh_cache_index();
         if (is_package_cached(package, version)) {
             LOG(INFO) << "Package " << package << "@" << version << " already cached";
+            record_local_hit();
             return true;
         }
         
@@ -123,21 +250,66 @@ bool CacheManager::install_package_to_cache(const std::string& package, const st
         // 创建包目录
         fs::create_directories(pkg_cache_dir.parent_path());
         
-        // 根据版本存储策略选择安装方法
+        // 同一版本只由一个进程安装，其余进程等它完成后复用结果；锁一直持有到索引保存之后
+        // 拿不到锁时不能继续：下面清理残留会删掉其他进程正在安装的目录
+        InstallLock install_lock(cache_path);
+        if (!install_lock.acquire()) {
+            LOG(ERROR) << "Failed to acquire install lock for " << package << "@" << version;
+            return false;
+        }
+        // 另一进程可能在上面的检查之后装完并释放了锁，此时 waited() 为假，同样要重新检查
+        refresh_cache_index();
+        if (is_package_cached(package, version)) {
+            LOG(INFO) << "Reusing " << package << "@" << version << " installed by another process";
+            record_local_hit();
+            return true;
+        }
+        
+        // 持锁后仍存在却未登记的目录是中断的安装留下的
+        if (fs::exists(cache_path)) {
+            LOG(WARNING) << "Removing leftovers of an interrupted install at " << cache_path;
+            fs::remove_all(cache_path);
+        }
+        fs::remove_all(cache_path + ".tmp");
+        
+        if (g_cache_monitor) {
+            g_cache_monitor->record_cache_miss(package);
+            g_cache_monitor->record_tier_miss("local", package);
+        }
+        
+        // 本地未命中时先从远程缓存读取，命中则不再下载
         bool success = false;
-        switch (version_storage_) {
-            case VersionStorage::SHALLOW_CLONE:
-                success = install_shallow_clone(repository_url, pkg_cache_dir.string(), version);
-                break;
-            case VersionStorage::ARCHIVE_ONLY:
-                success = install_archive_only(repository_url, pkg_cache_dir.string(), version);
-                break;
-            case VersionStorage::COMPRESSED:
-                success = install_compressed(repository_url, pkg_cache_dir.string(), version);
-                break;
-            default:
-                success = install_shallow_clone(repository_url, pkg_cache_dir.string(), version);
-                break;
+        bool from_remote = false;
+        if (remote_cache_) {
+            bool compressed = version_storage_ == VersionStorage::COMPRESSED;
+            std::string fetch_path = compressed ? cache_path + ".tmp" : cache_path;
+            if (remote_cache_->fetch(package, version, fetch_path)) {
+                from_remote = true;
+                success = !compressed || archive_version_tree(fetch_path, cache_path);
+                if (compressed) {
+                    fs::remove_all(fetch_path);
+                }
+            } else if (g_cache_monitor) {
+                g_cache_monitor->record_tier_miss("remote", package);
+            }
+        }
+        
+        // 根据版本存储策略选择安装方法
+        if (!from_remote) {
+            switch (version_storage_) {
+                case VersionStorage::SHALLOW_CLONE:
+                    success = install_shallow_clone(repository_url, pkg_cache_dir.string(), version);
+                    break;
+                case VersionStorage::ARCHIVE_ONLY:
+                    success = install_archive_only(repository_url, pkg_cache_dir.string(), version);
+                    break;
+                case VersionStorage::COMPRESSED:
+                    success = install_compressed(repository_url, pkg_cache_dir.string(), version);
+                    break;
+                default:
+                    success = install_shallow_clone(repository_url, pkg_cache_dir.string(), version);
+                    break;
+            }
         }
         
         if (!success) {
@@ -145,6 +317,12 @@ bool CacheManager::install_package_to_cache(const std::string& package, const st
             return false;
         }
         
+        // 纳入内容存储：与已缓存版本相同的文件只保留一份
+        BlobStore* store = get_blob_store();
+        if (store && fs::is_directory(cache_path)) {
+            store->ingest_tree(package, version, cache_path);
+        }
+        
         // 更新缓存索引
         PackageCacheInfo info;
         info.package_name = package;
@@ -153,7 +331,8 @@ bool CacheManager::install_package_to_cache(const std::string& package, const st
         info.repository_url = repository_url;
         info.install_time = std::chrono::system_clock::now();
         info.last_access = std::chrono::system_clock::now();
-        info.size_bytes = calculate_directory_size(cache_path);
+        info.size_bytes = fs::exists(archive_path_for(cache_path)) ? fs::file_size(archive_path_for(cache_path))
+                                                                  : calculate_directory_size(cache_path);
         info.access_count = 1;
         info.is_active = true;
         
@@ -162,6 +341,19 @@ bool CacheManager::install_package_to_cache(const std::string& package, const st
         // 保存索引
         save_cache_index();
         
+        // 从远程取回的计入远程层命中；新下载的版本在后台回写到远程缓存
+        if (from_remote) {
+            if (g_cache_monitor) {
+                g_cache_monitor->record_tier_hit("remote", package, info.size_bytes);
+            }
+        } else if (remote_cache_) {
+            remote_cache_->publish_async(package, version,
+                                         fs::exists(cache_path) ? cache_path : archive_path_for(cache_path));
+        }
+        
+        // 记录请求，供预取模型学习安装顺序
+        PrefetchTrace(user_cache_path_ + "/prefetch").append(package, info.size_bytes);
+        
         LOG(INFO) << "Successfully installed " << package << "@" << version << " to cache";
         return true;
         
@@ -187,8 +379,8 @@ bool CacheManager::is_package_cached(const std::string& package, const std::stri
         return false;
     }
     
-    // 检查文件是否实际存在
-    return fs::exists(ver_it->second.cache_path);
+    // 检查文件是否实际存在（目录或压缩归档）
+    return fs::exists(ver_it->second.cache_path) || fs::exists(archive_path_for(ver_it->second.cache_path));
 }
 
 std::string CacheManager::get_cached_package_path(const std::string& package, const std::string& version) const {
@@ -210,7 +402,59 @@ std::string CacheManager::get_cached_package_path(const std::string& package, co
         return "";
     }
     
-    return ver_it->second.cache_path;
+    // 压缩存储的版本在首次需要目录时并行解压；只读单个文件请用 read_cached_file
+    const std::string& cache_path = ver_it->second.cache_path;
+    std::string archive_path = archive_path_for(cache_path);
+    if (!fs::exists(cache_path) && fs::exists(archive_path)) {
+        SeekableArchiveReader reader;
+        std::string staging = cache_path + ".extract";
+        std::error_code ec;
+        fs::remove_all(staging, ec);
+        if (!reader.open(archive_path) || !reader.extract_all(staging)) {
+            fs::remove_all(staging, ec);
+            return "";
+        }
+        fs::rename(staging, cache_path, ec);
+        if (ec) {
+            fs::remove_all(staging, ec);
+        }
+        LOG(INFO) << "Extracted " << package << "@" << version << " from " << archive_path;
+    }
+    
+    return cache_path;
+}
+
+bool CacheManager::read_cached_file(const std::string& package, const std::string& version,
+                                    const std::string& relative_path, std::string& content) {
+    auto pkg_it = package_index_.find(package);
+    if (pkg_it == package_index_.end()) {
+        return false;
+    }
+    auto ver_it = pkg_it->second.find(version);
+    if (ver_it == pkg_it->second.end()) {
+        return false;
+    }
+    
+    // 已解压（或本来就是目录）时直接读文件
+    fs::path direct = fs::path(ver_it->second.cache_path) / relative_path;
+    if (fs::is_regular_file(direct)) {
+        std::ifstream file(direct, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return static_cast<bool>(file) || file.eof();
+    }
+    
+    std::string archive_path = archive_path_for(ver_it->second.cache_path);
+    auto& reader = open_archives_[archive_path];
+    if (!reader) {
+        reader = std::make_unique<SeekableArchiveReader>();
+        if (!reader->open(archive_path)) {
+            open_archives_.erase(archive_path);
+            return false;
+        }
+    }
+    ver_it->second.last_access = std::chrono::system_clock::now();
+    ver_it->second.access_count++;
+    return reader->read_file(relative_path, content);
 }
 
 bool CacheManager::create_project_link(const std::string& package, const std::string& version, 
@@ -223,17 +467,35 @@ bool CacheManager::create_project_link(const std::string& package, const std::st
             return false;
         }
         
-        // 创建项目链接目录
-        fs::path project_links_dir = fs::path(project_path) / ".paker" / "links";
-        fs::create_directories(project_links_dir);
-        
-        // 创建符号链接
-        fs::path link_path = project_links_dir / package;
-        if (fs::exists(link_path)) {
-            fs::remove(link_path);
+        // 新一代链接建好后原子切换，失败时工程仍停留在完整的当前代
+        GenerationManager generations(project_path);
+        GenerationEntry entry{version, fs::absolute(cached_path).string()};
+        MaterializePolicy policy = load_project_materialize_policy(project_path);
+        if (policy != MaterializePolicy::SYMLINK) {
+            // 工程需要真实文件：按策略用 reflink / 硬链接 / 内核复制物化，同一版本、同一策略的各代共用；
+            // 策略变化后目录名不同，按新策略重建
+            entry.target = generations.tree_path(package, version, materialize_policy_name(policy));
+            if (!fs::is_directory(entry.target)) {
+                FileMaterializer materializer(policy);
+                materializer.set_protect_source(read_only_store_);
+                MaterializeResult result = materializer.materialize_tree(cached_path, entry.target);
+                if (!result.success) {
+                    LOG(ERROR) << "Failed to materialize " << package << " into " << entry.target;
+                    return false;
+                }
+                Output::info("Materialized " + package + " (" + materialize_policy_name(policy) + "): " + result.summary());
+            }
         }
         
-        return create_symbolic_link(cached_path, link_path.string());
+        std::string reason = "link " + package + "@" + version;
+        if (batching_links_for(project_path)) {
+            auto& removals = pending_links_.removals;
+            removals.erase(std::remove(removals.begin(), removals.end(), package), removals.end());
+            pending_links_.changes[package] = entry;
+            pending_links_.reasons.push_back(reason);
+            return true;
+        }
+        return commit_project_links(project_path, {{package, entry}}, {}, reason);
         
     } catch (const std::exception& e) {
         LOG(ERROR) << "Error creating project link: " << e.what();
@@ -243,11 +505,17 @@ bool CacheManager::create_project_link(const std::string& package, const std::st
 
 bool CacheManager::remove_project_link(const std::string& package, const std::string& project_path) {
     try {
-        fs::path link_path = fs::path(project_path) / ".paker" / "links" / package;
-        if (fs::exists(link_path)) {
-            return remove_symbolic_link(link_path.string());
+        std::string reason = "unlink " + package;
+        if (batching_links_for(project_path)) {
+            pending_links_.changes.erase(package);
+            auto& removals = pending_links_.removals;
+            if (std::find(removals.begin(), removals.end(), package) == removals.end()) {
+                removals.push_back(package);
+            }
+            pending_links_.reasons.push_back(reason);
+            return true;
         }
-        return true;
+        return commit_project_links(project_path, {}, {package}, reason);
         
     } catch (const std::exception& e) {
         LOG(ERROR) << "Error removing project link: " << e.what();
@@ -255,11 +523,71 @@ bool CacheManager::remove_project_link(const std::string& package, const std::st
     }
 }
 
+bool CacheManager::commit_project_links(const std::string& project_path,
+                                        const std::map<std::string, GenerationEntry>& changes,
+                                        const std::vector<std::string>& removals, const std::string& reason) {
+    try {
+        GenerationManager generations(project_path);
+        uint64_t id = generations.create_generation(changes, removals, reason);
+        if (id == 0 || !generations.switch_to(id).success) {
+            LOG(ERROR) << "Failed to switch project packages to a new generation";
+            return false;
+        }
+        generations.collect_garbage(load_project_generation_retention(project_path));
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Error switching project links: " << e.what();
+        return false;
+    }
+}
+
+bool CacheManager::batching_links_for(const std::string& project_path) const {
+    return pending_links_.depth > 0 && pending_links_.project_path == project_path;
+}
+
+void CacheManager::begin_link_batch(const std::string& project_path) {
+    if (pending_links_.depth++ == 0) {
+        pending_links_.project_path = project_path;
+    }
+}
+
+bool CacheManager::end_link_batch() {
+    if (pending_links_.depth == 0 || --pending_links_.depth > 0) {
+        return true;
+    }
+    PendingLinks pending = std::move(pending_links_);
+    pending_links_ = PendingLinks();
+    if (pending.changes.empty() && pending.removals.empty()) {
+        return true;
+    }
+    
+    // 一次命令只产生一代，工程历史不会被单次批量安装挤出保留窗口
+    std::string reason = pending.reasons.front();
+    if (pending.reasons.size() > 1) {
+        reason += " (+" + std::to_string(pending.reasons.size() - 1) + " more)";
+    }
+    return commit_project_links(pending.project_path, pending.changes, pending.removals, reason);
+}
+
 std::string CacheManager::get_project_package_path(const std::string& package, const std::string& project_path) const {
+    if (batching_links_for(project_path)) {
+        auto it = pending_links_.changes.find(package);
+        if (it != pending_links_.changes.end()) {
+            return it->second.target;
+        }
+        const auto& removals = pending_links_.removals;
+        if (std::find(removals.begin(), removals.end(), package) != removals.end()) {
+            return "";
+        }
+    }
     fs::path link_path = fs::path(project_path) / ".paker" / "links" / package;
     if (fs::exists(link_path) && fs::is_symlink(link_path)) {
         return fs::read_symlink(link_path).string();
     }
+    if (fs::is_directory(link_path)) {
+        return link_path.string();
+    }
     return "";
 }
 
@@ -298,7 +626,9 @@ bool CacheManager::cleanup_unused_packages() {
 
 bool CacheManager::cleanup_old_versions() {
     try {
-        for (auto& [package, versions] : package_index_) {
+        // 先收集再删除：保存索引时会与磁盘合并并替换 package_index_
+        std::vector<std::pair<std::string, std::string>> versions_to_remove;
+        for (const auto& [package, versions] : package_index_) {
             if (versions.size() <= max_versions_per_package_) {
                 continue;
             }
@@ -316,10 +646,15 @@ bool CacheManager::cleanup_old_versions() {
             
             // 删除旧版本
             for (size_t i = max_versions_per_package_; i < sorted_versions.size(); ++i) {
-                remove_package_from_cache(package, sorted_versions[i].first);
+                versions_to_remove.emplace_back(package, sorted_versions[i].first);
             }
         }
+        for (const auto& [package, version] : versions_to_remove) {
+            remove_package_from_cache(package, version);
+        }
         
+        // 回收不再被任何版本引用的 blob
+        collect_store_garbage();
         return true;
         
     } catch (const std::exception& e) {
@@ -328,9 +663,71 @@ bool CacheManager::cleanup_old_versions() {
     }
 }
 
+bool CacheManager::cleanup_by_size() {
+    try {
+        BlobStore* store = get_blob_store();
+        
+        // 已纳入内容存储的版本按 blob 实际占用计算，其余按目录大小。
+        // 只由快照等外部引用保留的 blob 不计入：淘汰版本释放不了它们，计入会使上限永远达不到
+        auto current_usage = [&]() {
+            size_t usage = store ? store->get_stats().tree_bytes : 0;
+            for (const auto& [package, versions] : package_index_) {
+                for (const auto& [version, info] : versions) {
+                    if (!store || !store->has_manifest(package, version)) {
+                        usage += info.size_bytes;
+                    }
+                }
+            }
+            return usage;
+        };
+        
+        size_t usage = current_usage();
+        if (usage <= max_cache_size_) {
+            return true;
+        }
+        
+        // 按最近访问时间从旧到新删除，直到回到上限以内
+        std::vector<PackageCacheInfo> candidates;
+        for (const auto& [package, versions] : package_index_) {
+            for (const auto& [version, info] : versions) {
+                candidates.push_back(info);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                 [](const auto& a, const auto& b) {
+                     return a.last_access < b.last_access;
+                 });
+        
+        // 删除前估算每个版本能释放的字节并从总量中扣除，循环结束后只做一次回收和重新统计
+        size_t removed = 0;
+        for (const auto& info : candidates) {
+            if (usage <= max_cache_size_) {
+                break;
+            }
+            size_t freed = store && store->has_manifest(info.package_name, info.version)
+                               ? store->exclusive_bytes(info.package_name, info.version)
+                               : info.size_bytes;
+            remove_package_from_cache(info.package_name, info.version);
+            usage -= std::min(usage, freed);
+            removed++;
+        }
+        if (removed > 0) {
+            collect_store_garbage();
+            usage = current_usage();
+        }
+        
+        LOG(INFO) << "Size-based cleanup removed " << removed << " versions, cache usage now " << usage << " bytes";
+        return usage <= max_cache_size_;
+    
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Error cleaning up cache by size: " << e.what();
+        return false;
+    }
+}
+
 CacheStats CacheManager::get_cache_statistics() const {
     CacheStats stats;
-    
+
     for (const auto& [package, versions] : package_index_) {
         stats.total_packages += versions.size();
         
@@ -348,6 +745,10 @@ CacheStats CacheManager::get_cache_statistics() const {
         }
     }
     
+    if (blob_store_) {
+        stats.deduplicated_bytes = blob_store_->get_stats().deduplicated_bytes();
+    }
+    
     return stats;
 }
 
@@ -359,6 +760,8 @@ bool CacheManager::migrate_from_legacy_mode(const std::string& project_path) {
             return true;
         }
         
+        // 所有迁移的包合并为一代
+        ProjectLinkBatch batch(project_path, this);
         for (const auto& entry : fs::directory_iterator(legacy_packages_dir)) {
             if (entry.is_directory()) {
                 std::string package_name = entry.path().filename().string();
@@ -378,9 +781,8 @@ bool CacheManager::migrate_from_legacy_mode(const std::string& project_path) {
                     }
                 }
                 
-                // 安装到缓存
-                std::string repo_url = "";  // 需要从配置中获取
-                if (install_package_to_cache(package_name, version, repo_url)) {
+                // 旧目录直接移入缓存，不再重新下载
+                if (adopt_directory_into_cache(package_name, version, entry.path().string())) {
                     // 创建项目链接
                     create_project_link(package_name, version, project_path);
                     
@@ -401,6 +803,47 @@ bool CacheManager::migrate_from_legacy_mode(const std::string& project_path) {
 
 // 私有方法实现
 
+bool CacheManager::adopt_directory_into_cache(const std::string& package, const std::string& version,
+                                            const std::string& source_dir) {
+    if (is_package_cached(package, version)) {
+        return true;
+    }
+    
+    std::string cache_path = resolve_cache_path(package, version);
+    fs::create_directories(fs::path(cache_path).parent_path());
+    
+    // 同一文件系统上改名即可；跨文件系统时按 reflink / 内核复制物化
+    std::error_code ec;
+    fs::rename(source_dir, cache_path, ec);
+    if (ec) {
+        FileMaterializer materializer(MaterializePolicy::REFLINK);
+        MaterializeResult result = materializer.materialize_tree(source_dir, cache_path);
+        if (!result.success) {
+            LOG(ERROR) << "Failed to move " << source_dir << " into cache";
+            return false;
+        }
+    }
+    
+    PackageCacheInfo info;
+    info.package_name = package;
+    info.version = version;
+    info.cache_path = cache_path;
+    info.install_time = std::chrono::system_clock::now();
+    info.last_access = info.install_time;
+    info.size_bytes = calculate_directory_size(cache_path);
+    info.access_count = 1;
+    info.is_active = true;
+    package_index_[package][version] = info;
+    save_cache_index();
+    
+    if (BlobStore* store = get_blob_store()) {
+        store->ingest_tree(package, version, cache_path);
+    }
+    
+    LOG(INFO) << "Adopted " << source_dir << " into cache as " << package << "@" << version;
+    return true;
+}
+
 bool CacheManager::install_shallow_clone(const std::string& repo_url, const std::string& cache_path, 
                                        const std::string& version) {
     std::ostringstream cmd;
@@ -447,60 +890,75 @@ bool CacheManager::install_compressed(const std::string& repo_url, const std::st
         return false;
     }
     
-    // 创建压缩归档
-    std::ostringstream tar_cmd;
-    tar_cmd << "cd " << temp_path << " && tar -czf " << cache_path << ".tar.gz .";
-    int ret = std::system(tar_cmd.str().c_str());
+    bool success = archive_version_tree(temp_path, cache_path);
     
     // 清理临时目录
     fs::remove_all(temp_path);
     
-    return ret == 0;
+    return success;
 }
 
-bool CacheManager::load_cache_index() {
-    try {
-        std::string index_path = user_cache_path_ + "/cache_index.json";
-        if (!fs::exists(index_path)) {
-            return true;  // 索引文件不存在是正常的
-        }
-        
-        std::ifstream file(index_path);
-        json j;
-        file >> j;
-        
-        package_index_.clear();
-        for (const auto& [package, versions] : j.items()) {
-            for (const auto& [version, info] : versions.items()) {
-                PackageCacheInfo pkg_info;
-                pkg_info.package_name = package;
-                pkg_info.version = version;
-                pkg_info.cache_path = info["cache_path"];
-                pkg_info.repository_url = info["repository_url"];
-                pkg_info.size_bytes = info["size_bytes"];
-                pkg_info.access_count = info["access_count"];
-                pkg_info.is_active = info["is_active"];
-                
-                // 解析时间戳
-                if (info.contains("install_time")) {
-                    pkg_info.install_time = std::chrono::system_clock::from_time_t(info["install_time"]);
-                }
-                if (info.contains("last_access")) {
-                    pkg_info.last_access = std::chrono::system_clock::from_time_t(info["last_access"]);
-                }
-                
-                package_index_[package][version] = pkg_info;
+bool CacheManager::archive_version_tree(const std::string& tree_path, const std::string& cache_path) {
+    // 同一包的各版本共用一份 zstd 字典，首次压缩时用该版本的小文件训练
+    ArchiveWriteOptions options;
+    if (options.codec == ArchiveCodec::ZSTD) {
+        fs::path dict_path = fs::path(cache_path).parent_path() / ".zdict";
+        if (fs::exists(dict_path)) {
+            std::ifstream dict_file(dict_path, std::ios::binary);
+            options.dictionary.assign(std::istreambuf_iterator<char>(dict_file), std::istreambuf_iterator<char>());
+        } else {
+            options.dictionary = SeekableArchiveWriter::train_dictionary(tree_path);
+            if (!options.dictionary.empty()) {
+                std::ofstream(dict_path, std::ios::binary) << options.dictionary;
             }
         }
-        
+    }
+    
+    // 创建分帧压缩归档
+    return SeekableArchiveWriter::create(tree_path, archive_path_for(cache_path), options);
+}
+
+bool CacheManager::load_cache_index() {
+    if (!index_file_) {
+        return false;
+    }
+    // 索引文件不存在是正常的，读到的是空索引
+    json data;
+    uint64_t generation = 0;
+    if (!index_file_->read(data, generation)) {
+        return false;
+    }
+    try {
+        package_index_ = parse_package_index(data);
+        index_base_ = package_index_;
         return true;
-        
     } catch (const std::exception& e) {
         LOG(ERROR) << "Error loading cache index: " << e.what();
         return false;
     }
 }
 
+bool CacheManager::refresh_cache_index() {
+    if (!index_file_ || !index_file_->changed()) {
+        return true;
+    }
+    json delta = diff_package_index(index_base_, package_index_);
+    json data;
+    uint64_t generation = 0;
+    if (!index_file_->read(data, generation)) {
+        return false;
+    }
+    try {
+        index_base_ = parse_package_index(data);
+        apply_package_index_delta(data, delta);
+        package_index_ = parse_package_index(data);
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Error refreshing cache index: " << e.what();
+        return false;
+    }
+}
+
 void CacheManager::scan_installed_packages() {
     try {
         fs::path packages_dir = "packages";
@@ -638,28 +1096,21 @@ void CacheManager::scan_installed_packages_fast() {
 }
 
 bool CacheManager::save_cache_index() {
+    if (!index_file_) {
+        return false;
+    }
     try {
-        std::string index_path = user_cache_path_ + "/cache_index.json";
-        fs::create_directories(fs::path(index_path).parent_path());
-        
-        json j;
-        for (const auto& [package, versions] : package_index_) {
-            for (const auto& [version, info] : versions) {
-                j[package][version] = {
-                    {"cache_path", info.cache_path},
-                    {"repository_url", info.repository_url},
-                    {"size_bytes", info.size_bytes},
-                    {"access_count", info.access_count},
-                    {"is_active", info.is_active},
-                    {"install_time", std::chrono::system_clock::to_time_t(info.install_time)},
-                    {"last_access", std::chrono::system_clock::to_time_t(info.last_access)}
-                };
-            }
+        // 只提交本进程的修改，其他进程同时写入的条目保留
+        json delta = diff_package_index(index_base_, package_index_);
+        if (delta.empty()) {
+            return true;
         }
-        
-        std::ofstream file(index_path);
-        file << j.dump(2);
-        
+        json committed;
+        if (!index_file_->commit([&delta](json& data) { apply_package_index_delta(data, delta); }, &committed)) {
+            return false;
+        }
+        package_index_ = parse_package_index(committed);
+        index_base_ = package_index_;
         return true;
         
     } catch (const std::exception& e) {
@@ -668,7 +1119,7 @@ bool CacheManager::save_cache_index() {
     }
 }
 
-std::string CacheManager::resolve_cache_path(const std::string& package, const std::string& version) const {
+std::string CacheManager::resolve_cache_root() const {
     std::string cache_dir;
     
     switch (strategy_) {
@@ -685,6 +1136,29 @@ std::string CacheManager::resolve_cache_path(const std::string& package, const s
             cache_dir = project_cache_path_;
             break;
     }
+    return cache_dir;
+}
+
+BlobStore* CacheManager::get_blob_store() {
+    if (!content_store_enabled_) {
+        return nullptr;
+    }
+    // 缓存策略变化后根目录随之变化，blob 必须与版本目录在同一文件系统上才能硬链接
+    std::string root = resolve_cache_root() + "/.store";
+    if (!blob_store_ || blob_store_->get_root() != root) {
+        blob_store_ = std::make_unique<BlobStore>(root);
+        blob_store_->set_read_only_blobs(read_only_store_);
+    }
+    return blob_store_.get();
+}
+
+size_t CacheManager::collect_store_garbage(bool full_scan) {
+    BlobStore* store = get_blob_store();
+    return store ? store->collect_garbage(full_scan) : 0;
+}
+
+std::string CacheManager::resolve_cache_path(const std::string& package, const std::string& version) const {
+    std::string cache_dir = resolve_cache_root();
     
     std::string version_suffix = version.empty() ? "latest" : version;
     return cache_dir + "/" + package + "/" + version_suffix;
@@ -731,35 +1205,59 @@ size_t CacheManager::calculate_directory_size(const std::string& path) const {
 
 bool CacheManager::remove_package_from_cache(const std::string& package, const std::string& version) {
     try {
+        // 以其他进程最新的索引为准，避免删掉别人刚装好的版本后又把旧索引写回
+        refresh_cache_index();
         auto pkg_it = package_index_.find(package);
         if (pkg_it == package_index_.end()) {
             return false;
         }
         
+        // 版本 -> 登记的缓存路径，安装锁就放在这个路径旁边
+        std::vector<std::pair<std::string, std::string>> versions;
         if (version.empty()) {
             // 删除所有版本
             for (const auto& [ver, info] : pkg_it->second) {
-                if (fs::exists(info.cache_path)) {
-                    fs::remove_all(info.cache_path);
-                }
+                versions.emplace_back(ver, info.cache_path);
             }
-            package_index_.erase(pkg_it);
         } else {
             // 删除特定版本
             auto ver_it = pkg_it->second.find(version);
             if (ver_it != pkg_it->second.end()) {
-                if (fs::exists(ver_it->second.cache_path)) {
-                    fs::remove_all(ver_it->second.cache_path);
-                }
-                pkg_it->second.erase(ver_it);
-                
-                if (pkg_it->second.empty()) {
-                    package_index_.erase(pkg_it);
-                }
+                versions.emplace_back(version, ver_it->second.cache_path);
             }
         }
         
-        save_cache_index();
+        for (const auto& [ver, cache_path] : versions) {
+            // 与安装使用同一把锁，不会删掉另一进程正在安装的目录；锁持有到索引保存之后
+            InstallLock install_lock(cache_path);
+            if (!install_lock.acquire()) {
+                LOG(ERROR) << "Failed to acquire install lock for " << package << "@" << ver;
+                return false;
+            }
+            refresh_cache_index();
+            auto it = package_index_.find(package);
+            if (it == package_index_.end()) {
+                break;
+            }
+            auto ver_it = it->second.find(ver);
+            if (ver_it == it->second.end()) {
+                continue;
+            }
+            
+            if (blob_store_) {
+                blob_store_->release_tree(package, ver);
+            }
+            if (fs::exists(ver_it->second.cache_path)) {
+                fs::remove_all(ver_it->second.cache_path);
+            }
+            open_archives_.erase(archive_path_for(ver_it->second.cache_path));
+            fs::remove(archive_path_for(ver_it->second.cache_path));
+            it->second.erase(ver_it);
+            if (it->second.empty()) {
+                package_index_.erase(it);
+            }
+            save_cache_index();
+        }
         return true;
         
     } catch (const std::exception& e) {
@@ -768,7 +1266,31 @@ bool CacheManager::remove_package_from_cache(const std::string& package, const s
     }
 }
 
+ProjectLinkBatch::ProjectLinkBatch(const std::string& project_path, CacheManager* manager) : manager_(manager) {
+    if (manager_) {
+        manager_->begin_link_batch(project_path);
+    }
+}
+
+ProjectLinkBatch::~ProjectLinkBatch() {
+    if (manager_ && !manager_->end_link_batch()) {
+        LOG(ERROR) << "Failed to commit batched project links";
+    }
+}
+
 // 全局函数实现
+bool CacheManager::set_remote_cache(const std::string& location) {
+    remote_cache_.reset();
+    remote_cache_location_ = location;
+    auto backend = create_remote_cache_backend(location);
+    if (!backend) {
+        return false;
+    }
+    remote_cache_ = std::make_unique<RemoteCache>(std::move(backend), user_cache_path_ + "/remote-staging");
+    LOG(INFO) << "Remote cache: " << remote_cache_->describe();
+    return true;
+}
+
 bool initialize_cache_manager() {
     g_cache_manager = std::make_unique<CacheManager>();
     return g_cache_manager->initialize();
@@ -791,7 +1313,10 @@ std::vector<PackageCacheInfo> CacheManager::get_package_list() const {
             for (const auto& entry : fs::directory_iterator(global_cache_path_)) {
                 if (entry.is_directory()) {
                     std::string package_name = entry.path().filename().string();
-                    
+                    if (package_name[0] == '.') {
+                        continue;  // .store 等内部目录
+                    }
+
                     // 查找版本目录
                     for (const auto& version_entry : fs::directory_iterator(entry.path())) {
                         if (version_entry.is_directory()) {
@@ -849,6 +1374,12 @@ bool CacheManager::load_configuration(const std::string& config_path) {
                     user_cache_path_ = value;
                 } else if (key == "project_cache_dir") {
                     project_cache_path_ = value;
+                } else if (key == "content_store") {
+                    content_store_enabled_ = (value == "on" || value == "true" || value == "1");
+                } else if (key == "read_only_store") {
+                    read_only_store_ = (value == "on" || value == "true" || value == "1");
+                } else if (key == "remote_cache") {
+                    remote_cache_location_ = value;
                 } else if (key == "max_cache_size") {
                     max_cache_size_ = std::stoull(value);
                 } else if (key == "version_storage") {
@@ -0,0 +1,285 @@
+#include "Paker/cache/cache_monitor.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace Paker {
+
+// 全局缓存监控器实例
+std::unique_ptr<CacheMonitor> g_cache_monitor;
+
+namespace {
+
+double average(const std::vector<double>& values) {
+    return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+} // namespace
+
+CacheMonitor::CacheMonitor()
+    : monitoring_active_(false)
+    , monitoring_interval_(std::chrono::seconds(60))
+    , max_history_size_(1000) {
+}
+
+CacheMonitor::~CacheMonitor() {
+    stop_monitoring();
+}
+
+bool CacheMonitor::start_monitoring() {
+    if (monitoring_active_.exchange(true)) {
+        return false;
+    }
+    monitor_thread_ = std::thread(&CacheMonitor::monitoring_loop, this);
+    LOG(INFO) << "Cache monitoring started";
+    return true;
+}
+
+void CacheMonitor::stop_monitoring() {
+    if (!monitoring_active_.exchange(false)) {
+        return;
+    }
+    if (monitor_thread_.joinable()) {
+        monitor_thread_.join();
+    }
+    LOG(INFO) << "Cache monitoring stopped";
+}
+
+void CacheMonitor::monitoring_loop() {
+    auto next_run = std::chrono::steady_clock::now();
+    while (monitoring_active_.load()) {
+        if (std::chrono::steady_clock::now() >= next_run) {
+            update_performance_metrics();
+            cleanup_old_metrics();
+            check_cache_alerts();
+            next_run = std::chrono::steady_clock::now() + monitoring_interval_;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+void CacheMonitor::record_cache_hit(const std::string& package) {
+    (void)package;
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    current_metrics_.cache_hits++;
+}
+
+void CacheMonitor::record_cache_miss(const std::string& package) {
+    (void)package;
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    current_metrics_.cache_misses++;
+}
+
+void CacheMonitor::record_package_install(const std::string& package, double duration_ms) {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    current_metrics_.packages_installed++;
+    install_times_.push_back(duration_ms);
+    operation_times_[package] = std::chrono::system_clock::now();
+}
+
+void CacheMonitor::record_package_remove(const std::string& package) {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    current_metrics_.packages_removed++;
+    operation_times_.erase(package);
+}
+
+void CacheMonitor::record_package_access(const std::string& package, double duration_ms) {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    access_times_.push_back(duration_ms);
+    operation_times_[package] = std::chrono::system_clock::now();
+}
+
+void CacheMonitor::record_tier_hit(const std::string& tier, const std::string& package, size_t bytes) {
+    (void)package;
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    CacheTierStats& stats = tier_stats_[tier];
+    stats.hits++;
+    stats.bytes_served += bytes;
+}
+
+void CacheMonitor::record_tier_miss(const std::string& tier, const std::string& package) {
+    (void)package;
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    tier_stats_[tier].misses++;
+}
+
+void CacheMonitor::record_tier_error(const std::string& tier, const std::string& package) {
+    LOG(WARNING) << "Cache tier " << tier << " failed to serve " << package;
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    tier_stats_[tier].errors++;
+}
+
+CacheMetrics CacheMonitor::get_current_metrics() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    return current_metrics_;
+}
+
+CachePerformance CacheMonitor::get_current_performance() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    CachePerformance performance = current_performance_;
+    size_t lookups = current_metrics_.cache_hits + current_metrics_.cache_misses;
+    performance.hit_rate = lookups ? static_cast<double>(current_metrics_.cache_hits) / lookups : 0.0;
+    performance.avg_install_time = average(install_times_);
+    performance.avg_access_time = average(access_times_);
+    return performance;
+}
+
+std::map<std::string, CacheTierStats> CacheMonitor::get_tier_stats() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    return tier_stats_;
+}
+
+void CacheMonitor::update_performance_metrics() {
+    if (g_cache_manager) {
+        CacheStats stats = g_cache_manager->get_cache_statistics();
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        current_metrics_.total_packages = stats.total_packages;
+        current_metrics_.total_size_bytes = stats.total_size_bytes;
+        current_metrics_.last_cleanup = stats.last_cleanup;
+    }
+    CachePerformance performance = get_current_performance();
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    current_performance_ = performance;
+}
+
+void CacheMonitor::cleanup_old_metrics() {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    if (install_times_.size() > max_history_size_) {
+        install_times_.erase(install_times_.begin(), install_times_.end() - max_history_size_);
+    }
+    if (access_times_.size() > max_history_size_) {
+        access_times_.erase(access_times_.begin(), access_times_.end() - max_history_size_);
+    }
+}
+
+std::string CacheMonitor::generate_performance_report() const {
+    CacheMetrics metrics = get_current_metrics();
+    CachePerformance performance = get_current_performance();
+    auto tiers = get_tier_stats();
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+    report << "Cache Performance Report\n";
+    report << "========================\n";
+    report << "Packages: " << metrics.total_packages << " ("
+           << metrics.total_size_bytes / (1024.0 * 1024.0) << " MB)\n";
+    report << "Hit rate: " << performance.hit_rate * 100.0 << "% (" << metrics.cache_hits << " hits, "
+           << metrics.cache_misses << " misses)\n";
+    report << "Average install time: " << performance.avg_install_time << " ms\n";
+    report << "Average access time: " << performance.avg_access_time << " ms\n";
+    if (!tiers.empty()) {
+        report << "\nPer-tier hit rates:\n";
+        for (const auto& [tier, stats] : tiers) {
+            report << "  " << std::left << std::setw(8) << tier << std::right << stats.hit_rate() * 100.0 << "% ("
+                   << stats.hits << " hits, " << stats.misses << " misses, " << stats.errors << " errors, "
+                   << stats.bytes_served / (1024.0 * 1024.0) << " MB served)\n";
+        }
+    }
+    return report.str();
+}
+
+std::vector<std::string> CacheMonitor::get_performance_recommendations() const {
+    std::vector<std::string> recommendations;
+    CacheMetrics metrics = get_current_metrics();
+    CachePerformance performance = get_current_performance();
+    auto tiers = get_tier_stats();
+
+    if (metrics.cache_hits + metrics.cache_misses > 0 && performance.hit_rate < HIT_RATE_WARNING_THRESHOLD) {
+        recommendations.push_back("Low cache hit rate; consider warming the cache for project dependencies");
+    }
+    auto remote = tiers.find("remote");
+    if (remote == tiers.end() && metrics.cache_misses > metrics.cache_hits) {
+        recommendations.push_back("Most lookups miss the local cache; a shared remote cache (remote_cache) would let machines reuse each other's downloads");
+    } else if (remote != tiers.end() && remote->second.errors > 0) {
+        recommendations.push_back("Remote cache returned errors; check its connectivity and integrity");
+    }
+    if (metrics.total_size_bytes > SIZE_WARNING_THRESHOLD) {
+        recommendations.push_back("Cache size is large; run cleanup of old versions");
+    }
+    return recommendations;
+}
+
+bool CacheMonitor::should_perform_cleanup() const {
+    return get_current_metrics().total_size_bytes > SIZE_WARNING_THRESHOLD;
+}
+
+bool CacheMonitor::should_perform_optimization() const {
+    CacheMetrics metrics = get_current_metrics();
+    return metrics.cache_hits + metrics.cache_misses > 0 &&
+           get_current_performance().hit_rate < HIT_RATE_ERROR_THRESHOLD;
+}
+
+bool CacheMonitor::auto_optimize_cache() {
+    if (!g_cache_manager) {
+        return false;
+    }
+    bool optimized = false;
+    if (should_perform_cleanup()) {
+        optimized = g_cache_manager->cleanup_old_versions() || optimized;
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        current_metrics_.last_cleanup = std::chrono::system_clock::now();
+    }
+    if (should_perform_optimization()) {
+        optimized = g_cache_manager->optimize_cache() || optimized;
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        current_metrics_.last_optimization = std::chrono::system_clock::now();
+    }
+    return optimized;
+}
+
+void CacheMonitor::check_cache_alerts() {
+    CacheMetrics metrics = get_current_metrics();
+    CachePerformance performance = get_current_performance();
+    auto tiers = get_tier_stats();
+
+    std::vector<CacheAlert> alerts;
+    if (metrics.cache_hits + metrics.cache_misses > 0) {
+        if (performance.hit_rate < HIT_RATE_ERROR_THRESHOLD) {
+            alerts.emplace_back(CacheAlert::Level::ERROR, "Cache hit rate is below 50%",
+                                "Warm the cache or enable a shared remote cache");
+        } else if (performance.hit_rate < HIT_RATE_WARNING_THRESHOLD) {
+            alerts.emplace_back(CacheAlert::Level::WARNING, "Cache hit rate is below 70%",
+                                "Warm the cache for frequently used packages");
+        }
+    }
+    if (metrics.total_size_bytes > SIZE_ERROR_THRESHOLD) {
+        alerts.emplace_back(CacheAlert::Level::ERROR, "Cache size exceeds 8GB", "Clean up old versions");
+    } else if (metrics.total_size_bytes > SIZE_WARNING_THRESHOLD) {
+        alerts.emplace_back(CacheAlert::Level::WARNING, "Cache size exceeds 5GB", "Clean up old versions");
+    }
+    for (const auto& [tier, stats] : tiers) {
+        if (stats.errors > 0) {
+            alerts.emplace_back(CacheAlert::Level::WARNING,
+                                "Cache tier " + tier + " had " + std::to_string(stats.errors) + " errors",
+                                "Check the tier's availability and stored content");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    active_alerts_ = std::move(alerts);
+}
+
+std::vector<CacheMonitor::CacheAlert> CacheMonitor::get_active_alerts() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    return active_alerts_;
+}
+
+void CacheMonitor::clear_alerts() {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    active_alerts_.clear();
+}
+
+bool initialize_cache_monitor() {
+    if (!g_cache_monitor) {
+        g_cache_monitor = std::make_unique<CacheMonitor>();
+    }
+    return true;
+}
+
+void cleanup_cache_monitor() {
+    g_cache_monitor.reset();
+}
+
+} // namespace Paker
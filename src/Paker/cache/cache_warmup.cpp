@@ -1,5 +1,8 @@
 #include "Paker/cache/cache_warmup.h"
+#include "Paker/cache/warmup_scheduler.h"
 #include "Paker/cache/cache_manager.h"
+#include "Paker/cache/materializer.h"
+#include "Paker/cache/prefetch_model.h"
 #include "Paker/dependency/dependency_resolver.h"
 #include "Paker/core/service_container.h"
 #include "Paker/core/core_services.h"
@@ -26,6 +29,7 @@ CacheWarmupService::CacheWarmupService()
     , max_preload_size_(1024ULL * 1024 * 1024)  // 1GB
     , preload_timeout_(std::chrono::seconds(300))  // 5分钟
     , default_strategy_(WarmupStrategy::ASYNC)
+    , scheduler_(std::make_unique<WarmupScheduler>())
     , is_preloading_(false)
     , should_stop_(false)
     , current_preload_count_(0)
@@ -183,12 +187,17 @@ bool CacheWarmupService::start_preload(WarmupStrategy strategy) {
         is_preloading_.store(true);
         should_stop_.store(false);
         current_preload_count_.store(0);
-        total_preload_count_.store(packages_to_preload_.size());
+        
+        // 按优先级入队，预热超时作为各任务开始的期限
+        scheduler_->reset();
+        schedule_pending_packages(std::chrono::steady_clock::now() + preload_timeout_);
+        size_t scheduled = scheduler_->pending();
+        total_preload_count_.store(scheduled);
         
         // 更新统计信息
         {
             std::lock_guard<std::mutex> lock(stats_mutex_);
-            stats_.total_packages = packages_to_preload_.size();
+            stats_.total_packages = scheduled;
             stats_.preloaded_packages = 0;
             stats_.failed_packages = 0;
             stats_.skipped_packages = 0;
@@ -198,19 +207,13 @@ bool CacheWarmupService::start_preload(WarmupStrategy strategy) {
         auto start_time = std::chrono::high_resolution_clock::now();
         
         if (strategy == WarmupStrategy::IMMEDIATE) {
-            // 同步预热
-            LOG(INFO) << "Starting immediate preload of " << packages_to_preload_.size() << " packages";
-            
-            for (const auto& package : packages_to_preload_) {
-                if (should_stop_.load()) break;
-                
-                bool success = preload_single_package(package);
-                update_preload_progress(package.package_name, package.version, success);
-            }
+            // 同步预热：在当前线程按调度顺序执行
+            LOG(INFO) << "Starting immediate preload of " << scheduled << " packages";
+            preload_worker_thread();
             
         } else {
             // 异步预热
-            LOG(INFO) << "Starting async preload of " << packages_to_preload_.size() << " packages";
+            LOG(INFO) << "Starting async preload of " << scheduled << " packages";
             
             // 启动工作线程
             preload_threads_.clear();
@@ -233,6 +236,8 @@ bool CacheWarmupService::start_preload(WarmupStrategy strategy) {
         {
             std::lock_guard<std::mutex> lock(stats_mutex_);
             stats_.total_time = duration;
+            // 被取消或到期前未能开始的包
+            stats_.skipped_packages = stats_.total_packages - stats_.preloaded_packages - stats_.failed_packages;
             if (stats_.total_packages > 0) {
                 stats_.average_time_per_package = std::chrono::milliseconds(
                     duration.count() / stats_.total_packages
@@ -262,6 +267,7 @@ bool CacheWarmupService::stop_preload() {
         }
         
         should_stop_.store(true);
+        scheduler_->stop();
         
         // 等待所有线程完成
         for (auto& thread : preload_threads_) {
@@ -297,6 +303,9 @@ bool CacheWarmupService::start_smart_preload(const std::vector<std::string>& pro
             register_package(dep, "latest", "", WarmupPriority::CRITICAL);
         }
         
+        // 注册预取模型预测的包
+        preload_predicted_packages(dependencies, 20);
+        
         // 注册流行包
         preload_popular_packages(20);
         
@@ -357,6 +366,52 @@ bool CacheWarmupService::preload_popular_packages(size_t count) {
     }
 }
 
+bool CacheWarmupService::preload_predicted_packages(const std::vector<std::string>& context, size_t count) {
+    try {
+        PrefetchTrace trace(get_prefetch_dir());
+        PrefetchModel model;
+        model.load(trace.model_path());
+        if (model.update_from_trace(trace) > 0) {
+            model.save(trace.model_path());
+        }
+        
+        PrefetchOptions options;
+        options.max_candidates = count;
+        auto candidates = model.predict(context, options);
+        
+        size_t registered = 0;
+        for (const auto& candidate : candidates) {
+            WarmupPriority priority = candidate.confidence >= 0.7 ? WarmupPriority::HIGH : WarmupPriority::NORMAL;
+            if (!register_package(candidate.package, "latest", "", priority)) {
+                continue;
+            }
+            registered++;
+            
+            // 用模型给出的置信度和大小参与排序与预算
+            std::lock_guard<std::mutex> lock(preload_mutex_);
+            std::string key = candidate.package + "@latest";
+            PackageWarmupInfo& info = package_registry_[key];
+            info.estimated_size = candidate.expected_bytes;
+            info.access_frequency = static_cast<size_t>(candidate.confidence * 100.0);
+            info.popularity_score = calculate_popularity_score(info);
+            for (auto& pending : packages_to_preload_) {
+                if (pending.package_name == info.package_name && pending.version == info.version) {
+                    pending = info;
+                }
+            }
+            rebuild_priority_queues();
+        }
+        
+        LOG(INFO) << "Predicted packages registered for preload: " << registered << " of " << candidates.size()
+                  << " (model: " << model.package_count() << " packages)";
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to preload predicted packages: " << e.what();
+        return false;
+    }
+}
+
 double CacheWarmupService::get_progress_percentage() const {
     size_t current = current_preload_count_.load();
     size_t total = total_preload_count_.load();
@@ -392,30 +447,15 @@ WarmupStats CacheWarmupService::get_statistics() const {
 
 void CacheWarmupService::preload_worker_thread() {
     try {
-        while (!should_stop_.load()) {
-            PackageWarmupInfo package_info;
-            bool found_package = false;
-            
-            // 获取下一个要预热的包
-            {
+        // 调度器按优先级和流行度出队，前台安装进行时退避，并按带宽和磁盘写入预算限速
+        WarmupTask task;
+        while (!should_stop_.load() && scheduler_->next(task)) {
+            bool success = preload_single_package(task);
+            if (success) {
                 std::lock_guard<std::mutex> lock(preload_mutex_);
-                for (auto& package : packages_to_preload_) {
-                    if (!package.is_preloaded) {
-                        package_info = package;
-                        package.is_preloaded = true;
-                        found_package = true;
-                        break;
-                    }
-                }
+                preloaded_keys_.insert(task.key());
             }
-            
-            if (!found_package) {
-                break;  // 没有更多包需要预热
-            }
-            
-            // 预热单个包
-            bool success = preload_single_package(package_info);
-            update_preload_progress(package_info.package_name, package_info.version, success);
+            update_preload_progress(task.info.package_name, task.info.version, success);
         }
         
     } catch (const std::exception& e) {
@@ -423,7 +463,8 @@ void CacheWarmupService::preload_worker_thread() {
     }
 }
 
-bool CacheWarmupService::preload_single_package(const PackageWarmupInfo& package_info) {
+bool CacheWarmupService::preload_single_package(const WarmupTask& task) {
+    const PackageWarmupInfo& package_info = task.info;
     try {
         // 检查资源限制
         if (!check_preload_resources(package_info)) {
@@ -441,7 +482,7 @@ bool CacheWarmupService::preload_single_package(const PackageWarmupInfo& package
         
         // 如果repository_url为空，说明是已安装的包，直接复制
         if (package_info.repository_url.empty()) {
-            success = copy_installed_package_to_cache(package_info);
+            success = copy_installed_package_to_cache(task);
         } else {
             // 从仓库安装到缓存
             success = cache_manager_->install_package_to_cache(
@@ -449,6 +490,18 @@ bool CacheWarmupService::preload_single_package(const PackageWarmupInfo& package
                 package_info.version,
                 package_info.repository_url
             );
+            // 仓库拉取无法在传输中分块限速，完成后按实际落盘大小分块扣除预算，推迟后续任务
+            if (success) {
+                uint64_t bytes = 0;
+                std::error_code ec;
+                std::string cached = cache_manager_->get_cached_package_path(package_info.package_name, package_info.version);
+                for (fs::recursive_directory_iterator it(cached, ec), end; !ec && it != end; it.increment(ec)) {
+                    if (it->is_regular_file(ec)) {
+                        bytes += it->file_size(ec);
+                    }
+                }
+                scheduler_->charge(task, bytes > 0 ? bytes : WarmupScheduler::kDefaultEstimate, true);
+            }
         }
         
         if (success) {
@@ -484,6 +537,35 @@ void CacheWarmupService::update_preload_progress(const std::string& package, con
     }
 }
 
+void CacheWarmupService::schedule_pending_packages(std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(preload_mutex_);
+    for (const auto& package : packages_to_preload_) {
+        if (!preloaded_keys_.count(package.package_name + "@" + package.version)) {
+            scheduler_->schedule(package, deadline);
+        }
+    }
+}
+
+bool CacheWarmupService::cancel_preload(const std::string& package, const std::string& version) {
+    bool cancelled = scheduler_->cancel(package + "@" + version);
+    if (cancelled) {
+        LOG(INFO) << "Cancelled warmup of " << package << "@" << version;
+    }
+    return cancelled;
+}
+
+void CacheWarmupService::set_bandwidth_limit(uint64_t bytes_per_second) {
+    WarmupBudget budget = scheduler_->get_budget();
+    budget.network_bytes_per_second = bytes_per_second;
+    scheduler_->set_budget(budget);
+}
+
+void CacheWarmupService::set_disk_write_limit(uint64_t bytes_per_second) {
+    WarmupBudget budget = scheduler_->get_budget();
+    budget.disk_write_bytes_per_second = bytes_per_second;
+    scheduler_->set_budget(budget);
+}
+
 void CacheWarmupService::rebuild_priority_queues() {
     priority_queues_.clear();
     
@@ -591,7 +673,7 @@ double CacheWarmupService::calculate_popularity_score(const PackageWarmupInfo& p
     
     // 基于包大小（较小的包优先）
     if (package.estimated_size > 0) {
-        score += 1000.0 / (package.estimated_size / (1024 * 1024));  // MB
+        score += 1000.0 / std::max(1.0, package.estimated_size / (1024.0 * 1024.0));  // MB
     }
     
     return score;
@@ -715,13 +797,16 @@ void CacheWarmupService::scan_installed_packages_for_warmup() {
 
 std::vector<PackageWarmupInfo> CacheWarmupService::get_preload_queue() const {
     std::lock_guard<std::mutex> lock(preload_mutex_);
-    return packages_to_preload_;
+    std::vector<PackageWarmupInfo> queue = packages_to_preload_;
+    for (auto& package : queue) {
+        package.is_preloaded = preloaded_keys_.count(package.package_name + "@" + package.version) > 0;
+    }
+    return queue;
 }
 
 std::vector<PackageWarmupInfo> CacheWarmupService::get_preloaded_packages() const {
-    std::lock_guard<std::mutex> lock(preload_mutex_);
     std::vector<PackageWarmupInfo> preloaded;
-    for (const auto& package : packages_to_preload_) {
+    for (auto& package : get_preload_queue()) {
         if (package.is_preloaded) {
             preloaded.push_back(package);
         }
@@ -735,11 +820,7 @@ bool CacheWarmupService::check_preload_resources(const PackageWarmupInfo& packag
         return false;
     }
     
-    // 检查并发限制
-    if (current_preload_count_.load() >= max_concurrent_preloads_) {
-        return false;
-    }
-    
+    // 并发、带宽和磁盘写入由调度器控制
     return true;
 }
 
@@ -750,6 +831,7 @@ bool CacheWarmupService::load_default_config() {
         max_preload_size_ = 1024ULL * 1024 * 1024;  // 1GB
         preload_timeout_ = std::chrono::seconds(300);  // 5分钟
         default_strategy_ = WarmupStrategy::ASYNC;
+        scheduler_->set_budget(WarmupBudget());
         
         LOG(INFO) << "Default warmup configuration loaded";
         return true;
@@ -767,6 +849,9 @@ bool CacheWarmupService::save_preload_config(const std::string& config_path) con
         config["max_preload_size_mb"] = max_preload_size_ / (1024 * 1024);
         config["preload_timeout_seconds"] = preload_timeout_.count();
         config["default_strategy"] = static_cast<int>(default_strategy_);
+        WarmupBudget budget = scheduler_->get_budget();
+        config["bandwidth_bytes_per_second"] = budget.network_bytes_per_second;
+        config["disk_write_bytes_per_second"] = budget.disk_write_bytes_per_second;
         
         // 保存包注册信息
         json packages = json::array();
@@ -837,6 +922,10 @@ bool CacheWarmupService::load_preload_config(const std::string& config_path) {
         if (config.contains("default_strategy")) {
             default_strategy_ = static_cast<WarmupStrategy>(config["default_strategy"]);
         }
+        WarmupBudget budget = scheduler_->get_budget();
+        budget.network_bytes_per_second = config.value("bandwidth_bytes_per_second", budget.network_bytes_per_second);
+        budget.disk_write_bytes_per_second = config.value("disk_write_bytes_per_second", budget.disk_write_bytes_per_second);
+        scheduler_->set_budget(budget);
         
         // 加载包信息
         if (config.contains("packages")) {
@@ -890,7 +979,8 @@ bool initialize_cache_warmup_service() {
     }
 }
 
-bool CacheWarmupService::copy_installed_package_to_cache(const PackageWarmupInfo& package_info) {
+bool CacheWarmupService::copy_installed_package_to_cache(const WarmupTask& task) {
+    const PackageWarmupInfo& package_info = task.info;
     try {
         // 检查已安装的包是否存在
         fs::path installed_path = fs::path("packages") / package_info.package_name;
@@ -906,15 +996,16 @@ bool CacheWarmupService::copy_installed_package_to_cache(const PackageWarmupInfo
         // 创建缓存目录
         fs::create_directories(cache_dir.parent_path());
         
-        // 复制包到缓存
-        try {
-            fs::copy(installed_path, cache_dir, fs::copy_options::recursive);
-            LOG(INFO) << "Copied installed package to cache: " << package_info.package_name 
-                      << " from " << installed_path.string() << " to " << cache_path;
-        } catch (const fs::filesystem_error& e) {
-            LOG(ERROR) << "Failed to copy package: " << e.what();
+        // 复制包到缓存：reflink 克隆，不支持时在内核中复制
+        // 每个文件按块扣除磁盘写入预算，前台安装开始时在块之间退避，调度器停止时中止
+        FileMaterializer materializer(MaterializePolicy::REFLINK);
+        materializer.set_file_hook([this, &task](size_t bytes) { return scheduler_->charge(task, bytes, false); });
+        if (!materializer.materialize_tree(installed_path.string(), cache_path).success) {
+            LOG(ERROR) << "Failed to copy package: " << installed_path.string() << " to " << cache_path;
             return false;
         }
+        LOG(INFO) << "Copied installed package to cache: " << package_info.package_name 
+                  << " from " << installed_path.string() << " to " << cache_path;
         
         // 更新缓存索引 - 保存缓存索引
         cache_manager_->save_cache_index();
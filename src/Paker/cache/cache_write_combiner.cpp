@@ -0,0 +1,270 @@
+#include "Paker/cache/cache_write_combiner.h"
+#include "Paker/core/io_uring_engine.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// sync 时在关闭前 fdatasync，刷写复用写入的描述符，不再重新打开文件
+bool write_whole_file(const std::string& path, const std::string& content, bool sync) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t written = ::write(fd, content.data() + offset, content.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    if (sync && ::fdatasync(fd) != 0) {
+        LOG(WARNING) << "Failed to flush cache write " << path << ": " << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    return ::close(fd) == 0;
+}
+
+} // namespace
+
+CacheWriteCombiner::CacheWriteCombiner(WriteCombinerConfig config) : config_(config) {
+    worker_ = std::thread(&CacheWriteCombiner::run, this);
+}
+
+CacheWriteCombiner::~CacheWriteCombiner() {
+    stop();
+}
+
+bool CacheWriteCombiner::accepts(size_t size) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_.enabled && !stopping_ && size <= config_.max_entry_size;
+}
+
+void CacheWriteCombiner::submit(std::string path, std::string content, Callback done) {
+    auto now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    stats_.writes_submitted++;
+    if (stopping_) {
+        // 后台线程已停止，在调用线程上单独写入
+        lock.unlock();
+        std::vector<PendingWrite> batch(1);
+        batch[0].path = std::move(path);
+        batch[0].content = std::move(content);
+        batch[0].callbacks.push_back(std::move(done));
+        batch[0].submit_times.push_back(now);
+        std::vector<bool> results = write_batch(batch);
+        dispatch(batch, results);
+        return;
+    }
+
+    bool was_empty = pending_.empty();
+    bool was_ready = !was_empty && batch_ready(now);
+    auto it = pending_index_.find(path);
+    if (it != pending_index_.end()) {
+        // 批内覆盖：只保留最后一次内容，所有等待者在同一次落盘后回调
+        PendingWrite& existing = pending_[it->second];
+        pending_bytes_ = pending_bytes_ - existing.content.size() + content.size();
+        existing.content = std::move(content);
+        existing.callbacks.push_back(std::move(done));
+        existing.submit_times.push_back(now);
+        stats_.writes_coalesced++;
+    } else {
+        if (was_empty) {
+            batch_started_ = now;
+        }
+        pending_bytes_ += content.size();
+        pending_index_.emplace(path, pending_.size());
+        PendingWrite write;
+        write.path = std::move(path);
+        write.content = std::move(content);
+        write.callbacks.push_back(std::move(done));
+        write.submit_times.push_back(now);
+        pending_.push_back(std::move(write));
+    }
+    // 只在批次刚开始或刚好攒满时唤醒后台线程，其余情况由它按超时醒来
+    bool wake = was_empty || (!was_ready && batch_ready(now));
+    lock.unlock();
+    if (wake) {
+        work_cv_.notify_one();
+    }
+}
+
+bool CacheWriteCombiner::batch_ready(std::chrono::steady_clock::time_point now) const {
+    return pending_.size() >= config_.max_batch_entries || pending_bytes_ >= config_.max_batch_bytes ||
+           now >= batch_started_ + config_.max_delay || flush_waiters_ > 0;
+}
+
+void CacheWriteCombiner::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    worker_id_ = std::this_thread::get_id();
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            break;
+        }
+        while (!stopping_ && !batch_ready(std::chrono::steady_clock::now())) {
+            work_cv_.wait_until(lock, batch_started_ + config_.max_delay);
+        }
+
+        std::vector<PendingWrite> batch = take_pending();
+        writing_ = true;
+        lock.unlock();
+        std::vector<bool> results = write_batch(batch);
+        lock.lock();
+        // 回调和被恢复的协程可能再调用 flush：先清除 writing_ 再回调
+        writing_ = false;
+        dispatching_ = true;
+        lock.unlock();
+        dispatch(batch, results);
+        lock.lock();
+        dispatching_ = false;
+        drained_cv_.notify_all();
+    }
+}
+
+std::vector<CacheWriteCombiner::PendingWrite> CacheWriteCombiner::take_pending() {
+    std::vector<PendingWrite> batch;
+    batch.swap(pending_);
+    pending_index_.clear();
+    pending_bytes_ = 0;
+    return batch;
+}
+
+std::vector<bool> CacheWriteCombiner::write_batch(const std::vector<PendingWrite>& batch) {
+    bool durable;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        durable = config_.durable;
+    }
+
+    // durable 时只刷写本批写入的文件，不像 syncfs 那样连带整个文件系统上其他进程的脏数据：
+    // 环上的 fdatasync 与写入在同一条链里一起提交，同步路径在写完后用同一个描述符刷写
+    std::vector<bool> results;
+    bool used_ring = false;
+    IoUringEngine* engine = batch.size() > 1 ? IoUringEngine::for_current_thread() : nullptr;
+    if (engine) {
+        std::vector<std::pair<std::string, std::string_view>> files;
+        files.reserve(batch.size());
+        for (const auto& write : batch) {
+            files.emplace_back(write.path, write.content);
+        }
+        results = engine->write_files(files, durable);
+        used_ring = true;
+    } else {
+        results.resize(batch.size());
+        std::unordered_set<std::string> parents;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            fs::path parent = fs::path(batch[i].path).parent_path();
+            if (!parent.empty() && parents.insert(parent.string()).second) {
+                std::error_code ec;
+                fs::create_directories(parent, ec);
+            }
+            results[i] = write_whole_file(batch[i].path, batch[i].content, durable);
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.batches++;
+        stats_.io_uring_batches += used_ring ? 1 : 0;
+        stats_.durable_batches += durable && !batch.empty() ? 1 : 0;
+        stats_.max_batch_size = std::max(stats_.max_batch_size, batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (results[i]) {
+                stats_.files_written++;
+                stats_.files_flushed += durable ? 1 : 0;
+                stats_.bytes_written += batch[i].content.size();
+            } else {
+                stats_.failed_writes++;
+                LOG(WARNING) << "Failed to write cache file " << batch[i].path;
+            }
+            for (auto submitted : batch[i].submit_times) {
+                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - submitted);
+                stats_.total_latency += latency;
+                stats_.max_latency = std::max(stats_.max_latency, latency);
+            }
+        }
+    }
+    return results;
+}
+
+void CacheWriteCombiner::dispatch(std::vector<PendingWrite>& batch, const std::vector<bool>& results) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+        for (auto& callback : batch[i].callbacks) {
+            if (callback) {
+                callback(results[i], results[i] ? batch[i].content.size() : 0);
+            }
+        }
+    }
+}
+
+void CacheWriteCombiner::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (std::this_thread::get_id() == worker_id_) {
+        // 从回调里刷盘：后台线程就是当前线程，等它会死锁，直接在这里写完剩余批次
+        while (!pending_.empty()) {
+            std::vector<PendingWrite> batch = take_pending();
+            lock.unlock();
+            std::vector<bool> results = write_batch(batch);
+            dispatch(batch, results);
+            lock.lock();
+        }
+        return;
+    }
+    flush_waiters_++;
+    work_cv_.notify_one();
+    drained_cv_.wait(lock, [this] { return pending_.empty() && !writing_ && !dispatching_; });
+    flush_waiters_--;
+}
+
+void CacheWriteCombiner::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void CacheWriteCombiner::set_config(const WriteCombinerConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+    }
+    work_cv_.notify_one();
+}
+
+WriteCombinerConfig CacheWriteCombiner::get_config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+WriteCombinerStats CacheWriteCombiner::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace Paker
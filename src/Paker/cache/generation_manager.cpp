@@ -0,0 +1,376 @@
+#include "Paker/cache/generation_manager.h"
+#include "Paker/core/utils.h"
+#include <glog/logging.h>
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+constexpr const char* kGenerationPrefix = "generations/";
+
+// "generations/12" -> 12
+uint64_t parse_generation_link(const std::string& target) {
+    const std::string prefix = kGenerationPrefix;
+    if (target.compare(0, prefix.size(), prefix) != 0) {
+        return 0;
+    }
+    try {
+        return std::stoull(target.substr(prefix.size()));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+} // namespace
+
+GenerationManager::GenerationManager(const std::string& project_path)
+    : paker_dir_((fs::absolute(project_path) / ".paker").lexically_normal().string()),
+      links_path_(paker_dir_ + "/links"),
+      generations_dir_(paker_dir_ + "/generations") {}
+
+std::string GenerationManager::generation_path(uint64_t id) const {
+    return generations_dir_ + "/" + std::to_string(id);
+}
+
+std::string GenerationManager::tree_path(const std::string& package, const std::string& version,
+                                         const std::string& policy) const {
+    std::string path = paker_dir_ + "/trees/" + package + "@" + version;
+    return policy.empty() ? path : path + "~" + policy;
+}
+
+uint64_t GenerationManager::current() const {
+    std::error_code ec;
+    if (!fs::is_symlink(links_path_, ec)) {
+        return 0;
+    }
+    return parse_generation_link(fs::read_symlink(links_path_, ec).string());
+}
+
+bool GenerationManager::load(uint64_t id, Generation& generation) const {
+    std::string path = generation_path(id) + ".json";
+    try {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        json j;
+        file >> j;
+        generation.id = id;
+        generation.created = std::chrono::system_clock::time_point(std::chrono::seconds(j.value("created", 0LL)));
+        generation.reason = j.value("reason", "");
+        generation.packages.clear();
+        for (const auto& [package, entry] : j["packages"].items()) {
+            generation.packages[package] = {entry.value("version", ""), entry.value("target", "")};
+        }
+        return true;
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read generation " << path << ": " << e.what();
+        return false;
+    }
+}
+
+std::vector<Generation> GenerationManager::list() const {
+    std::vector<Generation> generations;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(generations_dir_, ec)) {
+        if (item.path().extension() != ".json") {
+            continue;
+        }
+        uint64_t id = 0;
+        try {
+            id = std::stoull(item.path().stem().string());
+        } catch (const std::exception&) {
+            continue;
+        }
+        Generation generation;
+        if (load(id, generation)) {
+            generations.push_back(std::move(generation));
+        }
+    }
+    std::sort(generations.begin(), generations.end(),
+              [](const Generation& a, const Generation& b) { return a.id < b.id; });
+    return generations;
+}
+
+bool GenerationManager::write_metadata(const Generation& generation) const {
+    std::string path = generation_path(generation.id) + ".json";
+    std::string temp = path + ".tmp";
+    try {
+        json packages = json::object();
+        for (const auto& [package, entry] : generation.packages) {
+            packages[package] = {{"version", entry.version}, {"target", entry.target}};
+        }
+        json j = {{"id", generation.id},
+                  {"created", std::chrono::duration_cast<std::chrono::seconds>(
+                                  generation.created.time_since_epoch()).count()},
+                  {"reason", generation.reason},
+                  {"packages", std::move(packages)}};
+        {
+            std::ofstream file(temp);
+            file << j.dump(2);
+            if (!file) {
+                return false;
+            }
+        }
+        fs::rename(temp, path);
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to write generation metadata " << path << ": " << e.what();
+        std::error_code ec;
+        fs::remove(temp, ec);
+        return false;
+    }
+}
+
+bool GenerationManager::swap_links(const std::string& target, std::chrono::microseconds& latency) {
+    std::string next = paker_dir_ + "/links.next";
+    ::unlink(next.c_str());
+    if (::symlink(target.c_str(), next.c_str()) != 0) {
+        LOG(ERROR) << "Failed to create link " << next << ": " << std::strerror(errno);
+        return false;
+    }
+
+    std::error_code ec;
+    bool links_exist = fs::exists(fs::symlink_status(links_path_, ec));
+    bool exchanged = false;
+    auto start = std::chrono::steady_clock::now();
+#ifdef __linux__
+    // 交换两个目录项：旧 links 无论是软链接还是真实目录都被原子替换
+    if (links_exist && ::renameat2(AT_FDCWD, next.c_str(), AT_FDCWD, links_path_.c_str(), RENAME_EXCHANGE) == 0) {
+        exchanged = true;
+    }
+#endif
+    if (!exchanged) {
+        // 不支持 RENAME_EXCHANGE 时，软链接之间的 rename 同样是原子的；真实目录不能被覆盖
+        if (links_exist && !fs::is_symlink(links_path_, ec) && fs::is_directory(links_path_, ec)) {
+            LOG(ERROR) << "Cannot atomically replace directory " << links_path_;
+            ::unlink(next.c_str());
+            return false;
+        }
+        if (::rename(next.c_str(), links_path_.c_str()) != 0) {
+            LOG(ERROR) << "Failed to switch " << links_path_ << ": " << std::strerror(errno);
+            ::unlink(next.c_str());
+            return false;
+        }
+    }
+    latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    if (exchanged) {
+        // next 现在是被换下的旧 links
+        if (fs::is_symlink(next, ec)) {
+            ::unlink(next.c_str());
+        } else {
+            fs::remove_all(next, ec);
+        }
+    }
+    return true;
+}
+
+bool GenerationManager::ensure_initialized() {
+    if (current() != 0) {
+        return true;
+    }
+    try {
+        fs::create_directories(generations_dir_);
+
+        // 旧式的 links 目录：软链接直接沿用，物化出的目录移到 trees 下
+        std::map<std::string, GenerationEntry> packages;
+        if (fs::is_directory(links_path_) && !fs::is_symlink(links_path_)) {
+            for (const auto& item : fs::directory_iterator(links_path_)) {
+                std::string package = item.path().filename().string();
+                if (item.is_symlink()) {
+                    fs::path target = fs::read_symlink(item.path());
+                    if (target.is_relative()) {
+                        target = (fs::path(links_path_) / target).lexically_normal();
+                    }
+                    packages[package] = {target.filename().string(), target.string()};
+                } else if (item.is_directory()) {
+                    std::string tree = tree_path(package, "migrated");
+                    fs::create_directories(fs::path(tree).parent_path());
+                    fs::remove_all(tree);
+                    fs::rename(item.path(), tree);
+                    packages[package] = {"", tree};
+                }
+            }
+        }
+
+        Generation initial;
+        initial.reason = "initial";
+        initial.packages = std::move(packages);
+        uint64_t id = write_generation(initial);
+        if (id == 0) {
+            return false;
+        }
+        GenerationSwitchResult switched = switch_to(id);
+        if (!switched.success) {
+            return false;
+        }
+        LOG(INFO) << "Initialized package generations in " << generations_dir_ << " with "
+                  << initial.packages.size() << " packages";
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to initialize package generations: " << e.what();
+        return false;
+    }
+}
+
+uint64_t GenerationManager::create_generation(const std::map<std::string, GenerationEntry>& changes,
+                                              const std::vector<std::string>& removals,
+                                              const std::string& reason) {
+    if (!ensure_initialized()) {
+        return 0;
+    }
+    Generation generation;
+    uint64_t base = current();
+    if (!load(base, generation)) {
+        LOG(ERROR) << "Current generation " << base << " is unreadable";
+        return 0;
+    }
+    for (const auto& [package, entry] : changes) {
+        generation.packages[package] = entry;
+    }
+    for (const auto& package : removals) {
+        generation.packages.erase(package);
+    }
+    generation.reason = reason;
+    return write_generation(generation);
+}
+
+uint64_t GenerationManager::write_generation(Generation generation) {
+    uint64_t id = current();
+    for (const auto& existing : list()) {
+        id = std::max(id, existing.id);
+    }
+    generation.id = id + 1;
+    generation.created = std::chrono::system_clock::now();
+
+    // 新一代只含软链接，建在独立目录中，切换前对当前代没有任何影响
+    std::string dir = generation_path(generation.id);
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    if (!fs::create_directories(dir, ec) && ec) {
+        LOG(ERROR) << "Failed to create generation directory " << dir << ": " << ec.message();
+        return 0;
+    }
+    for (const auto& [package, entry] : generation.packages) {
+        fs::path link = fs::path(dir) / package;
+        if (::symlink(entry.target.c_str(), link.c_str()) != 0) {
+            LOG(ERROR) << "Failed to link " << package << " in generation " << generation.id << ": "
+                       << std::strerror(errno);
+            fs::remove_all(dir, ec);
+            return 0;
+        }
+    }
+    if (!write_metadata(generation)) {
+        fs::remove_all(dir, ec);
+        return 0;
+    }
+    return generation.id;
+}
+
+GenerationSwitchResult GenerationManager::switch_to(uint64_t id) {
+    GenerationSwitchResult result;
+    result.from = current();
+    result.to = id;
+    std::error_code ec;
+    if (!fs::is_directory(generation_path(id), ec)) {
+        LOG(ERROR) << "Generation " << id << " does not exist";
+        return result;
+    }
+    result.success = swap_links(kGenerationPrefix + std::to_string(id), result.switch_latency);
+    if (result.success) {
+        LOG(INFO) << "Switched packages from generation " << result.from << " to " << id << " in "
+                  << result.switch_latency.count() << "us";
+    }
+    return result;
+}
+
+uint64_t GenerationManager::find_generation_with(const std::string& package, const std::string& version) const {
+    std::vector<Generation> generations = list();
+    for (auto it = generations.rbegin(); it != generations.rend(); ++it) {
+        auto entry = it->packages.find(package);
+        std::error_code ec;
+        if (entry != it->packages.end() && entry->second.version == version && fs::exists(entry->second.target, ec)) {
+            return it->id;
+        }
+    }
+    return 0;
+}
+
+size_t GenerationManager::collect_garbage(const GenerationRetention& retention) {
+    std::vector<Generation> generations = list();
+    uint64_t active = current();
+    uint64_t previous = 0;
+    for (const auto& generation : generations) {
+        if (generation.id < active) {
+            previous = generation.id;
+        }
+    }
+
+    auto now = std::chrono::system_clock::now();
+    size_t removed = 0;
+    size_t kept = 0;
+    std::set<std::string> referenced;
+    std::error_code ec;
+    for (auto it = generations.rbegin(); it != generations.rend(); ++it) {
+        bool pinned = it->id == active || it->id == previous;
+        bool wanted = kept < retention.keep_last && now - it->created <= retention.max_age;
+        if (pinned || wanted) {
+            kept++;
+            for (const auto& [package, entry] : it->packages) {
+                referenced.insert(entry.target);
+            }
+            continue;
+        }
+        fs::remove_all(generation_path(it->id), ec);
+        fs::remove(generation_path(it->id) + ".json", ec);
+        removed++;
+    }
+
+    // 物化目录只在没有任何一代引用时删除
+    for (const auto& item : fs::directory_iterator(paker_dir_ + "/trees", ec)) {
+        if (!referenced.count(item.path().string())) {
+            fs::remove_all(item.path(), ec);
+        }
+    }
+    if (removed > 0) {
+        LOG(INFO) << "Removed " << removed << " old package generations";
+    }
+    return removed;
+}
+
+GenerationRetention load_project_generation_retention(const std::string& project_path) {
+    GenerationRetention retention;
+    fs::path json_file = fs::path(project_path) / get_json_file();
+    try {
+        std::ifstream ifs(json_file);
+        if (!ifs) {
+            return retention;
+        }
+        json j;
+        ifs >> j;
+        if (j.contains("generations") && j["generations"].is_object()) {
+            const json& config = j["generations"];
+            retention.keep_last = config.value("keep", retention.keep_last);
+            retention.max_age = std::chrono::hours(24 * config.value("max_age_days", 30));
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read generation retention from " << json_file << ": " << e.what();
+    }
+    return retention;
+}
+
+} // namespace Paker
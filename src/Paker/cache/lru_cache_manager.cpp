@@ -1,10 +1,14 @@
 #include "Paker/cache/lru_cache_manager.h"
+#include "Paker/cache/cache_lock.h"
+#include "Paker/cache/materializer.h"
 #include "Paker/core/output.h"
 #include <glog/logging.h>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <sstream>
+#include <shared_mutex>
 #include "nlohmann/json.hpp"
 
 using json = nlohmann::json;
@@ -16,20 +20,126 @@ namespace Paker {
 std::unique_ptr<LRUCacheManager> g_lru_cache_manager;
 std::unique_ptr<SmartCacheCleaner> g_smart_cache_cleaner;
 
+namespace {
+
+// 读路径上访问时间的更新粒度：同一秒内的重复命中不再写同一个缓存行
+constexpr int64_t kRecencySampleTicks =
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(1)).count();
+
+int64_t to_ticks(std::chrono::system_clock::time_point time) {
+    return time.time_since_epoch().count();
+}
+
+std::chrono::system_clock::time_point from_ticks(int64_t ticks) {
+    return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(ticks));
+}
+
+} // namespace
+
+// 缓存分片：项表、时钟环和计数器；按缓存行对齐，避免不同分片的计数器互相干扰
+struct alignas(64) LRUCacheManager::Shard {
+    struct Entry {
+        LRUCacheItem item;                    // 访问时间和次数以下面的原子量为准
+        std::atomic<bool> referenced{false};  // CLOCK 访问位，新加入的项再被访问一次才受保护
+        std::atomic<int64_t> last_access{0};
+        std::atomic<size_t> access_count{0};
+        size_t clock_slot = 0;                // 在时钟环中的位置
+    };
+    
+    mutable std::shared_mutex mutex;
+    std::unordered_map<LRUCacheKey, Entry, LRUCacheKeyHash> entries;
+    std::vector<LRUCacheKey> clock;
+    size_t hand = 0;
+    
+    std::atomic<size_t> size_bytes{0};
+    std::atomic<size_t> item_count{0};
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+    
+    // 命中：置访问位并抽样更新访问时间，只用 relaxed 原子操作，持有共享锁即可
+    static void touch(Entry& entry, bool force_timestamp) {
+        if (!entry.referenced.load(std::memory_order_relaxed)) {
+            entry.referenced.store(true, std::memory_order_relaxed);
+        }
+        entry.access_count.fetch_add(1, std::memory_order_relaxed);
+        int64_t now = to_ticks(std::chrono::system_clock::now());
+        if (force_timestamp || now - entry.last_access.load(std::memory_order_relaxed) >= kRecencySampleTicks) {
+            entry.last_access.store(now, std::memory_order_relaxed);
+        }
+    }
+    
+    static LRUCacheItem snapshot(const Entry& entry) {
+        LRUCacheItem item = entry.item;
+        item.last_access = from_ticks(entry.last_access.load(std::memory_order_relaxed));
+        item.access_count = entry.access_count.load(std::memory_order_relaxed);
+        return item;
+    }
+    
+    // 以下在独占锁内调用
+    Entry& insert(const LRUCacheItem& item) {
+        auto [it, inserted] = entries.try_emplace(item.key);
+        Entry& entry = it->second;
+        if (!inserted) {
+            size_bytes.fetch_sub(entry.item.size_bytes, std::memory_order_relaxed);
+        } else {
+            entry.clock_slot = clock.size();
+            clock.push_back(item.key);
+            item_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        entry.item = item;
+        entry.last_access.store(to_ticks(item.last_access), std::memory_order_relaxed);
+        entry.access_count.store(item.access_count, std::memory_order_relaxed);
+        size_bytes.fetch_add(item.size_bytes, std::memory_order_relaxed);
+        return entry;
+    }
+    
+    void erase(std::unordered_map<LRUCacheKey, Entry, LRUCacheKeyHash>::iterator it) {
+        // 与环尾交换后弹出；指针停在原位，下一步检查换过来的项
+        size_t slot = it->second.clock_slot;
+        LRUCacheKey moved = clock.back();
+        clock[slot] = moved;
+        entries.find(moved)->second.clock_slot = slot;
+        clock.pop_back();
+        size_bytes.fetch_sub(it->second.item.size_bytes, std::memory_order_relaxed);
+        item_count.fetch_sub(1, std::memory_order_relaxed);
+        entries.erase(it);
+    }
+    
+    void clear() {
+        entries.clear();
+        clock.clear();
+        hand = 0;
+        size_bytes = 0;
+        item_count = 0;
+    }
+};
+
 LRUCacheManager::LRUCacheManager(const std::string& cache_directory,
                                size_t max_cache_size,
                                size_t max_cache_items,
                                std::chrono::hours max_age,
-                               CacheEvictionPolicy policy)
-    : max_cache_size_(max_cache_size)
+                               CacheEvictionPolicy policy,
+                               size_t shard_count)
+    : eviction_cursor_(0)
+    , max_cache_size_(max_cache_size)
     , max_cache_items_(max_cache_items)
     , max_age_(max_age)
     , eviction_policy_(policy)
-    , cache_directory_(cache_directory)
-    , adaptive_strategy_(std::make_unique<AdaptiveCacheStrategy>()) {
+    , adaptive_strategy_(std::make_unique<AdaptiveCacheStrategy>())
+    , cache_directory_(cache_directory) {
+    
+    // 分片数向上取 2 的幂，用掩码选分片
+    size_t shards = 1;
+    while (shards < std::max<size_t>(shard_count, 1)) {
+        shards <<= 1;
+    }
+    shard_mask_ = shards - 1;
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
     
     LOG(INFO) << "LRUCacheManager initialized with max size: " << max_cache_size_ 
-              << " bytes, max items: " << max_cache_items_;
+              << " bytes, max items: " << max_cache_items_ << ", shards: " << shards;
 }
 
 LRUCacheManager::~LRUCacheManager() {
@@ -66,20 +176,25 @@ bool LRUCacheManager::initialize() {
 
 bool LRUCacheManager::add_item(const std::string& package_name, const std::string& version, 
                               const std::string& cache_path) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
     try {
-        std::string key = generate_cache_key(package_name, version);
+        // 包名和版本各自驻留，组合键不驻留
+        LRUCacheKey key{Symbol(package_name), Symbol(version)};
+        Shard& shard = shard_for(key);
         
         // 检查是否已存在
-        if (cache_items_.find(key) != cache_items_.end()) {
-            LOG(INFO) << "Item already exists: " << key;
-            mark_accessed(package_name, version);
-            return true;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end()) {
+                LOG(INFO) << "Item already exists: " << key;
+                Shard::touch(it->second, true);
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
         }
         
-        // 创建新的缓存项
-        LRUCacheItem item(key, package_name, version);
+        // 创建新的缓存项；遍历目录算大小时不持有任何锁
+        LRUCacheItem item(package_name, version);
         item.cache_path = cache_path;
         item.size_bytes = calculate_item_size(cache_path);
         item.last_access = std::chrono::system_clock::now();
@@ -87,20 +202,22 @@ bool LRUCacheManager::add_item(const std::string& package_name, const std::strin
         item.access_count = 1;
         
         // 检查是否需要清理
-        if (statistics_.total_size_bytes + item.size_bytes > max_cache_size_ ||
-            cache_items_.size() >= max_cache_items_) {
+        if (get_cache_size() + item.size_bytes > max_cache_size_ ||
+            get_cache_items_count() >= max_cache_items_) {
+            std::lock_guard<std::mutex> lock(maintenance_mutex_);
             perform_eviction();
         }
         
-        // 添加项
-        cache_items_[key] = item;
-        lru_list_.push_front(key);
-        lru_map_[key] = lru_list_.begin();
-        
-        // 更新统计
-        statistics_.total_items++;
-        statistics_.total_size_bytes += item.size_bytes;
-        statistics_.package_sizes[package_name] += item.size_bytes;
+        // 添加项；其他线程可能已抢先加入同一项
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end()) {
+                Shard::touch(it->second, true);
+                return true;
+            }
+            shard.insert(item);
+        }
         
         // 记录访问模式
         if (adaptive_strategy_) {
@@ -117,103 +234,83 @@ bool LRUCacheManager::add_item(const std::string& package_name, const std::strin
 }
 
 bool LRUCacheManager::remove_item(const std::string& package_name, const std::string& version) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    try {
-        std::string key = generate_cache_key(package_name, version);
-        
-        auto it = cache_items_.find(key);
-        if (it == cache_items_.end()) {
-            LOG(INFO) << "Item not found: " << key;
-            return false;
-        }
-        
-        const LRUCacheItem& item = it->second;
-        
-        // 从LRU列表中移除
-        auto lru_it = lru_map_.find(key);
-        if (lru_it != lru_map_.end()) {
-            lru_list_.erase(lru_it->second);
-            lru_map_.erase(lru_it);
-        }
-        
-        // 从缓存中移除
-        cache_items_.erase(it);
-        
-        // 更新统计
-        statistics_.total_items--;
-        statistics_.total_size_bytes -= item.size_bytes;
-        auto size_it = statistics_.package_sizes.find(package_name);
-        if (size_it != statistics_.package_sizes.end()) {
-            size_it->second -= item.size_bytes;
-            if (size_it->second == 0) {
-                statistics_.package_sizes.erase(size_it);
-            }
-        }
-        
-        LOG(INFO) << "Removed cache item: " << key;
-        return true;
-        
-    } catch (const std::exception& e) {
-        LOG(ERROR) << "Failed to remove cache item: " << e.what();
+    auto key = find_cache_key(package_name, version);
+    if (!key || !evict_item(*key)) {
+        LOG(INFO) << "Item not found: " << generate_cache_key(package_name, version);
         return false;
     }
+    
+    LOG(INFO) << "Removed cache item: " << *key;
+    return true;
 }
 
 bool LRUCacheManager::has_item(const std::string& package_name, const std::string& version) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    std::string key = generate_cache_key(package_name, version);
-    return cache_items_.find(key) != cache_items_.end();
+    auto key = find_cache_key(package_name, version);
+    if (!key) {
+        return false;
+    }
+    Shard& shard = shard_for(*key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.entries.count(*key) > 0;
 }
 
 std::string LRUCacheManager::get_item_path(const std::string& package_name, const std::string& version) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto key = find_cache_key(package_name, version);
+    if (!key) {
+        // 从未驻留过的键：按包名选分片计数，未命中不会都挤在同一个计数器上
+        shards_[std::hash<std::string>{}(package_name) & shard_mask_]->misses.fetch_add(1, std::memory_order_relaxed);
+        return "";
+    }
     
-    std::string key = generate_cache_key(package_name, version);
-    auto it = cache_items_.find(key);
-    if (it != cache_items_.end()) {
-        update_lru(key);
-        update_statistics(key, true);
-        return it->second.cache_path;
+    Shard& shard = shard_for(*key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(*key);
+    if (it != shard.entries.end()) {
+        Shard::touch(it->second, false);
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second.item.cache_path;
     }
     
-    update_statistics(key, false);
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
     return "";
 }
 
 void LRUCacheManager::mark_accessed(const std::string& package_name, const std::string& version) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    std::string key = generate_cache_key(package_name, version);
-    auto it = cache_items_.find(key);
-    if (it != cache_items_.end()) {
-        it->second.last_access = std::chrono::system_clock::now();
-        it->second.access_count++;
-        update_lru(key);
-        update_statistics(key, true);
+    auto key = find_cache_key(package_name, version);
+    if (!key) {
+        return;
+    }
+    Shard& shard = shard_for(*key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(*key);
+    if (it != shard.entries.end()) {
+        Shard::touch(it->second, true);
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
 void LRUCacheManager::pin_item(const std::string& package_name, const std::string& version, bool pinned) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    std::string key = generate_cache_key(package_name, version);
-    auto it = cache_items_.find(key);
-    if (it != cache_items_.end()) {
-        it->second.is_pinned = pinned;
-        LOG(INFO) << (pinned ? "Pinned" : "Unpinned") << " cache item: " << key;
+    auto key = find_cache_key(package_name, version);
+    if (!key) {
+        return;
+    }
+    Shard& shard = shard_for(*key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(*key);
+    if (it != shard.entries.end()) {
+        it->second.item.is_pinned = pinned;
+        LOG(INFO) << (pinned ? "Pinned" : "Unpinned") << " cache item: " << *key;
     }
 }
 
 bool LRUCacheManager::cleanup_cache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
     
     try {
         LOG(INFO) << "Starting cache cleanup...";
         
-        size_t initial_items = cache_items_.size();
-        size_t initial_size = statistics_.total_size_bytes;
+        size_t initial_items = get_cache_items_count();
+        size_t initial_size = get_cache_size();
         
         // 执行清理
         perform_eviction();
@@ -224,8 +321,8 @@ bool LRUCacheManager::cleanup_cache() {
         // 清理未使用项
         cleanup_unused_items();
         
-        size_t final_items = cache_items_.size();
-        size_t final_size = statistics_.total_size_bytes;
+        size_t final_items = get_cache_items_count();
+        size_t final_size = get_cache_size();
         
         statistics_.last_cleanup = std::chrono::system_clock::now();
         
@@ -241,20 +338,15 @@ bool LRUCacheManager::cleanup_cache() {
 }
 
 bool LRUCacheManager::force_cleanup() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
     
     try {
         LOG(INFO) << "Starting force cleanup...";
         
         // 移除所有未固定的项
-        auto it = cache_items_.begin();
-        while (it != cache_items_.end()) {
-            if (!it->second.is_pinned) {
-                std::string key = it->first;
-                ++it;
-                evict_item(key);
-            } else {
-                ++it;
+        for (const auto& item : snapshot_items()) {
+            if (!item.is_pinned) {
+                evict_item(item.key);
             }
         }
         
@@ -268,14 +360,14 @@ bool LRUCacheManager::force_cleanup() {
 }
 
 bool LRUCacheManager::cleanup_package(const std::string& package_name) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
     
     try {
-        std::vector<std::string> keys_to_remove;
+        std::vector<LRUCacheKey> keys_to_remove;
         
-        for (const auto& [key, item] : cache_items_) {
+        for (const auto& item : snapshot_items()) {
             if (item.package_name == package_name) {
-                keys_to_remove.push_back(key);
+                keys_to_remove.push_back(item.key);
             }
         }
         
@@ -294,11 +386,11 @@ bool LRUCacheManager::cleanup_package(const std::string& package_name) {
 
 bool LRUCacheManager::cleanup_old_items() {
     auto cutoff_time = std::chrono::system_clock::now() - max_age_;
-    std::vector<std::string> keys_to_remove;
+    std::vector<LRUCacheKey> keys_to_remove;
     
-    for (const auto& [key, item] : cache_items_) {
+    for (const auto& item : snapshot_items()) {
         if (!item.is_pinned && item.last_access < cutoff_time) {
-            keys_to_remove.push_back(key);
+            keys_to_remove.push_back(item.key);
         }
     }
     
@@ -315,11 +407,11 @@ bool LRUCacheManager::cleanup_old_items() {
 
 bool LRUCacheManager::cleanup_unused_items() {
     // 清理访问次数少于2次的项
-    std::vector<std::string> keys_to_remove;
+    std::vector<LRUCacheKey> keys_to_remove;
     
-    for (const auto& [key, item] : cache_items_) {
+    for (const auto& item : snapshot_items()) {
         if (!item.is_pinned && item.access_count < 2) {
-            keys_to_remove.push_back(key);
+            keys_to_remove.push_back(item.key);
         }
     }
     
@@ -335,43 +427,72 @@ bool LRUCacheManager::cleanup_unused_items() {
 }
 
 CacheStatistics LRUCacheManager::get_statistics() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    return statistics_;
+    CacheStatistics stats;
+    {
+        std::lock_guard<std::mutex> lock(maintenance_mutex_);
+        stats = statistics_;
+    }
+    stats.total_items = 0;
+    stats.total_size_bytes = 0;
+    stats.hit_count = 0;
+    stats.miss_count = 0;
+    stats.package_sizes.clear();
+    for (const auto& shard : shards_) {
+        stats.total_items += shard->item_count.load(std::memory_order_relaxed);
+        stats.total_size_bytes += shard->size_bytes.load(std::memory_order_relaxed);
+        stats.hit_count += shard->hits.load(std::memory_order_relaxed);
+        stats.miss_count += shard->misses.load(std::memory_order_relaxed);
+        
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const auto& [key, entry] : shard->entries) {
+            stats.package_sizes[entry.item.package_name.str()] += entry.item.size_bytes;
+        }
+    }
+    size_t total_requests = stats.hit_count + stats.miss_count;
+    stats.hit_rate = total_requests > 0 ? static_cast<double>(stats.hit_count) / total_requests : 0.0;
+    return stats;
 }
 
 size_t LRUCacheManager::get_cache_size() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    return statistics_.total_size_bytes;
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->size_bytes.load(std::memory_order_relaxed);
+    }
+    return total;
 }
 
 size_t LRUCacheManager::get_cache_items_count() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    return cache_items_.size();
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->item_count.load(std::memory_order_relaxed);
+    }
+    return total;
 }
 
 double LRUCacheManager::get_hit_rate() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    return statistics_.hit_rate;
+    size_t hits = 0;
+    size_t misses = 0;
+    for (const auto& shard : shards_) {
+        hits += shard->hits.load(std::memory_order_relaxed);
+        misses += shard->misses.load(std::memory_order_relaxed);
+    }
+    return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
 }
 
 std::vector<std::string> LRUCacheManager::get_all_packages() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
     std::set<std::string> packages;
-    for (const auto& [key, item] : cache_items_) {
-        packages.insert(item.package_name);
+    for (const auto& item : snapshot_items()) {
+        packages.insert(item.package_name.str());
     }
     
     return std::vector<std::string>(packages.begin(), packages.end());
 }
 
 std::vector<std::string> LRUCacheManager::get_package_versions(const std::string& package_name) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
     std::vector<std::string> versions;
-    for (const auto& [key, item] : cache_items_) {
+    for (const auto& item : snapshot_items()) {
         if (item.package_name == package_name) {
-            versions.push_back(item.version);
+            versions.push_back(item.version.str());
         }
     }
     
@@ -379,45 +500,29 @@ std::vector<std::string> LRUCacheManager::get_package_versions(const std::string
 }
 
 std::vector<LRUCacheItem> LRUCacheManager::get_oldest_items(size_t count) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    std::vector<std::pair<std::string, LRUCacheItem>> items;
-    for (const auto& [key, item] : cache_items_) {
-        items.emplace_back(key, item);
-    }
-    
-    std::sort(items.begin(), items.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second.last_access < b.second.last_access;
-              });
+    std::vector<LRUCacheItem> items = snapshot_items();
     
-    std::vector<LRUCacheItem> result;
-    for (size_t i = 0; i < std::min(count, items.size()); ++i) {
-        result.push_back(items[i].second);
-    }
+    count = std::min(count, items.size());
+    std::partial_sort(items.begin(), items.begin() + count, items.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.last_access < b.last_access;
+                      });
+    items.resize(count);
     
-    return result;
+    return items;
 }
 
 std::vector<LRUCacheItem> LRUCacheManager::get_least_used_items(size_t count) const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    
-    std::vector<std::pair<std::string, LRUCacheItem>> items;
-    for (const auto& [key, item] : cache_items_) {
-        items.emplace_back(key, item);
-    }
+    std::vector<LRUCacheItem> items = snapshot_items();
     
-    std::sort(items.begin(), items.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second.access_count < b.second.access_count;
-              });
-    
-    std::vector<LRUCacheItem> result;
-    for (size_t i = 0; i < std::min(count, items.size()); ++i) {
-        result.push_back(items[i].second);
-    }
+    count = std::min(count, items.size());
+    std::partial_sort(items.begin(), items.begin() + count, items.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.access_count < b.access_count;
+                      });
+    items.resize(count);
     
-    return result;
+    return items;
 }
 
 bool LRUCacheManager::save_cache_index(const std::string& filename) const {
@@ -425,34 +530,79 @@ bool LRUCacheManager::save_cache_index(const std::string& filename) const {
         std::string index_file = filename.empty() ? 
             cache_directory_ + "/lru_cache_index.json" : filename;
         
+        // 计数取自各分片；可能在维护操作内调用，不取 maintenance_mutex_
+        size_t hit_count = 0;
+        size_t miss_count = 0;
+        for (const auto& shard : shards_) {
+            hit_count += shard->hits.load(std::memory_order_relaxed);
+            miss_count += shard->misses.load(std::memory_order_relaxed);
+        }
+        
         json j;
         j["statistics"] = {
-            {"total_items", statistics_.total_items},
-            {"total_size_bytes", statistics_.total_size_bytes},
-            {"hit_count", statistics_.hit_count},
-            {"miss_count", statistics_.miss_count},
-            {"hit_rate", statistics_.hit_rate},
+            {"total_items", get_cache_items_count()},
+            {"total_size_bytes", get_cache_size()},
+            {"hit_count", hit_count},
+            {"miss_count", miss_count},
+            {"hit_rate", hit_count + miss_count > 0 ? static_cast<double>(hit_count) / (hit_count + miss_count) : 0.0},
             {"last_cleanup", std::chrono::system_clock::to_time_t(statistics_.last_cleanup)}
         };
         
-        j["items"] = json::array();
-        for (const auto& [key, item] : cache_items_) {
+        std::unordered_map<std::string, json> current;
+        for (const auto& item : snapshot_items()) {
             json item_json;
-            item_json["key"] = item.key;
-            item_json["package_name"] = item.package_name;
-            item_json["version"] = item.version;
+            item_json["key"] = item.key.str();
+            item_json["package_name"] = item.package_name.view();
+            item_json["version"] = item.version.view();
             item_json["cache_path"] = item.cache_path;
             item_json["size_bytes"] = item.size_bytes;
             item_json["last_access"] = std::chrono::system_clock::to_time_t(item.last_access);
             item_json["install_time"] = std::chrono::system_clock::to_time_t(item.install_time);
             item_json["access_count"] = item.access_count;
             item_json["is_pinned"] = item.is_pinned;
-            j["items"].push_back(item_json);
+            current.emplace(item.key.str(), std::move(item_json));
+        }
+        
+        // 与上次同步时相比新增、修改和删除的缓存项
+        std::unordered_map<std::string, json> changed;
+        std::unordered_set<std::string> removed;
+        for (const auto& [key, item_json] : current) {
+            auto base = index_base_.find(key);
+            if (base == index_base_.end() || base->second != item_json.dump()) {
+                changed.emplace(key, item_json);
+            }
+        }
+        for (const auto& [key, dumped] : index_base_) {
+            if (!current.count(key)) {
+                removed.insert(key);
+            }
         }
         
-        std::ofstream file(index_file);
-        file << j.dump(2);
+        SharedIndexFile index(index_file);
+        bool committed = index.commit([&](json& data) {
+            json items = json::array();
+            if (data.contains("items")) {
+                for (auto& item_json : data["items"]) {
+                    std::string key = item_json.value("key", "");
+                    if (!changed.count(key) && !removed.count(key)) {
+                        items.push_back(std::move(item_json));
+                    }
+                }
+            }
+            for (const auto& [key, item_json] : changed) {
+                items.push_back(item_json);
+            }
+            data = j;
+            data["items"] = std::move(items);
+        });
+        if (!committed) {
+            return false;
+        }
         
+        index_base_.clear();
+        for (const auto& [key, item_json] : current) {
+            index_base_.emplace(key, item_json.dump());
+        }
         return true;
         
     } catch (const std::exception& e) {
@@ -466,27 +616,27 @@ bool LRUCacheManager::load_cache_index(const std::string& filename) {
         std::string index_file = filename.empty() ? 
             cache_directory_ + "/lru_cache_index.json" : filename;
         
-        if (!fs::exists(index_file)) {
-            return true; // 文件不存在，创建新的
-        }
-        
-        std::ifstream file(index_file);
+        // 文件不存在时读到空索引
         json j;
-        file >> j;
+        uint64_t generation = 0;
+        if (!SharedIndexFile(index_file).read(j, generation)) {
+            return false;
+        }
         
         // 清空现有数据
-        cache_items_.clear();
-        lru_list_.clear();
-        lru_map_.clear();
+        for (auto& shard : shards_) {
+            std::unique_lock<std::shared_mutex> lock(shard->mutex);
+            shard->clear();
+            shard->hits = 0;
+            shard->misses = 0;
+        }
+        index_base_.clear();
         
-        // 加载统计信息
+        // 加载统计信息；历史命中计数记在第一个分片上
         if (j.contains("statistics")) {
             const auto& stats = j["statistics"];
-            statistics_.total_items = stats["total_items"];
-            statistics_.total_size_bytes = stats["total_size_bytes"];
-            statistics_.hit_count = stats["hit_count"];
-            statistics_.miss_count = stats["miss_count"];
-            statistics_.hit_rate = stats["hit_rate"];
+            shards_[0]->hits = stats["hit_count"].get<size_t>();
+            shards_[0]->misses = stats["miss_count"].get<size_t>();
             statistics_.last_cleanup = std::chrono::system_clock::from_time_t(stats["last_cleanup"]);
         }
         
@@ -494,28 +644,29 @@ bool LRUCacheManager::load_cache_index(const std::string& filename) {
         if (j.contains("items")) {
             for (const auto& item_json : j["items"]) {
                 LRUCacheItem item;
-                item.key = item_json["key"];
-                item.package_name = item_json["package_name"];
-                item.version = item_json["version"];
-                item.cache_path = item_json["cache_path"];
+                item.package_name = Symbol(item_json["package_name"].get<std::string>());
+                item.version = Symbol(item_json["version"].get<std::string>());
+                item.key = LRUCacheKey{item.package_name, item.version};
+                item.cache_path = item_json["cache_path"].get<std::string>();
                 item.size_bytes = item_json["size_bytes"];
                 item.last_access = std::chrono::system_clock::from_time_t(item_json["last_access"]);
                 item.install_time = std::chrono::system_clock::from_time_t(item_json["install_time"]);
                 item.access_count = item_json["access_count"];
                 item.is_pinned = item_json["is_pinned"];
+                index_base_[item_json["key"].get<std::string>()] = item_json.dump();
                 
                 // 验证文件是否存在
                 if (fs::exists(item.cache_path)) {
-                    cache_items_[item.key] = item;
-                    lru_list_.push_front(item.key);
-                    lru_map_[item.key] = lru_list_.begin();
+                    Shard& shard = shard_for(item.key);
+                    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                    shard.insert(item);
                 } else {
                     LOG(WARNING) << "Cache file not found: " << item.cache_path;
                 }
             }
         }
         
-        LOG(INFO) << "Loaded cache index with " << cache_items_.size() << " items";
+        LOG(INFO) << "Loaded cache index with " << get_cache_items_count() << " items";
         return true;
         
     } catch (const std::exception& e) {
@@ -525,15 +676,21 @@ bool LRUCacheManager::load_cache_index(const std::string& filename) {
 }
 
 void LRUCacheManager::optimize_cache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
     
     LOG(INFO) << "Optimizing cache...";
     
-    // 重新计算大小
-    statistics_.total_size_bytes = 0;
-    for (auto& [key, item] : cache_items_) {
-        item.size_bytes = calculate_item_size(item.cache_path);
-        statistics_.total_size_bytes += item.size_bytes;
+    // 重新计算大小；遍历目录时不持有分片锁
+    for (const auto& item : snapshot_items()) {
+        size_t size = calculate_item_size(item.cache_path);
+        Shard& shard = shard_for(item.key);
+        std::unique_lock<std::shared_mutex> shard_lock(shard.mutex);
+        auto it = shard.entries.find(item.key);
+        if (it != shard.entries.end()) {
+            shard.size_bytes.fetch_sub(it->second.item.size_bytes, std::memory_order_relaxed);
+            shard.size_bytes.fetch_add(size, std::memory_order_relaxed);
+            it->second.item.size_bytes = size;
+        }
     }
     
     // 更新统计
@@ -543,7 +700,7 @@ void LRUCacheManager::optimize_cache() {
 }
 
 void LRUCacheManager::defragment_cache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
     
     LOG(INFO) << "Starting cache defragmentation...";
     
@@ -608,12 +765,12 @@ bool LRUCacheManager::validate_cache_integrity() const {
         size_t valid_items = 0;
         size_t invalid_items = 0;
         
-        for (const auto& [key, item] : cache_items_) {
+        for (const auto& item : snapshot_items()) {
             if (fs::exists(item.cache_path)) {
                 valid_items++;
             } else {
                 invalid_items++;
-                LOG(WARNING) << "Invalid cache item: " << key << " (path: " << item.cache_path << ")";
+                LOG(WARNING) << "Invalid cache item: " << item.key << " (path: " << item.cache_path << ")";
             }
         }
         
@@ -627,38 +784,64 @@ bool LRUCacheManager::validate_cache_integrity() const {
 }
 
 // 私有方法实现
-void LRUCacheManager::update_lru(const std::string& key) const {
-    auto it = lru_map_.find(key);
-    if (it != lru_map_.end()) {
-        lru_list_.erase(it->second);
-        lru_list_.push_front(key);
-        lru_map_[key] = lru_list_.begin();
-    }
+LRUCacheManager::Shard& LRUCacheManager::shard_for(const LRUCacheKey& key) const {
+    // 驻留 ID 是连续分配的，乘法散列后取高位，让相邻的键落在不同分片
+    uint64_t mixed = static_cast<uint64_t>(LRUCacheKeyHash{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return *shards_[(mixed >> 32) & shard_mask_];
 }
 
-void LRUCacheManager::evict_item(const std::string& key) {
-    auto it = cache_items_.find(key);
-    if (it == cache_items_.end()) {
-        return;
+std::vector<LRUCacheItem> LRUCacheManager::snapshot_items() const {
+    std::vector<LRUCacheItem> items;
+    items.reserve(get_cache_items_count());
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const auto& [key, entry] : shard->entries) {
+            items.push_back(Shard::snapshot(entry));
+        }
     }
-    
-    const LRUCacheItem& item = it->second;
-    
-    // 从LRU列表中移除
-    auto lru_it = lru_map_.find(key);
-    if (lru_it != lru_map_.end()) {
-        lru_list_.erase(lru_it->second);
-        lru_map_.erase(lru_it);
+    return items;
+}
+
+bool LRUCacheManager::evict_item(const LRUCacheKey& key) {
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return false;
     }
     
-    // 从缓存中移除
-    cache_items_.erase(it);
-    
-    // 更新统计
-    statistics_.total_items--;
-    statistics_.total_size_bytes -= item.size_bytes;
+    shard.erase(it);
     
     LOG(INFO) << "Evicted cache item: " << key;
+    return true;
+}
+
+bool LRUCacheManager::evict_clock_victim(Shard& shard) {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    
+    // 最多转两圈：第一圈清掉访问位，第二圈一定能遇到未被访问的项（固定项除外）
+    size_t limit = 2 * shard.clock.size();
+    for (size_t step = 0; step < limit && !shard.clock.empty(); ++step) {
+        if (shard.hand >= shard.clock.size()) {
+            shard.hand = 0;
+        }
+        auto it = shard.entries.find(shard.clock[shard.hand]);
+        Shard::Entry& entry = it->second;
+        if (entry.item.is_pinned || entry.referenced.exchange(false, std::memory_order_relaxed)) {
+            shard.hand++;
+            continue;
+        }
+        
+        LRUCacheKey key = it->first;
+        shard.erase(it);
+        LOG(INFO) << "Evicted cache item: " << key;
+        return true;
+    }
+    return false;
+}
+
+bool LRUCacheManager::over_capacity() const {
+    return get_cache_size() > max_cache_size_ || get_cache_items_count() > max_cache_items_;
 }
 
 bool LRUCacheManager::should_evict(const LRUCacheItem& item) const {
@@ -693,110 +876,74 @@ size_t LRUCacheManager::calculate_item_size(const std::string& cache_path) const
     }
 }
 
-void LRUCacheManager::update_statistics(const std::string& key, bool hit) const {
-    if (hit) {
-        statistics_.hit_count++;
-    } else {
-        statistics_.miss_count++;
-    }
-    
-    size_t total_requests = statistics_.hit_count + statistics_.miss_count;
-    if (total_requests > 0) {
-        statistics_.hit_rate = static_cast<double>(statistics_.hit_count) / total_requests;
-    }
-}
-
 void LRUCacheManager::evict_by_lru() {
-    while (!lru_list_.empty() && 
-           (statistics_.total_size_bytes > max_cache_size_ || 
-            cache_items_.size() > max_cache_items_)) {
-        
-        std::string key = lru_list_.back();
-        auto it = cache_items_.find(key);
-        
-        if (it != cache_items_.end() && !it->second.is_pinned) {
-            evict_item(key);
-        } else {
-            lru_list_.pop_back();
-        }
+    // 各分片轮流用时钟算法交出一个牺牲者，近似全局 LRU；连续一圈都没有可淘汰的项时停止
+    size_t idle_shards = 0;
+    while (over_capacity() && idle_shards < shards_.size()) {
+        Shard& shard = *shards_[eviction_cursor_++ & shard_mask_];
+        idle_shards = evict_clock_victim(shard) ? 0 : idle_shards + 1;
     }
 }
 
 void LRUCacheManager::evict_by_lfu() {
-    std::vector<std::pair<std::string, LRUCacheItem*>> items;
-    for (auto& [key, item] : cache_items_) {
-        if (!item.is_pinned) {
-            items.emplace_back(key, &item);
-        }
-    }
+    std::vector<LRUCacheItem> items = snapshot_items();
+    items.erase(std::remove_if(items.begin(), items.end(),
+                               [](const LRUCacheItem& item) { return item.is_pinned; }),
+                items.end());
     
     std::sort(items.begin(), items.end(),
               [](const auto& a, const auto& b) {
-                  return a.second->access_count < b.second->access_count;
+                  return a.access_count < b.access_count;
               });
     
-    for (const auto& [key, item] : items) {
-        if (statistics_.total_size_bytes <= max_cache_size_ && 
-            cache_items_.size() <= max_cache_items_) {
+    for (const auto& item : items) {
+        if (!over_capacity()) {
             break;
         }
-        evict_item(key);
+        evict_item(item.key);
     }
 }
 
 void LRUCacheManager::evict_by_size() {
-    std::vector<std::pair<std::string, LRUCacheItem*>> items;
-    for (auto& [key, item] : cache_items_) {
-        if (!item.is_pinned) {
-            items.emplace_back(key, &item);
-        }
-    }
+    std::vector<LRUCacheItem> items = snapshot_items();
+    items.erase(std::remove_if(items.begin(), items.end(),
+                               [](const LRUCacheItem& item) { return item.is_pinned; }),
+                items.end());
     
     std::sort(items.begin(), items.end(),
               [](const auto& a, const auto& b) {
-                  return a.second->size_bytes > b.second->size_bytes;
+                  return a.size_bytes > b.size_bytes;
               });
     
-    for (const auto& [key, item] : items) {
-        if (statistics_.total_size_bytes <= max_cache_size_ && 
-            cache_items_.size() <= max_cache_items_) {
+    for (const auto& item : items) {
+        if (!over_capacity()) {
             break;
         }
-        evict_item(key);
+        evict_item(item.key);
     }
 }
 
 void LRUCacheManager::evict_by_time() {
     auto cutoff_time = std::chrono::system_clock::now() - max_age_;
-    std::vector<std::string> keys_to_remove;
     
-    for (const auto& [key, item] : cache_items_) {
+    for (const auto& item : snapshot_items()) {
         if (!item.is_pinned && item.last_access < cutoff_time) {
-            keys_to_remove.push_back(key);
+            evict_item(item.key);
         }
     }
-    
-    for (const auto& key : keys_to_remove) {
-        evict_item(key);
-    }
 }
 
 void LRUCacheManager::evict_by_hybrid() {
     // 混合策略：结合LRU、LFU和大小
-    std::vector<std::pair<std::string, LRUCacheItem*>> items;
-    for (auto& [key, item] : cache_items_) {
-        if (!item.is_pinned) {
-            items.emplace_back(key, &item);
-        }
-    }
+    std::vector<LRUCacheItem> items = snapshot_items();
+    items.erase(std::remove_if(items.begin(), items.end(),
+                               [](const LRUCacheItem& item) { return item.is_pinned; }),
+                items.end());
     
     // 计算综合分数（访问频率、大小、时间）
     auto now = std::chrono::system_clock::now();
     std::sort(items.begin(), items.end(),
-              [now](const auto& a, const auto& b) {
-                  const auto& item_a = *a.second;
-                  const auto& item_b = *b.second;
-                  
+              [now](const LRUCacheItem& item_a, const LRUCacheItem& item_b) {
                   // 计算时间分数（越新越好）
                   auto age_a = now - item_a.last_access;
                   auto age_b = now - item_b.last_access;
@@ -818,12 +965,11 @@ void LRUCacheManager::evict_by_hybrid() {
                   return score_a < score_b;
               });
     
-    for (const auto& [key, item] : items) {
-        if (statistics_.total_size_bytes <= max_cache_size_ && 
-            cache_items_.size() <= max_cache_items_) {
+    for (const auto& item : items) {
+        if (!over_capacity()) {
             break;
         }
-        evict_item(key);
+        evict_item(item.key);
     }
 }
 
@@ -871,16 +1017,10 @@ void LRUCacheManager::perform_eviction() {
 }
 
 void LRUCacheManager::update_cache_statistics() {
-    // 更新包大小统计
-    statistics_.package_sizes.clear();
-    for (const auto& [key, item] : cache_items_) {
-        statistics_.package_sizes[item.package_name] += item.size_bytes;
-    }
-    
-    // 更新访问统计
+    // 包大小在 get_statistics 中按分片汇总，这里只更新访问统计
     statistics_.access_counts.clear();
-    for (const auto& [key, item] : cache_items_) {
-        statistics_.access_counts[item.package_name] += item.access_count;
+    for (const auto& item : snapshot_items()) {
+        statistics_.access_counts[item.package_name.str()] += item.access_count;
     }
 }
 
@@ -888,6 +1028,17 @@ std::string LRUCacheManager::generate_cache_key(const std::string& package_name,
     return package_name + ":" + version;
 }
 
+std::optional<LRUCacheKey> LRUCacheManager::find_cache_key(const std::string& package_name,
+                                                           const std::string& version) const {
+    auto& interner = StringInterner::instance();
+    auto name = interner.find(package_name);
+    auto ver = name ? interner.find(version) : std::nullopt;
+    if (!ver) {
+        return std::nullopt;
+    }
+    return LRUCacheKey{*name, *ver};
+}
+
 // SmartCacheCleaner 实现
 SmartCacheCleaner::SmartCacheCleaner(LRUCacheManager* cache_manager) 
     : cache_manager_(cache_manager) {
@@ -1036,7 +1187,7 @@ std::vector<std::string> SmartCacheCleaner::select_items_for_cleanup(CleanupReco
             {
                 auto oldest = cache_manager_->get_oldest_items(stats.total_items / 10);
                 for (const auto& item : oldest) {
-                    items.push_back(item.key);
+                    items.push_back(item.key.str());
                 }
             }
             break;
@@ -1046,7 +1197,7 @@ std::vector<std::string> SmartCacheCleaner::select_items_for_cleanup(CleanupReco
             {
                 auto oldest = cache_manager_->get_oldest_items(stats.total_items / 4);
                 for (const auto& item : oldest) {
-                    items.push_back(item.key);
+                    items.push_back(item.key.str());
                 }
             }
             break;
@@ -1056,7 +1207,7 @@ std::vector<std::string> SmartCacheCleaner::select_items_for_cleanup(CleanupReco
             {
                 auto oldest = cache_manager_->get_oldest_items(stats.total_items / 2);
                 for (const auto& item : oldest) {
-                    items.push_back(item.key);
+                    items.push_back(item.key.str());
                 }
             }
             break;
@@ -1112,10 +1263,11 @@ void AdaptiveCacheStrategy::record_access(const std::string& package_name, size_
     std::lock_guard<std::mutex> lock(patterns_mutex_);
     
     auto now = std::chrono::steady_clock::now();
-    auto& pattern = access_patterns_[package_name];
+    Symbol name(package_name);
+    auto& pattern = access_patterns_[name];
     
     if (pattern.access_count == 0) {
-        pattern.package_name = package_name;
+        pattern.package_name = name;
         pattern.first_access = now;
     }
     
@@ -1160,7 +1312,8 @@ void AdaptiveCacheStrategy::analyze_patterns() {
 double AdaptiveCacheStrategy::calculate_priority(const std::string& package_name) const {
     std::lock_guard<std::mutex> lock(patterns_mutex_);
     
-    auto it = access_patterns_.find(package_name);
+    auto name = StringInterner::instance().find(package_name);
+    auto it = name ? access_patterns_.find(*name) : access_patterns_.end();
     if (it != access_patterns_.end()) {
         return it->second.priority_score;
     }
@@ -1170,7 +1323,8 @@ double AdaptiveCacheStrategy::calculate_priority(const std::string& package_name
 bool AdaptiveCacheStrategy::should_evict(const std::string& package_name) const {
     std::lock_guard<std::mutex> lock(patterns_mutex_);
     
-    auto it = access_patterns_.find(package_name);
+    auto name = StringInterner::instance().find(package_name);
+    auto it = name ? access_patterns_.find(*name) : access_patterns_.end();
     if (it != access_patterns_.end()) {
         return it->second.priority_score < cold_threshold_;
     }
@@ -1180,7 +1334,7 @@ bool AdaptiveCacheStrategy::should_evict(const std::string& package_name) const
 std::vector<std::string> AdaptiveCacheStrategy::get_eviction_candidates() const {
     std::lock_guard<std::mutex> lock(patterns_mutex_);
     
-    std::vector<std::pair<std::string, double>> candidates;
+    std::vector<std::pair<Symbol, double>> candidates;
     for (const auto& [name, pattern] : access_patterns_) {
         if (pattern.priority_score < cold_threshold_) {
             candidates.emplace_back(name, pattern.priority_score);
@@ -1193,7 +1347,7 @@ std::vector<std::string> AdaptiveCacheStrategy::get_eviction_candidates() const
     
     std::vector<std::string> result;
     for (const auto& [name, score] : candidates) {
-        result.push_back(name);
+        result.push_back(name.str());
     }
     return result;
 }
@@ -1263,7 +1417,7 @@ FragmentationInfo LRUCacheManager::analyze_cache_fragmentation() const {
         size_t fragmented_size = 0;
         
         // 分析每个缓存项
-        for (const auto& [key, item] : cache_items_) {
+        for (const auto& item : snapshot_items()) {
             if (!fs::exists(item.cache_path)) continue;
             
             total_files++;
@@ -1307,7 +1461,7 @@ std::vector<LRUCacheItem> LRUCacheManager::get_sorted_cache_items_for_defragment
     std::vector<LRUCacheItem> items;
     
     // 收集所有缓存项
-    for (const auto& [key, item] : cache_items_) {
+    for (const auto& item : snapshot_items()) {
         if (fs::exists(item.cache_path)) {
             items.push_back(item);
         }
@@ -1328,10 +1482,10 @@ std::vector<LRUCacheItem> LRUCacheManager::get_sorted_cache_items_for_defragment
 bool LRUCacheManager::consolidate_cache_item(const LRUCacheItem& item, const std::string& temp_dir) {
     try {
         // 创建新的优化路径
-        std::string new_path = temp_dir + "/" + item.package_name + "_" + item.version + ".cache";
+        std::string new_path = temp_dir + "/" + item.package_name.str() + "_" + item.version.str() + ".cache";
         
         // 复制文件到新位置
-        if (fs::copy_file(item.cache_path, new_path)) {
+        if (FileMaterializer::copy_file(item.cache_path, new_path)) {
             // 验证文件完整性
             if (fs::file_size(new_path) == item.size_bytes) {
                 // 更新缓存项路径
@@ -1353,23 +1507,17 @@ bool LRUCacheManager::consolidate_cache_item(const LRUCacheItem& item, const std
 
 void LRUCacheManager::update_cache_index_after_defragmentation() {
     try {
-        // 重新构建LRU列表
-        lru_list_.clear();
-        lru_map_.clear();
-        
-        // 按访问时间重新排序
-        std::vector<std::pair<std::string, std::chrono::system_clock::time_point>> access_times;
-        for (const auto& [key, item] : cache_items_) {
-            access_times.emplace_back(key, item.last_access);
-        }
-        
-        std::sort(access_times.begin(), access_times.end(),
-                  [](const auto& a, const auto& b) { return a.second > b.second; });
-        
-        // 重建LRU结构
-        for (const auto& [key, time] : access_times) {
-            lru_list_.push_back(key);
-            lru_map_[key] = --lru_list_.end();
+        // 按访问时间重排各分片的时钟环：最久未访问的项排在指针前面，最先被检查
+        for (auto& shard : shards_) {
+            std::unique_lock<std::shared_mutex> lock(shard->mutex);
+            std::sort(shard->clock.begin(), shard->clock.end(), [&shard](const LRUCacheKey& a, const LRUCacheKey& b) {
+                return shard->entries.at(a).last_access.load(std::memory_order_relaxed) <
+                       shard->entries.at(b).last_access.load(std::memory_order_relaxed);
+            });
+            for (size_t slot = 0; slot < shard->clock.size(); ++slot) {
+                shard->entries.at(shard->clock[slot]).clock_slot = slot;
+            }
+            shard->hand = 0;
         }
         
         // 保存更新后的索引
@@ -0,0 +1,459 @@
+#include "Paker/cache/materializer.h"
+#include "Paker/core/utils.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <vector>
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/vfs.h>
+#endif
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 文件系统 magic（linux/magic.h 中的值）
+constexpr long kBtrfsMagic = 0x9123683E;
+constexpr long kXfsMagic = 0x58465342;
+constexpr long kBcachefsMagic = 0xca451a4e;
+
+// 一次物化过程中各机制是否仍然可用；失败一次即关闭，后续文件直接跳过
+struct Capabilities {
+    bool reflink = true;
+    bool hardlink = true;
+    bool copy_file_range = true;
+    bool sendfile = true;
+};
+
+enum class CopyOutcome { REFLINK, KERNEL, USER, UNSUPPORTED, FAILED };
+
+bool is_unsupported(int error) {
+    return error == EOPNOTSUPP || error == ENOTTY || error == EXDEV || error == EINVAL || error == ENOSYS ||
+           error == EPERM || error == EBADF;
+}
+
+CopyOutcome user_copy(int in, int out) {
+    std::vector<char> buffer(128 * 1024);
+    for (;;) {
+        ssize_t n = ::read(in, buffer.data(), buffer.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CopyOutcome::FAILED;
+        }
+        if (n == 0) {
+            return CopyOutcome::USER;
+        }
+        for (ssize_t written = 0; written < n;) {
+            ssize_t w = ::write(out, buffer.data() + written, static_cast<size_t>(n - written));
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return CopyOutcome::FAILED;
+            }
+            written += w;
+        }
+    }
+}
+
+// 内核内复制：copy_file_range 失败（跨文件系统、旧内核）时退回 sendfile。
+// 不足 size 字节就返回 0 时（文件被截断，或文件系统静默不支持），从当前位置起改用 read/write 复制剩余部分
+CopyOutcome kernel_copy(int in, int out, size_t size, Capabilities& caps) {
+#ifdef __linux__
+    if (caps.copy_file_range) {
+        size_t copied = 0;
+        while (copied < size) {
+            ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, size - copied, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (copied == 0 && is_unsupported(errno)) {
+                    caps.copy_file_range = false;
+                    break;
+                }
+                return CopyOutcome::FAILED;
+            }
+            if (n == 0) {
+                if (copied == 0) {
+                    caps.copy_file_range = false;
+                }
+                return user_copy(in, out);
+            }
+            copied += static_cast<size_t>(n);
+        }
+        if (caps.copy_file_range) {
+            return CopyOutcome::KERNEL;
+        }
+    }
+
+    if (caps.sendfile) {
+        off_t offset = 0;
+        while (static_cast<size_t>(offset) < size) {
+            ssize_t n = ::sendfile(out, in, &offset, size - static_cast<size_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (offset == 0 && is_unsupported(errno)) {
+                    caps.sendfile = false;
+                    break;
+                }
+                return CopyOutcome::FAILED;
+            }
+            if (n == 0) {
+                // sendfile 不移动输入文件的读位置，先对齐再接着复制
+                if (::lseek(in, offset, SEEK_SET) < 0) {
+                    return CopyOutcome::FAILED;
+                }
+                return user_copy(in, out);
+            }
+        }
+        if (caps.sendfile) {
+            return CopyOutcome::KERNEL;
+        }
+    }
+#else
+    (void)in;
+    (void)out;
+    (void)size;
+    (void)caps;
+#endif
+    return CopyOutcome::UNSUPPORTED;
+}
+
+// 以 reflink 或复制生成 dest；allow_copy 为 false 时只尝试 reflink，失败不留下目标文件
+bool clone_or_copy(const std::string& source, const std::string& dest, const struct stat& st, bool allow_reflink,
+                   bool allow_copy, Capabilities& caps, MaterializeResult& result) {
+    int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+    int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    CopyOutcome outcome = CopyOutcome::UNSUPPORTED;
+#ifdef __linux__
+    if (allow_reflink && caps.reflink) {
+        if (::ioctl(out, FICLONE, in) == 0) {
+            outcome = CopyOutcome::REFLINK;
+        } else if (is_unsupported(errno)) {
+            caps.reflink = false;
+        }
+    }
+#else
+    (void)allow_reflink;
+#endif
+    if (outcome == CopyOutcome::UNSUPPORTED && allow_copy) {
+        size_t size = static_cast<size_t>(st.st_size);
+        outcome = kernel_copy(in, out, size, caps);
+        if (outcome == CopyOutcome::UNSUPPORTED) {
+            outcome = user_copy(in, out);
+        }
+    }
+
+    bool ok = outcome == CopyOutcome::REFLINK || outcome == CopyOutcome::KERNEL || outcome == CopyOutcome::USER;
+    if (ok) {
+        ::fchmod(out, st.st_mode & 07777);
+    }
+    ok = (::close(out) == 0) && ok;
+    ::close(in);
+    if (!ok) {
+        ::unlink(dest.c_str());
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (outcome == CopyOutcome::REFLINK) {
+        result.reflinked++;
+    } else if (outcome == CopyOutcome::KERNEL) {
+        result.kernel_copied++;
+        result.bytes_copied += size;
+    } else {
+        result.user_copied++;
+        result.bytes_copied += size;
+    }
+    return true;
+}
+
+// 硬链接到缓存文件。protect_source 时先去掉缓存文件的写权限，工程内的原地写入会失败，
+// 编辑器的“写新文件再改名”则自然断开链接；否则不改动源文件
+bool hardlink_file(const std::string& source, const std::string& dest, const struct stat& st, bool protect_source,
+                   Capabilities& caps) {
+    if (protect_source && (st.st_mode & 0222)) {
+        ::chmod(source.c_str(), st.st_mode & 07555);
+    }
+    if (::link(source.c_str(), dest.c_str()) == 0) {
+        return true;
+    }
+    if (errno == EXDEV || errno == EPERM || errno == ENOTSUP) {
+        caps.hardlink = false;
+    }
+    return false;
+}
+
+bool materialize_file(MaterializePolicy policy, const std::string& source, const std::string& dest,
+                      const struct stat& st, bool protect_source, Capabilities& caps, MaterializeResult& result) {
+    result.files++;
+    result.bytes_total += static_cast<size_t>(st.st_size);
+
+    switch (policy) {
+        case MaterializePolicy::AUTO:
+            if (caps.reflink && clone_or_copy(source, dest, st, true, false, caps, result)) {
+                return true;
+            }
+            if (caps.hardlink && hardlink_file(source, dest, st, protect_source, caps)) {
+                result.hardlinked++;
+                return true;
+            }
+            return clone_or_copy(source, dest, st, false, true, caps, result);
+        case MaterializePolicy::HARDLINK:
+            if (caps.hardlink && hardlink_file(source, dest, st, protect_source, caps)) {
+                result.hardlinked++;
+                return true;
+            }
+            return clone_or_copy(source, dest, st, true, true, caps, result);
+        case MaterializePolicy::REFLINK:
+            return clone_or_copy(source, dest, st, true, true, caps, result);
+        default:
+            return clone_or_copy(source, dest, st, false, true, caps, result);
+    }
+}
+
+std::string format_bytes(size_t bytes) {
+    std::ostringstream oss;
+    if (bytes < 1024 * 1024) {
+        oss << bytes / 1024 << " KB";
+    } else {
+        oss << bytes / (1024 * 1024) << " MB";
+    }
+    return oss.str();
+}
+
+} // namespace
+
+MaterializePolicy parse_materialize_policy(const std::string& name, MaterializePolicy fallback) {
+    if (name == "symlink") return MaterializePolicy::SYMLINK;
+    if (name == "hardlink") return MaterializePolicy::HARDLINK;
+    if (name == "reflink") return MaterializePolicy::REFLINK;
+    if (name == "copy") return MaterializePolicy::COPY;
+    if (name == "auto") return MaterializePolicy::AUTO;
+    return fallback;
+}
+
+const char* materialize_policy_name(MaterializePolicy policy) {
+    switch (policy) {
+        case MaterializePolicy::SYMLINK: return "symlink";
+        case MaterializePolicy::HARDLINK: return "hardlink";
+        case MaterializePolicy::REFLINK: return "reflink";
+        case MaterializePolicy::COPY: return "copy";
+        default: return "auto";
+    }
+}
+
+MaterializePolicy load_project_materialize_policy(const std::string& project_path) {
+    fs::path json_file = fs::path(project_path) / get_json_file();
+    try {
+        std::ifstream ifs(json_file);
+        if (!ifs) {
+            return MaterializePolicy::SYMLINK;
+        }
+        json j;
+        ifs >> j;
+        if (j.contains("materialize") && j["materialize"].is_string()) {
+            return parse_materialize_policy(j["materialize"].get<std::string>());
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read materialize policy from " << json_file << ": " << e.what();
+    }
+    return MaterializePolicy::SYMLINK;
+}
+
+bool save_project_materialize_policy(const std::string& project_path, MaterializePolicy policy) {
+    fs::path json_file = fs::path(project_path) / get_json_file();
+    try {
+        json j;
+        {
+            std::ifstream ifs(json_file);
+            if (!ifs) {
+                return false;
+            }
+            ifs >> j;
+        }
+        j["materialize"] = materialize_policy_name(policy);
+        std::ofstream ofs(json_file);
+        ofs << j.dump(4);
+        return static_cast<bool>(ofs);
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to save materialize policy to " << json_file << ": " << e.what();
+        return false;
+    }
+}
+
+std::string MaterializeResult::summary() const {
+    std::ostringstream oss;
+    oss << files << " files";
+    if (reflinked) oss << ", " << reflinked << " reflinked";
+    if (hardlinked) oss << ", " << hardlinked << " hardlinked";
+    if (kernel_copied) oss << ", " << kernel_copied << " copied in kernel";
+    if (user_copied) oss << ", " << user_copied << " copied in user space";
+    oss << "; " << format_bytes(bytes_avoided()) << " of " << format_bytes(bytes_total) << " not copied";
+    return oss.str();
+}
+
+FileMaterializer::FileMaterializer(MaterializePolicy policy) : policy_(policy) {}
+
+MaterializeResult FileMaterializer::materialize_tree(const std::string& source, const std::string& dest) {
+    MaterializeResult result;
+    std::error_code ec;
+    fs::path dest_path(dest);
+    fs::create_directories(dest_path.parent_path(), ec);
+
+    if (policy_ == MaterializePolicy::SYMLINK) {
+        for (const auto& entry : fs::recursive_directory_iterator(source, ec)) {
+            if (entry.is_regular_file(ec)) {
+                result.files++;
+                result.bytes_total += entry.file_size(ec);
+            }
+        }
+        fs::remove_all(dest_path, ec);
+        fs::create_symlink(source, dest_path, ec);
+        if (ec) {
+            LOG(ERROR) << "Failed to link " << dest << " -> " << source << ": " << ec.message();
+            return result;
+        }
+        result.success = true;
+        return result;
+    }
+
+    // 先在同级临时目录完成，失败时不破坏已有内容；目录名由 mkdtemp 生成，
+    // 同一进程的多个线程同时物化同一目标也不会共用临时目录
+    std::string staging_template = dest_path.string() + ".paker-tmp-XXXXXX";
+    if (!::mkdtemp(staging_template.data())) {
+        LOG(ERROR) << "Failed to create staging directory for " << dest << ": " << std::strerror(errno);
+        return result;
+    }
+    fs::path staging = staging_template;
+    std::string unique_suffix = staging_template.substr(staging_template.size() - 6);
+    std::error_code perms_ec;
+    fs::permissions(staging, fs::status(source, perms_ec).permissions(), perms_ec);
+
+    Capabilities caps;
+    bool ok = true;
+    fs::recursive_directory_iterator it(source, ec), end;
+    for (; ok && !ec && it != end; it.increment(ec)) {
+        fs::path target = staging / it->path().lexically_relative(source);
+        struct stat st;
+        if (::lstat(it->path().c_str(), &st) != 0) {
+            ok = false;
+        } else if (S_ISDIR(st.st_mode)) {
+            fs::create_directory(target, it->path(), ec);
+            ok = !ec;
+        } else if (S_ISLNK(st.st_mode)) {
+            fs::copy_symlink(it->path(), target, ec);
+            ok = !ec;
+        } else if (S_ISREG(st.st_mode)) {
+            if (file_hook_ && !file_hook_(static_cast<size_t>(st.st_size))) {
+                LOG(INFO) << "Materialization of " << source << " aborted";
+                fs::remove_all(staging, ec);
+                return result;
+            }
+            ok = materialize_file(policy_, it->path().string(), target.string(), st, protect_source_, caps, result);
+        }
+        if (!ok) {
+            LOG(ERROR) << "Failed to materialize " << it->path() << ": "
+                       << (ec ? ec.message() : std::string(std::strerror(errno)));
+        }
+    }
+    if (ec) {
+        LOG(ERROR) << "Failed to walk " << source << ": " << ec.message();
+        ok = false;
+    }
+    if (!ok) {
+        fs::remove_all(staging, ec);
+        return result;
+    }
+
+    // 替换旧内容：旧的链接或目录先移开，新目录改名到位后再删除旧的
+    fs::path old = dest_path;
+    old += ".paker-old-" + unique_suffix;
+    bool had_old = fs::symlink_status(dest_path, ec).type() != fs::file_type::not_found;
+    if (had_old) {
+        fs::rename(dest_path, old, ec);
+    }
+    fs::rename(staging, dest_path, ec);
+    if (ec) {
+        LOG(ERROR) << "Failed to move " << staging << " to " << dest << ": " << ec.message();
+        if (had_old) {
+            std::error_code restore_ec;
+            fs::rename(old, dest_path, restore_ec);
+        }
+        fs::remove_all(staging, ec);
+        return result;
+    }
+    if (had_old) {
+        fs::remove_all(old, ec);
+    }
+
+    result.success = true;
+    LOG(INFO) << "Materialized " << source << " -> " << dest << " (" << materialize_policy_name(policy_)
+              << "): " << result.summary();
+    return result;
+}
+
+bool FileMaterializer::copy_file(const std::string& source, const std::string& dest, MaterializeResult* result) {
+    struct stat st;
+    if (::stat(source.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    // 目标可能是指向缓存文件的硬链接，先删除再创建，避免截断写穿到缓存
+    struct stat existing;
+    if (::stat(dest.c_str(), &existing) == 0) {
+        if (existing.st_dev == st.st_dev && existing.st_ino == st.st_ino) {
+            return false;
+        }
+        ::unlink(dest.c_str());
+    }
+    Capabilities caps;
+    MaterializeResult local;
+    MaterializeResult& target = result ? *result : local;
+    target.files++;
+    target.bytes_total += static_cast<size_t>(st.st_size);
+    return clone_or_copy(source, dest, st, true, true, caps, target);
+}
+
+bool FileMaterializer::filesystem_supports_reflink(const std::string& path) {
+#ifdef __linux__
+    struct statfs info;
+    if (::statfs(path.c_str(), &info) != 0) {
+        return false;
+    }
+    long type = static_cast<long>(info.f_type);
+    return type == kBtrfsMagic || type == kXfsMagic || type == kBcachefsMagic;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+} // namespace Paker
@@ -0,0 +1,606 @@
+#include "Paker/cache/prefetch_model.h"
+#include "Paker/cache/cache_manager.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+const char kModelMagic[4] = {'P', 'K', 'P', 'F'};
+constexpr uint32_t kModelVersion = 1;
+
+const char kLegacyTraceName[] = "trace.log";
+
+// trace-000001.log -> 1；旧版的 trace.log 为第 0 段；其他文件返回 -1
+int64_t parse_trace_segment(const std::string& name) {
+    if (name == kLegacyTraceName) {
+        return 0;
+    }
+    const std::string prefix = "trace-";
+    if (name.compare(0, prefix.size(), prefix) != 0 || name.size() < prefix.size() + 5 ||
+        name.compare(name.size() - 4, 4, ".log") != 0) {
+        return -1;
+    }
+    try {
+        return static_cast<int64_t>(std::stoul(name.substr(prefix.size(), name.size() - prefix.size() - 4)));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+uint64_t trace_position(uint32_t segment, uint64_t offset) {
+    return (static_cast<uint64_t>(segment) << 32) | offset;
+}
+
+// 单个会话最多参与关联统计的包数，关联计数是会话内包数的平方
+constexpr size_t kMaxSessionPackages = 256;
+
+int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 记录格式以制表符和换行分隔字段
+std::string sanitize(const std::string& value) {
+    std::string result = value;
+    for (char& c : result) {
+        if (c == '\t' || c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return result;
+}
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void put_string(std::string& out, const std::string& value) {
+    put_varint(out, value.size());
+    out.append(value);
+}
+
+class Reader {
+public:
+    explicit Reader(const std::string& data) : data_(data), pos_(0), ok_(true) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= data_.size()) {
+                break;
+            }
+            uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    std::string string() {
+        uint64_t size = varint();
+        if (!ok_ || size > data_.size() - pos_) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string value = data_.substr(pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    const std::string& data_;
+    size_t pos_;
+    bool ok_;
+};
+
+} // namespace
+
+// ==================== PrefetchTrace ====================
+
+PrefetchTrace::PrefetchTrace(const std::string& dir, uint64_t segment_bytes, size_t max_segments)
+    : dir_(dir),
+      segment_bytes_(std::min<uint64_t>(std::max<uint64_t>(1, segment_bytes), 0xffffffffULL)),
+      max_segments_(std::max<size_t>(1, max_segments)) {}
+
+std::string PrefetchTrace::segment_path(uint32_t segment) const {
+    if (segment == 0) {
+        return dir_ + "/" + kLegacyTraceName;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "trace-%06u.log", segment);
+    return dir_ + "/" + name;
+}
+
+std::vector<uint32_t> PrefetchTrace::list_segments() const {
+    std::vector<uint32_t> numbers;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(dir_, ec)) {
+        int64_t number = parse_trace_segment(item.path().filename().string());
+        if (number >= 0) {
+            numbers.push_back(static_cast<uint32_t>(number));
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+std::string PrefetchTrace::trace_path() const {
+    auto numbers = list_segments();
+    return segment_path(numbers.empty() || numbers.back() == 0 ? 1 : numbers.back());
+}
+
+bool PrefetchTrace::append(const std::string& package, uint64_t bytes) {
+    PrefetchEvent event;
+    event.timestamp_ms = now_ms();
+    event.session = current_session();
+    event.package = package;
+    event.bytes = bytes;
+    return append(event);
+}
+
+bool PrefetchTrace::append(const PrefetchEvent& event) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    std::string line = std::to_string(event.timestamp_ms) + "\t" + sanitize(event.session) + "\t" +
+                       sanitize(event.package) + "\t" + std::to_string(event.bytes) + "\n";
+    auto numbers = list_segments();
+    uint32_t active = numbers.empty() || numbers.back() == 0 ? 1 : numbers.back();
+    // O_APPEND 下单次 write 整行写入，多个进程同时记录时行不会交错；
+    // 两个进程同时开新段时都会写入同一个新段
+    int fd = ::open(segment_path(active).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    struct stat st;
+    if (fd >= 0 && ::fstat(fd, &st) == 0 && st.st_size > 0 &&
+        static_cast<uint64_t>(st.st_size) + line.size() > segment_bytes_) {
+        ::close(fd);
+        ++active;
+        fd = ::open(segment_path(active).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        // 开新段时删除超出保留数量的旧段
+        for (uint32_t number : numbers) {
+            if (static_cast<uint64_t>(number) + max_segments_ <= active) {
+                fs::remove(segment_path(number), ec);
+            }
+        }
+    }
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::write(fd, line.data(), line.size()) == static_cast<ssize_t>(line.size());
+    ::close(fd);
+    return ok;
+}
+
+uint64_t PrefetchTrace::read(std::vector<PrefetchEvent>& events, uint64_t position) const {
+    uint32_t segment = static_cast<uint32_t>(position >> 32);
+    uint64_t offset = position & 0xffffffffULL;
+    auto numbers = list_segments();
+    // 位置在现存最新的段之后说明记录被整体清理过，从头读取
+    if (!numbers.empty() && numbers.back() < segment) {
+        segment = 0;
+        offset = 0;
+    }
+    for (uint32_t number : numbers) {
+        if (number < segment) {
+            continue;   // 已读过
+        }
+        uint64_t end = read_segment(number, number == segment ? offset : 0, events);
+        position = trace_position(number, end);
+    }
+    return position;
+}
+
+uint64_t PrefetchTrace::read_segment(uint32_t segment, uint64_t offset, std::vector<PrefetchEvent>& events) const {
+    std::ifstream file(segment_path(segment), std::ios::binary);
+    if (!file) {
+        return offset;
+    }
+    file.seekg(static_cast<std::streamoff>(offset));
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    while (true) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) {
+            break;  // 末尾不完整的行留到下次读取
+        }
+        std::string line = data.substr(pos, end - pos);
+        pos = end + 1;
+
+        std::istringstream fields(line);
+        std::string timestamp, bytes;
+        PrefetchEvent event;
+        if (!std::getline(fields, timestamp, '\t') || !std::getline(fields, event.session, '\t') ||
+            !std::getline(fields, event.package, '\t') || !std::getline(fields, bytes) || event.package.empty()) {
+            continue;
+        }
+        try {
+            event.timestamp_ms = std::stoll(timestamp);
+            event.bytes = std::stoull(bytes);
+        } catch (const std::exception&) {
+            continue;
+        }
+        events.push_back(std::move(event));
+    }
+    return offset + pos;
+}
+
+std::string PrefetchTrace::current_session() {
+    static const std::string session = [] {
+        const char* env = std::getenv("PAKER_PREFETCH_SESSION");
+        if (env && *env) {
+            return sanitize(env);
+        }
+        return std::to_string(::getpid()) + "-" + std::to_string(now_ms());
+    }();
+    return session;
+}
+
+std::vector<PrefetchSession> PrefetchTrace::group_sessions(const std::vector<PrefetchEvent>& events) {
+    std::vector<PrefetchSession> sessions;
+    std::unordered_map<std::string, size_t> index;
+    for (const auto& event : events) {
+        auto it = index.find(event.session);
+        if (it == index.end()) {
+            it = index.emplace(event.session, sessions.size()).first;
+            sessions.push_back(PrefetchSession{event.session, {}});
+        }
+        sessions[it->second].events.push_back(event);
+    }
+    return sessions;
+}
+
+// ==================== PrefetchModel ====================
+
+PrefetchModel::PrefetchModel(size_t max_edges)
+    : max_edges_(std::max<size_t>(1, max_edges)), last_package_(-1), trained_offset_(0) {}
+
+uint32_t PrefetchModel::intern(const std::string& package) {
+    auto it = ids_.find(package);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    nodes_.back().package = package;
+    ids_.emplace(package, id);
+    return id;
+}
+
+void PrefetchModel::prune(Node& node) const {
+    if (node.edges.size() <= max_edges_) {
+        return;
+    }
+    std::vector<std::pair<uint32_t, Edge>> edges(node.edges.begin(), node.edges.end());
+    std::nth_element(edges.begin(), edges.begin() + max_edges_, edges.end(),
+                     [](const std::pair<uint32_t, Edge>& a, const std::pair<uint32_t, Edge>& b) {
+                         uint64_t wa = static_cast<uint64_t>(a.second.next) + a.second.together;
+                         uint64_t wb = static_cast<uint64_t>(b.second.next) + b.second.together;
+                         return wa != wb ? wa > wb : a.first < b.first;
+                     });
+    edges.resize(max_edges_);
+    node.edges.clear();
+    node.edges.insert(edges.begin(), edges.end());
+}
+
+void PrefetchModel::finish_session() {
+    for (uint32_t a : session_packages_) {
+        Node& node = nodes_[a];
+        node.sessions++;
+        for (uint32_t b : session_packages_) {
+            if (a != b) {
+                node.edges[b].together++;
+            }
+        }
+        // 边数超过两倍上限时再裁剪，避免每个会话都排序
+        if (node.edges.size() > max_edges_ * 2) {
+            prune(node);
+        }
+    }
+    session_packages_.clear();
+}
+
+void PrefetchModel::observe(const PrefetchEvent& event) {
+    if (event.package.empty()) {
+        return;
+    }
+    if (event.session != current_session_) {
+        finish_session();
+        current_session_ = event.session;
+    }
+    uint32_t id = intern(event.package);
+    if (event.bytes > 0) {
+        nodes_[id].bytes = event.bytes;
+    }
+
+    if (last_package_ >= 0 && static_cast<uint32_t>(last_package_) != id) {
+        Node& from = nodes_[static_cast<size_t>(last_package_)];
+        from.requests++;
+        from.edges[id].next++;
+        if (from.edges.size() > max_edges_ * 2) {
+            prune(from);
+        }
+    }
+    last_package_ = id;
+
+    if (session_packages_.size() < kMaxSessionPackages &&
+        std::find(session_packages_.begin(), session_packages_.end(), id) == session_packages_.end()) {
+        session_packages_.push_back(id);
+    }
+}
+
+void PrefetchModel::observe_session(const PrefetchSession& session) {
+    for (const auto& event : session.events) {
+        observe(event);
+    }
+}
+
+void PrefetchModel::train(const std::vector<PrefetchEvent>& events) {
+    // 并发的会话在记录中交错，按会话归并后再学习，避免把一个会话拆成多段
+    for (const auto& session : PrefetchTrace::group_sessions(events)) {
+        observe_session(session);
+    }
+}
+
+std::vector<PrefetchCandidate> PrefetchModel::predict(const std::vector<std::string>& context,
+                                                      const PrefetchOptions& options) const {
+    std::unordered_map<uint32_t, PrefetchCandidate> candidates;
+    std::unordered_set<uint32_t> seen;
+    for (const auto& package : context) {
+        auto it = ids_.find(package);
+        if (it != ids_.end()) {
+            seen.insert(it->second);
+        }
+    }
+
+    int64_t from = last_package_;
+    if (!context.empty()) {
+        auto it = ids_.find(context.back());
+        from = it != ids_.end() ? static_cast<int64_t>(it->second) : -1;
+    }
+    if (from >= 0) {
+        const Node& node = nodes_[static_cast<size_t>(from)];
+        for (const auto& edge : node.edges) {
+            if (edge.second.next == 0 || node.requests == 0) {
+                continue;
+            }
+            candidates[edge.first].markov = static_cast<double>(edge.second.next) / node.requests;
+        }
+    }
+
+    for (uint32_t a : seen) {
+        const Node& node = nodes_[a];
+        if (node.sessions == 0) {
+            continue;
+        }
+        for (const auto& edge : node.edges) {
+            if (edge.second.together == 0) {
+                continue;
+            }
+            double confidence = std::min(1.0, static_cast<double>(edge.second.together) / node.sessions);
+            PrefetchCandidate& candidate = candidates[edge.first];
+            candidate.association = std::max(candidate.association, confidence);
+        }
+    }
+
+    std::vector<PrefetchCandidate> result;
+    for (auto& item : candidates) {
+        if (seen.count(item.first)) {
+            continue;   // 本会话已请求过
+        }
+        PrefetchCandidate& candidate = item.second;
+        candidate.package = nodes_[item.first].package;
+        candidate.expected_bytes = nodes_[item.first].bytes;
+        candidate.confidence = 1.0 - (1.0 - candidate.markov) * (1.0 - candidate.association);
+        if (candidate.confidence >= options.min_confidence) {
+            result.push_back(std::move(candidate));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const PrefetchCandidate& a, const PrefetchCandidate& b) {
+        return a.confidence != b.confidence ? a.confidence > b.confidence : a.package < b.package;
+    });
+    if (result.size() > options.max_candidates) {
+        result.resize(options.max_candidates);
+    }
+    return result;
+}
+
+bool PrefetchModel::save(const std::string& path) const {
+    std::string out(kModelMagic, sizeof(kModelMagic));
+    put_varint(out, kModelVersion);
+    put_varint(out, trained_offset_);
+    put_varint(out, static_cast<uint64_t>(last_package_ + 1));
+    put_varint(out, nodes_.size());
+    for (const auto& node : nodes_) {
+        put_string(out, node.package);
+        put_varint(out, node.requests);
+        put_varint(out, node.sessions);
+        put_varint(out, node.bytes);
+    }
+    for (const auto& node : nodes_) {
+        Node pruned = node;
+        prune(pruned);
+        std::vector<std::pair<uint32_t, Edge>> edges(pruned.edges.begin(), pruned.edges.end());
+        std::sort(edges.begin(), edges.end(),
+                  [](const std::pair<uint32_t, Edge>& a, const std::pair<uint32_t, Edge>& b) { return a.first < b.first; });
+        // 目标按差值编码，常见的小编号和小计数都只占一个字节
+        put_varint(out, edges.size());
+        uint32_t previous = 0;
+        for (const auto& edge : edges) {
+            put_varint(out, edge.first - previous);
+            put_varint(out, edge.second.next);
+            put_varint(out, edge.second.together);
+            previous = edge.first;
+        }
+    }
+    // 未结束的会话随模型保存，下次继续累计
+    put_string(out, current_session_);
+    put_varint(out, session_packages_.size());
+    for (uint32_t id : session_packages_) {
+        put_varint(out, id);
+    }
+
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+            return false;
+        }
+    }
+    fs::rename(temp, path, ec);
+    return !ec;
+}
+
+bool PrefetchModel::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(kModelMagic) || data.compare(0, sizeof(kModelMagic), kModelMagic, sizeof(kModelMagic)) != 0) {
+        LOG(WARNING) << "Invalid prefetch model: " << path;
+        return false;
+    }
+    std::string body = data.substr(sizeof(kModelMagic));
+    Reader reader(body);
+    if (reader.varint() != kModelVersion) {
+        LOG(WARNING) << "Unsupported prefetch model version: " << path;
+        return false;
+    }
+
+    PrefetchModel model(max_edges_);
+    model.trained_offset_ = reader.varint();
+    model.last_package_ = static_cast<int64_t>(reader.varint()) - 1;
+    uint64_t count = reader.varint();
+    if (!reader.ok() || count > body.size()) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+        uint32_t id = model.intern(reader.string());
+        Node& node = model.nodes_[id];
+        node.requests = static_cast<uint32_t>(reader.varint());
+        node.sessions = static_cast<uint32_t>(reader.varint());
+        node.bytes = reader.varint();
+    }
+    for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+        uint64_t edges = reader.varint();
+        uint64_t target = 0;
+        for (uint64_t j = 0; j < edges && reader.ok(); ++j) {
+            target += reader.varint();
+            Edge edge;
+            edge.next = static_cast<uint32_t>(reader.varint());
+            edge.together = static_cast<uint32_t>(reader.varint());
+            if (target < count) {
+                model.nodes_[i].edges[static_cast<uint32_t>(target)] = edge;
+            }
+        }
+    }
+    model.current_session_ = reader.string();
+    uint64_t pending = reader.varint();
+    for (uint64_t i = 0; i < pending && reader.ok(); ++i) {
+        uint64_t id = reader.varint();
+        if (id < count) {
+            model.session_packages_.push_back(static_cast<uint32_t>(id));
+        }
+    }
+    if (!reader.ok() || model.nodes_.size() != count || model.last_package_ >= static_cast<int64_t>(count)) {
+        LOG(WARNING) << "Truncated prefetch model: " << path;
+        return false;
+    }
+    *this = std::move(model);
+    return true;
+}
+
+size_t PrefetchModel::update_from_trace(const PrefetchTrace& trace) {
+    std::vector<PrefetchEvent> events;
+    trained_offset_ = trace.read(events, trained_offset_);
+    train(events);
+    return events.size();
+}
+
+size_t PrefetchModel::package_count() const {
+    return nodes_.size();
+}
+
+size_t PrefetchModel::edge_count() const {
+    size_t count = 0;
+    for (const auto& node : nodes_) {
+        count += node.edges.size();
+    }
+    return count;
+}
+
+PrefetchReplayResult PrefetchModel::replay(const std::vector<PrefetchEvent>& events, const PrefetchOptions& options,
+                                           size_t max_edges) {
+    PrefetchReplayResult result;
+    PrefetchModel model(max_edges);
+    for (const auto& session : PrefetchTrace::group_sessions(events)) {
+        std::vector<std::string> context;
+        std::unordered_map<std::string, uint64_t> prefetched;   // 包 -> 预取时估计的大小
+        std::unordered_set<std::string> requested;
+
+        for (const auto& event : session.events) {
+            for (const auto& candidate : model.predict(context, options)) {
+                if (!requested.count(candidate.package) &&
+                    prefetched.emplace(candidate.package, candidate.expected_bytes).second) {
+                    result.prefetched++;
+                    result.prefetched_bytes += candidate.expected_bytes;
+                }
+            }
+            result.requests++;
+            if (prefetched.count(event.package)) {
+                result.covered++;
+            }
+            requested.insert(event.package);
+            context.push_back(event.package);
+        }
+
+        for (const auto& item : prefetched) {
+            if (requested.count(item.first)) {
+                result.useful++;
+            } else {
+                result.wasted_bytes += item.second;
+            }
+        }
+        model.observe_session(session);
+        result.sessions++;
+    }
+    return result;
+}
+
+std::string get_prefetch_dir() {
+    if (g_cache_manager && !g_cache_manager->get_user_cache_path().empty()) {
+        return g_cache_manager->get_user_cache_path() + "/prefetch";
+    }
+    const char* home = std::getenv("HOME");
+    return home ? std::string(home) + "/.paker/cache/prefetch" : "./.paker/cache/prefetch";
+}
+
+} // namespace Paker
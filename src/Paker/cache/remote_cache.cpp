@@ -0,0 +1,390 @@
+#include "Paker/cache/remote_cache.h"
+#include "Paker/cache/seekable_archive.h"
+#include "Paker/cache/blob_store.h"
+#include <glog/logging.h>
+#include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+std::atomic<uint64_t> g_temp_serial{0};
+
+bool is_hex_digest(const std::string& digest) {
+    return digest.size() == 64 &&
+           std::all_of(digest.begin(), digest.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+// 每个请求使用独立的句柄，后台回写和前台读取可以并发
+class CurlRequest {
+public:
+    CurlRequest(const std::string& url, long timeout_seconds) : curl_(curl_easy_init()), headers_(nullptr) {
+        if (!curl_) {
+            return;
+        }
+        curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl_, CURLOPT_TIMEOUT, timeout_seconds);
+        curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+        // 不等待 100-continue，上传立即开始
+        headers_ = curl_slist_append(headers_, "Expect:");
+        curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers_);
+    }
+
+    ~CurlRequest() {
+        if (headers_) {
+            curl_slist_free_all(headers_);
+        }
+        if (curl_) {
+            curl_easy_cleanup(curl_);
+        }
+    }
+
+    CURL* handle() const { return curl_; }
+
+    // 返回 HTTP 状态码，传输失败时返回 0
+    long perform(const std::string& what) {
+        if (!curl_) {
+            return 0;
+        }
+        CURLcode res = curl_easy_perform(curl_);
+        if (res != CURLE_OK) {
+            LOG(WARNING) << "Remote cache " << what << " failed: " << curl_easy_strerror(res);
+            return 0;
+        }
+        long code = 0;
+        curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &code);
+        return code;
+    }
+
+private:
+    CURL* curl_;
+    curl_slist* headers_;
+};
+
+} // namespace
+
+// ==================== FilesystemRemoteBackend ====================
+
+FilesystemRemoteBackend::FilesystemRemoteBackend(const std::string& root) : root_(root) {}
+
+bool FilesystemRemoteBackend::fetch(const std::string& key, const std::string& dest_path) {
+    std::error_code ec;
+    fs::copy_file(fs::path(root_) / key, dest_path, fs::copy_options::overwrite_existing, ec);
+    return !ec;
+}
+
+bool FilesystemRemoteBackend::store(const std::string& key, const std::string& src_path) {
+    fs::path target = fs::path(root_) / key;
+    std::error_code ec;
+    fs::create_directories(target.parent_path(), ec);
+    fs::path temp = target.string() + ".tmp." + std::to_string(::getpid()) + "." +
+                    std::to_string(g_temp_serial.fetch_add(1));
+    fs::copy_file(src_path, temp, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        fs::rename(temp, target, ec);
+    }
+    if (ec) {
+        LOG(WARNING) << "Failed to store " << key << " in remote cache " << root_ << ": " << ec.message();
+        std::error_code remove_ec;
+        fs::remove(temp, remove_ec);
+        return false;
+    }
+    return true;
+}
+
+bool FilesystemRemoteBackend::contains(const std::string& key) {
+    std::error_code ec;
+    return fs::is_regular_file(fs::path(root_) / key, ec);
+}
+
+// ==================== HttpRemoteBackend ====================
+
+HttpRemoteBackend::HttpRemoteBackend(const std::string& base_url, long timeout_seconds)
+    : base_url_(base_url), timeout_seconds_(timeout_seconds) {
+    while (!base_url_.empty() && base_url_.back() == '/') {
+        base_url_.pop_back();
+    }
+    static std::once_flag curl_init;
+    std::call_once(curl_init, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+bool HttpRemoteBackend::fetch(const std::string& key, const std::string& dest_path) {
+    FILE* file = std::fopen(dest_path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    CurlRequest request(url_for(key), timeout_seconds_);
+    curl_easy_setopt(request.handle(), CURLOPT_WRITEDATA, file);
+    long code = request.perform("GET " + key);
+    std::fclose(file);
+    if (code != 200) {
+        std::error_code ec;
+        fs::remove(dest_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool HttpRemoteBackend::store(const std::string& key, const std::string& src_path) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(src_path, ec);
+    FILE* file = ec ? nullptr : std::fopen(src_path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    CurlRequest request(url_for(key), timeout_seconds_);
+    curl_easy_setopt(request.handle(), CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(request.handle(), CURLOPT_READDATA, file);
+    curl_easy_setopt(request.handle(), CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(size));
+    long code = request.perform("PUT " + key);
+    std::fclose(file);
+    if (code < 200 || code >= 300) {
+        LOG(WARNING) << "Remote cache rejected PUT " << key << " (HTTP " << code << ")";
+        return false;
+    }
+    return true;
+}
+
+bool HttpRemoteBackend::contains(const std::string& key) {
+    CurlRequest request(url_for(key), timeout_seconds_);
+    curl_easy_setopt(request.handle(), CURLOPT_NOBODY, 1L);
+    return request.perform("HEAD " + key) == 200;
+}
+
+std::unique_ptr<RemoteCacheBackend> create_remote_cache_backend(const std::string& location) {
+    if (location.empty()) {
+        return nullptr;
+    }
+    if (location.rfind("http://", 0) == 0 || location.rfind("https://", 0) == 0) {
+        return std::make_unique<HttpRemoteBackend>(location);
+    }
+    if (location.rfind("file://", 0) == 0) {
+        return std::make_unique<FilesystemRemoteBackend>(location.substr(7));
+    }
+    return std::make_unique<FilesystemRemoteBackend>(location);
+}
+
+// ==================== RemoteCache ====================
+
+RemoteCache::RemoteCache(std::unique_ptr<RemoteCacheBackend> backend, const std::string& staging_dir)
+    : backend_(std::move(backend))
+    , staging_dir_(staging_dir)
+    , staging_serial_(0)
+    , uploads_in_flight_(0)
+    , stopping_(false) {
+    std::error_code ec;
+    fs::create_directories(staging_dir_, ec);
+    uploader_ = std::thread(&RemoteCache::upload_loop, this);
+}
+
+RemoteCache::~RemoteCache() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    if (uploader_.joinable()) {
+        uploader_.join();
+    }
+}
+
+bool RemoteCache::valid_name(const std::string& name) {
+    return !name.empty() && name != "." && name != ".." && name.find('/') == std::string::npos &&
+           name.find('\\') == std::string::npos;
+}
+
+std::string RemoteCache::ref_key(const std::string& package, const std::string& version) {
+    return "refs/" + package + "/" + version;
+}
+
+std::string RemoteCache::object_key(const std::string& digest) {
+    return "objects/" + digest.substr(0, 2) + "/" + digest;
+}
+
+std::string RemoteCache::staging_path(const std::string& name) {
+    return staging_dir_ + "/" + std::to_string(::getpid()) + "-" + std::to_string(staging_serial_.fetch_add(1)) +
+           "." + name;
+}
+
+bool RemoteCache::fetch(const std::string& package, const std::string& version, const std::string& dest_dir) {
+    if (!valid_name(package) || !valid_name(version)) {
+        return false;
+    }
+    auto record_miss = [this] {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.misses++;
+    };
+
+    std::string digest;
+    std::string ref_path = staging_path("ref");
+    if (backend_->fetch(ref_key(package, version), ref_path)) {
+        std::ifstream(ref_path) >> digest;
+        std::transform(digest.begin(), digest.end(), digest.begin(), ::tolower);
+    }
+    std::error_code ec;
+    fs::remove(ref_path, ec);
+    if (!is_hex_digest(digest)) {
+        record_miss();
+        return false;
+    }
+
+    std::string object_path = staging_path("pkar");
+    if (!backend_->fetch(object_key(digest), object_path)) {
+        fs::remove(object_path, ec);
+        record_miss();
+        return false;
+    }
+    uint64_t size = fs::file_size(object_path, ec);
+    if (BlobStore::hash_file(object_path) != digest) {
+        LOG(WARNING) << "Remote cache object for " << package << "@" << version << " failed SHA-256 verification";
+        fs::remove(object_path, ec);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.integrity_failures++;
+        return false;
+    }
+
+    // 先解压到旁边的临时目录，完整后再改名
+    std::string temp_dir = dest_dir + ".remote";
+    fs::remove_all(temp_dir, ec);
+    bool extracted = false;
+    {
+        SeekableArchiveReader reader;
+        extracted = reader.open(object_path) && reader.extract_all(temp_dir);
+    }
+    fs::remove(object_path, ec);
+    if (extracted) {
+        fs::create_directories(fs::path(dest_dir).parent_path(), ec);
+        fs::rename(temp_dir, dest_dir, ec);
+        extracted = !ec;
+    }
+    if (!extracted) {
+        LOG(WARNING) << "Failed to unpack remote cache object for " << package << "@" << version;
+        fs::remove_all(temp_dir, ec);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.integrity_failures++;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.hits++;
+    stats_.bytes_downloaded += size;
+    LOG(INFO) << "Fetched " << package << "@" << version << " from remote cache " << backend_->describe();
+    return true;
+}
+
+bool RemoteCache::pack(const std::string& source, const std::string& archive_path) {
+    // 本地的 COMPRESSED 归档可能依赖本机的 zstd 字典，重新打包为自包含的归档
+    std::string tree = source;
+    std::string unpacked;
+    if (fs::is_regular_file(source)) {
+        unpacked = staging_path("tree");
+        SeekableArchiveReader reader;
+        if (!reader.open(source) || !reader.extract_all(unpacked)) {
+            std::error_code ec;
+            fs::remove_all(unpacked, ec);
+            return false;
+        }
+        tree = unpacked;
+    } else if (!fs::is_directory(source)) {
+        return false;
+    }
+
+    bool success = SeekableArchiveWriter::create(tree, archive_path);
+    if (!unpacked.empty()) {
+        std::error_code ec;
+        fs::remove_all(unpacked, ec);
+    }
+    return success;
+}
+
+bool RemoteCache::publish(const std::string& package, const std::string& version, const std::string& source) {
+    if (!valid_name(package) || !valid_name(version)) {
+        return false;
+    }
+    std::string archive_path = staging_path("pkar");
+    std::string ref_path = staging_path("ref");
+    bool success = false;
+    bool present = false;
+    uint64_t uploaded = 0;
+    if (pack(source, archive_path)) {
+        // 对象键是归档的标准 SHA-256，其他工具（如 sha256sum）可以直接校验服务器上的对象
+        std::string digest = BlobStore::hash_file(archive_path);
+        std::string key = object_key(digest);
+        present = backend_->contains(key);
+        if (present || backend_->store(key, archive_path)) {
+            uploaded = present ? 0 : fs::file_size(archive_path);
+            // 对象写完后再写引用
+            std::ofstream(ref_path) << digest << "\n";
+            success = backend_->store(ref_key(package, version), ref_path);
+        }
+    }
+    std::error_code ec;
+    fs::remove(archive_path, ec);
+    fs::remove(ref_path, ec);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (success) {
+        stats_.uploads++;
+        stats_.bytes_uploaded += uploaded;
+        if (present) {
+            stats_.already_present++;
+        }
+        LOG(INFO) << "Published " << package << "@" << version << " to remote cache " << backend_->describe();
+    } else {
+        stats_.upload_failures++;
+        LOG(WARNING) << "Failed to publish " << package << "@" << version << " to remote cache";
+    }
+    return success;
+}
+
+void RemoteCache::publish_async(const std::string& package, const std::string& version, const std::string& source) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        uploads_.push_back(Upload{package, version, source});
+    }
+    queue_cv_.notify_one();
+}
+
+void RemoteCache::flush() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    idle_cv_.wait(lock, [this] { return uploads_.empty() && uploads_in_flight_ == 0; });
+}
+
+void RemoteCache::upload_loop() {
+    while (true) {
+        Upload upload;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !uploads_.empty(); });
+            // 退出前把已排队的回写做完，新安装的版本不会因进程结束而丢失
+            if (uploads_.empty()) {
+                return;
+            }
+            upload = std::move(uploads_.front());
+            uploads_.pop_front();
+            uploads_in_flight_++;
+        }
+        publish(upload.package, upload.version, upload.source);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            uploads_in_flight_--;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+RemoteCacheStats RemoteCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+} // namespace Paker
@@ -0,0 +1,237 @@
+#include "Paker/cache/remote_cache_server.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 请求头的上限，超过时直接断开
+constexpr size_t kMaxHeaderBytes = 16 * 1024;
+
+bool send_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void send_status(int fd, int code, const char* reason) {
+    std::string response = "HTTP/1.1 " + std::to_string(code) + " " + reason +
+                           "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    send_all(fd, response.data(), response.size());
+}
+
+} // namespace
+
+RemoteCacheServer::RemoteCacheServer(const std::string& root) : root_(root) {
+}
+
+RemoteCacheServer::~RemoteCacheServer() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+    }
+}
+
+bool RemoteCacheServer::bind(uint16_t port, const std::string& address) {
+    std::error_code ec;
+    fs::create_directories(root_, ec);
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        LOG(ERROR) << "Invalid remote cache server address: " << address;
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG(ERROR) << "Failed to create remote cache server socket: " << std::strerror(errno);
+        return false;
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    socklen_t length = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 64) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), &length) != 0) {
+        LOG(ERROR) << "Failed to listen on " << address << ":" << port << ": " << std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    address_ = address;
+    port_ = ntohs(addr.sin_port);
+    LOG(INFO) << "Remote cache server serving " << root_ << " on " << get_url();
+    return true;
+}
+
+std::string RemoteCacheServer::get_url() const {
+    return "http://" + address_ + ":" + std::to_string(port_);
+}
+
+void RemoteCacheServer::run() {
+    if (listen_fd_ < 0 && !bind()) {
+        return;
+    }
+    while (!stop_requested_) {
+        struct pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 100);
+        if (ready < 0 && errno != EINTR) {
+            LOG(ERROR) << "Remote cache server poll failed: " << std::strerror(errno);
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        handle_connection(client);
+        ::close(client);
+        requests_served_++;
+    }
+}
+
+std::string RemoteCacheServer::resolve_key(const std::string& target) const {
+    // 只接受由普通路径段组成的键
+    std::string key = target.substr(0, target.find('?'));
+    while (!key.empty() && key.front() == '/') {
+        key.erase(0, 1);
+    }
+    std::istringstream segments(key);
+    std::string segment;
+    bool any = false;
+    while (std::getline(segments, segment, '/')) {
+        if (segment.empty() || segment == "." || segment == "..") {
+            return "";
+        }
+        any = true;
+    }
+    return any ? root_ + "/" + key : "";
+}
+
+void RemoteCacheServer::handle_connection(int client_fd) {
+    struct timeval timeout{30, 0};
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string buffer;
+    size_t header_end = std::string::npos;
+    char chunk[64 * 1024];
+    while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > kMaxHeaderBytes) {
+            return;
+        }
+        ssize_t n = ::recv(client_fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::istringstream head(buffer.substr(0, header_end));
+    std::string method, target, line;
+    head >> method >> target;
+    std::getline(head, line);
+    uint64_t content_length = 0;
+    while (std::getline(head, line)) {
+        std::string lower = line;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower.rfind("content-length:", 0) == 0) {
+            content_length = std::strtoull(line.c_str() + 15, nullptr, 10);
+        }
+    }
+    std::string body = buffer.substr(header_end + 4);
+
+    std::string path = resolve_key(target);
+    if (path.empty()) {
+        send_status(client_fd, 400, "Bad Request");
+        return;
+    }
+
+    if (method == "GET" || method == "HEAD") {
+        std::error_code ec;
+        if (!fs::is_regular_file(path, ec)) {
+            send_status(client_fd, 404, "Not Found");
+            return;
+        }
+        uintmax_t size = fs::file_size(path, ec);
+        std::string header = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: " +
+                             std::to_string(size) + "\r\nConnection: close\r\n\r\n";
+        if (!send_all(client_fd, header.data(), header.size()) || method == "HEAD") {
+            return;
+        }
+        std::ifstream file(path, std::ios::binary);
+        while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0) {
+            if (!send_all(client_fd, chunk, static_cast<size_t>(file.gcount()))) {
+                return;
+            }
+        }
+        return;
+    }
+
+    if (method != "PUT") {
+        send_status(client_fd, 405, "Method Not Allowed");
+        return;
+    }
+
+    // 写入临时文件，收完整个请求体后再改名
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    std::string temp = path + ".upload." + std::to_string(::getpid()) + "." + std::to_string(requests_served_.load());
+    uint64_t received = 0;
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        size_t first = static_cast<size_t>(std::min<uint64_t>(body.size(), content_length));
+        file.write(body.data(), static_cast<std::streamsize>(first));
+        received = first;
+        while (received < content_length) {
+            ssize_t n = ::recv(client_fd, chunk, static_cast<size_t>(std::min<uint64_t>(sizeof(chunk), content_length - received)), 0);
+            if (n <= 0) {
+                break;
+            }
+            file.write(chunk, n);
+            received += static_cast<uint64_t>(n);
+        }
+        if (!file) {
+            received = 0;
+        }
+    }
+    if (received != content_length) {
+        fs::remove(temp, ec);
+        send_status(client_fd, 400, "Bad Request");
+        return;
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        send_status(client_fd, 500, "Internal Server Error");
+        return;
+    }
+    send_status(client_fd, 201, "Created");
+}
+
+} // namespace Paker
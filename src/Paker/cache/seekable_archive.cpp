@@ -0,0 +1,758 @@
+#include "Paker/cache/seekable_archive.h"
+#include <glog/logging.h>
+#include <omp.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string_view>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef PAKER_HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 尾部布局（本机字节序，缓存归档不跨机器共享）
+constexpr char kMagic[4] = {'P', 'K', 'A', 'R'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kFooterSize = 40;
+constexpr size_t kNoFrame = std::numeric_limits<size_t>::max();
+
+// 索引编码
+class ByteWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void put_string(const std::string& value) {
+        put<uint32_t>(static_cast<uint32_t>(value.size()));
+        buffer_.append(value);
+    }
+    const std::string& data() const { return buffer_; }
+
+private:
+    std::string buffer_;
+};
+
+class ByteReader {
+public:
+    ByteReader(const char* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - pos_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool get_string(std::string& value) {
+        uint32_t length = 0;
+        if (!get(length) || size_ - pos_ < length) {
+            return false;
+        }
+        value.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+bool pread_all(int fd, char* buffer, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buffer += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int effective_threads(int threads) {
+    return threads > 0 ? threads : omp_get_max_threads();
+}
+
+uint32_t dictionary_id(const std::string& dictionary) {
+#ifdef PAKER_HAVE_ZSTD
+    return dictionary.empty() ? 0 : ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+#else
+    (void)dictionary;
+    return 0;
+#endif
+}
+
+// 非空的相对路径，且没有 "."、".." 或空的路径段
+bool is_contained_entry_path(const std::string& path) {
+    if (path.empty() || path.front() == '/') {
+        return false;
+    }
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        std::string_view part(path.data() + start, end - start);
+        if (part.empty() || part == "." || part == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+bool archive_codec_available(ArchiveCodec codec) {
+#ifdef PAKER_HAVE_ZSTD
+    return codec == ArchiveCodec::ZSTD || codec == ArchiveCodec::ZLIB;
+#else
+    return codec == ArchiveCodec::ZLIB;
+#endif
+}
+
+ArchiveCodec default_archive_codec() {
+#ifdef PAKER_HAVE_ZSTD
+    return ArchiveCodec::ZSTD;
+#else
+    return ArchiveCodec::ZLIB;
+#endif
+}
+
+// 单线程使用的帧压缩/解压上下文
+class SeekableArchiveReader::FrameCodec {
+public:
+    FrameCodec(ArchiveCodec codec, const std::string& dictionary, int level)
+        : codec_(codec), dictionary_(dictionary), level_(level) {
+        if (level_ == 0) {
+#ifdef PAKER_HAVE_ZSTD
+            level_ = codec_ == ArchiveCodec::ZSTD ? ZSTD_CLEVEL_DEFAULT : Z_DEFAULT_COMPRESSION;
+#else
+            level_ = Z_DEFAULT_COMPRESSION;
+#endif
+        }
+    }
+
+    ~FrameCodec() {
+#ifdef PAKER_HAVE_ZSTD
+        ZSTD_freeCCtx(cctx_);
+        ZSTD_freeDCtx(dctx_);
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDDict(ddict_);
+#endif
+    }
+
+    FrameCodec(const FrameCodec&) = delete;
+    FrameCodec& operator=(const FrameCodec&) = delete;
+
+    bool compress(const char* src, size_t size, std::string& out) {
+#ifdef PAKER_HAVE_ZSTD
+        if (codec_ == ArchiveCodec::ZSTD) {
+            if (!cctx_) {
+                cctx_ = ZSTD_createCCtx();
+            }
+            if (!dictionary_.empty() && !cdict_) {
+                cdict_ = ZSTD_createCDict(dictionary_.data(), dictionary_.size(), level_);
+            }
+            out.resize(ZSTD_compressBound(size));
+            size_t result = cdict_ ? ZSTD_compress_usingCDict(cctx_, &out[0], out.size(), src, size, cdict_)
+                                   : ZSTD_compressCCtx(cctx_, &out[0], out.size(), src, size, level_);
+            if (ZSTD_isError(result)) {
+                LOG(ERROR) << "zstd compression failed: " << ZSTD_getErrorName(result);
+                return false;
+            }
+            out.resize(result);
+            return true;
+        }
+#endif
+        uLongf length = compressBound(static_cast<uLong>(size));
+        out.resize(length);
+        if (compress2(reinterpret_cast<Bytef*>(&out[0]), &length, reinterpret_cast<const Bytef*>(src),
+                      static_cast<uLong>(size), level_) != Z_OK) {
+            return false;
+        }
+        out.resize(length);
+        return true;
+    }
+
+    bool decompress(const char* src, size_t size, char* dst, size_t dst_size) {
+#ifdef PAKER_HAVE_ZSTD
+        if (codec_ == ArchiveCodec::ZSTD) {
+            if (!dctx_) {
+                dctx_ = ZSTD_createDCtx();
+            }
+            if (!dictionary_.empty() && !ddict_) {
+                ddict_ = ZSTD_createDDict(dictionary_.data(), dictionary_.size());
+            }
+            size_t result = ddict_ ? ZSTD_decompress_usingDDict(dctx_, dst, dst_size, src, size, ddict_)
+                                   : ZSTD_decompressDCtx(dctx_, dst, dst_size, src, size);
+            return !ZSTD_isError(result) && result == dst_size;
+        }
+#endif
+        uLongf length = static_cast<uLongf>(dst_size);
+        return uncompress(reinterpret_cast<Bytef*>(dst), &length, reinterpret_cast<const Bytef*>(src),
+                          static_cast<uLong>(size)) == Z_OK && length == dst_size;
+    }
+
+private:
+    ArchiveCodec codec_;
+    const std::string& dictionary_;
+    int level_;
+#ifdef PAKER_HAVE_ZSTD
+    ZSTD_CCtx* cctx_ = nullptr;
+    ZSTD_DCtx* dctx_ = nullptr;
+    ZSTD_CDict* cdict_ = nullptr;
+    ZSTD_DDict* ddict_ = nullptr;
+#endif
+};
+
+// ---------------------------------------------------------------------------
+// 写入
+// ---------------------------------------------------------------------------
+
+bool SeekableArchiveWriter::create(const std::string& source_dir, const std::string& archive_path,
+                                   const ArchiveWriteOptions& options, ArchiveWriteStats* stats) {
+    using FrameCodec = SeekableArchiveReader::FrameCodec;
+
+    if (!archive_codec_available(options.codec)) {
+        LOG(ERROR) << "Archive codec " << static_cast<uint32_t>(options.codec) << " is not available in this build";
+        return false;
+    }
+    const size_t frame_size = std::max<size_t>(options.frame_size, 4096);
+    const int threads = effective_threads(options.threads);
+    const std::string dictionary = options.codec == ArchiveCodec::ZSTD ? options.dictionary : std::string();
+
+    // 按路径排序，同一目录下的小文件落在相邻位置，通常共享一帧
+    std::vector<fs::path> paths;
+    try {
+        for (const auto& entry : fs::recursive_directory_iterator(source_dir)) {
+            paths.push_back(entry.path());
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to scan " << source_dir << ": " << e.what();
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::string temp_path = archive_path + ".tmp";
+    std::error_code dir_ec;
+    fs::create_directories(fs::path(archive_path).parent_path(), dir_ec);
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG(ERROR) << "Failed to create archive " << temp_path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    std::vector<std::unique_ptr<FrameCodec>> codecs;
+    for (int i = 0; i < threads; ++i) {
+        codecs.push_back(std::make_unique<FrameCodec>(options.codec, dictionary, options.level));
+    }
+
+    std::vector<ArchiveEntry> entries;
+    ByteWriter frame_table;
+    uint32_t frame_count = 0;
+    uint64_t file_offset = 0;
+    uint64_t stream_size = 0;
+    std::string pending;
+    bool ok = true;
+
+    // 把 pending 中的整帧（final 时包括最后的不满帧）并行压缩后按顺序写出
+    auto flush = [&](bool final) {
+        size_t count = pending.size() / frame_size;
+        if (final && pending.size() % frame_size != 0) {
+            count++;
+        }
+        if (count == 0 || !ok) {
+            return;
+        }
+        std::vector<std::string> compressed(count);
+        std::vector<char> failed(count, 0);
+        #pragma omp parallel for num_threads(threads) schedule(dynamic)
+        for (size_t i = 0; i < count; ++i) {
+            size_t begin = i * frame_size;
+            size_t length = std::min(frame_size, pending.size() - begin);
+            if (!codecs[omp_get_thread_num()]->compress(pending.data() + begin, length, compressed[i])) {
+                failed[i] = 1;
+            }
+        }
+        for (size_t i = 0; i < count && ok; ++i) {
+            size_t length = std::min(frame_size, pending.size() - i * frame_size);
+            if (failed[i] || !write_all(fd, compressed[i].data(), compressed[i].size())) {
+                ok = false;
+                break;
+            }
+            frame_table.put<uint64_t>(file_offset);
+            frame_table.put<uint32_t>(static_cast<uint32_t>(compressed[i].size()));
+            frame_table.put<uint32_t>(static_cast<uint32_t>(length));
+            file_offset += compressed[i].size();
+            frame_count++;
+        }
+        pending.erase(0, std::min(pending.size(), count * frame_size));
+    };
+
+    const size_t batch_bytes = frame_size * static_cast<size_t>(threads) * 4;
+    for (const auto& path : paths) {
+        std::error_code ec;
+        fs::file_status status = fs::symlink_status(path, ec);
+        if (ec) {
+            continue;
+        }
+
+        ArchiveEntry entry;
+        entry.path = path.lexically_relative(source_dir).generic_string();
+        entry.mode = static_cast<uint32_t>(status.permissions()) & 07777;
+        entry.stream_offset = stream_size;
+        if (fs::is_symlink(status)) {
+            entry.type = ArchiveEntry::Type::SYMLINK;
+            entry.link_target = fs::read_symlink(path, ec).string();
+        } else if (fs::is_directory(status)) {
+            entry.type = ArchiveEntry::Type::DIRECTORY;
+        } else if (fs::is_regular_file(status)) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                LOG(WARNING) << "Skipping unreadable file " << path.string();
+                continue;
+            }
+            char buffer[64 * 1024];
+            while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+                pending.append(buffer, static_cast<size_t>(file.gcount()));
+                entry.size += static_cast<uint64_t>(file.gcount());
+                if (pending.size() >= batch_bytes) {
+                    flush(false);
+                }
+            }
+            stream_size += entry.size;
+        } else {
+            continue;
+        }
+        entries.push_back(std::move(entry));
+    }
+    flush(true);
+
+    ByteWriter index;
+    index.put<uint32_t>(frame_count);
+    std::string index_data = index.data() + frame_table.data();
+    ByteWriter entry_table;
+    entry_table.put<uint32_t>(static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries) {
+        entry_table.put<uint8_t>(static_cast<uint8_t>(entry.type));
+        entry_table.put<uint32_t>(entry.mode);
+        entry_table.put<uint64_t>(entry.size);
+        entry_table.put<uint64_t>(entry.stream_offset);
+        entry_table.put_string(entry.path);
+        entry_table.put_string(entry.link_target);
+    }
+    index_data += entry_table.data();
+
+    ByteWriter footer;
+    for (char c : kMagic) {
+        footer.put<char>(c);
+    }
+    footer.put<uint32_t>(kFormatVersion);
+    footer.put<uint32_t>(static_cast<uint32_t>(options.codec));
+    footer.put<uint32_t>(dictionary_id(dictionary));
+    footer.put<uint32_t>(static_cast<uint32_t>(frame_size));
+    footer.put<uint32_t>(0);
+    footer.put<uint64_t>(file_offset);
+    footer.put<uint64_t>(index_data.size());
+
+    ok = ok && write_all(fd, index_data.data(), index_data.size()) &&
+         write_all(fd, footer.data().data(), footer.data().size());
+    ok = (::close(fd) == 0) && ok;
+    if (!ok) {
+        LOG(ERROR) << "Failed to write archive " << archive_path;
+        ::unlink(temp_path.c_str());
+        return false;
+    }
+    if (::rename(temp_path.c_str(), archive_path.c_str()) != 0) {
+        LOG(ERROR) << "Failed to move archive into place: " << archive_path;
+        ::unlink(temp_path.c_str());
+        return false;
+    }
+
+    size_t archive_bytes = file_offset + index_data.size() + kFooterSize;
+    if (stats) {
+        stats->files = entries.size();
+        stats->frames = frame_count;
+        stats->uncompressed_bytes = stream_size;
+        stats->archive_bytes = archive_bytes;
+    }
+    LOG(INFO) << "Created archive " << archive_path << ": " << entries.size() << " entries, " << frame_count
+              << " frames, " << stream_size << " -> " << archive_bytes << " bytes";
+    return true;
+}
+
+std::string SeekableArchiveWriter::train_dictionary(const std::string& source_dir, size_t max_dict_size) {
+#ifdef PAKER_HAVE_ZSTD
+    constexpr size_t kMaxSampleSize = 64 * 1024;
+    constexpr size_t kMaxSampleBytes = 8 * 1024 * 1024;
+    constexpr size_t kMinSamples = 16;
+
+    std::string samples;
+    std::vector<size_t> sample_sizes;
+    try {
+        for (auto it = fs::recursive_directory_iterator(source_dir); it != fs::recursive_directory_iterator(); ++it) {
+            if (it->is_directory() && it->path().filename() == ".git") {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if (it->is_symlink() || !it->is_regular_file()) {
+                continue;
+            }
+            size_t size = it->file_size();
+            if (size < 16 || size > kMaxSampleSize) {
+                continue;
+            }
+            std::ifstream file(it->path(), std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            samples += content;
+            sample_sizes.push_back(content.size());
+            if (samples.size() >= kMaxSampleBytes) {
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to collect dictionary samples from " << source_dir << ": " << e.what();
+        return "";
+    }
+    if (sample_sizes.size() < kMinSamples) {
+        return "";
+    }
+
+    std::string dictionary(max_dict_size, '\0');
+    size_t result = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(), samples.data(), sample_sizes.data(),
+                                          static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(result)) {
+        LOG(INFO) << "Dictionary training skipped for " << source_dir;
+        return "";
+    }
+    dictionary.resize(result);
+    return dictionary;
+#else
+    (void)source_dir;
+    (void)max_dict_size;
+    return "";
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// 读取
+// ---------------------------------------------------------------------------
+
+SeekableArchiveReader::SeekableArchiveReader()
+    : fd_(-1), codec_(ArchiveCodec::ZLIB), frame_size_(0), cached_index_(kNoFrame), frames_decompressed_(0) {}
+
+SeekableArchiveReader::~SeekableArchiveReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool SeekableArchiveReader::open(const std::string& archive_path, const std::string& dictionary_path) {
+    int fd = ::open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    auto fail = [&](const char* reason) {
+        LOG(ERROR) << "Invalid archive " << archive_path << ": " << reason;
+        ::close(fd);
+        return false;
+    };
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kFooterSize) {
+        return fail("too small");
+    }
+    char footer_data[kFooterSize];
+    if (!pread_all(fd, footer_data, kFooterSize, static_cast<uint64_t>(st.st_size) - kFooterSize)) {
+        return fail("cannot read footer");
+    }
+
+    ByteReader footer(footer_data, kFooterSize);
+    char magic[4];
+    uint32_t version = 0, codec = 0, dict_id = 0, frame_size = 0, reserved = 0;
+    uint64_t index_offset = 0, index_size = 0;
+    for (char& c : magic) {
+        footer.get(c);
+    }
+    footer.get(version);
+    footer.get(codec);
+    footer.get(dict_id);
+    footer.get(frame_size);
+    footer.get(reserved);
+    footer.get(index_offset);
+    footer.get(index_size);
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kFormatVersion) {
+        return fail("bad magic or version");
+    }
+    if (!archive_codec_available(static_cast<ArchiveCodec>(codec))) {
+        return fail("codec not available in this build");
+    }
+    if (frame_size == 0 || index_offset + index_size + kFooterSize != static_cast<uint64_t>(st.st_size)) {
+        return fail("corrupt footer");
+    }
+
+    std::string index_data(index_size, '\0');
+    if (!pread_all(fd, &index_data[0], index_size, index_offset)) {
+        return fail("cannot read index");
+    }
+    ByteReader index(index_data.data(), index_data.size());
+    uint32_t frame_count = 0;
+    if (!index.get(frame_count)) {
+        return fail("corrupt frame table");
+    }
+    std::vector<Frame> frames(frame_count);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Frame& frame = frames[i];
+        if (!index.get(frame.offset) || !index.get(frame.compressed_size) || !index.get(frame.size) ||
+            frame.offset + frame.compressed_size > index_offset) {
+            return fail("corrupt frame table");
+        }
+        // 读取时按 offset / frame_size 定位帧：除最后一帧外每帧必须恰好 frame_size 字节，最后一帧非空且不超过它
+        bool last = i + 1 == frames.size();
+        if (last ? (frame.size == 0 || frame.size > frame_size) : frame.size != frame_size) {
+            return fail("frame size does not match footer");
+        }
+    }
+    uint32_t entry_count = 0;
+    if (!index.get(entry_count)) {
+        return fail("corrupt entry table");
+    }
+    uint64_t stream_size = static_cast<uint64_t>(frame_size) * (frame_count == 0 ? 0 : frame_count - 1) +
+                           (frame_count == 0 ? 0 : frames.back().size);
+    std::vector<ArchiveEntry> entries(entry_count);
+    for (auto& entry : entries) {
+        uint8_t type = 0;
+        if (!index.get(type) || !index.get(entry.mode) || !index.get(entry.size) || !index.get(entry.stream_offset) ||
+            !index.get_string(entry.path) || !index.get_string(entry.link_target) || type > 2 ||
+            entry.stream_offset + entry.size > stream_size) {
+            return fail("corrupt entry table");
+        }
+        entry.type = static_cast<ArchiveEntry::Type>(type);
+    }
+    // 解压时按条目路径直接写入目标目录，路径必须留在目录内，且不能经过归档自身的符号链接
+    std::unordered_set<std::string> paths;
+    std::unordered_set<std::string> symlinks;
+    for (const auto& entry : entries) {
+        if (!is_contained_entry_path(entry.path) || !paths.insert(entry.path).second) {
+            return fail("unsafe or duplicate entry path");
+        }
+        if (entry.type == ArchiveEntry::Type::SYMLINK) {
+            symlinks.insert(entry.path);
+        }
+    }
+    for (const auto& entry : entries) {
+        for (size_t slash = entry.path.find('/'); slash != std::string::npos; slash = entry.path.find('/', slash + 1)) {
+            if (symlinks.count(entry.path.substr(0, slash))) {
+                return fail("entry path passes through an archived symlink");
+            }
+        }
+    }
+
+    std::string dictionary;
+    if (dict_id != 0) {
+        std::string path = dictionary_path.empty() ? (fs::path(archive_path).parent_path() / ".zdict").string()
+                                                   : dictionary_path;
+        std::ifstream file(path, std::ios::binary);
+        dictionary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (dictionary_id(dictionary) != dict_id) {
+            return fail("dictionary missing or does not match");
+        }
+    }
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+    codec_ = static_cast<ArchiveCodec>(codec);
+    frame_size_ = frame_size;
+    dictionary_ = std::move(dictionary);
+    frames_ = std::move(frames);
+    entries_ = std::move(entries);
+    lookup_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        lookup_[entries_[i].path] = i;
+    }
+    read_codec_ = std::make_unique<FrameCodec>(codec_, dictionary_, 0);
+    cached_index_ = kNoFrame;
+    cached_frame_.clear();
+    return true;
+}
+
+const ArchiveEntry* SeekableArchiveReader::find(const std::string& path) const {
+    auto it = lookup_.find(path);
+    return it == lookup_.end() ? nullptr : &entries_[it->second];
+}
+
+bool SeekableArchiveReader::decompress_frame(size_t index, FrameCodec& codec, std::string& out) {
+    const Frame& frame = frames_[index];
+    thread_local std::string compressed;
+    compressed.resize(frame.compressed_size);
+    if (!pread_all(fd_, &compressed[0], frame.compressed_size, frame.offset)) {
+        return false;
+    }
+    out.resize(frame.size);
+    if (!codec.decompress(compressed.data(), compressed.size(), &out[0], out.size())) {
+        LOG(ERROR) << "Failed to decompress archive frame " << index;
+        return false;
+    }
+    frames_decompressed_++;
+    return true;
+}
+
+bool SeekableArchiveReader::read_range(uint64_t offset, uint64_t size, FrameCodec& codec, std::string& out,
+                                       size_t* cached_index, std::string* cached_frame) {
+    out.clear();
+    out.reserve(size);
+    std::string local_frame;
+    uint64_t position = offset;
+    uint64_t end = offset + size;
+    while (position < end) {
+        size_t index = static_cast<size_t>(position / frame_size_);
+        if (index >= frames_.size()) {
+            return false;
+        }
+        std::string* frame = cached_frame ? cached_frame : &local_frame;
+        if (!cached_index || *cached_index != index) {
+            if (!decompress_frame(index, codec, *frame)) {
+                if (cached_index) {
+                    *cached_index = kNoFrame;
+                }
+                return false;
+            }
+            if (cached_index) {
+                *cached_index = index;
+            }
+        }
+        uint64_t in_frame = position - static_cast<uint64_t>(index) * frame_size_;
+        uint64_t take = std::min<uint64_t>(end - position, frame->size() - in_frame);
+        out.append(*frame, static_cast<size_t>(in_frame), static_cast<size_t>(take));
+        position += take;
+    }
+    return true;
+}
+
+bool SeekableArchiveReader::read_file(const std::string& path, std::string& out) {
+    const ArchiveEntry* entry = find(path);
+    if (!entry || entry->type != ArchiveEntry::Type::FILE) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(read_mutex_);
+    return read_range(entry->stream_offset, entry->size, *read_codec_, out, &cached_index_, &cached_frame_);
+}
+
+bool SeekableArchiveReader::extract_all(const std::string& dest_dir, int threads) {
+    if (!is_open()) {
+        return false;
+    }
+    threads = effective_threads(threads);
+
+    // 目录与符号链接顺序创建，文件按起始帧分组后并行解压
+    std::map<size_t, std::vector<size_t>> groups;
+    try {
+        fs::create_directories(dest_dir);
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const ArchiveEntry& entry = entries_[i];
+            fs::path target = fs::path(dest_dir) / entry.path;
+            switch (entry.type) {
+                case ArchiveEntry::Type::DIRECTORY:
+                    fs::create_directories(target);
+                    break;
+                case ArchiveEntry::Type::SYMLINK:
+                    fs::create_directories(target.parent_path());
+                    fs::remove(target);
+                    fs::create_symlink(entry.link_target, target);
+                    break;
+                case ArchiveEntry::Type::FILE:
+                    fs::create_directories(target.parent_path());
+                    groups[static_cast<size_t>(entry.stream_offset / frame_size_)].push_back(i);
+                    break;
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to prepare extraction into " << dest_dir << ": " << e.what();
+        return false;
+    }
+
+    std::vector<const std::vector<size_t>*> work;
+    for (const auto& [frame, members] : groups) {
+        work.push_back(&members);
+    }
+    std::vector<std::unique_ptr<FrameCodec>> codecs;
+    for (int i = 0; i < threads; ++i) {
+        codecs.push_back(std::make_unique<FrameCodec>(codec_, dictionary_, 0));
+    }
+
+    std::atomic<bool> ok{true};
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (size_t g = 0; g < work.size(); ++g) {
+        FrameCodec& codec = *codecs[omp_get_thread_num()];
+        size_t cached_index = kNoFrame;
+        std::string cached_frame;
+        std::string data;
+        for (size_t i : *work[g]) {
+            const ArchiveEntry& entry = entries_[i];
+            std::string target = (fs::path(dest_dir) / entry.path).string();
+            if (!read_range(entry.stream_offset, entry.size, codec, data, &cached_index, &cached_frame)) {
+                ok = false;
+                continue;
+            }
+            int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 0600);
+            if (fd < 0) {
+                ok = false;
+                continue;
+            }
+            if (!write_all(fd, data.data(), data.size()) || ::fchmod(fd, entry.mode) != 0) {
+                ok = false;
+            }
+            ::close(fd);
+        }
+    }
+
+    if (!ok) {
+        LOG(ERROR) << "Failed to extract archive into " << dest_dir;
+    }
+    return ok;
+}
+
+} // namespace Paker
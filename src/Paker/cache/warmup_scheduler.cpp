@@ -0,0 +1,314 @@
+#include "Paker/cache/warmup_scheduler.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 本进程内进行中的前台操作数，避免每次检查都列目录
+std::atomic<size_t> g_foreground_scopes{0};
+std::atomic<uint64_t> g_foreground_serial{0};
+
+// 等待时的最长单次睡眠，保证取消和停止能及时生效
+constexpr std::chrono::milliseconds kPollInterval{50};
+
+} // namespace
+
+// ==================== TokenBucket ====================
+
+TokenBucket::TokenBucket(uint64_t rate_per_second, uint64_t capacity)
+    : rate_(0), capacity_(0), tokens_(0), last_refill_(std::chrono::steady_clock::now()) {
+    set_rate(rate_per_second, capacity);
+}
+
+void TokenBucket::set_rate(uint64_t rate_per_second, uint64_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_ = rate_per_second;
+    // 默认允许一秒的突发
+    capacity_ = capacity > 0 ? capacity : rate_per_second;
+    tokens_ = static_cast<double>(capacity_);
+    last_refill_ = std::chrono::steady_clock::now();
+}
+
+uint64_t TokenBucket::rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_;
+}
+
+void TokenBucket::refill(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    tokens_ = std::min(static_cast<double>(capacity_), tokens_ + elapsed * static_cast<double>(rate_));
+    last_refill_ = now;
+}
+
+bool TokenBucket::try_acquire(uint64_t amount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rate_ == 0) {
+        return true;
+    }
+    refill(std::chrono::steady_clock::now());
+    double need = static_cast<double>(std::min(amount, capacity_));
+    if (tokens_ < need) {
+        return false;
+    }
+    tokens_ -= static_cast<double>(amount);
+    return true;
+}
+
+bool TokenBucket::acquire(uint64_t amount, std::chrono::steady_clock::time_point deadline,
+                          const std::atomic<bool>* cancelled) {
+    while (!(cancelled && cancelled->load())) {
+        std::chrono::steady_clock::duration wait;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (rate_ == 0) {
+                return true;
+            }
+            auto now = std::chrono::steady_clock::now();
+            refill(now);
+            double need = static_cast<double>(std::min(amount, capacity_));
+            if (tokens_ >= need) {
+                tokens_ -= static_cast<double>(amount);
+                return true;
+            }
+            wait = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((need - tokens_) / static_cast<double>(rate_)));
+            // 到期前补不足令牌时不必空等
+            if (deadline - now < wait) {
+                return false;
+            }
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(wait, kPollInterval));
+    }
+    return false;
+}
+
+// ==================== ForegroundActivity ====================
+
+std::string ForegroundActivity::default_dir() {
+    const char* home = std::getenv("HOME");
+    return home ? std::string(home) + "/.paker/foreground" : ".paker/foreground";
+}
+
+ForegroundActivity::Scope::Scope(const std::string& reason, const std::string& dir) {
+    g_foreground_scopes.fetch_add(1);
+    std::string marker_dir = dir.empty() ? default_dir() : dir;
+    std::error_code ec;
+    fs::create_directories(marker_dir, ec);
+    marker_ = marker_dir + "/" + std::to_string(::getpid()) + "." + std::to_string(g_foreground_serial.fetch_add(1));
+    std::ofstream(marker_) << reason << "\n";
+}
+
+ForegroundActivity::Scope::~Scope() {
+    std::error_code ec;
+    fs::remove(marker_, ec);
+    g_foreground_scopes.fetch_sub(1);
+}
+
+bool ForegroundActivity::active(const std::string& dir) {
+    if (g_foreground_scopes.load() > 0) {
+        return true;
+    }
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(dir.empty() ? default_dir() : dir, ec)) {
+        std::string name = item.path().filename().string();
+        pid_t pid = 0;
+        try {
+            pid = static_cast<pid_t>(std::stol(name.substr(0, name.find('.'))));
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM)) {
+            return true;
+        }
+        // 进程已退出（例如被强制终止），标记失效
+        std::error_code remove_ec;
+        fs::remove(item.path(), remove_ec);
+    }
+    return false;
+}
+
+// ==================== WarmupScheduler ====================
+
+bool WarmupScheduler::Order::operator()(const WarmupTask& a, const WarmupTask& b) const {
+    // priority_queue 把“更小”的放在堆底：数值小的优先级、流行度高的、先加入的先出
+    if (a.info.priority != b.info.priority) {
+        return static_cast<int>(a.info.priority) > static_cast<int>(b.info.priority);
+    }
+    if (a.info.popularity_score != b.info.popularity_score) {
+        return a.info.popularity_score < b.info.popularity_score;
+    }
+    return a.sequence > b.sequence;
+}
+
+WarmupScheduler::WarmupScheduler(const WarmupBudget& budget, const std::string& foreground_dir)
+    : next_sequence_(1), stopped_(false), foreground_dir_(foreground_dir) {
+    set_budget(budget);
+}
+
+void WarmupScheduler::set_budget(const WarmupBudget& budget) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = budget;
+    }
+    network_.set_rate(budget.network_bytes_per_second);
+    disk_.set_rate(budget.disk_write_bytes_per_second);
+}
+
+WarmupBudget WarmupScheduler::get_budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+void WarmupScheduler::schedule(const PackageWarmupInfo& info, std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    WarmupTask task;
+    task.info = info;
+    task.deadline = deadline;
+    task.sequence = next_sequence_++;
+    live_[task.key()] = task.sequence;
+    heap_.push(std::move(task));
+    stats_.scheduled++;
+}
+
+bool WarmupScheduler::cancel(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (live_.erase(key) == 0) {
+        return false;
+    }
+    stats_.cancelled++;
+    return true;
+}
+
+void WarmupScheduler::cancel_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.cancelled += live_.size();
+    live_.clear();
+    heap_ = decltype(heap_)();
+}
+
+void WarmupScheduler::stop() {
+    stopped_.store(true);
+    stop_cv_.notify_all();
+}
+
+void WarmupScheduler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.clear();
+    heap_ = decltype(heap_)();
+    stopped_.store(false);
+}
+
+size_t WarmupScheduler::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size();
+}
+
+WarmupSchedulerStats WarmupScheduler::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool WarmupScheduler::still_live(const WarmupTask& task) const {
+    auto it = live_.find(task.key());
+    return it != live_.end() && it->second == task.sequence;
+}
+
+bool WarmupScheduler::pop(WarmupTask& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    while (!heap_.empty()) {
+        task = heap_.top();
+        heap_.pop();
+        if (!still_live(task)) {
+            continue;   // 已取消或被更新的条目
+        }
+        if (task.deadline <= now) {
+            live_.erase(task.key());
+            stats_.expired++;
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool WarmupScheduler::wait_for_foreground(const WarmupTask& task, std::chrono::steady_clock::time_point deadline) {
+    std::chrono::milliseconds backoff = get_budget().backoff_initial;
+    std::chrono::milliseconds backoff_max = get_budget().backoff_max;
+    auto start = std::chrono::steady_clock::now();
+    bool waited = false;
+    while (!stopped_.load() && ForegroundActivity::active(foreground_dir_)) {
+        if (!waited) {
+            waited = true;
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.backoffs++;
+            VLOG(1) << "Foreground install active, delaying warmup of " << task.key();
+        }
+        if (std::chrono::steady_clock::now() + backoff > deadline) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        stop_cv_.wait_for(lock, backoff, [this] { return stopped_.load(); });
+        backoff = std::min(backoff * 2, backoff_max);
+    }
+    if (waited) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.backoff_time += std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+    return !stopped_.load();
+}
+
+bool WarmupScheduler::charge(const WarmupTask& task, uint64_t bytes, bool network) {
+    // 任务已经开始，期限只约束开始时间，之后只因停止而放弃
+    const auto no_deadline = std::chrono::steady_clock::time_point::max();
+    while (bytes > 0) {
+        uint64_t chunk = std::min(bytes, kChunkSize);
+        if (!wait_for_foreground(task, no_deadline) ||
+            (network && !network_.acquire(chunk, no_deadline, &stopped_)) ||
+            !disk_.acquire(chunk, no_deadline, &stopped_)) {
+            return false;
+        }
+        bytes -= chunk;
+    }
+    return !stopped_.load();
+}
+
+bool WarmupScheduler::next(WarmupTask& task) {
+    while (!stopped_.load()) {
+        if (!pop(task)) {
+            return false;
+        }
+        bool ready = wait_for_foreground(task, task.deadline);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_.load()) {
+            return false;
+        }
+        if (!still_live(task)) {
+            continue;   // 等待期间被取消
+        }
+        live_.erase(task.key());
+        if (!ready) {
+            stats_.expired++;
+            LOG(INFO) << "Warmup of " << task.key() << " skipped: deadline reached before it could start";
+            continue;
+        }
+        stats_.started++;
+        return true;
+    }
+    return false;
+}
+
+} // namespace Paker
@@ -1,5 +1,7 @@
 #include "Paker/commands/cache.h"
 #include "Paker/cache/cache_manager.h"
+#include "Paker/cache/blob_store.h"
+#include "Paker/cache/materializer.h"
 #include "Paker/core/output.h"
 #include "Paker/core/utils.h"
 #include "Paker/dependency/sources.h"
@@ -225,10 +227,10 @@ int pm_cache_cleanup() {
         
         size_t cleaned_packages = 0;
         
-        // 清理用户缓存目录中的空目录和临时文件
+        // 清理用户缓存目录中的空目录和临时文件（.store 等内部目录除外）
         if (fs::exists(user_cache_path)) {
             for (const auto& entry : fs::directory_iterator(user_cache_path)) {
-                if (entry.is_directory()) {
+                if (entry.is_directory() && entry.path().filename().string()[0] != '.') {
                     // 检查目录是否为空或只包含临时文件
                     bool is_empty = true;
                     for (const auto& sub_entry : fs::directory_iterator(entry.path())) {
@@ -277,6 +279,13 @@ int pm_cache_cleanup() {
             }
         }
         
+        // 回收内容存储中已无版本引用的 blob
+        size_t freed_bytes = BlobStore(user_cache_path + "/.store").collect_garbage(true);
+        if (freed_bytes > 0) {
+            std::cout << "\033[1;32m Freed \033[1;36m" << Paker::format_size(freed_bytes)
+                      << "\033[1;32m of unreferenced content\033[0m" << std::endl;
+        }
+        
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
@@ -315,7 +324,7 @@ int pm_cache_stats() {
         
         if (fs::exists(user_cache_path)) {
             for (const auto& entry : fs::directory_iterator(user_cache_path)) {
-                if (entry.is_directory()) {
+                if (entry.is_directory() && entry.path().filename().string()[0] != '.') {
                     total_packages++;
                     // 跳过递归大小计算以提高性能
                 }
@@ -385,6 +394,24 @@ int pm_cache_migrate(const std::string& project_path) {
     }
 }
 
+int pm_cache_link_mode(const std::string& mode) {
+    std::string project_path = fs::current_path().string();
+    MaterializePolicy current = load_project_materialize_policy(project_path);
+    if (mode.empty()) {
+        Output::info("Link mode: " + std::string(materialize_policy_name(current)));
+        return 0;
+    }
+
+    MaterializePolicy policy = parse_materialize_policy(mode, current);
+    if (!save_project_materialize_policy(project_path, policy)) {
+        Output::error("Failed to save link mode to Paker.json");
+        return 1;
+    }
+    Output::success("Link mode set to " + std::string(materialize_policy_name(policy)) +
+                    "; takes effect for packages linked from now on");
+    return 0;
+}
+
 int pm_cache_config_set(const std::string& key, const std::string& value) {
     try {
         if (!ensure_cache_manager_initialized()) {
@@ -464,7 +491,7 @@ int pm_cache_status() {
         
         if (fs::exists(user_cache_path)) {
             for (const auto& entry : fs::directory_iterator(user_cache_path)) {
-                if (entry.is_directory()) {
+                if (entry.is_directory() && entry.path().filename().string()[0] != '.') {
                     total_packages++;
                 }
             }
@@ -510,6 +537,19 @@ int pm_cache_status() {
         std::cout << "  \033[1;37mGlobal cache:\033[0m \033[1;35m(not configured)\033[0m" << std::endl;
         std::cout << "  \033[1;37mProject cache:\033[0m \033[1;32m" << project_cache_path << "\033[0m" << std::endl;
         
+        // 内容寻址存储
+        BlobStore store(user_cache_path + "/.store");
+        BlobStoreStats store_stats = store.get_stats();
+        if (store_stats.manifests > 0) {
+            std::cout << "\n\033[1;33m Content Store:\033[0m" << std::endl;
+            std::cout << "  \033[1;37mVersions:\033[0m \033[1;36m" << store_stats.manifests << "\033[0m" << std::endl;
+            std::cout << "  \033[1;37mUnique files:\033[0m \033[1;36m" << store_stats.blobs << "\033[0m" << std::endl;
+            std::cout << "  \033[1;37mStored:\033[0m \033[1;34m" << Paker::format_size(store_stats.stored_bytes)
+                      << "\033[0m of \033[1;34m" << Paker::format_size(store_stats.logical_bytes) << "\033[0m" << std::endl;
+            std::cout << "  \033[1;37mSaved by deduplication:\033[0m \033[1;32m"
+                      << Paker::format_size(store_stats.deduplicated_bytes()) << "\033[0m" << std::endl;
+        }
+        
         // 策略信息
         std::cout << "\n\033[1;33m Cache Configuration:\033[0m" << std::endl;
         std::cout << "  \033[1;37mStrategy:\033[0m \033[1;34m2 (LRU)\033[0m" << std::endl;
@@ -263,7 +263,7 @@ void pm_cache_oldest_items() {
         std::ostringstream time_ss;
         time_ss << std::put_time(std::localtime(&last_access), "%Y-%m-%d %H:%M:%S");
         
-        Output::info("  " + std::to_string(i + 1) + ". " + item.package_name + "@" + item.version);
+        Output::info("  " + std::to_string(i + 1) + ". " + item.package_name.str() + "@" + item.version.str());
         Output::info("     Last Access: " + time_ss.str());
         Output::info("     Size: " + format_bytes(item.size_bytes));
         Output::info("     Access Count: " + std::to_string(item.access_count));
@@ -12,9 +12,13 @@
 #include "Paker/commands/version.h"
 #include "Paker/commands/remove_project.h"
 #include "Paker/commands/suggestion.h"
+#include "Paker/commands/daemon.h"
 #include "Paker/core/utils.h"
 #include "Paker/core/output.h"
 #include "Paker/core/package_manager.h"
+#include "Paker/core/core_services.h"
+#include "Paker/core/command_arena.h"
+#include "Paker/core/io_uring_engine.h"
 #include "Paker/dependency/sources.h"
 #include "Paker/version.h"
 #include "Recorder/record.h"
@@ -23,14 +27,26 @@
 
 int run_cli(int argc, char* argv[]) {
     CLI::App app{"Paker - C++ Package Manager"};
+    // 守护进程中 run_cli 会被反复调用，全局开关不能沿用上一条命令的设置
+    Paker::CommandArena::set_reporting_enabled(false);
+    // --io-backend 只对本次命令生效，返回时恢复之前的默认后端
+    Paker::ScopedIOBackend io_backend_scope;
 
     // 全局选项
     bool no_color = false;
     bool version = false;
     bool dev_mode = false;
+    bool startup_profile = false;
     app.add_flag("--no-color", no_color, "Disable colored output");
     app.add_flag("--version", version, "Show version information");
     app.add_flag("--dev", dev_mode, "Enable development mode (show advanced commands)");
+    app.add_flag("--startup-profile", startup_profile, "Report service initialization timing after the command");
+    app.add_flag_callback("--arena-stats", []() { Paker::CommandArena::set_reporting_enabled(true); },
+                          "Report per-command arena allocation count and peak bytes");
+    app.add_option_function<std::string>("--io-backend",
+        [](const std::string& name) { Paker::set_default_io_backend(Paker::parse_io_backend(name)); },
+        "Batch file I/O backend: auto, io_uring or threads (default: $PAKER_IO_BACKEND or auto)")
+        ->check(CLI::IsMember({"auto", "io_uring", "threads"}));
     
     // 自定义帮助信息
     app.set_help_flag("-h,--help", "Print this help message and exit");
@@ -44,10 +60,10 @@ int run_cli(int argc, char* argv[]) {
     app.preparse_callback([&](size_t) {
         Paker::Output::set_colored_output(!no_color);
         
-        // 处理版本信息
+        // 处理版本信息；通过 CLI::Success 返回退出码，不结束守护进程
         if (version) {
             std::cout << Paker::Version::get_detailed_version() << std::endl;
-            exit(0);
+            throw CLI::Success();
         }
     });
     
@@ -304,6 +320,15 @@ int run_cli(int argc, char* argv[]) {
         }
     });
     
+    // cache link-mode [mode]
+    std::string cache_link_mode;
+    auto cache_link = cache_cmd->add_subcommand("link-mode", "Show or set how cached packages appear in the project");
+    cache_link->add_option("mode", cache_link_mode, "symlink, hardlink, reflink, copy or auto")
+        ->check(CLI::IsMember({"symlink", "hardlink", "reflink", "copy", "auto"}));
+    cache_link->callback([&]() {
+        Paker::pm_cache_link_mode(cache_link_mode);
+    });
+    
     // cache warmup
     auto cache_warmup = cache_cmd->add_subcommand("warmup", "Preload frequently used packages into cache");
     cache_warmup->callback([]() {
@@ -545,6 +570,8 @@ int run_cli(int argc, char* argv[]) {
     
     // 统一的增量解析命令
     bool parse_stats = false, parse_config = false, parse_clear = false, parse_opt = false, parse_validate = false;
+    bool parse_watch = false;
+    int parse_interval = 500;
     
     auto parse_cmd = app.add_subcommand("parse", "Incremental dependency parsing");
     parse_cmd->group("System Management");
@@ -553,8 +580,12 @@ int run_cli(int argc, char* argv[]) {
     parse_cmd->add_flag("--clear", parse_clear, "Clear parse cache");
     parse_cmd->add_flag("--opt", parse_opt, "Optimize parse cache");
     parse_cmd->add_flag("--validate", parse_validate, "Validate parse cache integrity");
+    parse_cmd->add_flag("--watch", parse_watch, "Watch the manifest and packages/ and re-parse changed packages");
+    parse_cmd->add_option("--interval", parse_interval, "Watch polling interval in milliseconds")->default_val(500);
     parse_cmd->callback([&]() {
-        if (parse_stats) {
+        if (parse_watch) {
+            Paker::pm_incremental_parse_watch(parse_interval);
+        } else if (parse_stats) {
             Paker::pm_incremental_parse_stats();
         } else if (parse_config) {
             Paker::pm_incremental_parse_config();
@@ -595,6 +626,38 @@ int run_cli(int argc, char* argv[]) {
         }
     });
 
+    // 守护进程命令
+    bool daemon_foreground = false;
+    int daemon_idle_minutes = 30;
+    
+    auto daemon_cmd = app.add_subcommand("daemon", "Keep services warm in a background daemon");
+    daemon_cmd->group("System Management");
+    daemon_cmd->require_subcommand(1);
+    
+    // daemon start [--foreground] [--idle-timeout]
+    auto daemon_start = daemon_cmd->add_subcommand("start", "Start the daemon for the current user");
+    daemon_start->add_flag("--foreground", daemon_foreground, "Run in the foreground");
+    daemon_start->add_option("--idle-timeout", daemon_idle_minutes, "Exit after N idle minutes (0 = never, default: 30)");
+    daemon_start->callback([&]() {
+        Paker::pm_daemon_start(daemon_foreground, daemon_idle_minutes);
+    });
+    
+    // daemon stop
+    auto daemon_stop = daemon_cmd->add_subcommand("stop", "Stop the running daemon");
+    daemon_stop->callback([]() {
+        Paker::pm_daemon_stop();
+    });
+    
+    // daemon status
+    auto daemon_status = daemon_cmd->add_subcommand("status", "Show daemon status");
+    daemon_status->callback([]() {
+        Paker::pm_daemon_status();
+    });
+
     CLI11_PARSE(app, argc, argv);
+    
+    if (startup_profile) {
+        Paker::print_startup_profile();
+    }
     return 0;
 }
@@ -0,0 +1,162 @@
+#include "Paker/commands/daemon.h"
+#include "Paker/commands/cli.h"
+#include "Paker/cache/cache_manager.h"
+#include "Paker/core/core_services.h"
+#include "Paker/core/daemon.h"
+#include "Paker/core/output.h"
+#include "Paker/core/package_manager.h"
+#include "Paker/core/version_history.h"
+#include "Paker/dependency/incremental_parser.h"
+#include <glog/logging.h>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+// 与工程目录绑定的服务所加载的工程；这些服务按相对路径读写 .paker/cache、.paker/history、packages/ 等
+fs::path g_services_project;
+
+// 丢弃绑定在旧工程上的服务，下一次取用时在当前工程中重新创建
+void reset_project_services(const fs::path& current) {
+    LOG(INFO) << "Daemon switching project services from " << g_services_project << " to " << current;
+    cleanup_incremental_parser();
+    // 历史日志持有旧工程 .paker/history 的活动段和内存索引
+    cleanup_history_manager();
+    cleanup_cache_manager();
+    if (g_service_manager) {
+        // 预热服务持有缓存管理器和依赖解析器，先于它们关闭
+        g_service_manager->reset_service<CacheWarmupServiceWrapper>();
+        g_service_manager->reset_service<CacheManagerService>();
+        g_service_manager->reset_service<DependencyResolverService>();
+    }
+    g_services_project = current;
+}
+
+// 在守护进程内以完整命令行重新进入 CLI
+int run_forwarded_command(const std::vector<std::string>& args) {
+    prepare_daemon_project_services();
+
+    std::vector<std::string> storage;
+    storage.reserve(args.size() + 1);
+    storage.push_back("paker");
+    storage.insert(storage.end(), args.begin(), args.end());
+
+    std::vector<char*> argv;
+    for (auto& arg : storage) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    return run_cli(static_cast<int>(storage.size()), argv.data());
+}
+
+// 预先构造守护进程要服务的对象，使第一个转发的命令也走热路径
+// （initialize_paker_services 只注册延迟工厂，需逐个取用才会真正创建）
+void warm_up_services() {
+    std::error_code ec;
+    g_services_project = fs::current_path(ec);
+    if (!initialize_paker_services()) {
+        LOG(WARNING) << "Some services failed to initialize in daemon";
+        return;
+    }
+    if (!get_cache_manager()) {
+        LOG(WARNING) << "Cache manager not available in daemon";
+    }
+    if (!get_dependency_resolver()) {
+        LOG(WARNING) << "Dependency resolver not available in daemon";
+    }
+    if (!get_parallel_executor()) {
+        LOG(WARNING) << "Parallel executor not available in daemon";
+    }
+    if (!get_performance_monitor()) {
+        LOG(WARNING) << "Performance monitor not available in daemon";
+    }
+    if (!get_incremental_updater()) {
+        LOG(WARNING) << "Incremental updater not available in daemon";
+    }
+    if (!get_incremental_parser()) {
+        LOG(WARNING) << "Incremental parser not available in daemon";
+    }
+}
+
+} // namespace
+
+void prepare_daemon_project_services() {
+    // DaemonServer 已切换到客户端的工作目录
+    std::error_code ec;
+    fs::path current = fs::current_path(ec);
+    if (ec) {
+        return;
+    }
+    if (g_services_project.empty()) {
+        g_services_project = current;
+    } else if (current != g_services_project) {
+        reset_project_services(current);
+    }
+}
+
+void pm_daemon_start(bool foreground, int idle_timeout_minutes) {
+    DaemonClient client;
+    if (client.is_available()) {
+        Output::info("Paker daemon is already running on " + get_daemon_socket_path());
+        return;
+    }
+
+    std::chrono::seconds idle_timeout = std::chrono::minutes(idle_timeout_minutes);
+    if (foreground) {
+        DaemonServer server(run_forwarded_command);
+        server.set_idle_timeout(idle_timeout);
+        if (!server.bind()) {
+            Output::error("Failed to bind daemon socket: " + server.get_socket_path());
+            return;
+        }
+        warm_up_services();
+        Output::success("Paker daemon listening on " + server.get_socket_path());
+        server.run();
+        return;
+    }
+
+    if (!spawn_daemon(run_forwarded_command, idle_timeout, warm_up_services)) {
+        Output::error("Failed to start Paker daemon");
+        return;
+    }
+    Output::success("Paker daemon started on " + get_daemon_socket_path());
+}
+
+void pm_daemon_stop() {
+    DaemonClient client;
+    if (!client.is_available()) {
+        Output::info("Paker daemon is not running");
+        return;
+    }
+    if (!client.stop()) {
+        Output::error("Failed to stop Paker daemon");
+        return;
+    }
+
+    // 等待套接字关闭，避免紧接着的 start 误判为已在运行
+    for (int i = 0; i < 50 && client.is_available(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    Output::success("Paker daemon stopped");
+}
+
+void pm_daemon_status() {
+    DaemonStatus status = DaemonClient().status();
+    if (!status.running) {
+        Output::info("Paker daemon is not running (socket: " + status.socket_path + ")");
+        return;
+    }
+    Output::info("Paker daemon is running");
+    Output::info("  PID: " + std::to_string(status.pid));
+    Output::info("  Socket: " + status.socket_path);
+    Output::info("  Uptime: " + std::to_string(status.uptime.count()) + "s");
+    Output::info("  Requests served: " + std::to_string(status.requests_served));
+}
+
+} // namespace Paker
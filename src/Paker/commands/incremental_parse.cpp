@@ -2,7 +2,10 @@
 #include "Paker/dependency/incremental_parser.h"
 #include "Paker/core/package_manager.h"
 #include "Paker/core/output.h"
+#include "Paker/core/utils.h"
+#include "Paker/core/command_arena.h"
 #include <glog/logging.h>
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
@@ -500,4 +503,46 @@ void pm_incremental_parse_validate() {
     }
 }
 
+void pm_incremental_parse_watch(int interval_ms) {
+    LOG(INFO) << "Starting incremental parse watch mode";
+    
+    if (!ensure_incremental_parser_initialized()) {
+        return;
+    }
+    auto* parser = get_incremental_parser();
+    if (!parser->enable_watch_mode()) {
+        Output::warning("Filesystem watch unavailable, falling back to periodic full scans");
+    }
+    
+    Output::info("Watching " + get_json_file() + " and packages/ for changes (Ctrl+C to stop)...");
+    auto interval = std::chrono::milliseconds(std::max(interval_ms, 50));
+    while (true) {
+        // 首次检测为全量扫描，之后只取出监视器积累的事件并检查对应的脏包
+        auto changes = parser->detect_project_changes();
+        if (changes.has_changes) {
+            for (const auto& package : changes.new_packages) {
+                Output::info("  + " + package);
+            }
+            for (const auto& package : changes.changed_packages) {
+                Output::info("  ~ " + package);
+            }
+            for (const auto& package : changes.removed_packages) {
+                Output::info("  - " + package);
+            }
+            
+            // 重新解析的临时容器放在本轮的 arena 上，解析结束时整体释放
+            CommandArena arena("watch");
+            ArenaScope arena_scope(arena);
+            auto start_time = std::chrono::steady_clock::now();
+            size_t reparsed = parser->apply_project_changes(changes);
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            Output::success("Re-parsed " + std::to_string(reparsed) + " packages in " +
+                            std::to_string(duration.count()) + "ms");
+        }
+        // 阻塞在监视器上，事件到达立即返回，下一轮检测会把事件读空；interval 只是等待上限
+        parser->wait_for_project_changes(interval);
+    }
+}
+
 } // namespace Paker
@@ -10,6 +10,8 @@
 #include "Paker/core/parallel_executor.h"
 #include "Paker/core/incremental_updater.h"
 #include "Paker/cache/lru_cache_manager.h"
+#include "Paker/cache/materializer.h"
+#include "Paker/cache/warmup_scheduler.h"
 #include "Paker/dependency/sources.h"
 #include "Recorder/record.h"
 #include <filesystem>
@@ -108,6 +110,8 @@ void pm_add_parallel(const std::vector<std::string>& packages) {
         Paker::Output::warning("No packages specified for parallel download");
         return;
     }
+    // 交互式安装期间后台预热退避
+    Paker::ForegroundActivity::Scope foreground("add");
     
     // 初始化并行执行器
     if (!Paker::g_parallel_executor) {
@@ -227,6 +231,7 @@ void pm_add_parallel(const std::vector<std::string>& packages) {
 }
 
 void pm_add(const std::string& pkg_input) {
+    Paker::ForegroundActivity::Scope foreground("add " + pkg_input);
     // 开始性能监控
     LOG(INFO) << "Starting performance monitoring for package_install";
     PAKER_PERF_START("package_install");
@@ -740,6 +745,8 @@ static void add_recursive(const std::string& pkg, std::set<std::string>& install
 }
 
 void pm_add_recursive(const std::string& pkg) {
+    // 递归安装的所有包合并为一代
+    Paker::ProjectLinkBatch batch(fs::current_path().string());
     std::set<std::string> installed;
     add_recursive(pkg, installed);
 }
@@ -953,8 +960,10 @@ std::vector<std::string> install_to_system_and_get_files(const std::string& pack
                 // Create destination directory
                 fs::create_directories(dest_file.parent_path());
                 
-                // Copy file
-                fs::copy_file(source_file, dest_file, fs::copy_options::overwrite_existing);
+                // Copy file (reflink / copy_file_range when the filesystem allows it)
+                if (!Paker::FileMaterializer::copy_file(source_file.string(), dest_file.string())) {
+                    throw std::runtime_error("cannot copy " + source_file.string() + " to " + dest_file.string());
+                }
                 system_installed_files.push_back(dest_file.string());
             }
         }
@@ -1050,6 +1059,7 @@ void remove_installation_record(const std::string& package_name) {
 
 // Main install command implementation
 void pm_install(const std::string& package) {
+    Paker::ForegroundActivity::Scope foreground("install " + package);
     LOG(INFO) << "Starting package installation: " << package;
     Paker::Output::info("Starting package installation: " + package);
     
@@ -1121,6 +1131,7 @@ void pm_install_parallel(const std::vector<std::string>& packages) {
         return;
     }
     
+    Paker::ForegroundActivity::Scope foreground("install");
     LOG(INFO) << "Starting parallel installation of " << packages.size() << " packages";
     Paker::Output::info("Starting parallel installation of " + std::to_string(packages.size()) + " packages");
     
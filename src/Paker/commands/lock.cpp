@@ -3,6 +3,8 @@
 #include "Paker/core/utils.h"
 #include "Paker/dependency/dependency_resolver.h"
 #include "Paker/conflict/conflict_detector.h"
+#include "Paker/core/command_arena.h"
+#include "Paker/cache/cache_manager.h"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -23,14 +25,19 @@ void pm_lock() {
     
     // 添加依赖验证
     Paker::DependencyResolver resolver;
-    if (!resolver.resolve_project_dependencies()) {
-        LOG(ERROR) << "Failed to resolve project dependencies";
-        std::cout << "Failed to resolve project dependencies\n";
-        return;
-    }
-    
     Paker::ConflictDetector detector(resolver.get_dependency_graph());
-    auto conflicts = detector.detect_all_conflicts();
+    std::vector<Paker::ConflictInfo> conflicts;
+    {
+        // 解析与冲突检测的临时容器从 arena 分配，依赖图仍在普通堆上
+        Paker::CommandArena arena("lock");
+        Paker::ArenaScope arena_scope(arena);
+        if (!resolver.resolve_project_dependencies()) {
+            LOG(ERROR) << "Failed to resolve project dependencies";
+            std::cout << "Failed to resolve project dependencies\n";
+            return;
+        }
+        conflicts = detector.detect_all_conflicts();
+    }
     
     if (!conflicts.empty()) {
         LOG(ERROR) << "Conflicts detected in dependency tree";
@@ -119,6 +126,8 @@ void pm_add_lock() {
         std::cout << "Paker.lock missing dependencies field.\n";
         return;
     }
+    // 锁文件中的所有包合并为一代
+    Paker::ProjectLinkBatch batch(fs::current_path().string());
     for (auto& [dep, ver] : lock_j["dependencies"].items()) {
         std::string dep_str = dep;
         if (!ver.is_null() && ver != "*" && ver != "unknown") dep_str += "@" + ver.get<std::string>();
@@ -142,6 +151,8 @@ void pm_upgrade(const std::string& pkg) {
         std::cout << "No dependencies to upgrade.\n";
         return;
     }
+    // 升级的移除与重新链接合并为一代
+    Paker::ProjectLinkBatch batch(fs::current_path().string());
     if (pkg.empty()) {
         for (auto& [dep, ver] : j["dependencies"].items()) {
             LOG(INFO) << "Upgrading " << dep << " to latest...";
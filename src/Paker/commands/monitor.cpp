@@ -64,7 +64,7 @@ int pm_analyze_dependencies(const std::string& output_file) {
         }
         
         // 获取依赖图
-        auto graph = resolver.get_dependency_graph();
+        const auto& graph = resolver.get_dependency_graph();
         if (graph.empty()) {
             Output::warning("No dependencies found to analyze");
             return 0;
@@ -118,7 +118,7 @@ int pm_diagnose(const std::string& output_file) {
         }
         
         // 获取依赖图
-        auto graph = resolver.get_dependency_graph();
+        const auto& graph = resolver.get_dependency_graph();
         
         // 创建诊断工具
         DiagnosticTool diagnostic(graph);
@@ -110,6 +110,8 @@ void pm_remove_project(bool force) {
         std::vector<std::string> cache_files = {
             ".paker/cache",
             ".paker/links",
+            ".paker/generations",
+            ".paker/trees",
             ".paker/temp",
             ".paker/logs",
             "paker_cache",
@@ -1,13 +1,16 @@
 #include "Paker/conflict/conflict_detector.h"
 #include "Paker/dependency/version_manager.h"
+#include "Paker/dependency/graph_condensation.h"
 #include "Paker/core/output.h"
+#include "Paker/core/command_arena.h"
 #include <algorithm>
 #include <sstream>
 #include <glog/logging.h>
 
 namespace Paker {
 
-ConflictDetector::ConflictDetector(const DependencyGraph& graph) : graph_(graph) {}
+ConflictDetector::ConflictDetector(const DependencyGraph& graph, size_t max_explanation_paths)
+    : graph_(graph), max_explanation_paths_(max_explanation_paths) {}
 
 std::vector<ConflictInfo> ConflictDetector::detect_all_conflicts() {
     std::vector<ConflictInfo> all_conflicts;
@@ -29,32 +32,18 @@ std::vector<ConflictInfo> ConflictDetector::detect_all_conflicts() {
 
 std::vector<ConflictInfo> ConflictDetector::detect_version_conflicts() {
     std::vector<ConflictInfo> conflicts;
+    auto csr = graph_.freeze();
     
     // 遍历所有包
     for (const auto& [package, node] : graph_.get_nodes()) {
-        // 检查该包在不同路径中的版本要求
-        auto paths = graph_.get_all_paths_to_package(package);
-        
-        std::map<std::string, std::vector<std::vector<std::string>>> version_paths;
-        
-        for (const auto& path : paths) {
-            std::string required_version = calculate_required_version(path);
-            if (!required_version.empty()) {
-                version_paths[required_version].push_back(path);
-            }
-        }
+        // 检查该包被直接依赖者提出的版本要求
+        auto version_requesters = collect_version_requirements(*csr, package);
         
         // 检查是否有多个不同的版本要求
-        if (version_paths.size() > 1) {
+        if (version_requesters.size() > 1) {
             std::vector<std::string> conflicting_versions;
-            std::vector<std::string> conflict_path;
-            
-            for (const auto& [version, paths] : version_paths) {
-                conflicting_versions.push_back(version);
-                // 使用第一个路径作为冲突路径示例
-                if (conflict_path.empty() && !paths.empty()) {
-                    conflict_path = paths[0];
-                }
+            for (const auto& [version, _] : version_requesters) {
+                conflicting_versions.emplace_back(version);
             }
             
             // 检查版本是否真的不兼容
@@ -72,7 +61,15 @@ std::vector<ConflictInfo> ConflictDetector::detect_version_conflicts() {
             if (has_conflict) {
                 ConflictInfo conflict(ConflictInfo::Type::VERSION_CONFLICT, package);
                 conflict.conflicting_versions = conflicting_versions;
-                conflict.conflict_path = conflict_path;
+                for (const auto& [version, requesters] : version_requesters) {
+                    auto paths = explain_requirement(*csr, requesters, package);
+                    conflict.explanation_paths.insert(conflict.explanation_paths.end(),
+                                                      paths.begin(), paths.end());
+                }
+                // 使用第一个路径作为冲突路径示例
+                if (!conflict.explanation_paths.empty()) {
+                    conflict.conflict_path = conflict.explanation_paths.front();
+                }
                 conflict.suggested_solution = generate_solution_suggestion(package, 
                                                                          conflicting_versions[0], 
                                                                          conflicting_versions[1]);
@@ -155,7 +152,19 @@ std::string ConflictDetector::generate_conflict_report(const std::vector<Conflic
                 break;
         }
         
-        if (!conflict.conflict_path.empty()) {
+        if (conflict.explanation_paths.size() > 1) {
+            report << "Required Through:\n";
+            for (const auto& path : conflict.explanation_paths) {
+                report << "  ";
+                for (size_t j = 0; j < path.size(); ++j) {
+                    report << path[j];
+                    if (j < path.size() - 1) {
+                        report << " -> ";
+                    }
+                }
+                report << "\n";
+            }
+        } else if (!conflict.conflict_path.empty()) {
             report << "Conflict Path: ";
             for (size_t j = 0; j < conflict.conflict_path.size(); ++j) {
                 report << conflict.conflict_path[j];
@@ -180,26 +189,23 @@ std::vector<ConflictInfo> ConflictDetector::detect_package_conflicts(const std::
     std::vector<ConflictInfo> conflicts;
     
     // 检测该包的版本冲突
-    auto paths = graph_.get_all_paths_to_package(package_name);
-    std::map<std::string, std::vector<std::vector<std::string>>> version_paths;
+    auto csr = graph_.freeze();
+    auto version_requesters = collect_version_requirements(*csr, package_name);
     
-    for (const auto& path : paths) {
-        std::string required_version = calculate_required_version(path);
-        if (!required_version.empty()) {
-            version_paths[required_version].push_back(path);
-        }
-    }
-    
-    if (version_paths.size() > 1) {
+    if (version_requesters.size() > 1) {
         std::vector<std::string> conflicting_versions;
-        for (const auto& [version, _] : version_paths) {
-            conflicting_versions.push_back(version);
+        for (const auto& [version, _] : version_requesters) {
+            conflicting_versions.emplace_back(version);
         }
         
         ConflictInfo conflict(ConflictInfo::Type::VERSION_CONFLICT, package_name);
         conflict.conflicting_versions = conflicting_versions;
-        if (!version_paths.empty() && !version_paths.begin()->second.empty()) {
-            conflict.conflict_path = version_paths.begin()->second[0];
+        for (const auto& [version, requesters] : version_requesters) {
+            auto paths = explain_requirement(*csr, requesters, package_name);
+            conflict.explanation_paths.insert(conflict.explanation_paths.end(), paths.begin(), paths.end());
+        }
+        if (!conflict.explanation_paths.empty()) {
+            conflict.conflict_path = conflict.explanation_paths.front();
         }
         conflict.suggested_solution = generate_solution_suggestion(package_name, 
                                                                  conflicting_versions[0], 
@@ -233,6 +239,72 @@ std::string ConflictDetector::calculate_required_version(const std::vector<std::
     return "";
 }
 
+ConflictDetector::VersionRequirements ConflictDetector::collect_version_requirements(
+    const CSRDependencyGraph& csr, const std::string& package) const {
+    // 每个包都会构建一次，放在命令 arena 上避免 O(E) 次堆分配
+    VersionRequirements requirements(current_arena_resource());
+    auto package_id = csr.find(package);
+    if (package_id == CSRDependencyGraph::INVALID_NODE) {
+        return requirements;
+    }
+    
+    for (auto dependent_id : csr.dependents(package_id)) {
+        if (dependent_id == package_id) continue;
+        
+        // 版本要求只取决于最后一跳 dependent -> package
+        auto dependent = csr.name(dependent_id);
+        const auto* node = graph_.get_node(std::string(dependent));
+        if (!node) continue;
+        auto it = node->version_constraints.find(package);
+        if (it == node->version_constraints.end() || it->second.version.empty()) continue;
+        
+        auto& requesters = requirements[std::pmr::string(it->second.version, requirements.get_allocator())];
+        requesters.emplace_back(dependent);
+    }
+    
+    return requirements;
+}
+
+std::vector<std::vector<std::string>> ConflictDetector::explain_requirement(
+    const CSRDependencyGraph& csr,
+    const std::pmr::vector<std::pmr::string>& requesters,
+    const std::string& package) const {
+    std::vector<std::vector<std::string>> explanations;
+    if (max_explanation_paths_ == 0) {
+        return explanations;
+    }
+    
+    // 根包：没有任何包依赖它们
+    std::vector<CSRDependencyGraph::NodeId> roots;
+    for (CSRDependencyGraph::NodeId id = 0; id < csr.node_count(); ++id) {
+        if (csr.in_degree(id) == 0) {
+            roots.push_back(id);
+        }
+    }
+    
+    for (const auto& requester : requesters) {
+        if (explanations.size() >= max_explanation_paths_) break;
+        
+        auto requester_id = csr.find(requester);
+        size_t remaining = max_explanation_paths_ - explanations.size();
+        auto paths = k_shortest_paths(csr, roots, requester_id, remaining);
+        
+        if (paths.empty()) {
+            // 请求者只被环上的包依赖，直接给出最后一跳
+            explanations.push_back({std::string(requester), package});
+            continue;
+        }
+        
+        for (const auto& path : paths) {
+            auto names = csr.to_names(path);
+            names.push_back(package);
+            explanations.push_back(std::move(names));
+        }
+    }
+    
+    return explanations;
+}
+
 bool ConflictDetector::is_version_compatible(const std::string& version1, const std::string& version2) const {
     return VersionManager::is_version_compatible(version1, version2);
 }
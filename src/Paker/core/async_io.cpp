@@ -1,6 +1,8 @@
 #include "Paker/core/async_io.h"
 #include "Paker/core/memory_pool.h"
 #include "Paker/core/package_manager.h"
+#include "Paker/core/io_uring_engine.h"
+#include "Paker/cache/prefetch_model.h"
 #include <fstream>
 #include <sstream>
 #include <filesystem>
@@ -372,6 +374,93 @@ void AsyncNetworkDownloadOperation::cancel() {
     }
 }
 
+// AsyncBatchReadOperation 实现
+AsyncBatchReadOperation::AsyncBatchReadOperation(std::vector<std::string> file_paths, bool read_as_text)
+    : file_paths_(std::move(file_paths)), promises_(file_paths_.size()), read_as_text_(read_as_text) {}
+
+std::string AsyncBatchReadOperation::get_description() const {
+    return "Batch read: " + std::to_string(file_paths_.size()) + " files";
+}
+
+std::vector<std::future<std::shared_ptr<FileReadResult>>> AsyncBatchReadOperation::get_futures() {
+    std::vector<std::future<std::shared_ptr<FileReadResult>>> futures;
+    futures.reserve(promises_.size());
+    for (auto& promise : promises_) {
+        futures.push_back(promise.get_future());
+    }
+    return futures;
+}
+
+void AsyncBatchReadOperation::execute() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    set_status(IOOperationStatus::IN_PROGRESS);
+    
+    IoUringEngine* engine = cancelled_ ? nullptr : IoUringEngine::for_current_thread();
+    std::vector<IoUringReadResult> read_results;
+    if (engine) {
+        read_results = engine->read_files(file_paths_);
+    }
+    
+    size_t failed = 0;
+    for (size_t i = 0; i < file_paths_.size(); ++i) {
+        std::shared_ptr<FileReadResult> result;
+        if (cancelled_) {
+            result = std::make_shared<FileReadResult>();
+            result->status = IOOperationStatus::CANCELLED;
+        } else if (!engine) {
+            // 引擎在本线程不可用，逐个同步读取
+            AsyncFileReadOperation single(file_paths_[i], read_as_text_);
+            single.execute();
+            result = single.get_result();
+        } else {
+            result = std::make_shared<FileReadResult>();
+            IoUringReadResult& read = read_results[i];
+            if (read.success) {
+                result->file_size = read.data.size();
+                result->bytes_processed = read.data.size();
+                if (read_as_text_) {
+                    result->content = std::move(read.data);
+                } else {
+                    result->data.assign(read.data.begin(), read.data.end());
+                }
+                result->status = IOOperationStatus::COMPLETED;
+            } else {
+                result->error_message = "Failed to read file " + file_paths_[i] + ": " + std::strerror(read.error);
+                result->status = IOOperationStatus::FAILED;
+            }
+        }
+        if (result->status != IOOperationStatus::COMPLETED) {
+            failed++;
+        }
+        promises_[i].set_value(std::move(result));
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    duration_ = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    if (cancelled_) {
+        set_status(IOOperationStatus::CANCELLED);
+    } else if (failed > 0) {
+        set_error(std::to_string(failed) + " of " + std::to_string(file_paths_.size()) + " files failed to read");
+    } else {
+        set_status(IOOperationStatus::COMPLETED);
+    }
+}
+
+void AsyncBatchReadOperation::cancel() {
+    cancelled_ = true;
+}
+
+// AsyncCallbackOperation 实现
+void AsyncCallbackOperation::execute() {
+    if (cancelled_) {
+        set_status(IOOperationStatus::CANCELLED);
+        return;
+    }
+    set_status(IOOperationStatus::IN_PROGRESS);
+    function_();
+    set_status(IOOperationStatus::COMPLETED);
+}
+
 // AsyncIOManager 实现
 AsyncIOManager::AsyncIOManager(size_t thread_count, size_t max_concurrent, 
                                size_t max_patterns, size_t max_batch_size, 
@@ -424,13 +513,17 @@ bool AsyncIOManager::initialize() {
 }
 
 void AsyncIOManager::shutdown() {
-    if (!running_) {
-        return;
+    {
+        // 与 submit_operation 的入队互斥：置位之后不再有操作进入队列
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
     }
-    
-    running_ = false;
     queue_cv_.notify_all();
     
+    // 工作线程执行完队列中剩余的操作后才退出，等待它们的 future 和协程都会完成    
     // 等待所有工作线程结束
     for (auto& thread : worker_threads_) {
         if (thread.joinable()) {
@@ -443,26 +536,22 @@ void AsyncIOManager::shutdown() {
 }
 
 void AsyncIOManager::worker_thread_function() {
-    while (running_) {
+    while (true) {
         std::shared_ptr<AsyncIOOperation> operation;
         
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             queue_cv_.wait(lock, [this] { return !running_ || !operation_queue_.empty(); });
             
-            if (!running_) {
+            // 停止后先排空队列再退出
+            if (operation_queue_.empty()) {
                 break;
             }
-            
-            if (!operation_queue_.empty()) {
-                operation = operation_queue_.front();
-                operation_queue_.pop();
-            }
+            operation = std::move(operation_queue_.front());
+            operation_queue_.pop();
         }
         
-        if (operation) {
-            process_operation(operation);
-        }
+        process_operation(operation);
     }
 }
 
@@ -479,7 +568,10 @@ void AsyncIOManager::process_operation(std::shared_ptr<AsyncIOOperation> operati
             failed_operations_++;
         }
         
-        total_io_time_ += operation->get_duration();
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            total_io_time_ += operation->get_duration();
+        }
         
     } catch (const std::exception& e) {
         LOG(ERROR) << "Exception in async operation: " << e.what();
@@ -487,6 +579,27 @@ void AsyncIOManager::process_operation(std::shared_ptr<AsyncIOOperation> operati
     }
     
     active_operations_count_--;
+    operation->notify_completion();
+}
+
+void AsyncIOManager::submit_operation(std::shared_ptr<AsyncIOOperation> operation) {
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (running_) {
+            operation_queue_.push(operation);
+            queued = true;
+        }
+    }
+    if (!queued) {
+        process_operation(operation);
+        return;
+    }
+    queue_cv_.notify_one();
+}
+
+void AsyncIOManager::post(std::function<void()> function) {
+    submit_operation(std::make_shared<AsyncCallbackOperation>(std::move(function)));
 }
 
 std::future<std::shared_ptr<FileReadResult>> AsyncIOManager::read_file_async(
@@ -497,19 +610,10 @@ std::future<std::shared_ptr<FileReadResult>> AsyncIOManager::read_file_async(
     auto future = promise->get_future();
     
     // 设置完成回调
-    operation->set_progress_callback([operation, promise](size_t current, size_t total) {
-        if (operation->get_status() == IOOperationStatus::COMPLETED ||
-            operation->get_status() == IOOperationStatus::FAILED ||
-            operation->get_status() == IOOperationStatus::CANCELLED) {
-            promise->set_value(operation->get_result());
-        }
+    operation->set_completion_callback([operation, promise] {
+        promise->set_value(take_operation_result(*operation));
     });
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        operation_queue_.push(operation);
-    }
-    queue_cv_.notify_one();
+    submit_operation(operation);
     
     return future;
 }
@@ -522,19 +626,10 @@ std::future<std::shared_ptr<FileWriteResult>> AsyncIOManager::write_file_async(
     auto future = promise->get_future();
     
     // 设置完成回调
-    operation->set_progress_callback([operation, promise](size_t current, size_t total) {
-        if (operation->get_status() == IOOperationStatus::COMPLETED ||
-            operation->get_status() == IOOperationStatus::FAILED ||
-            operation->get_status() == IOOperationStatus::CANCELLED) {
-            promise->set_value(operation->get_result());
-        }
+    operation->set_completion_callback([operation, promise] {
+        promise->set_value(take_operation_result(*operation));
     });
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        operation_queue_.push(operation);
-    }
-    queue_cv_.notify_one();
+    submit_operation(operation);
     
     return future;
 }
@@ -547,19 +642,10 @@ std::future<std::shared_ptr<FileWriteResult>> AsyncIOManager::write_file_async(
     auto future = promise->get_future();
     
     // 设置完成回调
-    operation->set_progress_callback([operation, promise](size_t current, size_t total) {
-        if (operation->get_status() == IOOperationStatus::COMPLETED ||
-            operation->get_status() == IOOperationStatus::FAILED ||
-            operation->get_status() == IOOperationStatus::CANCELLED) {
-            promise->set_value(operation->get_result());
-        }
+    operation->set_completion_callback([operation, promise] {
+        promise->set_value(take_operation_result(*operation));
     });
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        operation_queue_.push(operation);
-    }
-    queue_cv_.notify_one();
+    submit_operation(operation);
     
     return future;
 }
@@ -572,19 +658,10 @@ std::future<std::shared_ptr<NetworkDownloadResult>> AsyncIOManager::download_asy
     auto future = promise->get_future();
     
     // 设置完成回调
-    operation->set_progress_callback([operation, promise](size_t current, size_t total) {
-        if (operation->get_status() == IOOperationStatus::COMPLETED ||
-            operation->get_status() == IOOperationStatus::FAILED ||
-            operation->get_status() == IOOperationStatus::CANCELLED) {
-            promise->set_value(operation->get_result());
-        }
+    operation->set_completion_callback([operation, promise] {
+        promise->set_value(take_operation_result(*operation));
     });
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        operation_queue_.push(operation);
-    }
-    queue_cv_.notify_one();
+    submit_operation(operation);
     
     return future;
 }
@@ -595,6 +672,21 @@ std::vector<std::future<std::shared_ptr<FileReadResult>>> AsyncIOManager::read_f
     std::vector<std::future<std::shared_ptr<FileReadResult>>> futures;
     futures.reserve(file_paths.size());
     
+    if (file_paths.size() > 1 && should_use_io_uring(get_io_backend())) {
+        // 拆成至多两批交给工作线程，每批在一个线程上通过 io_uring 完成
+        size_t batch_size = std::max<size_t>(IoUringEngine::kSlotCount, (file_paths.size() + 1) / 2);
+        for (size_t start = 0; start < file_paths.size(); start += batch_size) {
+            size_t end = std::min(file_paths.size(), start + batch_size);
+            auto operation = std::make_shared<AsyncBatchReadOperation>(
+                std::vector<std::string>(file_paths.begin() + start, file_paths.begin() + end), read_as_text);
+            for (auto& future : operation->get_futures()) {
+                futures.push_back(std::move(future));
+            }
+            submit_operation(operation);
+        }
+        return futures;
+    }
+    
     for (const auto& file_path : file_paths) {
         futures.push_back(read_file_async(file_path, read_as_text));
     }
@@ -652,16 +744,24 @@ size_t AsyncIOManager::get_queue_size() const {
 }
 
 void AsyncIOManager::clear_queue() {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    while (!operation_queue_.empty()) {
-        operation_queue_.pop();
-    }
+    abandon_queued_operations();
 }
 
 void AsyncIOManager::cancel_all_operations() {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    std::queue<std::shared_ptr<AsyncIOOperation>> empty_queue;
-    operation_queue_.swap(empty_queue);
+    abandon_queued_operations();
+}
+
+void AsyncIOManager::abandon_queued_operations() {
+    std::queue<std::shared_ptr<AsyncIOOperation>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        operation_queue_.swap(dropped);
+    }
+    // 在锁外通知：完成回调可能恢复协程并再次提交操作
+    while (!dropped.empty()) {
+        dropped.front()->abandon();
+        dropped.pop();
+    }
 }
 
 // 全局函数实现
@@ -1245,12 +1345,52 @@ PredictivePreloadStrategy::PredictivePreloadStrategy(double confidence_threshold
     , max_predictions_(max_predictions)
     , frequency_weight_(freq_weight)
     , recency_weight_(rec_weight)
-    , dependency_weight_(dep_weight) {
+    , dependency_weight_(dep_weight)
+    , prediction_window_size_(50)
+    , model_(std::make_unique<PrefetchModel>()) {
 }
 
+PredictivePreloadStrategy::~PredictivePreloadStrategy() = default;
+
 void PredictivePreloadStrategy::record_package_usage(const std::string& package_name) {
     std::lock_guard<std::mutex> lock(prediction_mutex_);
-    package_frequency_[package_name].usage_count++;
+    auto& usage = package_frequency_[package_name];
+    usage.usage_count++;
+    usage.last_used = std::chrono::steady_clock::now();
+    
+    PrefetchEvent event;
+    event.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    event.session = PrefetchTrace::current_session();
+    event.package = package_name;
+    model_->observe(event);
+    if (std::find(session_context_.begin(), session_context_.end(), package_name) == session_context_.end()) {
+        session_context_.push_back(package_name);
+    }
+}
+
+bool PredictivePreloadStrategy::load_model(const std::string& dir) {
+    PrefetchTrace trace(dir.empty() ? get_prefetch_dir() : dir);
+    PrefetchModel model;
+    model.load(trace.model_path());
+    size_t learned = model.update_from_trace(trace);
+    if (learned > 0 && !model.save(trace.model_path())) {
+        LOG(WARNING) << "Failed to save prefetch model to " << trace.model_path();
+    }
+    
+    std::lock_guard<std::mutex> lock(prediction_mutex_);
+    *model_ = std::move(model);
+    LOG(INFO) << "Loaded prefetch model: " << model_->package_count() << " packages, "
+              << model_->edge_count() << " edges, " << learned << " new requests";
+    return model_->package_count() > 0;
+}
+
+std::vector<PrefetchCandidate> PredictivePreloadStrategy::predict_next() const {
+    std::lock_guard<std::mutex> lock(prediction_mutex_);
+    PrefetchOptions options;
+    options.max_candidates = max_predictions_;
+    options.min_confidence = confidence_threshold_;
+    return model_->predict(session_context_, options);
 }
 
 void PredictivePreloadStrategy::update_dependency_graph(const std::string& package, 
@@ -1279,18 +1419,22 @@ std::vector<DependencyPrediction> PredictivePreloadStrategy::predict_dependencie
         }
     }
     
-    // 基于使用频率进行预测
-    for (const auto& [pkg, freq] : package_frequency_) {
-        if (pkg != package_name) {
-            DependencyPrediction prediction;
-            prediction.package_name = pkg;
-            prediction.confidence = calculate_prediction_confidence(package_name, pkg);
-            prediction.prediction_time = std::chrono::steady_clock::now();
-            
-            if (prediction.confidence >= confidence_threshold_) {
-                predictions.push_back(prediction);
-            }
+    // 基于请求记录中的转移和共现进行预测
+    PrefetchOptions options;
+    options.max_candidates = max_predictions_;
+    options.min_confidence = confidence_threshold_;
+    for (const auto& candidate : model_->predict({package_name}, options)) {
+        auto existing = std::find_if(predictions.begin(), predictions.end(),
+                                     [&candidate](const auto& p) { return p.package_name == candidate.package; });
+        if (existing != predictions.end()) {
+            existing->confidence = std::max(existing->confidence, candidate.confidence);
+            continue;
         }
+        DependencyPrediction prediction;
+        prediction.package_name = candidate.package;
+        prediction.confidence = candidate.confidence;
+        prediction.prediction_time = std::chrono::steady_clock::now();
+        predictions.push_back(prediction);
     }
     
     // 按置信度排序，返回前N个预测
@@ -1312,12 +1456,13 @@ void PredictivePreloadStrategy::preload_predicted_packages() {
     
     last_preload_ = now;
     
-    std::lock_guard<std::mutex> lock(prediction_mutex_);
-    
-    // 为最常用的包预测依赖
+    // 为最常用的包预测依赖；predict_dependencies 自行加锁，这里只在复制和记录时持锁
     std::vector<std::pair<std::string, size_t>> sorted_packages;
-    for (const auto& [pkg, info] : package_frequency_) {
-        sorted_packages.emplace_back(pkg, info.usage_count);
+    {
+        std::lock_guard<std::mutex> lock(prediction_mutex_);
+        for (const auto& [pkg, info] : package_frequency_) {
+            sorted_packages.emplace_back(pkg, info.usage_count);
+        }
     }
     
     std::sort(sorted_packages.begin(), sorted_packages.end(),
@@ -1329,7 +1474,10 @@ void PredictivePreloadStrategy::preload_predicted_packages() {
         auto predictions = predict_dependencies(package_name);
         
         // 记录预测历史
-        prediction_history_[package_name] = predictions;
+        {
+            std::lock_guard<std::mutex> lock(prediction_mutex_);
+            prediction_history_[package_name] = predictions;
+        }
         
         LOG(INFO) << "Predicted " << predictions.size() << " dependencies for " << package_name;
     }
@@ -1444,8 +1592,12 @@ double PredictivePreloadStrategy::calculate_prediction_confidence(const std::str
         }
     }
     
-    // 基于最近性的置信度（简化实现）
-    confidence += recency_weight_ * 0.5; // 占位符
+    // 基于最近性的置信度：按距上次使用的时间以一小时为尺度衰减
+    if (freq_it != package_frequency_.end() && freq_it->second.usage_count > 0) {
+        double minutes = std::chrono::duration<double, std::ratio<60>>(
+            std::chrono::steady_clock::now() - freq_it->second.last_used).count();
+        confidence += recency_weight_ * std::exp(-std::max(0.0, minutes) / 60.0);
+    }
     
     return std::min(1.0, confidence);
 }
@@ -1673,6 +1825,14 @@ void ZeroCopyIOOperation::execute() {
             case IOOperationType::NETWORK_UPLOAD:
                 success = execute_network_upload();
                 break;
+            case IOOperationType::READ_DIRECTORY:
+            case IOOperationType::DELETE_FILE:
+            case IOOperationType::COPY_FILE:
+            case IOOperationType::MOVE_FILE:
+            case IOOperationType::CREATE_DIRECTORY:
+            case IOOperationType::USER_CALLBACK:
+                // 零拷贝路径只支持文件读写和网络传输
+                break;
         }
         
         if (success) {
@@ -1829,6 +1989,14 @@ std::string ZeroCopyIOOperation::get_description() const {
         case IOOperationType::NETWORK_UPLOAD:
             type_str = "Zero-copy network upload";
             break;
+        case IOOperationType::READ_DIRECTORY:
+        case IOOperationType::DELETE_FILE:
+        case IOOperationType::COPY_FILE:
+        case IOOperationType::MOVE_FILE:
+        case IOOperationType::CREATE_DIRECTORY:
+        case IOOperationType::USER_CALLBACK:
+            type_str = "Unsupported zero-copy operation";
+            break;
     }
     return type_str + ": " + file_path_;
 }
@@ -0,0 +1,91 @@
+#include "Paker/core/command_arena.h"
+#include "Paker/core/output.h"
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <glog/logging.h>
+
+namespace Paker {
+
+namespace {
+
+std::atomic<bool> g_arena_reporting{false};
+thread_local CommandArena* tls_current_arena = nullptr;
+
+std::string format_kb(size_t bytes) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KB";
+    return oss.str();
+}
+
+} // namespace
+
+void* CountingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    void* ptr = upstream_->allocate(bytes, alignment);
+    ++allocation_count_;
+    bytes_requested_ += bytes;
+    bytes_in_use_ += bytes;
+    if (bytes_in_use_ > peak_bytes_) {
+        peak_bytes_ = bytes_in_use_;
+    }
+    return ptr;
+}
+
+void CountingMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    upstream_->deallocate(ptr, bytes, alignment);
+    bytes_in_use_ -= bytes;
+}
+
+CommandArena::CommandArena(std::string name, size_t initial_size, std::pmr::memory_resource* upstream)
+    : name_(std::move(name))
+    , upstream_counter_(upstream)
+    , monotonic_(initial_size, &upstream_counter_)
+    , counter_(&monotonic_) {}
+
+CommandArena::~CommandArena() {
+    ArenaStats stats = get_stats();
+    LOG(INFO) << "Arena '" << name_ << "': " << stats.allocation_count << " allocations, "
+              << stats.bytes_requested << " bytes requested, peak " << stats.peak_bytes << " bytes";
+    if (is_reporting_enabled()) {
+        Output::info("Arena [" + name_ + "] allocations: " + std::to_string(stats.allocation_count) +
+                     ", requested: " + format_kb(stats.bytes_requested) +
+                     ", peak: " + format_kb(stats.peak_bytes) +
+                     " in " + std::to_string(stats.upstream_allocations) + " blocks");
+    }
+    // monotonic_ 析构时一次性归还全部内存
+}
+
+ArenaStats CommandArena::get_stats() const {
+    ArenaStats stats;
+    stats.allocation_count = counter_.allocation_count();
+    stats.bytes_requested = counter_.bytes_requested();
+    stats.peak_bytes = upstream_counter_.peak_bytes();
+    stats.upstream_allocations = upstream_counter_.allocation_count();
+    return stats;
+}
+
+void CommandArena::set_reporting_enabled(bool enabled) {
+    g_arena_reporting = enabled;
+}
+
+bool CommandArena::is_reporting_enabled() {
+    return g_arena_reporting;
+}
+
+ArenaScope::ArenaScope(CommandArena& arena) : previous_(tls_current_arena) {
+    tls_current_arena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    tls_current_arena = previous_;
+}
+
+CommandArena* current_arena() {
+    return tls_current_arena;
+}
+
+std::pmr::memory_resource* current_arena_resource() {
+    return tls_current_arena ? tls_current_arena->resource() : std::pmr::get_default_resource();
+}
+
+} // namespace Paker
@@ -0,0 +1,74 @@
+#include "Paker/core/content_hash.h"
+#include <openssl/evp.h>
+#include <cerrno>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Paker {
+
+namespace {
+
+constexpr size_t kHashBufferSize = 64 * 1024;
+
+std::string to_hex(const unsigned char* digest, unsigned int length) {
+    static const char* hex = "0123456789abcdef";
+    std::string result;
+    result.reserve(length * 2);
+    for (unsigned int i = 0; i < length; ++i) {
+        result.push_back(hex[digest[i] >> 4]);
+        result.push_back(hex[digest[i] & 0x0f]);
+    }
+    return result;
+}
+
+} // namespace
+
+std::string sha256_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return "";
+    }
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1) {
+        ::close(fd);
+        return "";
+    }
+
+    std::vector<unsigned char> buffer(kHashBufferSize);
+    bool ok = true;
+    while (true) {
+        ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        EVP_DigestUpdate(ctx.get(), buffer.data(), static_cast<size_t>(n));
+    }
+    ::close(fd);
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (!ok || EVP_DigestFinal_ex(ctx.get(), digest, &length) != 1) {
+        return "";
+    }
+    return to_hex(digest, length);
+}
+
+std::string sha256_data(const std::string& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (EVP_Digest(data.data(), data.size(), digest, &length, EVP_sha256(), nullptr) != 1) {
+        return "";
+    }
+    return to_hex(digest, length);
+}
+
+} // namespace Paker
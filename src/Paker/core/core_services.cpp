@@ -2,9 +2,16 @@
 #include "Paker/core/output.h"
 #include "Paker/cache/cache_warmup.h"
 #include <glog/logging.h>
+#include <iomanip>
+#include <sstream>
 
 namespace Paker {
 
+namespace {
+// 进程启动时间（静态初始化阶段），用于启动耗时报告
+const auto g_process_start = std::chrono::steady_clock::now();
+}
+
 // ==================== DependencyResolverService ====================
 
 DependencyResolverService::DependencyResolverService() {
@@ -240,24 +247,64 @@ bool ServiceFactory::register_all_core_services() {
         return false;
     }
     
-    // 注册所有核心服务
-    g_service_manager->register_service(create_dependency_resolver_service());
-    g_service_manager->register_service(create_cache_manager_service());
-    g_service_manager->register_service(create_parallel_executor_service());
-    g_service_manager->register_service(create_performance_monitor_service());
-    g_service_manager->register_service(create_incremental_updater_service());
-    g_service_manager->register_service(create_cache_warmup_service());
-    
-    // 初始化所有服务
-    if (!g_service_manager->initialize_all()) {
-        LOG(ERROR) << "Failed to initialize all core services";
-        return false;
+    // 重复调用（例如守护进程中的多条命令）直接复用已注册的服务
+    if (g_service_manager->get_registered_count() > 0) {
+        return true;
     }
     
-    LOG(INFO) << "All core services registered and initialized";
+    // 只注册工厂：服务在首次被访问时才构造和初始化，
+    // 像 list 这样的命令不会触发缓存扫描、线程池或磁盘缓存加载
+    g_service_manager->register_lazy_service<DependencyResolverService>(create_dependency_resolver_service);
+    g_service_manager->register_lazy_service<CacheManagerService>(create_cache_manager_service);
+    g_service_manager->register_lazy_service<ParallelExecutorService>(create_parallel_executor_service);
+    g_service_manager->register_lazy_service<PerformanceMonitorService>(create_performance_monitor_service);
+    g_service_manager->register_lazy_service<IncrementalUpdaterService>(create_incremental_updater_service);
+    // 预热服务初始化时会取用缓存管理器和依赖解析器
+    g_service_manager->register_lazy_service<CacheWarmupServiceWrapper>(
+        create_cache_warmup_service,
+        {typeid(CacheManagerService), typeid(DependencyResolverService)});
+    
+    LOG(INFO) << "All core services registered";
     return true;
 }
 
+void print_startup_profile() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - g_process_start);
+    
+    std::vector<ServiceInitRecord> profile;
+    size_t registered = 0;
+    if (g_service_manager) {
+        profile = g_service_manager->get_init_profile();
+        registered = g_service_manager->get_registered_count();
+    }
+    
+    auto format_ms = [](std::chrono::microseconds us) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << us.count() / 1000.0 << " ms";
+        return oss.str();
+    };
+    
+    Output::info("\nStartup profile:");
+    if (profile.empty()) {
+        Output::info("  No services were initialized");
+    } else {
+        Table table;
+        table.add_column("Service", 30);
+        table.add_column("Init time", 12, true);
+        table.add_column("Status", 8);
+        std::chrono::microseconds total{0};
+        for (const auto& record : profile) {
+            table.add_row({record.name, format_ms(record.duration), record.success ? "ok" : "failed"});
+            total += record.duration;
+        }
+        Output::print_table(table);
+        Output::info("  Service init total: " + format_ms(total));
+    }
+    Output::info("  Services initialized: " + std::to_string(profile.size()) + "/" + std::to_string(registered));
+    Output::info("  Process time so far: " + format_ms(elapsed));
+}
+
 // ==================== 便捷访问函数 ====================
 
 DependencyResolver* get_dependency_resolver() {
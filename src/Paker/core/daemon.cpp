@@ -0,0 +1,658 @@
+#include "Paker/core/daemon.h"
+#include <filesystem>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <glog/logging.h>
+#include "nlohmann/json.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+constexpr uint32_t PROTOCOL_VERSION = 2;
+constexpr uint32_t MAX_FRAME_SIZE = 1 << 20;
+constexpr size_t STDIO_FD_COUNT = 3;
+
+// 随每条命令从客户端转发的环境变量；守护进程启动时的值只对当时的客户端有效
+constexpr const char* FORWARDED_ENV[] = {
+    "PAKER_IO_BACKEND", "PAKER_REMOTE_CACHE", "PAKER_PREFETCH_SESSION", "GITHUB_TOKEN",
+    "http_proxy", "https_proxy", "all_proxy", "no_proxy",
+    "HTTP_PROXY", "HTTPS_PROXY", "ALL_PROXY", "NO_PROXY",
+};
+
+// 套接字用 send + MSG_NOSIGNAL
+bool write_all(int fd, const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::send(fd, ptr, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// 终端、管道等普通描述符；处理 EINTR 与短写
+bool write_fd_all(int fd, const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, ptr, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t size) {
+    char* ptr = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(fd, ptr, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        ptr += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+// 帧格式：uint32 长度 + JSON 负载；描述符随长度字段以 SCM_RIGHTS 附带
+bool send_frame(int fd, const std::string& payload, const int* fds = nullptr, size_t fd_count = 0) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    struct iovec iov{&length, sizeof(length)};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * STDIO_FD_COUNT)];
+    if (fd_count > 0) {
+        std::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent <= 0) {
+        return false;
+    }
+    if (static_cast<size_t>(sent) < sizeof(length) &&
+        !write_all(fd, reinterpret_cast<char*>(&length) + sent, sizeof(length) - static_cast<size_t>(sent))) {
+        return false;
+    }
+    return write_all(fd, payload.data(), payload.size());
+}
+
+bool recv_frame(int fd, std::string& payload, std::vector<int>* fds = nullptr) {
+    uint32_t length = 0;
+    struct iovec iov{&length, sizeof(length)};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * STDIO_FD_COUNT)];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        return false;
+    }
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int* received_fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        for (size_t i = 0; i < count; ++i) {
+            if (fds) {
+                fds->push_back(received_fds[i]);
+            } else {
+                ::close(received_fds[i]);
+            }
+        }
+    }
+
+    if (static_cast<size_t>(received) < sizeof(length) &&
+        !read_all(fd, reinterpret_cast<char*>(&length) + received, sizeof(length) - static_cast<size_t>(received))) {
+        return false;
+    }
+    if (length > MAX_FRAME_SIZE) {
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || read_all(fd, &payload[0], length);
+}
+
+// 客户端的环境：值为 null 表示客户端未设置该变量
+json capture_forwarded_env() {
+    json env = json::object();
+    for (const char* name : FORWARDED_ENV) {
+        const char* value = std::getenv(name);
+        env[name] = value ? json(value) : json(nullptr);
+    }
+    return env;
+}
+
+// 命令执行期间套用客户端的环境，析构时恢复守护进程原来的值；只接受 FORWARDED_ENV 中的变量
+class ScopedClientEnv {
+public:
+    explicit ScopedClientEnv(const json& env) {
+        if (!env.is_object()) {
+            return;
+        }
+        for (const char* name : FORWARDED_ENV) {
+            auto it = env.find(name);
+            if (it == env.end()) {
+                continue;
+            }
+            const char* previous = std::getenv(name);
+            saved_.emplace(name, previous ? std::optional<std::string>(previous) : std::nullopt);
+            apply(name, it->is_string() ? std::optional<std::string>(it->get<std::string>()) : std::nullopt);
+        }
+    }
+    ~ScopedClientEnv() {
+        for (const auto& [name, value] : saved_) {
+            apply(name, value);
+        }
+    }
+    ScopedClientEnv(const ScopedClientEnv&) = delete;
+    ScopedClientEnv& operator=(const ScopedClientEnv&) = delete;
+
+private:
+    static void apply(const std::string& name, const std::optional<std::string>& value) {
+        if (value) {
+            ::setenv(name.c_str(), value->c_str(), 1);
+        } else {
+            ::unsetenv(name.c_str());
+        }
+    }
+
+    std::map<std::string, std::optional<std::string>> saved_;
+};
+
+void close_fds(const std::vector<int>& fds) {
+    for (int fd : fds) {
+        ::close(fd);
+    }
+}
+
+bool fill_address(const std::string& path, struct sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG(ERROR) << "Daemon socket path too long: " << path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// 目录须属于当前用户或 root，且其他用户不能替换其中的文件
+bool is_private_directory(const fs::path& directory) {
+    struct stat st;
+    return ::stat(directory.c_str(), &st) == 0 && S_ISDIR(st.st_mode) &&
+           (st.st_uid == ::getuid() || st.st_uid == 0) &&
+           (!(st.st_mode & (S_IWGRP | S_IWOTH)) || (st.st_mode & S_ISVTX));
+}
+
+// 对端进程是否属于当前用户
+bool peer_is_current_user(int fd) {
+#ifdef SO_PEERCRED
+    struct ucred cred{};
+    socklen_t cred_len = sizeof(cred);
+    return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0 && cred.uid == ::getuid();
+#else
+    (void)fd;
+    return true;
+#endif
+}
+
+} // namespace
+
+std::string get_daemon_socket_path() {
+    if (const char* custom = std::getenv("PAKER_DAEMON_SOCKET")) {
+        return custom;
+    }
+    const std::string uid = std::to_string(::getuid());
+    if (const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR")) {
+        return (fs::path(runtime_dir) / ("paker-" + uid + ".sock")).string();
+    }
+    return "/tmp/paker-" + uid + "/daemon.sock";
+}
+
+// ==================== DaemonServer ====================
+
+DaemonServer::DaemonServer(CommandHandler handler, const std::string& socket_path)
+    : handler_(std::move(handler)), socket_path_(socket_path) {
+}
+
+DaemonServer::~DaemonServer() {
+    close_socket();
+}
+
+bool DaemonServer::bind() {
+    if (DaemonClient(socket_path_).is_available()) {
+        LOG(WARNING) << "Daemon already running on " << socket_path_;
+        return false;
+    }
+
+    // 父目录只允许当前用户访问
+    auto parent = fs::path(socket_path_).parent_path();
+    if (!parent.empty()) {
+        if (::mkdir(parent.c_str(), 0700) != 0 && errno != EEXIST) {
+            LOG(ERROR) << "Failed to create daemon directory " << parent << ": " << std::strerror(errno);
+            return false;
+        }
+        if (!is_private_directory(parent)) {
+            LOG(ERROR) << "Daemon directory " << parent << " is not private to current user";
+            return false;
+        }
+    }
+
+    struct sockaddr_un addr;
+    if (!fill_address(socket_path_, addr)) {
+        return false;
+    }
+
+    // 上一个实例异常退出时遗留的套接字文件
+    ::unlink(socket_path_.c_str());
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG(ERROR) << "Failed to create daemon socket: " << std::strerror(errno);
+        return false;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(socket_path_.c_str(), 0600) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        LOG(ERROR) << "Failed to listen on " << socket_path_ << ": " << std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    LOG(INFO) << "Daemon listening on " << socket_path_;
+    return true;
+}
+
+void DaemonServer::close_socket() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+void DaemonServer::run() {
+    if (listen_fd_ < 0 && !bind()) {
+        return;
+    }
+
+    started_at_ = std::chrono::steady_clock::now();
+    auto last_activity = started_at_;
+
+    while (!stop_requested_) {
+        struct pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 1000);
+        if (ready < 0 && errno != EINTR) {
+            LOG(ERROR) << "Daemon poll failed: " << std::strerror(errno);
+            break;
+        }
+        if (ready <= 0) {
+            if (idle_timeout_.count() > 0 &&
+                std::chrono::steady_clock::now() - last_activity >= idle_timeout_) {
+                LOG(INFO) << "Daemon idle for " << idle_timeout_.count() << "s, exiting";
+                break;
+            }
+            continue;
+        }
+
+        int client_fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            continue;
+        }
+        handle_connection(client_fd);
+        ::close(client_fd);
+        last_activity = std::chrono::steady_clock::now();
+    }
+
+    close_socket();
+    LOG(INFO) << "Daemon stopped after " << requests_served_.load() << " requests";
+}
+
+void DaemonServer::handle_connection(int client_fd) {
+    // 只服务同一用户的客户端
+    if (!peer_is_current_user(client_fd)) {
+        LOG(WARNING) << "Rejected daemon connection from foreign user";
+        return;
+    }
+
+    std::string payload;
+    std::vector<int> fds;
+    if (!recv_frame(client_fd, payload, &fds)) {
+        close_fds(fds);
+        return;
+    }
+
+    json response;
+    try {
+        json request = json::parse(payload);
+        std::string type = request.value("type", "");
+        if (request.value("protocol", 0u) != PROTOCOL_VERSION) {
+            response["error"] = "protocol mismatch";
+        } else if (type == "run" && fds.size() == STDIO_FD_COUNT) {
+            auto args = request["args"].get<std::vector<std::string>>();
+            ScopedClientEnv client_env(request.value("env", json::object()));
+            response["exit_code"] = execute(args, request.value("cwd", ""), fds.data());
+        } else if (type == "status") {
+            response["pid"] = static_cast<int64_t>(::getpid());
+            response["requests_served"] = requests_served_.load();
+            response["uptime_seconds"] = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - started_at_).count();
+        } else if (type == "stop") {
+            response["stopping"] = true;
+            stop_requested_ = true;
+        } else {
+            response["error"] = "invalid request";
+        }
+    } catch (const std::exception& e) {
+        response["error"] = e.what();
+    }
+
+    close_fds(fds);
+    send_frame(client_fd, response.dump());
+}
+
+int DaemonServer::execute(const std::vector<std::string>& args, const std::string& cwd, const int fds[3]) {
+    std::error_code ec;
+    auto previous_cwd = fs::current_path(ec);
+    if (!cwd.empty()) {
+        fs::current_path(cwd, ec);
+        if (ec) {
+            std::string message = "paker daemon: cannot enter " + cwd + ": " + ec.message() + "\n";
+            if (!write_fd_all(fds[2], message.data(), message.size())) {
+                LOG(WARNING) << "Failed to report cwd error to client: " << std::strerror(errno);
+            }
+            return 1;
+        }
+    }
+
+    // 命令执行期间让 0/1/2 指向客户端的终端
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    int saved[STDIO_FD_COUNT];
+    for (size_t i = 0; i < STDIO_FD_COUNT; ++i) {
+        saved[i] = ::fcntl(static_cast<int>(i), F_DUPFD_CLOEXEC, 3);
+        ::dup2(fds[i], static_cast<int>(i));
+    }
+
+    int exit_code = 1;
+    try {
+        exit_code = handler_(args);
+    } catch (const std::exception& e) {
+        std::cerr << "paker daemon: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "paker daemon: unknown error" << std::endl;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    for (size_t i = 0; i < STDIO_FD_COUNT; ++i) {
+        if (saved[i] >= 0) {
+            ::dup2(saved[i], static_cast<int>(i));
+            ::close(saved[i]);
+        }
+    }
+    std::cin.clear();
+    std::cout.clear();
+    std::cerr.clear();
+
+    if (!previous_cwd.empty()) {
+        fs::current_path(previous_cwd, ec);
+    }
+    ++requests_served_;
+    return exit_code;
+}
+
+// ==================== DaemonClient ====================
+
+DaemonClient::DaemonClient(const std::string& socket_path) : socket_path_(socket_path) {
+}
+
+int DaemonClient::connect_socket() const {
+    struct sockaddr_un addr;
+    if (!fill_address(socket_path_, addr)) {
+        return -1;
+    }
+    // 其他用户可抢先创建共享目录中的套接字，截获转发的参数与终端描述符
+    auto parent = fs::path(socket_path_).parent_path();
+    if (!parent.empty() && !is_private_directory(parent)) {
+        LOG(WARNING) << "Ignoring daemon socket in non-private directory " << parent;
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    if (!peer_is_current_user(fd)) {
+        LOG(WARNING) << "Daemon socket " << socket_path_ << " is served by another user";
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool DaemonClient::is_available() const {
+    int fd = connect_socket();
+    if (fd < 0) {
+        return false;
+    }
+    ::close(fd);
+    return true;
+}
+
+bool DaemonClient::call(const std::string& payload, std::string& response) const {
+    int fd = connect_socket();
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = send_frame(fd, payload) && recv_frame(fd, response);
+    ::close(fd);
+    return ok;
+}
+
+bool DaemonClient::forward(const std::vector<std::string>& args, int& exit_code,
+                           int in_fd, int out_fd, int err_fd) const {
+    int fd = connect_socket();
+    if (fd < 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    json request = {
+        {"protocol", PROTOCOL_VERSION},
+        {"type", "run"},
+        {"cwd", fs::current_path(ec).string()},
+        {"args", args},
+        {"env", capture_forwarded_env()}
+    };
+    const int fds[STDIO_FD_COUNT] = {in_fd, out_fd, err_fd};
+    if (!send_frame(fd, request.dump(), fds, STDIO_FD_COUNT)) {
+        // 请求未送达，调用方可以安全地在本进程重新执行
+        ::close(fd);
+        return false;
+    }
+
+    std::string payload;
+    bool ok = recv_frame(fd, payload);
+    ::close(fd);
+
+    exit_code = 1;
+    if (!ok) {
+        // 命令可能已部分执行，不能回退重跑
+        std::string message = "paker: lost connection to daemon\n";
+        if (!write_fd_all(err_fd, message.data(), message.size())) {
+            LOG(WARNING) << "Lost connection to daemon";
+        }
+        return true;
+    }
+    try {
+        json response = json::parse(payload);
+        if (response.contains("exit_code")) {
+            exit_code = response["exit_code"].get<int>();
+            return true;
+        }
+        // 守护进程拒绝了请求（例如协议版本不同），回退到本进程执行
+        LOG(WARNING) << "Daemon rejected request: " << response.value("error", "");
+        return false;
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Invalid daemon response: " << e.what();
+        return true;
+    }
+}
+
+bool DaemonClient::stop() const {
+    std::string response;
+    json request = {{"protocol", PROTOCOL_VERSION}, {"type", "stop"}};
+    return call(request.dump(), response);
+}
+
+DaemonStatus DaemonClient::status() const {
+    DaemonStatus status;
+    status.socket_path = socket_path_;
+    std::string payload;
+    json request = {{"protocol", PROTOCOL_VERSION}, {"type", "status"}};
+    if (!call(request.dump(), payload)) {
+        return status;
+    }
+    try {
+        json response = json::parse(payload);
+        status.running = response.contains("pid");
+        status.pid = response.value("pid", int64_t(0));
+        status.requests_served = response.value("requests_served", uint64_t(0));
+        status.uptime = std::chrono::seconds(response.value("uptime_seconds", int64_t(0)));
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Invalid daemon status: " << e.what();
+    }
+    return status;
+}
+
+bool DaemonClient::should_forward(int argc, char* argv[]) {
+    if (argc < 2 || std::getenv("PAKER_NO_DAEMON")) {
+        return false;
+    }
+    // --watch 长期运行，会独占守护进程
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--watch") {
+            return false;
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (!arg.empty() && arg[0] != '-') {
+            return arg != "daemon";
+        }
+    }
+    return false;
+}
+
+bool DaemonClient::try_forward(int argc, char* argv[], int& exit_code) {
+    if (!should_forward(argc, argv)) {
+        return false;
+    }
+    std::vector<std::string> args(argv + 1, argv + argc);
+    return DaemonClient().forward(args, exit_code);
+}
+
+// ==================== 启动 ====================
+
+bool spawn_daemon(const DaemonServer::CommandHandler& handler, std::chrono::seconds idle_timeout,
+                  const std::function<void()>& on_ready) {
+    int ready_pipe[2];
+    if (::pipe2(ready_pipe, O_CLOEXEC) != 0) {
+        LOG(ERROR) << "Failed to create pipe: " << std::strerror(errno);
+        return false;
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        LOG(ERROR) << "Failed to fork daemon: " << std::strerror(errno);
+        ::close(ready_pipe[0]);
+        ::close(ready_pipe[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        ::close(ready_pipe[0]);
+        ::setsid();
+        int null_fd = ::open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            for (int fd = 0; fd < static_cast<int>(STDIO_FD_COUNT); ++fd) {
+                ::dup2(null_fd, fd);
+            }
+            if (null_fd > 2) ::close(null_fd);
+        }
+
+        DaemonServer server(handler);
+        server.set_idle_timeout(idle_timeout);
+        char status = server.bind() ? 1 : 0;
+        if (status && on_ready) {
+            on_ready();
+        }
+        // 父进程读不到状态时按启动失败处理
+        write_fd_all(ready_pipe[1], &status, 1);
+        ::close(ready_pipe[1]);
+        if (status) {
+            server.run();
+        }
+        // 正常退出以执行服务清理
+        std::exit(status ? 0 : 1);
+    }
+
+    ::close(ready_pipe[1]);
+    char status = 0;
+    ssize_t received;
+    do {
+        received = ::read(ready_pipe[0], &status, 1);
+    } while (received < 0 && errno == EINTR);
+    ::close(ready_pipe[0]);
+    return received == 1 && status == 1;
+}
+
+} // namespace Paker
@@ -0,0 +1,873 @@
+#include "Paker/core/history_log.h"
+#include "Paker/cache/blob_store.h"
+#include "Paker/cache/cache_lock.h"
+#include <glog/logging.h>
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x49484B50;   // "PKHI"
+constexpr uint32_t kIndexVersion = 1;
+constexpr uint8_t kRollbackFlag = 1;
+
+int64_t to_millis(const std::chrono::system_clock::time_point& time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_millis(int64_t ms) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_string(std::string& out, const std::string& value) {
+    put<uint16_t>(out, static_cast<uint16_t>(value.size()));
+    out.append(value);
+}
+
+// 顺序读取索引文件内容，越界时置 ok 为 false
+struct IndexReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    T get() {
+        T value{};
+        if (pos + sizeof(T) > data.size()) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string get_string() {
+        uint16_t length = get<uint16_t>();
+        if (!ok || pos + length > data.size()) {
+            ok = false;
+            return {};
+        }
+        std::string value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+};
+
+bool read_file(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool write_file_atomic(const std::string& path, const std::string& content) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!file) {
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    return !ec;
+}
+
+uint64_t read_retention(const std::string& path) {
+    std::string retention;
+    if (!read_file(path, retention)) {
+        return 0;
+    }
+    try {
+        return std::stoull(retention);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+// "segment-000012.log" -> 12
+uint32_t parse_segment_name(const std::string& name) {
+    const std::string prefix = "segment-";
+    if (name.compare(0, prefix.size(), prefix) != 0 || name.size() < prefix.size() + 5 ||
+        name.compare(name.size() - 4, 4, ".log") != 0) {
+        return 0;
+    }
+    try {
+        return static_cast<uint32_t>(std::stoul(name.substr(prefix.size(), name.size() - prefix.size() - 4)));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+json entry_to_json(const VersionHistoryEntry& entry, uint64_t seq) {
+    json j = {{"seq", seq},
+              {"ts", to_millis(entry.timestamp)},
+              {"package", entry.package_name},
+              {"old", entry.old_version},
+              {"new", entry.new_version},
+              {"url", entry.repository_url},
+              {"reason", entry.reason},
+              {"user", entry.user},
+              {"commit", entry.commit_hash},
+              {"rollback", entry.is_rollback},
+              {"backup", entry.backup_path},
+              {"backup_size", entry.backup_size_bytes}};
+    if (!entry.affected_files_ref.empty()) {
+        j["files"] = entry.affected_files_ref;
+    }
+    return j;
+}
+
+void entry_from_json(const json& j, VersionHistoryEntry& entry) {
+    entry.package_name = j.value("package", "");
+    entry.old_version = j.value("old", "");
+    entry.new_version = j.value("new", "");
+    entry.repository_url = j.value("url", "");
+    entry.reason = j.value("reason", "");
+    entry.user = j.value("user", "");
+    entry.commit_hash = j.value("commit", "");
+    entry.is_rollback = j.value("rollback", false);
+    entry.backup_path = j.value("backup", "");
+    entry.backup_size_bytes = j.value("backup_size", static_cast<size_t>(0));
+    entry.affected_files_ref = j.value("files", "");
+    entry.affected_files.clear();
+    entry.timestamp = from_millis(j.value("ts", static_cast<int64_t>(0)));
+}
+
+} // namespace
+
+HistoryLog::HistoryLog(const std::string& dir, size_t segment_capacity)
+    : dir_(dir), segment_capacity_(std::max<size_t>(segment_capacity, 1)), next_seq_(1), first_seq_(0),
+      active_segment_(1), active_fd_(-1), rollbacks_(0), backup_bytes_(0) {
+    file_refs_.emplace_back();
+}
+
+HistoryLog::~HistoryLog() {
+    if (active_fd_ >= 0) {
+        ::close(active_fd_);
+    }
+}
+
+std::string HistoryLog::segment_path(uint32_t segment, const char* extension) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%06u%s", segment, extension);
+    return dir_ + "/" + name;
+}
+
+std::vector<uint32_t> HistoryLog::list_segments() const {
+    std::vector<uint32_t> numbers;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(dir_, ec)) {
+        uint32_t number = parse_segment_name(item.path().filename().string());
+        if (number != 0) {
+            numbers.push_back(number);
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+bool HistoryLog::open() {
+    std::error_code ec;
+    fs::create_directories(fs::path(dir_) / "files", ec);
+    if (ec) {
+        LOG(ERROR) << "Failed to create history directory " << dir_ << ": " << ec.message();
+        return false;
+    }
+    // 打开时可能截掉半行、补写索引，与其他进程的追加互斥
+    FileLock lock;
+    if (!lock.lock(dir_ + "/lock")) {
+        return false;
+    }
+    return load();
+}
+
+void HistoryLog::reset() {
+    if (active_fd_ >= 0) {
+        ::close(active_fd_);
+        active_fd_ = -1;
+    }
+    next_seq_ = 1;
+    first_seq_ = 0;
+    segments_.clear();
+    active_segment_ = 1;
+    by_time_.clear();
+    by_package_.clear();
+    package_names_.clear();
+    package_ids_.clear();
+    file_refs_.assign(1, std::string());
+    file_ref_ids_.clear();
+    rollbacks_ = 0;
+    backup_bytes_ = 0;
+}
+
+bool HistoryLog::load() {
+    first_seq_ = read_retention(dir_ + "/retention");
+
+    std::vector<uint32_t> numbers = list_segments();
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        if (!load_segment(numbers[i], i + 1 < numbers.size())) {
+            return false;
+        }
+    }
+    if (!numbers.empty()) {
+        active_segment_ = numbers.back();
+    }
+    if (first_seq_ > next_seq_) {
+        next_seq_ = first_seq_;
+    }
+    LOG(INFO) << "Opened version history " << dir_ << " with " << by_time_.size() << " entries in "
+              << segments_.size() << " segments";
+    return open_active();
+}
+
+bool HistoryLog::load_segment(uint32_t segment, bool sealed) {
+    std::vector<Location> locations;
+    bool indexed = false;
+    std::string data;
+    if (sealed && read_file(segment_path(segment, ".idx"), data)) {
+        IndexReader reader{data};
+        uint32_t magic = reader.get<uint32_t>();
+        uint32_t version = reader.get<uint32_t>();
+        uint32_t count = reader.get<uint32_t>();
+        uint64_t bytes = reader.get<uint64_t>();
+        indexed = reader.ok && magic == kIndexMagic && version == kIndexVersion;
+        for (uint32_t i = 0; indexed && i < count; ++i) {
+            Location location;
+            location.segment = segment;
+            location.seq = reader.get<uint64_t>();
+            location.ts_ms = reader.get<int64_t>();
+            location.offset = reader.get<uint64_t>();
+            location.length = reader.get<uint32_t>();
+            location.rollback = (reader.get<uint8_t>() & kRollbackFlag) != 0;
+            location.backup_size = reader.get<uint64_t>();
+            location.package = intern_package(reader.get_string());
+            location.files = intern_files(reader.get_string());
+            indexed = reader.ok;
+            locations.push_back(location);
+        }
+        if (indexed) {
+            segments_[segment].bytes = bytes;
+        } else {
+            LOG(WARNING) << "Ignoring damaged history index " << segment_path(segment, ".idx");
+            locations.clear();
+        }
+    }
+    if (!indexed) {
+        if (!scan_segment(segment, 0, locations)) {
+            return false;
+        }
+    }
+
+    add_locations(segment, locations);
+    const Segment& info = segments_[segment];
+    if (sealed && info.records == 0) {
+        // 整段都在保留起点之前，完成上次未结束的清理
+        std::error_code ec;
+        fs::remove(segment_path(segment, ".log"), ec);
+        fs::remove(segment_path(segment, ".idx"), ec);
+        segments_.erase(segment);
+    } else if (sealed && !indexed) {
+        write_index(segment);
+    }
+    return true;
+}
+
+void HistoryLog::add_locations(uint32_t segment, const std::vector<Location>& locations) {
+    Segment& info = segments_[segment];
+    for (const auto& location : locations) {
+        next_seq_ = std::max(next_seq_, location.seq + 1);
+        if (location.seq < first_seq_) {
+            continue;
+        }
+        if (info.records == 0) {
+            info.first_seq = location.seq;
+        }
+        info.last_seq = location.seq;
+        info.records++;
+        insert(location);
+    }
+}
+
+bool HistoryLog::scan_segment(uint32_t segment, uint64_t from, std::vector<Location>& locations) {
+    std::string path = segment_path(segment, ".log");
+    std::string data;
+    if (!read_file(path, data) || data.size() < from) {
+        LOG(ERROR) << "Failed to read history segment " << path;
+        return false;
+    }
+
+    size_t pos = static_cast<size_t>(from);
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) {
+            // 写入中断留下的半行，截掉后继续追加
+            LOG(WARNING) << "Truncating incomplete record at " << path << ":" << pos;
+            if (::truncate(path.c_str(), static_cast<off_t>(pos)) != 0) {
+                LOG(ERROR) << "Failed to truncate " << path << ": " << std::strerror(errno);
+                return false;
+            }
+            data.resize(pos);
+            break;
+        }
+        try {
+            json j = json::parse(data.begin() + static_cast<std::ptrdiff_t>(pos),
+                                 data.begin() + static_cast<std::ptrdiff_t>(end));
+            Location location;
+            location.segment = segment;
+            location.seq = j.value("seq", static_cast<uint64_t>(0));
+            location.ts_ms = j.value("ts", static_cast<int64_t>(0));
+            location.offset = pos;
+            location.length = static_cast<uint32_t>(end - pos);
+            location.rollback = j.value("rollback", false);
+            location.backup_size = j.value("backup_size", static_cast<uint64_t>(0));
+            location.package = intern_package(j.value("package", ""));
+            location.files = intern_files(j.value("files", ""));
+            locations.push_back(location);
+        } catch (const std::exception& e) {
+            LOG(WARNING) << "Skipping unreadable history record at " << path << ":" << pos << ": " << e.what();
+        }
+        pos = end + 1;
+    }
+    segments_[segment].bytes = data.size();
+    return true;
+}
+
+bool HistoryLog::write_index(uint32_t segment) const {
+    auto info = segments_.find(segment);
+    std::vector<const Location*> locations;
+    for (const auto& location : by_time_) {
+        if (location.segment == segment) {
+            locations.push_back(&location);
+        }
+    }
+    std::sort(locations.begin(), locations.end(),
+              [](const Location* a, const Location* b) { return a->offset < b->offset; });
+
+    std::string data;
+    put<uint32_t>(data, kIndexMagic);
+    put<uint32_t>(data, kIndexVersion);
+    put<uint32_t>(data, static_cast<uint32_t>(locations.size()));
+    put<uint64_t>(data, info != segments_.end() ? info->second.bytes : 0);
+    for (const Location* location : locations) {
+        put<uint64_t>(data, location->seq);
+        put<int64_t>(data, location->ts_ms);
+        put<uint64_t>(data, location->offset);
+        put<uint32_t>(data, location->length);
+        put<uint8_t>(data, location->rollback ? kRollbackFlag : 0);
+        put<uint64_t>(data, location->backup_size);
+        put_string(data, package_names_[location->package]);
+        put_string(data, file_refs_[location->files]);
+    }
+    if (!write_file_atomic(segment_path(segment, ".idx"), data)) {
+        LOG(WARNING) << "Failed to write history index for segment " << segment;
+        return false;
+    }
+    return true;
+}
+
+bool HistoryLog::open_active() {
+    if (active_fd_ >= 0) {
+        ::close(active_fd_);
+    }
+    std::string path = segment_path(active_segment_, ".log");
+    active_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (active_fd_ < 0) {
+        LOG(ERROR) << "Failed to open history segment " << path << ": " << std::strerror(errno);
+        return false;
+    }
+    segments_[active_segment_];
+    return true;
+}
+
+bool HistoryLog::seal_active() {
+    write_index(active_segment_);
+    active_segment_++;
+    return open_active();
+}
+
+bool HistoryLog::refresh() {
+    // 其他进程清理过历史（保留起点前移、删除了段）时整体重新加载
+    std::vector<uint32_t> numbers = list_segments();
+    bool pruned = read_retention(dir_ + "/retention") != first_seq_;
+    for (const auto& [segment, info] : segments_) {
+        if (!pruned && !std::binary_search(numbers.begin(), numbers.end(), segment)) {
+            pruned = segment != active_segment_ || info.bytes > 0;
+        }
+    }
+    struct stat st{};
+    std::string active_path = segment_path(active_segment_, ".log");
+    if (!pruned && ::stat(active_path.c_str(), &st) == 0 &&
+        static_cast<uint64_t>(st.st_size) < segments_[active_segment_].bytes) {
+        pruned = true;
+    }
+    if (pruned) {
+        LOG(INFO) << "Version history " << dir_ << " was pruned by another process, reloading";
+        reset();
+        return load();
+    }
+
+    // 活动段的实际长度与内存中的不同：读入其他进程追加的尾部记录
+    if (::stat(active_path.c_str(), &st) == 0 &&
+        static_cast<uint64_t>(st.st_size) != segments_[active_segment_].bytes) {
+        std::vector<Location> locations;
+        if (!scan_segment(active_segment_, segments_[active_segment_].bytes, locations)) {
+            return false;
+        }
+        add_locations(active_segment_, locations);
+    }
+
+    // 其他进程封存了活动段并开始了新段
+    auto newer = std::upper_bound(numbers.begin(), numbers.end(), active_segment_);
+    if (newer == numbers.end()) {
+        return true;
+    }
+    for (auto it = newer; it != numbers.end(); ++it) {
+        if (!load_segment(*it, std::next(it) != numbers.end())) {
+            return false;
+        }
+    }
+    active_segment_ = numbers.back();
+    return open_active();
+}
+
+void HistoryLog::insert(const Location& location) {
+    auto before = [](const Location& a, const Location& b) {
+        return a.ts_ms != b.ts_ms ? a.ts_ms < b.ts_ms : a.seq < b.seq;
+    };
+    // 正常追加的记录时间单调，直接放到末尾；导入或时钟回拨时才需要插入
+    auto place = [&before](std::vector<Location>& locations, const Location& value) {
+        if (locations.empty() || !before(value, locations.back())) {
+            locations.push_back(value);
+        } else {
+            locations.insert(std::upper_bound(locations.begin(), locations.end(), value, before), value);
+        }
+    };
+    place(by_time_, location);
+    if (by_package_.size() <= location.package) {
+        by_package_.resize(location.package + 1);
+    }
+    place(by_package_[location.package], location);
+    if (location.rollback) {
+        rollbacks_++;
+    }
+    backup_bytes_ += location.backup_size;
+}
+
+uint32_t HistoryLog::intern_package(const std::string& package) {
+    auto it = package_ids_.find(package);
+    if (it != package_ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(package_names_.size());
+    package_names_.push_back(package);
+    package_ids_.emplace(package, id);
+    return id;
+}
+
+uint32_t HistoryLog::intern_files(const std::string& ref) {
+    if (ref.empty()) {
+        return 0;
+    }
+    auto it = file_ref_ids_.find(ref);
+    if (it != file_ref_ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(file_refs_.size());
+    file_refs_.push_back(ref);
+    file_ref_ids_.emplace(ref, id);
+    return id;
+}
+
+std::string HistoryLog::store_files(const std::vector<std::string>& files) {
+    std::string joined;
+    for (const auto& file : files) {
+        joined += file;
+        joined += '\n';
+    }
+    // 引用由内容决定且同名文件直接复用，必须是覆盖全部字节的标准 SHA-256
+    std::string ref = BlobStore::hash_data(joined).substr(0, 32);
+    std::string path = dir_ + "/files/" + ref + ".z";
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        return ref;
+    }
+
+    uLongf length = compressBound(static_cast<uLong>(joined.size()));
+    std::string data;
+    put<uint64_t>(data, joined.size());
+    size_t header = data.size();
+    data.resize(header + length);
+    if (compress2(reinterpret_cast<Bytef*>(&data[header]), &length, reinterpret_cast<const Bytef*>(joined.data()),
+                  static_cast<uLong>(joined.size()), Z_BEST_COMPRESSION) != Z_OK) {
+        LOG(WARNING) << "Failed to compress affected file list";
+        return "";
+    }
+    data.resize(header + length);
+    if (!write_file_atomic(path, data)) {
+        LOG(WARNING) << "Failed to write affected file list " << path;
+        return "";
+    }
+    return ref;
+}
+
+std::vector<std::string> HistoryLog::load_affected_files(const VersionHistoryEntry& entry) const {
+    std::vector<std::string> files;
+    if (entry.affected_files_ref.empty()) {
+        return entry.affected_files;
+    }
+    std::string data;
+    if (!read_file(dir_ + "/files/" + entry.affected_files_ref + ".z", data) || data.size() < sizeof(uint64_t)) {
+        LOG(WARNING) << "Affected file list " << entry.affected_files_ref << " is missing";
+        return files;
+    }
+    uint64_t raw_size = 0;
+    std::memcpy(&raw_size, data.data(), sizeof(raw_size));
+    std::string joined(raw_size, '\0');
+    uLongf length = static_cast<uLongf>(raw_size);
+    if (uncompress(reinterpret_cast<Bytef*>(&joined[0]), &length,
+                   reinterpret_cast<const Bytef*>(data.data() + sizeof(raw_size)),
+                   static_cast<uLong>(data.size() - sizeof(raw_size))) != Z_OK || length != raw_size) {
+        LOG(WARNING) << "Affected file list " << entry.affected_files_ref << " is corrupted";
+        return files;
+    }
+    std::istringstream stream(joined);
+    std::string line;
+    while (std::getline(stream, line)) {
+        files.push_back(line);
+    }
+    return files;
+}
+
+bool HistoryLog::append(VersionHistoryEntry& entry) {
+    // 段长度、记录数和封存都以磁盘为准：持锁后先并入其他进程的追加，再决定封存与偏移
+    FileLock lock;
+    if (!lock.lock(dir_ + "/lock")) {
+        return false;
+    }
+    if (!refresh()) {
+        return false;
+    }
+    if (active_fd_ < 0 && !open_active()) {
+        return false;
+    }
+    if (!entry.affected_files.empty()) {
+        entry.affected_files_ref = store_files(entry.affected_files);
+    }
+    if (segments_[active_segment_].records >= segment_capacity_ && !seal_active()) {
+        return false;
+    }
+
+    uint64_t seq = next_seq_;
+    std::string line = entry_to_json(entry, seq).dump() + "\n";
+    Segment& info = segments_[active_segment_];
+    // O_APPEND 下整行一次写入，中断时最多留下一个半行，打开时会被截掉
+    ssize_t written = ::write(active_fd_, line.data(), line.size());
+    if (written != static_cast<ssize_t>(line.size())) {
+        LOG(ERROR) << "Failed to append history record: " << std::strerror(errno);
+        if (written > 0 && ::ftruncate(active_fd_, static_cast<off_t>(info.bytes)) != 0) {
+            LOG(ERROR) << "Failed to roll back partial history record: " << std::strerror(errno);
+        }
+        return false;
+    }
+
+    Location location;
+    location.seq = seq;
+    location.ts_ms = to_millis(entry.timestamp);
+    location.segment = active_segment_;
+    location.offset = info.bytes;
+    location.length = static_cast<uint32_t>(line.size() - 1);
+    location.package = intern_package(entry.package_name);
+    location.files = intern_files(entry.affected_files_ref);
+    location.rollback = entry.is_rollback;
+    location.backup_size = entry.backup_size_bytes;
+
+    next_seq_++;
+    info.bytes += line.size();
+    if (info.records == 0) {
+        info.first_seq = seq;
+    }
+    info.last_seq = seq;
+    info.records++;
+    insert(location);
+    return true;
+}
+
+bool HistoryLog::read(const Location& location, VersionHistoryEntry& entry, std::map<uint32_t, int>& fds) const {
+    auto fd = fds.find(location.segment);
+    if (fd == fds.end()) {
+        std::string path = segment_path(location.segment, ".log");
+        fd = fds.emplace(location.segment, ::open(path.c_str(), O_RDONLY | O_CLOEXEC)).first;
+        if (fd->second < 0) {
+            LOG(ERROR) << "Failed to open history segment " << path << ": " << std::strerror(errno);
+        }
+    }
+    if (fd->second < 0) {
+        return false;
+    }
+    std::string line(location.length, '\0');
+    ssize_t got = ::pread(fd->second, &line[0], line.size(), static_cast<off_t>(location.offset));
+    if (got != static_cast<ssize_t>(line.size())) {
+        LOG(ERROR) << "Short read of history record " << location.seq;
+        return false;
+    }
+    try {
+        entry_from_json(json::parse(line), entry);
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Unreadable history record " << location.seq << ": " << e.what();
+        return false;
+    }
+}
+
+std::vector<VersionHistoryEntry> HistoryLog::read_all(const std::vector<const Location*>& locations) const {
+    std::vector<VersionHistoryEntry> entries;
+    entries.reserve(locations.size());
+    std::map<uint32_t, int> fds;
+    for (const Location* location : locations) {
+        VersionHistoryEntry entry;
+        if (read(*location, entry, fds)) {
+            entries.push_back(std::move(entry));
+        }
+    }
+    for (const auto& [segment, fd] : fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    return entries;
+}
+
+std::vector<std::string> HistoryLog::packages() const {
+    std::vector<std::string> names;
+    for (size_t id = 0; id < by_package_.size(); ++id) {
+        if (!by_package_[id].empty()) {
+            names.push_back(package_names_[id]);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::vector<VersionHistoryEntry> HistoryLog::package_history(const std::string& package, size_t limit) const {
+    auto id = package_ids_.find(package);
+    if (id == package_ids_.end() || id->second >= by_package_.size()) {
+        return {};
+    }
+    const auto& locations = by_package_[id->second];
+    size_t start = limit > 0 && locations.size() > limit ? locations.size() - limit : 0;
+    std::vector<const Location*> selected;
+    for (size_t i = start; i < locations.size(); ++i) {
+        selected.push_back(&locations[i]);
+    }
+    return read_all(selected);
+}
+
+std::vector<VersionHistoryEntry> HistoryLog::recent(size_t count) const {
+    size_t start = by_time_.size() > count ? by_time_.size() - count : 0;
+    std::vector<const Location*> selected;
+    for (size_t i = start; i < by_time_.size(); ++i) {
+        selected.push_back(&by_time_[i]);
+    }
+    return read_all(selected);
+}
+
+std::vector<VersionHistoryEntry> HistoryLog::range(const std::chrono::system_clock::time_point& from,
+                                                   const std::chrono::system_clock::time_point& to) const {
+    int64_t low = to_millis(from);
+    int64_t high = to_millis(to);
+    auto begin = std::lower_bound(by_time_.begin(), by_time_.end(), low,
+                                  [](const Location& location, int64_t ts) { return location.ts_ms < ts; });
+    auto end = std::upper_bound(by_time_.begin(), by_time_.end(), high,
+                                [](int64_t ts, const Location& location) { return ts < location.ts_ms; });
+    std::vector<const Location*> selected;
+    for (auto it = begin; it < end; ++it) {
+        selected.push_back(&*it);
+    }
+    return read_all(selected);
+}
+
+bool HistoryLog::find_at_or_before(const std::chrono::system_clock::time_point& timestamp,
+                                   VersionHistoryEntry& entry, const std::string& package) const {
+    const std::vector<Location>* locations = &by_time_;
+    if (!package.empty()) {
+        auto id = package_ids_.find(package);
+        if (id == package_ids_.end() || id->second >= by_package_.size()) {
+            return false;
+        }
+        locations = &by_package_[id->second];
+    }
+    int64_t ts = to_millis(timestamp);
+    auto it = std::upper_bound(locations->begin(), locations->end(), ts,
+                               [](int64_t value, const Location& location) { return value < location.ts_ms; });
+    if (it == locations->begin()) {
+        return false;
+    }
+    std::map<uint32_t, int> fds;
+    bool found = read(*std::prev(it), entry, fds);
+    for (const auto& [segment, fd] : fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    return found;
+}
+
+void HistoryLog::for_each(const std::function<bool(const VersionHistoryEntry&)>& visit) const {
+    // 分批读取，导出大量历史时内存占用有界
+    constexpr size_t kBatch = 1024;
+    for (size_t start = 0; start < by_time_.size(); start += kBatch) {
+        std::vector<const Location*> selected;
+        for (size_t i = start; i < std::min(by_time_.size(), start + kBatch); ++i) {
+            selected.push_back(&by_time_[i]);
+        }
+        for (const auto& entry : read_all(selected)) {
+            if (!visit(entry)) {
+                return;
+            }
+        }
+    }
+}
+
+HistoryLogStats HistoryLog::stats() const {
+    HistoryLogStats stats;
+    stats.entries = by_time_.size();
+    for (const auto& locations : by_package_) {
+        if (!locations.empty()) {
+            stats.packages++;
+        }
+    }
+    stats.rollbacks = rollbacks_;
+    stats.segments = segments_.size();
+    stats.backup_bytes = backup_bytes_;
+    if (!by_time_.empty()) {
+        stats.first = from_millis(by_time_.front().ts_ms);
+        stats.last = from_millis(by_time_.back().ts_ms);
+    }
+    return stats;
+}
+
+bool HistoryLog::save_retention() const {
+    return write_file_atomic(dir_ + "/retention", std::to_string(first_seq_) + "\n");
+}
+
+size_t HistoryLog::retain_latest(size_t keep, std::vector<VersionHistoryEntry>* dropped) {
+    FileLock lock;
+    if (!lock.lock(dir_ + "/lock") || !refresh()) {
+        return 0;
+    }
+    if (by_time_.size() <= keep) {
+        return 0;
+    }
+    std::vector<uint64_t> seqs;
+    seqs.reserve(by_time_.size());
+    for (const auto& location : by_time_) {
+        seqs.push_back(location.seq);
+    }
+    size_t remove = by_time_.size() - keep;
+    std::nth_element(seqs.begin(), seqs.begin() + static_cast<std::ptrdiff_t>(remove), seqs.end());
+    uint64_t cut = keep > 0 ? seqs[remove] : next_seq_;
+
+    if (dropped) {
+        std::vector<const Location*> selected;
+        for (const auto& location : by_time_) {
+            if (location.seq < cut) {
+                selected.push_back(&location);
+            }
+        }
+        *dropped = read_all(selected);
+    }
+
+    // 先持久化保留起点，之后即使删除段文件中断，重新打开时也不会再看到这些记录
+    uint64_t previous_first = first_seq_;
+    first_seq_ = cut;
+    if (!save_retention()) {
+        first_seq_ = previous_first;
+        LOG(ERROR) << "Failed to update history retention in " << dir_;
+        return 0;
+    }
+
+    auto expired = [cut](const Location& location) { return location.seq < cut; };
+    for (const auto& location : by_time_) {
+        if (expired(location)) {
+            if (location.rollback) {
+                rollbacks_--;
+            }
+            backup_bytes_ -= location.backup_size;
+        }
+    }
+    by_time_.erase(std::remove_if(by_time_.begin(), by_time_.end(), expired), by_time_.end());
+    for (auto& locations : by_package_) {
+        locations.erase(std::remove_if(locations.begin(), locations.end(), expired), locations.end());
+    }
+
+    // 重新统计各段的存活记录，整段过期的段连同索引删除
+    for (auto& [segment, info] : segments_) {
+        info.records = 0;
+    }
+    for (const auto& location : by_time_) {
+        Segment& info = segments_[location.segment];
+        if (info.records == 0 || location.seq < info.first_seq) {
+            info.first_seq = location.seq;
+        }
+        if (info.records == 0 || location.seq > info.last_seq) {
+            info.last_seq = location.seq;
+        }
+        info.records++;
+    }
+    std::error_code ec;
+    for (auto it = segments_.begin(); it != segments_.end();) {
+        if (it->first == active_segment_ || it->second.records > 0) {
+            ++it;
+            continue;
+        }
+        fs::remove(segment_path(it->first, ".log"), ec);
+        fs::remove(segment_path(it->first, ".idx"), ec);
+        it = segments_.erase(it);
+    }
+
+    // 删除不再被任何记录引用的文件列表
+    std::vector<bool> referenced(file_refs_.size(), false);
+    for (const auto& location : by_time_) {
+        referenced[location.files] = true;
+    }
+    for (size_t id = 1; id < file_refs_.size(); ++id) {
+        if (!referenced[id] && !file_refs_[id].empty()) {
+            fs::remove(dir_ + "/files/" + file_refs_[id] + ".z", ec);
+            file_ref_ids_.erase(file_refs_[id]);
+            file_refs_[id].clear();
+        }
+    }
+
+    LOG(INFO) << "Removed " << remove << " old history entries from " << dir_;
+    return remove;
+}
+
+} // namespace Paker
@@ -0,0 +1,71 @@
+#include "Paker/core/async_io.h"
+
+#if defined(PAKER_HAVE_COROUTINES)
+
+#include <glog/logging.h>
+
+namespace Paker {
+
+namespace {
+
+// co_await 时提交操作；完成回调在工作线程上恢复协程，之后不再访问等待器
+template<typename Operation>
+class OperationAwaiter {
+public:
+    OperationAwaiter(AsyncIOManager& manager, std::shared_ptr<Operation> operation)
+        : manager_(manager), operation_(std::move(operation)) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        operation_->set_completion_callback([handle] { handle.resume(); });
+        AsyncIOManager& manager = manager_;
+        std::shared_ptr<AsyncIOOperation> operation = operation_;
+        manager.submit_operation(std::move(operation));
+    }
+    auto await_resume() const { return take_operation_result(*operation_); }
+
+private:
+    AsyncIOManager& manager_;
+    std::shared_ptr<Operation> operation_;
+};
+
+template<typename Operation>
+OperationAwaiter<Operation> await_operation(AsyncIOManager& manager, std::shared_ptr<Operation> operation) {
+    return OperationAwaiter<Operation>(manager, std::move(operation));
+}
+
+detail::detached_task run_spawned(task<void> work) {
+    try {
+        co_await work;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Exception in spawned task: " << e.what();
+    }
+}
+
+} // namespace
+
+task<std::shared_ptr<FileReadResult>> AsyncIOManager::read_file_task(std::string file_path, bool read_as_text) {
+    co_return co_await await_operation(*this, std::make_shared<AsyncFileReadOperation>(file_path, read_as_text));
+}
+
+task<std::shared_ptr<FileWriteResult>> AsyncIOManager::write_file_task(std::string file_path, std::string content) {
+    co_return co_await await_operation(*this, std::make_shared<AsyncFileWriteOperation>(file_path, content));
+}
+
+task<std::shared_ptr<FileWriteResult>> AsyncIOManager::write_file_task(std::string file_path, std::vector<char> data) {
+    co_return co_await await_operation(*this, std::make_shared<AsyncFileWriteOperation>(file_path, data));
+}
+
+task<std::shared_ptr<NetworkDownloadResult>> AsyncIOManager::download_task(std::string url, std::string local_path) {
+    co_return co_await await_operation(*this, std::make_shared<AsyncNetworkDownloadOperation>(url, local_path));
+}
+
+void IOExecutor::spawn(task<void> work) {
+    manager_.post([work = std::make_shared<task<void>>(std::move(work))] {
+        run_spawned(std::move(*work));
+    });
+}
+
+} // namespace Paker
+
+#endif // PAKER_HAVE_COROUTINES
@@ -0,0 +1,642 @@
+#include "Paker/core/io_uring_engine.h"
+#include "Paker/cache/materializer.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+// 直接描述符（open/close 到注册文件表）要求内核 5.15 以上；
+// 以 5.19 头文件引入的 IORING_FILE_INDEX_ALLOC 判断头文件里有 sqe->file_index 等字段
+#if defined(IORING_FILE_INDEX_ALLOC)
+#define PAKER_HAS_IO_URING 1
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+std::atomic<int> g_default_backend{-1};
+
+// 每条链内各操作的序号，user_data = 槽位 * kOpsPerSlot + 序号
+constexpr unsigned kOpOpen = 0;
+constexpr unsigned kOpData = 1;
+constexpr unsigned kOpClose = 2;
+constexpr unsigned kOpStat = 3;
+constexpr unsigned kOpSync = 3;     // 写入链不取 statx，与 kOpStat 共用序号
+constexpr unsigned kOpsPerSlot = 4;
+
+// 同步读取整个文件，从 offset 开始追加到 data
+int read_file_sync(const std::string& path, std::string& data, size_t offset) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+    data.resize(offset);
+    char buffer[64 * 1024];
+    int error = 0;
+    for (;;) {
+        ssize_t n = ::pread(fd, buffer, sizeof(buffer), static_cast<off_t>(data.size()));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return error;
+}
+
+bool write_file_sync(const std::string& path, std::string_view data, bool sync) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool synced = !sync || (written == data.size() && ::fdatasync(fd) == 0);
+    return ::close(fd) == 0 && written == data.size() && synced;
+}
+
+} // namespace
+
+IOBackend parse_io_backend(const std::string& name) {
+    if (name == "io_uring" || name == "uring") {
+        return IOBackend::IO_URING;
+    }
+    if (name == "threads" || name == "thread_pool") {
+        return IOBackend::THREAD_POOL;
+    }
+    return IOBackend::AUTO;
+}
+
+const char* io_backend_name(IOBackend backend) {
+    switch (backend) {
+        case IOBackend::IO_URING: return "io_uring";
+        case IOBackend::THREAD_POOL: return "threads";
+        default: return "auto";
+    }
+}
+
+IOBackend default_io_backend() {
+    int value = g_default_backend.load(std::memory_order_relaxed);
+    if (value < 0) {
+        const char* env = std::getenv("PAKER_IO_BACKEND");
+        value = static_cast<int>(env ? parse_io_backend(env) : IOBackend::AUTO);
+        g_default_backend.store(value, std::memory_order_relaxed);
+    }
+    return static_cast<IOBackend>(value);
+}
+
+void set_default_io_backend(IOBackend backend) {
+    g_default_backend.store(static_cast<int>(backend), std::memory_order_relaxed);
+}
+
+bool should_use_io_uring(IOBackend backend) {
+    if (backend == IOBackend::THREAD_POOL) {
+        return false;
+    }
+    bool supported = IoUringEngine::is_supported();
+    if (!supported && backend == IOBackend::IO_URING) {
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+            LOG(WARNING) << "io_uring backend requested but not available, falling back to thread pool";
+        }
+    }
+    return supported;
+}
+
+#if defined(PAKER_HAS_IO_URING)
+
+struct IoUringEngine::Ring {
+    int fd = -1;
+    void* sq_map = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned local_tail = 0;
+    unsigned pending = 0;
+
+    // 每个槽位一块 kBufferSize 的缓冲区，注册成功时用 READ_FIXED 读入
+    char* buffers = static_cast<char*>(MAP_FAILED);
+    bool fixed_buffers = false;
+
+    ~Ring() {
+        if (buffers != MAP_FAILED) munmap(buffers, kSlotCount * kBufferSize);
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_map != MAP_FAILED && cq_map != sq_map) munmap(cq_map, cq_map_size);
+        if (sq_map != MAP_FAILED) munmap(sq_map, sq_map_size);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        unsigned flags = 0;
+#if defined(IORING_SETUP_DEFER_TASKRUN)
+        // 环只在创建线程上使用，完成事件推迟到 io_uring_enter 时处理，减少中断式的任务唤醒。
+        // 两个标志分别来自 6.0/6.1，头文件较旧时不设置；内核较旧时返回 EINVAL，去掉后重试
+        flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+#endif
+        params.flags = flags;
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0 && errno == EINVAL && flags != 0) {
+            std::memset(&params, 0, sizeof(params));
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        }
+        if (fd < 0) {
+            return false;
+        }
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            return false;
+        }
+        cq_map = single_mmap ? sq_map
+                             : mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    fd, IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) {
+            return false;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_map);
+        char* cq = static_cast<char*>(cq_map);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        local_tail = *sq_tail;
+
+        // 稀疏注册文件表：open 直接落到槽位，后续 read/write/close 不再经过进程 fd 表
+        std::vector<int> files(kSlotCount, -1);
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_FILES, files.data(), kSlotCount) < 0) {
+            return false;
+        }
+
+        buffers = static_cast<char*>(mmap(nullptr, kSlotCount * kBufferSize, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buffers == MAP_FAILED) {
+            return false;
+        }
+        std::vector<iovec> iovecs(kSlotCount);
+        for (unsigned i = 0; i < kSlotCount; ++i) {
+            iovecs[i].iov_base = buffers + i * kBufferSize;
+            iovecs[i].iov_len = kBufferSize;
+        }
+        // 注册缓冲区受 RLIMIT_MEMLOCK 限制，失败时退回普通 READ
+        fixed_buffers = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                kSlotCount) == 0;
+        return true;
+    }
+
+    char* buffer(unsigned slot) { return buffers + slot * kBufferSize; }
+
+    io_uring_sqe* get_sqe(unsigned slot, unsigned op) {
+        unsigned index = local_tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = slot * kOpsPerSlot + op;
+        sq_array[index] = index;
+        local_tail++;
+        pending++;
+        return sqe;
+    }
+
+    // 直接描述符不能带 O_CLOEXEC，注册文件表本身不会被子进程继承
+    void prep_open(unsigned slot, const char* path, int flags, mode_t mode, __u8 sqe_flags = IOSQE_IO_LINK) {
+        io_uring_sqe* sqe = get_sqe(slot, kOpOpen);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uintptr_t>(path);
+        sqe->len = mode;
+        sqe->open_flags = static_cast<__u32>(flags);
+        sqe->file_index = slot + 1;
+        sqe->flags = sqe_flags;
+    }
+
+    void prep_rw(unsigned slot, __u8 opcode, const void* data, size_t size) {
+        io_uring_sqe* sqe = get_sqe(slot, kOpData);
+        sqe->opcode = opcode;
+        sqe->fd = static_cast<__s32>(slot);
+        sqe->addr = reinterpret_cast<uintptr_t>(data);
+        sqe->len = static_cast<__u32>(size);
+        sqe->off = 0;
+        if (opcode == IORING_OP_READ_FIXED || opcode == IORING_OP_WRITE_FIXED) {
+            sqe->buf_index = static_cast<__u16>(slot);
+        }
+        // 硬链接：读写失败或短读时仍然执行后面的 close，释放注册文件槽
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    }
+
+    // 刷写注册文件槽中的文件；硬链接保证之后的 close 一定执行
+    void prep_fsync(unsigned slot) {
+        io_uring_sqe* sqe = get_sqe(slot, kOpSync);
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = static_cast<__s32>(slot);
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    }
+
+    void prep_close(unsigned slot) {
+        io_uring_sqe* sqe = get_sqe(slot, kOpClose);
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->file_index = slot + 1;
+    }
+
+    void prep_statx(unsigned slot, const char* path, struct statx* out) {
+        io_uring_sqe* sqe = get_sqe(slot, kOpStat);
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uintptr_t>(path);
+        sqe->len = STATX_MODE;
+        sqe->off = reinterpret_cast<uintptr_t>(out);
+        sqe->statx_flags = AT_STATX_SYNC_AS_STAT;
+    }
+};
+
+IoUringEngine::IoUringEngine() {
+    auto ring = std::make_unique<Ring>();
+    if (!ring->setup(kSlotCount * kOpsPerSlot)) {
+        return;
+    }
+    ring_ = std::move(ring);
+
+    // 自检：旧内核不支持直接描述符，open 会返回 -EINVAL
+    std::vector<int> results;
+    ring_->prep_open(0, ".", O_RDONLY | O_DIRECTORY, 0, 0);
+    submit_and_wait(results);
+    if (!ring_ || results[kOpOpen] < 0) {
+        ring_.reset();
+        return;
+    }
+    ring_->prep_close(0);
+    submit_and_wait(results);
+    stats_ = IoUringStats{};
+}
+
+IoUringEngine::~IoUringEngine() = default;
+
+void IoUringEngine::submit_and_wait(std::vector<int>& results) {
+    Ring& ring = *ring_;
+    results.assign(kSlotCount * kOpsPerSlot, -ECANCELED);
+
+    unsigned expected = ring.pending;
+    unsigned to_submit = ring.pending;
+    __atomic_store_n(ring.sq_tail, ring.local_tail, __ATOMIC_RELEASE);
+    stats_.sqes_submitted += to_submit;
+    ring.pending = 0;
+
+    unsigned seen = 0;
+    while (seen < expected) {
+        // 断链时后续操作也会以 -ECANCELED 完成，所以一次等齐本轮剩余的完成事件不会挂起；
+        // 刷写链的完成时间参差不齐，逐个等待会让 io_uring_enter 次数随文件数增长
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring.fd, to_submit, expected - seen,
+                                           IORING_ENTER_GETEVENTS, nullptr, 0));
+        stats_.submit_calls++;
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            // 环已不可用：整轮结果作废，由调用方同步补做
+            LOG(ERROR) << "io_uring_enter failed: " << std::strerror(errno) << ", disabling io_uring engine";
+            results.assign(kSlotCount * kOpsPerSlot, -ECANCELED);
+            ring_.reset();
+            return;
+        }
+        to_submit -= std::min(to_submit, static_cast<unsigned>(ret));
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head, ++seen) {
+            const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+            if (cqe.user_data < results.size()) {
+                results[cqe.user_data] = cqe.res;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+std::vector<IoUringReadResult> IoUringEngine::read_files(const std::vector<std::string>& paths) {
+    std::vector<IoUringReadResult> results(paths.size());
+    std::vector<int> cqe;
+
+    for (size_t start = 0; start < paths.size(); start += kSlotCount) {
+        unsigned count = static_cast<unsigned>(std::min<size_t>(kSlotCount, paths.size() - start));
+        if (ring_) {
+            for (unsigned slot = 0; slot < count; ++slot) {
+                ring_->prep_open(slot, paths[start + slot].c_str(), O_RDONLY, 0);
+                ring_->prep_rw(slot, ring_->fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ,
+                               ring_->buffer(slot), kBufferSize);
+                ring_->prep_close(slot);
+            }
+            submit_and_wait(cqe);
+        } else {
+            cqe.assign(kSlotCount * kOpsPerSlot, -ECANCELED);
+        }
+
+        for (unsigned slot = 0; slot < count; ++slot) {
+            IoUringReadResult& result = results[start + slot];
+            int open_res = cqe[slot * kOpsPerSlot + kOpOpen];
+            int read_res = cqe[slot * kOpsPerSlot + kOpData];
+            if (open_res < 0 && open_res != -ECANCELED) {
+                result.error = -open_res;
+                continue;
+            }
+            if (open_res >= 0 && read_res >= 0) {
+                result.data.assign(ring_->buffer(slot), static_cast<size_t>(read_res));
+                if (ring_->fixed_buffers) {
+                    stats_.fixed_buffer_reads++;
+                }
+                if (static_cast<size_t>(read_res) < kBufferSize) {
+                    result.success = true;
+                    stats_.files_read++;
+                    stats_.bytes_read += result.data.size();
+                    continue;
+                }
+            }
+            // 文件超出单轮缓冲区，或环失效：在当前线程上同步补完
+            stats_.fallback_operations++;
+            result.error = read_file_sync(paths[start + slot], result.data, result.data.size());
+            result.success = result.error == 0;
+            if (result.success) {
+                stats_.files_read++;
+                stats_.bytes_read += result.data.size();
+            } else {
+                result.data.clear();
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<bool> IoUringEngine::write_files(const std::vector<std::pair<std::string, std::string_view>>& files,
+                                             bool sync) {
+    std::vector<bool> results(files.size(), false);
+    std::vector<int> cqe;
+
+    std::unordered_set<std::string> parents;
+    for (const auto& [path, data] : files) {
+        fs::path parent = fs::path(path).parent_path();
+        if (!parent.empty() && parents.insert(parent.string()).second) {
+            std::error_code ec;
+            fs::create_directories(parent, ec);
+        }
+    }
+
+    for (size_t start = 0; start < files.size(); start += kSlotCount) {
+        unsigned count = static_cast<unsigned>(std::min<size_t>(kSlotCount, files.size() - start));
+        if (ring_) {
+            for (unsigned slot = 0; slot < count; ++slot) {
+                const auto& [path, data] = files[start + slot];
+                ring_->prep_open(slot, path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+                ring_->prep_rw(slot, IORING_OP_WRITE, data.data(), data.size());
+                if (sync) {
+                    ring_->prep_fsync(slot);
+                }
+                ring_->prep_close(slot);
+            }
+            submit_and_wait(cqe);
+        } else {
+            cqe.assign(kSlotCount * kOpsPerSlot, -ECANCELED);
+        }
+
+        for (unsigned slot = 0; slot < count; ++slot) {
+            const auto& [path, data] = files[start + slot];
+            int open_res = cqe[slot * kOpsPerSlot + kOpOpen];
+            int write_res = cqe[slot * kOpsPerSlot + kOpData];
+            int close_res = cqe[slot * kOpsPerSlot + kOpClose];
+            int sync_res = sync ? cqe[slot * kOpsPerSlot + kOpSync] : 0;
+            if (open_res < 0 && open_res != -ECANCELED) {
+                continue;
+            }
+            bool ok = open_res >= 0 && write_res >= 0 && static_cast<size_t>(write_res) == data.size() &&
+                      sync_res >= 0 && close_res >= 0;
+            if (!ok) {
+                // 短写（超过单次写入上限的大文件）、刷写失败或环失效
+                stats_.fallback_operations++;
+                ok = write_file_sync(path, data, sync);
+            }
+            results[start + slot] = ok;
+            if (ok) {
+                stats_.files_written++;
+                stats_.bytes_written += data.size();
+                stats_.files_synced += sync ? 1 : 0;
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<bool> IoUringEngine::copy_files(const std::vector<std::pair<std::string, std::string>>& source_dest_pairs) {
+    std::vector<bool> results(source_dest_pairs.size(), false);
+    std::vector<int> cqe;
+    std::vector<struct statx> stats(kSlotCount);
+
+    std::unordered_set<std::string> parents;
+    for (const auto& [source, dest] : source_dest_pairs) {
+        fs::path parent = fs::path(dest).parent_path();
+        if (!parent.empty() && parents.insert(parent.string()).second) {
+            std::error_code ec;
+            fs::create_directories(parent, ec);
+        }
+    }
+
+    for (size_t start = 0; start < source_dest_pairs.size(); start += kSlotCount) {
+        unsigned count = static_cast<unsigned>(std::min<size_t>(kSlotCount, source_dest_pairs.size() - start));
+        std::vector<bool> via_ring(count, false);
+
+        if (ring_) {
+            // 第一轮：读源文件并取权限位
+            for (unsigned slot = 0; slot < count; ++slot) {
+                const char* source = source_dest_pairs[start + slot].first.c_str();
+                ring_->prep_open(slot, source, O_RDONLY, 0);
+                ring_->prep_rw(slot, ring_->fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ,
+                               ring_->buffer(slot), kBufferSize);
+                ring_->prep_close(slot);
+                ring_->prep_statx(slot, source, &stats[slot]);
+            }
+            submit_and_wait(cqe);
+        }
+
+        if (ring_) {
+            // 第二轮：从同一块缓冲区写出
+            for (unsigned slot = 0; slot < count; ++slot) {
+                int read_res = cqe[slot * kOpsPerSlot + kOpData];
+                if (cqe[slot * kOpsPerSlot + kOpOpen] < 0 || read_res < 0 ||
+                    static_cast<size_t>(read_res) >= kBufferSize || cqe[slot * kOpsPerSlot + kOpStat] < 0) {
+                    continue;
+                }
+                stats_.files_read++;
+                stats_.bytes_read += static_cast<size_t>(read_res);
+                via_ring[slot] = true;
+                mode_t mode = stats[slot].stx_mode & 07777;
+                ring_->prep_open(slot, source_dest_pairs[start + slot].second.c_str(),
+                                 O_WRONLY | O_CREAT | O_TRUNC, mode);
+                ring_->prep_rw(slot, ring_->fixed_buffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE,
+                               ring_->buffer(slot), static_cast<size_t>(read_res));
+                ring_->prep_close(slot);
+            }
+            std::vector<int> read_cqe = cqe;
+            submit_and_wait(cqe);
+            for (unsigned slot = 0; slot < count; ++slot) {
+                if (!via_ring[slot]) {
+                    continue;
+                }
+                int size = read_cqe[slot * kOpsPerSlot + kOpData];
+                results[start + slot] = cqe[slot * kOpsPerSlot + kOpOpen] >= 0 &&
+                                        cqe[slot * kOpsPerSlot + kOpData] == size &&
+                                        cqe[slot * kOpsPerSlot + kOpClose] >= 0;
+                if (results[start + slot]) {
+                    stats_.files_written++;
+                    stats_.bytes_written += static_cast<size_t>(size);
+                } else {
+                    via_ring[slot] = false;
+                }
+            }
+        }
+
+        // 大文件、读取失败或环失效的条目交给 FileMaterializer（reflink / copy_file_range / sendfile）
+        for (unsigned slot = 0; slot < count; ++slot) {
+            if (via_ring[slot]) {
+                continue;
+            }
+            const auto& [source, dest] = source_dest_pairs[start + slot];
+            results[start + slot] = FileMaterializer::copy_file(source, dest);
+            if (!results[start + slot]) {
+                LOG(ERROR) << "Failed to copy file " << source << " to " << dest;
+            } else {
+                stats_.fallback_operations++;
+            }
+        }
+    }
+    return results;
+}
+
+bool IoUringEngine::is_supported() {
+    static const bool supported = []() {
+        IoUringEngine probe;
+        if (!probe.is_ready()) {
+            LOG(INFO) << "io_uring is not available, batch file I/O uses the thread pool";
+            return false;
+        }
+        return true;
+    }();
+    return supported;
+}
+
+#else
+
+struct IoUringEngine::Ring {};
+
+IoUringEngine::IoUringEngine() = default;
+IoUringEngine::~IoUringEngine() = default;
+
+void IoUringEngine::submit_and_wait(std::vector<int>& results) {
+    results.assign(kSlotCount * kOpsPerSlot, -ECANCELED);
+}
+
+std::vector<IoUringReadResult> IoUringEngine::read_files(const std::vector<std::string>& paths) {
+    std::vector<IoUringReadResult> results(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        results[i].error = read_file_sync(paths[i], results[i].data, 0);
+        results[i].success = results[i].error == 0;
+    }
+    return results;
+}
+
+std::vector<bool> IoUringEngine::write_files(const std::vector<std::pair<std::string, std::string_view>>& files,
+                                             bool sync) {
+    std::vector<bool> results(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::error_code ec;
+        fs::create_directories(fs::path(files[i].first).parent_path(), ec);
+        results[i] = write_file_sync(files[i].first, files[i].second, sync);
+    }
+    return results;
+}
+
+std::vector<bool> IoUringEngine::copy_files(const std::vector<std::pair<std::string, std::string>>& source_dest_pairs) {
+    std::vector<bool> results(source_dest_pairs.size());
+    for (size_t i = 0; i < source_dest_pairs.size(); ++i) {
+        std::error_code ec;
+        fs::create_directories(fs::path(source_dest_pairs[i].second).parent_path(), ec);
+        results[i] = FileMaterializer::copy_file(source_dest_pairs[i].first, source_dest_pairs[i].second);
+    }
+    return results;
+}
+
+bool IoUringEngine::is_supported() {
+    return false;
+}
+
+#endif
+
+IoUringEngine* IoUringEngine::for_current_thread() {
+    if (!is_supported()) {
+        return nullptr;
+    }
+    thread_local std::unique_ptr<IoUringEngine> engine;
+    if (!engine) {
+        engine = std::make_unique<IoUringEngine>();
+    }
+    return engine->is_ready() ? engine.get() : nullptr;
+}
+
+} // namespace Paker
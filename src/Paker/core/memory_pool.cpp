@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cstring>
 #include <cmath>
+#include <cstdlib>
 
 namespace Paker {
 
@@ -15,6 +16,13 @@ SmartMemoryPool::SmartMemoryPool(size_t max_pool_size, size_t small_size,
     , medium_block_size_(medium_size)
     , large_block_size_(large_size)
     , huge_block_size_(huge_size)
+    , allocator_(SlabAllocator::instance())
+    , total_allocated_(0)
+    , total_freed_(0)
+    , current_usage_(0)
+    , peak_usage_(0)
+    , allocation_count_(0)
+    , free_count_(0)
     , cleanup_enabled_(true)
     , preallocation_enabled_(true) {
     
@@ -34,7 +42,7 @@ bool SmartMemoryPool::initialize() {
         }
         
         // 启动清理线程
-        if (cleanup_enabled_) {
+        if (cleanup_enabled_ && !cleanup_thread_.joinable()) {
             cleanup_thread_ = std::thread(&SmartMemoryPool::cleanup_thread_function, this);
         }
         
@@ -48,81 +56,51 @@ bool SmartMemoryPool::initialize() {
 }
 
 void SmartMemoryPool::shutdown() {
-    cleanup_enabled_ = false;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        cleanup_enabled_ = false;
+    }
+    cleanup_cv_.notify_all();
     
     if (cleanup_thread_.joinable()) {
         cleanup_thread_.join();
     }
     
-    // 释放所有内存块
-    for (auto& block : memory_blocks_) {
-        if (block.ptr && !block.is_free) {
-            std::free(block.ptr);
-        }
-    }
-    
-    memory_blocks_.clear();
-    free_blocks_by_size_.clear();
-    free_blocks_by_type_.clear();
-    
+    // 仍未释放的块属于调用方，由 slab 分配器在其释放时回收
     LOG(INFO) << "SmartMemoryPool shutdown completed";
 }
 
 void* SmartMemoryPool::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(pool_mutex_);
-    
     if (size == 0) {
         return nullptr;
     }
     
-    MemoryBlockType type = get_block_type(size);
-    size_t block_index = find_free_block(size, type);
-    
-    if (block_index == SIZE_MAX) {
-        // 没有找到空闲块，分配新块
-        void* ptr = allocate_block(size, type);
-        if (!ptr) {
-            LOG(ERROR) << "Failed to allocate memory block of size: " << size;
-            return nullptr;
-        }
-        
-        update_statistics(size, true);
-        return ptr;
+    void* ptr = nullptr;
+    try {
+        ptr = allocator_.allocate(size);
+    } catch (const std::bad_alloc&) {
+        LOG(ERROR) << "Failed to allocate memory block of size: " << size;
+        return nullptr;
     }
     
-    // 使用现有空闲块
-    MemoryBlock& block = memory_blocks_[block_index];
-    block.is_free = false;
-    block.last_used = std::chrono::steady_clock::now();
-    
-    update_statistics(size, true);
-    return block.ptr;
+    update_statistics(allocator_.usable_size(ptr), true);
+    return ptr;
 }
 
 void SmartMemoryPool::deallocate(void* ptr) {
     if (!ptr) {
         return;
     }
-    
-    std::lock_guard<std::mutex> lock(pool_mutex_);
-    
-    // 查找对应的内存块
-    for (size_t i = 0; i < memory_blocks_.size(); ++i) {
-        MemoryBlock& block = memory_blocks_[i];
-        if (block.ptr == ptr && !block.is_free) {
-            block.is_free = true;
-            block.last_used = std::chrono::steady_clock::now();
-            
-            // 添加到空闲块列表
-            free_blocks_by_size_[block.size].push_back(i);
-            free_blocks_by_type_[block.type].push_back(i);
-            
-            update_statistics(block.size, false);
-            return;
-        }
+    if (!allocator_.owns(ptr)) {
+        LOG(WARNING) << "Attempted to deallocate unknown pointer: " << ptr;
+        return;
     }
     
-    LOG(WARNING) << "Attempted to deallocate unknown pointer: " << ptr;
+    // 内部指针与重复释放由分配器拒绝，统计不变
+    size_t size = allocator_.usable_size(ptr);
+    if (allocator_.deallocate(ptr)) {
+        update_statistics(size, false);
+    }
 }
 
 void* SmartMemoryPool::reallocate(void* ptr, size_t new_size) {
@@ -135,28 +113,24 @@ void* SmartMemoryPool::reallocate(void* ptr, size_t new_size) {
         return nullptr;
     }
     
-    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (!allocator_.owns(ptr)) {
+        LOG(WARNING) << "Attempted to reallocate unknown pointer: " << ptr;
+        return nullptr;
+    }
     
-    // 查找现有块
-    for (auto& block : memory_blocks_) {
-        if (block.ptr == ptr && !block.is_free) {
-            if (new_size <= block.size) {
-                // 新大小小于等于现有大小，直接返回
-                return ptr;
-            } else {
-                // 需要更大的块，分配新块并复制数据
-                void* new_ptr = allocate(new_size);
-                if (new_ptr) {
-                    std::memcpy(new_ptr, ptr, block.size);
-                    deallocate(ptr);
-                }
-                return new_ptr;
-            }
-        }
+    // 现有块足够大，直接返回
+    size_t old_size = allocator_.usable_size(ptr);
+    if (new_size <= old_size) {
+        return ptr;
     }
     
-    LOG(WARNING) << "Attempted to reallocate unknown pointer: " << ptr;
-    return nullptr;
+    // 需要更大的块，分配新块并复制数据
+    void* new_ptr = allocate(new_size);
+    if (new_ptr) {
+        std::memcpy(new_ptr, ptr, old_size);
+        deallocate(ptr);
+    }
+    return new_ptr;
 }
 
 MemoryBlockType SmartMemoryPool::get_block_type(size_t size) const {
@@ -171,95 +145,28 @@ MemoryBlockType SmartMemoryPool::get_block_type(size_t size) const {
     }
 }
 
-size_t SmartMemoryPool::find_free_block(size_t size, MemoryBlockType type) {
-    // 首先在相同类型的空闲块中查找
-    auto& free_blocks = free_blocks_by_type_[type];
-    for (size_t i = 0; i < free_blocks.size(); ++i) {
-        size_t block_index = free_blocks[i];
-        if (memory_blocks_[block_index].size >= size) {
-            // 找到合适的块，从列表中移除
-            free_blocks.erase(free_blocks.begin() + i);
-            return block_index;
-        }
-    }
-    
-    // 在相同大小的空闲块中查找
-    auto& size_blocks = free_blocks_by_size_[size];
-    if (!size_blocks.empty()) {
-        size_t block_index = size_blocks.back();
-        size_blocks.pop_back();
-        return block_index;
-    }
-    
-    return SIZE_MAX;
-}
-
-void* SmartMemoryPool::allocate_block(size_t size, MemoryBlockType type) {
-    void* ptr = std::malloc(size);
-    if (!ptr) {
-        return nullptr;
-    }
-    
-    MemoryBlock block;
-    block.ptr = ptr;
-    block.size = size;
-    block.is_free = false;
-    block.last_used = std::chrono::steady_clock::now();
-    block.type = type;
-    
-    memory_blocks_.push_back(block);
-    
-    return ptr;
-}
-
 void SmartMemoryPool::update_statistics(size_t size, bool is_allocation) {
     if (is_allocation) {
-        stats_.total_allocated += size;
-        stats_.current_usage += size;
-        stats_.allocation_count++;
+        total_allocated_.fetch_add(size, std::memory_order_relaxed);
+        allocation_count_.fetch_add(1, std::memory_order_relaxed);
+        size_t usage = current_usage_.fetch_add(size, std::memory_order_relaxed) + size;
         
-        if (stats_.current_usage > stats_.peak_usage) {
-            stats_.peak_usage = stats_.current_usage;
+        size_t peak = peak_usage_.load(std::memory_order_relaxed);
+        while (usage > peak && !peak_usage_.compare_exchange_weak(peak, usage, std::memory_order_relaxed)) {
         }
     } else {
-        stats_.total_freed += size;
-        stats_.current_usage -= size;
-        stats_.free_count++;
-    }
-    
-    // 计算碎片化比率
-    if (stats_.total_allocated > 0) {
-        stats_.fragmentation_ratio = static_cast<double>(stats_.total_freed) / stats_.total_allocated;
+        total_freed_.fetch_add(size, std::memory_order_relaxed);
+        current_usage_.fetch_sub(size, std::memory_order_relaxed);
+        free_count_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
 void SmartMemoryPool::cleanup_unused_blocks() {
-    auto now = std::chrono::steady_clock::now();
-    auto cleanup_threshold = std::chrono::minutes(5); // 5分钟未使用的块
-    
-    std::vector<size_t> blocks_to_remove;
-    
-    for (size_t i = 0; i < memory_blocks_.size(); ++i) {
-        MemoryBlock& block = memory_blocks_[i];
-        if (block.is_free && (now - block.last_used) > cleanup_threshold) {
-            blocks_to_remove.push_back(i);
-        }
-    }
+    // 空闲 slab 在分配器的全局缓存中，归还给系统
+    size_t released = allocator_.trim();
     
-    // 从后往前删除，避免索引变化
-    for (auto it = blocks_to_remove.rbegin(); it != blocks_to_remove.rend(); ++it) {
-        size_t index = *it;
-        MemoryBlock& block = memory_blocks_[index];
-        
-        if (block.ptr) {
-            std::free(block.ptr);
-        }
-        
-        memory_blocks_.erase(memory_blocks_.begin() + index);
-    }
-    
-    if (!blocks_to_remove.empty()) {
-        LOG(INFO) << "Cleaned up " << blocks_to_remove.size() << " unused memory blocks";
+    if (released > 0) {
+        LOG(INFO) << "Cleaned up " << released << " unused memory blocks";
     }
 }
 
@@ -273,18 +180,6 @@ void SmartMemoryPool::optimize() {
     // 清理未使用的块
     cleanup_unused_blocks();
     
-    // 压缩内存块向量
-    memory_blocks_.shrink_to_fit();
-    
-    // 清理空闲块映射
-    for (auto& [size, blocks] : free_blocks_by_size_) {
-        blocks.shrink_to_fit();
-    }
-    
-    for (auto& [type, blocks] : free_blocks_by_type_) {
-        blocks.shrink_to_fit();
-    }
-    
     LOG(INFO) << "Memory pool optimization completed";
 }
 
@@ -296,52 +191,57 @@ void SmartMemoryPool::enable_preallocation(bool enable) {
 }
 
 size_t SmartMemoryPool::get_current_usage() const {
-    return stats_.current_usage;
+    return current_usage_.load(std::memory_order_relaxed);
+}
+
+size_t SmartMemoryPool::get_peak_usage() const {
+    return peak_usage_.load(std::memory_order_relaxed);
 }
 
 MemoryPoolStats SmartMemoryPool::get_statistics() const {
-    return stats_;
+    MemoryPoolStats stats;
+    stats.total_allocated = total_allocated_.load(std::memory_order_relaxed);
+    stats.total_freed = total_freed_.load(std::memory_order_relaxed);
+    stats.current_usage = current_usage_.load(std::memory_order_relaxed);
+    stats.peak_usage = peak_usage_.load(std::memory_order_relaxed);
+    stats.allocation_count = allocation_count_.load(std::memory_order_relaxed);
+    stats.free_count = free_count_.load(std::memory_order_relaxed);
+    
+    // 计算碎片化比率
+    if (stats.total_allocated > 0) {
+        stats.fragmentation_ratio = static_cast<double>(stats.total_freed) / stats.total_allocated;
+    }
+    
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    stats.last_cleanup = last_cleanup_;
+    return stats;
 }
 
 void SmartMemoryPool::preallocate_blocks() {
     LOG(INFO) << "Preallocating memory blocks...";
     
-    // 预分配小对象块
-    for (size_t i = 0; i < preallocated_blocks_[MemoryBlockType::SMALL]; ++i) {
-        void* ptr = std::malloc(small_block_size_);
-        if (ptr) {
-            MemoryBlock block;
-            block.ptr = ptr;
-            block.size = small_block_size_;
-            block.is_free = true;
-            block.type = MemoryBlockType::SMALL;
-            memory_blocks_.push_back(block);
-        }
-    }
-    
-    // 预分配中等对象块
-    for (size_t i = 0; i < preallocated_blocks_[MemoryBlockType::MEDIUM]; ++i) {
-        void* ptr = std::malloc(medium_block_size_);
-        if (ptr) {
-            MemoryBlock block;
-            block.ptr = ptr;
-            block.size = medium_block_size_;
-            block.is_free = true;
-            block.type = MemoryBlockType::MEDIUM;
-            memory_blocks_.push_back(block);
-        }
+    // 小对象和中等对象预分配折算成 slab 放入分配器缓存
+    size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        bytes += preallocated_blocks_[MemoryBlockType::SMALL] * small_block_size_;
+        bytes += preallocated_blocks_[MemoryBlockType::MEDIUM] * medium_block_size_;
     }
+    allocator_.reserve((bytes + SlabAllocator::kSlabSize - 1) / SlabAllocator::kSlabSize);
     
     LOG(INFO) << "Preallocation completed";
 }
 
 void SmartMemoryPool::cleanup_thread_function() {
+    std::unique_lock<std::mutex> lock(pool_mutex_);
     while (cleanup_enabled_) {
-        std::this_thread::sleep_for(std::chrono::minutes(1));
+        cleanup_cv_.wait_for(lock, std::chrono::minutes(1), [this]() { return !cleanup_enabled_; });
         
         if (cleanup_enabled_) {
+            lock.unlock();
             cleanup_unused_blocks();
-            stats_.last_cleanup = std::chrono::steady_clock::now();
+            lock.lock();
+            last_cleanup_ = std::chrono::steady_clock::now();
         }
     }
 }
@@ -437,6 +337,22 @@ std::unique_ptr<ConfigMemoryPool> GlobalMemoryManager::config_pool_;
 std::mutex GlobalMemoryManager::manager_mutex_;
 std::atomic<bool> GlobalMemoryManager::initialized_{false};
 
+namespace {
+
+// 初始化前的块来自 malloc，不属于 slab；这类块交还 free，其余的块返回 false 由调用方释放
+bool free_unpooled(void* ptr) {
+    if (!ptr) {
+        return true;
+    }
+    if (!SlabAllocator::instance().owns(ptr)) {
+        std::free(ptr);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
 bool GlobalMemoryManager::initialize_global_pools() {
     std::lock_guard<std::mutex> lock(manager_mutex_);
     
@@ -501,15 +417,20 @@ void GlobalMemoryManager::shutdown_global_pools() {
 
 void* GlobalMemoryManager::global_allocate(size_t size) {
     if (!initialized_) {
+        // 未初始化时回退到 malloc，失败返回 nullptr 而不抛异常
         return std::malloc(size);
     }
     
     return global_pool_->allocate(size);
 }
 
+// 释放时按块的来源分派：malloc 的块交还 free；slab 的块在内存池关闭后直接还给 slab
 void GlobalMemoryManager::global_deallocate(void* ptr) {
+    if (free_unpooled(ptr)) {
+        return;
+    }
     if (!initialized_) {
-        std::free(ptr);
+        SlabAllocator::instance().deallocate(ptr);
         return;
     }
     
@@ -525,8 +446,11 @@ char* GlobalMemoryManager::allocate_string(size_t length) {
 }
 
 void GlobalMemoryManager::deallocate_string(char* str) {
+    if (free_unpooled(str)) {
+        return;
+    }
     if (!initialized_) {
-        std::free(str);
+        SlabAllocator::instance().deallocate(str);
         return;
     }
     
@@ -542,8 +466,11 @@ void* GlobalMemoryManager::allocate_config(size_t size) {
 }
 
 void GlobalMemoryManager::deallocate_config(void* ptr) {
+    if (free_unpooled(ptr)) {
+        return;
+    }
     if (!initialized_) {
-        std::free(ptr);
+        SlabAllocator::instance().deallocate(ptr);
         return;
     }
     
@@ -1,4 +1,5 @@
 #include "Paker/core/openmp_io.h"
+#include "Paker/cache/materializer.h"
 #include <fstream>
 #include <iostream>
 #include <chrono>
@@ -22,16 +23,51 @@ std::vector<std::string> OpenMPIOManager::read_text_files_parallel(const std::ve
     std::vector<std::string> results(file_paths.size());
     std::vector<bool> success_flags(file_paths.size(), false);
     
-    // 使用OpenMP并行读取文件
-    #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
-    for (size_t i = 0; i < file_paths.size(); ++i) {
-        auto [success, content] = read_single_text_file(file_paths[i]);
-        if (success) {
-            results[i] = std::move(content);
-            success_flags[i] = true;
-        } else {
-            results[i] = "";
-            success_flags[i] = false;
+    if (IoUringEngine* engine = batch_engine()) {
+        // 小文件由调用线程经 io_uring 批量提交，大文件同时在其余 OpenMP 线程上读取
+        std::vector<size_t> small, large;
+        split_by_ring_buffer(file_paths, small, large);
+        std::vector<std::string> small_paths;
+        small_paths.reserve(small.size());
+        for (size_t i : small) {
+            small_paths.push_back(file_paths[i]);
+        }
+        std::vector<char> large_flags(large.size(), 0);
+        
+        #pragma omp parallel num_threads(max_threads_)
+        {
+            #pragma omp master
+            {
+                auto read_results = engine->read_files(small_paths);
+                for (size_t k = 0; k < small.size(); ++k) {
+                    results[small[k]] = std::move(read_results[k].data);
+                    success_flags[small[k]] = read_results[k].success;
+                }
+            }
+            #pragma omp for schedule(dynamic)
+            for (size_t k = 0; k < large.size(); ++k) {
+                auto [success, content] = read_single_text_file(file_paths[large[k]]);
+                if (success) {
+                    results[large[k]] = std::move(content);
+                    large_flags[k] = 1;
+                }
+            }
+        }
+        for (size_t k = 0; k < large.size(); ++k) {
+            success_flags[large[k]] = large_flags[k] != 0;
+        }
+    } else {
+        // 使用OpenMP并行读取文件
+        #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
+        for (size_t i = 0; i < file_paths.size(); ++i) {
+            auto [success, content] = read_single_text_file(file_paths[i]);
+            if (success) {
+                results[i] = std::move(content);
+                success_flags[i] = true;
+            } else {
+                results[i] = "";
+                success_flags[i] = false;
+            }
         }
     }
     
@@ -54,16 +90,51 @@ std::vector<std::vector<char>> OpenMPIOManager::read_binary_files_parallel(const
     std::vector<std::vector<char>> results(file_paths.size());
     std::vector<bool> success_flags(file_paths.size(), false);
     
-    // 使用OpenMP并行读取文件
-    #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
-    for (size_t i = 0; i < file_paths.size(); ++i) {
-        auto [success, data] = read_single_binary_file(file_paths[i]);
-        if (success) {
-            results[i] = std::move(data);
-            success_flags[i] = true;
-        } else {
-            results[i] = std::vector<char>();
-            success_flags[i] = false;
+    if (IoUringEngine* engine = batch_engine()) {
+        // 与文本读取相同：小文件走 io_uring 批量，大文件并行读取
+        std::vector<size_t> small, large;
+        split_by_ring_buffer(file_paths, small, large);
+        std::vector<std::string> small_paths;
+        small_paths.reserve(small.size());
+        for (size_t i : small) {
+            small_paths.push_back(file_paths[i]);
+        }
+        std::vector<char> large_flags(large.size(), 0);
+        
+        #pragma omp parallel num_threads(max_threads_)
+        {
+            #pragma omp master
+            {
+                auto read_results = engine->read_files(small_paths);
+                for (size_t k = 0; k < small.size(); ++k) {
+                    results[small[k]].assign(read_results[k].data.begin(), read_results[k].data.end());
+                    success_flags[small[k]] = read_results[k].success;
+                }
+            }
+            #pragma omp for schedule(dynamic)
+            for (size_t k = 0; k < large.size(); ++k) {
+                auto [success, data] = read_single_binary_file(file_paths[large[k]]);
+                if (success) {
+                    results[large[k]] = std::move(data);
+                    large_flags[k] = 1;
+                }
+            }
+        }
+        for (size_t k = 0; k < large.size(); ++k) {
+            success_flags[large[k]] = large_flags[k] != 0;
+        }
+    } else {
+        // 使用OpenMP并行读取文件
+        #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
+        for (size_t i = 0; i < file_paths.size(); ++i) {
+            auto [success, data] = read_single_binary_file(file_paths[i]);
+            if (success) {
+                results[i] = std::move(data);
+                success_flags[i] = true;
+            } else {
+                results[i] = std::vector<char>();
+                success_flags[i] = false;
+            }
         }
     }
     
@@ -85,10 +156,19 @@ std::vector<bool> OpenMPIOManager::write_text_files_parallel(const std::vector<s
     
     std::vector<bool> results(file_contents.size());
     
-    // 使用OpenMP并行写入文件
-    #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
-    for (size_t i = 0; i < file_contents.size(); ++i) {
-        results[i] = write_single_text_file(file_contents[i].first, file_contents[i].second);
+    if (IoUringEngine* engine = batch_engine()) {
+        std::vector<std::pair<std::string, std::string_view>> files;
+        files.reserve(file_contents.size());
+        for (const auto& [path, content] : file_contents) {
+            files.emplace_back(path, content);
+        }
+        results = engine->write_files(files);
+    } else {
+        // 使用OpenMP并行写入文件
+        #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
+        for (size_t i = 0; i < file_contents.size(); ++i) {
+            results[i] = write_single_text_file(file_contents[i].first, file_contents[i].second);
+        }
     }
     
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -109,10 +189,19 @@ std::vector<bool> OpenMPIOManager::write_binary_files_parallel(const std::vector
     
     std::vector<bool> results(file_data.size());
     
-    // 使用OpenMP并行写入文件
-    #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
-    for (size_t i = 0; i < file_data.size(); ++i) {
-        results[i] = write_single_binary_file(file_data[i].first, file_data[i].second);
+    if (IoUringEngine* engine = batch_engine()) {
+        std::vector<std::pair<std::string, std::string_view>> files;
+        files.reserve(file_data.size());
+        for (const auto& [path, data] : file_data) {
+            files.emplace_back(path, std::string_view(data.data(), data.size()));
+        }
+        results = engine->write_files(files);
+    } else {
+        // 使用OpenMP并行写入文件
+        #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
+        for (size_t i = 0; i < file_data.size(); ++i) {
+            results[i] = write_single_binary_file(file_data[i].first, file_data[i].second);
+        }
     }
     
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -160,25 +249,52 @@ std::vector<bool> OpenMPIOManager::copy_files_parallel(const std::vector<std::pa
     
     std::vector<bool> results(source_dest_pairs.size());
     
-    // 使用OpenMP并行复制文件
-    #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
-    for (size_t i = 0; i < source_dest_pairs.size(); ++i) {
-        try {
-            std::filesystem::path source(source_dest_pairs[i].first);
-            std::filesystem::path dest(source_dest_pairs[i].second);
-            
-            // 创建目标目录
-            if (dest.has_parent_path()) {
-                std::filesystem::create_directories(dest.parent_path());
+    IoUringEngine* engine = batch_engine();
+    // 支持 reflink 的文件系统上克隆比经 io_uring 读写更省
+    if (engine && !source_dest_pairs.empty() &&
+        FileMaterializer::filesystem_supports_reflink(source_dest_pairs.front().first)) {
+        engine = nullptr;
+    }
+    
+    if (engine) {
+        // 小文件由调用线程经 io_uring 读写，大文件同时在其余 OpenMP 线程上复制
+        std::vector<std::string> sources;
+        sources.reserve(source_dest_pairs.size());
+        for (const auto& pair : source_dest_pairs) {
+            sources.push_back(pair.first);
+        }
+        std::vector<size_t> small, large;
+        split_by_ring_buffer(sources, small, large);
+        std::vector<std::pair<std::string, std::string>> small_pairs;
+        small_pairs.reserve(small.size());
+        for (size_t i : small) {
+            small_pairs.push_back(source_dest_pairs[i]);
+        }
+        std::vector<char> large_results(large.size(), 0);
+        
+        #pragma omp parallel num_threads(max_threads_)
+        {
+            #pragma omp master
+            {
+                auto small_results = engine->copy_files(small_pairs);
+                for (size_t k = 0; k < small.size(); ++k) {
+                    results[small[k]] = small_results[k];
+                }
+            }
+            #pragma omp for schedule(dynamic)
+            for (size_t k = 0; k < large.size(); ++k) {
+                const auto& [source, dest] = source_dest_pairs[large[k]];
+                large_results[k] = copy_single_file(source, dest) ? 1 : 0;
             }
-            
-            // 复制文件
-            std::filesystem::copy_file(source, dest, std::filesystem::copy_options::overwrite_existing);
-            results[i] = true;
-        } catch (const std::exception& e) {
-            LOG(ERROR) << "Failed to copy file " << source_dest_pairs[i].first 
-                       << " to " << source_dest_pairs[i].second << ": " << e.what();
-            results[i] = false;
+        }
+        for (size_t k = 0; k < large.size(); ++k) {
+            results[large[k]] = large_results[k] != 0;
+        }
+    } else {
+        // 使用OpenMP并行复制文件
+        #pragma omp parallel for num_threads(max_threads_) schedule(dynamic)
+        for (size_t i = 0; i < source_dest_pairs.size(); ++i) {
+            results[i] = copy_single_file(source_dest_pairs[i].first, source_dest_pairs[i].second);
         }
     }
     
@@ -297,6 +413,55 @@ void OpenMPIOManager::set_thread_count(int thread_count) {
     LOG(INFO) << "OpenMP thread count set to " << thread_count;
 }
 
+void OpenMPIOManager::set_io_backend(IOBackend backend) {
+    io_backend_override_ = static_cast<int>(backend);
+    LOG(INFO) << "OpenMPIOManager I/O backend set to " << io_backend_name(backend);
+}
+
+IOBackend OpenMPIOManager::get_io_backend() const {
+    return io_backend_override_ < 0 ? default_io_backend() : static_cast<IOBackend>(io_backend_override_);
+}
+
+bool OpenMPIOManager::copy_single_file(const std::string& source, const std::string& dest) {
+    try {
+        // 创建目标目录
+        std::filesystem::path dest_path(dest);
+        if (dest_path.has_parent_path()) {
+            std::filesystem::create_directories(dest_path.parent_path());
+        }
+        
+        // 复制文件：reflink / copy_file_range 优先，最后才走用户态
+        if (!FileMaterializer::copy_file(source, dest)) {
+            LOG(ERROR) << "Failed to copy file " << source << " to " << dest;
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to copy file " << source << " to " << dest << ": " << e.what();
+        return false;
+    }
+}
+
+void OpenMPIOManager::split_by_ring_buffer(const std::vector<std::string>& file_paths,
+                                           std::vector<size_t>& small, std::vector<size_t>& large) {
+    for (size_t i = 0; i < file_paths.size(); ++i) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file_paths[i], ec);
+        if (!ec && size >= IoUringEngine::kBufferSize) {
+            large.push_back(i);
+        } else {
+            small.push_back(i);
+        }
+    }
+}
+
+IoUringEngine* OpenMPIOManager::batch_engine() const {
+    if (!should_use_io_uring(get_io_backend())) {
+        return nullptr;
+    }
+    return IoUringEngine::for_current_thread();
+}
+
 OpenMPIOManager::PerformanceStats OpenMPIOManager::get_performance_stats() const {
     std::lock_guard<std::mutex> lock(stats_mutex_);
     return stats_;
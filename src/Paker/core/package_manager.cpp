@@ -7,6 +7,7 @@
 #include "Paker/core/version_history.h"
 #include "Paker/core/service_container.h"
 #include "Paker/core/core_services.h"
+#include "Paker/core/command_arena.h"
 #include <iostream>
 #include <fstream>
 #include <memory>
@@ -20,6 +21,11 @@ namespace fs = std::filesystem;
 
 // 初始化所有Paker服务的函数
 bool initialize_paker_services() {
+    // 已初始化（例如在守护进程中）时直接复用现有服务
+    if (Paker::g_service_manager && Paker::g_service_manager->get_registered_count() > 0) {
+        return true;
+    }
+    
     try {
         // 初始化服务管理器
         if (!Paker::initialize_service_manager()) {
@@ -148,17 +154,21 @@ void pm_check_conflicts() {
     // 直接创建依赖解析器，不通过服务管理器
     std::unique_ptr<Paker::DependencyResolver> resolver = std::make_unique<Paker::DependencyResolver>();
     
-    if (!resolver->resolve_project_dependencies()) {
-        LOG(ERROR) << "Failed to resolve project dependencies";
-        Paker::Output::error("Failed to resolve project dependencies");
-        return;
-    }
-    
     auto& graph = resolver->get_dependency_graph();
-    
-    // 检测冲突
     Paker::ConflictDetector detector(graph);
-    auto conflicts = detector.detect_all_conflicts();
+    
+    // 解析与冲突检测的临时容器从 arena 分配；解析器和依赖图的生命周期更长，仍在普通堆上
+    std::vector<Paker::ConflictInfo> conflicts;
+    {
+        Paker::CommandArena arena("check-conflicts");
+        Paker::ArenaScope arena_scope(arena);
+        if (!resolver->resolve_project_dependencies()) {
+            LOG(ERROR) << "Failed to resolve project dependencies";
+            Paker::Output::error("Failed to resolve project dependencies");
+            return;
+        }
+        conflicts = detector.detect_all_conflicts();
+    }
     
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -184,17 +194,21 @@ void pm_resolve_conflicts() {
     // 直接创建依赖解析器，不通过服务管理器
     std::unique_ptr<Paker::DependencyResolver> resolver = std::make_unique<Paker::DependencyResolver>();
     
-    if (!resolver->resolve_project_dependencies()) {
-        LOG(ERROR) << "Failed to resolve project dependencies";
-        Paker::Output::error("Failed to resolve project dependencies");
-        return;
-    }
-    
     auto& graph = resolver->get_dependency_graph();
-    
-    // 检测冲突
     Paker::ConflictDetector detector(graph);
-    auto conflicts = detector.detect_all_conflicts();
+    
+    // 解析与冲突检测的临时容器从 arena 分配；解析器和依赖图的生命周期更长，仍在普通堆上
+    std::vector<Paker::ConflictInfo> conflicts;
+    {
+        Paker::CommandArena arena("resolve-conflicts");
+        Paker::ArenaScope arena_scope(arena);
+        if (!resolver->resolve_project_dependencies()) {
+            LOG(ERROR) << "Failed to resolve project dependencies";
+            Paker::Output::error("Failed to resolve project dependencies");
+            return;
+        }
+        conflicts = detector.detect_all_conflicts();
+    }
     
     if (conflicts.empty()) {
         Paker::Output::success("No conflicts to resolve");
@@ -230,7 +244,12 @@ void pm_resolve_conflicts() {
         Paker::Output::success("Conflicts resolved successfully");
         
         // 重新检测冲突以确认解决
-        auto remaining_conflicts = detector.detect_all_conflicts();
+        std::vector<Paker::ConflictInfo> remaining_conflicts;
+        {
+            Paker::CommandArena arena("resolve-conflicts");
+            Paker::ArenaScope arena_scope(arena);
+            remaining_conflicts = detector.detect_all_conflicts();
+        }
         if (remaining_conflicts.empty()) {
             Paker::Output::success("All conflicts have been resolved");
         } else {
@@ -253,7 +272,9 @@ void pm_validate_dependencies() {
     // 直接创建依赖解析器，不通过服务管理器
     std::unique_ptr<Paker::DependencyResolver> resolver = std::make_unique<Paker::DependencyResolver>();
     
-    // 解析依赖
+    // 解析依赖；临时容器从 arena 分配，依赖图仍在普通堆上
+    Paker::CommandArena arena("validate");
+    Paker::ArenaScope arena_scope(arena);
     if (!resolver->resolve_project_dependencies()) {
         LOG(ERROR) << "Failed to resolve dependencies for validation";
         Paker::Output::error("Failed to resolve dependencies for validation");
@@ -13,7 +13,8 @@ namespace Paker {
 std::unique_ptr<ParallelExecutor> g_parallel_executor;
 
 ParallelExecutor::ParallelExecutor(size_t max_workers, size_t max_concurrent_tasks)
-    : stop_flag_(false)
+    : started_(false)
+    , stop_flag_(false)
     , active_tasks_(0)
     , max_workers_(max_workers == 0 ? std::thread::hardware_concurrency() : max_workers)
     , max_concurrent_tasks_(max_concurrent_tasks)
@@ -39,6 +40,18 @@ bool ParallelExecutor::start() {
     }
     
     stop_flag_ = false;
+    started_ = true;
+    
+    // 工作线程推迟到第一个任务提交时创建，不需要并行的命令不必付出线程启动成本
+    LOG(INFO) << "ParallelExecutor started, " << max_workers_ << " workers will spawn on first task";
+    return true;
+}
+
+void ParallelExecutor::ensure_workers() {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (!workers_.empty() || stop_flag_) {
+        return;
+    }
     
     // 启动工作线程
     for (size_t i = 0; i < max_workers_; ++i) {
@@ -46,12 +59,11 @@ bool ParallelExecutor::start() {
     }
     
     // 启动负载监控线程
-    if (load_monitoring_enabled_) {
+    if (load_monitoring_enabled_ && !load_monitor_thread_.joinable()) {
         load_monitor_thread_ = std::thread(&ParallelExecutor::load_monitor_loop, this);
     }
     
     LOG(INFO) << "Started " << max_workers_ << " worker threads";
-    return true;
 }
 
 void ParallelExecutor::stop() {
@@ -62,11 +74,18 @@ void ParallelExecutor::stop() {
     stop_flag_ = true;
     queue_cv_.notify_all();
     
-    // 等待负载监控线程结束
-    if (load_monitor_thread_.joinable()) {
-        load_monitor_thread_.join();
+    // 等待负载监控线程结束；它调整线程数时要取 workers_mutex_，不能持锁等待
+    std::thread load_monitor;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        load_monitor = std::move(load_monitor_thread_);
+    }
+    if (load_monitor.joinable()) {
+        load_monitor.join();
     }
     
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    
     // 等待所有工作线程结束
     for (auto& worker : workers_) {
         if (worker.joinable()) {
@@ -74,12 +93,13 @@ void ParallelExecutor::stop() {
         }
     }
     workers_.clear();
+    started_ = false;
     
     LOG(INFO) << "ParallelExecutor stopped";
 }
 
 bool ParallelExecutor::is_running() const {
-    return !workers_.empty() && !stop_flag_;
+    return started_ && !stop_flag_;
 }
 
 std::string ParallelExecutor::submit_task(std::shared_ptr<Task> task) {
@@ -88,6 +108,8 @@ std::string ParallelExecutor::submit_task(std::shared_ptr<Task> task) {
         return "";
     }
     
+    ensure_workers();
+    
     std::lock_guard<std::mutex> lock(queue_mutex_);
     task_queue_.push(task);
     queue_cv_.notify_one();
@@ -514,7 +536,8 @@ double AdaptiveLoadBalancer::get_current_load() const {
 // ParallelExecutor 自适应负载均衡方法实现
 void ParallelExecutor::enable_adaptive_load_balancing(bool enable) {
     load_monitoring_enabled_ = enable;
-    if (enable && is_running() && !load_monitor_thread_.joinable()) {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (enable && !workers_.empty() && !stop_flag_ && !load_monitor_thread_.joinable()) {
         load_monitor_thread_ = std::thread(&ParallelExecutor::load_monitor_loop, this);
     }
 }
@@ -571,6 +594,11 @@ void ParallelExecutor::adjust_worker_count() {
     
     size_t optimal_workers = load_balancer_->calculate_optimal_workers();
     
+    // 与 ensure_workers() 和 stop() 互斥地读取并扩充 workers_
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (stop_flag_) {
+        return;
+    }
     if (optimal_workers != workers_.size()) {
         LOG(INFO) << "Adjusting worker count from " << workers_.size() 
                   << " to " << optimal_workers;
@@ -2,7 +2,9 @@
 #include "Paker/core/output.h"
 #include "Paker/dependency/version_manager.h"
 #include "Paker/dependency/dependency_resolver.h"
+#include "Paker/dependency/csr_dependency_graph.h"
 #include "Paker/cache/cache_manager.h"
+#include "Paker/core/snapshot_store.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -39,18 +41,23 @@ bool RollbackUtils::check_rollback_safety(const std::string& package_name, const
             auto& graph = resolver.get_dependency_graph();
             auto* node = graph.get_node(package_name);
             if (node) {
-                // 检查依赖该包的包
-                for (const auto& [other_name, other_node] : graph.get_nodes()) {
-                    if (other_node.dependencies.find(package_name) != other_node.dependencies.end()) {
-                        // 检查依赖包是否兼容目标版本
-                        auto constraint_it = other_node.version_constraints.find(package_name);
-                        if (constraint_it != other_node.version_constraints.end()) {
-                            if (!constraint_it->second.satisfies(target_version)) {
-                                LOG(WARNING) << "Dependency constraint violation: " << other_name 
-                                           << " requires " << package_name << " " 
-                                           << constraint_it->second.to_string();
-                                return false;
-                            }
+                // 版本约束只存在于直接依赖边上：沿CSR反向边检查直接依赖方，无需扫描全图
+                auto csr = graph.freeze();
+                auto package_id = csr->find(package_name);
+                for (auto dependent_id : csr->dependents(package_id)) {
+                    std::string other_name(csr->name(dependent_id));
+                    const auto* other_node = graph.get_node(other_name);
+                    if (!other_node) {
+                        continue;
+                    }
+                    // 检查依赖包是否兼容目标版本
+                    auto constraint_it = other_node->version_constraints.find(package_name);
+                    if (constraint_it != other_node->version_constraints.end()) {
+                        if (!constraint_it->second.satisfies(target_version)) {
+                            LOG(WARNING) << "Dependency constraint violation: " << other_name 
+                                       << " requires " << package_name << " " 
+                                       << constraint_it->second.to_string();
+                            return false;
                         }
                     }
                 }
@@ -100,6 +107,9 @@ std::string RollbackUtils::generate_rollback_report(const RollbackResult& result
     // 基本信息
     report << "Status: " << (result.success ? "[OK] Success" : "[FAIL] Failed") << "\n";
     report << "Duration: " << result.duration.count() << "ms\n";
+    if (result.generation != 0) {
+        report << "Generation: " << result.generation << " (switched in " << result.switch_latency.count() << "us)\n";
+    }
     report << "Message: " << result.message << "\n\n";
     
     // 成功回滚的包
@@ -161,6 +171,17 @@ bool RollbackUtils::validate_backup_integrity(const std::string& backup_path) {
             return false;
         }
         
+        // 快照备份：清单可读且引用的对象齐全
+        if (SnapshotStore::is_snapshot(backup_path)) {
+            SnapshotStore store(fs::path(backup_path).parent_path().string());
+            if (!store.verify(backup_path)) {
+                LOG(ERROR) << "Backup file integrity check failed: " << backup_path;
+                return false;
+            }
+            LOG(INFO) << "Backup integrity check passed: " << backup_path;
+            return true;
+        }
+        
         // 检查文件格式（tar.gz）
         if (backup_path.find(".tar.gz") == std::string::npos) {
             LOG(WARNING) << "Backup file may not be in tar.gz format: " << backup_path;
@@ -195,31 +216,22 @@ std::vector<std::string> RollbackUtils::calculate_file_differences(const std::st
             return differences;
         }
         
-        // 使用diff命令计算差异
-        std::ostringstream cmd;
-        cmd << "diff -r " << path1 << " " << path2 << " 2>/dev/null";
-        
-        FILE* pipe = popen(cmd.str().c_str(), "r");
-        if (!pipe) {
-            LOG(ERROR) << "Failed to execute diff command";
+        // 两侧目录并行计算哈希后按路径比较
+        std::vector<SnapshotEntry> before, after;
+        if (!SnapshotStore::scan_tree(path1, before) || !SnapshotStore::scan_tree(path2, after)) {
+            LOG(ERROR) << "Failed to scan directories for diff calculation";
             return differences;
         }
         
-        char buffer[128];
-        std::string result;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            result += buffer;
+        SnapshotDiff diff = SnapshotStore::diff(before, after);
+        for (const auto& path : diff.added) {
+            differences.push_back("added: " + path);
         }
-        
-        pclose(pipe);
-        
-        // 解析差异输出
-        std::istringstream iss(result);
-        std::string line;
-        while (std::getline(iss, line)) {
-            if (!line.empty()) {
-                differences.push_back(line);
-            }
+        for (const auto& path : diff.modified) {
+            differences.push_back("modified: " + path);
+        }
+        for (const auto& path : diff.removed) {
+            differences.push_back("removed: " + path);
         }
         
         LOG(INFO) << "Calculated " << differences.size() << " file differences";
@@ -239,20 +251,16 @@ bool RollbackUtils::create_differential_backup(const std::string& source_path,
             return false;
         }
         
-        // 创建差异备份目录
-        fs::create_directories(fs::path(backup_path).parent_path());
-        
-        // 使用rsync创建差异备份
-        std::ostringstream cmd;
-        cmd << "rsync -av --delete " << source_path << "/ " << backup_path << "/";
-        
-        int ret = std::system(cmd.str().c_str());
-        if (ret != 0) {
+        // 文件内容进入缓存的内容存储，与其他快照和缓存版本共用 blob；清单所在目录只保存清单和快照状态
+        SnapshotStore store(fs::path(backup_path).parent_path().string());
+        SnapshotCaptureResult snapshot = store.capture(source_path, backup_path);
+        if (!snapshot.success) {
             LOG(ERROR) << "Failed to create differential backup: " << backup_path;
             return false;
         }
         
-        LOG(INFO) << "Created differential backup: " << backup_path;
+        LOG(INFO) << "Created differential backup: " << backup_path << " (" << snapshot.new_objects
+                  << " new files, " << snapshot.bytes_stored << " bytes)";
         return true;
         
     } catch (const std::exception& e) {
@@ -269,15 +277,10 @@ bool RollbackUtils::apply_differential_backup(const std::string& backup_path,
             return false;
         }
         
-        // 创建目标目录
-        fs::create_directories(target_path);
-        
-        // 使用rsync应用差异备份
-        std::ostringstream cmd;
-        cmd << "rsync -av --delete " << backup_path << "/ " << target_path << "/";
-        
-        int ret = std::system(cmd.str().c_str());
-        if (ret != 0) {
+        // 只重写与快照不同的文件，删除快照中没有的文件
+        SnapshotStore store(fs::path(backup_path).parent_path().string());
+        SnapshotRestoreResult restored = store.restore(backup_path, target_path);
+        if (!restored.success) {
             LOG(ERROR) << "Failed to apply differential backup: " << backup_path;
             return false;
         }
@@ -0,0 +1,599 @@
+#include "Paker/core/slab_allocator.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Paker {
+
+namespace {
+
+constexpr uint32_t kSlabMagic = 0x424c5350;  // "PSLB"
+constexpr uint16_t kLargeClass = 0xffff;
+constexpr size_t kMaxBlocksPerSlab = SlabAllocator::kSlabSize / SlabAllocator::kMinBlockSize;
+constexpr size_t kBitmapWords = kMaxBlocksPerSlab / 64;
+// 补充 slab 时最多检查的已有 slab 数；检查过的满 slab 轮转到链表尾部
+constexpr size_t kRefillScanLimit = 8;
+// 全局空闲 slab 缓存上限（4MB）
+constexpr size_t kMaxCachedSlabs = 64;
+// 线程计数累计到该值后汇总到全局
+constexpr uint64_t kStatsFlushInterval = 1024;
+
+static_assert(kBitmapWords <= 64, "summary word must cover the whole bitmap");
+
+struct ThreadCache;
+
+// 远程释放时复用块的前 8 字节作为链表节点
+struct RemoteBlock {
+    RemoteBlock* next;
+};
+
+// 位于每个 slab（以及每个大块）起始处的块头
+struct alignas(64) SlabHeader {
+    uint32_t magic = kSlabMagic;
+    uint16_t size_class = 0;
+    uint16_t block_shift = 0;
+    uint32_t block_count = 0;
+    uint32_t free_count = 0;      // 仅所属线程读写
+    size_t data_offset = 0;
+    size_t large_size = 0;
+    std::atomic<ThreadCache*> owner{nullptr};
+    std::atomic<RemoteBlock*> remote_free{nullptr};
+    SlabHeader* next = nullptr;   // 所属线程的循环双向链表
+    SlabHeader* prev = nullptr;
+    uint64_t summary = 0;         // 第 w 位表示 bitmap[w] 非零
+    uint64_t bitmap[kBitmapWords] = {};  // 1 表示空闲
+
+    char* data() { return reinterpret_cast<char*>(this) + data_offset; }
+};
+
+constexpr size_t kHeaderSize = (sizeof(SlabHeader) + 63) & ~size_t(63);
+static_assert(kHeaderSize < SlabAllocator::kSlabSize / 2, "slab header too large");
+
+inline SlabHeader* slab_of(const void* ptr) {
+    return reinterpret_cast<SlabHeader*>(
+        reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t(SlabAllocator::kSlabSize) - 1));
+}
+
+struct ThreadCache {
+    // 每个尺寸类一条循环链表，表头是当前分配的 slab
+    SlabHeader* slabs[SlabAllocator::kSizeClassCount] = {};
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+
+    ~ThreadCache();
+};
+
+// 进程级共享状态（只在慢路径上访问）
+struct GlobalState {
+    std::mutex cache_mutex;
+    std::vector<void*> cached_slabs;
+
+    std::mutex orphan_mutex;
+    std::vector<SlabHeader*> orphans[SlabAllocator::kSizeClassCount];
+    std::atomic<size_t> orphan_count{0};
+
+    std::atomic<uint64_t> allocation_count{0};
+    std::atomic<uint64_t> free_count{0};
+    std::atomic<uint64_t> remote_free_count{0};
+    std::atomic<uint64_t> large_allocation_count{0};
+    std::atomic<size_t> slabs_in_use{0};
+    std::atomic<size_t> large_bytes_in_use{0};
+};
+
+GlobalState& global_state() {
+    static GlobalState* state = new GlobalState();
+    return *state;
+}
+
+// 按 64KB 区间记录哪些地址由本分配器向系统申请：根表按地址高位索引，
+// 叶子位图按需分配且从不回收，查询无锁。超出 48 位地址空间的区间不登记，视为不属于本分配器。
+class SlabRegistry {
+public:
+    void mark(const void* base, bool owned) {
+        uintptr_t slab = reinterpret_cast<uintptr_t>(base) >> kSlabShift;
+        size_t root = slab >> kLeafShift;
+        if (root >= kRootEntries) {
+            return;
+        }
+        std::atomic<uint64_t>* leaf = root_[root].load(std::memory_order_acquire);
+        if (!leaf) {
+            if (!owned) {
+                return;
+            }
+            auto* fresh = new std::atomic<uint64_t>[kLeafWords]();
+            if (root_[root].compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel)) {
+                leaf = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        size_t bit = slab & ((size_t(1) << kLeafShift) - 1);
+        uint64_t mask = uint64_t(1) << (bit % 64);
+        if (owned) {
+            leaf[bit / 64].fetch_or(mask, std::memory_order_release);
+        } else {
+            leaf[bit / 64].fetch_and(~mask, std::memory_order_release);
+        }
+    }
+
+    bool contains(const void* ptr) const {
+        uintptr_t slab = reinterpret_cast<uintptr_t>(ptr) >> kSlabShift;
+        size_t root = slab >> kLeafShift;
+        if (root >= kRootEntries) {
+            return false;
+        }
+        const std::atomic<uint64_t>* leaf = root_[root].load(std::memory_order_acquire);
+        if (!leaf) {
+            return false;
+        }
+        size_t bit = slab & ((size_t(1) << kLeafShift) - 1);
+        return (leaf[bit / 64].load(std::memory_order_acquire) >> (bit % 64)) & 1;
+    }
+
+private:
+    static constexpr unsigned kSlabShift = 16;
+    static constexpr unsigned kLeafShift = 16;   // 每个叶子覆盖 4GB 地址空间，位图 8KB
+    static constexpr size_t kLeafWords = (size_t(1) << kLeafShift) / 64;
+    static constexpr size_t kRootEntries = size_t(1) << (48 - kSlabShift - kLeafShift);
+    static_assert((size_t(1) << kSlabShift) == SlabAllocator::kSlabSize, "registry granularity must match slab size");
+
+    std::atomic<std::atomic<uint64_t>*> root_[kRootEntries];
+};
+
+// 静态存储期零初始化，无需构造，静态析构期间仍可查询
+SlabRegistry g_slab_registry;
+
+void* system_allocate_slab(size_t size) {
+    void* raw = nullptr;
+    if (posix_memalign(&raw, SlabAllocator::kSlabSize, size) != 0) {
+        return nullptr;
+    }
+    g_slab_registry.mark(raw, true);
+    return raw;
+}
+
+void system_free_slab(void* raw) {
+    g_slab_registry.mark(raw, false);
+    std::free(raw);
+}
+
+thread_local bool tls_cache_destroyed = false;
+
+ThreadCache* local_cache() {
+    if (tls_cache_destroyed) {
+        return nullptr;
+    }
+    static thread_local ThreadCache cache;
+    return &cache;
+}
+
+void flush_counters(ThreadCache* cache) {
+    auto& state = global_state();
+    state.allocation_count.fetch_add(cache->allocations, std::memory_order_relaxed);
+    state.free_count.fetch_add(cache->frees, std::memory_order_relaxed);
+    cache->allocations = 0;
+    cache->frees = 0;
+}
+
+// 循环链表操作
+void link_front(SlabHeader*& head, SlabHeader* slab) {
+    if (!head) {
+        slab->next = slab->prev = slab;
+    } else {
+        slab->next = head;
+        slab->prev = head->prev;
+        head->prev->next = slab;
+        head->prev = slab;
+    }
+    head = slab;
+}
+
+void link_after(SlabHeader* anchor, SlabHeader* slab) {
+    slab->prev = anchor;
+    slab->next = anchor->next;
+    anchor->next->prev = slab;
+    anchor->next = slab;
+}
+
+void unlink(SlabHeader*& head, SlabHeader* slab) {
+    if (slab->next == slab) {
+        head = nullptr;
+    } else {
+        slab->prev->next = slab->next;
+        slab->next->prev = slab->prev;
+        if (head == slab) {
+            head = slab->next;
+        }
+    }
+    slab->next = slab->prev = nullptr;
+}
+
+void* acquire_raw_slab() {
+    auto& state = global_state();
+    {
+        std::lock_guard<std::mutex> lock(state.cache_mutex);
+        if (!state.cached_slabs.empty()) {
+            void* raw = state.cached_slabs.back();
+            state.cached_slabs.pop_back();
+            return raw;
+        }
+    }
+    void* raw = system_allocate_slab(SlabAllocator::kSlabSize);
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    return raw;
+}
+
+void release_slab(SlabHeader* slab) {
+    auto& state = global_state();
+    slab->~SlabHeader();
+    state.slabs_in_use.fetch_sub(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(state.cache_mutex);
+        if (state.cached_slabs.size() < kMaxCachedSlabs) {
+            state.cached_slabs.push_back(slab);
+            return;
+        }
+    }
+    system_free_slab(slab);
+}
+
+SlabHeader* new_slab(size_t size_class, ThreadCache* owner) {
+    void* raw = acquire_raw_slab();
+    auto* slab = new (raw) SlabHeader();
+    size_t block_size = SlabAllocator::class_block_size(size_class);
+    slab->size_class = static_cast<uint16_t>(size_class);
+    slab->block_shift = static_cast<uint16_t>(__builtin_ctzll(block_size));
+    slab->data_offset = kHeaderSize;
+    slab->block_count = static_cast<uint32_t>((SlabAllocator::kSlabSize - kHeaderSize) / block_size);
+    slab->free_count = slab->block_count;
+
+    size_t full_words = slab->block_count / 64;
+    for (size_t w = 0; w < full_words; ++w) {
+        slab->bitmap[w] = ~uint64_t(0);
+    }
+    if (size_t rest = slab->block_count % 64) {
+        slab->bitmap[full_words] = (uint64_t(1) << rest) - 1;
+        ++full_words;
+    }
+    slab->summary = full_words == 64 ? ~uint64_t(0) : (uint64_t(1) << full_words) - 1;
+    slab->owner.store(owner, std::memory_order_release);
+
+    global_state().slabs_in_use.fetch_add(1, std::memory_order_relaxed);
+    return slab;
+}
+
+inline void* take_block(SlabHeader* slab) {
+    size_t word = __builtin_ctzll(slab->summary);
+    uint64_t bits = slab->bitmap[word];
+    size_t bit = __builtin_ctzll(bits);
+    bits &= bits - 1;
+    slab->bitmap[word] = bits;
+    if (!bits) {
+        slab->summary &= ~(uint64_t(1) << word);
+    }
+    --slab->free_count;
+    return slab->data() + ((word * 64 + bit) << slab->block_shift);
+}
+
+// ptr 是否恰好落在 slab 中某个块的起始地址
+inline bool block_index(SlabHeader* slab, const void* ptr, size_t& index) {
+    uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(slab->data());
+    if (reinterpret_cast<uintptr_t>(ptr) < reinterpret_cast<uintptr_t>(slab->data()) ||
+        (offset & ((uintptr_t(1) << slab->block_shift) - 1)) != 0) {
+        return false;
+    }
+    index = static_cast<size_t>(offset >> slab->block_shift);
+    return index < slab->block_count;
+}
+
+inline bool put_block(SlabHeader* slab, void* ptr) {
+    size_t index = 0;
+    if (!block_index(slab, ptr, index)) {
+        LOG(WARNING) << "Attempted to free interior or misaligned slab pointer: " << ptr;
+        return false;
+    }
+    uint64_t mask = uint64_t(1) << (index % 64);
+    if (slab->bitmap[index / 64] & mask) {
+        LOG(WARNING) << "Attempted to free slab block twice: " << ptr;
+        return false;
+    }
+    slab->bitmap[index / 64] |= mask;
+    slab->summary |= uint64_t(1) << (index / 64);
+    ++slab->free_count;
+    return true;
+}
+
+// 收回其他线程释放的块
+void drain_remote(SlabHeader* slab) {
+    if (!slab->remote_free.load(std::memory_order_relaxed)) {
+        return;
+    }
+    RemoteBlock* block = slab->remote_free.exchange(nullptr, std::memory_order_acquire);
+    while (block) {
+        RemoteBlock* next = block->next;
+        put_block(slab, block);
+        block = next;
+    }
+}
+
+SlabHeader* adopt_orphan(size_t size_class, ThreadCache* cache) {
+    auto& state = global_state();
+    if (state.orphan_count.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    SlabHeader* slab = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state.orphan_mutex);
+        auto& orphans = state.orphans[size_class];
+        if (orphans.empty()) {
+            return nullptr;
+        }
+        slab = orphans.back();
+        orphans.pop_back();
+        state.orphan_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    slab->owner.store(cache, std::memory_order_release);
+    drain_remote(slab);
+    return slab;
+}
+
+// 当前 slab 用尽：先收回远程释放，再依次检查链表中的其他 slab，最后接管孤儿或新建
+SlabHeader* refill(ThreadCache* cache, size_t size_class) {
+    SlabHeader*& head = cache->slabs[size_class];
+    if (head) {
+        drain_remote(head);
+        if (head->free_count) {
+            return head;
+        }
+        for (size_t i = 0; i < kRefillScanLimit && head->next != head; ++i) {
+            head = head->next;  // 旧表头随之成为表尾
+            drain_remote(head);
+            if (head->free_count) {
+                return head;
+            }
+        }
+    }
+
+    SlabHeader* slab = adopt_orphan(size_class, cache);
+    if (!slab) {
+        slab = new_slab(size_class, cache);
+    }
+    link_front(head, slab);
+    return slab;
+}
+
+void* allocate_large(size_t size, size_t alignment) {
+    size_t offset = (kHeaderSize + alignment - 1) & ~(alignment - 1);
+    if (offset >= SlabAllocator::kSlabSize || size > SIZE_MAX - offset) {
+        throw std::bad_alloc();
+    }
+    void* raw = system_allocate_slab(offset + size);
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    auto* header = new (raw) SlabHeader();
+    header->size_class = kLargeClass;
+    header->data_offset = offset;
+    header->large_size = size;
+
+    auto& state = global_state();
+    state.large_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    state.large_bytes_in_use.fetch_add(size, std::memory_order_relaxed);
+    return header->data();
+}
+
+ThreadCache::~ThreadCache() {
+    // 空 slab 归还，仍有存活块的 slab 交给孤儿列表
+    auto& state = global_state();
+    for (size_t size_class = 0; size_class < SlabAllocator::kSizeClassCount; ++size_class) {
+        while (SlabHeader* slab = slabs[size_class]) {
+            unlink(slabs[size_class], slab);
+            drain_remote(slab);
+            if (slab->free_count == slab->block_count) {
+                release_slab(slab);
+                continue;
+            }
+            slab->owner.store(nullptr, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(state.orphan_mutex);
+            state.orphans[size_class].push_back(slab);
+            state.orphan_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    flush_counters(this);
+    tls_cache_destroyed = true;
+}
+
+} // namespace
+
+SlabAllocator& SlabAllocator::instance() {
+    static SlabAllocator* allocator = new SlabAllocator();
+    return *allocator;
+}
+
+size_t SlabAllocator::size_class_of(size_t size) {
+    if (size <= kMinBlockSize) {
+        return 0;
+    }
+    // 向上取到 2 的幂
+    return static_cast<size_t>(64 - __builtin_clzll(size - 1)) - 4;
+}
+
+void* SlabAllocator::allocate(size_t size, size_t alignment) {
+    size_t request = std::max(size, alignment);
+    if (request > kMaxBlockSize || alignment > kMaxSmallAlignment) {
+        return allocate_large(size, std::max(alignment, size_t(64)));
+    }
+
+    ThreadCache* cache = local_cache();
+    if (!cache) {
+        // 线程正在退出，线程缓存已析构
+        return allocate_large(size, std::max(alignment, size_t(64)));
+    }
+
+    size_t size_class = size_class_of(request);
+    SlabHeader* slab = cache->slabs[size_class];
+    if (!slab || slab->free_count == 0) {
+        slab = refill(cache, size_class);
+    }
+    if (++cache->allocations >= kStatsFlushInterval) {
+        flush_counters(cache);
+    }
+    return take_block(slab);
+}
+
+bool SlabAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return false;
+    }
+    SlabHeader* slab = slab_of(ptr);
+    auto& state = global_state();
+
+    if (slab->size_class == kLargeClass) {
+        if (ptr != slab->data()) {
+            LOG(WARNING) << "Attempted to free interior pointer of large block: " << ptr;
+            return false;
+        }
+        state.large_bytes_in_use.fetch_sub(slab->large_size, std::memory_order_relaxed);
+        state.free_count.fetch_add(1, std::memory_order_relaxed);
+        slab->~SlabHeader();
+        system_free_slab(slab);
+        return true;
+    }
+
+    ThreadCache* cache = local_cache();
+    if (!cache || slab->owner.load(std::memory_order_acquire) != cache) {
+        // 位图属于所属线程，这里只能检查地址；重复释放由 drain_remote 中的 put_block 发现
+        size_t index = 0;
+        if (!block_index(slab, ptr, index)) {
+            LOG(WARNING) << "Attempted to free interior or misaligned slab pointer: " << ptr;
+            return false;
+        }
+        auto* block = static_cast<RemoteBlock*>(ptr);
+        RemoteBlock* head = slab->remote_free.load(std::memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!slab->remote_free.compare_exchange_weak(head, block, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+        state.remote_free_count.fetch_add(1, std::memory_order_relaxed);
+        state.free_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (!put_block(slab, ptr)) {
+        return false;
+    }
+    if (++cache->frees >= kStatsFlushInterval) {
+        flush_counters(cache);
+    }
+
+    SlabHeader*& head = cache->slabs[slab->size_class];
+    if (slab == head) {
+        return true;
+    }
+    if (slab->free_count == slab->block_count) {
+        unlink(head, slab);
+        release_slab(slab);
+    } else if (slab->free_count == 1) {
+        // 满 slab 刚有空位，移到表头之后，下次补充时优先使用
+        unlink(head, slab);
+        link_after(head, slab);
+    }
+    return true;
+}
+
+bool SlabAllocator::owns(const void* ptr) const {
+    return ptr && g_slab_registry.contains(ptr);
+}
+
+size_t SlabAllocator::usable_size(const void* ptr) const {
+    if (!ptr) {
+        return 0;
+    }
+    const SlabHeader* slab = slab_of(ptr);
+    if (slab->size_class == kLargeClass) {
+        return slab->large_size;
+    }
+    return size_t(1) << slab->block_shift;
+}
+
+void SlabAllocator::reserve(size_t slab_count) {
+    auto& state = global_state();
+    std::vector<void*> reserved;
+    {
+        std::lock_guard<std::mutex> lock(state.cache_mutex);
+        size_t cached = state.cached_slabs.size();
+        if (slab_count <= cached) {
+            return;
+        }
+        slab_count = std::min(slab_count, kMaxCachedSlabs) - std::min(cached, kMaxCachedSlabs);
+    }
+    for (size_t i = 0; i < slab_count; ++i) {
+        void* raw = system_allocate_slab(kSlabSize);
+        if (!raw) {
+            break;
+        }
+        reserved.push_back(raw);
+    }
+    std::lock_guard<std::mutex> lock(state.cache_mutex);
+    state.cached_slabs.insert(state.cached_slabs.end(), reserved.begin(), reserved.end());
+}
+
+size_t SlabAllocator::trim() {
+    auto& state = global_state();
+    std::vector<void*> released;
+    {
+        std::lock_guard<std::mutex> lock(state.cache_mutex);
+        released.swap(state.cached_slabs);
+    }
+    for (void* raw : released) {
+        system_free_slab(raw);
+    }
+    return released.size();
+}
+
+SlabAllocatorStats SlabAllocator::get_statistics() const {
+    if (ThreadCache* cache = local_cache()) {
+        flush_counters(cache);
+    }
+    auto& state = global_state();
+    SlabAllocatorStats stats;
+    stats.allocation_count = state.allocation_count.load(std::memory_order_relaxed) +
+                             state.large_allocation_count.load(std::memory_order_relaxed);
+    stats.free_count = state.free_count.load(std::memory_order_relaxed);
+    stats.remote_free_count = state.remote_free_count.load(std::memory_order_relaxed);
+    stats.large_allocation_count = state.large_allocation_count.load(std::memory_order_relaxed);
+    stats.slabs_in_use = state.slabs_in_use.load(std::memory_order_relaxed);
+    stats.orphan_slabs = state.orphan_count.load(std::memory_order_relaxed);
+    stats.large_bytes_in_use = state.large_bytes_in_use.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(state.cache_mutex);
+        stats.slabs_cached = state.cached_slabs.size();
+    }
+    return stats;
+}
+
+void* SlabMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    return SlabAllocator::instance().allocate(bytes, alignment);
+}
+
+void SlabMemoryResource::do_deallocate(void* ptr, size_t /*bytes*/, size_t /*alignment*/) {
+    SlabAllocator::instance().deallocate(ptr);
+}
+
+bool SlabMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    // 所有实例共享同一个分配器
+    return dynamic_cast<const SlabMemoryResource*>(&other) != nullptr;
+}
+
+std::pmr::memory_resource* get_slab_memory_resource() {
+    static SlabMemoryResource* resource = new SlabMemoryResource();
+    return resource;
+}
+
+} // namespace Paker
@@ -0,0 +1,499 @@
+#include "Paker/core/snapshot_store.h"
+#include "Paker/cache/blob_store.h"
+#include "Paker/cache/cache_manager.h"
+#include "Paker/cache/materializer.h"
+#include <glog/logging.h>
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <omp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+constexpr const char* kSnapshotSuffix = ".snapshot";
+constexpr const char* kHashAlgorithm = "sha256";
+
+int64_t mtime_of(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+bool set_mtime(const std::string& path, int64_t mtime_ns) {
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(mtime_ns / 1000000000LL);
+    times[1].tv_nsec = static_cast<long>(mtime_ns % 1000000000LL);
+    return ::utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+const char* type_name(SnapshotEntry::Type type) {
+    switch (type) {
+        case SnapshotEntry::Type::DIRECTORY: return "dir";
+        case SnapshotEntry::Type::SYMLINK: return "symlink";
+        default: return "file";
+    }
+}
+
+SnapshotEntry::Type parse_type(const std::string& name) {
+    if (name == "dir") {
+        return SnapshotEntry::Type::DIRECTORY;
+    }
+    return name == "symlink" ? SnapshotEntry::Type::SYMLINK : SnapshotEntry::Type::FILE;
+}
+
+bool same_content(const SnapshotEntry& a, const SnapshotEntry& b) {
+    if (a.type != b.type) {
+        return false;
+    }
+    switch (a.type) {
+        case SnapshotEntry::Type::FILE:
+            return a.hash == b.hash && a.mode == b.mode;
+        case SnapshotEntry::Type::SYMLINK:
+            return a.link_target == b.link_target;
+        default:
+            return true;
+    }
+}
+
+// current_format 返回清单的哈希是否为 SHA-256；早期清单的哈希不能作为 blob 名沿用
+bool read_manifest(const std::string& manifest_path, std::vector<SnapshotEntry>& entries, bool* current_format) {
+    entries.clear();
+    try {
+        std::ifstream file(manifest_path);
+        if (!file) {
+            return false;
+        }
+        json j;
+        file >> j;
+        if (current_format) {
+            *current_format = j.value("hash", "") == kHashAlgorithm;
+        }
+        for (const auto& item : j["entries"]) {
+            SnapshotEntry entry;
+            entry.path = item["path"].get<std::string>();
+            entry.type = parse_type(item.value("type", "file"));
+            entry.hash = item.value("hash", "");
+            entry.size = item.value("size", 0ULL);
+            entry.mode = item.value("mode", 0644u);
+            entry.mtime_ns = item.value("mtime", 0LL);
+            entry.link_target = item.value("target", "");
+            entries.push_back(std::move(entry));
+        }
+        return true;
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to read snapshot manifest " << manifest_path << ": " << e.what();
+        entries.clear();
+        return false;
+    }
+}
+
+// 不解析软链接：包目录从软链接换成真实目录后仍是同一个键
+std::string absolute_key(const std::string& dir) {
+    std::error_code ec;
+    return fs::absolute(dir, ec).lexically_normal().string();
+}
+
+} // namespace
+
+SnapshotStore::SnapshotStore(const std::string& root, BlobStore* blobs) : root_(root), blobs_(blobs) {
+    if (!blobs_ && g_cache_manager) {
+        blobs_ = g_cache_manager->get_blob_store();
+    }
+    if (!blobs_) {
+        const char* home = std::getenv("HOME");
+        std::string cache_root = home ? std::string(home) + "/.paker/cache" : ".paker/cache";
+        owned_blobs_ = std::make_unique<BlobStore>(cache_root + "/.store");
+        blobs_ = owned_blobs_.get();
+    }
+}
+
+SnapshotStore::~SnapshotStore() = default;
+
+std::string SnapshotStore::object_path(const std::string& hash) const {
+    return blobs_->blob_path(hash);
+}
+
+bool SnapshotStore::is_snapshot(const std::string& path) {
+    const std::string suffix = kSnapshotSuffix;
+    return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool SnapshotStore::load_manifest(const std::string& manifest_path, std::vector<SnapshotEntry>& entries) {
+    return read_manifest(manifest_path, entries, nullptr);
+}
+
+bool SnapshotStore::scan_tree(const std::string& dir, std::vector<SnapshotEntry>& entries,
+                              const std::map<std::string, SnapshotEntry>* known, size_t* hashed) {
+    entries.clear();
+    std::vector<size_t> to_hash;
+    try {
+        for (auto it = fs::recursive_directory_iterator(dir); it != fs::recursive_directory_iterator(); ++it) {
+            struct stat st {};
+            if (::lstat(it->path().c_str(), &st) != 0) {
+                return false;
+            }
+            SnapshotEntry entry;
+            entry.path = it->path().lexically_relative(dir).generic_string();
+            entry.mode = st.st_mode & 07777;
+            entry.mtime_ns = mtime_of(st);
+            if (S_ISDIR(st.st_mode)) {
+                entry.type = SnapshotEntry::Type::DIRECTORY;
+            } else if (S_ISLNK(st.st_mode)) {
+                entry.type = SnapshotEntry::Type::SYMLINK;
+                entry.link_target = fs::read_symlink(it->path()).string();
+            } else if (S_ISREG(st.st_mode)) {
+                entry.size = static_cast<uint64_t>(st.st_size);
+                const SnapshotEntry* previous = nullptr;
+                if (known) {
+                    auto found = known->find(entry.path);
+                    if (found != known->end()) {
+                        previous = &found->second;
+                    }
+                }
+                if (previous && previous->type == SnapshotEntry::Type::FILE && previous->size == entry.size &&
+                    previous->mtime_ns == entry.mtime_ns && !previous->hash.empty()) {
+                    entry.hash = previous->hash;
+                } else {
+                    to_hash.push_back(entries.size());
+                }
+            } else {
+                continue;   // 设备文件、套接字等不纳入快照
+            }
+            entries.push_back(std::move(entry));
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to scan " << dir << ": " << e.what();
+        return false;
+    }
+
+    // 只有变化的文件需要读取内容
+    std::atomic<bool> ok{true};
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < to_hash.size(); ++i) {
+        SnapshotEntry& entry = entries[to_hash[i]];
+        entry.hash = BlobStore::hash_file((fs::path(dir) / entry.path).string());
+        if (entry.hash.empty()) {
+            ok = false;
+        }
+    }
+    if (hashed) {
+        *hashed = to_hash.size();
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const SnapshotEntry& a, const SnapshotEntry& b) { return a.path < b.path; });
+    return ok;
+}
+
+SnapshotDiff SnapshotStore::diff(const std::vector<SnapshotEntry>& from, const std::vector<SnapshotEntry>& to) {
+    SnapshotDiff result;
+    std::map<std::string, const SnapshotEntry*> before;
+    for (const auto& entry : from) {
+        before[entry.path] = &entry;
+    }
+    for (const auto& entry : to) {
+        auto it = before.find(entry.path);
+        if (it == before.end()) {
+            result.added.push_back(entry.path);
+        } else {
+            if (!same_content(*it->second, entry)) {
+                result.modified.push_back(entry.path);
+            }
+            before.erase(it);
+        }
+    }
+    for (const auto& [path, entry] : before) {
+        result.removed.push_back(path);
+    }
+    return result;
+}
+
+std::map<std::string, SnapshotEntry> SnapshotStore::known_entries(const std::string& dir) const {
+    std::map<std::string, SnapshotEntry> known;
+    try {
+        std::ifstream file(root_ + "/state.json");
+        if (!file) {
+            return known;
+        }
+        json state;
+        file >> state;
+        std::string manifest = state.value(absolute_key(dir), "");
+        std::vector<SnapshotEntry> entries;
+        bool current_format = false;
+        if (!manifest.empty() && read_manifest(manifest, entries, &current_format) && current_format) {
+            for (auto& entry : entries) {
+                std::string path = entry.path;
+                known.emplace(std::move(path), std::move(entry));
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Ignoring unreadable snapshot state in " << root_ << ": " << e.what();
+    }
+    return known;
+}
+
+void SnapshotStore::remember(const std::string& dir, const std::string& manifest_path) const {
+    std::string path = root_ + "/state.json";
+    try {
+        json state = json::object();
+        {
+            std::ifstream file(path);
+            if (file) {
+                file >> state;
+            }
+        }
+        state[absolute_key(dir)] = absolute_key(manifest_path);
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream file(temp);
+            file << state.dump(2);
+        }
+        fs::rename(temp, path);
+    } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to update snapshot state in " << root_ << ": " << e.what();
+    }
+}
+
+SnapshotCaptureResult SnapshotStore::capture(const std::string& source_dir, const std::string& manifest_path) {
+    SnapshotCaptureResult result;
+    std::map<std::string, SnapshotEntry> known = known_entries(source_dir);
+    std::vector<SnapshotEntry> entries;
+    if (!scan_tree(source_dir, entries, &known, &result.hashed)) {
+        LOG(ERROR) << "Failed to scan " << source_dir << " for snapshot";
+        return result;
+    }
+
+    // 先登记引用再复制内容：回收从不删除已登记的 blob，其他进程的回收也不会删掉刚复制、
+    // 尚无引用的对象；登记时 blob 尚不存在也无妨
+    std::vector<BlobManifestEntry> refs;
+    for (const auto& entry : entries) {
+        if (entry.type == SnapshotEntry::Type::FILE) {
+            refs.push_back({entry.path, entry.hash, static_cast<size_t>(entry.size)});
+        }
+    }
+    std::string owner = absolute_key(manifest_path);
+    if (!blobs_->retain(owner, refs)) {
+        LOG(ERROR) << "Failed to register snapshot objects for " << manifest_path;
+        return result;
+    }
+
+    json items = json::array();
+    for (const auto& entry : entries) {
+        if (entry.type == SnapshotEntry::Type::FILE) {
+            result.files++;
+            bool created = false;
+            if (!blobs_->store_copy((fs::path(source_dir) / entry.path).string(), entry.hash, created)) {
+                LOG(ERROR) << "Failed to store snapshot object for " << entry.path;
+                blobs_->release(owner);
+                return result;
+            }
+            if (created) {
+                result.new_objects++;
+                result.bytes_stored += entry.size;
+            }
+        }
+        json item = {{"path", entry.path}, {"type", type_name(entry.type)}, {"mode", entry.mode}};
+        if (entry.type == SnapshotEntry::Type::FILE) {
+            item["hash"] = entry.hash;
+            item["size"] = entry.size;
+            item["mtime"] = entry.mtime_ns;
+        } else if (entry.type == SnapshotEntry::Type::SYMLINK) {
+            item["target"] = entry.link_target;
+        }
+        items.push_back(std::move(item));
+    }
+
+    try {
+        fs::create_directories(fs::path(manifest_path).parent_path());
+        std::string temp = manifest_path + ".tmp";
+        {
+            std::ofstream file(temp);
+            file << json({{"source", absolute_key(source_dir)}, {"hash", kHashAlgorithm},
+                          {"entries", std::move(items)}}).dump();
+            if (!file) {
+                blobs_->release(owner);
+                return result;
+            }
+        }
+        fs::rename(temp, manifest_path);
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to write snapshot manifest " << manifest_path << ": " << e.what();
+        blobs_->release(owner);
+        return result;
+    }
+
+    remember(source_dir, manifest_path);
+    result.success = true;
+    LOG(INFO) << "Snapshot " << manifest_path << ": " << result.files << " files, " << result.hashed
+              << " rehashed, " << result.new_objects << " new objects (" << result.bytes_stored << " bytes)";
+    return result;
+}
+
+SnapshotRestoreResult SnapshotStore::restore(const std::string& manifest_path, const std::string& target_dir,
+                                             int threads) {
+    SnapshotRestoreResult result;
+    std::vector<SnapshotEntry> wanted;
+    if (!load_manifest(manifest_path, wanted)) {
+        LOG(ERROR) << "Cannot load snapshot manifest " << manifest_path;
+        return result;
+    }
+
+    // 目录现状：与目标清单或最近记录的清单大小、修改时间一致的文件不再读取
+    std::map<std::string, SnapshotEntry> known = known_entries(target_dir);
+    for (const auto& entry : wanted) {
+        known[entry.path] = entry;
+    }
+    std::vector<SnapshotEntry> current;
+    std::error_code ec;
+    if (fs::is_symlink(target_dir, ec)) {
+        // 软链接到全局缓存的包目录不能原地改写，换成真实目录后整体恢复
+        fs::remove(target_dir, ec);
+    }
+    if (fs::exists(target_dir, ec) && !scan_tree(target_dir, current, &known)) {
+        LOG(ERROR) << "Failed to scan " << target_dir << " before restore";
+        return result;
+    }
+
+    SnapshotDiff changes = diff(current, wanted);
+    std::map<std::string, const SnapshotEntry*> current_by_path;
+    for (const auto& entry : current) {
+        current_by_path[entry.path] = &entry;
+    }
+    std::map<std::string, const SnapshotEntry*> wanted_by_path;
+    for (const auto& entry : wanted) {
+        wanted_by_path[entry.path] = &entry;
+    }
+
+    try {
+        // 先删除多余条目和类型改变的条目，深层路径在前
+        std::vector<std::string> doomed = changes.removed;
+        for (const auto& path : changes.modified) {
+            if (current_by_path[path]->type != wanted_by_path[path]->type) {
+                doomed.push_back(path);
+            }
+        }
+        std::sort(doomed.rbegin(), doomed.rend());
+        for (const auto& path : doomed) {
+            result.removed += fs::remove_all(fs::path(target_dir) / path) > 0 ? 1 : 0;
+        }
+
+        fs::create_directories(target_dir);
+        for (const auto& entry : wanted) {
+            if (entry.type == SnapshotEntry::Type::DIRECTORY) {
+                fs::create_directories(fs::path(target_dir) / entry.path);
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to prepare " << target_dir << " for restore: " << e.what();
+        return result;
+    }
+
+    std::vector<const SnapshotEntry*> work;
+    for (const auto* list : {&changes.added, &changes.modified}) {
+        for (const auto& path : *list) {
+            const SnapshotEntry* entry = wanted_by_path[path];
+            if (entry->type != SnapshotEntry::Type::DIRECTORY) {
+                work.push_back(entry);
+            }
+        }
+    }
+
+    std::atomic<bool> ok{true};
+    std::atomic<size_t> bytes_written{0};
+    if (threads <= 0) {
+        threads = omp_get_max_threads();
+    }
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (size_t i = 0; i < work.size(); ++i) {
+        const SnapshotEntry& entry = *work[i];
+        std::string path = (fs::path(target_dir) / entry.path).string();
+        std::string temp = path + ".paker-restore";
+        ::unlink(temp.c_str());
+        if (entry.type == SnapshotEntry::Type::SYMLINK) {
+            if (::symlink(entry.link_target.c_str(), temp.c_str()) != 0 ||
+                ::rename(temp.c_str(), path.c_str()) != 0) {
+                ok = false;
+            }
+            continue;
+        }
+        // 对象只读，恢复出的文件按清单权限重设并写回原修改时间，下次比较可直接命中
+        if (!FileMaterializer::copy_file(object_path(entry.hash), temp) ||
+            ::chmod(temp.c_str(), entry.mode) != 0 || !set_mtime(temp, entry.mtime_ns) ||
+            ::rename(temp.c_str(), path.c_str()) != 0) {
+            LOG(ERROR) << "Failed to restore " << path << " from snapshot";
+            ::unlink(temp.c_str());
+            ok = false;
+            continue;
+        }
+        bytes_written += entry.size;
+    }
+
+    // 目录权限最后设置，避免只读目录挡住其中文件的写入
+    for (const auto& entry : wanted) {
+        if (entry.type == SnapshotEntry::Type::DIRECTORY) {
+            ::chmod((fs::path(target_dir) / entry.path).c_str(), entry.mode);
+        }
+    }
+
+    result.success = ok;
+    result.written = work.size();
+    result.unchanged = wanted.size() - changes.added.size() - changes.modified.size();
+    result.bytes_written = bytes_written;
+    if (result.success) {
+        remember(target_dir, manifest_path);
+    }
+    LOG(INFO) << "Restored " << target_dir << " from " << manifest_path << ": " << result.written << " written, "
+              << result.removed << " removed, " << result.unchanged << " unchanged";
+    return result;
+}
+
+bool SnapshotStore::verify(const std::string& manifest_path) const {
+    std::vector<SnapshotEntry> entries;
+    if (!load_manifest(manifest_path, entries)) {
+        return false;
+    }
+    for (const auto& entry : entries) {
+        if (entry.type != SnapshotEntry::Type::FILE) {
+            continue;
+        }
+        struct stat st {};
+        if (entry.hash.size() < 3 || ::stat(object_path(entry.hash).c_str(), &st) != 0 ||
+            static_cast<uint64_t>(st.st_size) != entry.size) {
+            LOG(ERROR) << "Snapshot " << manifest_path << " is missing object for " << entry.path;
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t SnapshotStore::collect_garbage() {
+    // 只处理本目录下的快照：清单已删除的撤销引用，blob 是否删除由内容存储按引用计数决定
+    std::string prefix = absolute_key(root_) + "/";
+    size_t released = 0;
+    for (const auto& owner : blobs_->list_owners()) {
+        std::error_code ec;
+        if (owner.compare(0, prefix.size(), prefix) == 0 && !fs::exists(owner, ec) && !ec &&
+            blobs_->release(owner)) {
+            released++;
+        }
+    }
+    size_t freed = blobs_->collect_garbage();
+    if (released > 0) {
+        LOG(INFO) << "Released " << released << " deleted snapshots under " << root_ << ", freed " << freed
+                  << " bytes";
+    }
+    return freed;
+}
+
+} // namespace Paker
@@ -0,0 +1,176 @@
+#include "Paker/core/string_interner.h"
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace Paker {
+
+namespace {
+
+// 空字符串（ID 0）的存储
+const char kEmpty[] = "";
+
+} // namespace
+
+StringInterner& StringInterner::instance() {
+    // 有意泄漏：静态析构期间仍可能有对象持有 Symbol
+    static StringInterner* interner = new StringInterner();
+    return *interner;
+}
+
+StringInterner::StringInterner() : next_id_(1), bytes_stored_(1), arena_bytes_(0) {
+    for (auto& segment : segments_) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+    Entry* first = ensure_segment(0);
+    first[0] = Entry{kEmpty, 0};
+}
+
+StringInterner::Entry* StringInterner::ensure_segment(size_t segment) {
+    Entry* entries = segments_[segment].load(std::memory_order_acquire);
+    if (entries) {
+        return entries;
+    }
+    Entry* fresh = new Entry[kFirstSegmentSize << segment];
+    if (segments_[segment].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete[] fresh;
+    return entries;
+}
+
+Symbol::Id StringInterner::probe(const Shard& shard, std::string_view text, size_t hash) const {
+    if (shard.slots.empty()) {
+        return 0;
+    }
+    size_t mask = shard.slots.size() - 1;
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = shard.slots[i];
+        if (slot.id == 0) {
+            return 0;
+        }
+        if (slot.tag == tag && view(slot.id) == text) {
+            return slot.id;
+        }
+    }
+}
+
+void StringInterner::insert_slot(Shard& shard, Symbol::Id id, size_t hash) {
+    size_t mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    while (shard.slots[i].id != 0) {
+        i = (i + 1) & mask;
+    }
+    shard.slots[i] = Slot{id, static_cast<uint32_t>(hash >> 32)};
+}
+
+void StringInterner::grow(Shard& shard) {
+    std::vector<Slot> old;
+    old.swap(shard.slots);
+    shard.slots.assign(old.empty() ? 256 : old.size() * 2, Slot{0, 0});
+    for (const Slot& slot : old) {
+        if (slot.id != 0) {
+            insert_slot(shard, slot.id, std::hash<std::string_view>{}(view(slot.id)));
+        }
+    }
+}
+
+const char* StringInterner::store(Shard& shard, std::string_view text) {
+    size_t needed = text.size() + 1;
+    char* dest;
+    if (needed > kArenaBlockSize / 4) {
+        // 长字符串单独分配，避免浪费当前块的剩余空间
+        shard.blocks.emplace_back(new char[needed]);
+        dest = shard.blocks.back().get();
+        arena_bytes_.fetch_add(needed, std::memory_order_relaxed);
+    } else {
+        if (shard.remaining < needed) {
+            shard.blocks.emplace_back(new char[kArenaBlockSize]);
+            shard.cursor = shard.blocks.back().get();
+            shard.remaining = kArenaBlockSize;
+            arena_bytes_.fetch_add(kArenaBlockSize, std::memory_order_relaxed);
+        }
+        dest = shard.cursor;
+        shard.cursor += needed;
+        shard.remaining -= needed;
+    }
+    std::memcpy(dest, text.data(), text.size());
+    dest[text.size()] = '\0';
+    bytes_stored_.fetch_add(needed, std::memory_order_relaxed);
+    return dest;
+}
+
+Symbol StringInterner::intern(std::string_view text) {
+    if (text.empty()) {
+        return Symbol();
+    }
+    size_t hash = std::hash<std::string_view>{}(text);
+    Shard& shard = shard_for(hash);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (Symbol::Id id = probe(shard, text, hash)) {
+            return Symbol(id, true);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (Symbol::Id id = probe(shard, text, hash)) {
+        return Symbol(id, true);
+    }
+    if (text.size() > UINT32_MAX) {
+        throw std::length_error("String too long to intern");
+    }
+
+    Symbol::Id id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0) {
+        throw std::overflow_error("String interner exhausted 32-bit symbol space");
+    }
+    const char* data = store(shard, text);
+
+    size_t offset;
+    size_t segment = segment_of(id, offset);
+    ensure_segment(segment)[offset] = Entry{data, static_cast<uint32_t>(text.size())};
+
+    // 负载因子保持在 3/4 以下
+    if ((shard.used + 1) * 4 > shard.slots.size() * 3) {
+        grow(shard);
+    }
+    insert_slot(shard, id, hash);
+    shard.used++;
+    return Symbol(id, true);
+}
+
+std::optional<Symbol> StringInterner::find(std::string_view text) const {
+    if (text.empty()) {
+        return Symbol();
+    }
+    size_t hash = std::hash<std::string_view>{}(text);
+    Shard& shard = shard_for(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    Symbol::Id id = probe(shard, text, hash);
+    if (id == 0) {
+        return std::nullopt;
+    }
+    return Symbol(id, true);
+}
+
+StringInternerStats StringInterner::get_statistics() const {
+    StringInternerStats stats;
+    stats.symbol_count = next_id_.load(std::memory_order_relaxed);
+    stats.bytes_stored = bytes_stored_.load(std::memory_order_relaxed);
+    stats.arena_bytes = arena_bytes_.load(std::memory_order_relaxed);
+
+    for (size_t segment = 0; segment < kSegmentCount; ++segment) {
+        if (segments_[segment].load(std::memory_order_acquire)) {
+            stats.table_bytes += (kFirstSegmentSize << segment) * sizeof(Entry);
+        }
+    }
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.table_bytes += shard.slots.capacity() * sizeof(Slot);
+    }
+    return stats;
+}
+
+} // namespace Paker
@@ -2,8 +2,12 @@
 #include "Paker/core/output.h"
 #include "Paker/dependency/version_manager.h"
 #include "Paker/dependency/dependency_resolver.h"
+#include "Paker/dependency/csr_dependency_graph.h"
 #include "Paker/cache/cache_manager.h"
+#include "Paker/cache/generation_manager.h"
 #include "Paker/core/core_services.h"
+#include "Paker/core/snapshot_store.h"
+#include "Paker/core/history_log.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -28,6 +32,8 @@ VersionHistoryManager::VersionHistoryManager(const std::string& project_path) {
         backup_dir_ = (fs::path(project_path) / ".paker" / "backups").string();
     }
     
+    history_log_ = std::make_unique<HistoryLog>((fs::path(history_file_path_).parent_path() / "history").string());
+    
     // 创建必要的目录
     fs::create_directories(fs::path(history_file_path_).parent_path());
     fs::create_directories(backup_dir_);
@@ -36,30 +42,45 @@ VersionHistoryManager::VersionHistoryManager(const std::string& project_path) {
     load_history();
 }
 
+VersionHistoryManager::~VersionHistoryManager() = default;
+
 bool VersionHistoryManager::load_history() {
-    try {
-        if (!fs::exists(history_file_path_)) {
-            return true; // 文件不存在是正常的
+    if (!history_log_->open()) {
+        LOG(ERROR) << "Failed to open history log: " << history_log_->get_dir();
+        return false;
+    }
+    
+    // 旧版整体 JSON 历史只迁移一次，迁移后改名保留
+    if (history_log_->empty() && fs::exists(history_file_path_)) {
+        size_t migrated = 0;
+        if (!append_json_history(history_file_path_, migrated)) {
+            return false;
         }
-        
-        std::ifstream file(history_file_path_);
+        std::error_code ec;
+        fs::rename(history_file_path_, history_file_path_ + ".migrated", ec);
+        LOG(INFO) << "Migrated " << migrated << " history entries from " << history_file_path_;
+    }
+    return true;
+}
+
+bool VersionHistoryManager::append_json_history(const std::string& path, size_t& appended) {
+    appended = 0;
+    try {
+        std::ifstream file(path);
         if (!file.is_open()) {
-            LOG(ERROR) << "Failed to open history file: " << history_file_path_;
+            LOG(ERROR) << "Failed to open history file: " << path;
             return false;
         }
         
         nlohmann::json j;
         file >> j;
         
-        history_.clear();
-        package_history_.clear();
-        
         for (const auto& entry_json : j["history"]) {
             VersionHistoryEntry entry;
             entry.package_name = entry_json["package_name"];
             entry.old_version = entry_json["old_version"];
             entry.new_version = entry_json["new_version"];
-            entry.repository_url = entry_json["repository_url"];
+            entry.repository_url = entry_json.value("repository_url", "");
             entry.reason = entry_json.value("reason", "");
             entry.user = entry_json.value("user", "");
             entry.commit_hash = entry_json.value("commit_hash", "");
@@ -67,13 +88,20 @@ bool VersionHistoryManager::load_history() {
             entry.backup_path = entry_json.value("backup_path", "");
             entry.backup_size_bytes = entry_json.value("backup_size_bytes", 0);
             
-            // 解析时间戳
+            // 解析时间戳：本地时间字符串，或旧版导出文件中的秒数
             if (entry_json.contains("timestamp")) {
-                auto timestamp_str = entry_json["timestamp"].get<std::string>();
-                std::tm tm = {};
-                std::istringstream ss(timestamp_str);
-                ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-                entry.timestamp = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+                auto timestamp_str = entry_json["timestamp"].is_number()
+                    ? std::to_string(entry_json["timestamp"].get<int64_t>())
+                    : entry_json["timestamp"].get<std::string>();
+                if (!timestamp_str.empty() && std::all_of(timestamp_str.begin(), timestamp_str.end(), ::isdigit)) {
+                    entry.timestamp = std::chrono::system_clock::from_time_t(std::stoll(timestamp_str));
+                } else {
+                    std::tm tm = {};
+                    tm.tm_isdst = -1;
+                    std::istringstream ss(timestamp_str);
+                    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+                    entry.timestamp = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+                }
             }
             
             // 解析受影响文件
@@ -81,61 +109,16 @@ bool VersionHistoryManager::load_history() {
                 entry.affected_files = entry_json["affected_files"].get<std::vector<std::string>>();
             }
             
-            history_.push_back(entry);
-            package_history_[entry.package_name].push_back(entry);
-        }
-        
-        LOG(INFO) << "Loaded " << history_.size() << " history entries";
-        return true;
-        
-    } catch (const std::exception& e) {
-        LOG(ERROR) << "Error loading history: " << e.what();
-        return false;
-    }
-}
-
-bool VersionHistoryManager::save_history() {
-    try {
-        nlohmann::json j;
-        j["version"] = "1.0";
-        j["last_updated"] = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        
-        nlohmann::json history_array = nlohmann::json::array();
-        for (const auto& entry : history_) {
-            nlohmann::json entry_json;
-            entry_json["package_name"] = entry.package_name;
-            entry_json["old_version"] = entry.old_version;
-            entry_json["new_version"] = entry.new_version;
-            entry_json["repository_url"] = entry.repository_url;
-            entry_json["reason"] = entry.reason;
-            entry_json["user"] = entry.user;
-            entry_json["commit_hash"] = entry.commit_hash;
-            entry_json["is_rollback"] = entry.is_rollback;
-            entry_json["backup_path"] = entry.backup_path;
-            entry_json["backup_size_bytes"] = entry.backup_size_bytes;
-            entry_json["affected_files"] = entry.affected_files;
-            
-            // 格式化时间戳
-            auto time_t = std::chrono::system_clock::to_time_t(entry.timestamp);
-            std::stringstream ss;
-            ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-            entry_json["timestamp"] = ss.str();
-            
-            history_array.push_back(entry_json);
-        }
-        j["history"] = history_array;
-        
-        std::ofstream file(history_file_path_);
-        if (!file.is_open()) {
-            LOG(ERROR) << "Failed to open history file for writing: " << history_file_path_;
-            return false;
+            if (history_log_->append(entry)) {
+                appended++;
+            }
         }
         
-        file << j.dump(2);
+        LOG(INFO) << "Loaded " << appended << " history entries from " << path;
         return true;
         
     } catch (const std::exception& e) {
-        LOG(ERROR) << "Error saving history: " << e.what();
+        LOG(ERROR) << "Error loading history from " << path << ": " << e.what();
         return false;
     }
 }
@@ -181,14 +164,10 @@ bool VersionHistoryManager::record_version_change(const std::string& package_nam
         
         // 创建备份（如果需要）
         if (!old_version.empty() && old_version != new_version) {
-            if (create_backup(package_name, old_version)) {
-                entry.backup_path = generate_backup_path(package_name, old_version);
-                // 计算备份大小
-                fs::path backup_path(entry.backup_path);
-                if (fs::exists(backup_path)) {
-                    entry.backup_size_bytes = fs::file_size(backup_path);
-                }
-            }
+            // 备份大小只计本次快照新增的对象，未变化的文件与之前的快照共用
+            size_t stored_bytes = 0;
+            entry.backup_path = create_backup(package_name, old_version, &stored_bytes);
+            entry.backup_size_bytes = stored_bytes;
         }
         
         // 记录受影响文件
@@ -204,11 +183,11 @@ bool VersionHistoryManager::record_version_change(const std::string& package_nam
             }
         }
         
-        history_.push_back(entry);
-        package_history_[package_name].push_back(entry);
-        
-        // 保存历史记录
-        save_history();
+        // 只追加一条记录，不重写已有历史
+        if (!history_log_->append(entry)) {
+            LOG(ERROR) << "Failed to append version change for " << package_name;
+            return false;
+        }
         
         LOG(INFO) << "Recorded version change: " << package_name << " " 
                  << old_version << " -> " << new_version;
@@ -266,8 +245,8 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
         }
         
         // 查找目标版本的历史记录
-        auto it = package_history_.find(package_name);
-        if (it == package_history_.end()) {
+        std::vector<VersionHistoryEntry> package_history = history_log_->package_history(package_name);
+        if (package_history.empty()) {
             result.success = false;
             result.message = "No history found for package: " + package_name;
             return result;
@@ -275,7 +254,7 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
         
         // 查找目标版本
         const VersionHistoryEntry* target_entry = nullptr;
-        for (const auto& entry : it->second) {
+        for (const auto& entry : package_history) {
             if (entry.new_version == target_version) {
                 target_entry = &entry;
                 break;
@@ -288,16 +267,22 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
             return result;
         }
         
+        // 包含目标版本的链接代仍在时，回滚只是一次原子切换，当前代本身就是备份
+        std::string project_path = fs::current_path().string();
+        GenerationManager generations(project_path);
+        // 链接代由工程目录决定，与是否初始化了全局缓存管理器无关
+        uint64_t source_generation =
+            generations.current() != 0 ? generations.find_generation_with(package_name, target_version) : 0;
+        
         // 创建当前版本备份
         std::string current_backup_path;
-        if (options.create_backup) {
+        if (options.create_backup && source_generation == 0) {
             std::string current_version = "current";
             if (g_cache_manager) {
-                std::string project_path = fs::current_path().string();
                 std::string package_path = g_cache_manager->get_project_package_path(package_name, project_path);
                 if (!package_path.empty()) {
-                    current_backup_path = generate_backup_path(package_name, current_version);
-                    if (create_backup(package_name, current_version)) {
+                    current_backup_path = create_backup(package_name, current_version);
+                    if (!current_backup_path.empty()) {
                         Output::info("Created backup of current version");
                     }
                 }
@@ -306,11 +291,31 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
         
         // 执行回滚
         bool rollback_success = false;
-        if (!target_entry->backup_path.empty() && fs::exists(target_entry->backup_path)) {
+        Generation source;
+        if (source_generation != 0 && generations.load(source_generation, source)) {
+            // 全部回滚直接切回那一代；单包回滚在当前代基础上只替换该包
+            uint64_t id = source_generation;
+            if (options.strategy != RollbackStrategy::ALL_PACKAGES) {
+                id = generations.create_generation({{package_name, source.packages[package_name]}}, {},
+                                                   "rollback " + package_name + "@" + target_version);
+            }
+            GenerationSwitchResult switched = id != 0 ? generations.switch_to(id) : GenerationSwitchResult();
+            if (switched.success) {
+                rollback_success = true;
+                result.generation = id;
+                result.switch_latency = switched.switch_latency;
+                generations.collect_garbage(load_project_generation_retention(project_path));
+                Output::success("Switched to package generation " + std::to_string(id) + " in " +
+                                std::to_string(switched.switch_latency.count()) + "us");
+            }
+        }
+        
+        if (rollback_success) {
+            // 链接代切换已完成
+        } else if (!target_entry->backup_path.empty() && fs::exists(target_entry->backup_path)) {
             // 从备份恢复
             std::string target_path;
             if (g_cache_manager) {
-                std::string project_path = fs::current_path().string();
                 target_path = g_cache_manager->get_project_package_path(package_name, project_path);
             } else {
                 target_path = "packages/" + package_name;
@@ -324,7 +329,8 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
             // 重新安装目标版本
             if (g_cache_manager) {
                 std::string repo_url = target_entry->repository_url;
-                if (g_cache_manager->install_package_to_cache(package_name, target_version, repo_url)) {
+                if (g_cache_manager->install_package_to_cache(package_name, target_version, repo_url) &&
+                    g_cache_manager->create_project_link(package_name, target_version, project_path)) {
                     rollback_success = true;
                     Output::success("Successfully reinstalled target version");
                 }
@@ -343,7 +349,7 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
             rollback_entry.is_rollback = true;
             rollback_entry.backup_path = current_backup_path;
             
-            history_.push_back(rollback_entry);
+            history_log_->append(rollback_entry);
             
             // 依赖感知回滚：处理依赖包
             if (options.strategy == RollbackStrategy::DEPENDENCY_AWARE) {
@@ -352,10 +358,10 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
                     LOG(INFO) << "Checking if dependent package " << dep_pkg << " needs rollback";
                     
                     // 检查依赖包是否需要相应的回滚
-                    auto dep_it = package_history_.find(dep_pkg);
-                    if (dep_it != package_history_.end() && !dep_it->second.empty()) {
+                    auto dep_history = history_log_->package_history(dep_pkg, 1);
+                    if (!dep_history.empty()) {
                         // 获取依赖包的最新版本
-                        const auto& latest_entry = dep_it->second.back();
+                        const auto& latest_entry = dep_history.back();
                         Output::info("Dependent package " + dep_pkg + " is at version " + latest_entry.new_version);
                         
                         // 这里可以添加更复杂的逻辑来决定是否需要回滚依赖包
@@ -363,9 +369,6 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
                     }
                 }
             }
-            package_history_[package_name].push_back(rollback_entry);
-            save_history();
-            
             result.success = true;
             result.rolled_back_packages.push_back(package_name);
             result.message = "Successfully rolled back " + package_name + " to version " + target_version;
@@ -391,8 +394,8 @@ RollbackResult VersionHistoryManager::rollback_to_version(const std::string& pac
 
 RollbackResult VersionHistoryManager::rollback_to_previous(const std::string& package_name,
                                                          const RollbackOptions& options) {
-    auto it = package_history_.find(package_name);
-    if (it == package_history_.end() || it->second.empty()) {
+    auto history = history_log_->package_history(package_name, 1);
+    if (history.empty()) {
         RollbackResult result;
         result.success = false;
         result.message = "No previous version found for package: " + package_name;
@@ -400,37 +403,33 @@ RollbackResult VersionHistoryManager::rollback_to_previous(const std::string& pa
     }
     
     // 获取上一个版本
-    const auto& history = it->second;
     std::string previous_version = history.back().old_version;
     
     return rollback_to_version(package_name, previous_version, options);
 }
 
 std::vector<VersionHistoryEntry> VersionHistoryManager::get_package_history(const std::string& package_name) const {
-    auto it = package_history_.find(package_name);
-    if (it != package_history_.end()) {
-        return it->second;
-    }
-    return {};
+    return history_log_->package_history(package_name);
 }
 
 std::vector<VersionHistoryEntry> VersionHistoryManager::get_recent_history(size_t count) const {
-    std::vector<VersionHistoryEntry> recent;
-    size_t start = history_.size() > count ? history_.size() - count : 0;
-    for (size_t i = start; i < history_.size(); ++i) {
-        recent.push_back(history_[i]);
-    }
-    return recent;
+    return history_log_->recent(count);
+}
+
+std::vector<VersionHistoryEntry> VersionHistoryManager::get_history_between(
+    const std::chrono::system_clock::time_point& from, const std::chrono::system_clock::time_point& to) const {
+    return history_log_->range(from, to);
+}
+
+std::vector<std::string> VersionHistoryManager::get_affected_files(const VersionHistoryEntry& entry) const {
+    return history_log_->load_affected_files(entry);
 }
 
 std::vector<std::string> VersionHistoryManager::get_rollbackable_versions(const std::string& package_name) const {
     std::vector<std::string> versions;
-    auto it = package_history_.find(package_name);
-    if (it != package_history_.end()) {
-        for (const auto& entry : it->second) {
-            if (!entry.new_version.empty()) {
-                versions.push_back(entry.new_version);
-            }
+    for (const auto& entry : history_log_->package_history(package_name)) {
+        if (!entry.new_version.empty()) {
+            versions.push_back(entry.new_version);
         }
     }
     return versions;
@@ -452,7 +451,8 @@ bool VersionHistoryManager::can_safely_rollback(const std::string& package_name,
     return true;
 }
 
-bool VersionHistoryManager::create_backup(const std::string& package_name, const std::string& version) {
+std::string VersionHistoryManager::create_backup(const std::string& package_name, const std::string& version,
+                                                size_t* stored_bytes) {
     try {
         std::string source_path;
         if (g_cache_manager) {
@@ -464,29 +464,28 @@ bool VersionHistoryManager::create_backup(const std::string& package_name, const
         
         if (!fs::exists(source_path)) {
             LOG(WARNING) << "Source path does not exist: " << source_path;
-            return false;
+            return "";
         }
         
+        // 增量快照：只有大小或修改时间变化的文件会被读取并存入内容存储
         std::string backup_path = generate_backup_path(package_name, version);
-        fs::create_directories(fs::path(backup_path).parent_path());
-        
-        // 使用tar创建备份
-        std::ostringstream cmd;
-        cmd << "tar -czf " << backup_path << " -C " << fs::path(source_path).parent_path().string() 
-            << " " << fs::path(source_path).filename().string();
-        
-        int ret = std::system(cmd.str().c_str());
-        if (ret != 0) {
+        SnapshotStore store(backup_dir_);
+        SnapshotCaptureResult snapshot = store.capture(source_path, backup_path);
+        if (!snapshot.success) {
             LOG(ERROR) << "Failed to create backup: " << backup_path;
-            return false;
+            return "";
+        }
+        if (stored_bytes) {
+            *stored_bytes = snapshot.bytes_stored;
         }
         
-        LOG(INFO) << "Created backup: " << backup_path;
-        return true;
+        LOG(INFO) << "Created backup: " << backup_path << " (" << snapshot.new_objects << " of "
+                  << snapshot.files << " files stored)";
+        return backup_path;
         
     } catch (const std::exception& e) {
         LOG(ERROR) << "Error creating backup: " << e.what();
-        return false;
+        return "";
     }
 }
 
@@ -500,12 +499,23 @@ bool VersionHistoryManager::restore_backup(const std::string& backup_path, const
         // 创建目标目录
         fs::create_directories(fs::path(target_path).parent_path());
         
-        // 如果目标路径存在，先删除
+        if (SnapshotStore::is_snapshot(backup_path)) {
+            SnapshotStore store(fs::path(backup_path).parent_path().string());
+            SnapshotRestoreResult restored = store.restore(backup_path, target_path);
+            if (!restored.success) {
+                LOG(ERROR) << "Failed to restore backup: " << backup_path;
+                return false;
+            }
+            LOG(INFO) << "Restored backup: " << backup_path << " to " << target_path << " ("
+                      << restored.written << " written, " << restored.removed << " removed)";
+            return true;
+        }
+        
+        // 旧版本留下的 tar.gz 备份
         if (fs::exists(target_path)) {
             fs::remove_all(target_path);
         }
         
-        // 使用tar恢复备份
         std::ostringstream cmd;
         cmd << "tar -xzf " << backup_path << " -C " << fs::path(target_path).parent_path().string();
         
@@ -529,7 +539,7 @@ std::string VersionHistoryManager::generate_backup_path(const std::string& packa
     auto time_t = std::chrono::system_clock::to_time_t(now);
     std::stringstream ss;
     ss << backup_dir_ << "/" << package_name << "_" << version << "_" 
-       << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S") << ".tar.gz";
+       << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S") << ".snapshot";
     return ss.str();
 }
 
@@ -557,16 +567,13 @@ std::vector<std::string> VersionHistoryManager::get_dependent_packages(const std
             return dependents;
         }
         
-        // 从依赖图中查找所有依赖该包的包
-        const auto& nodes = dependency_graph->get_nodes();
-        for (const auto& [pkg_name, node] : nodes) {
-            // 检查该包的依赖列表中是否包含目标包
-            for (const auto& dep : node.dependencies) {
-                if (dep == package_name) {
-                    dependents.push_back(pkg_name);
-                    VLOG(1) << "Found dependent package: " << pkg_name << " depends on " << package_name;
-                    break;
-                }
+        // 只返回直接依赖该包的包：沿CSR快照的反向边读取，无需扫描全图
+        auto csr = dependency_graph->freeze();
+        auto package_id = csr->find(package_name);
+        if (package_id != CSRDependencyGraph::INVALID_NODE) {
+            for (auto dependent_id : csr->dependents(package_id)) {
+                dependents.emplace_back(csr->name(dependent_id));
+                VLOG(1) << "Found dependent package: " << dependents.back() << " depends on " << package_name;
             }
         }
         
@@ -577,16 +584,12 @@ std::vector<std::string> VersionHistoryManager::get_dependent_packages(const std
             LOG(INFO) << "No dependents found in dependency graph, checking history records";
             
             // 从历史记录中查找可能受影响的包
-            for (const auto& entry : history_) {
-                if (entry.package_name != package_name) {
-                    // 检查该包是否在目标包变更时被记录
-                    // 这可以作为依赖关系的间接证据
-                    auto it = std::find(dependents.begin(), dependents.end(), entry.package_name);
-                    if (it == dependents.end()) {
-                        // 简单启发式：如果包在同一时间被修改，可能有关联
-                        dependents.push_back(entry.package_name);
-                        VLOG(1) << "Inferred potential dependent from history: " << entry.package_name;
-                    }
+            // 包名直接取自历史日志的包索引，不读取记录
+            for (const auto& name : history_log_->packages()) {
+                if (name != package_name) {
+                    // 简单启发式：同一工程中有变更记录的包可能有关联
+                    dependents.push_back(name);
+                    VLOG(1) << "Inferred potential dependent from history: " << name;
                 }
             }
         }
@@ -612,14 +615,13 @@ std::vector<std::string> VersionHistoryManager::get_rollback_suggestions(const s
         LOG(INFO) << "Generating rollback suggestions for: " << package_name;
         
         // 获取包的历史记录
-        auto it = package_history_.find(package_name);
-        if (it == package_history_.end() || it->second.empty()) {
+        auto history = history_log_->package_history(package_name);
+        if (history.empty()) {
             LOG(WARNING) << "No history found for package: " << package_name;
             return suggestions;
         }
         
         // 分析历史记录，生成智能建议
-        const auto& history = it->second;
         
         // 1. 最近稳定版本建议
         for (auto rit = history.rbegin(); rit != history.rend() && suggestions.size() < 3; ++rit) {
@@ -682,14 +684,10 @@ RollbackResult VersionHistoryManager::rollback_to_timestamp(const std::chrono::s
     result.duration = std::chrono::milliseconds(0);
     
     try {
-        // 查找指定时间戳之前的最新版本
-        auto it = std::find_if(history_.rbegin(), history_.rend(),
-            [&timestamp](const VersionHistoryEntry& entry) {
-                return entry.timestamp <= timestamp;
-            });
-        
-        if (it != history_.rend()) {
-            result.message = "Found version to rollback to: " + it->new_version;
+        // 通过时间索引二分查找指定时间戳之前的最新版本
+        VersionHistoryEntry entry;
+        if (history_log_->find_at_or_before(timestamp, entry)) {
+            result.message = "Found version to rollback to: " + entry.package_name + " " + entry.new_version;
             result.success = true;
         } else {
             result.message = "No version found before timestamp";
@@ -704,28 +702,28 @@ RollbackResult VersionHistoryManager::rollback_to_timestamp(const std::chrono::s
 
 bool VersionHistoryManager::cleanup_old_history(size_t max_entries) {
     try {
-        if (history_.size() <= max_entries) {
+        if (history_log_->size() <= max_entries) {
             return true;
         }
         
-        // 按时间戳排序，保留最新的条目
-        std::sort(history_.begin(), history_.end(),
-            [](const VersionHistoryEntry& a, const VersionHistoryEntry& b) {
-                return a.timestamp < b.timestamp;
-            });
-        
-        // 删除旧的条目
-        size_t entries_to_remove = history_.size() - max_entries;
-        history_.erase(history_.begin(), history_.begin() + entries_to_remove);
-        
-        // 重新构建包历史映射
-        package_history_.clear();
-        for (const auto& entry : history_) {
-            package_history_[entry.package_name].push_back(entry);
+        // 保留最新的条目：历史日志只移动保留起点并删除整段过期的段
+        std::vector<VersionHistoryEntry> dropped;
+        if (history_log_->retain_latest(max_entries, &dropped) == 0) {
+            return false;
         }
         
-        // 保存更新后的历史
-        return save_history();
+        // 删除被清理条目的快照清单，再回收只被它们引用的对象
+        bool removed_snapshot = false;
+        for (const auto& entry : dropped) {
+            if (SnapshotStore::is_snapshot(entry.backup_path)) {
+                std::error_code ec;
+                removed_snapshot |= fs::remove(entry.backup_path, ec);
+            }
+        }
+        if (removed_snapshot) {
+            SnapshotStore(backup_dir_).collect_garbage();
+        }
+        return true;
         
     } catch (const std::exception& e) {
         LOG(ERROR) << "Error cleaning up old history: " << e.what();
@@ -741,28 +739,37 @@ bool VersionHistoryManager::export_history(const std::string& export_path) const
             return false;
         }
         
-        // 简单的JSON格式导出
-        export_file << "{\n";
-        export_file << "  \"history\": [\n";
-        
-        for (size_t i = 0; i < history_.size(); ++i) {
-            const auto& entry = history_[i];
-            export_file << "    {\n";
-            export_file << "      \"package_name\": \"" << entry.package_name << "\",\n";
-            export_file << "      \"old_version\": \"" << entry.old_version << "\",\n";
-            export_file << "      \"new_version\": \"" << entry.new_version << "\",\n";
-            export_file << "      \"timestamp\": \"" << std::chrono::duration_cast<std::chrono::seconds>(
-                entry.timestamp.time_since_epoch()).count() << "\",\n";
-            export_file << "      \"reason\": \"" << entry.reason << "\"\n";
-            export_file << "    }";
-            if (i < history_.size() - 1) {
-                export_file << ",";
-            }
-            export_file << "\n";
-        }
+        // 与旧版历史文件格式相同，可由 import_history 导入
+        nlohmann::json history_array = nlohmann::json::array();
+        history_log_->for_each([&](const VersionHistoryEntry& entry) {
+            nlohmann::json entry_json;
+            entry_json["package_name"] = entry.package_name;
+            entry_json["old_version"] = entry.old_version;
+            entry_json["new_version"] = entry.new_version;
+            entry_json["repository_url"] = entry.repository_url;
+            entry_json["reason"] = entry.reason;
+            entry_json["user"] = entry.user;
+            entry_json["commit_hash"] = entry.commit_hash;
+            entry_json["is_rollback"] = entry.is_rollback;
+            entry_json["backup_path"] = entry.backup_path;
+            entry_json["backup_size_bytes"] = entry.backup_size_bytes;
+            entry_json["affected_files"] = history_log_->load_affected_files(entry);
+            
+            // 格式化时间戳
+            auto time_t = std::chrono::system_clock::to_time_t(entry.timestamp);
+            std::stringstream ss;
+            ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+            entry_json["timestamp"] = ss.str();
+            
+            history_array.push_back(std::move(entry_json));
+            return true;
+        });
         
-        export_file << "  ]\n";
-        export_file << "}\n";
+        nlohmann::json j;
+        j["version"] = "1.0";
+        j["last_updated"] = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        j["history"] = std::move(history_array);
+        export_file << j.dump(2);
         
         LOG(INFO) << "History exported to: " << export_path;
         return true;
@@ -774,54 +781,27 @@ bool VersionHistoryManager::export_history(const std::string& export_path) const
 }
 
 bool VersionHistoryManager::import_history(const std::string& import_path) {
-    try {
-        std::ifstream import_file(import_path);
-        if (!import_file.is_open()) {
-            LOG(ERROR) << "Failed to open import file: " << import_path;
-            return false;
-        }
-        
-        // 简单的JSON格式导入
-        std::string line;
-        std::string content;
-        while (std::getline(import_file, line)) {
-            content += line + "\n";
-        }
-        
-        // 这里应该使用JSON解析库，但为了简单起见，我们只记录导入操作
-        LOG(INFO) << "History import from: " << import_path << " (simplified implementation)";
-        return true;
-        
-    } catch (const std::exception& e) {
-        LOG(ERROR) << "Error importing history: " << e.what();
+    size_t imported = 0;
+    if (!append_json_history(import_path, imported)) {
         return false;
     }
+    LOG(INFO) << "Imported " << imported << " history entries from: " << import_path;
+    return true;
 }
 
 VersionHistoryManager::HistoryStats VersionHistoryManager::get_statistics() const {
     HistoryStats stats;
     
-    stats.total_entries = history_.size();
-    stats.total_packages = package_history_.size();
-    stats.total_rollbacks = 0;
-    stats.total_backup_size_bytes = 0;
+    // 统计信息由历史日志的索引维护，不读取记录
+    HistoryLogStats log_stats = history_log_->stats();
+    stats.total_entries = log_stats.entries;
+    stats.total_packages = log_stats.packages;
+    stats.total_rollbacks = log_stats.rollbacks;
+    stats.total_backup_size_bytes = log_stats.backup_bytes;
     
-    if (!history_.empty()) {
-        auto minmax = std::minmax_element(history_.begin(), history_.end(),
-            [](const VersionHistoryEntry& a, const VersionHistoryEntry& b) {
-                return a.timestamp < b.timestamp;
-            });
-        
-        stats.first_entry = minmax.first->timestamp;
-        stats.last_entry = minmax.second->timestamp;
-        
-        // 计算回滚次数和备份大小
-        for (const auto& entry : history_) {
-            if (entry.is_rollback) {
-                stats.total_rollbacks++;
-            }
-            stats.total_backup_size_bytes += entry.backup_size_bytes;
-        }
+    if (log_stats.entries > 0) {
+        stats.first_entry = log_stats.first;
+        stats.last_entry = log_stats.last;
     } else {
         // 如果没有历史记录，设置默认值
         stats.first_entry = std::chrono::system_clock::now();
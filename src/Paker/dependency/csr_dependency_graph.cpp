@@ -0,0 +1,341 @@
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include "Paker/dependency/graph_condensation.h"
+#include <algorithm>
+#include <glog/logging.h>
+
+namespace Paker {
+
+// NodeInterner 实现
+NodeInterner::NodeId NodeInterner::intern(std::string_view name) {
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    NodeId id = static_cast<NodeId>(names_.size());
+    names_.emplace_back(name);
+    index_.emplace(names_.back(), id);
+    return id;
+}
+
+NodeInterner::NodeId NodeInterner::find(std::string_view name) const {
+    auto it = index_.find(name);
+    return it != index_.end() ? it->second : INVALID_ID;
+}
+
+void NodeInterner::reserve(size_t count) {
+    index_.reserve(count);
+}
+
+void NodeInterner::clear() {
+    names_.clear();
+    index_.clear();
+}
+
+// CSRDependencyGraph 实现
+CSRDependencyGraph::CSRDependencyGraph()
+    : name_offsets_(1, 0), out_offsets_(1, 0), in_offsets_(1, 0) {}
+
+CSRDependencyGraph CSRDependencyGraph::from_graph(const DependencyGraph& graph) {
+    CSRGraphBuilder builder;
+    const auto& adjacency = graph.get_adjacency_list();
+
+    size_t edge_total = 0;
+    for (const auto& [name, deps] : adjacency) {
+        edge_total += deps.size();
+    }
+    builder.reserve(graph.size(), edge_total);
+
+    // 按名称顺序分配ID，保持与 std::map 遍历顺序一致
+    for (const auto& [name, _] : graph.get_nodes()) {
+        builder.add_node(name);
+    }
+    for (const auto& [name, deps] : adjacency) {
+        auto from = builder.add_node(name);
+        for (const auto& dep : deps) {
+            builder.add_edge(from, builder.add_node(dep));
+        }
+    }
+
+    return builder.build();
+}
+
+CSRDependencyGraph CSRDependencyGraph::from_graph(const OptimizedDependencyGraph& graph) {
+    CSRGraphBuilder builder;
+    const auto& nodes = graph.nodes_;
+    builder.reserve(nodes.size(), graph.get_edge_count());
+
+    // 节点ID与 OptimizedDependencyGraph 的索引一一对应
+    for (const auto& node : nodes) {
+        builder.add_node(node.name);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t dep_index : nodes[i].dependency_indices) {
+            if (dep_index < nodes.size()) {
+                builder.add_edge(static_cast<NodeId>(i), static_cast<NodeId>(dep_index));
+            }
+        }
+    }
+
+    return builder.build();
+}
+
+CSRDependencyGraph::NodeId CSRDependencyGraph::find(std::string_view name) const {
+    auto it = name_index_.find(name);
+    return it != name_index_.end() ? it->second : INVALID_NODE;
+}
+
+std::string_view CSRDependencyGraph::name(NodeId id) const {
+    if (id >= node_count()) {
+        return {};
+    }
+    return std::string_view(name_pool_.data() + name_offsets_[id],
+                            name_offsets_[id + 1] - name_offsets_[id]);
+}
+
+std::optional<Symbol> CSRDependencyGraph::find_symbol(NodeId id) const {
+    if (id >= node_count()) {
+        return std::nullopt;
+    }
+    return StringInterner::instance().find(name(id));
+}
+
+std::vector<CSRDependencyGraph::NodeId> CSRDependencyGraph::topological_order() const {
+    const size_t n = node_count();
+    std::vector<uint32_t> remaining(n);
+    std::vector<NodeId> order;
+    order.reserve(n);
+
+    for (NodeId i = 0; i < n; ++i) {
+        remaining[i] = static_cast<uint32_t>(in_degree(i));
+        if (remaining[i] == 0) {
+            order.push_back(i);
+        }
+    }
+
+    // order 同时作为 FIFO 队列使用
+    for (size_t head = 0; head < order.size(); ++head) {
+        for (NodeId dep : dependencies(order[head])) {
+            if (--remaining[dep] == 0) {
+                order.push_back(dep);
+            }
+        }
+    }
+
+    return order;
+}
+
+std::vector<std::string> CSRDependencyGraph::topological_sort() const {
+    auto order = topological_order();
+    if (order.size() != node_count()) {
+        LOG(WARNING) << "Circular dependency detected in topological sort";
+    }
+    return to_names(order);
+}
+
+std::vector<std::vector<CSRDependencyGraph::NodeId>> CSRDependencyGraph::find_cycles() const {
+    std::vector<std::vector<NodeId>> cycles;
+    GraphCondensation condensation(*this);
+    for (auto comp : condensation.cyclic_components()) {
+        cycles.push_back(condensation.representative_cycle(comp));
+    }
+    return cycles;
+}
+
+std::vector<std::vector<std::string>> CSRDependencyGraph::detect_cycles() const {
+    std::vector<std::vector<std::string>> result;
+    for (const auto& cycle : find_cycles()) {
+        result.push_back(to_names(cycle));
+    }
+    return result;
+}
+
+std::vector<std::vector<CSRDependencyGraph::NodeId>> CSRDependencyGraph::find_paths(
+    NodeId from, NodeId to, size_t max_paths) const {
+    std::vector<std::vector<NodeId>> paths;
+    const size_t n = node_count();
+    if (from >= n || to >= n || max_paths == 0) {
+        return paths;
+    }
+
+    std::vector<NodeId> path{from};
+    if (from == to) {
+        paths.push_back(path);
+        return paths;
+    }
+
+    // 剪枝：到不了 to 的分支在菱形依赖下会被重复展开指数次
+    std::vector<uint8_t> reaches_to(n, 0);
+    reaches_to[to] = 1;
+    for (NodeId id : bfs(to, false)) {
+        reaches_to[id] = 1;
+    }
+    if (!reaches_to[from]) {
+        return paths;
+    }
+
+    std::vector<uint8_t> on_path(n, 0);
+    std::vector<uint32_t> cursors{out_offsets_[from]};
+    on_path[from] = 1;
+
+    while (!path.empty() && paths.size() < max_paths) {
+        NodeId node = path.back();
+        uint32_t& cursor = cursors.back();
+        if (cursor == out_offsets_[node + 1]) {
+            on_path[node] = 0;
+            path.pop_back();
+            cursors.pop_back();
+            continue;
+        }
+
+        NodeId dep = out_edges_[cursor++];
+        if (on_path[dep] || !reaches_to[dep]) continue;
+
+        if (dep == to) {
+            paths.push_back(path);
+            paths.back().push_back(dep);
+        } else {
+            on_path[dep] = 1;
+            path.push_back(dep);
+            cursors.push_back(out_offsets_[dep]);
+        }
+    }
+
+    return paths;
+}
+
+std::vector<CSRDependencyGraph::NodeId> CSRDependencyGraph::reachable_from(NodeId id) const {
+    return bfs(id, true);
+}
+
+std::vector<CSRDependencyGraph::NodeId> CSRDependencyGraph::reachable_to(NodeId id) const {
+    return bfs(id, false);
+}
+
+std::vector<CSRDependencyGraph::NodeId> CSRDependencyGraph::bfs(NodeId start, bool forward) const {
+    std::vector<NodeId> visited_order;
+    const size_t n = node_count();
+    if (start >= n) {
+        return visited_order;
+    }
+
+    const auto& offsets = forward ? out_offsets_ : in_offsets_;
+    const auto& edges = forward ? out_edges_ : in_edges_;
+
+    std::vector<uint8_t> seen(n, 0);
+    seen[start] = 1;
+    visited_order.push_back(start);
+    for (size_t head = 0; head < visited_order.size(); ++head) {
+        NodeId node = visited_order[head];
+        for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+            NodeId next = edges[e];
+            if (!seen[next]) {
+                seen[next] = 1;
+                visited_order.push_back(next);
+            }
+        }
+    }
+
+    visited_order.erase(visited_order.begin());
+    return visited_order;
+}
+
+std::vector<std::string> CSRDependencyGraph::to_names(const std::vector<NodeId>& ids) const {
+    std::vector<std::string> names;
+    names.reserve(ids.size());
+    for (NodeId id : ids) {
+        names.emplace_back(name(id));
+    }
+    return names;
+}
+
+size_t CSRDependencyGraph::get_memory_usage() const {
+    size_t usage = sizeof(*this);
+    usage += name_pool_.capacity();
+    usage += name_offsets_.capacity() * sizeof(uint32_t);
+    usage += name_index_.bucket_count() * sizeof(void*);
+    usage += name_index_.size() * (sizeof(std::string_view) + sizeof(NodeId) + sizeof(void*));
+    usage += (out_offsets_.capacity() + in_offsets_.capacity()) * sizeof(uint32_t);
+    usage += (out_edges_.capacity() + in_edges_.capacity()) * sizeof(NodeId);
+    return usage;
+}
+
+// CSRGraphBuilder 实现
+void CSRGraphBuilder::reserve(size_t nodes, size_t edges) {
+    interner_.reserve(nodes);
+    edges_.reserve(edges);
+}
+
+CSRGraphBuilder::NodeId CSRGraphBuilder::add_node(std::string_view name) {
+    return interner_.intern(name);
+}
+
+void CSRGraphBuilder::add_edge(NodeId from, NodeId to) {
+    edges_.emplace_back(from, to);
+}
+
+void CSRGraphBuilder::add_edge(std::string_view from, std::string_view to) {
+    NodeId from_id = add_node(from);
+    NodeId to_id = add_node(to);
+    edges_.emplace_back(from_id, to_id);
+}
+
+CSRDependencyGraph CSRGraphBuilder::build() {
+    CSRDependencyGraph graph;
+    const size_t n = interner_.size();
+
+    // 名称池
+    size_t pool_size = 0;
+    for (const auto& name : interner_.names()) {
+        pool_size += name.size();
+    }
+    graph.name_pool_.reserve(pool_size);
+    graph.name_offsets_.reserve(n + 1);
+    for (const auto& name : interner_.names()) {
+        graph.name_pool_.insert(graph.name_pool_.end(), name.begin(), name.end());
+        graph.name_offsets_.push_back(static_cast<uint32_t>(graph.name_pool_.size()));
+    }
+    graph.name_index_.reserve(n);
+    for (NodeId id = 0; id < n; ++id) {
+        graph.name_index_.emplace(graph.name(id), id);
+    }
+
+    // 边按 (from, to) 排序并去重
+    std::sort(edges_.begin(), edges_.end());
+    edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+
+    // 正向 CSR
+    graph.out_offsets_.assign(n + 1, 0);
+    graph.out_edges_.reserve(edges_.size());
+    for (const auto& [from, to] : edges_) {
+        graph.out_offsets_[from + 1]++;
+        graph.out_edges_.push_back(to);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        graph.out_offsets_[i + 1] += graph.out_offsets_[i];
+    }
+
+    // 反向 CSR（计数排序，保证每个节点的入边按来源ID有序）
+    graph.in_offsets_.assign(n + 1, 0);
+    for (const auto& [from, to] : edges_) {
+        (void)from;
+        graph.in_offsets_[to + 1]++;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        graph.in_offsets_[i + 1] += graph.in_offsets_[i];
+    }
+    graph.in_edges_.resize(edges_.size());
+    std::vector<uint32_t> fill(graph.in_offsets_.begin(), graph.in_offsets_.end() - 1);
+    for (const auto& [from, to] : edges_) {
+        graph.in_edges_[fill[to]++] = from;
+    }
+
+    interner_.clear();
+    edges_.clear();
+    edges_.shrink_to_fit();
+
+    return graph;
+}
+
+} // namespace Paker
@@ -1,8 +1,9 @@
 #include "Paker/dependency/dependency_graph.h"
 #include "Paker/dependency/version_manager.h"
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/graph_condensation.h"
+#include "Paker/dependency/reachability_index.h"
 #include <algorithm>
-#include <queue>
-#include <stack>
 #include <unordered_set>
 #include <glog/logging.h>
 
@@ -78,10 +79,84 @@ VersionConstraint VersionConstraint::parse(const std::string& constraint) {
 }
 
 // DependencyGraph 实现
+DependencyGraph::DependencyGraph(const DependencyGraph& other)
+    : nodes_(other.nodes_),
+      adjacency_list_(other.adjacency_list_),
+      version_(other.version_),
+      topo_order_(other.topo_order_) {
+    {
+        std::lock_guard<std::mutex> lock(other.reachability_mutex_);
+        reachability_ = other.reachability_;
+        reachability_version_ = other.reachability_version_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(other.frozen_mutex_);
+        frozen_ = other.frozen_;
+        frozen_version_ = other.frozen_version_;
+    }
+    rebuild_topo_index(other.topo_names_);
+}
+
+// std::map 移动后节点地址不变，索引随之移动；源对象清空为空图
+DependencyGraph::DependencyGraph(DependencyGraph&& other) noexcept
+    : nodes_(std::move(other.nodes_)),
+      adjacency_list_(std::move(other.adjacency_list_)),
+      version_(other.version_),
+      frozen_(std::move(other.frozen_)),
+      frozen_version_(other.frozen_version_),
+      reachability_(std::move(other.reachability_)),
+      reachability_version_(other.reachability_version_),
+      topo_order_(std::move(other.topo_order_)),
+      topo_ids_(std::move(other.topo_ids_)),
+      topo_names_(std::move(other.topo_names_)) {
+    other.clear();
+}
+
+DependencyGraph& DependencyGraph::operator=(const DependencyGraph& other) {
+    if (this != &other) {
+        DependencyGraph copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+DependencyGraph& DependencyGraph::operator=(DependencyGraph&& other) noexcept {
+    if (this != &other) {
+        nodes_ = std::move(other.nodes_);
+        adjacency_list_ = std::move(other.adjacency_list_);
+        version_ = other.version_;
+        frozen_ = std::move(other.frozen_);
+        frozen_version_ = other.frozen_version_;
+        reachability_ = std::move(other.reachability_);
+        reachability_version_ = other.reachability_version_;
+        topo_order_ = std::move(other.topo_order_);
+        topo_ids_ = std::move(other.topo_ids_);
+        topo_names_ = std::move(other.topo_names_);
+        other.clear();
+    }
+    return *this;
+}
+
+void DependencyGraph::rebuild_topo_index(const std::vector<const std::string*>& source_names) {
+    topo_ids_.clear();
+    topo_names_.clear();
+    topo_names_.reserve(source_names.size());
+    for (uint32_t id = 0; id < source_names.size(); ++id) {
+        auto it = nodes_.find(*source_names[id]);
+        topo_ids_.emplace(it->first, id);
+        topo_names_.push_back(&it->first);
+    }
+}
+
 void DependencyGraph::add_node(const DependencyNode& node) {
-    nodes_[node.name] = node;
+    auto [it, inserted] = nodes_.insert_or_assign(node.name, node);
     if (adjacency_list_.find(node.name) == adjacency_list_.end()) {
         adjacency_list_[node.name] = std::set<std::string>();
+        ++version_;
+    }
+    if (inserted) {
+        topo_ids_.emplace(it->first, topo_order_.add_node());
+        topo_names_.push_back(&it->first);
     }
 }
 
@@ -91,10 +166,52 @@ void DependencyGraph::add_dependency(const std::string& from, const std::string&
         return;
     }
     
-    adjacency_list_[from].insert(to);
+    if (adjacency_list_[from].insert(to).second) {
+        ++version_;
+        if (!topo_order_.add_edge(topo_ids_.at(from), topo_ids_.at(to))) {
+            LOG(WARNING) << "Dependency " << from << " -> " << to << " introduces a cycle";
+        }
+    }
     nodes_[from].dependencies.insert(to);
 }
 
+bool DependencyGraph::try_add_dependency(const std::string& from, const std::string& to,
+                                         std::vector<std::string>* cycle) {
+    if (nodes_.find(from) == nodes_.end() || nodes_.find(to) == nodes_.end()) {
+        LOG(WARNING) << "Cannot add dependency: node not found";
+        return false;
+    }
+    
+    if (adjacency_list_[from].count(to) == 0) {
+        std::vector<uint32_t> cycle_ids;
+        if (!topo_order_.try_add_edge(topo_ids_.at(from), topo_ids_.at(to), cycle ? &cycle_ids : nullptr)) {
+            if (cycle) {
+                cycle->clear();
+                for (auto id : cycle_ids) {
+                    cycle->push_back(*topo_names_[id]);
+                }
+            }
+            return false;
+        }
+        adjacency_list_[from].insert(to);
+        ++version_;
+    }
+    nodes_[from].dependencies.insert(to);
+    return true;
+}
+
+bool DependencyGraph::remove_dependency(const std::string& from, const std::string& to) {
+    auto adj_it = adjacency_list_.find(from);
+    if (adj_it == adjacency_list_.end() || adj_it->second.erase(to) == 0) {
+        return false;
+    }
+    
+    nodes_[from].dependencies.erase(to);
+    topo_order_.remove_edge(topo_ids_.at(from), topo_ids_.at(to));
+    ++version_;
+    return true;
+}
+
 const DependencyNode* DependencyGraph::get_node(const std::string& name) const {
     auto it = nodes_.find(name);
     return it != nodes_.end() ? &it->second : nullptr;
@@ -115,138 +232,109 @@ std::set<std::string> DependencyGraph::get_dependencies(const std::string& name)
 }
 
 std::vector<std::string> DependencyGraph::topological_sort() const {
-    std::vector<std::string> result;
-    std::map<std::string, int> in_degree;
-    std::queue<std::string> q;
-    
-    // 计算入度
-    for (const auto& [node, deps] : adjacency_list_) {
-        if (in_degree.find(node) == in_degree.end()) {
-            in_degree[node] = 0;
-        }
-        for (const auto& dep : deps) {
-            in_degree[dep]++;
-        }
+    if (!topo_order_.is_acyclic()) {
+        // 有环时退回到整图 Kahn 排序（结果不完整并给出警告）
+        return freeze()->topological_sort();
     }
     
-    // 将入度为0的节点加入队列
-    for (const auto& [node, degree] : in_degree) {
-        if (degree == 0) {
-            q.push(node);
-        }
-    }
-    
-    // 拓扑排序
-    while (!q.empty()) {
-        std::string current = q.front();
-        q.pop();
-        result.push_back(current);
-        
-        for (const auto& dep : get_dependencies(current)) {
-            in_degree[dep]--;
-            if (in_degree[dep] == 0) {
-                q.push(dep);
-            }
-        }
-    }
-    
-    // 检查是否有循环依赖
-    if (result.size() != nodes_.size()) {
-        LOG(WARNING) << "Circular dependency detected in topological sort";
+    std::vector<std::string> result;
+    result.reserve(topo_names_.size());
+    for (auto id : topo_order_.order()) {
+        result.push_back(*topo_names_[id]);
     }
-    
     return result;
 }
 
 std::vector<std::vector<std::string>> DependencyGraph::detect_cycles() const {
-    std::vector<std::vector<std::string>> cycles;
-    std::unordered_set<std::string> visited;
-    std::unordered_set<std::string> rec_stack;
-    std::vector<std::string> path;
-    
-    for (const auto& [node_name, _] : nodes_) {
-        if (visited.find(node_name) == visited.end()) {
-            dfs_cycle_detection(node_name, visited, rec_stack, path, cycles);
-        }
-    }
-    
-    return cycles;
+    return freeze()->detect_cycles();
+}
+
+std::vector<std::vector<std::string>> DependencyGraph::get_all_paths(const std::string& from, const std::string& to) const {
+    return get_shortest_paths(from, to, CSRDependencyGraph::DEFAULT_MAX_PATHS);
 }
 
-void DependencyGraph::dfs_cycle_detection(const std::string& node,
-                                        std::unordered_set<std::string>& visited,
-                                        std::unordered_set<std::string>& rec_stack,
-                                        std::vector<std::string>& path,
-                                        std::vector<std::vector<std::string>>& cycles) const {
-    visited.insert(node);
-    rec_stack.insert(node);
-    path.push_back(node);
+std::vector<std::vector<std::string>> DependencyGraph::get_all_paths_to_package(const std::string& package) const {
+    std::vector<std::vector<std::string>> all_paths;
+    auto csr = freeze();
+    auto target = csr->find(package);
+    if (target == CSRDependencyGraph::INVALID_NODE) {
+        return all_paths;
+    }
     
-    for (const auto& dep : get_dependencies(node)) {
-        if (visited.find(dep) == visited.end()) {
-            dfs_cycle_detection(dep, visited, rec_stack, path, cycles);
-        } else if (rec_stack.find(dep) != rec_stack.end()) {
-            // 找到循环
-            auto cycle_start = std::find(path.begin(), path.end(), dep);
-            if (cycle_start != path.end()) {
-                std::vector<std::string> cycle(cycle_start, path.end());
-                cycle.push_back(dep);
-                cycles.push_back(cycle);
-            }
+    // 只有能到达目标的节点才可能产生路径；总数受同一上限约束
+    auto sources = csr->reachable_to(target);
+    std::sort(sources.begin(), sources.end());
+    for (auto source : sources) {
+        size_t remaining = CSRDependencyGraph::DEFAULT_MAX_PATHS - all_paths.size();
+        if (remaining == 0) {
+            break;
+        }
+        for (const auto& path : k_shortest_paths(*csr, {source}, target, remaining)) {
+            all_paths.push_back(csr->to_names(path));
         }
     }
     
-    rec_stack.erase(node);
-    path.pop_back();
+    return all_paths;
 }
 
-std::vector<std::vector<std::string>> DependencyGraph::get_all_paths(const std::string& from, const std::string& to) const {
+std::vector<std::vector<std::string>> DependencyGraph::get_shortest_paths(const std::string& from,
+                                                                         const std::string& to,
+                                                                         size_t k) const {
+    auto csr = freeze();
+    auto from_id = csr->find(from);
+    auto to_id = csr->find(to);
     std::vector<std::vector<std::string>> paths;
-    std::vector<std::string> current_path;
-    std::unordered_set<std::string> visited;
+    if (from_id == CSRDependencyGraph::INVALID_NODE || to_id == CSRDependencyGraph::INVALID_NODE) {
+        return paths;
+    }
     
-    dfs_find_paths(from, to, visited, current_path, paths);
+    for (const auto& path : k_shortest_paths(*csr, {from_id}, to_id, k)) {
+        paths.push_back(csr->to_names(path));
+    }
     return paths;
 }
 
-void DependencyGraph::dfs_find_paths(const std::string& current,
-                                   const std::string& target,
-                                   std::unordered_set<std::string>& visited,
-                                   std::vector<std::string>& current_path,
-                                   std::vector<std::vector<std::string>>& paths) const {
-    visited.insert(current);
-    current_path.push_back(current);
-    
-    if (current == target) {
-        paths.push_back(current_path);
-    } else {
-        for (const auto& dep : get_dependencies(current)) {
-            if (visited.find(dep) == visited.end()) {
-                dfs_find_paths(dep, target, visited, current_path, paths);
-            }
-        }
+bool DependencyGraph::depends_on(const std::string& from, const std::string& to) const {
+    return reachability_index()->reaches(from, to);
+}
+
+std::vector<std::string> DependencyGraph::get_transitive_dependencies(const std::string& name) const {
+    auto result = reachability_index()->transitive_dependencies(name);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> DependencyGraph::get_transitive_dependents(const std::string& name) const {
+    auto result = reachability_index()->transitive_dependents(name);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::shared_ptr<const CSRDependencyGraph> DependencyGraph::freeze() const {
+    std::lock_guard<std::mutex> lock(frozen_mutex_);
+    if (!frozen_ || frozen_version_ != version_) {
+        frozen_ = std::make_shared<const CSRDependencyGraph>(CSRDependencyGraph::from_graph(*this));
+        frozen_version_ = version_;
     }
-    
-    visited.erase(current);
-    current_path.pop_back();
+    return frozen_;
 }
 
-std::vector<std::vector<std::string>> DependencyGraph::get_all_paths_to_package(const std::string& package) const {
-    std::vector<std::vector<std::string>> all_paths;
-    
-    for (const auto& [node_name, _] : nodes_) {
-        if (node_name != package) {
-            auto paths = get_all_paths(node_name, package);
-            all_paths.insert(all_paths.end(), paths.begin(), paths.end());
-        }
+std::shared_ptr<const ReachabilityIndex> DependencyGraph::reachability_index() const {
+    std::lock_guard<std::mutex> lock(reachability_mutex_);
+    if (!reachability_ || reachability_version_ != version_) {
+        reachability_ = std::make_shared<const ReachabilityIndex>(freeze());
+        reachability_version_ = version_;
     }
-    
-    return all_paths;
+    return reachability_;
 }
 
 void DependencyGraph::clear() {
     nodes_.clear();
     adjacency_list_.clear();
+    topo_order_.clear();
+    topo_ids_.clear();
+    topo_names_.clear();
+    ++version_;
 }
 
 } // namespace Paker 
\ No newline at end of file
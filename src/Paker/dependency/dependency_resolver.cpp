@@ -4,6 +4,9 @@
 #include "Paker/dependency/sources.h"
 #include "Paker/core/package_manager.h"
 #include "Paker/dependency/version_manager.h"
+#include "Paker/dependency/graph_snapshot.h"
+#include "Paker/core/command_arena.h"
+#include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -86,6 +89,43 @@ bool DependencyResolver::resolve_package(const std::string& package, const std::
     return true;
 }
 
+bool DependencyResolver::reload_package(const std::string& package, const std::string& version) {
+    const DependencyNode* existing = graph_.get_node(package);
+    if (!existing) {
+        return resolve_package(package, version);
+    }
+    
+    // 先撤掉旧清单中的依赖边，再按当前清单重建节点
+    DependencyNode node(package, version.empty() ? existing->version : version);
+    node.repository = existing->repository;
+    // 旧依赖名字是本次重载的临时数据，整个放在 arena 上；图接口以 std::string 为参数，经复用的缓冲区传入
+    std::pmr::vector<std::pmr::string> previous(current_arena_resource());
+    previous.reserve(existing->dependencies.size());
+    for (const auto& dep : existing->dependencies) {
+        previous.emplace_back(dep);
+    }
+    std::string dep_name;
+    for (const auto& dep : previous) {
+        dep_name.assign(dep.data(), dep.size());
+        graph_.remove_dependency(package, dep_name);
+    }
+    
+    std::string install_path = get_package_install_path(package);
+    if (fs::exists(install_path)) {
+        node.is_installed = true;
+        node.install_path = install_path;
+        if (!read_package_dependencies(install_path, node)) {
+            LOG(WARNING) << "Failed to read dependencies for installed package: " << package;
+        }
+    }
+    graph_.add_node(node);
+    
+    if (recursive_mode_) {
+        return resolve_recursive_dependencies(package, node.version);
+    }
+    return true;
+}
+
 bool DependencyResolver::resolve_project_dependencies() {
     std::string json_file = get_json_file();
     if (!fs::exists(json_file)) {
@@ -93,7 +133,34 @@ bool DependencyResolver::resolve_project_dependencies() {
         return false;
     }
     
-    return load_dependencies_from_json(json_file);
+    // 清单与已安装包均未变化时直接复用上次的解析结果
+    const bool cacheable = graph_.empty();
+    uint64_t fingerprint = 0;
+    std::string snapshot_file;
+    if (cacheable) {
+        fingerprint = compute_project_fingerprint(json_file);
+        snapshot_file = get_snapshot_file(json_file);
+        if (load_graph_snapshot(snapshot_file, fingerprint)) {
+            // 仓库映射不在快照中，仍从清单读取
+            try {
+                std::ifstream ifs(json_file);
+                json j;
+                ifs >> j;
+                load_remotes_from_json(j);
+            } catch (const std::exception& e) {
+                LOG(WARNING) << "Failed to read remotes from " << json_file << ": " << e.what();
+            }
+            return true;
+        }
+    }
+    
+    if (!load_dependencies_from_json(json_file)) {
+        return false;
+    }
+    if (cacheable) {
+        save_graph_snapshot(snapshot_file, fingerprint);
+    }
+    return true;
 }
 
 bool DependencyResolver::resolve_recursive_dependencies(const std::string& package, const std::string& version) {
@@ -212,15 +279,7 @@ bool DependencyResolver::load_dependencies_from_json(const std::string& json_fil
         scan_installed_packages();
         
         // 解析自定义仓库
-        if (j.contains("remotes")) {
-            for (const auto& remote : j["remotes"]) {
-                if (remote.contains("name") && remote.contains("url")) {
-                    std::string name = remote["name"];
-                    std::string url = remote["url"];
-                    add_repository(name, url);
-                }
-            }
-        }
+        load_remotes_from_json(j);
         
         LOG(INFO) << "Loaded dependencies from JSON file: " << json_file;
         return true;
@@ -309,6 +368,121 @@ bool DependencyResolver::save_dependencies_to_json(const std::string& json_file)
     }
 }
 
+void DependencyResolver::load_remotes_from_json(const json& j) {
+    if (j.contains("remotes")) {
+        for (const auto& remote : j["remotes"]) {
+            if (remote.contains("name") && remote.contains("url")) {
+                std::string name = remote["name"];
+                std::string url = remote["url"];
+                add_repository(name, url);
+            }
+        }
+    }
+}
+
+bool DependencyResolver::save_graph_snapshot(const std::string& snapshot_file, uint64_t fingerprint) const {
+    return GraphSnapshot::write(graph_, snapshot_file, fingerprint);
+}
+
+bool DependencyResolver::load_graph_snapshot(const std::string& snapshot_file, uint64_t expected_fingerprint) {
+    GraphSnapshot snapshot;
+    if (!snapshot.open(snapshot_file)) {
+        return false;
+    }
+    if (snapshot.fingerprint() != expected_fingerprint) {
+        VLOG(1) << "Graph snapshot is stale: " << snapshot_file;
+        return false;
+    }
+    
+    graph_.clear();
+    for (uint32_t id = 0; id < snapshot.node_count(); ++id) {
+        DependencyNode node{std::string(snapshot.name(id)), std::string(snapshot.version(id))};
+        node.repository = snapshot.repository(id);
+        node.install_path = snapshot.install_path(id);
+        node.is_installed = snapshot.is_installed(id);
+        
+        // 依赖列表与约束按声明还原，包括没有对应边的条目
+        for (size_t i = 0; i < snapshot.declared_count(id); ++i) {
+            auto declared = snapshot.declared(id, i);
+            std::string dep_name(declared.name);
+            if (declared.has_constraint) {
+                node.version_constraints[dep_name] = VersionConstraint::parse(std::string(declared.constraint));
+            }
+            if (declared.listed) {
+                node.dependencies.insert(std::move(dep_name));
+            }
+        }
+        graph_.add_node(node);
+    }
+    for (uint32_t id = 0; id < snapshot.node_count(); ++id) {
+        std::string from(snapshot.name(id));
+        for (auto dep : snapshot.dependencies(id)) {
+            graph_.add_dependency(from, std::string(snapshot.name(dep)));
+        }
+    }
+    
+    LOG(INFO) << "Loaded resolved dependency graph from snapshot: " << snapshot_file
+              << " (" << snapshot.node_count() << " packages)";
+    return true;
+}
+
+uint64_t DependencyResolver::compute_project_fingerprint(const std::string& json_file) const {
+    // 清单内容与目录项都是本次解析的临时数据，启用了 arena 时从 arena 分配
+    std::pmr::memory_resource* resource = current_arena_resource();
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](std::string_view data) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    };
+    
+    std::ifstream ifs(json_file, std::ios::binary);
+    mix(std::pmr::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>(), resource));
+    mix(recursive_mode_ ? "recursive" : "flat");
+    
+    // 已安装包：目录项以及解析时会读取的配置文件的修改时间
+    std::error_code ec;
+    fs::path packages_dir = "packages";
+    if (fs::is_directory(packages_dir, ec)) {
+        auto append_stamp = [](std::pmr::string& line, const fs::path& path) {
+            std::error_code stamp_ec;
+            auto time = fs::last_write_time(path, stamp_ec);
+            line += ':';
+            if (stamp_ec) {
+                line += '-';
+                return;
+            }
+            char buffer[32];
+            line.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), time.time_since_epoch().count()).ptr);
+        };
+        
+        std::pmr::vector<std::pmr::string> entries(resource);
+        for (const auto& entry : fs::directory_iterator(packages_dir, ec)) {
+            std::pmr::string line(resource);
+            line += entry.path().filename().native();
+            append_stamp(line, entry.path());
+            for (const char* file : {".git/HEAD", "package.json", "CMakeLists.txt", "paker.json", "dependencies.json"}) {
+                append_stamp(line, entry.path() / file);
+            }
+            entries.push_back(std::move(line));
+        }
+        std::sort(entries.begin(), entries.end());
+        for (const auto& line : entries) {
+            mix(line);
+        }
+    }
+    return hash;
+}
+
+std::string DependencyResolver::get_snapshot_file(const std::string& json_file) const {
+    // 快照放在清单所在的项目根目录下，不随当前工作目录变化
+    fs::path project_root = fs::absolute(json_file).parent_path();
+    return (project_root / ".paker" / "resolved_graph.snapshot").string();
+}
+
 bool DependencyResolver::parse_package_metadata(const std::string& package, const std::string& version) {
     // 这里应该解析包的元数据文件（如 package.json, CMakeLists.txt 等）
     // 简化实现，返回 true
@@ -317,14 +491,14 @@ bool DependencyResolver::parse_package_metadata(const std::string& package, cons
 
 bool DependencyResolver::read_package_dependencies(const std::string& package_path, DependencyNode& node) {
     // 尝试读取各种可能的依赖配置文件
-    std::vector<std::string> config_files = {
+    static constexpr const char* config_files[] = {
         "package.json",
         "CMakeLists.txt",
         "paker.json",
         "dependencies.json"
     };
     
-    for (const auto& config_file : config_files) {
+    for (const char* config_file : config_files) {
         fs::path config_path = fs::path(package_path) / config_file;
         if (fs::exists(config_path)) {
             if (read_dependencies_from_file(config_path.string(), node)) {
@@ -383,13 +557,13 @@ bool DependencyResolver::read_dependencies_from_json(std::ifstream& ifs, Depende
 }
 
 bool DependencyResolver::read_dependencies_from_cmake(std::ifstream& ifs, DependencyNode& node) {
-    // 改进的 CMake 依赖解析
-    std::string line;
+    // 改进的 CMake 依赖解析；行缓冲是临时数据，启用了 arena 时从 arena 分配
+    std::pmr::string line(current_arena_resource());
     while (std::getline(ifs, line)) {
         // 移除注释和多余空格
         size_t comment_pos = line.find('#');
         if (comment_pos != std::string::npos) {
-            line = line.substr(0, comment_pos);
+            line.erase(comment_pos);
         }
         
         // 移除前后空格
@@ -405,15 +579,17 @@ bool DependencyResolver::read_dependencies_from_cmake(std::ifstream& ifs, Depend
             size_t close_paren = line.find(')');
             
             if (open_paren != std::string::npos && close_paren != std::string::npos) {
-                std::string package_part = line.substr(open_paren + 1, close_paren - open_paren - 1);
+                std::string_view package_part(line);
+                package_part = package_part.substr(open_paren + 1, close_paren - open_paren - 1);
                 
                 // 提取包名（第一个单词）
-                std::istringstream iss(package_part);
-                std::string package_name;
-                if (iss >> package_name) {
+                size_t begin = package_part.find_first_not_of(" \t\r\n\v\f");
+                if (begin != std::string_view::npos) {
+                    size_t end = package_part.find_first_of(" \t\r\n\v\f", begin);
+                    std::string package_name(package_part.substr(begin, end == std::string_view::npos ? end : end - begin));
                     // 验证包名是否有效（不包含特殊字符）
                     if (is_valid_package_name(package_name)) {
-                        node.dependencies.insert(package_name);
+                        node.dependencies.insert(std::move(package_name));
                     }
                 }
             }
@@ -451,7 +627,7 @@ bool DependencyResolver::infer_dependencies_from_structure(const std::string& pa
     try {
         // 从目录结构推断依赖（简化实现）
         // 检查是否有第三方库目录
-        std::vector<std::string> third_party_dirs = {
+        static constexpr const char* third_party_dirs[] = {
             "third_party",
             "external",
             "deps",
@@ -459,7 +635,7 @@ bool DependencyResolver::infer_dependencies_from_structure(const std::string& pa
             "vendor"
         };
         
-        for (const auto& dir : third_party_dirs) {
+        for (const char* dir : third_party_dirs) {
             fs::path third_party_path = fs::path(package_path) / dir;
             if (fs::exists(third_party_path) && fs::is_directory(third_party_path)) {
                 try {
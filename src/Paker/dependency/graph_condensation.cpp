@@ -0,0 +1,366 @@
+#include "Paker/dependency/graph_condensation.h"
+#include "Paker/core/slab_allocator.h"
+#include <algorithm>
+#include <deque>
+#include <memory_resource>
+#include <queue>
+#include <unordered_map>
+#include <limits>
+#include <tuple>
+
+namespace Paker {
+
+namespace {
+constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+}
+
+GraphCondensation::GraphCondensation(const CSRDependencyGraph& graph) : graph_(graph) {
+    run_tarjan();
+    build_dag();
+}
+
+void GraphCondensation::run_tarjan() {
+    const size_t n = graph_.node_count();
+    const auto& offsets = graph_.out_offsets();
+    const auto& edges = graph_.out_edges();
+
+    component_.assign(n, UNVISITED);
+    std::vector<uint32_t> index(n, UNVISITED);
+    std::vector<uint32_t> low(n, 0);
+    std::vector<uint8_t> on_stack(n, 0);
+    std::vector<NodeId> scc_stack;
+    std::vector<std::pair<NodeId, uint32_t>> call_stack;  // (节点, 下一条边的偏移)
+
+    uint32_t next_index = 0;
+    ComponentId next_component = 0;
+
+    for (NodeId root = 0; root < n; ++root) {
+        if (index[root] != UNVISITED) continue;
+
+        index[root] = low[root] = next_index++;
+        scc_stack.push_back(root);
+        on_stack[root] = 1;
+        call_stack.emplace_back(root, offsets[root]);
+
+        while (!call_stack.empty()) {
+            auto& [v, cursor] = call_stack.back();
+
+            if (cursor < offsets[v + 1]) {
+                NodeId w = edges[cursor++];
+                if (index[w] == UNVISITED) {
+                    index[w] = low[w] = next_index++;
+                    scc_stack.push_back(w);
+                    on_stack[w] = 1;
+                    call_stack.emplace_back(w, offsets[w]);
+                } else if (on_stack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            // v 的所有边处理完毕
+            NodeId finished = v;
+            call_stack.pop_back();
+
+            if (low[finished] == index[finished]) {
+                NodeId member;
+                do {
+                    member = scc_stack.back();
+                    scc_stack.pop_back();
+                    on_stack[member] = 0;
+                    component_[member] = next_component;
+                } while (member != finished);
+                ++next_component;
+            }
+
+            if (!call_stack.empty()) {
+                NodeId parent = call_stack.back().first;
+                low[parent] = std::min(low[parent], low[finished]);
+            }
+        }
+    }
+
+    // 分量成员（计数排序，成员按节点ID升序）
+    member_offsets_.assign(next_component + 1, 0);
+    for (NodeId v = 0; v < n; ++v) {
+        member_offsets_[component_[v] + 1]++;
+    }
+    for (size_t c = 0; c < next_component; ++c) {
+        member_offsets_[c + 1] += member_offsets_[c];
+    }
+    members_.resize(n);
+    std::vector<uint32_t> fill(member_offsets_.begin(), member_offsets_.end() - 1);
+    for (NodeId v = 0; v < n; ++v) {
+        members_[fill[component_[v]]++] = v;
+    }
+
+    cyclic_.assign(next_component, 0);
+    for (ComponentId c = 0; c < next_component; ++c) {
+        if (member_offsets_[c + 1] - member_offsets_[c] > 1) {
+            cyclic_[c] = 1;
+        }
+    }
+    for (NodeId v = 0; v < n; ++v) {
+        for (NodeId w : graph_.dependencies(v)) {
+            if (w == v) {
+                cyclic_[component_[v]] = 1;
+            }
+        }
+    }
+}
+
+void GraphCondensation::build_dag() {
+    const size_t c = component_count();
+
+    std::vector<std::pair<ComponentId, ComponentId>> dag_edges;
+    for (NodeId v = 0; v < graph_.node_count(); ++v) {
+        for (NodeId w : graph_.dependencies(v)) {
+            if (component_[v] != component_[w]) {
+                dag_edges.emplace_back(component_[v], component_[w]);
+            }
+        }
+    }
+    std::sort(dag_edges.begin(), dag_edges.end());
+    dag_edges.erase(std::unique(dag_edges.begin(), dag_edges.end()), dag_edges.end());
+
+    dag_out_offsets_.assign(c + 1, 0);
+    dag_in_offsets_.assign(c + 1, 0);
+    dag_out_edges_.reserve(dag_edges.size());
+    for (const auto& [from, to] : dag_edges) {
+        dag_out_offsets_[from + 1]++;
+        dag_in_offsets_[to + 1]++;
+        dag_out_edges_.push_back(to);
+    }
+    for (size_t i = 0; i < c; ++i) {
+        dag_out_offsets_[i + 1] += dag_out_offsets_[i];
+        dag_in_offsets_[i + 1] += dag_in_offsets_[i];
+    }
+    dag_in_edges_.resize(dag_edges.size());
+    std::vector<uint32_t> fill(dag_in_offsets_.begin(), dag_in_offsets_.end() - 1);
+    for (const auto& [from, to] : dag_edges) {
+        dag_in_edges_[fill[to]++] = from;
+    }
+}
+
+std::vector<GraphCondensation::ComponentId> GraphCondensation::cyclic_components() const {
+    std::vector<ComponentId> result;
+    for (ComponentId c = 0; c < component_count(); ++c) {
+        if (cyclic_[c]) {
+            result.push_back(c);
+        }
+    }
+    // 按分量中最小节点ID排序，保证输出顺序稳定
+    std::sort(result.begin(), result.end(), [this](ComponentId a, ComponentId b) {
+        return members(a)[0] < members(b)[0];
+    });
+    return result;
+}
+
+bool GraphCondensation::has_cycles() const {
+    return std::find(cyclic_.begin(), cyclic_.end(), 1) != cyclic_.end();
+}
+
+std::vector<GraphCondensation::NodeId> GraphCondensation::representative_cycle(ComponentId comp) const {
+    std::vector<NodeId> cycle;
+    if (comp >= component_count() || !cyclic_[comp]) {
+        return cycle;
+    }
+
+    NodeId start = members(comp)[0];
+
+    // 分量内 BFS，找到回到 start 的最短环
+    // BFS 的临时节点频繁分配释放，交给 slab 分配器
+    std::pmr::unordered_map<NodeId, NodeId> parent(get_slab_memory_resource());
+    parent.reserve(members(comp).size());
+    std::queue<NodeId, std::pmr::deque<NodeId>> q{std::pmr::deque<NodeId>(get_slab_memory_resource())};
+    q.push(start);
+    parent[start] = start;
+
+    NodeId last = CSRDependencyGraph::INVALID_NODE;
+    while (!q.empty() && last == CSRDependencyGraph::INVALID_NODE) {
+        NodeId v = q.front();
+        q.pop();
+        for (NodeId w : graph_.dependencies(v)) {
+            if (component_[w] != comp) continue;
+            if (w == start) {
+                last = v;
+                break;
+            }
+            if (parent.emplace(w, v).second) {
+                q.push(w);
+            }
+        }
+    }
+
+    if (last == CSRDependencyGraph::INVALID_NODE) {
+        return cycle;
+    }
+
+    for (NodeId v = last; v != start; v = parent[v]) {
+        cycle.push_back(v);
+    }
+    cycle.push_back(start);
+    std::reverse(cycle.begin(), cycle.end());
+    cycle.push_back(start);
+    return cycle;
+}
+
+bool GraphCondensation::reaches(NodeId from, NodeId to) const {
+    if (from >= graph_.node_count() || to >= graph_.node_count()) {
+        return false;
+    }
+
+    ComponentId source = component_[from];
+    ComponentId target = component_[to];
+    if (source == target) {
+        return from != to || cyclic_[source];
+    }
+    // 依赖方向上分量编号严格递减
+    if (target > source) {
+        return false;
+    }
+
+    std::vector<uint8_t> visited(source - target + 1, 0);
+    std::vector<ComponentId> stack{source};
+    visited[source - target] = 1;
+    while (!stack.empty()) {
+        ComponentId c = stack.back();
+        stack.pop_back();
+        for (ComponentId next : component_dependencies(c)) {
+            if (next == target) return true;
+            if (next < target || visited[next - target]) continue;
+            visited[next - target] = 1;
+            stack.push_back(next);
+        }
+    }
+    return false;
+}
+
+std::vector<GraphCondensation::NodeId> GraphCondensation::transitive_dependencies(NodeId node) const {
+    return collect(node, true);
+}
+
+std::vector<GraphCondensation::NodeId> GraphCondensation::transitive_dependents(NodeId node) const {
+    return collect(node, false);
+}
+
+std::vector<GraphCondensation::NodeId> GraphCondensation::collect(NodeId node, bool forward) const {
+    std::vector<NodeId> result;
+    if (node >= graph_.node_count()) {
+        return result;
+    }
+
+    ComponentId start = component_[node];
+    std::vector<uint8_t> visited(component_count(), 0);
+    std::vector<ComponentId> order{start};
+    visited[start] = 1;
+    for (size_t head = 0; head < order.size(); ++head) {
+        auto next_range = forward ? component_dependencies(order[head]) : component_dependents(order[head]);
+        for (ComponentId next : next_range) {
+            if (!visited[next]) {
+                visited[next] = 1;
+                order.push_back(next);
+            }
+        }
+    }
+
+    for (ComponentId c : order) {
+        for (NodeId member : members(c)) {
+            if (member != node) {
+                result.push_back(member);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<CSRDependencyGraph::NodeId>> k_shortest_paths(
+    const CSRDependencyGraph& graph,
+    const std::vector<CSRDependencyGraph::NodeId>& sources,
+    CSRDependencyGraph::NodeId target,
+    size_t k,
+    size_t max_expansions) {
+    using NodeId = CSRDependencyGraph::NodeId;
+    std::vector<std::vector<NodeId>> paths;
+    const size_t n = graph.node_count();
+    if (target >= n || k == 0 || sources.empty()) {
+        return paths;
+    }
+
+    // 正向多源 BFS：dist[v] = 从任一源到 v 的最短距离
+    std::vector<uint32_t> dist(n, UNVISITED);
+    std::vector<NodeId> frontier;
+    for (NodeId s : sources) {
+        if (s < n && dist[s] == UNVISITED) {
+            dist[s] = 0;
+            frontier.push_back(s);
+        }
+    }
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        NodeId v = frontier[head];
+        for (NodeId w : graph.dependencies(v)) {
+            if (dist[w] == UNVISITED) {
+                dist[w] = dist[v] + 1;
+                frontier.push_back(w);
+            }
+        }
+    }
+    if (dist[target] == UNVISITED) {
+        return paths;
+    }
+
+    // 反向 A*：部分路径以父指针树存储，parent 指向更靠近 target 的一端
+    struct Entry {
+        NodeId node;
+        uint32_t parent;
+        uint32_t length;
+    };
+    std::vector<Entry> entries;
+    entries.push_back({target, UNVISITED, 0});
+
+    // (f = g + h, 距离源的剩余长度, 序号, entry)
+    // f 相同时优先扩展更深的部分路径，否则等长路径很多时会退化为逐层展开；序号保证结果稳定
+    using QueueItem = std::tuple<uint32_t, uint32_t, uint64_t, uint32_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> open;
+    uint64_t sequence = 0;
+    open.emplace(dist[target], dist[target], sequence++, 0);
+
+    size_t expansions = 0;
+    while (!open.empty() && paths.size() < k && expansions < max_expansions) {
+        uint32_t entry_index = std::get<3>(open.top());
+        open.pop();
+        const Entry current = entries[entry_index];
+
+        if (dist[current.node] == 0) {
+            std::vector<NodeId> path;
+            for (uint32_t e = entry_index; e != UNVISITED; e = entries[e].parent) {
+                path.push_back(entries[e].node);
+            }
+            paths.push_back(std::move(path));
+            continue;
+        }
+
+        ++expansions;
+        for (NodeId prev : graph.dependents(current.node)) {
+            if (dist[prev] == UNVISITED) continue;
+
+            // 保持简单路径
+            bool on_path = false;
+            for (uint32_t e = entry_index; e != UNVISITED; e = entries[e].parent) {
+                if (entries[e].node == prev) {
+                    on_path = true;
+                    break;
+                }
+            }
+            if (on_path) continue;
+
+            entries.push_back({prev, entry_index, current.length + 1});
+            open.emplace(current.length + 1 + dist[prev], dist[prev], sequence++,
+                         static_cast<uint32_t>(entries.size() - 1));
+        }
+    }
+
+    return paths;
+}
+
+} // namespace Paker
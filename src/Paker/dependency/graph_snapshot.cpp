@@ -0,0 +1,676 @@
+#include "Paker/dependency/graph_snapshot.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <tuple>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <glog/logging.h>
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+constexpr char SNAPSHOT_MAGIC[8] = {'P', 'A', 'K', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t ENDIAN_TAG = 0x01020304;
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+// 写入唯一的临时文件并 fsync 后再 rename，并发写入互不覆盖，崩溃也不会留下半截快照
+bool write_file_durably(const fs::path& target, const std::vector<char>& buffer) {
+    std::string temp_path = (target.parent_path() / (target.filename().string() + ".XXXXXX")).string();
+    int fd = ::mkstemp(temp_path.data());
+    if (fd < 0) {
+        LOG(ERROR) << "Cannot create temporary snapshot file for " << target << ": " << std::strerror(errno);
+        return false;
+    }
+    size_t offset = 0;
+    bool ok = true;
+    while (offset < buffer.size()) {
+        ssize_t written = ::write(fd, buffer.data() + offset, buffer.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    ok = ok && ::fchmod(fd, 0644) == 0 && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(temp_path.c_str(), target.c_str()) != 0) {
+        LOG(ERROR) << "Failed to write snapshot file " << target << ": " << std::strerror(errno);
+        ::unlink(temp_path.c_str());
+        return false;
+    }
+
+    // 持久化目录项，确保 rename 本身落盘
+    int dir_fd = ::open(target.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+// 字符串池引用，length 为 0 表示空串
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+}
+
+struct GraphSnapshot::Header {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t endian_tag;
+    uint64_t fingerprint;
+    uint32_t node_count;
+    uint32_t edge_count;
+    uint32_t hash_capacity;
+    uint32_t flags;
+    uint64_t string_pool_offset;
+    uint64_t string_pool_size;
+    uint64_t node_table_offset;
+    uint64_t out_offsets_offset;
+    uint64_t out_edges_offset;
+    uint64_t in_offsets_offset;
+    uint64_t in_edges_offset;
+    uint64_t constraints_offset;
+    uint64_t declared_offsets_offset;
+    uint64_t declared_offset;
+    uint32_t declared_count;
+    uint32_t reserved;
+    uint64_t hash_table_offset;
+    uint64_t file_size;
+    uint32_t payload_crc;
+    uint32_t header_crc;    // 覆盖此字段之前的全部头部字节，必须位于末尾
+};
+
+struct GraphSnapshot::NodeRecord {
+    StringRef name;
+    StringRef version;
+    StringRef repository;
+    StringRef install_path;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct GraphSnapshot::DeclaredRecord {
+    StringRef name;
+    StringRef constraint;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+namespace {
+
+using Header = GraphSnapshot::Header;
+using NodeRecord = GraphSnapshot::NodeRecord;
+using DeclaredRecord = GraphSnapshot::DeclaredRecord;
+
+static_assert(sizeof(Header) % SECTION_ALIGNMENT == 0, "snapshot header must keep sections aligned");
+static_assert(offsetof(Header, header_crc) + sizeof(uint32_t) == sizeof(Header), "header_crc must be last");
+
+constexpr uint32_t NODE_INSTALLED = 1;
+constexpr uint32_t DECLARED_LISTED = 1;
+constexpr uint32_t DECLARED_CONSTRAINED = 2;
+
+uint32_t crc32_of(const char* data, size_t size) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    // zlib 的长度参数为 uInt，大文件分块计算
+    while (size > 0) {
+        uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+uint64_t hash_name(std::string_view name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 快照构建器：两种图类型先转换为统一的节点/边列表
+class SnapshotBuilder {
+public:
+    struct Node {
+        std::string_view name;
+        std::string_view version;
+        std::string_view repository;
+        std::string_view install_path;
+        bool installed;
+    };
+
+    void reserve(size_t nodes, size_t edges) {
+        nodes_.reserve(nodes);
+        edges_.reserve(edges);
+    }
+
+    uint32_t add_node(const Node& node) {
+        NodeRecord record{};
+        record.name = intern(node.name);
+        record.version = intern(node.version);
+        record.repository = intern(node.repository);
+        record.install_path = intern(node.install_path);
+        record.flags = node.installed ? NODE_INSTALLED : 0;
+        nodes_.push_back(record);
+        names_.push_back(node.name);
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void add_edge(uint32_t from, uint32_t to, std::string_view constraint = {}) {
+        edges_.emplace_back(from, to, intern(constraint));
+    }
+
+    // 同一节点的声明依赖须连续、按名称升序加入
+    void add_declared(uint32_t node, std::string_view name, bool listed, const std::string* constraint) {
+        DeclaredRecord record{};
+        record.name = intern(name);
+        record.constraint = constraint ? intern(*constraint) : StringRef{0, 0};
+        record.flags = (listed ? DECLARED_LISTED : 0) | (constraint ? DECLARED_CONSTRAINED : 0);
+        declared_.emplace_back(node, record);
+    }
+
+    bool write(const std::string& path, uint64_t fingerprint);
+
+private:
+    StringRef intern(std::string_view value) {
+        if (value.empty()) {
+            return StringRef{0, 0};
+        }
+        auto it = pool_index_.find(std::string(value));
+        if (it != pool_index_.end()) {
+            return it->second;
+        }
+        StringRef ref{static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(value.size())};
+        pool_.append(value.data(), value.size());
+        pool_index_.emplace(std::string(value), ref);
+        return ref;
+    }
+
+    std::string pool_;
+    std::unordered_map<std::string, StringRef> pool_index_;
+    std::vector<NodeRecord> nodes_;
+    std::vector<std::string_view> names_;
+    std::vector<std::tuple<uint32_t, uint32_t, StringRef>> edges_;
+    std::vector<std::pair<uint32_t, DeclaredRecord>> declared_;
+};
+
+template<typename T>
+uint64_t append_section(std::vector<char>& buffer, const T* data, size_t count) {
+    buffer.resize((buffer.size() + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT, 0);
+    uint64_t offset = buffer.size();
+    const char* bytes = reinterpret_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+    return offset;
+}
+
+bool SnapshotBuilder::write(const std::string& path, uint64_t fingerprint) {
+    const uint32_t n = static_cast<uint32_t>(nodes_.size());
+
+    std::sort(edges_.begin(), edges_.end(), [](const auto& a, const auto& b) {
+        return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+    });
+    edges_.erase(std::unique(edges_.begin(), edges_.end(), [](const auto& a, const auto& b) {
+        return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+    }), edges_.end());
+    const uint32_t e = static_cast<uint32_t>(edges_.size());
+
+    // 出边 CSR 与逐边约束
+    std::vector<uint32_t> out_offsets(n + 1, 0);
+    std::vector<uint32_t> out_edges(e);
+    std::vector<StringRef> constraints(e);
+    std::vector<uint32_t> in_offsets(n + 1, 0);
+    for (uint32_t i = 0; i < e; ++i) {
+        const auto& [from, to, constraint] = edges_[i];
+        out_offsets[from + 1]++;
+        in_offsets[to + 1]++;
+        out_edges[i] = to;
+        constraints[i] = constraint;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        out_offsets[i + 1] += out_offsets[i];
+        in_offsets[i + 1] += in_offsets[i];
+    }
+
+    // 入边 CSR：按来源顺序填充，来源已有序
+    std::vector<uint32_t> in_edges(e);
+    std::vector<uint32_t> fill(in_offsets.begin(), in_offsets.end() - 1);
+    for (const auto& [from, to, _] : edges_) {
+        in_edges[fill[to]++] = from;
+    }
+
+    // 声明依赖按节点分段
+    std::stable_sort(declared_.begin(), declared_.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<uint32_t> declared_offsets(n + 1, 0);
+    std::vector<DeclaredRecord> declared(declared_.size());
+    for (size_t i = 0; i < declared_.size(); ++i) {
+        declared_offsets[declared_[i].first + 1]++;
+        declared[i] = declared_[i].second;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        declared_offsets[i + 1] += declared_offsets[i];
+    }
+
+    // 名称哈希表：容量为不小于 2n 的 2 的幂，线性探测
+    uint32_t capacity = 1;
+    while (capacity < 2 * std::max<uint32_t>(n, 1)) {
+        capacity <<= 1;
+    }
+    std::vector<uint32_t> hash_table(capacity, GraphSnapshot::INVALID_NODE);
+    for (uint32_t id = 0; id < n; ++id) {
+        uint32_t slot = static_cast<uint32_t>(hash_name(names_[id]) & (capacity - 1));
+        while (hash_table[slot] != GraphSnapshot::INVALID_NODE) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        hash_table[slot] = id;
+    }
+
+    std::vector<char> buffer(sizeof(Header), 0);
+    Header header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.format_version = GraphSnapshot::FORMAT_VERSION;
+    header.endian_tag = ENDIAN_TAG;
+    header.fingerprint = fingerprint;
+    header.node_count = n;
+    header.edge_count = e;
+    header.hash_capacity = capacity;
+    header.string_pool_offset = append_section(buffer, pool_.data(), pool_.size());
+    header.string_pool_size = pool_.size();
+    header.node_table_offset = append_section(buffer, nodes_.data(), nodes_.size());
+    header.out_offsets_offset = append_section(buffer, out_offsets.data(), out_offsets.size());
+    header.out_edges_offset = append_section(buffer, out_edges.data(), out_edges.size());
+    header.in_offsets_offset = append_section(buffer, in_offsets.data(), in_offsets.size());
+    header.in_edges_offset = append_section(buffer, in_edges.data(), in_edges.size());
+    header.constraints_offset = append_section(buffer, constraints.data(), constraints.size());
+    header.declared_offsets_offset = append_section(buffer, declared_offsets.data(), declared_offsets.size());
+    header.declared_offset = append_section(buffer, declared.data(), declared.size());
+    header.declared_count = static_cast<uint32_t>(declared.size());
+    header.hash_table_offset = append_section(buffer, hash_table.data(), hash_table.size());
+    header.file_size = buffer.size();
+    header.payload_crc = crc32_of(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    header.header_crc = crc32_of(reinterpret_cast<const char*>(&header), offsetof(Header, header_crc));
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+
+    try {
+        fs::path target = fs::absolute(path);
+        fs::create_directories(target.parent_path());
+        if (!write_file_durably(target, buffer)) {
+            return false;
+        }
+    } catch (const std::exception& ex) {
+        LOG(ERROR) << "Failed to save graph snapshot: " << ex.what();
+        return false;
+    }
+
+    LOG(INFO) << "Saved graph snapshot to " << path << " (" << n << " nodes, " << e
+              << " edges, " << buffer.size() << " bytes)";
+    return true;
+}
+
+} // namespace
+
+GraphSnapshot::~GraphSnapshot() {
+    close();
+}
+
+GraphSnapshot::GraphSnapshot(GraphSnapshot&& other) noexcept
+    : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+GraphSnapshot& GraphSnapshot::operator=(GraphSnapshot&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+bool GraphSnapshot::open(const std::string& path, bool verify_checksum) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        LOG(WARNING) << "Invalid graph snapshot: " << path;
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG(ERROR) << "Failed to memory map graph snapshot: " << path;
+        return false;
+    }
+
+    data_ = static_cast<const char*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+    if (!validate(verify_checksum)) {
+        LOG(WARNING) << "Rejected corrupted or incompatible graph snapshot: " << path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GraphSnapshot::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+bool GraphSnapshot::validate(bool verify_checksum) const {
+    const Header& h = header();
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        h.format_version != FORMAT_VERSION || h.endian_tag != ENDIAN_TAG) {
+        return false;
+    }
+    if (h.header_crc != crc32_of(data_, offsetof(Header, header_crc)) || h.file_size != size_) {
+        return false;
+    }
+
+    const uint64_t n = h.node_count;
+    const uint64_t e = h.edge_count;
+    auto section_fits = [this](uint64_t offset, uint64_t bytes) {
+        return offset % SECTION_ALIGNMENT == 0 && offset >= sizeof(Header) &&
+               offset <= size_ && bytes <= size_ - offset;
+    };
+    if (!section_fits(h.string_pool_offset, h.string_pool_size) ||
+        !section_fits(h.node_table_offset, n * sizeof(NodeRecord)) ||
+        !section_fits(h.out_offsets_offset, (n + 1) * sizeof(uint32_t)) ||
+        !section_fits(h.out_edges_offset, e * sizeof(uint32_t)) ||
+        !section_fits(h.in_offsets_offset, (n + 1) * sizeof(uint32_t)) ||
+        !section_fits(h.in_edges_offset, e * sizeof(uint32_t)) ||
+        !section_fits(h.constraints_offset, e * sizeof(StringRef)) ||
+        !section_fits(h.declared_offsets_offset, (n + 1) * sizeof(uint32_t)) ||
+        !section_fits(h.declared_offset, uint64_t(h.declared_count) * sizeof(DeclaredRecord)) ||
+        !section_fits(h.hash_table_offset, uint64_t(h.hash_capacity) * sizeof(uint32_t))) {
+        return false;
+    }
+    if (h.hash_capacity == 0 || (h.hash_capacity & (h.hash_capacity - 1)) != 0 || h.hash_capacity <= n) {
+        return false;
+    }
+
+    if (verify_checksum &&
+        h.payload_crc != crc32_of(data_ + sizeof(Header), size_ - sizeof(Header))) {
+        return false;
+    }
+
+    // 结构检查 O(V+E)，保证访问器不会越界
+    auto ref_valid = [&h](const StringRef& ref) {
+        return uint64_t(ref.offset) + ref.length <= h.string_pool_size;
+    };
+    const auto* records = section<NodeRecord>(h.node_table_offset);
+    for (uint64_t i = 0; i < n; ++i) {
+        const auto& r = records[i];
+        if (!ref_valid(r.name) || !ref_valid(r.version) || !ref_valid(r.repository) || !ref_valid(r.install_path)) {
+            return false;
+        }
+    }
+    for (uint64_t csr : {h.out_offsets_offset, h.in_offsets_offset}) {
+        const auto* offsets = section<uint32_t>(csr);
+        if (offsets[0] != 0 || offsets[n] != e) {
+            return false;
+        }
+        for (uint64_t i = 0; i < n; ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+    }
+    for (uint64_t edges : {h.out_edges_offset, h.in_edges_offset}) {
+        const auto* targets = section<uint32_t>(edges);
+        for (uint64_t i = 0; i < e; ++i) {
+            if (targets[i] >= n) {
+                return false;
+            }
+        }
+    }
+    const auto* constraints = section<StringRef>(h.constraints_offset);
+    for (uint64_t i = 0; i < e; ++i) {
+        if (!ref_valid(constraints[i])) {
+            return false;
+        }
+    }
+    const auto* declared_offsets = section<uint32_t>(h.declared_offsets_offset);
+    if (declared_offsets[0] != 0 || declared_offsets[n] != h.declared_count) {
+        return false;
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        if (declared_offsets[i] > declared_offsets[i + 1]) {
+            return false;
+        }
+    }
+    const auto* declared = section<DeclaredRecord>(h.declared_offset);
+    for (uint64_t i = 0; i < h.declared_count; ++i) {
+        if (!ref_valid(declared[i].name) || !ref_valid(declared[i].constraint)) {
+            return false;
+        }
+    }
+    const auto* table = section<uint32_t>(h.hash_table_offset);
+    for (uint64_t i = 0; i < h.hash_capacity; ++i) {
+        if (table[i] != INVALID_NODE && table[i] >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const GraphSnapshot::Header& GraphSnapshot::header() const {
+    return *reinterpret_cast<const Header*>(data_);
+}
+
+const GraphSnapshot::NodeRecord& GraphSnapshot::record(NodeId id) const {
+    return section<NodeRecord>(header().node_table_offset)[id];
+}
+
+std::string_view GraphSnapshot::pool_string(uint32_t offset, uint32_t length) const {
+    if (length == 0) {
+        return {};
+    }
+    return std::string_view(data_ + header().string_pool_offset + offset, length);
+}
+
+uint64_t GraphSnapshot::fingerprint() const {
+    return is_open() ? header().fingerprint : 0;
+}
+
+size_t GraphSnapshot::node_count() const {
+    return is_open() ? header().node_count : 0;
+}
+
+size_t GraphSnapshot::edge_count() const {
+    return is_open() ? header().edge_count : 0;
+}
+
+GraphSnapshot::NodeId GraphSnapshot::find(std::string_view name) const {
+    if (!is_open() || header().node_count == 0) {
+        return INVALID_NODE;
+    }
+
+    // 最多探测整张表一次：校验只保证表中的 ID 合法，不保证留有空槽
+    const uint32_t capacity = header().hash_capacity;
+    const uint32_t mask = capacity - 1;
+    const auto* table = section<uint32_t>(header().hash_table_offset);
+    uint32_t slot = static_cast<uint32_t>(hash_name(name) & mask);
+    for (uint32_t probes = 0; probes < capacity; ++probes, slot = (slot + 1) & mask) {
+        NodeId id = table[slot];
+        if (id == INVALID_NODE) {
+            return INVALID_NODE;
+        }
+        if (this->name(id) == name) {
+            return id;
+        }
+    }
+    return INVALID_NODE;
+}
+
+std::string_view GraphSnapshot::name(NodeId id) const {
+    if (id >= node_count()) return {};
+    return pool_string(record(id).name.offset, record(id).name.length);
+}
+
+std::string_view GraphSnapshot::version(NodeId id) const {
+    if (id >= node_count()) return {};
+    return pool_string(record(id).version.offset, record(id).version.length);
+}
+
+std::string_view GraphSnapshot::repository(NodeId id) const {
+    if (id >= node_count()) return {};
+    return pool_string(record(id).repository.offset, record(id).repository.length);
+}
+
+std::string_view GraphSnapshot::install_path(NodeId id) const {
+    if (id >= node_count()) return {};
+    return pool_string(record(id).install_path.offset, record(id).install_path.length);
+}
+
+bool GraphSnapshot::is_installed(NodeId id) const {
+    return id < node_count() && (record(id).flags & NODE_INSTALLED) != 0;
+}
+
+CSRDependencyGraph::EdgeRange GraphSnapshot::dependencies(NodeId id) const {
+    if (id >= node_count()) return CSRDependencyGraph::EdgeRange(nullptr, nullptr);
+    const auto* offsets = section<uint32_t>(header().out_offsets_offset);
+    const auto* edges = section<uint32_t>(header().out_edges_offset);
+    return CSRDependencyGraph::EdgeRange(edges + offsets[id], edges + offsets[id + 1]);
+}
+
+CSRDependencyGraph::EdgeRange GraphSnapshot::dependents(NodeId id) const {
+    if (id >= node_count()) return CSRDependencyGraph::EdgeRange(nullptr, nullptr);
+    const auto* offsets = section<uint32_t>(header().in_offsets_offset);
+    const auto* edges = section<uint32_t>(header().in_edges_offset);
+    return CSRDependencyGraph::EdgeRange(edges + offsets[id], edges + offsets[id + 1]);
+}
+
+std::string_view GraphSnapshot::constraint(NodeId id, size_t index) const {
+    if (id >= node_count()) return {};
+    const auto* offsets = section<uint32_t>(header().out_offsets_offset);
+    if (offsets[id] + index >= offsets[id + 1]) return {};
+    const auto& ref = section<StringRef>(header().constraints_offset)[offsets[id] + index];
+    return pool_string(ref.offset, ref.length);
+}
+
+size_t GraphSnapshot::declared_count(NodeId id) const {
+    if (id >= node_count()) return 0;
+    const auto* offsets = section<uint32_t>(header().declared_offsets_offset);
+    return offsets[id + 1] - offsets[id];
+}
+
+GraphSnapshot::DeclaredDependency GraphSnapshot::declared(NodeId id, size_t index) const {
+    if (index >= declared_count(id)) return {};
+    const auto* offsets = section<uint32_t>(header().declared_offsets_offset);
+    const auto& record = section<DeclaredRecord>(header().declared_offset)[offsets[id] + index];
+    DeclaredDependency dependency;
+    dependency.name = pool_string(record.name.offset, record.name.length);
+    dependency.constraint = pool_string(record.constraint.offset, record.constraint.length);
+    dependency.listed = (record.flags & DECLARED_LISTED) != 0;
+    dependency.has_constraint = (record.flags & DECLARED_CONSTRAINED) != 0;
+    return dependency;
+}
+
+bool GraphSnapshot::write(const DependencyGraph& graph, const std::string& path, uint64_t fingerprint) {
+    SnapshotBuilder builder;
+    const auto& nodes = graph.get_nodes();
+
+    // 节点ID按名称顺序分配，与 CSRDependencyGraph::from_graph 一致
+    std::unordered_map<std::string_view, uint32_t> ids;
+    ids.reserve(nodes.size());
+    builder.reserve(nodes.size(), 0);
+    for (const auto& [name, node] : nodes) {
+        ids.emplace(name, builder.add_node({name, node.version, node.repository, node.install_path, node.is_installed}));
+    }
+
+    for (const auto& [name, deps] : graph.get_adjacency_list()) {
+        auto from = ids.find(name);
+        if (from == ids.end()) continue;
+        const auto& constraints = nodes.at(name).version_constraints;
+        for (const auto& dep : deps) {
+            auto to = ids.find(dep);
+            if (to == ids.end()) continue;
+            auto constraint_it = constraints.find(dep);
+            if (constraint_it != constraints.end()) {
+                builder.add_edge(from->second, to->second, constraint_it->second.to_string());
+            } else {
+                builder.add_edge(from->second, to->second);
+            }
+        }
+    }
+
+    // 声明依赖与约束不一定对应图中的边（依赖未解析、或只有约束），逐项写出，加载时原样还原
+    for (const auto& [name, node] : nodes) {
+        uint32_t id = ids.at(name);
+        auto dep = node.dependencies.begin();
+        auto constraint = node.version_constraints.begin();
+        while (dep != node.dependencies.end() || constraint != node.version_constraints.end()) {
+            bool take_dep = dep != node.dependencies.end() &&
+                            (constraint == node.version_constraints.end() || *dep <= constraint->first);
+            bool take_constraint = constraint != node.version_constraints.end() &&
+                                   (dep == node.dependencies.end() || constraint->first <= *dep);
+            const std::string& dep_name = take_dep ? *dep : constraint->first;
+            std::string constraint_text = take_constraint ? constraint->second.to_string() : std::string();
+            builder.add_declared(id, dep_name, take_dep, take_constraint ? &constraint_text : nullptr);
+            if (take_dep) ++dep;
+            if (take_constraint) ++constraint;
+        }
+    }
+
+    return builder.write(path, fingerprint);
+}
+
+bool GraphSnapshot::write(const OptimizedDependencyGraph& graph, const std::string& path, uint64_t fingerprint) {
+    SnapshotBuilder builder;
+    const size_t n = graph.get_node_count();
+    builder.reserve(n, graph.get_edge_count());
+
+    // 节点ID与 OptimizedDependencyGraph 的索引一致
+    for (size_t i = 0; i < n; ++i) {
+        const auto* node = graph.get_node_by_index(i);
+        builder.add_node({node->name, node->version, node->repository, node->install_path, node->is_installed});
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t dep_index : graph.get_node_by_index(i)->dependency_indices) {
+            if (dep_index < n) {
+                builder.add_edge(static_cast<uint32_t>(i), static_cast<uint32_t>(dep_index));
+            }
+        }
+    }
+
+    return builder.write(path, fingerprint);
+}
+
+bool GraphSnapshot::is_snapshot_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+} // namespace Paker
@@ -2,7 +2,8 @@
 #include "Paker/core/utils.h"
 #include "Paker/core/package_manager.h"
 #include "Paker/dependency/sources.h"
-#include "Paker/simd/simd_hash.h"
+#include "Paker/core/content_hash.h"
+#include "Paker/core/command_arena.h"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -18,12 +19,33 @@ namespace fs = std::filesystem;
 
 namespace Paker {
 
+namespace {
+
+// 查询路径只查找已驻留的键，避免未命中的键进入驻留表
+std::optional<Symbol> find_symbol(std::string_view text) {
+    return StringInterner::instance().find(text);
+}
+
+// 缓存与解析接口以 std::string 为参数；arena 上的名字复制进调用方复用的缓冲区，
+// 缓冲区扩容后不再分配，不必为每个名字在堆上构造一个 std::string
+const std::string& as_std_string(const std::string& name, std::string&) {
+    return name;
+}
+
+const std::string& as_std_string(const std::pmr::string& name, std::string& buffer) {
+    buffer.assign(name.data(), name.size());
+    return buffer;
+}
+
+} // namespace
+
 // 全局实例
 std::unique_ptr<IncrementalParser> g_incremental_parser = nullptr;
 
 IncrementalParser::IncrementalParser(const std::string& cache_directory)
-    : cache_file_path_(cache_directory + "/parse_cache.json"), 
+    : cache_file_path_((fs::absolute(cache_directory) / "parse_cache.json").string()),
       active_tasks_(0) {
+    // 缓存路径在构造时固定为绝对路径：守护进程切换工作目录后仍写回加载它的工程
     // 注意：不在构造函数中初始化 resolver_，避免循环依赖
     // resolver_ 将在首次使用时延迟初始化
 }
@@ -56,6 +78,11 @@ bool IncrementalParser::initialize() {
         }
     }
     
+    // 监视失败不影响初始化，变更检测会退回全量扫描
+    if (config_.enable_watch_mode) {
+        enable_watch_mode();
+    }
+    
     LOG(INFO) << "Incremental parser initialized successfully";
     return true;
 }
@@ -66,6 +93,8 @@ void IncrementalParser::shutdown() {
     // 等待所有并行任务完成
     wait_for_parallel_tasks();
     
+    disable_watch_mode();
+    
     // 保存缓存
     if (config_.enable_caching) {
         save_cache_to_disk();
@@ -75,7 +104,15 @@ void IncrementalParser::shutdown() {
 }
 
 void IncrementalParser::set_config(const ParseConfig& config) {
+    bool watch_changed = config.enable_watch_mode != config_.enable_watch_mode;
     config_ = config;
+    if (watch_changed) {
+        if (config_.enable_watch_mode) {
+            enable_watch_mode();
+        } else {
+            disable_watch_mode();
+        }
+    }
     LOG(INFO) << "Parse configuration updated";
 }
 
@@ -118,8 +155,9 @@ bool IncrementalParser::parse_package(const std::string& package, const std::str
         // 更新缓存
         std::lock_guard<std::mutex> lock(cache_mutex_);
         ParseCacheEntry entry;
-        entry.package_name = package;
-        entry.version = version;
+        Symbol package_symbol(package);
+        entry.package_name = package_symbol;
+        entry.version = Symbol(version);
         entry.hash = calculate_package_hash(package, version);
         entry.last_parsed = std::chrono::system_clock::now();
         entry.last_accessed = entry.last_parsed;
@@ -130,11 +168,14 @@ bool IncrementalParser::parse_package(const std::string& package, const std::str
         const auto& graph = resolver_->get_dependency_graph();
         if (graph.has_node(package)) {
             const auto& node = graph.get_node(package);
-            // 将 set 转换为 vector
-            entry.dependencies.assign(node->dependencies.begin(), node->dependencies.end());
+            entry.dependencies.reserve(node->dependencies.size());
+            for (const auto& dep : node->dependencies) {
+                entry.dependencies.emplace_back(dep);
+            }
         }
         
-        parse_cache_[cache_key] = entry;
+        parse_cache_[cache_key] = std::move(entry);
+        cache_keys_by_name_[package_symbol] = cache_key;
         
         // 检查缓存大小限制
         if (parse_cache_.size() > config_.max_cache_size) {
@@ -159,12 +200,24 @@ bool IncrementalParser::parse_package(const std::string& package, const std::str
 }
 
 bool IncrementalParser::parse_packages(const std::vector<std::string>& packages) {
+    return parse_package_list(packages);
+}
+
+bool IncrementalParser::parse_packages(const ScratchPackageList& packages) {
+    return parse_package_list(packages);
+}
+
+template <typename PackageList>
+bool IncrementalParser::parse_package_list(const PackageList& packages) {
     LOG(INFO) << "Parsing " << packages.size() << " packages";
     
+    std::string buffer;
     if (config_.enable_parallel && packages.size() > 1) {
         // 并行解析
-        for (const auto& package : packages) {
+        for (const auto& name : packages) {
+            const std::string& package = as_std_string(name, buffer);
             if (active_tasks_.load() < config_.max_parallel_tasks) {
+                // 任务持有名字的副本，不引用 arena 或复用的缓冲区
                 parallel_tasks_.emplace_back(
                     std::async(std::launch::async, 
                               [this, package]() { parse_package_parallel(package, ""); }));
@@ -179,7 +232,8 @@ bool IncrementalParser::parse_packages(const std::vector<std::string>& packages)
         wait_for_parallel_tasks();
     } else {
         // 串行解析
-        for (const auto& package : packages) {
+        for (const auto& name : packages) {
+            const std::string& package = as_std_string(name, buffer);
             if (!parse_package(package)) {
                 LOG(WARNING) << "Failed to parse package: " << package;
             }
@@ -204,10 +258,10 @@ bool IncrementalParser::parse_project_dependencies() {
         json j;
         ifs >> j;
         
-        std::vector<std::string> packages;
+        ScratchPackageList packages(current_arena_resource());
         if (j.contains("dependencies")) {
             for (const auto& [package, version] : j["dependencies"].items()) {
-                packages.push_back(package);
+                packages.emplace_back(package);
             }
         }
         
@@ -235,13 +289,14 @@ bool IncrementalParser::incremental_parse(const std::vector<std::string>& packag
               << changes.removed_packages.size() << " removed";
     
     // 解析变更的包
-    std::vector<std::string> packages_to_parse;
-    packages_to_parse.insert(packages_to_parse.end(), 
-                           changes.changed_packages.begin(), 
-                           changes.changed_packages.end());
-    packages_to_parse.insert(packages_to_parse.end(), 
-                           changes.new_packages.begin(), 
-                           changes.new_packages.end());
+    ScratchPackageList packages_to_parse(current_arena_resource());
+    packages_to_parse.reserve(changes.changed_packages.size() + changes.new_packages.size());
+    for (const auto& package : changes.changed_packages) {
+        packages_to_parse.emplace_back(package);
+    }
+    for (const auto& package : changes.new_packages) {
+        packages_to_parse.emplace_back(package);
+    }
     
     bool success = parse_packages(packages_to_parse);
     
@@ -255,31 +310,31 @@ bool IncrementalParser::incremental_parse(const std::vector<std::string>& packag
 }
 
 ChangeDetectionResult IncrementalParser::detect_changes(const std::vector<std::string>& packages) const {
+    return detect_changes_in(packages);
+}
+
+ChangeDetectionResult IncrementalParser::detect_changes(const ScratchPackageList& packages) const {
+    return detect_changes_in(packages);
+}
+
+template <typename PackageList>
+ChangeDetectionResult IncrementalParser::detect_changes_in(const PackageList& packages) const {
     ChangeDetectionResult result;
     
     std::lock_guard<std::mutex> lock(cache_mutex_);
     
-    for (const auto& package : packages) {
-        std::string cache_key = package + "@*";  // 检查所有版本
-        
+    std::string buffer;
+    for (const auto& name : packages) {
+        const std::string& package = as_std_string(name, buffer);
         // 检查包是否在缓存中
-        bool found_in_cache = false;
-        for (const auto& [key, entry] : parse_cache_) {
-            if (entry.package_name == package) {
-                found_in_cache = true;
-                
-                // 检查是否有变更
-                if (has_package_changed(package, entry.version)) {
-                    result.changed_packages.insert(package);
-                    result.has_changes = true;
-                }
-                break;
-            }
-        }
-        
-        if (!found_in_cache) {
+        const ParseCacheEntry* entry = find_cache_entry(package);
+        if (!entry) {
             result.new_packages.insert(package);
             result.has_changes = true;
+        } else if (has_package_changed(package, entry->version.str())) {
+            // 检查是否有变更
+            result.changed_packages.insert(package);
+            result.has_changes = true;
         }
     }
     
@@ -297,8 +352,8 @@ std::string IncrementalParser::calculate_dependency_hash(const std::string& pack
             return "";
         }
         
-        // 使用SIMD优化的哈希计算
-        return SIMDHashCalculator::sha256_simd_file(manifest_path);
+        // 覆盖全部字节的标准 SHA-256，清单末尾的改动也能被发现
+        return sha256_file(manifest_path);
         
     } catch (const std::exception& e) {
         LOG(WARNING) << "Failed to calculate dependency hash: " << e.what();
@@ -330,24 +385,26 @@ void IncrementalParser::evict_old_cache_entries() {
     }
     
     // 按最后访问时间和访问次数排序
-    std::vector<std::pair<std::string, ParseCacheEntry*>> entries;
-    for (auto& [key, entry] : parse_cache_) {
-        entries.emplace_back(key, &entry);
+    // 排序用的临时列表只保存迭代器，不复制键
+    std::pmr::vector<decltype(parse_cache_)::iterator> entries(current_arena_resource());
+    entries.reserve(parse_cache_.size());
+    for (auto it = parse_cache_.begin(); it != parse_cache_.end(); ++it) {
+        entries.push_back(it);
     }
     
     std::sort(entries.begin(), entries.end(), 
               [](const auto& a, const auto& b) {
                   // 优先保留最近访问和访问次数多的条目
-                  if (a.second->last_accessed != b.second->last_accessed) {
-                      return a.second->last_accessed > b.second->last_accessed;
+                  if (a->second.last_accessed != b->second.last_accessed) {
+                      return a->second.last_accessed > b->second.last_accessed;
                   }
-                  return a.second->access_count > b.second->access_count;
+                  return a->second.access_count > b->second.access_count;
               });
     
     // 删除最旧的条目
     size_t to_remove = parse_cache_.size() - config_.max_cache_size + 10; // 多删除一些避免频繁清理
     for (size_t i = entries.size() - to_remove; i < entries.size(); ++i) {
-        parse_cache_.erase(entries[i].first);
+        parse_cache_.erase(entries[i]);
     }
     
     LOG(INFO) << "Evicted " << to_remove << " cache entries";
@@ -366,10 +423,11 @@ bool IncrementalParser::load_cache_from_disk() {
         ifs >> j;
         
         parse_cache_.clear();
+        cache_keys_by_name_.clear();
         for (const auto& [key, value] : j.items()) {
             ParseCacheEntry entry;
-            entry.package_name = value["package_name"];
-            entry.version = value["version"];
+            entry.package_name = Symbol(value["package_name"].get<std::string>());
+            entry.version = Symbol(value["version"].get<std::string>());
             entry.hash = value["hash"];
             entry.access_count = value["access_count"];
             entry.is_valid = value["is_valid"];
@@ -377,7 +435,7 @@ bool IncrementalParser::load_cache_from_disk() {
             // 解析依赖列表
             if (value.contains("dependencies")) {
                 for (const auto& dep : value["dependencies"]) {
-                    entry.dependencies.push_back(dep);
+                    entry.dependencies.emplace_back(dep.get<std::string>());
                 }
             }
             
@@ -392,7 +450,8 @@ bool IncrementalParser::load_cache_from_disk() {
                 entry.last_accessed = timestamp;
             }
             
-            parse_cache_[key] = entry;
+            cache_keys_by_name_[entry.package_name] = key;
+            parse_cache_[key] = std::move(entry);
         }
         
         auto end_time = std::chrono::high_resolution_clock::now();
@@ -420,12 +479,16 @@ bool IncrementalParser::save_cache_to_disk() const {
         json j;
         for (const auto& [key, entry] : parse_cache_) {
             json entry_json;
-            entry_json["package_name"] = entry.package_name;
-            entry_json["version"] = entry.version;
+            entry_json["package_name"] = entry.package_name.view();
+            entry_json["version"] = entry.version.view();
             entry_json["hash"] = entry.hash;
             entry_json["access_count"] = entry.access_count;
             entry_json["is_valid"] = entry.is_valid;
-            entry_json["dependencies"] = entry.dependencies;
+            json dependencies = json::array();
+            for (Symbol dep : entry.dependencies) {
+                dependencies.push_back(dep.view());
+            }
+            entry_json["dependencies"] = std::move(dependencies);
             entry_json["last_parsed"] = std::chrono::system_clock::to_time_t(entry.last_parsed);
             entry_json["last_accessed"] = std::chrono::system_clock::to_time_t(entry.last_accessed);
             
@@ -474,6 +537,180 @@ bool IncrementalParser::has_package_changed(const std::string& package, const st
     return it->second.hash != current_hash;
 }
 
+const ParseCacheEntry* IncrementalParser::find_cache_entry(const std::string& package) const {
+    // 调用方需持有 cache_mutex_；所有插入都会更新索引，索引中没有即不在缓存中
+    auto name = find_symbol(package);
+    auto key_it = name ? cache_keys_by_name_.find(*name) : cache_keys_by_name_.end();
+    if (key_it == cache_keys_by_name_.end()) {
+        return nullptr;
+    }
+    // 键可能已被淘汰或清理
+    auto it = parse_cache_.find(key_it->second);
+    if (it == parse_cache_.end() || it->second.package_name != *name) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+ChangeDetectionResult IncrementalParser::detect_project_changes() {
+    bool packages_loaded;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        packages_loaded = project_packages_loaded_;
+    }
+    if (!watcher_ || !packages_loaded) {
+        return scan_project_changes();
+    }
+    
+    WatchChanges watch = watcher_->poll_changes();
+    if (watch.manifest_changed) {
+        return scan_project_changes();
+    }
+    
+    // 只校验脏集合中的包，未变化的包不做任何 I/O
+    ChangeDetectionResult result;
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (const auto& package : watch.dirty_packages) {
+        if (project_packages_.find(package) == project_packages_.end()) {
+            continue;
+        }
+        const ParseCacheEntry* entry = find_cache_entry(package);
+        if (!entry) {
+            result.new_packages.insert(package);
+        } else if (has_package_changed(package, entry->version.str())) {
+            result.changed_packages.insert(package);
+        }
+    }
+    result.has_changes = !result.new_packages.empty() || !result.changed_packages.empty();
+    
+    if (watch.overflowed) {
+        LOG(INFO) << "Watch queue overflowed, revalidated " << watch.dirty_packages.size()
+                  << " packages by stat";
+    }
+    return result;
+}
+
+size_t IncrementalParser::apply_project_changes(const ChangeDetectionResult& changes) {
+    for (const auto& package : changes.removed_packages) {
+        invalidate_package_cache(package);
+    }
+    
+    ScratchPackageList to_parse(current_arena_resource());
+    to_parse.reserve(changes.new_packages.size() + changes.changed_packages.size());
+    for (const auto& package : changes.new_packages) {
+        to_parse.emplace_back(package);
+    }
+    for (const auto& package : changes.changed_packages) {
+        to_parse.emplace_back(package);
+    }
+    if (to_parse.empty()) {
+        return 0;
+    }
+    // 缓存条目在有效期内会直接命中，解析器也会跳过已解析的包，两者都要先清掉
+    std::string buffer;
+    for (const auto& name : to_parse) {
+        const std::string& package = as_std_string(name, buffer);
+        invalidate_package_cache(package);
+        if (resolver_) {
+            resolver_->reload_package(package);
+        }
+    }
+    if (!parse_packages(to_parse)) {
+        LOG(WARNING) << "Some changed packages failed to parse";
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.incremental_updates++;
+    }
+    return to_parse.size();
+}
+
+ChangeDetectionResult IncrementalParser::scan_project_changes() {
+    // 先清空监视器积累的事件，扫描之后的修改留给下一次检测
+    if (watcher_) {
+        watcher_->poll_changes();
+    }
+    
+    ChangeDetectionResult result;
+    ScratchPackageList packages(current_arena_resource());
+    std::string json_file = get_json_file();
+    try {
+        if (fs::exists(json_file)) {
+            std::ifstream ifs(json_file);
+            json j;
+            ifs >> j;
+            if (j.contains("dependencies")) {
+                for (const auto& [package, version] : j["dependencies"].items()) {
+                    packages.emplace_back(package);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to parse project JSON: " << e.what();
+        return result;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        project_packages_.clear();
+        for (const auto& package : packages) {
+            project_packages_.emplace(package);
+        }
+        project_packages_loaded_ = true;
+    }
+    
+    result = detect_changes(packages);
+    
+    // 缓存中存在但清单已不再依赖的包
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (const auto& [key, entry] : parse_cache_) {
+        std::string name = entry.package_name.str();
+        if (project_packages_.find(name) == project_packages_.end()) {
+            result.removed_packages.insert(std::move(name));
+            result.has_changes = true;
+        }
+    }
+    return result;
+}
+
+bool IncrementalParser::enable_watch_mode() {
+    if (watcher_ && watcher_->is_active()) {
+        return true;
+    }
+    
+    watcher_ = std::make_unique<ManifestWatcher>(".", get_json_file());
+    if (!watcher_->start()) {
+        LOG(WARNING) << "Filesystem watch unavailable, using full change detection";
+        watcher_.reset();
+        return false;
+    }
+    
+    // 监视建立前的状态未知，下一次检测需全量扫描
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    project_packages_loaded_ = false;
+    return true;
+}
+
+void IncrementalParser::disable_watch_mode() {
+    if (watcher_) {
+        watcher_->stop();
+        watcher_.reset();
+    }
+}
+
+bool IncrementalParser::is_watch_mode_active() const {
+    return watcher_ && watcher_->is_active();
+}
+
+bool IncrementalParser::wait_for_project_changes(std::chrono::milliseconds timeout) const {
+    if (is_watch_mode_active()) {
+        return watcher_->wait_for_events(timeout);
+    }
+    // 没有监视器时退化为按间隔轮询
+    std::this_thread::sleep_for(timeout);
+    return false;
+}
+
 void IncrementalParser::parse_package_parallel(const std::string& package, const std::string& version) {
     try {
         parse_package(package, version);
@@ -497,6 +734,7 @@ void IncrementalParser::wait_for_parallel_tasks() {
 void IncrementalParser::clear_cache() {
     std::lock_guard<std::mutex> lock(cache_mutex_);
     parse_cache_.clear();
+    cache_keys_by_name_.clear();
     LOG(INFO) << "Parse cache cleared";
 }
 
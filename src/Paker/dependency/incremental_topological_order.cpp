@@ -0,0 +1,273 @@
+#include "Paker/dependency/incremental_topological_order.h"
+#include "Paker/dependency/csr_dependency_graph.h"
+#include <algorithm>
+
+namespace Paker {
+
+namespace {
+constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+constexpr uint8_t MARK_FORWARD = 1;
+constexpr uint8_t MARK_BACKWARD = 2;
+}
+
+IncrementalTopologicalOrder::NodeId IncrementalTopologicalOrder::add_node() {
+    NodeId id = static_cast<NodeId>(position_.size());
+    position_.push_back(id);
+    node_at_.push_back(id);
+    out_.emplace_back();
+    in_.emplace_back();
+    mark_.push_back(0);
+    parent_.push_back(NO_PARENT);
+    return id;
+}
+
+bool IncrementalTopologicalOrder::add_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle) {
+    if (has_edge(from, to)) {
+        return true;
+    }
+    if (std::find(pending_edges_.begin(), pending_edges_.end(), std::make_pair(from, to)) != pending_edges_.end()) {
+        return false;
+    }
+
+    bool inserted = insert_edge(from, to, cycle);
+    record_insert(inserted);
+    if (!inserted) {
+        pending_edges_.emplace_back(from, to);
+    }
+    return inserted;
+}
+
+bool IncrementalTopologicalOrder::try_add_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle) {
+    if (has_edge(from, to)) {
+        return true;
+    }
+
+    bool inserted = insert_edge(from, to, cycle);
+    record_insert(inserted);
+    return inserted;
+}
+
+bool IncrementalTopologicalOrder::remove_edge(NodeId from, NodeId to) {
+    auto pending = std::find(pending_edges_.begin(), pending_edges_.end(), std::make_pair(from, to));
+    if (pending != pending_edges_.end()) {
+        pending_edges_.erase(pending);
+        return true;
+    }
+
+    if (from >= out_.size() || to >= in_.size() || !erase_from(out_[from], to)) {
+        return false;
+    }
+    erase_from(in_[to], from);
+
+    // 删除边可能打破环，让挂起的边重新参与排序
+    if (!pending_edges_.empty()) {
+        retry_pending_edges();
+    }
+    return true;
+}
+
+bool IncrementalTopologicalOrder::has_edge(NodeId from, NodeId to) const {
+    if (from >= out_.size()) {
+        return false;
+    }
+    const auto& deps = out_[from];
+    return std::find(deps.begin(), deps.end(), to) != deps.end();
+}
+
+void IncrementalTopologicalOrder::rebuild(const CSRDependencyGraph& graph) {
+    clear();
+    const size_t n = graph.node_count();
+    for (size_t i = 0; i < n; ++i) {
+        add_node();
+    }
+
+    // 以 Kahn 序作为初始顺序；环上及其下游的节点排在最后，由逐边插入修正
+    auto order = graph.topological_order();
+    std::vector<uint8_t> placed(n, 0);
+    size_t next = 0;
+    for (NodeId node : order) {
+        placed[node] = 1;
+        position_[node] = static_cast<uint32_t>(next);
+        node_at_[next++] = node;
+    }
+    for (NodeId node = 0; node < n; ++node) {
+        if (!placed[node]) {
+            position_[node] = static_cast<uint32_t>(next);
+            node_at_[next++] = node;
+        }
+    }
+
+    for (NodeId from = 0; from < n; ++from) {
+        for (NodeId to : graph.dependencies(from)) {
+            add_edge(from, to);
+        }
+    }
+}
+
+void IncrementalTopologicalOrder::clear() {
+    position_.clear();
+    node_at_.clear();
+    out_.clear();
+    in_.clear();
+    pending_edges_.clear();
+    mark_.clear();
+    parent_.clear();
+    delta_forward_.clear();
+    delta_backward_.clear();
+    stack_.clear();
+    stats_ = Stats();
+}
+
+bool IncrementalTopologicalOrder::insert_edge(NodeId from, NodeId to, std::vector<NodeId>* cycle) {
+    delta_forward_.clear();
+    delta_backward_.clear();
+    if (from == to) {
+        if (cycle) {
+            *cycle = {from, from};
+        }
+        return false;
+    }
+
+    uint32_t upper_bound = position_[from];
+    uint32_t lower_bound = position_[to];
+
+    if (lower_bound < upper_bound) {
+        // 违反当前顺序：只在受影响区间内搜索
+        if (!discover_forward(to, upper_bound, from, cycle)) {
+            reset_marks();
+            return false;
+        }
+        discover_backward(from, lower_bound);
+        reorder();
+        reset_marks();
+    }
+
+    out_[from].push_back(to);
+    in_[to].push_back(from);
+    return true;
+}
+
+bool IncrementalTopologicalOrder::discover_forward(NodeId start, uint32_t upper_bound, NodeId target,
+                                                   std::vector<NodeId>* cycle) {
+    stack_.clear();
+    mark_[start] = MARK_FORWARD;
+    parent_[start] = NO_PARENT;
+    delta_forward_.push_back(start);
+    stack_.push_back(start);
+
+    while (!stack_.empty()) {
+        NodeId v = stack_.back();
+        stack_.pop_back();
+
+        for (NodeId w : out_[v]) {
+            if (w == target) {
+                // target 可由 start 到达：新边 target -> start 闭合成环
+                if (cycle) {
+                    cycle->clear();
+                    for (NodeId u = v; u != NO_PARENT; u = parent_[u]) {
+                        cycle->push_back(u);
+                    }
+                    cycle->push_back(target);
+                    std::reverse(cycle->begin(), cycle->end());
+                    cycle->push_back(target);
+                }
+                return false;
+            }
+            if (mark_[w] == 0 && position_[w] < upper_bound) {
+                mark_[w] = MARK_FORWARD;
+                parent_[w] = v;
+                delta_forward_.push_back(w);
+                stack_.push_back(w);
+            }
+        }
+    }
+    return true;
+}
+
+void IncrementalTopologicalOrder::discover_backward(NodeId start, uint32_t lower_bound) {
+    stack_.clear();
+    mark_[start] = MARK_BACKWARD;
+    delta_backward_.push_back(start);
+    stack_.push_back(start);
+
+    while (!stack_.empty()) {
+        NodeId v = stack_.back();
+        stack_.pop_back();
+
+        for (NodeId w : in_[v]) {
+            if (mark_[w] == 0 && position_[w] > lower_bound) {
+                mark_[w] = MARK_BACKWARD;
+                delta_backward_.push_back(w);
+                stack_.push_back(w);
+            }
+        }
+    }
+}
+
+void IncrementalTopologicalOrder::reorder() {
+    auto by_position = [this](NodeId a, NodeId b) { return position_[a] < position_[b]; };
+    std::sort(delta_forward_.begin(), delta_forward_.end(), by_position);
+    std::sort(delta_backward_.begin(), delta_backward_.end(), by_position);
+
+    // 受影响节点原来占据的位置集合
+    std::vector<uint32_t> slots;
+    slots.reserve(delta_forward_.size() + delta_backward_.size());
+    for (NodeId node : delta_backward_) slots.push_back(position_[node]);
+    for (NodeId node : delta_forward_) slots.push_back(position_[node]);
+    std::sort(slots.begin(), slots.end());
+
+    // 后向集合（依赖 from 的节点）整体移到前向集合（to 的下游）之前，各自保持相对顺序
+    size_t slot = 0;
+    for (NodeId node : delta_backward_) {
+        position_[node] = slots[slot];
+        node_at_[slots[slot++]] = node;
+    }
+    for (NodeId node : delta_forward_) {
+        position_[node] = slots[slot];
+        node_at_[slots[slot++]] = node;
+    }
+}
+
+void IncrementalTopologicalOrder::reset_marks() {
+    for (NodeId node : delta_forward_) mark_[node] = 0;
+    for (NodeId node : delta_backward_) mark_[node] = 0;
+}
+
+void IncrementalTopologicalOrder::record_insert(bool inserted) {
+    // 统计由 add_edge/try_add_edge/retry_pending_edges 各记一次，insert_edge 本身不计数
+    stats_.last_affected_nodes = delta_forward_.size() + delta_backward_.size();
+    stats_.nodes_visited += stats_.last_affected_nodes;
+    if (!inserted) {
+        stats_.cycles_detected++;
+        return;
+    }
+    stats_.edges_added++;
+    if (!delta_backward_.empty()) {
+        stats_.reorders++;
+    }
+}
+
+void IncrementalTopologicalOrder::retry_pending_edges() {
+    auto pending = std::move(pending_edges_);
+    pending_edges_.clear();
+    for (const auto& [from, to] : pending) {
+        // 仍然成环的边在最初加入时已计入 cycles_detected，不再重复统计
+        if (insert_edge(from, to, nullptr)) {
+            record_insert(true);
+        } else {
+            pending_edges_.emplace_back(from, to);
+        }
+    }
+}
+
+bool IncrementalTopologicalOrder::erase_from(std::vector<NodeId>& list, NodeId value) {
+    auto it = std::find(list.begin(), list.end(), value);
+    if (it == list.end()) {
+        return false;
+    }
+    *it = list.back();
+    list.pop_back();
+    return true;
+}
+
+} // namespace Paker
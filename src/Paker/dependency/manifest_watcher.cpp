@@ -0,0 +1,431 @@
+#include "Paker/dependency/manifest_watcher.h"
+#include <filesystem>
+#include <glog/logging.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Paker {
+
+namespace {
+
+#ifdef __linux__
+// 根目录只关心清单文件与 packages 目录本身
+constexpr uint32_t ROOT_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                               IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                               IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+// packages/ 与各包目录：任何一级条目的变化都会使对应包变脏
+constexpr uint32_t DIR_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                              IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                              IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+constexpr size_t EVENT_BUFFER_SIZE = 64 * 1024;
+#endif
+
+const char* const PACKAGES_DIR_NAME = "packages";
+
+} // namespace
+
+ManifestWatcher::ManifestWatcher(const std::string& project_root, const std::string& manifest_name)
+    : project_root_(project_root),
+      manifest_name_(manifest_name),
+      packages_dir_((fs::path(project_root) / PACKAGES_DIR_NAME).string()) {
+#ifdef __linux__
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG(WARNING) << "eventfd failed: " << std::strerror(errno);
+    }
+#endif
+}
+
+ManifestWatcher::~ManifestWatcher() {
+    stop();
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int fd : retired_fds_) {
+        ::close(fd);
+    }
+    retired_fds_.clear();
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+    }
+#endif
+}
+
+bool ManifestWatcher::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inotify_fd_ >= 0) {
+        return true;
+    }
+    if (!add_watches()) {
+        return false;
+    }
+
+    manifest_stamp_ = stat_file((fs::path(project_root_) / manifest_name_).string());
+    package_stamps_ = scan_packages();
+    dirty_packages_.clear();
+    manifest_changed_ = false;
+    overflowed_ = false;
+
+    LOG(INFO) << "Manifest watcher started on " << project_root_ << " ("
+              << package_wds_.size() << " package directories)";
+    return true;
+}
+
+void ManifestWatcher::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inotify_fd_ < 0) {
+        return;
+    }
+    remove_watches();
+    LOG(INFO) << "Manifest watcher stopped";
+}
+
+bool ManifestWatcher::is_active() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inotify_fd_ >= 0;
+}
+
+size_t ManifestWatcher::get_watch_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inotify_fd_ < 0) {
+        return 0;
+    }
+    return 1 + (packages_wd_ >= 0 ? 1 : 0) + package_wds_.size();
+}
+
+void ManifestWatcher::mark_overflow() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    overflowed_ = true;
+}
+
+bool ManifestWatcher::add_watches() {
+#ifdef __linux__
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        LOG(WARNING) << "inotify_init1 failed: " << std::strerror(errno);
+        return false;
+    }
+
+    root_wd_ = inotify_add_watch(inotify_fd_, project_root_.c_str(), ROOT_MASK);
+    if (root_wd_ < 0) {
+        LOG(WARNING) << "Failed to watch project root " << project_root_ << ": " << std::strerror(errno);
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+
+    watch_packages_directory();
+    return true;
+#else
+    LOG(WARNING) << "Filesystem watch is not supported on this platform";
+    return false;
+#endif
+}
+
+void ManifestWatcher::remove_watches() {
+#ifdef __linux__
+    // 关闭描述符会一并移除所有 watch
+    if (inotify_fd_ >= 0) {
+        if (waiters_ == 0) {
+            ::close(inotify_fd_);
+        } else {
+            // 有线程正在 poll 这个描述符：唤醒它们，由最后一个离开的等待者关闭
+            retired_fds_.push_back(inotify_fd_);
+            if (wake_fd_ >= 0) {
+                uint64_t one = 1;
+                ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+                (void)written;
+            }
+        }
+    }
+#endif
+    inotify_fd_ = -1;
+    root_wd_ = -1;
+    packages_wd_ = -1;
+    package_wds_.clear();
+}
+
+void ManifestWatcher::watch_packages_directory() {
+#ifdef __linux__
+    int wd = inotify_add_watch(inotify_fd_, packages_dir_.c_str(), DIR_MASK);
+    if (wd < 0) {
+        // packages/ 尚不存在，等待根目录上的创建事件
+        packages_wd_ = -1;
+        return;
+    }
+    packages_wd_ = wd;
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(packages_dir_, ec)) {
+        if (entry.is_directory(ec)) {
+            watch_package(entry.path().filename().string());
+        }
+    }
+#endif
+}
+
+void ManifestWatcher::watch_package(const std::string& package) {
+#ifdef __linux__
+    auto path = (fs::path(packages_dir_) / package).string();
+    int wd = inotify_add_watch(inotify_fd_, path.c_str(), DIR_MASK);
+    if (wd >= 0) {
+        package_wds_[wd] = package;
+    } else if (errno == ENOSPC) {
+        // 超出 max_user_watches：该包的变化只能靠 stat 重新校验发现
+        LOG(WARNING) << "inotify watch limit reached, falling back to stat validation";
+        overflowed_ = true;
+    }
+#else
+    (void)package;
+#endif
+}
+
+void ManifestWatcher::drain_events() {
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[EVENT_BUFFER_SIZE];
+    while (true) {
+        ssize_t length = ::read(inotify_fd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            handle_event(event->wd, event->mask, event->len > 0 ? std::string(event->name) : std::string());
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+        }
+    }
+#endif
+}
+
+void ManifestWatcher::handle_event(int wd, uint32_t mask, const std::string& name) {
+#ifdef __linux__
+    if (mask & IN_Q_OVERFLOW) {
+        overflowed_ = true;
+        return;
+    }
+
+    const bool created = (mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+
+    if (wd == root_wd_) {
+        if (mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+            // 项目根目录本身被移走，只能依靠 stat 重新校验
+            overflowed_ = true;
+        } else if (name == manifest_name_) {
+            manifest_changed_ = true;
+        } else if (name == PACKAGES_DIR_NAME && (mask & IN_ISDIR)) {
+            // packages/ 整体出现或消失：涉及的包都视为变脏
+            for (const auto& [package, stamp] : package_stamps_) {
+                dirty_packages_.insert(package);
+            }
+            if (created && packages_wd_ < 0) {
+                watch_packages_directory();
+                std::error_code ec;
+                for (const auto& entry : fs::directory_iterator(packages_dir_, ec)) {
+                    dirty_packages_.insert(entry.path().filename().string());
+                }
+            }
+        }
+        return;
+    }
+
+    if (wd == packages_wd_) {
+        if (mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+            packages_wd_ = -1;
+            return;
+        }
+        if (name.empty()) {
+            return;
+        }
+        // 包目录被删除时，其自身的 watch 会收到 IN_IGNORED 并在下面注销
+        dirty_packages_.insert(name);
+        if (created && (mask & IN_ISDIR)) {
+            watch_package(name);
+        }
+        return;
+    }
+
+    auto it = package_wds_.find(wd);
+    if (it == package_wds_.end()) {
+        return;
+    }
+    dirty_packages_.insert(it->second);
+    if (mask & IN_MOVE_SELF) {
+        // 包目录被移出 packages/，不再跟踪其新位置
+        inotify_rm_watch(inotify_fd_, wd);
+        package_wds_.erase(it);
+    } else if (mask & IN_IGNORED) {
+        package_wds_.erase(it);
+    }
+#else
+    (void)wd;
+    (void)mask;
+    (void)name;
+#endif
+}
+
+void ManifestWatcher::release_retired_fds() const {
+#ifdef __linux__
+    if (retired_fds_.empty()) {
+        return;
+    }
+    for (int fd : retired_fds_) {
+        ::close(fd);
+    }
+    retired_fds_.clear();
+    if (wake_fd_ >= 0) {
+        // 清零唤醒计数，避免下一次等待被误唤醒
+        uint64_t count;
+        ssize_t drained = ::read(wake_fd_, &count, sizeof(count));
+        (void)drained;
+    }
+#endif
+}
+
+bool ManifestWatcher::wait_for_events(std::chrono::milliseconds timeout) const {
+#ifdef __linux__
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (inotify_fd_ < 0) {
+        return false;
+    }
+    // 登记为等待者后，stop/resync 不会在 poll 返回前关闭这个描述符
+    struct pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    nfds_t count = wake_fd_ >= 0 ? 2 : 1;
+    ++waiters_;
+    lock.unlock();
+
+    int ready = ::poll(fds, count, static_cast<int>(timeout.count()));
+
+    lock.lock();
+    if (--waiters_ == 0) {
+        release_retired_fds();
+    }
+    if (ready <= 0) {
+        return false;
+    }
+    // 被 stop 唤醒时不报告事件；被 resync 唤醒时监视已重建，交给 poll_changes 处理
+    return inotify_fd_ >= 0;
+#else
+    (void)timeout;
+    return false;
+#endif
+}
+
+WatchChanges ManifestWatcher::poll_changes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    WatchChanges changes;
+    if (inotify_fd_ < 0) {
+        return changes;
+    }
+
+    drain_events();
+
+    if (overflowed_) {
+        resync(changes);
+    } else {
+        // 只刷新变脏部分的快照，保持 O(变更数)
+        for (const auto& package : dirty_packages_) {
+            package_stamps_[package] = stat_package(package);
+        }
+        if (manifest_changed_) {
+            manifest_stamp_ = stat_file((fs::path(project_root_) / manifest_name_).string());
+        }
+    }
+
+    changes.dirty_packages.insert(dirty_packages_.begin(), dirty_packages_.end());
+    changes.manifest_changed = changes.manifest_changed || manifest_changed_;
+
+    dirty_packages_.clear();
+    manifest_changed_ = false;
+    overflowed_ = false;
+    return changes;
+}
+
+void ManifestWatcher::resync(WatchChanges& changes) {
+    LOG(WARNING) << "Manifest watcher lost events, revalidating with stat";
+    changes.overflowed = true;
+
+    // 先重新建立监视再做 stat，保证两者之间的修改不会遗漏
+    remove_watches();
+    if (!add_watches()) {
+        // 无法恢复监视：报告全部已知包为脏，调用方会退回常规检测
+        for (const auto& [package, stamp] : package_stamps_) {
+            changes.dirty_packages.insert(package);
+        }
+        changes.manifest_changed = true;
+        return;
+    }
+
+    auto current = scan_packages();
+    for (const auto& [package, stamp] : current) {
+        auto it = package_stamps_.find(package);
+        if (it == package_stamps_.end() || it->second != stamp) {
+            changes.dirty_packages.insert(package);
+        }
+    }
+    for (const auto& [package, stamp] : package_stamps_) {
+        if (stamp.exists && current.find(package) == current.end()) {
+            changes.dirty_packages.insert(package);
+        }
+    }
+    package_stamps_ = std::move(current);
+
+    auto manifest = stat_file((fs::path(project_root_) / manifest_name_).string());
+    if (manifest != manifest_stamp_) {
+        changes.manifest_changed = true;
+        manifest_stamp_ = manifest;
+    }
+}
+
+ManifestWatcher::FileStamp ManifestWatcher::stat_file(const std::string& path) const {
+    FileStamp stamp;
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return stamp;
+    }
+    stamp.exists = true;
+    stamp.size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    stamp.mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    return stamp;
+}
+
+ManifestWatcher::FileStamp ManifestWatcher::stat_package(const std::string& package) const {
+    // 与 IncrementalParser::calculate_dependency_hash 的清单查找顺序一致
+    auto package_path = fs::path(packages_dir_) / package;
+    for (const char* manifest : {"paker.json", "package.json"}) {
+        FileStamp stamp = stat_file((package_path / manifest).string());
+        if (stamp.exists) {
+            return stamp;
+        }
+    }
+    // 没有清单时以目录本身表示存在性
+    return stat_file(package_path.string());
+}
+
+std::map<std::string, ManifestWatcher::FileStamp> ManifestWatcher::scan_packages() const {
+    std::map<std::string, FileStamp> stamps;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(packages_dir_, ec)) {
+        if (entry.is_directory(ec)) {
+            auto package = entry.path().filename().string();
+            stamps[package] = stat_package(package);
+        }
+    }
+    return stamps;
+}
+
+} // namespace Paker
@@ -1,4 +1,8 @@
 #include "Paker/dependency/optimized_dependency_graph.h"
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/graph_condensation.h"
+#include "Paker/dependency/reachability_index.h"
+#include "Paker/dependency/graph_snapshot.h"
 #include "Paker/core/output.h"
 #include <glog/logging.h>
 #include <fstream>
@@ -37,6 +41,8 @@ size_t OptimizedDependencyGraph::add_node(const LightweightDependencyNode& node)
         // 更新现有节点
         size_t index = it->second;
         nodes_[index] = node;
+        ++graph_version_;
+        topo_dirty_ = true;
         update_access_time(index);
         return index;
     }
@@ -46,6 +52,10 @@ size_t OptimizedDependencyGraph::add_node(const LightweightDependencyNode& node)
     nodes_.push_back(node);
     name_to_index_[node.name] = index;
     access_counts_[index] = 1;
+    ++graph_version_;
+    if (!topo_dirty_) {
+        topo_order_.add_node();
+    }
     
     // 检查是否需要清理缓存
     if (nodes_.size() > cache_cleanup_threshold_) {
@@ -109,6 +119,8 @@ bool OptimizedDependencyGraph::remove_node(const std::string& name) {
         }
     }
     
+    ++graph_version_;
+    topo_dirty_ = true;
     LOG(INFO) << "Removed node: " << name;
     return true;
 }
@@ -186,6 +198,10 @@ bool OptimizedDependencyGraph::add_dependency(const std::string& from, const std
     // 添加依赖关系
     from_node.dependency_indices.push_back(to_index);
     nodes_[to_index].dependent_indices.push_back(from_index);
+    ++graph_version_;
+    if (!topo_dirty_ && !topo_order_.add_edge(static_cast<uint32_t>(from_index), static_cast<uint32_t>(to_index))) {
+        LOG(WARNING) << "Dependency " << from << " -> " << to << " introduces a cycle";
+    }
     
     LOG(INFO) << "Added dependency: " << from << " -> " << to;
     return true;
@@ -216,11 +232,57 @@ bool OptimizedDependencyGraph::remove_dependency(const std::string& from, const
     if (dep_it2 != to_node.dependent_indices.end()) {
         to_node.dependent_indices.erase(dep_it2);
     }
+    ++graph_version_;
+    if (!topo_dirty_) {
+        topo_order_.remove_edge(static_cast<uint32_t>(from_index), static_cast<uint32_t>(to_index));
+    }
     
     LOG(INFO) << "Removed dependency: " << from << " -> " << to;
     return true;
 }
 
+bool OptimizedDependencyGraph::try_add_dependency(const std::string& from, const std::string& to,
+                                                  std::vector<std::string>* cycle) {
+    auto from_it = name_to_index_.find(from);
+    auto to_it = name_to_index_.find(to);
+    
+    if (from_it == name_to_index_.end() || to_it == name_to_index_.end()) {
+        return false;
+    }
+    
+    size_t from_index = from_it->second;
+    size_t to_index = to_it->second;
+    auto& from_node = nodes_[from_index];
+    if (std::find(from_node.dependency_indices.begin(), 
+                  from_node.dependency_indices.end(), to_index) != from_node.dependency_indices.end()) {
+        return true; // 已存在
+    }
+    
+    std::vector<uint32_t> cycle_ids;
+    std::unique_lock<std::mutex> topo_lock(topo_mutex_);
+    refresh_topological_order_locked();
+    bool inserted = topo_order_.try_add_edge(static_cast<uint32_t>(from_index), static_cast<uint32_t>(to_index),
+                                             cycle ? &cycle_ids : nullptr);
+    topo_lock.unlock();
+    if (!inserted) {
+        if (cycle) {
+            cycle->clear();
+            for (auto id : cycle_ids) {
+                cycle->push_back(nodes_[id].name);
+            }
+        }
+        LOG(WARNING) << "Rejected dependency " << from << " -> " << to << ": would introduce a cycle";
+        return false;
+    }
+    
+    from_node.dependency_indices.push_back(to_index);
+    nodes_[to_index].dependent_indices.push_back(from_index);
+    ++graph_version_;
+    
+    LOG(INFO) << "Added dependency: " << from << " -> " << to;
+    return true;
+}
+
 std::vector<std::string> OptimizedDependencyGraph::get_dependencies(const std::string& name) const {
     const auto* node = get_node(name);
     if (!node) {
@@ -253,54 +315,54 @@ std::vector<std::string> OptimizedDependencyGraph::get_dependents(const std::str
     return dependents;
 }
 
+std::vector<std::string> OptimizedDependencyGraph::get_transitive_dependencies(const std::string& name) const {
+    return reachability_index()->transitive_dependencies(name);
+}
+
+std::vector<std::string> OptimizedDependencyGraph::get_transitive_dependents(const std::string& name) const {
+    return reachability_index()->transitive_dependents(name);
+}
+
+bool OptimizedDependencyGraph::depends_on(const std::string& from, const std::string& to) const {
+    return reachability_index()->reaches(from, to);
+}
+
 std::vector<std::string> OptimizedDependencyGraph::topological_sort() const {
-    std::vector<std::string> result;
-    std::vector<int> in_degree(nodes_.size(), 0);
-    std::queue<size_t> q;
-    
-    // 计算入度
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        in_degree[i] = nodes_[i].dependent_indices.size();
-        if (in_degree[i] == 0) {
-            q.push(i);
-        }
-    }
-    
-    // 拓扑排序
-    while (!q.empty()) {
-        size_t current = q.front();
-        q.pop();
-        result.push_back(nodes_[current].name);
-        
-        for (size_t dep_index : nodes_[current].dependency_indices) {
-            in_degree[dep_index]--;
-            if (in_degree[dep_index] == 0) {
-                q.push(dep_index);
-            }
-        }
+    auto topo = ensure_topological_order();
+    if (!topo.acyclic) {
+        // 有环时退回到整图 Kahn 排序（结果不完整并给出警告）
+        return freeze()->topological_sort();
     }
     
-    // 检查是否有循环依赖
-    if (result.size() != nodes_.size()) {
-        LOG(WARNING) << "Circular dependency detected in topological sort";
+    std::vector<std::string> result;
+    result.reserve(nodes_.size());
+    for (auto index : topo.order) {
+        result.push_back(nodes_[index].name);
     }
-    
     return result;
 }
 
-std::vector<std::vector<std::string>> OptimizedDependencyGraph::detect_cycles() const {
-    std::vector<std::vector<std::string>> cycles;
-    std::unordered_set<size_t> visited;
-    std::unordered_set<size_t> rec_stack;
-    std::vector<size_t> path;
-    
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        if (visited.find(i) == visited.end()) {
-            dfs_cycle_detection(i, visited, rec_stack, path, cycles);
-        }
+bool OptimizedDependencyGraph::is_acyclic() const {
+    std::lock_guard<std::mutex> lock(topo_mutex_);
+    refresh_topological_order_locked();
+    return topo_order_.is_acyclic();
+}
+
+OptimizedDependencyGraph::TopologicalOrderSnapshot OptimizedDependencyGraph::ensure_topological_order() const {
+    std::lock_guard<std::mutex> lock(topo_mutex_);
+    refresh_topological_order_locked();
+    return {topo_order_.order(), topo_order_.is_acyclic()};
+}
+
+void OptimizedDependencyGraph::refresh_topological_order_locked() const {
+    if (topo_dirty_) {
+        topo_order_.rebuild(*freeze());
+        topo_dirty_ = false;
     }
-    
-    return cycles;
+}
+
+std::vector<std::vector<std::string>> OptimizedDependencyGraph::detect_cycles() const {
+    return freeze()->detect_cycles();
 }
 
 std::vector<std::vector<std::string>> OptimizedDependencyGraph::get_all_paths(const std::string& from, 
@@ -312,18 +374,36 @@ std::vector<std::vector<std::string>> OptimizedDependencyGraph::get_all_paths(co
         return {};
     }
     
-    size_t from_index = from_it->second;
-    size_t to_index = to_it->second;
-    
+    // CSR 节点ID与本图索引一致；有界 K 最短路径，菱形依赖下不会指数展开
+    auto csr = freeze();
     std::vector<std::vector<std::string>> all_paths;
-    std::unordered_set<size_t> visited;
-    std::vector<size_t> current_path;
-    
-    dfs_path_finding(from_index, to_index, visited, current_path, all_paths);
+    for (const auto& path : k_shortest_paths(*csr, {static_cast<uint32_t>(from_it->second)},
+                                             static_cast<uint32_t>(to_it->second),
+                                             CSRDependencyGraph::DEFAULT_MAX_PATHS)) {
+        all_paths.push_back(csr->to_names(path));
+    }
     
     return all_paths;
 }
 
+std::shared_ptr<const CSRDependencyGraph> OptimizedDependencyGraph::freeze() const {
+    std::lock_guard<std::mutex> lock(frozen_mutex_);
+    if (!frozen_ || frozen_version_ != graph_version_) {
+        frozen_ = std::make_shared<const CSRDependencyGraph>(CSRDependencyGraph::from_graph(*this));
+        frozen_version_ = graph_version_;
+    }
+    return frozen_;
+}
+
+std::shared_ptr<const ReachabilityIndex> OptimizedDependencyGraph::reachability_index() const {
+    std::lock_guard<std::mutex> lock(reachability_mutex_);
+    if (!reachability_ || reachability_version_ != graph_version_) {
+        reachability_ = std::make_shared<const ReachabilityIndex>(freeze());
+        reachability_version_ = graph_version_;
+    }
+    return reachability_;
+}
+
 void OptimizedDependencyGraph::optimize_memory() {
     LOG(INFO) << "Optimizing memory usage...";
     
@@ -431,6 +511,10 @@ bool OptimizedDependencyGraph::save_to_file(const std::string& filename) const {
 }
 
 bool OptimizedDependencyGraph::load_from_file(const std::string& filename) {
+    if (GraphSnapshot::is_snapshot_file(filename)) {
+        return load_from_snapshot(filename);
+    }
+    
     try {
         std::ifstream file(filename);
         if (!file) {
@@ -445,6 +529,9 @@ bool OptimizedDependencyGraph::load_from_file(const std::string& filename) {
         nodes_.clear();
         name_to_index_.clear();
         access_counts_.clear();
+        ++graph_version_;
+        topo_order_.clear();
+        topo_dirty_ = false;
         
         // 加载节点
         for (const auto& node_json : j["nodes"]) {
@@ -476,6 +563,46 @@ bool OptimizedDependencyGraph::load_from_file(const std::string& filename) {
     }
 }
 
+bool OptimizedDependencyGraph::save_to_snapshot(const std::string& filename, uint64_t fingerprint) const {
+    return GraphSnapshot::write(*this, filename, fingerprint);
+}
+
+bool OptimizedDependencyGraph::load_from_snapshot(const std::string& filename) {
+    GraphSnapshot snapshot;
+    if (!snapshot.open(filename)) {
+        LOG(ERROR) << "Cannot load graph snapshot: " << filename;
+        return false;
+    }
+    
+    const size_t node_count = snapshot.node_count();
+    nodes_.clear();
+    name_to_index_.clear();
+    access_counts_.clear();
+    nodes_.reserve(node_count);
+    name_to_index_.reserve(node_count);
+    
+    // 快照节点ID即索引，直接填充，不经过 add_node/add_dependency 的逐条日志与查找
+    for (uint32_t id = 0; id < node_count; ++id) {
+        LightweightDependencyNode node(std::string(snapshot.name(id)), std::string(snapshot.version(id)));
+        node.repository = snapshot.repository(id);
+        node.install_path = snapshot.install_path(id);
+        node.is_installed = snapshot.is_installed(id);
+        auto deps = snapshot.dependencies(id);
+        node.dependency_indices.assign(deps.begin(), deps.end());
+        auto dependents = snapshot.dependents(id);
+        node.dependent_indices.assign(dependents.begin(), dependents.end());
+        name_to_index_.emplace(node.name, id);
+        nodes_.push_back(std::move(node));
+    }
+    
+    ++graph_version_;
+    topo_dirty_ = true;
+    
+    LOG(INFO) << "Loaded graph snapshot from " << filename << " (" << node_count << " nodes, "
+              << snapshot.edge_count() << " edges)";
+    return true;
+}
+
 void OptimizedDependencyGraph::add_nodes_batch(const std::vector<LightweightDependencyNode>& nodes) {
     nodes_.reserve(nodes_.size() + nodes.size());
     
@@ -538,67 +665,6 @@ size_t OptimizedDependencyGraph::get_node_index(const std::string& name) const {
     return it != name_to_index_.end() ? it->second : SIZE_MAX;
 }
 
-void OptimizedDependencyGraph::dfs_cycle_detection(size_t node_index,
-                                                 std::unordered_set<size_t>& visited,
-                                                 std::unordered_set<size_t>& rec_stack,
-                                                 std::vector<size_t>& path,
-                                                 std::vector<std::vector<std::string>>& cycles) const {
-    if (node_index >= nodes_.size()) return;
-    
-    visited.insert(node_index);
-    rec_stack.insert(node_index);
-    path.push_back(node_index);
-    
-    for (size_t dep_index : nodes_[node_index].dependency_indices) {
-        if (dep_index >= nodes_.size()) continue;
-        
-        if (visited.find(dep_index) == visited.end()) {
-            dfs_cycle_detection(dep_index, visited, rec_stack, path, cycles);
-        } else if (rec_stack.find(dep_index) != rec_stack.end()) {
-            // 找到循环
-            std::vector<std::string> cycle;
-            auto cycle_start = std::find(path.begin(), path.end(), dep_index);
-            for (auto it = cycle_start; it != path.end(); ++it) {
-                cycle.push_back(nodes_[*it].name);
-            }
-            cycle.push_back(nodes_[dep_index].name);
-            cycles.push_back(cycle);
-        }
-    }
-    
-    rec_stack.erase(node_index);
-    path.pop_back();
-}
-
-void OptimizedDependencyGraph::dfs_path_finding(size_t from_index, size_t to_index,
-                                              std::unordered_set<size_t>& visited,
-                                              std::vector<size_t>& current_path,
-                                              std::vector<std::vector<std::string>>& all_paths) const {
-    if (from_index >= nodes_.size()) return;
-    
-    if (from_index == to_index) {
-        std::vector<std::string> path;
-        for (size_t idx : current_path) {
-            path.push_back(nodes_[idx].name);
-        }
-        path.push_back(nodes_[to_index].name);
-        all_paths.push_back(path);
-        return;
-    }
-    
-    visited.insert(from_index);
-    current_path.push_back(from_index);
-    
-    for (size_t dep_index : nodes_[from_index].dependency_indices) {
-        if (dep_index < nodes_.size() && visited.find(dep_index) == visited.end()) {
-            dfs_path_finding(dep_index, to_index, visited, current_path, all_paths);
-        }
-    }
-    
-    visited.erase(from_index);
-    current_path.pop_back();
-}
-
 // DependencyGraphBuilder 实现
 DependencyGraphBuilder::DependencyGraphBuilder() {
     graph_ = std::make_unique<OptimizedDependencyGraph>();
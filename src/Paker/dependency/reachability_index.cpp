@@ -0,0 +1,340 @@
+#include "Paker/dependency/reachability_index.h"
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <iterator>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Paker {
+
+namespace {
+
+constexpr size_t WORD_BITS = 64;
+
+// dst[begin, end) |= src[begin, end)
+void or_words(uint64_t* dst, const uint64_t* src, size_t begin, size_t end) {
+    size_t i = begin;
+#ifdef __AVX2__
+    for (; i + 4 <= end; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(a, b));
+    }
+#endif
+    for (; i < end; ++i) {
+        dst[i] |= src[i];
+    }
+}
+
+size_t popcount_words(const uint64_t* words, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += static_cast<size_t>(__builtin_popcountll(words[i]));
+    }
+    return total;
+}
+
+// 遍历位集中的置位下标
+template<typename Func>
+void for_each_bit(const uint64_t* words, size_t count, Func func) {
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t word = words[i];
+        while (word) {
+            func(static_cast<uint32_t>(i * WORD_BITS + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+} // namespace
+
+ReachabilityIndex::ReachabilityIndex(std::shared_ptr<const CSRDependencyGraph> graph,
+                                     size_t max_bitset_components)
+    : graph_(std::move(graph)) {
+    condensation_ = std::make_unique<GraphCondensation>(*graph_);
+    if (condensation_->component_count() <= max_bitset_components) {
+        mode_ = Mode::BITSET;
+        build_bitsets();
+    } else {
+        mode_ = Mode::INTERVAL;
+        build_intervals();
+    }
+}
+
+void ReachabilityIndex::build_bitsets() {
+    const size_t c = condensation_->component_count();
+    words_ = (c + WORD_BITS - 1) / WORD_BITS;
+    descendants_.assign(c * words_, 0);
+    ancestors_.assign(c * words_, 0);
+
+    // 依赖分量编号更小：按编号递增合并后代，且只需合并到 comp 所在的字为止
+    for (ComponentId comp = 0; comp < c; ++comp) {
+        uint64_t* row = descendants_.data() + comp * words_;
+        row[comp / WORD_BITS] |= uint64_t(1) << (comp % WORD_BITS);
+        for (ComponentId dep : condensation_->component_dependencies(comp)) {
+            or_words(row, descendants_row(dep), 0, dep / WORD_BITS + 1);
+        }
+    }
+
+    // 祖先编号更大：按编号递减合并
+    for (ComponentId comp = static_cast<ComponentId>(c); comp-- > 0;) {
+        uint64_t* row = ancestors_.data() + comp * words_;
+        row[comp / WORD_BITS] |= uint64_t(1) << (comp % WORD_BITS);
+        for (ComponentId dependent : condensation_->component_dependents(comp)) {
+            or_words(row, ancestors_row(dependent), dependent / WORD_BITS, words_);
+        }
+    }
+}
+
+void ReachabilityIndex::build_intervals() {
+    const size_t c = condensation_->component_count();
+    interval_low_.assign(c * INTERVAL_LABELS, 0);
+    interval_post_.assign(c * INTERVAL_LABELS, 0);
+
+    std::vector<ComponentId> roots;
+    for (ComponentId comp = 0; comp < c; ++comp) {
+        if (condensation_->component_dependents(comp).empty()) {
+            roots.push_back(comp);
+        }
+    }
+
+    std::mt19937 rng(0x5eed);
+    std::vector<uint8_t> visited(c);
+    // (分量, 已访问的子节点数, 子节点起始偏移)
+    std::vector<std::tuple<ComponentId, uint32_t, uint32_t>> stack;
+
+    for (size_t label = 0; label < INTERVAL_LABELS; ++label) {
+        std::fill(visited.begin(), visited.end(), 0);
+        std::shuffle(roots.begin(), roots.end(), rng);
+        uint32_t rank = 0;
+
+        for (ComponentId root : roots) {
+            visited[root] = 1;
+            stack.emplace_back(root, 0, static_cast<uint32_t>(rng()));
+
+            while (!stack.empty()) {
+                auto& [comp, next, offset] = stack.back();
+                auto children = condensation_->component_dependencies(comp);
+                const uint32_t degree = static_cast<uint32_t>(children.size());
+
+                if (next < degree) {
+                    // 每次遍历以随机偏移轮转子节点顺序，使各组标号相互独立
+                    ComponentId child = children.begin()[(offset + next) % degree];
+                    ++next;
+                    if (!visited[child]) {
+                        visited[child] = 1;
+                        stack.emplace_back(child, 0, static_cast<uint32_t>(rng()));
+                    }
+                    continue;
+                }
+
+                ComponentId finished = comp;
+                stack.pop_back();
+                uint32_t low = rank;
+                for (ComponentId child : condensation_->component_dependencies(finished)) {
+                    low = std::min(low, interval_low_[child * INTERVAL_LABELS + label]);
+                }
+                interval_low_[finished * INTERVAL_LABELS + label] = low;
+                interval_post_[finished * INTERVAL_LABELS + label] = rank++;
+            }
+        }
+    }
+}
+
+bool ReachabilityIndex::interval_may_reach(ComponentId from, ComponentId to) const {
+    // from 可达 to 时，to 的区间必然包含在 from 的区间内
+    for (size_t label = 0; label < INTERVAL_LABELS; ++label) {
+        size_t f = from * INTERVAL_LABELS + label;
+        size_t t = to * INTERVAL_LABELS + label;
+        if (interval_low_[t] < interval_low_[f] || interval_post_[t] > interval_post_[f]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReachabilityIndex::component_reaches(ComponentId from, ComponentId to) const {
+    if (from == to) {
+        return true;
+    }
+    if (mode_ == Mode::BITSET) {
+        return (descendants_row(from)[to / WORD_BITS] >> (to % WORD_BITS)) & 1;
+    }
+    if (to > from || !interval_may_reach(from, to)) {
+        return false;
+    }
+
+    // 只访问编号位于 [to, from] 且区间标号允许的分量
+    std::vector<uint8_t> visited(from - to + 1, 0);
+    std::vector<ComponentId> stack{from};
+    visited[from - to] = 1;
+    while (!stack.empty()) {
+        ComponentId comp = stack.back();
+        stack.pop_back();
+        for (ComponentId next : condensation_->component_dependencies(comp)) {
+            if (next == to) return true;
+            if (next < to || visited[next - to]) continue;
+            visited[next - to] = 1;
+            if (interval_may_reach(next, to)) {
+                stack.push_back(next);
+            }
+        }
+    }
+    return false;
+}
+
+bool ReachabilityIndex::reaches(NodeId from, NodeId to) const {
+    if (from >= graph_->node_count() || to >= graph_->node_count()) {
+        return false;
+    }
+
+    ComponentId source = condensation_->component_of(from);
+    ComponentId target = condensation_->component_of(to);
+    if (source == target) {
+        return from != to || condensation_->is_cyclic(source);
+    }
+    return component_reaches(source, target);
+}
+
+std::vector<ReachabilityIndex::ComponentId> ReachabilityIndex::reachable_components(ComponentId start,
+                                                                                   bool forward) const {
+    std::vector<ComponentId> result;
+    if (mode_ == Mode::BITSET) {
+        const uint64_t* row = forward ? descendants_row(start) : ancestors_row(start);
+        for_each_bit(row, words_, [&](uint32_t comp) { result.push_back(comp); });
+        return result;
+    }
+
+    std::vector<uint8_t> visited(condensation_->component_count(), 0);
+    result.push_back(start);
+    visited[start] = 1;
+    for (size_t head = 0; head < result.size(); ++head) {
+        auto next_range = forward ? condensation_->component_dependencies(result[head])
+                                  : condensation_->component_dependents(result[head]);
+        for (ComponentId next : next_range) {
+            if (!visited[next]) {
+                visited[next] = 1;
+                result.push_back(next);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<ReachabilityIndex::NodeId> ReachabilityIndex::expand(const std::vector<ComponentId>& components,
+                                                                 NodeId exclude) const {
+    std::vector<NodeId> nodes;
+    for (ComponentId comp : components) {
+        for (NodeId member : condensation_->members(comp)) {
+            if (member != exclude) {
+                nodes.push_back(member);
+            }
+        }
+    }
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+size_t ReachabilityIndex::count_members(const std::vector<ComponentId>& components, NodeId exclude) const {
+    size_t count = 0;
+    for (ComponentId comp : components) {
+        count += condensation_->members(comp).size();
+    }
+    return exclude < graph_->node_count() ? count - 1 : count;
+}
+
+std::vector<ReachabilityIndex::NodeId> ReachabilityIndex::transitive_dependencies(NodeId node) const {
+    if (node >= graph_->node_count()) {
+        return {};
+    }
+    return expand(reachable_components(condensation_->component_of(node), true), node);
+}
+
+std::vector<ReachabilityIndex::NodeId> ReachabilityIndex::transitive_dependents(NodeId node) const {
+    if (node >= graph_->node_count()) {
+        return {};
+    }
+    return expand(reachable_components(condensation_->component_of(node), false), node);
+}
+
+size_t ReachabilityIndex::count_transitive_dependencies(NodeId node) const {
+    if (node >= graph_->node_count()) {
+        return 0;
+    }
+    ComponentId comp = condensation_->component_of(node);
+    // 无环图中分量即节点，计数就是位集的 popcount
+    if (mode_ == Mode::BITSET && !condensation_->has_cycles()) {
+        return popcount_words(descendants_row(comp), words_) - 1;
+    }
+    return count_members(reachable_components(comp, true), node);
+}
+
+size_t ReachabilityIndex::count_transitive_dependents(NodeId node) const {
+    if (node >= graph_->node_count()) {
+        return 0;
+    }
+    ComponentId comp = condensation_->component_of(node);
+    if (mode_ == Mode::BITSET && !condensation_->has_cycles()) {
+        return popcount_words(ancestors_row(comp), words_) - 1;
+    }
+    return count_members(reachable_components(comp, false), node);
+}
+
+std::vector<ReachabilityIndex::NodeId> ReachabilityIndex::common_dependencies(NodeId a, NodeId b) const {
+    std::vector<NodeId> result;
+    if (a >= graph_->node_count() || b >= graph_->node_count()) {
+        return result;
+    }
+
+    ComponentId comp_a = condensation_->component_of(a);
+    ComponentId comp_b = condensation_->component_of(b);
+    std::vector<ComponentId> components;
+    if (mode_ == Mode::BITSET) {
+        const uint64_t* row_a = descendants_row(comp_a);
+        const uint64_t* row_b = descendants_row(comp_b);
+        // 两者的公共后代编号不超过较小的分量编号
+        const size_t limit = std::min(comp_a, comp_b) / WORD_BITS + 1;
+        std::vector<uint64_t> both(limit);
+        for (size_t i = 0; i < limit; ++i) {
+            both[i] = row_a[i] & row_b[i];
+        }
+        for_each_bit(both.data(), limit, [&](uint32_t comp) { components.push_back(comp); });
+    } else {
+        auto from_a = reachable_components(comp_a, true);
+        auto from_b = reachable_components(comp_b, true);
+        std::sort(from_a.begin(), from_a.end());
+        std::sort(from_b.begin(), from_b.end());
+        std::set_intersection(from_a.begin(), from_a.end(), from_b.begin(), from_b.end(),
+                              std::back_inserter(components));
+    }
+
+    for (NodeId node : expand(components, a)) {
+        if (node != b) {
+            result.push_back(node);
+        }
+    }
+    return result;
+}
+
+bool ReachabilityIndex::reaches(const std::string& from, const std::string& to) const {
+    return reaches(graph_->find(from), graph_->find(to));
+}
+
+std::vector<std::string> ReachabilityIndex::transitive_dependencies(const std::string& name) const {
+    return graph_->to_names(transitive_dependencies(graph_->find(name)));
+}
+
+std::vector<std::string> ReachabilityIndex::transitive_dependents(const std::string& name) const {
+    return graph_->to_names(transitive_dependents(graph_->find(name)));
+}
+
+size_t ReachabilityIndex::get_memory_usage() const {
+    size_t usage = sizeof(*this);
+    usage += (descendants_.capacity() + ancestors_.capacity()) * sizeof(uint64_t);
+    usage += (interval_low_.capacity() + interval_post_.capacity()) * sizeof(uint32_t);
+    return usage;
+}
+
+} // namespace Paker
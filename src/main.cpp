@@ -1,5 +1,6 @@
 #include "Paker/commands/cli.h"
 #include "Paker/core/service_container.h"
+#include "Paker/core/daemon.h"
 #include <glog/logging.h>
 
 int main(int argc, char* argv[]) {
@@ -8,7 +9,11 @@ int main(int argc, char* argv[]) {
     FLAGS_logtostderr = 0;  // 不输出到stderr
     FLAGS_minloglevel = 2;  // 只显示ERROR和FATAL级别日志
     
-    int result = run_cli(argc, argv);
+    // 守护进程在运行时转发命令，否则在本进程执行
+    int result = 0;
+    if (!Paker::DaemonClient::try_forward(argc, argv, result)) {
+        result = run_cli(argc, argv);
+    }
     
     // 只在服务管理器被初始化时才清理
     if (Paker::g_service_manager) {
@@ -5,6 +5,7 @@
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <future>
 
 namespace Paker {
 
@@ -267,7 +268,60 @@ TEST_F(AsyncIOTest, ErrorHandling) {
     
     ASSERT_TRUE(read_result);
     ASSERT_EQ(read_result->status, IOOperationStatus::FAILED);
-    ASSERT_FALSE(read_result->content.empty()); // 应该有错误信息
+    ASSERT_FALSE(read_result->error_message.empty()); // 应该有错误信息
+}
+
+TEST(AsyncIOQueueTest, CancelledOperationsCompleteAndRelease) {
+    AsyncIOManager manager(1, 10);
+    manager.initialize();
+    
+    // 唯一的工作线程被占住，之后提交的操作都留在队列里
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    manager.post([released] { released.wait(); });
+    
+    auto read_future = manager.read_file_async("/tmp/paker_test_async_io_missing", true);
+    std::weak_ptr<AsyncFileReadOperation> weak;
+    {
+        auto operation = std::make_shared<AsyncFileReadOperation>("/tmp/paker_test_async_io_missing", true);
+        operation->set_completion_callback([operation] {});
+        weak = operation;
+        manager.submit_operation(operation);
+    }
+    
+    manager.cancel_all_operations();
+    ASSERT_EQ(read_future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(read_future.get()->status, IOOperationStatus::CANCELLED);
+    // 回调里的自引用随取消一起释放
+    EXPECT_TRUE(weak.expired());
+    
+    release.set_value();
+    manager.shutdown();
+}
+
+TEST(AsyncIOQueueTest, ShutdownDrainsQueuedOperations) {
+    AsyncIOManager manager(1, 10);
+    manager.initialize();
+    
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    manager.post([released] { released.wait(); });
+    
+    std::vector<std::future<std::shared_ptr<FileReadResult>>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(manager.read_file_async("/tmp/paker_test_async_io_missing", true));
+    }
+    std::thread releaser([&release] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release.set_value();
+    });
+    manager.shutdown();
+    releaser.join();
+    
+    for (auto& future : futures) {
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+        EXPECT_EQ(future.get()->status, IOOperationStatus::FAILED);
+    }
 }
 
 // 性能测试
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/blob_store.h"
+#include <sys/stat.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class BlobStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_blob_store_test";
+        remove_tree(test_dir_);
+        store_root_ = (test_dir_ / ".store").string();
+
+        // 两个版本共享大部分文件，只有 version.h 不同
+        for (const std::string version : {"1.0.0", "1.1.0"}) {
+            fs::path dir = test_dir_ / "fmt" / version;
+            fs::create_directories(dir / "include" / "fmt");
+            fs::create_directories(dir / ".git");
+            write(dir / "include" / "fmt" / "core.h", std::string(4096, 'c'));
+            write(dir / "include" / "fmt" / "format.h", std::string(2048, 'f'));
+            write(dir / "include" / "fmt" / "version.h", "#define FMT_VERSION \"" + version + "\"\n");
+            write(dir / ".git" / "HEAD", "ref: refs/heads/master\n");
+        }
+    }
+
+    void TearDown() override {
+        remove_tree(test_dir_);
+    }
+
+    static void remove_tree(const fs::path& path) {
+        std::error_code ec;
+        for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+            if (!entry.is_symlink()) {
+                fs::permissions(entry.path(), fs::perms::owner_write, fs::perm_options::add, ec);
+            }
+        }
+        fs::remove_all(path, ec);
+    }
+
+    static void write(const fs::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    static std::string read_back(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    static struct stat stat_of(const fs::path& path) {
+        struct stat st {};
+        ::lstat(path.c_str(), &st);
+        return st;
+    }
+
+    std::string tree(const std::string& version) const {
+        return (test_dir_ / "fmt" / version).string();
+    }
+
+    std::string blob_of(BlobStore& store, const std::string& version, const std::string& path) {
+        for (const auto& entry : store.load_manifest("fmt", version)) {
+            if (entry.path == path) {
+                return entry.blob;
+            }
+        }
+        return "";
+    }
+
+    fs::path test_dir_;
+    std::string store_root_;
+};
+
+TEST_F(BlobStoreTest, SharedFilesAreStoredOnce) {
+    BlobStore store(store_root_);
+    BlobIngestResult first = store.ingest_tree("fmt", "1.0.0", tree("1.0.0"));
+    BlobIngestResult second = store.ingest_tree("fmt", "1.1.0", tree("1.1.0"));
+
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+    EXPECT_EQ(first.files, 3u);   // .git 不纳入
+    EXPECT_EQ(first.new_blobs, 3u);
+    EXPECT_EQ(second.new_blobs, 1u);
+    EXPECT_EQ(second.deduplicated, 2u);
+    EXPECT_EQ(second.bytes_reclaimed, 4096u + 2048u);
+
+    struct stat a = stat_of(test_dir_ / "fmt" / "1.0.0" / "include" / "fmt" / "core.h");
+    struct stat b = stat_of(test_dir_ / "fmt" / "1.1.0" / "include" / "fmt" / "core.h");
+    EXPECT_EQ(a.st_ino, b.st_ino);
+    // 默认不改动缓存文件的权限
+    EXPECT_NE(a.st_mode & S_IWUSR, 0u);
+    EXPECT_EQ(read_back(test_dir_ / "fmt" / "1.1.0" / "include" / "fmt" / "core.h"), std::string(4096, 'c'));
+    EXPECT_EQ(stat_of(test_dir_ / "fmt" / "1.1.0" / ".git" / "HEAD").st_nlink, 1u);
+
+    std::string core = blob_of(store, "1.0.0", "include/fmt/core.h");
+    ASSERT_EQ(core.size(), 64u);
+    EXPECT_EQ(store.get_refcount(core), 2u);
+
+    BlobStoreStats stats = store.get_stats();
+    EXPECT_EQ(stats.manifests, 2u);
+    EXPECT_EQ(stats.blobs, 4u);
+    EXPECT_EQ(stats.deduplicated_bytes(), 4096u + 2048u);
+}
+
+TEST_F(BlobStoreTest, ReadOnlyBlobsAreOptIn) {
+    BlobStore store(store_root_);
+    store.set_read_only_blobs(true);
+    ASSERT_TRUE(store.ingest_tree("fmt", "1.0.0", tree("1.0.0")).success);
+    EXPECT_EQ(stat_of(test_dir_ / "fmt" / "1.0.0" / "include" / "fmt" / "core.h").st_mode & 0222, 0u);
+}
+
+TEST_F(BlobStoreTest, TreeBytesExcludeExternallyRetainedBlobs) {
+    BlobStore store(store_root_);
+    ASSERT_TRUE(store.ingest_tree("fmt", "1.0.0", tree("1.0.0")).success);
+    std::vector<BlobManifestEntry> entries = store.load_manifest("fmt", "1.0.0");
+    ASSERT_TRUE(store.retain("/snapshots/a.json", entries));
+
+    BlobStoreStats stats = store.get_stats();
+    EXPECT_EQ(stats.tree_bytes, stats.stored_bytes);
+
+    // 版本释放后 blob 只由快照保留，淘汰版本不能再回收它们
+    ASSERT_TRUE(store.release_tree("fmt", "1.0.0"));
+    stats = store.get_stats();
+    EXPECT_GT(stats.stored_bytes, 0u);
+    EXPECT_EQ(stats.tree_bytes, 0u);
+
+    // 重新加载后按清单与引用重建的结果一致
+    BlobStore reloaded(store_root_);
+    EXPECT_EQ(reloaded.get_stats().tree_bytes, 0u);
+    EXPECT_EQ(reloaded.get_stats().stored_bytes, stats.stored_bytes);
+}
+
+TEST_F(BlobStoreTest, ReleaseAndGarbageCollection) {
+    BlobStore store(store_root_);
+    store.ingest_tree("fmt", "1.0.0", tree("1.0.0"));
+    store.ingest_tree("fmt", "1.1.0", tree("1.1.0"));
+
+    std::string shared = blob_of(store, "1.0.0", "include/fmt/core.h");
+    std::string exclusive = blob_of(store, "1.0.0", "include/fmt/version.h");
+    EXPECT_EQ(store.exclusive_bytes("fmt", "1.0.0"), std::string("#define FMT_VERSION \"1.0.0\"\n").size());
+
+    ASSERT_TRUE(store.release_tree("fmt", "1.0.0"));
+    EXPECT_FALSE(store.has_manifest("fmt", "1.0.0"));
+    EXPECT_EQ(store.get_refcount(shared), 1u);
+    EXPECT_EQ(store.get_refcount(exclusive), 0u);
+
+    // 版本目录尚未删除时，blob 仍有硬链接，不回收
+    EXPECT_EQ(store.collect_garbage(), 0u);
+    EXPECT_TRUE(fs::exists(store.blob_path(exclusive)));
+
+    remove_tree(tree("1.0.0"));
+    EXPECT_GT(store.collect_garbage(), 0u);
+    EXPECT_FALSE(fs::exists(store.blob_path(exclusive)));
+    EXPECT_TRUE(fs::exists(store.blob_path(shared)));
+    EXPECT_EQ(read_back(test_dir_ / "fmt" / "1.1.0" / "include" / "fmt" / "core.h"), std::string(4096, 'c'));
+}
+
+TEST_F(BlobStoreTest, RefcountsRebuiltFromManifests) {
+    {
+        BlobStore store(store_root_);
+        store.ingest_tree("fmt", "1.0.0", tree("1.0.0"));
+        store.ingest_tree("fmt", "1.1.0", tree("1.1.0"));
+        // 重复纳入同一版本不会重复计数
+        store.ingest_tree("fmt", "1.1.0", tree("1.1.0"));
+    }
+
+    BlobStore reopened(store_root_);
+    std::string core = blob_of(reopened, "1.1.0", "include/fmt/core.h");
+    EXPECT_EQ(reopened.get_refcount(core), 2u);
+    EXPECT_EQ(reopened.get_stats().manifests, 2u);
+
+    // 崩溃遗留、没有清单引用的 blob 只在全量回收时清理
+    std::string orphan = std::string(64, 'a');
+    fs::create_directories(fs::path(reopened.blob_path(orphan)).parent_path());
+    write(reopened.blob_path(orphan), "orphan");
+    EXPECT_EQ(reopened.collect_garbage(), 0u);
+    EXPECT_EQ(reopened.collect_garbage(true), 6u);
+    EXPECT_FALSE(fs::exists(reopened.blob_path(orphan)));
+}
+
+TEST_F(BlobStoreTest, GarbageCollectionSeesReferencesFromOtherInstances) {
+    // 长期存活的实例（如守护进程中的缓存管理器）先加载了引用计数
+    BlobStore long_lived(store_root_);
+    long_lived.ingest_tree("fmt", "1.0.0", tree("1.0.0"));
+    EXPECT_EQ(long_lived.get_stats().manifests, 1u);
+
+    // 另一个进程随后保存了快照对象，该 blob 只有一个链接
+    fs::path source = test_dir_ / "snapshot.txt";
+    write(source, "snapshot content");
+    std::string blob = BlobStore::hash_file(source.string());
+    BlobStore other(store_root_);
+    ASSERT_TRUE(other.retain("/project/.paker/backups/1.json", {{"snapshot.txt", blob, 16}}));
+    bool created = false;
+    ASSERT_TRUE(other.store_copy(source.string(), blob, created));
+    EXPECT_TRUE(created);
+    EXPECT_EQ(stat_of(other.blob_path(blob)).st_nlink, 1u);
+
+    EXPECT_EQ(long_lived.collect_garbage(true), 0u);
+    EXPECT_TRUE(fs::exists(long_lived.blob_path(blob)));
+    EXPECT_EQ(long_lived.get_refcount(blob), 1u);
+
+    ASSERT_TRUE(other.release("/project/.paker/backups/1.json"));
+    EXPECT_EQ(long_lived.collect_garbage(true), 16u);
+    EXPECT_FALSE(fs::exists(long_lived.blob_path(blob)));
+}
+
+TEST_F(BlobStoreTest, ExecutableFilesGetSeparateBlobs) {
+    fs::path script = test_dir_ / "fmt" / "1.1.0" / "include" / "fmt" / "format.h";
+    fs::permissions(script, fs::perms::owner_exec, fs::perm_options::add);
+
+    BlobStore store(store_root_);
+    store.ingest_tree("fmt", "1.0.0", tree("1.0.0"));
+    store.ingest_tree("fmt", "1.1.0", tree("1.1.0"));
+
+    std::string plain = blob_of(store, "1.0.0", "include/fmt/format.h");
+    std::string exec = blob_of(store, "1.1.0", "include/fmt/format.h");
+    EXPECT_EQ(exec, plain + "-x");
+    EXPECT_NE(stat_of(script).st_mode & S_IXUSR, 0u);
+    EXPECT_EQ(stat_of(test_dir_ / "fmt" / "1.0.0" / "include" / "fmt" / "format.h").st_mode & S_IXUSR, 0u);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/cache_lock.h"
+#include "Paker/cache/lru_cache_manager.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Paker;
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+class CacheLockTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_cache_lock_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    fs::path test_dir_;
+};
+
+TEST_F(CacheLockTest, FileLockModes) {
+    std::string path = (test_dir_ / "index.lock").string();
+    FileLock first;
+    FileLock second;
+    ASSERT_TRUE(first.lock(path, FileLock::Mode::SHARED));
+    EXPECT_TRUE(second.try_lock(path, FileLock::Mode::SHARED));
+    second.unlock();
+    EXPECT_FALSE(second.try_lock(path));
+
+    first.unlock();
+    EXPECT_TRUE(second.try_lock(path));
+    EXPECT_FALSE(first.try_lock(path, FileLock::Mode::SHARED));
+}
+
+TEST_F(CacheLockTest, SecondInstallerWaitsForFirst) {
+    std::string cache_path = (test_dir_ / "fmt" / "10.2.1").string();
+    InstallLock leader(cache_path);
+    ASSERT_TRUE(leader.acquire());
+    EXPECT_FALSE(leader.waited());
+
+    std::atomic<bool> finished{false};
+    std::atomic<bool> follower_waited{false};
+    std::thread follower([&] {
+        InstallLock lock(cache_path);
+        EXPECT_TRUE(lock.acquire());
+        follower_waited = lock.waited();
+        // 等待者拿到锁时领导者的结果必须已经写好
+        EXPECT_TRUE(fs::exists(cache_path));
+        finished = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(finished);
+    fs::create_directories(cache_path);
+    leader.release();
+    follower.join();
+    EXPECT_TRUE(follower_waited);
+}
+
+TEST_F(CacheLockTest, ConcurrentProcessesMergeIndexUpdates) {
+    std::string path = (test_dir_ / "cache_index.json").string();
+    constexpr int kProcesses = 4;
+    constexpr int kUpdates = 25;
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < kProcesses; ++p) {
+        pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            SharedIndexFile index(path);
+            for (int i = 0; i < kUpdates; ++i) {
+                std::string key = "pkg" + std::to_string(p) + "_" + std::to_string(i);
+                if (!index.commit([&key](json& data) { data[key] = {{"version", "1.0.0"}}; })) {
+                    ::_exit(1);
+                }
+            }
+            ::_exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    SharedIndexFile index(path);
+    json data;
+    uint64_t generation = 0;
+    ASSERT_TRUE(index.read(data, generation));
+    EXPECT_EQ(data.size(), static_cast<size_t>(kProcesses * kUpdates));
+    EXPECT_EQ(generation, static_cast<uint64_t>(kProcesses * kUpdates));
+    EXPECT_FALSE(index.changed());
+
+    ASSERT_TRUE(index.commit([](json& data) { data.erase("pkg0_0"); }));
+    EXPECT_EQ(index.get_generation(), generation + 1);
+    SharedIndexFile reader(path);
+    ASSERT_TRUE(reader.read(data, generation));
+    EXPECT_FALSE(data.contains("pkg0_0"));
+}
+
+TEST_F(CacheLockTest, LRUIndexKeepsOtherWritersItems) {
+    fs::create_directories(test_dir_ / "fmt-10.2.1");
+    fs::create_directories(test_dir_ / "zlib-1.3");
+    {
+        // 两个进程各自加载同一份索引，分别加入不同的包
+        LRUCacheManager first(test_dir_.string());
+        LRUCacheManager second(test_dir_.string());
+        ASSERT_TRUE(first.load_cache_index());
+        ASSERT_TRUE(second.load_cache_index());
+        ASSERT_TRUE(first.add_item("fmt", "10.2.1", (test_dir_ / "fmt-10.2.1").string()));
+        ASSERT_TRUE(second.add_item("zlib", "1.3", (test_dir_ / "zlib-1.3").string()));
+        ASSERT_TRUE(first.save_cache_index());
+        ASSERT_TRUE(second.save_cache_index());
+    }
+
+    LRUCacheManager reloaded(test_dir_.string());
+    ASSERT_TRUE(reloaded.load_cache_index());
+    EXPECT_TRUE(reloaded.has_item("fmt", "10.2.1"));
+    EXPECT_TRUE(reloaded.has_item("zlib", "1.3"));
+
+    // 删除同样只影响本进程删掉的项
+    ASSERT_TRUE(reloaded.remove_item("fmt", "10.2.1"));
+    ASSERT_TRUE(reloaded.save_cache_index());
+    LRUCacheManager after_remove(test_dir_.string());
+    ASSERT_TRUE(after_remove.load_cache_index());
+    EXPECT_FALSE(after_remove.has_item("fmt", "10.2.1"));
+    EXPECT_TRUE(after_remove.has_item("zlib", "1.3"));
+}
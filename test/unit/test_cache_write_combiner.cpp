@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/cache_write_combiner.h"
+#include "Paker/cache/async_cache_manager.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+} // namespace
+
+class CacheWriteCombinerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_write_combiner_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    fs::path test_dir_;
+};
+
+TEST_F(CacheWriteCombinerTest, CoalescesWritesIntoBatches) {
+    WriteCombinerConfig config;
+    config.max_delay = std::chrono::milliseconds(200);
+    config.max_batch_entries = 1000;
+    config.durable = true;
+    CacheWriteCombiner combiner(config);
+
+    std::atomic<size_t> succeeded{0};
+    std::atomic<size_t> bytes{0};
+    auto done = [&](bool ok, size_t written) {
+        succeeded += ok ? 1 : 0;
+        bytes += written;
+    };
+    for (int i = 0; i < 100; ++i) {
+        combiner.submit((test_dir_ / ("entry-" + std::to_string(i))).string(), "value " + std::to_string(i), done);
+    }
+    // 同一文件的多次写入只落盘最后一次，两个等待者都得到回调
+    combiner.submit((test_dir_ / "nested" / "index").string(), "first", done);
+    combiner.submit((test_dir_ / "nested" / "index").string(), "second", done);
+    combiner.flush();
+
+    EXPECT_EQ(succeeded, 102u);
+    EXPECT_EQ(read_file(test_dir_ / "entry-42"), "value 42");
+    EXPECT_EQ(read_file(test_dir_ / "nested" / "index"), "second");
+
+    WriteCombinerStats stats = combiner.get_stats();
+    EXPECT_EQ(stats.writes_submitted, 102u);
+    EXPECT_EQ(stats.writes_coalesced, 1u);
+    EXPECT_EQ(stats.files_written, 101u);
+    EXPECT_EQ(stats.batches, 1u);
+    EXPECT_EQ(stats.max_batch_size, 101u);
+    EXPECT_EQ(stats.durable_batches, 1u);
+    EXPECT_EQ(stats.files_flushed, 101u);
+    EXPECT_DOUBLE_EQ(stats.average_batch_size(), 101.0);
+}
+
+TEST_F(CacheWriteCombinerTest, FullBatchDoesNotWaitForWindow) {
+    WriteCombinerConfig config;
+    config.max_delay = std::chrono::seconds(30);
+    config.max_batch_entries = 4;
+    config.durable = false;
+    CacheWriteCombiner combiner(config);
+    EXPECT_TRUE(combiner.accepts(config.max_entry_size));
+    EXPECT_FALSE(combiner.accepts(config.max_entry_size + 1));
+
+    std::atomic<size_t> completed{0};
+    for (int i = 0; i < 4; ++i) {
+        combiner.submit((test_dir_ / std::to_string(i)).string(), "x", [&](bool ok, size_t) {
+            completed += ok ? 1 : 0;
+        });
+    }
+    for (int i = 0; i < 500 && completed < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(completed, 4u);
+    EXPECT_EQ(combiner.get_stats().durable_batches, 0u);
+    EXPECT_EQ(combiner.get_stats().files_flushed, 0u);
+
+    // 停止后的写入在调用线程上直接完成
+    combiner.stop();
+    bool ok = false;
+    combiner.submit((test_dir_ / "after-stop").string(), "late", [&](bool success, size_t) { ok = success; });
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(read_file(test_dir_ / "after-stop"), "late");
+}
+
+TEST_F(CacheWriteCombinerTest, AsyncCacheManagerBatchesSmallWrites) {
+    AsyncIOManager io_manager(2, 10);
+    io_manager.initialize();
+    {
+        AsyncCacheManager cache(&io_manager);
+        ASSERT_TRUE(cache.initialize());
+        cache.set_cache_directory((test_dir_ / "cache").string());
+        WriteCombinerConfig config;
+        config.max_delay = std::chrono::milliseconds(100);
+        cache.set_write_combiner_config(config);
+
+        std::vector<std::pair<std::string, std::string>> entries;
+        for (int i = 0; i < 64; ++i) {
+            entries.emplace_back("pkg-" + std::to_string(i), std::string(128, static_cast<char>('a' + i % 26)));
+        }
+        auto futures = cache.write_multiple_cache_async(entries);
+        for (auto& future : futures) {
+            auto result = future.get();
+            ASSERT_TRUE(result->success);
+            EXPECT_EQ(result->bytes_written, 128u);
+        }
+
+        auto read = cache.read_cache_async("pkg-3").get();
+        ASSERT_TRUE(read->success);
+        EXPECT_EQ(read->content, std::string(128, 'd'));
+
+        WriteCombinerStats stats = cache.get_write_combiner_stats();
+        EXPECT_EQ(stats.files_written, 64u);
+        EXPECT_LE(stats.batches, 2u);
+        EXPECT_EQ(cache.get_total_writes(), 64u);
+        EXPECT_NE(cache.get_performance_report().find("Write combining: enabled"), std::string::npos);
+
+        // 关闭合并后写入回到单文件路径
+        config.enabled = false;
+        cache.set_write_combiner_config(config);
+        ASSERT_TRUE(cache.write_cache_async("direct", std::string("payload")).get()->success);
+        EXPECT_EQ(cache.get_write_combiner_stats().writes_submitted, 64u);
+    }
+    io_manager.shutdown();
+}
+
+TEST_F(CacheWriteCombinerTest, FlushFromCallbackDoesNotDeadlock) {
+    WriteCombinerConfig config;
+    config.max_delay = std::chrono::milliseconds(5);
+    CacheWriteCombiner combiner(config);
+
+    // 回调里再提交一次并刷盘：后台线程不能等自己
+    std::atomic<bool> nested_done{false};
+    std::atomic<bool> outer_done{false};
+    combiner.submit((test_dir_ / "outer").string(), "outer", [&](bool, size_t) {
+        combiner.submit((test_dir_ / "inner").string(), "inner", [&](bool ok, size_t) { nested_done = ok; });
+        combiner.flush();
+        outer_done = true;
+    });
+    combiner.flush();
+
+    EXPECT_TRUE(outer_done);
+    EXPECT_TRUE(nested_done);
+    EXPECT_EQ(read_file(test_dir_ / "inner"), "inner");
+}
+
+TEST_F(CacheWriteCombinerTest, AsyncCacheManagerRecreatesCombinerAfterShutdown) {
+    AsyncIOManager io_manager(2, 10);
+    io_manager.initialize();
+    {
+        AsyncCacheManager cache(&io_manager);
+        ASSERT_TRUE(cache.initialize());
+        cache.set_cache_directory((test_dir_ / "cache").string());
+        cache.shutdown();
+        ASSERT_TRUE(cache.initialize());
+
+        ASSERT_TRUE(cache.write_cache_async("again", std::string("payload")).get()->success);
+        EXPECT_EQ(cache.get_write_combiner_stats().writes_submitted, 1u);
+    }
+    io_manager.shutdown();
+}
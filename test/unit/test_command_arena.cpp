@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "Paker/core/command_arena.h"
+#include "Paker/conflict/conflict_detector.h"
+#include "Paker/dependency/dependency_resolver.h"
+#include "Paker/dependency/version_manager.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Paker;
+
+TEST(CommandArenaTest, CountsAllocationsAndPeak) {
+    CommandArena arena("test", 4096);
+    auto before = arena.get_stats();
+    EXPECT_EQ(before.allocation_count, 0u);
+    EXPECT_EQ(before.upstream_allocations, 0u);
+
+    std::pmr::vector<std::pmr::string> names(arena.resource());
+    for (int i = 0; i < 500; ++i) {
+        names.emplace_back("dependency-with-a-long-enough-name-" + std::to_string(i));
+    }
+
+    auto stats = arena.get_stats();
+    EXPECT_GE(stats.allocation_count, 500u);
+    EXPECT_GT(stats.bytes_requested, 500u * 32);
+    // 单调 arena 按几何增长向上游申请，块数远小于分配次数
+    EXPECT_GE(stats.peak_bytes, stats.bytes_requested);
+    EXPECT_LT(stats.upstream_allocations, 20u);
+}
+
+TEST(CommandArenaTest, ScopesNestAndRestore) {
+    EXPECT_EQ(current_arena(), nullptr);
+    EXPECT_EQ(current_arena_resource(), std::pmr::get_default_resource());
+
+    CommandArena outer("outer");
+    {
+        ArenaScope outer_scope(outer);
+        EXPECT_EQ(current_arena(), &outer);
+        {
+            CommandArena inner("inner");
+            ArenaScope inner_scope(inner);
+            EXPECT_EQ(current_arena(), &inner);
+            EXPECT_EQ(current_arena_resource(), inner.resource());
+        }
+        EXPECT_EQ(current_arena(), &outer);
+
+        // arena 只对当前线程生效
+        CommandArena* seen = &outer;
+        std::thread([&]() { seen = current_arena(); }).join();
+        EXPECT_EQ(seen, nullptr);
+    }
+    EXPECT_EQ(current_arena(), nullptr);
+}
+
+TEST(CommandArenaTest, ConflictDetectionUsesArena) {
+    DependencyGraph graph;
+    graph.add_node(DependencyNode("app"));
+    graph.add_node(DependencyNode("net"));
+    graph.add_node(DependencyNode("db"));
+    graph.add_node(DependencyNode("core"));
+    graph.add_dependency("app", "net");
+    graph.add_dependency("app", "db");
+    graph.add_dependency("net", "core");
+    graph.add_dependency("db", "core");
+    graph.get_node("net")->version_constraints["core"] = VersionConstraint::parse("1.0.0");
+    graph.get_node("db")->version_constraints["core"] = VersionConstraint::parse("2.0.0");
+
+    std::vector<ConflictInfo> without_arena = ConflictDetector(graph).detect_version_conflicts();
+
+    CommandArena arena("check");
+    std::vector<ConflictInfo> with_arena;
+    {
+        ArenaScope scope(arena);
+        with_arena = ConflictDetector(graph).detect_version_conflicts();
+    }
+
+    ASSERT_EQ(with_arena.size(), 1u);
+    ASSERT_EQ(without_arena.size(), 1u);
+    EXPECT_EQ(with_arena[0].conflicting_versions, without_arena[0].conflicting_versions);
+    EXPECT_EQ(with_arena[0].explanation_paths, without_arena[0].explanation_paths);
+    EXPECT_GT(arena.get_stats().allocation_count, 0u);
+}
+
+TEST(CommandArenaTest, ResolverPassUsesArena) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "paker_command_arena_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "packages" / "net");
+    std::ofstream(dir / "Paker.json") << R"({"dependencies": {"net": "1.0.0"}})";
+    std::ofstream(dir / "packages" / "net" / "CMakeLists.txt")
+        << "cmake_minimum_required(VERSION 3.10)  # build\n"
+        << "find_package(OpenSSL REQUIRED)\n";
+
+    fs::path previous = fs::current_path();
+    fs::current_path(dir);
+    CommandArena arena("resolve");
+    DependencyResolver resolver;
+    bool resolved = false;
+    {
+        ArenaScope scope(arena);
+        resolved = resolver.resolve_project_dependencies();
+    }
+    fs::current_path(previous);
+
+    ASSERT_TRUE(resolved);
+    // 指纹、CMake 行缓冲等临时数据走 arena，依赖图本身不受影响
+    const DependencyNode* net = resolver.get_dependency_graph().get_node("net");
+    ASSERT_NE(net, nullptr);
+    EXPECT_EQ(net->dependencies.count("OpenSSL"), 1u);
+    EXPECT_GT(arena.get_stats().allocation_count, 0u);
+    fs::remove_all(dir);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#if defined(PAKER_HAVE_COROUTINES)
+
+#include "Paker/core/async_io.h"
+#include "Paker/cache/async_cache_manager.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+task<int> constant(int value) {
+    co_return value;
+}
+
+task<int> add(int a, int b) {
+    int x = co_await constant(a);
+    int y = co_await constant(b);
+    co_return x + y;
+}
+
+task<int> fail() {
+    co_await constant(0);
+    throw std::runtime_error("boom");
+}
+
+// 切换到工作线程后等待一段时间再返回
+task<int> delayed(IOExecutor& executor, int value, std::chrono::milliseconds delay) {
+    co_await executor.schedule();
+    std::this_thread::sleep_for(delay);
+    co_return value;
+}
+
+} // namespace
+
+class CoroutineTaskTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_coroutine_task_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+        io_manager_ = std::make_unique<AsyncIOManager>(4, 10);
+        io_manager_->initialize();
+    }
+
+    void TearDown() override {
+        io_manager_->shutdown();
+        fs::remove_all(test_dir_);
+    }
+
+    fs::path test_dir_;
+    std::unique_ptr<AsyncIOManager> io_manager_;
+};
+
+TEST_F(CoroutineTaskTest, TasksComposeAndPropagateExceptions) {
+    EXPECT_EQ(sync_wait(add(2, 3)), 5);
+    EXPECT_THROW(sync_wait(fail()), std::runtime_error);
+
+    // 任务是惰性的，销毁未等待的任务不会执行它
+    std::atomic<bool> started{false};
+    {
+        auto lazy = [&started]() -> task<void> {
+            started = true;
+            co_return;
+        }();
+        EXPECT_FALSE(lazy.done());
+    }
+    EXPECT_FALSE(started);
+}
+
+TEST_F(CoroutineTaskTest, WhenAllAndWhenAnyRunOnExecutor) {
+    IOExecutor executor(*io_manager_);
+
+    std::vector<task<int>> all;
+    for (int i = 0; i < 8; ++i) {
+        all.push_back(delayed(executor, i, std::chrono::milliseconds(5)));
+    }
+    std::vector<int> values = sync_wait(when_all(std::move(all)));
+    ASSERT_EQ(values.size(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(values[i], i);
+    }
+    EXPECT_TRUE(sync_wait(when_all(std::vector<task<int>>{})).empty());
+
+    std::vector<task<int>> failing;
+    failing.push_back(constant(1));
+    failing.push_back(fail());
+    EXPECT_THROW(sync_wait(when_all(std::move(failing))), std::runtime_error);
+
+    std::vector<task<int>> race;
+    race.push_back(delayed(executor, 1, std::chrono::milliseconds(300)));
+    race.push_back(delayed(executor, 2, std::chrono::milliseconds(1)));
+    auto [index, value] = sync_wait(when_any(std::move(race)));
+    EXPECT_EQ(index, 1u);
+    EXPECT_EQ(value, 2);
+
+    std::atomic<int> spawned{0};
+    for (int i = 0; i < 4; ++i) {
+        executor.spawn([](IOExecutor& executor, std::atomic<int>& counter) -> task<void> {
+            co_await executor.schedule();
+            counter++;
+        }(executor, spawned));
+    }
+    for (int i = 0; i < 200 && spawned < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(spawned, 4);
+    // 等待 when_any 中输掉的任务结束后再关闭管理器
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+}
+
+TEST_F(CoroutineTaskTest, FileAndCacheOperations) {
+    std::string path = (test_dir_ / "nested" / "file.txt").string();
+    auto written = sync_wait(io_manager_->write_file_task(path, "hello coroutine"));
+    ASSERT_TRUE(written);
+    EXPECT_EQ(written->status, IOOperationStatus::COMPLETED);
+    EXPECT_EQ(written->bytes_written, 15u);
+
+    auto read = sync_wait(io_manager_->read_file_task(path));
+    ASSERT_TRUE(read);
+    EXPECT_EQ(read->status, IOOperationStatus::COMPLETED);
+    EXPECT_EQ(read->content, "hello coroutine");
+
+    auto missing = sync_wait(io_manager_->read_file_task((test_dir_ / "missing").string()));
+    EXPECT_EQ(missing->status, IOOperationStatus::FAILED);
+
+    // 旧的 future 接口同样由完成回调兑现
+    auto future = io_manager_->read_file_async(path);
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(future.get()->content, "hello coroutine");
+
+    AsyncCacheManager cache(io_manager_.get());
+    ASSERT_TRUE(cache.initialize());
+    cache.set_cache_directory((test_dir_ / "cache").string());
+    auto stored = sync_wait(cache.write_cache_task("fmt-10.2.1", "cached payload"));
+    ASSERT_TRUE(stored->success);
+
+    auto results = sync_wait(cache.read_multiple_cache_task({"fmt-10.2.1", "absent"}));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_TRUE(results[0]->success);
+    EXPECT_EQ(results[0]->content, "cached payload");
+    EXPECT_FALSE(results[1]->success);
+    EXPECT_EQ(cache.get_cache_hits(), 1u);
+    EXPECT_EQ(cache.get_cache_misses(), 1u);
+}
+
+#endif // PAKER_HAVE_COROUTINES
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include "Paker/dependency/reachability_index.h"
+#include <algorithm>
+#include <thread>
+
+using namespace Paker;
+
+class CSRDependencyGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // a -> b -> d, a -> c -> d
+        for (const auto* name : {"a", "b", "c", "d"}) {
+            graph_.add_node(DependencyNode(name, "1.0.0"));
+        }
+        graph_.add_dependency("a", "b");
+        graph_.add_dependency("a", "c");
+        graph_.add_dependency("b", "d");
+        graph_.add_dependency("c", "d");
+    }
+
+    DependencyGraph graph_;
+};
+
+TEST_F(CSRDependencyGraphTest, BuildFromDependencyGraph) {
+    auto csr = CSRDependencyGraph::from_graph(graph_);
+
+    EXPECT_EQ(csr.node_count(), 4);
+    EXPECT_EQ(csr.edge_count(), 4);
+
+    auto a = csr.find("a");
+    auto d = csr.find("d");
+    ASSERT_NE(a, CSRDependencyGraph::INVALID_NODE);
+    ASSERT_NE(d, CSRDependencyGraph::INVALID_NODE);
+    EXPECT_EQ(csr.name(a), "a");
+    EXPECT_EQ(csr.out_degree(a), 2);
+    EXPECT_EQ(csr.in_degree(d), 2);
+    EXPECT_EQ(csr.find("missing"), CSRDependencyGraph::INVALID_NODE);
+}
+
+TEST_F(CSRDependencyGraphTest, TopologicalSortMatchesGraph) {
+    auto order = graph_.topological_sort();
+    ASSERT_EQ(order.size(), 4);
+    EXPECT_EQ(order.front(), "a");
+    EXPECT_EQ(order.back(), "d");
+}
+
+TEST_F(CSRDependencyGraphTest, CycleDetection) {
+    EXPECT_TRUE(graph_.detect_cycles().empty());
+
+    graph_.add_dependency("d", "a");
+    auto cycles = graph_.detect_cycles();
+    ASSERT_FALSE(cycles.empty());
+    EXPECT_EQ(cycles[0].front(), cycles[0].back());
+}
+
+TEST_F(CSRDependencyGraphTest, PathsAndReachability) {
+    auto paths = graph_.get_all_paths("a", "d");
+    EXPECT_EQ(paths.size(), 2);
+
+    auto csr = graph_.freeze();
+    auto limited = csr->find_paths(csr->find("a"), csr->find("d"), 1);
+    EXPECT_EQ(limited.size(), 1);
+
+    auto dependents = csr->to_names(csr->reachable_to(csr->find("d")));
+    std::sort(dependents.begin(), dependents.end());
+    EXPECT_EQ(dependents, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST_F(CSRDependencyGraphTest, FreezeIsCachedUntilGraphChanges) {
+    auto first = graph_.freeze();
+    EXPECT_EQ(first, graph_.freeze());
+
+    graph_.add_node(DependencyNode("e", "1.0.0"));
+    auto second = graph_.freeze();
+    EXPECT_NE(first, second);
+    EXPECT_EQ(second->node_count(), 5);
+}
+
+TEST_F(CSRDependencyGraphTest, ConcurrentFreezeSharesOneSnapshot) {
+    std::vector<std::shared_ptr<const CSRDependencyGraph>> snapshots(8);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        readers.emplace_back([this, &snapshots, i] { snapshots[i] = graph_.freeze(); });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (const auto& snapshot : snapshots) {
+        EXPECT_EQ(snapshot, snapshots.front());
+    }
+}
+
+TEST_F(CSRDependencyGraphTest, ConcurrentReadersShareOptimizedGraphCaches) {
+    OptimizedDependencyGraph optimized;
+    for (const auto* name : {"app", "net", "old", "json", "core"}) {
+        optimized.add_node(LightweightDependencyNode(name));
+    }
+    optimized.add_dependency("app", "net");
+    optimized.add_dependency("app", "json");
+    optimized.add_dependency("net", "old");
+    optimized.add_dependency("json", "core");
+    optimized.add_dependency("net", "core");
+    // 删除节点使拓扑序失效，由第一个读者重建
+    optimized.remove_node("old");
+
+    const OptimizedDependencyGraph& reader_view = optimized;
+    std::vector<std::shared_ptr<const CSRDependencyGraph>> snapshots(8);
+    std::vector<std::shared_ptr<const ReachabilityIndex>> indexes(8);
+    std::vector<std::vector<std::string>> orders(8);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        readers.emplace_back([&, i] {
+            snapshots[i] = reader_view.freeze();
+            indexes[i] = reader_view.reachability_index();
+            orders[i] = reader_view.topological_sort();
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        EXPECT_EQ(snapshots[i], snapshots.front());
+        EXPECT_EQ(indexes[i], indexes.front());
+        EXPECT_EQ(orders[i], orders.front());
+    }
+    EXPECT_EQ(orders.front().size(), 4);
+    EXPECT_TRUE(optimized.depends_on("app", "core"));
+}
+
+TEST_F(CSRDependencyGraphTest, BuildFromOptimizedGraph) {
+    OptimizedDependencyGraph optimized;
+    optimized.add_node(LightweightDependencyNode("x"));
+    optimized.add_node(LightweightDependencyNode("y"));
+    optimized.add_node(LightweightDependencyNode("z"));
+    optimized.add_dependency("x", "y");
+    optimized.add_dependency("y", "z");
+
+    auto csr = optimized.freeze();
+    EXPECT_EQ(csr->node_count(), 3);
+    EXPECT_EQ(csr->find("y"), 1u);
+    EXPECT_EQ(optimized.topological_sort(), (std::vector<std::string>{"x", "y", "z"}));
+
+    optimized.remove_dependency("x", "y");
+    EXPECT_EQ(optimized.freeze()->edge_count(), 1);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "Paker/core/daemon.h"
+#include "Paker/commands/daemon.h"
+#include "Paker/core/version_history.h"
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_fd(int fd) {
+    std::string data;
+    char buffer[256];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    return data;
+}
+
+} // namespace
+
+class DaemonTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("paker_daemon_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_ / "project");
+        socket_path_ = (dir_ / "daemon.sock").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir_);
+    }
+
+    fs::path dir_;
+    std::string socket_path_;
+};
+
+TEST_F(DaemonTest, ForwardsCommandsAndStreamsOutput) {
+    DaemonServer server([](const std::vector<std::string>& args) {
+        std::cout << "cwd=" << fs::current_path().filename().string();
+        for (const auto& arg : args) {
+            std::cout << " " << arg;
+        }
+        std::cout << std::endl;
+        std::cerr << "warning" << std::endl;
+        return args.size() == 2 ? 7 : 0;
+    }, socket_path_);
+    ASSERT_TRUE(server.bind());
+
+    // 同一路径上不能启动第二个实例
+    DaemonServer second([](const std::vector<std::string>&) { return 0; }, socket_path_);
+    EXPECT_FALSE(second.bind());
+
+    std::thread worker([&server]() { server.run(); });
+
+    int out_pipe[2], err_pipe[2];
+    ASSERT_EQ(::pipe(out_pipe), 0);
+    ASSERT_EQ(::pipe(err_pipe), 0);
+    int null_fd = ::open("/dev/null", O_RDONLY);
+
+    auto previous = fs::current_path();
+    fs::current_path(dir_ / "project");
+    DaemonClient client(socket_path_);
+    int exit_code = -1;
+    bool forwarded = client.forward({"list", "--all"}, exit_code, null_fd, out_pipe[1], err_pipe[1]);
+    fs::current_path(previous);
+
+    ::close(out_pipe[1]);
+    ::close(err_pipe[1]);
+    ::close(null_fd);
+    EXPECT_TRUE(forwarded);
+    EXPECT_EQ(exit_code, 7);
+    EXPECT_EQ(read_fd(out_pipe[0]), "cwd=project list --all\n");
+    EXPECT_EQ(read_fd(err_pipe[0]), "warning\n");
+    ::close(out_pipe[0]);
+    ::close(err_pipe[0]);
+
+    auto status = client.status();
+    EXPECT_TRUE(status.running);
+    EXPECT_EQ(status.pid, ::getpid());
+    EXPECT_EQ(status.requests_served, 1);
+
+    EXPECT_TRUE(client.stop());
+    worker.join();
+    EXPECT_FALSE(fs::exists(socket_path_));
+    EXPECT_FALSE(client.is_available());
+}
+
+TEST_F(DaemonTest, FallsBackWhenDaemonIsNotRunning) {
+    DaemonClient client(socket_path_);
+    int exit_code = -1;
+    EXPECT_FALSE(client.is_available());
+    EXPECT_FALSE(client.forward({"list"}, exit_code));
+    EXPECT_EQ(exit_code, -1);
+    EXPECT_FALSE(client.status().running);
+}
+
+TEST_F(DaemonTest, IgnoresSocketInSharedDirectory) {
+    // 其他用户可写的目录中的套接字可能由他人创建，客户端不得连接
+    fs::path shared = dir_ / "shared";
+    fs::create_directories(shared);
+    fs::permissions(shared, fs::perms::all);
+    std::string path = (shared / "daemon.sock").string();
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+
+    DaemonClient client(path);
+    int exit_code = -1;
+    EXPECT_FALSE(client.is_available());
+    EXPECT_FALSE(client.forward({"list"}, exit_code));
+    EXPECT_EQ(exit_code, -1);
+    ::close(listener);
+}
+
+TEST_F(DaemonTest, SwitchingProjectsReopensHistory) {
+    // 守护进程先后服务两个工程：历史管理器必须随工作目录切换，不能读写前一个工程的日志
+    fs::create_directories(dir_ / "other");
+    auto previous = fs::current_path();
+
+    fs::current_path(dir_ / "project");
+    prepare_daemon_project_services();
+    ASSERT_TRUE(get_history_manager()->record_version_change("fmt", "", "9.1.0",
+                                                             "https://github.com/fmtlib/fmt.git"));
+    EXPECT_EQ(get_history_manager()->get_package_history("fmt").size(), 1u);
+
+    fs::current_path(dir_ / "other");
+    prepare_daemon_project_services();
+    EXPECT_TRUE(get_history_manager()->get_package_history("fmt").empty());
+    ASSERT_TRUE(get_history_manager()->record_version_change("spdlog", "", "1.12.0",
+                                                             "https://github.com/gabime/spdlog.git"));
+
+    fs::current_path(dir_ / "project");
+    prepare_daemon_project_services();
+    EXPECT_EQ(get_history_manager()->get_package_history("fmt").size(), 1u);
+    EXPECT_TRUE(get_history_manager()->get_package_history("spdlog").empty());
+
+    fs::current_path(previous);
+    cleanup_history_manager();
+    EXPECT_TRUE(fs::exists(dir_ / "project" / ".paker" / "history"));
+    EXPECT_TRUE(fs::exists(dir_ / "other" / ".paker" / "history"));
+}
+
+TEST(DaemonClientTest, ShouldForward) {
+    auto check = [](std::vector<std::string> args) {
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(&arg[0]);
+        return DaemonClient::should_forward(static_cast<int>(argv.size()), argv.data());
+    };
+    EXPECT_TRUE(check({"paker", "list"}));
+    EXPECT_TRUE(check({"paker", "--no-color", "tree"}));
+    EXPECT_FALSE(check({"paker"}));
+    EXPECT_FALSE(check({"paker", "--version"}));
+    EXPECT_FALSE(check({"paker", "daemon", "stop"}));
+    EXPECT_FALSE(check({"paker", "parse", "--watch"}));
+}
+
+TEST_F(DaemonTest, ForwardsClientEnvironmentPerRequest) {
+    // 守护进程在子进程中运行，环境与客户端分离
+    ::setenv("PAKER_IO_BACKEND", "daemon-value", 1);
+    pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        DaemonServer server([](const std::vector<std::string>&) {
+            const char* backend = std::getenv("PAKER_IO_BACKEND");
+            std::cout << (backend ? backend : "(unset)") << std::endl;
+            return 0;
+        }, socket_path_);
+        if (!server.bind()) {
+            ::_exit(1);
+        }
+        server.run();
+        ::_exit(0);
+    }
+
+    DaemonClient client(socket_path_);
+    for (int i = 0; i < 200 && !client.is_available(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(client.is_available());
+
+    auto run = [&client]() {
+        int out_pipe[2];
+        EXPECT_EQ(::pipe(out_pipe), 0);
+        int null_fd = ::open("/dev/null", O_RDWR);
+        int exit_code = -1;
+        EXPECT_TRUE(client.forward({"env"}, exit_code, null_fd, out_pipe[1], null_fd));
+        ::close(out_pipe[1]);
+        ::close(null_fd);
+        std::string output = read_fd(out_pipe[0]);
+        ::close(out_pipe[0]);
+        return output;
+    };
+
+    ::setenv("PAKER_IO_BACKEND", "client-value", 1);
+    EXPECT_EQ(run(), "client-value\n");
+    // 客户端未设置的变量在命令执行期间同样不存在，之后恢复守护进程自己的值
+    ::unsetenv("PAKER_IO_BACKEND");
+    EXPECT_EQ(run(), "(unset)\n");
+
+    EXPECT_TRUE(client.stop());
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
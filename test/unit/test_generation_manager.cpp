@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/generation_manager.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class GenerationManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_generation_manager_test";
+        fs::remove_all(test_dir_);
+        project_ = test_dir_ / "project";
+        fs::create_directories(project_ / ".paker");
+        for (const std::string version : {"1.0.0", "2.0.0"}) {
+            fs::create_directories(cached(version));
+            std::ofstream(fs::path(cached(version)) / "version.h") << version;
+        }
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    std::string cached(const std::string& version) const {
+        return (test_dir_ / "cache" / "fmt" / version).string();
+    }
+
+    std::string linked_version() const {
+        std::ifstream file(project_ / ".paker" / "links" / "fmt" / "version.h");
+        std::string version;
+        file >> version;
+        return version;
+    }
+
+    fs::path test_dir_;
+    fs::path project_;
+};
+
+TEST_F(GenerationManagerTest, MigratesLegacyLinksDirectory) {
+    fs::path links = project_ / ".paker" / "links";
+    fs::create_directories(links / "spdlog");
+    std::ofstream(links / "spdlog" / "spdlog.h") << "materialized";
+    fs::create_directory_symlink(cached("1.0.0"), links / "fmt");
+
+    GenerationManager generations(project_.string());
+    ASSERT_TRUE(generations.ensure_initialized());
+    EXPECT_TRUE(fs::is_symlink(links));
+    EXPECT_EQ(generations.current(), 1u);
+    EXPECT_EQ(linked_version(), "1.0.0");
+    EXPECT_TRUE(fs::exists(links / "spdlog" / "spdlog.h"));
+
+    Generation first;
+    ASSERT_TRUE(generations.load(1, first));
+    EXPECT_EQ(first.packages["fmt"].version, "1.0.0");
+    EXPECT_EQ(first.packages["spdlog"].target, generations.tree_path("spdlog", "migrated"));
+}
+
+TEST_F(GenerationManagerTest, UpgradeAndRollbackAreAtomicSwitches) {
+    GenerationManager generations(project_.string());
+    uint64_t old_generation = generations.create_generation({{"fmt", {"1.0.0", cached("1.0.0")}}}, {}, "install");
+    ASSERT_NE(old_generation, 0u);
+    ASSERT_TRUE(generations.switch_to(old_generation).success);
+    EXPECT_EQ(linked_version(), "1.0.0");
+
+    uint64_t new_generation = generations.create_generation({{"fmt", {"2.0.0", cached("2.0.0")}}}, {}, "upgrade");
+    ASSERT_GT(new_generation, old_generation);
+    // 新一代建好但未切换前，工程仍看到旧版本
+    EXPECT_EQ(linked_version(), "1.0.0");
+    GenerationSwitchResult upgraded = generations.switch_to(new_generation);
+    ASSERT_TRUE(upgraded.success);
+    EXPECT_EQ(upgraded.from, old_generation);
+    EXPECT_EQ(linked_version(), "2.0.0");
+
+    EXPECT_EQ(generations.find_generation_with("fmt", "1.0.0"), old_generation);
+    GenerationSwitchResult rolled_back = generations.switch_to(old_generation);
+    ASSERT_TRUE(rolled_back.success);
+    EXPECT_LT(rolled_back.switch_latency.count(), 1000000);
+    EXPECT_EQ(linked_version(), "1.0.0");
+
+    // 切换到不存在的代失败，当前代不变
+    EXPECT_FALSE(generations.switch_to(999).success);
+    EXPECT_EQ(generations.current(), old_generation);
+    EXPECT_FALSE(fs::exists(project_ / ".paker" / "links.next"));
+}
+
+TEST_F(GenerationManagerTest, GarbageCollectionKeepsCurrentAndPrevious) {
+    GenerationManager generations(project_.string());
+    fs::create_directories(generations.tree_path("fmt", "1.0.0"));
+    uint64_t id = 0;
+    for (int i = 0; i < 6; ++i) {
+        std::string version = i % 2 ? "2.0.0" : "1.0.0";
+        std::string target = i == 0 ? generations.tree_path("fmt", "1.0.0") : cached(version);
+        id = generations.create_generation({{"fmt", {version, target}}}, {}, "step " + std::to_string(i));
+        ASSERT_TRUE(generations.switch_to(id).success);
+    }
+    uint64_t previous = id - 1;
+    ASSERT_TRUE(generations.switch_to(previous).success);
+
+    GenerationRetention retention;
+    retention.keep_last = 1;
+    EXPECT_GT(generations.collect_garbage(retention), 0u);
+
+    std::vector<Generation> remaining = generations.list();
+    ASSERT_EQ(remaining.size(), 3u);   // 最新一代、当前代及其上一代
+    EXPECT_EQ(remaining.back().id, id);
+    EXPECT_EQ(generations.current(), previous);
+    EXPECT_FALSE(fs::exists(generations.generation_path(1)));
+    EXPECT_FALSE(fs::exists(generations.tree_path("fmt", "1.0.0")));
+    EXPECT_EQ(linked_version(), "1.0.0");
+}
+
+TEST_F(GenerationManagerTest, PolicyChangeUsesNewTree) {
+    GenerationManager generations(project_.string());
+    std::string copied = generations.tree_path("fmt", "1.0.0", "copy");
+    std::string hardlinked = generations.tree_path("fmt", "1.0.0", "hardlink");
+    EXPECT_NE(copied, hardlinked);
+    EXPECT_NE(copied, generations.tree_path("fmt", "1.0.0"));
+
+    // 按旧策略物化的目录在切到新策略后不再被引用，随垃圾回收删除
+    fs::create_directories(copied);
+    fs::create_directories(hardlinked);
+    uint64_t first = generations.create_generation({{"fmt", {"1.0.0", copied}}}, {}, "copy");
+    ASSERT_TRUE(generations.switch_to(first).success);
+    uint64_t second = generations.create_generation({{"fmt", {"1.0.0", hardlinked}}}, {}, "hardlink");
+    ASSERT_TRUE(generations.switch_to(second).success);
+    uint64_t third = generations.create_generation({{"zlib", {"2.0.0", cached("2.0.0")}}}, {}, "add zlib");
+    ASSERT_TRUE(generations.switch_to(third).success);
+    EXPECT_TRUE(fs::exists(copied));
+
+    GenerationRetention retention;
+    retention.keep_last = 1;
+    EXPECT_GT(generations.collect_garbage(retention), 0u);
+    EXPECT_FALSE(fs::exists(copied));
+    EXPECT_TRUE(fs::exists(hardlinked));
+}
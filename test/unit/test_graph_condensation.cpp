@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/graph_condensation.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/conflict/conflict_detector.h"
+
+using namespace Paker;
+
+namespace {
+
+// 构建 layers 层菱形链：每层两个节点，都依赖下一层的两个节点
+// 根到底部的路径数为 2^layers
+CSRDependencyGraph build_diamond_chain(size_t layers) {
+    CSRGraphBuilder builder;
+    builder.add_node("root");
+    std::vector<std::string> previous{"root"};
+    for (size_t i = 0; i < layers; ++i) {
+        std::vector<std::string> current{"l" + std::to_string(i) + "a", "l" + std::to_string(i) + "b"};
+        for (const auto& from : previous) {
+            for (const auto& to : current) {
+                builder.add_edge(from, to);
+            }
+        }
+        previous = current;
+    }
+    for (const auto& from : previous) {
+        builder.add_edge(from, "leaf");
+    }
+    return builder.build();
+}
+
+} // namespace
+
+TEST(GraphCondensationTest, StronglyConnectedComponents) {
+    // a -> b -> c -> a, c -> d, d -> d
+    CSRGraphBuilder builder;
+    builder.add_edge("a", "b");
+    builder.add_edge("b", "c");
+    builder.add_edge("c", "a");
+    builder.add_edge("c", "d");
+    builder.add_edge("d", "d");
+    builder.add_node("e");
+    auto csr = builder.build();
+
+    GraphCondensation condensation(csr);
+    EXPECT_EQ(condensation.component_count(), 3);
+    EXPECT_EQ(condensation.component_of(csr.find("a")), condensation.component_of(csr.find("c")));
+    EXPECT_NE(condensation.component_of(csr.find("a")), condensation.component_of(csr.find("d")));
+    EXPECT_TRUE(condensation.is_cyclic(condensation.component_of(csr.find("d"))));
+    EXPECT_FALSE(condensation.is_cyclic(condensation.component_of(csr.find("e"))));
+    EXPECT_EQ(condensation.cyclic_components().size(), 2);
+
+    // 依赖方向上分量编号递减
+    EXPECT_LT(condensation.component_of(csr.find("d")), condensation.component_of(csr.find("a")));
+
+    auto cycle = condensation.representative_cycle(condensation.component_of(csr.find("a")));
+    ASSERT_EQ(cycle.size(), 4);
+    EXPECT_EQ(cycle.front(), cycle.back());
+}
+
+TEST(GraphCondensationTest, ReachabilityQueries) {
+    auto csr = build_diamond_chain(10);
+    GraphCondensation condensation(csr);
+
+    EXPECT_TRUE(condensation.reaches(csr.find("root"), csr.find("leaf")));
+    EXPECT_FALSE(condensation.reaches(csr.find("leaf"), csr.find("root")));
+    EXPECT_FALSE(condensation.reaches(csr.find("l3a"), csr.find("l3b")));
+    EXPECT_EQ(condensation.transitive_dependents(csr.find("leaf")).size(), csr.node_count() - 1);
+}
+
+TEST(GraphCondensationTest, KShortestPathsAreBounded) {
+    // 60 层菱形链共有 2^60 条路径，必须在有界时间内返回
+    auto csr = build_diamond_chain(60);
+    auto paths = k_shortest_paths(csr, {csr.find("root")}, csr.find("leaf"), 3);
+
+    ASSERT_EQ(paths.size(), 3);
+    for (const auto& path : paths) {
+        EXPECT_EQ(path.size(), 62);
+        EXPECT_EQ(csr.name(path.front()), "root");
+        EXPECT_EQ(csr.name(path.back()), "leaf");
+    }
+    EXPECT_NE(paths[0], paths[1]);
+}
+
+TEST(GraphCondensationTest, PathEnumerationIsCappedByDefault) {
+    auto csr = build_diamond_chain(60);
+    auto paths = csr.find_paths(csr.find("root"), csr.find("leaf"));
+    EXPECT_EQ(paths.size(), CSRDependencyGraph::DEFAULT_MAX_PATHS);
+
+    // DependencyGraph 的路径查询走有界 K 最短路径
+    DependencyGraph graph;
+    graph.add_node(DependencyNode("root", "1.0.0"));
+    graph.add_node(DependencyNode("leaf", "1.0.0"));
+    std::vector<std::string> previous{"root"};
+    for (size_t i = 0; i < 40; ++i) {
+        std::vector<std::string> current{"l" + std::to_string(i) + "a", "l" + std::to_string(i) + "b"};
+        for (const auto& to : current) {
+            graph.add_node(DependencyNode(to, "1.0.0"));
+            for (const auto& from : previous) {
+                graph.add_dependency(from, to);
+            }
+        }
+        previous = current;
+    }
+    for (const auto& from : previous) {
+        graph.add_dependency(from, "leaf");
+    }
+
+    auto shortest_first = graph.get_all_paths("root", "leaf");
+    ASSERT_EQ(shortest_first.size(), CSRDependencyGraph::DEFAULT_MAX_PATHS);
+    EXPECT_EQ(shortest_first.front().size(), 42);
+    EXPECT_LE(graph.get_all_paths_to_package("leaf").size(), CSRDependencyGraph::DEFAULT_MAX_PATHS);
+}
+
+TEST(GraphCondensationTest, ConflictDetectorOnDiamondGraph) {
+    DependencyGraph graph;
+    graph.add_node(DependencyNode("app"));
+    for (size_t i = 0; i < 40; ++i) {
+        graph.add_node(DependencyNode("mid" + std::to_string(i) + "a"));
+        graph.add_node(DependencyNode("mid" + std::to_string(i) + "b"));
+    }
+    graph.add_node(DependencyNode("core"));
+
+    std::vector<std::string> previous{"app"};
+    for (size_t i = 0; i < 40; ++i) {
+        std::vector<std::string> current{"mid" + std::to_string(i) + "a", "mid" + std::to_string(i) + "b"};
+        for (const auto& from : previous) {
+            for (const auto& to : current) {
+                graph.add_dependency(from, to);
+            }
+        }
+        previous = current;
+    }
+    graph.add_dependency(previous[0], "core");
+    graph.add_dependency(previous[1], "core");
+    graph.get_node(previous[0])->version_constraints["core"] = VersionConstraint::parse("1.0.0");
+    graph.get_node(previous[1])->version_constraints["core"] = VersionConstraint::parse("2.0.0");
+
+    ConflictDetector detector(graph, 2);
+    auto conflicts = detector.detect_version_conflicts();
+    ASSERT_EQ(conflicts.size(), 1);
+    EXPECT_EQ(conflicts[0].package_name, "core");
+    EXPECT_EQ(conflicts[0].conflicting_versions.size(), 2);
+    EXPECT_EQ(conflicts[0].explanation_paths.size(), 4);
+    EXPECT_EQ(conflicts[0].conflict_path.front(), "app");
+    EXPECT_EQ(conflicts[0].conflict_path.back(), "core");
+}
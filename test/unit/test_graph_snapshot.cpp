@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/graph_snapshot.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <thread>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class GraphSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / ("paker_snapshot_test_" + std::to_string(::getpid()));
+        fs::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    std::string path(const std::string& name) const {
+        return (test_dir_ / name).string();
+    }
+
+    fs::path test_dir_;
+};
+
+TEST_F(GraphSnapshotTest, OptimizedGraphRoundTrip) {
+    OptimizedDependencyGraph graph;
+    for (int i = 0; i < 50; ++i) {
+        LightweightDependencyNode node("pkg" + std::to_string(i), "1.0." + std::to_string(i % 3));
+        node.repository = "https://example.com/repo.git";
+        node.is_installed = (i % 2) == 0;
+        node.install_path = "packages/pkg" + std::to_string(i);
+        graph.add_node(node);
+    }
+    for (int i = 0; i + 1 < 50; ++i) {
+        graph.add_dependency("pkg" + std::to_string(i), "pkg" + std::to_string(i + 1));
+        if (i + 7 < 50) {
+            graph.add_dependency("pkg" + std::to_string(i), "pkg" + std::to_string(i + 7));
+        }
+    }
+
+    auto file = path("graph.snapshot");
+    ASSERT_TRUE(graph.save_to_snapshot(file, 42));
+    EXPECT_TRUE(GraphSnapshot::is_snapshot_file(file));
+
+    OptimizedDependencyGraph loaded;
+    ASSERT_TRUE(loaded.load_from_file(file));
+    ASSERT_EQ(loaded.get_node_count(), graph.get_node_count());
+    EXPECT_EQ(loaded.get_edge_count(), graph.get_edge_count());
+    for (int i = 0; i < 50; ++i) {
+        auto name = "pkg" + std::to_string(i);
+        const auto* original = graph.get_node(name);
+        const auto* restored = loaded.get_node(name);
+        ASSERT_NE(restored, nullptr);
+        EXPECT_EQ(restored->version, original->version);
+        EXPECT_EQ(restored->repository, original->repository);
+        EXPECT_EQ(restored->is_installed, original->is_installed);
+        EXPECT_EQ(restored->install_path, original->install_path);
+        EXPECT_EQ(loaded.get_dependents(name).size(), graph.get_dependents(name).size());
+    }
+    EXPECT_EQ(loaded.topological_sort().size(), 50);
+
+    // 重复字符串在池中只存一份
+    GraphSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(file));
+    EXPECT_EQ(snapshot.fingerprint(), 42);
+    EXPECT_EQ(snapshot.repository(snapshot.find("pkg3")).data(),
+              snapshot.repository(snapshot.find("pkg4")).data());
+}
+
+TEST_F(GraphSnapshotTest, DependencyGraphViewAndConstraints) {
+    DependencyGraph graph;
+    graph.add_node(DependencyNode("app", "2.0.0"));
+    graph.add_node(DependencyNode("fmt", "10.1.0"));
+    graph.add_node(DependencyNode("spdlog", "1.12.0"));
+    graph.add_dependency("app", "spdlog");
+    graph.add_dependency("app", "fmt");
+    graph.add_dependency("spdlog", "fmt");
+    graph.get_node("app")->version_constraints["fmt"] = VersionConstraint::parse(">=10.0.0");
+
+    auto file = path("resolved.snapshot");
+    ASSERT_TRUE(GraphSnapshot::write(graph, file));
+
+    GraphSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(file));
+    EXPECT_EQ(snapshot.node_count(), 3);
+    EXPECT_EQ(snapshot.edge_count(), 3);
+    EXPECT_EQ(snapshot.find("missing"), GraphSnapshot::INVALID_NODE);
+
+    auto app = snapshot.find("app");
+    auto fmt = snapshot.find("fmt");
+    ASSERT_NE(app, GraphSnapshot::INVALID_NODE);
+    EXPECT_EQ(snapshot.version(app), "2.0.0");
+    EXPECT_EQ(snapshot.dependents(fmt).size(), 2);
+
+    auto deps = snapshot.dependencies(app);
+    ASSERT_EQ(deps.size(), 2);
+    for (size_t i = 0; i < deps.size(); ++i) {
+        EXPECT_EQ(snapshot.constraint(app, i), deps[i] == fmt ? ">=10.0.0" : "");
+    }
+}
+
+TEST_F(GraphSnapshotTest, KeepsDeclaredDependenciesWithoutEdges) {
+    DependencyGraph graph;
+    graph.add_node(DependencyNode("app", "2.0.0"));
+    graph.add_node(DependencyNode("fmt", "10.1.0"));
+    graph.add_dependency("app", "fmt");
+    // 未解析的依赖与只有约束的条目都不会形成边
+    auto* app_node = graph.get_node("app");
+    app_node->dependencies.insert("zlib");
+    app_node->version_constraints["zlib"] = VersionConstraint::parse("^1.3.0");
+    app_node->version_constraints["boost"] = VersionConstraint::parse(">=1.80.0");
+
+    auto file = path("declared.snapshot");
+    ASSERT_TRUE(GraphSnapshot::write(graph, file));
+
+    GraphSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(file));
+    EXPECT_EQ(snapshot.edge_count(), 1);
+    auto app = snapshot.find("app");
+    ASSERT_EQ(snapshot.declared_count(app), 3);
+    EXPECT_EQ(snapshot.declared_count(snapshot.find("fmt")), 0);
+
+    auto boost = snapshot.declared(app, 0);
+    EXPECT_EQ(boost.name, "boost");
+    EXPECT_FALSE(boost.listed);
+    EXPECT_TRUE(boost.has_constraint);
+    EXPECT_EQ(boost.constraint, app_node->version_constraints["boost"].to_string());
+
+    auto fmt = snapshot.declared(app, 1);
+    EXPECT_EQ(fmt.name, "fmt");
+    EXPECT_TRUE(fmt.listed);
+    EXPECT_FALSE(fmt.has_constraint);
+
+    auto zlib = snapshot.declared(app, 2);
+    EXPECT_EQ(zlib.name, "zlib");
+    EXPECT_TRUE(zlib.listed);
+    EXPECT_EQ(zlib.constraint, app_node->version_constraints["zlib"].to_string());
+}
+
+TEST_F(GraphSnapshotTest, RejectsCorruptedFiles) {
+    OptimizedDependencyGraph graph;
+    graph.add_node(LightweightDependencyNode("a", "1.0.0"));
+    graph.add_node(LightweightDependencyNode("b", "1.0.0"));
+    graph.add_dependency("a", "b");
+
+    auto file = path("corrupt.snapshot");
+    ASSERT_TRUE(graph.save_to_snapshot(file));
+    auto size = fs::file_size(file);
+
+    // 篡改数据区最后一个字节
+    {
+        std::fstream stream(file, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(static_cast<std::streamoff>(size - 1));
+        stream.put('\x7f');
+    }
+    GraphSnapshot snapshot;
+    EXPECT_FALSE(snapshot.open(file));
+    EXPECT_FALSE(snapshot.is_open());
+
+    // 截断的文件
+    fs::resize_file(file, size / 2);
+    EXPECT_FALSE(snapshot.open(file, false));
+
+    // JSON 文件不会被误识别为快照
+    auto json_file = path("graph.json");
+    ASSERT_TRUE(graph.save_to_file(json_file));
+    EXPECT_FALSE(GraphSnapshot::is_snapshot_file(json_file));
+}
+
+TEST_F(GraphSnapshotTest, ConcurrentWritersLeaveOneCompleteFile) {
+    DependencyGraph graph;
+    for (int i = 0; i < 200; ++i) {
+        graph.add_node(DependencyNode("pkg" + std::to_string(i), "1.0.0"));
+    }
+
+    // 各写者使用独立的临时文件，最终文件始终是某一次完整的写入
+    auto file = path("nested/shared.snapshot");
+    std::vector<std::thread> writers;
+    std::atomic<int> succeeded{0};
+    for (int i = 0; i < 8; ++i) {
+        writers.emplace_back([&] { succeeded += GraphSnapshot::write(graph, file) ? 1 : 0; });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    EXPECT_EQ(succeeded, 8);
+
+    GraphSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(file));
+    EXPECT_EQ(snapshot.node_count(), 200);
+    size_t entries = 0;
+    for ([[maybe_unused]] const auto& entry : fs::directory_iterator(test_dir_ / "nested")) {
+        ++entries;
+    }
+    EXPECT_EQ(entries, 1);
+}
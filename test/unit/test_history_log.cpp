@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "Paker/core/history_log.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class HistoryLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_history_log_test";
+        fs::remove_all(test_dir_);
+        dir_ = (test_dir_ / "history").string();
+        base_ = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    std::chrono::system_clock::time_point at(int minute) const {
+        return base_ + std::chrono::minutes(minute);
+    }
+
+    // 交替记录 fmt 和 spdlog 的升级，第 i 条在第 i 分钟
+    void fill(HistoryLog& log, int count) {
+        for (int i = 0; i < count; ++i) {
+            VersionHistoryEntry entry;
+            entry.package_name = i % 2 ? "spdlog" : "fmt";
+            entry.old_version = std::to_string(i);
+            entry.new_version = std::to_string(i + 1);
+            entry.timestamp = at(i);
+            entry.is_rollback = i == 5;
+            entry.backup_size_bytes = 100;
+            ASSERT_TRUE(log.append(entry));
+        }
+    }
+
+    fs::path test_dir_;
+    std::string dir_;
+    std::chrono::system_clock::time_point base_;
+};
+
+TEST_F(HistoryLogTest, QueriesUseIndexesAfterReopen) {
+    {
+        HistoryLog log(dir_, 4);
+        ASSERT_TRUE(log.open());
+        fill(log, 10);
+    }
+    // 前两段已封存并写出索引，活动段在打开时扫描
+    EXPECT_TRUE(fs::exists(dir_ + "/segment-000001.idx"));
+    EXPECT_TRUE(fs::exists(dir_ + "/segment-000002.idx"));
+    EXPECT_FALSE(fs::exists(dir_ + "/segment-000003.idx"));
+
+    HistoryLog log(dir_, 4);
+    ASSERT_TRUE(log.open());
+    EXPECT_EQ(log.size(), 10u);
+    EXPECT_EQ(log.packages(), (std::vector<std::string>{"fmt", "spdlog"}));
+
+    auto fmt = log.package_history("fmt");
+    ASSERT_EQ(fmt.size(), 5u);
+    EXPECT_EQ(fmt.front().new_version, "1");
+    EXPECT_EQ(fmt.back().new_version, "9");
+    auto latest = log.package_history("spdlog", 1);
+    ASSERT_EQ(latest.size(), 1u);
+    EXPECT_EQ(latest[0].new_version, "10");
+
+    auto recent = log.recent(3);
+    ASSERT_EQ(recent.size(), 3u);
+    EXPECT_EQ(recent[0].new_version, "8");
+    EXPECT_EQ(recent[2].new_version, "10");
+
+    auto window = log.range(at(3), at(6));
+    ASSERT_EQ(window.size(), 4u);
+    EXPECT_EQ(window.front().timestamp, at(3));
+    EXPECT_EQ(window.back().timestamp, at(6));
+
+    VersionHistoryEntry found;
+    ASSERT_TRUE(log.find_at_or_before(at(6) + std::chrono::seconds(30), found));
+    EXPECT_EQ(found.new_version, "7");
+    ASSERT_TRUE(log.find_at_or_before(at(6), found, "spdlog"));
+    EXPECT_EQ(found.new_version, "6");
+    EXPECT_FALSE(log.find_at_or_before(at(-1), found));
+
+    HistoryLogStats stats = log.stats();
+    EXPECT_EQ(stats.entries, 10u);
+    EXPECT_EQ(stats.packages, 2u);
+    EXPECT_EQ(stats.rollbacks, 1u);
+    EXPECT_EQ(stats.segments, 3u);
+    EXPECT_EQ(stats.backup_bytes, 1000u);
+    EXPECT_EQ(stats.first, at(0));
+    EXPECT_EQ(stats.last, at(9));
+}
+
+TEST_F(HistoryLogTest, AffectedFilesAreSharedCompressedReferences) {
+    HistoryLog log(dir_);
+    ASSERT_TRUE(log.open());
+    std::vector<std::string> files;
+    for (int i = 0; i < 200; ++i) {
+        files.push_back("/work/project/packages/fmt/include/fmt/header_" + std::to_string(i) + ".h");
+    }
+    for (int i = 0; i < 3; ++i) {
+        VersionHistoryEntry entry;
+        entry.package_name = "fmt";
+        entry.new_version = "1.0." + std::to_string(i);
+        entry.timestamp = at(i);
+        entry.affected_files = files;
+        ASSERT_TRUE(log.append(entry));
+        EXPECT_FALSE(entry.affected_files_ref.empty());
+    }
+
+    size_t blobs = 0;
+    for (const auto& item : fs::directory_iterator(dir_ + "/files")) {
+        blobs++;
+        EXPECT_LT(fs::file_size(item.path()), files.size() * files[0].size() / 4);
+    }
+    EXPECT_EQ(blobs, 1u);
+
+    auto history = log.package_history("fmt");
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_TRUE(history[1].affected_files.empty());
+    EXPECT_EQ(log.load_affected_files(history[1]), files);
+}
+
+TEST_F(HistoryLogTest, AffectedFilesDifferingOnlyInLastPathKeepSeparateLists) {
+    HistoryLog log(dir_);
+    ASSERT_TRUE(log.open());
+    std::vector<std::string> first;
+    for (int i = 0; i < 60; ++i) {
+        first.push_back("/work/project/packages/fmt/include/fmt/header_" + std::to_string(i) + ".h");
+    }
+    std::vector<std::string> second = first;
+    second.back() = "/work/project/packages/fmt/include/fmt/header_59.hpp";
+
+    for (int i = 0; i < 2; ++i) {
+        VersionHistoryEntry entry;
+        entry.package_name = "fmt";
+        entry.new_version = "2.0." + std::to_string(i);
+        entry.timestamp = at(i);
+        entry.affected_files = i == 0 ? first : second;
+        ASSERT_TRUE(log.append(entry));
+    }
+
+    auto history = log.package_history("fmt");
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_NE(history[0].affected_files_ref, history[1].affected_files_ref);
+    EXPECT_EQ(log.load_affected_files(history[0]), first);
+    EXPECT_EQ(log.load_affected_files(history[1]), second);
+}
+
+TEST_F(HistoryLogTest, RetainLatestDropsExpiredSegments) {
+    HistoryLog log(dir_, 4);
+    ASSERT_TRUE(log.open());
+    fill(log, 10);
+
+    std::vector<VersionHistoryEntry> dropped;
+    EXPECT_EQ(log.retain_latest(3, &dropped), 7u);
+    ASSERT_EQ(dropped.size(), 7u);
+    EXPECT_EQ(dropped.front().new_version, "1");
+    EXPECT_EQ(log.size(), 3u);
+    EXPECT_FALSE(fs::exists(dir_ + "/segment-000001.log"));
+    EXPECT_TRUE(fs::exists(dir_ + "/segment-000002.log"));   // 仍含第 8 条
+    EXPECT_EQ(log.stats().rollbacks, 0u);
+
+    HistoryLog reopened(dir_, 4);
+    ASSERT_TRUE(reopened.open());
+    auto remaining = reopened.recent(10);
+    ASSERT_EQ(remaining.size(), 3u);
+    EXPECT_EQ(remaining.front().new_version, "8");
+    EXPECT_EQ(reopened.package_history("fmt").size(), 1u);
+}
+
+TEST_F(HistoryLogTest, IncompleteTailRecordIsDiscarded) {
+    {
+        HistoryLog log(dir_, 4);
+        ASSERT_TRUE(log.open());
+        fill(log, 2);
+    }
+    std::ofstream(dir_ + "/segment-000001.log", std::ios::app) << "{\"seq\":3,\"ts\":";
+
+    HistoryLog log(dir_, 4);
+    ASSERT_TRUE(log.open());
+    EXPECT_EQ(log.size(), 2u);
+    fill(log, 1);
+    auto recent = log.recent(5);
+    ASSERT_EQ(recent.size(), 3u);
+
+    HistoryLog reopened(dir_, 4);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.size(), 3u);
+}
+
+TEST_F(HistoryLogTest, ConcurrentWritersShareSegments) {
+    // 两个实例模拟两个进程：各自只在内存中记得自己的记录，追加时必须以磁盘为准
+    HistoryLog first(dir_, 4);
+    HistoryLog second(dir_, 4);
+    ASSERT_TRUE(first.open());
+    ASSERT_TRUE(second.open());
+    for (int i = 0; i < 10; ++i) {
+        VersionHistoryEntry entry;
+        entry.package_name = i % 2 ? "spdlog" : "fmt";
+        entry.new_version = std::to_string(i + 1);
+        entry.timestamp = at(i);
+        ASSERT_TRUE((i % 2 ? second : first).append(entry));
+    }
+    // 每个实例在追加时都并入了对方的记录
+    EXPECT_EQ(second.size(), 10u);
+    EXPECT_EQ(first.size(), 9u);
+
+    HistoryLog reopened(dir_, 4);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.stats().segments, 3u);
+    auto all = reopened.recent(20);
+    ASSERT_EQ(all.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(all[i].new_version, std::to_string(i + 1));
+    }
+    EXPECT_EQ(reopened.package_history("fmt").size(), 5u);
+    EXPECT_EQ(reopened.package_history("spdlog").size(), 5u);
+}
@@ -3,6 +3,7 @@
 #include "Paker/dependency/dependency_resolver.h"
 #include "Paker/core/package_manager.h"
 #include <filesystem>
+#include <fstream>
 #include <thread>
 #include <vector>
 
@@ -271,4 +272,75 @@ TEST(IncrementalParserConcurrencyTest, ThreadSafety) {
     std::filesystem::remove_all(test_dir);
 }
 
+TEST(IncrementalParserWatchTest, ChangedPackageIsReparsed) {
+    // 包清单变化后应读到新内容，而不是有效期内的缓存结果
+    namespace fs = std::filesystem;
+    fs::path project = fs::temp_directory_path() / "paker_incremental_watch_test";
+    fs::remove_all(project);
+    fs::create_directories(project / "packages" / "fmt");
+    std::ofstream(project / "Paker.json") << R"({"name": "demo", "dependencies": {"fmt": "1.0.0"}})";
+    std::ofstream(project / "packages" / "fmt" / "paker.json") << R"({"dependencies": {"zlib": "1.0.0"}})";
+    fs::path original_cwd = fs::current_path();
+    fs::current_path(project);
+    {
+        IncrementalParser parser((project / ".paker" / "cache").string());
+        ParseConfig config;
+        config.enable_parallel = false;
+        config.enable_watch_mode = true;
+        parser.set_config(config);
+        ASSERT_TRUE(parser.initialize());
+        EXPECT_EQ(parser.apply_project_changes(parser.detect_project_changes()), 1u);
+        const DependencyNode* node = parser.get_dependency_graph().get_node("fmt");
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->dependencies.count("zlib"), 1u);
+
+        std::ofstream(project / "packages" / "fmt" / "paker.json") << R"({"dependencies": {"spdlog": "2.0.0"}})";
+        ChangeDetectionResult changes = parser.detect_project_changes();
+        EXPECT_EQ(changes.changed_packages.count("fmt"), 1u);
+        EXPECT_EQ(parser.apply_project_changes(changes), 1u);
+        node = parser.get_dependency_graph().get_node("fmt");
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->dependencies.count("spdlog"), 1u);
+        EXPECT_EQ(node->dependencies.count("zlib"), 0u);
+        parser.shutdown();
+    }
+    fs::current_path(original_cwd);
+    fs::remove_all(project);
+}
+
+TEST(IncrementalParserWatchTest, WaitReturnsWhenManifestChanges) {
+    // 监视模式下等待应在事件到达时立即返回，而不是睡满整个间隔
+    namespace fs = std::filesystem;
+    fs::path project = fs::temp_directory_path() / "paker_incremental_wait_test";
+    fs::remove_all(project);
+    fs::create_directories(project / "packages");
+    std::ofstream(project / "Paker.json") << R"({"name": "demo", "dependencies": {}})";
+    fs::path original_cwd = fs::current_path();
+    fs::current_path(project);
+    {
+        IncrementalParser parser((project / ".paker" / "cache").string());
+        ParseConfig config;
+        config.enable_watch_mode = true;
+        parser.set_config(config);
+        ASSERT_TRUE(parser.initialize());
+        if (parser.is_watch_mode_active()) {
+            parser.detect_project_changes();
+            EXPECT_FALSE(parser.wait_for_project_changes(std::chrono::milliseconds(20)));
+
+            std::thread writer([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::ofstream(project / "Paker.json") << R"({"name": "demo", "dependencies": {"fmt": "1.0.0"}})";
+            });
+            auto start = std::chrono::steady_clock::now();
+            EXPECT_TRUE(parser.wait_for_project_changes(std::chrono::seconds(10)));
+            EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+            writer.join();
+            EXPECT_EQ(parser.detect_project_changes().new_packages.count("fmt"), 1u);
+        }
+        parser.shutdown();
+    }
+    fs::current_path(original_cwd);
+    fs::remove_all(project);
+}
+
 } // namespace Paker
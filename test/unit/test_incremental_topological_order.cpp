@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/incremental_topological_order.h"
+#include "Paker/dependency/csr_dependency_graph.h"
+#include "Paker/dependency/dependency_graph.h"
+#include "Paker/dependency/optimized_dependency_graph.h"
+#include <memory>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+using namespace Paker;
+
+namespace {
+
+// 检查所有边都满足 position(from) < position(to)
+void expect_valid_order(const IncrementalTopologicalOrder& topo,
+                        const std::vector<std::pair<uint32_t, uint32_t>>& edges) {
+    for (const auto& [from, to] : edges) {
+        EXPECT_LT(topo.position(from), topo.position(to)) << from << " -> " << to;
+    }
+}
+
+// 依赖方（from）必须出现在被依赖方（to）之前
+bool precedes(const std::vector<std::string>& order, const std::string& a, const std::string& b) {
+    auto ia = std::find(order.begin(), order.end(), a);
+    auto ib = std::find(order.begin(), order.end(), b);
+    return ia != order.end() && ib != order.end() && ia < ib;
+}
+
+} // namespace
+
+TEST(IncrementalTopologicalOrderTest, MaintainsOrderUnderRandomInsertions) {
+    const uint32_t node_count = 200;
+    IncrementalTopologicalOrder topo;
+    for (uint32_t i = 0; i < node_count; ++i) {
+        topo.add_node();
+    }
+
+    // 按隐藏的随机排列生成 DAG 边，以随机顺序插入
+    std::mt19937 rng(42);
+    std::vector<uint32_t> rank(node_count);
+    std::iota(rank.begin(), rank.end(), 0);
+    std::shuffle(rank.begin(), rank.end(), rng);
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::uniform_int_distribution<uint32_t> pick(0, node_count - 1);
+    for (int i = 0; i < 1000; ++i) {
+        uint32_t a = pick(rng), b = pick(rng);
+        if (rank[a] == rank[b]) continue;
+        if (rank[a] > rank[b]) std::swap(a, b);
+        EXPECT_TRUE(topo.add_edge(a, b));
+        edges.emplace_back(a, b);
+    }
+
+    EXPECT_TRUE(topo.is_acyclic());
+    expect_valid_order(topo, edges);
+    EXPECT_GT(topo.get_stats().reorders, 0);
+}
+
+TEST(IncrementalTopologicalOrderTest, DetectsCycleAndRecoversOnRemoval) {
+    IncrementalTopologicalOrder topo;
+    for (int i = 0; i < 4; ++i) {
+        topo.add_node();
+    }
+    EXPECT_TRUE(topo.add_edge(0, 1));
+    EXPECT_TRUE(topo.add_edge(1, 2));
+    EXPECT_TRUE(topo.add_edge(2, 3));
+
+    // try_add_edge 拒绝成环的边且不修改状态
+    std::vector<uint32_t> cycle;
+    EXPECT_FALSE(topo.try_add_edge(3, 0, &cycle));
+    EXPECT_EQ(cycle, (std::vector<uint32_t>{3, 0, 1, 2, 3}));
+    EXPECT_TRUE(topo.is_acyclic());
+    EXPECT_FALSE(topo.has_edge(3, 0));
+
+    // add_edge 将成环的边挂起
+    EXPECT_FALSE(topo.add_edge(3, 1));
+    EXPECT_FALSE(topo.is_acyclic());
+    ASSERT_EQ(topo.pending_edges().size(), 1);
+
+    // 删除 1 -> 2 打破环，挂起的边重新生效
+    EXPECT_TRUE(topo.remove_edge(1, 2));
+    EXPECT_TRUE(topo.is_acyclic());
+    EXPECT_TRUE(topo.has_edge(3, 1));
+    expect_valid_order(topo, {{0, 1}, {2, 3}, {3, 1}});
+}
+
+TEST(IncrementalTopologicalOrderTest, StatsCountEachEdgeOnce) {
+    IncrementalTopologicalOrder topo;
+    for (int i = 0; i < 3; ++i) {
+        topo.add_node();
+    }
+    EXPECT_TRUE(topo.add_edge(0, 1));
+    EXPECT_TRUE(topo.add_edge(1, 2));
+    EXPECT_FALSE(topo.try_add_edge(2, 0));
+    EXPECT_FALSE(topo.add_edge(2, 1));
+    EXPECT_EQ(topo.get_stats().edges_added, 2);
+    EXPECT_EQ(topo.get_stats().cycles_detected, 2);
+
+    // 挂起的边在重新插入成功时计入一次，仍成环的重试不重复计数
+    EXPECT_TRUE(topo.remove_edge(0, 1));
+    EXPECT_FALSE(topo.is_acyclic());
+    EXPECT_TRUE(topo.remove_edge(1, 2));
+    EXPECT_TRUE(topo.is_acyclic());
+    EXPECT_EQ(topo.get_stats().edges_added, 3);
+    EXPECT_EQ(topo.get_stats().cycles_detected, 2);
+}
+
+TEST(IncrementalTopologicalOrderTest, RebuildFromFrozenGraph) {
+    CSRGraphBuilder builder;
+    builder.add_edge("a", "b");
+    builder.add_edge("b", "c");
+    builder.add_edge("c", "b");
+    builder.add_edge("a", "d");
+    auto csr = builder.build();
+
+    IncrementalTopologicalOrder topo;
+    topo.rebuild(csr);
+    EXPECT_EQ(topo.node_count(), csr.node_count());
+    EXPECT_FALSE(topo.is_acyclic());
+    EXPECT_EQ(topo.pending_edges().size(), 1);
+    EXPECT_LT(topo.position(csr.find("a")), topo.position(csr.find("d")));
+}
+
+// topological_sort 保证的顺序：依赖方在被依赖方之前，相同的编辑序列得到相同结果，
+// 没有边约束的节点保持加入顺序。它不再是按名称排序的 Kahn 序，这里不比较具体序列。
+TEST(IncrementalTopologicalOrderTest, TopologicalSortOrderGuarantees) {
+    const uint32_t node_count = 120;
+    std::mt19937 rng(7);
+    std::vector<uint32_t> rank(node_count);
+    std::iota(rank.begin(), rank.end(), 0);
+    std::shuffle(rank.begin(), rank.end(), rng);
+    std::vector<std::pair<std::string, std::string>> edges;
+    std::uniform_int_distribution<uint32_t> pick(0, node_count - 1);
+    for (int i = 0; i < 400; ++i) {
+        uint32_t a = pick(rng), b = pick(rng);
+        if (rank[a] == rank[b]) continue;
+        if (rank[a] > rank[b]) std::swap(a, b);
+        edges.emplace_back("pkg" + std::to_string(a), "pkg" + std::to_string(b));
+    }
+
+    auto build_graph = [&] {
+        DependencyGraph graph;
+        for (uint32_t i = 0; i < node_count; ++i) {
+            graph.add_node(DependencyNode("pkg" + std::to_string(i)));
+        }
+        for (const auto& [from, to] : edges) {
+            graph.add_dependency(from, to);
+        }
+        return graph;
+    };
+    auto build_optimized = [&](OptimizedDependencyGraph& graph) {
+        for (uint32_t i = 0; i < node_count; ++i) {
+            graph.add_node(LightweightDependencyNode("pkg" + std::to_string(i)));
+        }
+        for (const auto& [from, to] : edges) {
+            graph.add_dependency(from, to);
+        }
+    };
+
+    DependencyGraph graph = build_graph();
+    OptimizedDependencyGraph optimized;
+    build_optimized(optimized);
+    auto order = graph.topological_sort();
+    auto optimized_order = optimized.topological_sort();
+    ASSERT_EQ(order.size(), node_count);
+    ASSERT_EQ(optimized_order.size(), node_count);
+    for (const auto& [from, to] : edges) {
+        EXPECT_TRUE(precedes(order, from, to)) << from << " -> " << to;
+        EXPECT_TRUE(precedes(optimized_order, from, to)) << from << " -> " << to;
+    }
+
+    EXPECT_EQ(build_graph().topological_sort(), order);
+    OptimizedDependencyGraph rebuilt;
+    build_optimized(rebuilt);
+    EXPECT_EQ(rebuilt.topological_sort(), optimized_order);
+
+    // 与加入顺序一致的边不触发重排
+    DependencyGraph chain;
+    for (const auto* name : {"zlib", "app", "core", "boost"}) {
+        chain.add_node(DependencyNode(name));
+    }
+    chain.add_dependency("zlib", "core");
+    chain.add_dependency("app", "boost");
+    EXPECT_EQ(chain.topological_sort(), (std::vector<std::string>{"zlib", "app", "core", "boost"}));
+}
+
+TEST(IncrementalTopologicalOrderTest, DependencyGraphIntegration) {
+    DependencyGraph graph;
+    for (const auto* name : {"app", "net", "json", "core"}) {
+        graph.add_node(DependencyNode(name));
+    }
+    graph.add_dependency("json", "core");
+    graph.add_dependency("net", "core");
+    graph.add_dependency("app", "net");
+    graph.add_dependency("app", "json");
+
+    auto order = graph.topological_sort();
+    ASSERT_EQ(order.size(), 4);
+    EXPECT_TRUE(precedes(order, "app", "net"));
+    EXPECT_TRUE(precedes(order, "net", "core"));
+    EXPECT_TRUE(precedes(order, "json", "core"));
+
+    std::vector<std::string> cycle;
+    EXPECT_FALSE(graph.try_add_dependency("core", "app", &cycle));
+    ASSERT_FALSE(cycle.empty());
+    EXPECT_EQ(cycle.front(), "core");
+    EXPECT_EQ(cycle.back(), "core");
+    EXPECT_TRUE(graph.is_acyclic());
+    EXPECT_TRUE(graph.detect_cycles().empty());
+
+    graph.add_dependency("core", "app");
+    EXPECT_FALSE(graph.is_acyclic());
+    EXPECT_TRUE(graph.remove_dependency("core", "app"));
+    EXPECT_TRUE(graph.is_acyclic());
+    EXPECT_EQ(graph.topological_sort().size(), 4);
+}
+
+TEST(IncrementalTopologicalOrderTest, OptimizedGraphRebuildsAfterNodeRemoval) {
+    OptimizedDependencyGraph graph;
+    for (const auto* name : {"app", "net", "old", "core"}) {
+        graph.add_node(LightweightDependencyNode(name));
+    }
+    graph.add_dependency("app", "net");
+    graph.add_dependency("net", "old");
+    graph.add_dependency("old", "core");
+    graph.add_dependency("core", "app");
+    EXPECT_FALSE(graph.is_acyclic());
+
+    // 删除节点使索引移动，拓扑序惰性重建
+    EXPECT_TRUE(graph.remove_node("old"));
+    EXPECT_TRUE(graph.is_acyclic());
+    EXPECT_TRUE(graph.try_add_dependency("core", "net"));
+    EXPECT_FALSE(graph.try_add_dependency("net", "core"));
+
+    auto order = graph.topological_sort();
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_TRUE(precedes(order, "core", "app"));
+    EXPECT_TRUE(precedes(order, "app", "net"));
+}
+
+TEST(IncrementalTopologicalOrderTest, CopiedGraphOutlivesSource) {
+    DependencyGraph copy;
+    {
+        auto source = std::make_unique<DependencyGraph>();
+        for (const auto* name : {"app", "net", "core"}) {
+            source->add_node(DependencyNode(name));
+        }
+        source->add_dependency("app", "net");
+        source->add_dependency("net", "core");
+        DependencyGraph temporary(*source);
+        copy = temporary;
+        source->clear();
+    }
+
+    // 拷贝的拓扑序索引必须指向自身的节点，源对象销毁后仍可使用
+    std::vector<std::string> cycle;
+    EXPECT_FALSE(copy.try_add_dependency("core", "app", &cycle));
+    EXPECT_EQ(cycle, (std::vector<std::string>{"core", "app", "net", "core"}));
+    EXPECT_TRUE(copy.remove_dependency("net", "core"));
+    EXPECT_TRUE(copy.try_add_dependency("core", "app"));
+
+    DependencyGraph moved(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    auto order = moved.topological_sort();
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_TRUE(precedes(order, "core", "app"));
+}
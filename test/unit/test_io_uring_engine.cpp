@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "Paker/core/async_io.h"
+#include "Paker/core/io_uring_engine.h"
+#include "Paker/core/openmp_io.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class IoUringEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_io_uring_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_ / "src");
+
+        // 大部分是小文件，夹杂几个超过单轮缓冲区的大文件
+        for (size_t i = 0; i < 300; ++i) {
+            size_t size = (i % 50 == 0) ? IoUringEngine::kBufferSize * 3 + i : i * 13;
+            std::string content;
+            for (size_t j = 0; j < size; ++j) {
+                content.push_back(static_cast<char>('a' + (i + j) % 26));
+            }
+            std::string path = (test_dir_ / "src" / ("file_" + std::to_string(i) + ".h")).string();
+            std::ofstream(path, std::ios::binary) << content;
+            paths_.push_back(path);
+            contents_.push_back(content);
+        }
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    static std::string read_back(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    fs::path test_dir_;
+    std::vector<std::string> paths_;
+    std::vector<std::string> contents_;
+};
+
+TEST_F(IoUringEngineTest, BackendSelection) {
+    EXPECT_EQ(parse_io_backend("io_uring"), IOBackend::IO_URING);
+    EXPECT_EQ(parse_io_backend("threads"), IOBackend::THREAD_POOL);
+    EXPECT_EQ(parse_io_backend("unknown"), IOBackend::AUTO);
+    EXPECT_STREQ(io_backend_name(IOBackend::THREAD_POOL), "threads");
+
+    EXPECT_FALSE(should_use_io_uring(IOBackend::THREAD_POOL));
+    EXPECT_EQ(should_use_io_uring(IOBackend::AUTO), IoUringEngine::is_supported());
+    // 强制 io_uring 但内核不支持时退回线程池
+    EXPECT_EQ(should_use_io_uring(IOBackend::IO_URING), IoUringEngine::is_supported());
+
+    // 作用域内的覆盖在离开时恢复
+    IOBackend before = default_io_backend();
+    {
+        ScopedIOBackend scope(IOBackend::THREAD_POOL);
+        EXPECT_EQ(default_io_backend(), IOBackend::THREAD_POOL);
+        {
+            ScopedIOBackend nested;
+            set_default_io_backend(IOBackend::IO_URING);
+        }
+        EXPECT_EQ(default_io_backend(), IOBackend::THREAD_POOL);
+    }
+    EXPECT_EQ(default_io_backend(), before);
+}
+
+TEST_F(IoUringEngineTest, ReadsBatchWithLargeAndMissingFiles) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not available";
+    }
+    IoUringEngine engine;
+    ASSERT_TRUE(engine.is_ready());
+
+    std::vector<std::string> paths = paths_;
+    paths.push_back((test_dir_ / "missing.h").string());
+    auto results = engine.read_files(paths);
+
+    ASSERT_EQ(results.size(), paths.size());
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        ASSERT_TRUE(results[i].success) << paths_[i];
+        ASSERT_EQ(results[i].data, contents_[i]) << paths_[i];
+    }
+    EXPECT_FALSE(results.back().success);
+    EXPECT_EQ(results.back().error, ENOENT);
+
+    const auto& stats = engine.get_stats();
+    EXPECT_EQ(stats.files_read, paths_.size());
+    EXPECT_EQ(stats.fallback_operations, 6u);
+    // 每轮 64 条链只需很少的 io_uring_enter 调用
+    EXPECT_LT(stats.submit_calls, paths.size() / 4);
+}
+
+TEST_F(IoUringEngineTest, WritesAndCopiesPreserveContentAndMode) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not available";
+    }
+    IoUringEngine engine;
+    fs::permissions(paths_[1], fs::perms::owner_all | fs::perms::group_read | fs::perms::others_read);
+
+    std::vector<std::pair<std::string, std::string>> pairs;
+    std::vector<std::pair<std::string, std::string_view>> writes;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        pairs.emplace_back(paths_[i], (test_dir_ / "copy" / fs::path(paths_[i]).filename()).string());
+        writes.emplace_back((test_dir_ / "out" / "nested" / fs::path(paths_[i]).filename()).string(),
+                            contents_[i]);
+    }
+    pairs.emplace_back((test_dir_ / "missing.h").string(), (test_dir_ / "copy" / "missing.h").string());
+
+    auto written = engine.write_files(writes);
+    auto copied = engine.copy_files(pairs);
+
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        ASSERT_TRUE(written[i]);
+        ASSERT_TRUE(copied[i]);
+        EXPECT_EQ(read_back(writes[i].first), contents_[i]);
+        EXPECT_EQ(read_back(pairs[i].second), contents_[i]);
+    }
+    EXPECT_FALSE(copied.back());
+    EXPECT_TRUE((fs::status(pairs[1].second).permissions() & fs::perms::owner_exec) != fs::perms::none);
+}
+
+TEST_F(IoUringEngineTest, SyncedWritesFlushInTheSameSubmission) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not available";
+    }
+    IoUringEngine engine;
+    std::vector<std::pair<std::string, std::string_view>> writes;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        writes.emplace_back((test_dir_ / "synced" / fs::path(paths_[i]).filename()).string(), contents_[i]);
+    }
+
+    auto written = engine.write_files(writes, true);
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        ASSERT_TRUE(written[i]);
+        EXPECT_EQ(read_back(writes[i].first), contents_[i]);
+    }
+    // 刷写挂在每个文件的链上，不额外增加提交轮次
+    const IoUringStats& stats = engine.get_stats();
+    EXPECT_EQ(stats.files_synced, paths_.size());
+    EXPECT_EQ(stats.fallback_operations, 0u);
+    EXPECT_LT(stats.submit_calls, paths_.size());
+}
+
+TEST_F(IoUringEngineTest, ManagersFollowPerCommandBackend) {
+    OpenMPIOManager manager(2);
+    {
+        ScopedIOBackend scope(IOBackend::THREAD_POOL);
+        EXPECT_EQ(manager.get_io_backend(), IOBackend::THREAD_POOL);
+    }
+    {
+        ScopedIOBackend scope(IOBackend::IO_URING);
+        EXPECT_EQ(manager.get_io_backend(), IOBackend::IO_URING);
+    }
+
+    manager.set_io_backend(IOBackend::THREAD_POOL);
+    ScopedIOBackend scope(IOBackend::IO_URING);
+    EXPECT_EQ(manager.get_io_backend(), IOBackend::THREAD_POOL);
+}
+
+TEST_F(IoUringEngineTest, BatchReadCompletesWithoutRunningManager) {
+    if (!IoUringEngine::is_supported()) {
+        GTEST_SKIP() << "io_uring not available";
+    }
+    // 未启动的管理器在调用线程上直接执行，批量读取同样不能丢进无人处理的队列
+    AsyncIOManager manager(2);
+    manager.set_io_backend(IOBackend::IO_URING);
+    std::vector<std::string> paths(paths_.begin(), paths_.begin() + 20);
+    auto futures = manager.read_files_async(paths, true);
+
+    ASSERT_EQ(futures.size(), paths.size());
+    for (size_t i = 0; i < futures.size(); ++i) {
+        ASSERT_EQ(futures[i].wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        auto result = futures[i].get();
+        ASSERT_EQ(result->status, IOOperationStatus::COMPLETED);
+        EXPECT_EQ(result->content, contents_[i]);
+    }
+}
+
+TEST_F(IoUringEngineTest, OpenMPManagerBackendsAgree) {
+    OpenMPIOManager manager(4);
+
+    manager.set_io_backend(IOBackend::THREAD_POOL);
+    auto threaded = manager.read_binary_files_parallel(paths_);
+    manager.set_io_backend(IOBackend::IO_URING);
+    IoUringEngine* engine = IoUringEngine::for_current_thread();
+    size_t fallbacks = engine ? engine->get_stats().fallback_operations : 0;
+    auto uring = manager.read_binary_files_parallel(paths_);
+
+    ASSERT_EQ(threaded.size(), uring.size());
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        EXPECT_EQ(std::string(uring[i].begin(), uring[i].end()), contents_[i]);
+        EXPECT_EQ(threaded[i], uring[i]);
+    }
+    // 大文件在 OpenMP 线程上读取，不经调用线程上引擎的同步补读
+    if (engine) {
+        EXPECT_EQ(engine->get_stats().fallback_operations, fallbacks);
+    }
+
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (size_t i = 0; i < 10; ++i) {
+        pairs.emplace_back(paths_[i], (test_dir_ / "mgr_copy" / std::to_string(i)).string());
+    }
+    auto copied = manager.copy_files_parallel(pairs);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        ASSERT_TRUE(copied[i]);
+        EXPECT_EQ(read_back(pairs[i].second), contents_[i]);
+    }
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/lru_cache_manager.h"
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class LRUCacheManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_lru_cache_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    std::string item_path(const std::string& name) {
+        fs::path path = test_dir_ / name;
+        fs::create_directories(path);
+        return path.string();
+    }
+
+    fs::path test_dir_;
+};
+
+TEST_F(LRUCacheManagerTest, ClockEvictionSkipsRecentlyReadItems) {
+    // 单分片便于确定时钟指针的走向
+    LRUCacheManager cache(test_dir_.string(), 1ULL << 30, 3, std::chrono::hours(24),
+                          CacheEvictionPolicy::LRU, 1);
+    for (const char* name : {"fmt", "zlib", "spdlog", "boost"}) {
+        ASSERT_TRUE(cache.add_item(name, "1.0", item_path(name)));
+    }
+    cache.pin_item("boost", "1.0");
+    EXPECT_FALSE(cache.get_item_path("fmt", "1.0").empty());
+    EXPECT_FALSE(cache.get_item_path("spdlog", "1.0").empty());
+
+    // 超出上限：读过的 fmt 得到第二次机会，未被读过的 zlib 先被淘汰
+    ASSERT_TRUE(cache.add_item("gtest", "1.0", item_path("gtest")));
+    EXPECT_FALSE(cache.has_item("zlib", "1.0"));
+    EXPECT_TRUE(cache.has_item("fmt", "1.0"));
+    EXPECT_TRUE(cache.has_item("spdlog", "1.0"));
+    EXPECT_TRUE(cache.has_item("gtest", "1.0"));
+
+    // 固定项永远不会被时钟选中
+    cache.set_max_cache_items(1);
+    cache.cleanup_cache();
+    EXPECT_TRUE(cache.has_item("boost", "1.0"));
+}
+
+TEST_F(LRUCacheManagerTest, ConcurrentReadersAndWriters) {
+    LRUCacheManager cache(test_dir_.string(), 1ULL << 30, 100000);
+    constexpr int kPreloaded = 64;
+    for (int i = 0; i < kPreloaded; ++i) {
+        ASSERT_TRUE(cache.add_item("pkg" + std::to_string(i), "1.0", (test_dir_ / "missing").string()));
+    }
+
+    constexpr int kReaders = 6;
+    constexpr int kWriters = 2;
+    constexpr int kLookups = 20000;
+    constexpr int kWrites = 500;
+    std::atomic<int> found{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < kReaders; ++r) {
+        threads.emplace_back([&, r] {
+            int local = 0;
+            for (int i = 0; i < kLookups; ++i) {
+                std::string name = "pkg" + std::to_string((i + r) % kPreloaded);
+                local += !cache.get_item_path(name, "1.0").empty();
+            }
+            found += local;
+        });
+    }
+    for (int w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < kWrites; ++i) {
+                std::string name = "writer" + std::to_string(w) + "_" + std::to_string(i);
+                cache.add_item(name, "2.0", (test_dir_ / "missing").string());
+                if (i % 2 == 0) {
+                    cache.remove_item(name, "2.0");
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(found.load(), kReaders * kLookups);
+    CacheStatistics stats = cache.get_statistics();
+    EXPECT_EQ(stats.hit_count, static_cast<size_t>(kReaders * kLookups));
+    EXPECT_EQ(stats.total_items, static_cast<size_t>(kPreloaded + kWriters * kWrites / 2));
+    EXPECT_EQ(cache.get_cache_items_count(), stats.total_items);
+    EXPECT_EQ(cache.get_all_packages().size(), stats.total_items);
+}
+
+TEST_F(LRUCacheManagerTest, StatisticsAggregateAcrossShards) {
+    LRUCacheManager cache(test_dir_.string());
+    std::string fmt = item_path("fmt");
+    std::ofstream(fmt + "/core.h") << std::string(1000, 'x');
+    ASSERT_TRUE(cache.add_item("fmt", "10.2.1", fmt));
+    ASSERT_TRUE(cache.add_item("zlib", "1.3", item_path("zlib")));
+
+    EXPECT_FALSE(cache.get_item_path("fmt", "10.2.1").empty());
+    EXPECT_TRUE(cache.get_item_path("fmt", "9.0.0").empty());
+    EXPECT_TRUE(cache.get_item_path("never-seen", "1.0").empty());
+
+    CacheStatistics stats = cache.get_statistics();
+    EXPECT_EQ(stats.total_items, 2u);
+    EXPECT_EQ(stats.total_size_bytes, 1000u);
+    EXPECT_EQ(stats.package_sizes["fmt"], 1000u);
+    EXPECT_EQ(stats.hit_count, 1u);
+    EXPECT_EQ(stats.miss_count, 2u);
+    EXPECT_NEAR(cache.get_hit_rate(), 1.0 / 3.0, 1e-9);
+
+    // 访问次数在快照中可见；zlib 访问两次，与 fmt 不会打平，结果不依赖分片顺序
+    cache.mark_accessed("zlib", "1.3");
+    cache.mark_accessed("zlib", "1.3");
+    auto items = cache.get_least_used_items(1);
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0].package_name, Symbol("fmt"));
+    EXPECT_EQ(cache.get_oldest_items(5).size(), 2u);
+}
+
+TEST_F(LRUCacheManagerTest, CachePathsAreNotInterned) {
+    LRUCacheManager cache(test_dir_.string());
+    std::string path = item_path("unique-install-dir-7f3a");
+    ASSERT_TRUE(cache.add_item("fmt", "10.2.1", path));
+    EXPECT_EQ(cache.get_item_path("fmt", "10.2.1"), path);
+
+    // 驻留表只增不减，每次安装都不同的路径不能进入驻留表
+    EXPECT_TRUE(StringInterner::instance().find("fmt").has_value());
+    EXPECT_FALSE(StringInterner::instance().find(path).has_value());
+}
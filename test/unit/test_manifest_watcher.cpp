@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/manifest_watcher.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <unistd.h>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class ManifestWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("paker_watch_test_" + std::to_string(::getpid()));
+        fs::create_directories(root_);
+        write("Paker.json", R"({"dependencies": {"fmt": "*", "json": "*"}})");
+    }
+
+    void TearDown() override {
+        fs::remove_all(root_);
+    }
+
+    void write(const std::string& relative, const std::string& content) {
+        auto path = root_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream(path) << content;
+    }
+
+    void add_package(const std::string& name, const std::string& content = "{}") {
+        write("packages/" + name + "/paker.json", content);
+    }
+
+    fs::path root_;
+};
+
+#ifdef __linux__
+
+TEST_F(ManifestWatcherTest, TracksManifestAndPackageChanges) {
+    add_package("fmt");
+    add_package("json");
+
+    ManifestWatcher watcher(root_.string());
+    ASSERT_TRUE(watcher.start());
+    EXPECT_EQ(watcher.get_watch_count(), 4);
+    EXPECT_TRUE(watcher.poll_changes().empty());
+
+    write("Paker.json", R"({"dependencies": {"fmt": "*"}})");
+    auto changes = watcher.poll_changes();
+    EXPECT_TRUE(changes.manifest_changed);
+    EXPECT_TRUE(changes.dirty_packages.empty());
+
+    add_package("fmt", R"({"version": "10.1.0"})");
+    changes = watcher.poll_changes();
+    EXPECT_FALSE(changes.manifest_changed);
+    EXPECT_EQ(changes.dirty_packages, (std::set<std::string>{"fmt"}));
+
+    // 事件已被消费
+    EXPECT_TRUE(watcher.poll_changes().empty());
+
+    fs::remove_all(root_ / "packages" / "json");
+    changes = watcher.poll_changes();
+    EXPECT_EQ(changes.dirty_packages, (std::set<std::string>{"json"}));
+    EXPECT_EQ(watcher.get_watch_count(), 3);
+
+    watcher.stop();
+    EXPECT_FALSE(watcher.is_active());
+    EXPECT_TRUE(watcher.poll_changes().empty());
+}
+
+TEST_F(ManifestWatcherTest, WatchesNewlyCreatedDirectories) {
+    ManifestWatcher watcher(root_.string());
+    ASSERT_TRUE(watcher.start());
+
+    // packages/ 在启动后才出现
+    add_package("spdlog");
+    auto changes = watcher.poll_changes();
+    EXPECT_TRUE(changes.dirty_packages.count("spdlog"));
+
+    // 新目录已被纳入监视
+    write("packages/spdlog/paker.json", R"({"version": "1.12.0"})");
+    EXPECT_TRUE(watcher.wait_for_events(std::chrono::milliseconds(1000)));
+    changes = watcher.poll_changes();
+    EXPECT_EQ(changes.dirty_packages, (std::set<std::string>{"spdlog"}));
+}
+
+TEST_F(ManifestWatcherTest, OverflowFallsBackToStatValidation) {
+    add_package("fmt");
+    add_package("json");
+    add_package("zlib");
+
+    ManifestWatcher watcher(root_.string());
+    ASSERT_TRUE(watcher.start());
+
+    add_package("fmt", R"({"version": "changed"})");
+    fs::remove_all(root_ / "packages" / "zlib");
+    watcher.mark_overflow();
+
+    // 未变化的 json 不在结果中
+    auto changes = watcher.poll_changes();
+    EXPECT_TRUE(changes.overflowed);
+    EXPECT_FALSE(changes.manifest_changed);
+    EXPECT_EQ(changes.dirty_packages, (std::set<std::string>{"fmt", "zlib"}));
+
+    // 重新监视后继续正常工作
+    add_package("json", R"({"version": "2"})");
+    changes = watcher.poll_changes();
+    EXPECT_FALSE(changes.overflowed);
+    EXPECT_EQ(changes.dirty_packages, (std::set<std::string>{"json"}));
+}
+
+TEST_F(ManifestWatcherTest, ResyncAndStopWakeWaiters) {
+    add_package("fmt");
+
+    ManifestWatcher watcher(root_.string());
+    ASSERT_TRUE(watcher.start());
+    const auto long_wait = std::chrono::seconds(30);
+
+    // 重新监视会替换 inotify 描述符，另一线程中的等待应被唤醒而不是继续 poll 旧描述符
+    auto start = std::chrono::steady_clock::now();
+    auto waiter = std::async(std::launch::async, [&] { return watcher.wait_for_events(long_wait); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    watcher.mark_overflow();
+    EXPECT_TRUE(watcher.poll_changes().overflowed);
+    EXPECT_TRUE(waiter.get());
+
+    // 唤醒计数已清零，新描述符上的等待正常工作
+    add_package("fmt", R"({"version": "2"})");
+    EXPECT_TRUE(watcher.wait_for_events(std::chrono::milliseconds(1000)));
+    EXPECT_EQ(watcher.poll_changes().dirty_packages, (std::set<std::string>{"fmt"}));
+    EXPECT_FALSE(watcher.wait_for_events(std::chrono::milliseconds(50)));
+
+    waiter = std::async(std::launch::async, [&] { return watcher.wait_for_events(long_wait); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    watcher.stop();
+    EXPECT_FALSE(waiter.get());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, long_wait);
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/materializer.h"
+#include <sys/stat.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class MaterializerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_materializer_test";
+        fs::remove_all(test_dir_);
+        cache_dir_ = test_dir_ / "cache" / "fmt" / "10.0.0";
+        fs::create_directories(cache_dir_ / "include" / "fmt");
+        write(cache_dir_ / "include" / "fmt" / "core.h", std::string(100000, 'c'));
+        write(cache_dir_ / "include" / "fmt" / "format.h", "#pragma once\n");
+        write(cache_dir_ / "README.md", "fmt");
+        fs::create_symlink("include/fmt/core.h", cache_dir_ / "core_link.h");
+    }
+
+    void TearDown() override {
+        // 硬链接策略会去掉缓存文件的写权限，清理前恢复
+        for (const auto& entry : fs::recursive_directory_iterator(test_dir_)) {
+            if (!entry.is_symlink()) {
+                fs::permissions(entry.path(), fs::perms::owner_write, fs::perm_options::add);
+            }
+        }
+        fs::remove_all(test_dir_);
+    }
+
+    static void write(const fs::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    static std::string read_back(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    static ino_t inode_of(const fs::path& path) {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0 ? st.st_ino : 0;
+    }
+
+    void expect_tree_matches(const fs::path& dest) {
+        EXPECT_EQ(read_back(dest / "include" / "fmt" / "core.h"), std::string(100000, 'c'));
+        EXPECT_EQ(read_back(dest / "include" / "fmt" / "format.h"), "#pragma once\n");
+        EXPECT_EQ(read_back(dest / "README.md"), "fmt");
+        EXPECT_TRUE(fs::is_symlink(dest / "core_link.h"));
+        EXPECT_FALSE(fs::is_symlink(dest));
+    }
+
+    fs::path test_dir_;
+    fs::path cache_dir_;
+};
+
+TEST_F(MaterializerTest, PolicyNames) {
+    EXPECT_EQ(parse_materialize_policy("hardlink"), MaterializePolicy::HARDLINK);
+    EXPECT_EQ(parse_materialize_policy("reflink"), MaterializePolicy::REFLINK);
+    EXPECT_EQ(parse_materialize_policy("auto"), MaterializePolicy::AUTO);
+    EXPECT_EQ(parse_materialize_policy("bogus"), MaterializePolicy::SYMLINK);
+    EXPECT_EQ(parse_materialize_policy("bogus", MaterializePolicy::COPY), MaterializePolicy::COPY);
+    EXPECT_STREQ(materialize_policy_name(MaterializePolicy::COPY), "copy");
+}
+
+TEST_F(MaterializerTest, HardlinkTreeSharesInodesAndProtectsCache) {
+    fs::path dest = test_dir_ / "project" / "packages" / "fmt";
+    FileMaterializer materializer(MaterializePolicy::HARDLINK);
+    MaterializeResult result = materializer.materialize_tree(cache_dir_.string(), dest.string());
+
+    ASSERT_TRUE(result.success);
+    expect_tree_matches(dest);
+    EXPECT_EQ(result.files, 3u);
+    EXPECT_EQ(result.hardlinked, 3u);
+    EXPECT_EQ(result.bytes_copied, 0u);
+    EXPECT_EQ(result.bytes_avoided(), result.bytes_total);
+    EXPECT_EQ(inode_of(dest / "README.md"), inode_of(cache_dir_ / "README.md"));
+    // 默认不修改缓存中的源文件
+    EXPECT_NE(fs::status(cache_dir_ / "README.md").permissions() & fs::perms::owner_write, fs::perms::none);
+
+    // 开启保护时去掉源文件写权限
+    fs::path protected_dest = test_dir_ / "project" / "packages" / "fmt-protected";
+    materializer.set_protect_source(true);
+    ASSERT_TRUE(materializer.materialize_tree(cache_dir_.string(), protected_dest.string()).success);
+    EXPECT_EQ(fs::status(cache_dir_ / "README.md").permissions() & fs::perms::owner_write, fs::perms::none);
+}
+
+TEST_F(MaterializerTest, ConcurrentMaterializationsUseSeparateStaging) {
+    fs::path dest = test_dir_ / "project" / "packages" / "fmt";
+    std::vector<std::thread> threads;
+    std::atomic<int> succeeded{0};
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            FileMaterializer materializer(MaterializePolicy::COPY);
+            if (materializer.materialize_tree(cache_dir_.string(), dest.string()).success) {
+                succeeded++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(succeeded.load(), 8);
+    expect_tree_matches(dest);
+    // 不留下临时目录
+    EXPECT_EQ(std::distance(fs::directory_iterator(dest.parent_path()), fs::directory_iterator()), 1);
+}
+
+TEST_F(MaterializerTest, CopyTreeProducesIndependentFiles) {
+    fs::path dest = test_dir_ / "project" / "packages" / "fmt";
+    fs::create_directories(dest);
+    write(dest / "stale.h", "old");
+
+    FileMaterializer materializer(MaterializePolicy::COPY);
+    MaterializeResult result = materializer.materialize_tree(cache_dir_.string(), dest.string());
+
+    ASSERT_TRUE(result.success);
+    expect_tree_matches(dest);
+    EXPECT_FALSE(fs::exists(dest / "stale.h"));
+    EXPECT_EQ(result.hardlinked, 0u);
+    EXPECT_EQ(result.reflinked + result.kernel_copied + result.user_copied, 3u);
+    EXPECT_NE(inode_of(dest / "README.md"), inode_of(cache_dir_ / "README.md"));
+}
+
+TEST_F(MaterializerTest, FileHookSeesEveryFileAndCanAbort) {
+    fs::path dest = test_dir_ / "project" / "packages" / "fmt";
+    fs::create_directories(dest);
+    write(dest / "stale.h", "old");
+
+    size_t files = 0;
+    size_t bytes = 0;
+    FileMaterializer materializer(MaterializePolicy::COPY);
+    materializer.set_file_hook([&](size_t size) {
+        files++;
+        bytes += size;
+        return true;
+    });
+    ASSERT_TRUE(materializer.materialize_tree(cache_dir_.string(), dest.string()).success);
+    EXPECT_EQ(files, 3u);
+    EXPECT_EQ(bytes, 100000u + 13u + 3u);
+
+    // 中止时保留原有内容，不留下临时目录
+    write(dest / "stale.h", "old");
+    materializer.set_file_hook([](size_t) { return false; });
+    EXPECT_FALSE(materializer.materialize_tree(cache_dir_.string(), (dest.parent_path() / "other").string()).success);
+    EXPECT_FALSE(fs::exists(dest.parent_path() / "other"));
+    EXPECT_EQ(std::distance(fs::directory_iterator(dest.parent_path()), fs::directory_iterator()), 1);
+    EXPECT_EQ(read_back(dest / "stale.h"), "old");
+}
+
+TEST_F(MaterializerTest, AutoAvoidsCopyingOnSameFilesystem) {
+    fs::path dest = test_dir_ / "project" / "packages" / "fmt";
+    FileMaterializer materializer(MaterializePolicy::AUTO);
+    MaterializeResult result = materializer.materialize_tree(cache_dir_.string(), dest.string());
+
+    ASSERT_TRUE(result.success);
+    expect_tree_matches(dest);
+    EXPECT_EQ(result.reflinked + result.hardlinked, 3u);
+    EXPECT_EQ(result.bytes_copied, 0u);
+}
+
+TEST_F(MaterializerTest, CopyFileDoesNotWriteThroughHardlink) {
+    fs::path dest = test_dir_ / "linked.h";
+    fs::create_hard_link(cache_dir_ / "README.md", dest);
+    write(test_dir_ / "new.h", "replacement");
+
+    ASSERT_TRUE(FileMaterializer::copy_file((test_dir_ / "new.h").string(), dest.string()));
+    EXPECT_EQ(read_back(dest), "replacement");
+    EXPECT_EQ(read_back(cache_dir_ / "README.md"), "fmt");
+
+    // 源与目标是同一个文件时拒绝，避免截断
+    EXPECT_FALSE(FileMaterializer::copy_file(dest.string(), dest.string()));
+    EXPECT_EQ(read_back(dest), "replacement");
+    EXPECT_FALSE(FileMaterializer::copy_file((test_dir_ / "missing.h").string(), dest.string()));
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/prefetch_model.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+PrefetchEvent make_event(const std::string& session, const std::string& package, uint64_t bytes = 1000) {
+    static int64_t clock = 0;
+    PrefetchEvent event;
+    event.timestamp_ms = ++clock;
+    event.session = session;
+    event.package = package;
+    event.bytes = bytes;
+    return event;
+}
+
+// CI 式负载：两类作业交替，每类作业按固定顺序安装一组依赖，偶尔夹带一个随机包
+std::vector<PrefetchEvent> ci_workload(int jobs) {
+    const std::vector<std::vector<std::string>> kinds = {
+        {"fmt", "spdlog", "gtest", "benchmark"},
+        {"zlib", "openssl", "curl", "nlohmann_json"},
+    };
+    std::vector<PrefetchEvent> events;
+    for (int job = 0; job < jobs; ++job) {
+        std::string session = "job-" + std::to_string(job);
+        for (const auto& package : kinds[job % 2]) {
+            events.push_back(make_event(session, package));
+        }
+        if (job % 5 == 0) {
+            events.push_back(make_event(session, "noise-" + std::to_string(job), 5000));
+        }
+    }
+    return events;
+}
+
+} // namespace
+
+class PrefetchModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = (fs::temp_directory_path() / "paker_prefetch_model_test").string();
+        fs::remove_all(dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir_);
+    }
+
+    std::string dir_;
+};
+
+TEST_F(PrefetchModelTest, RanksMarkovSuccessorsAndSessionAssociations) {
+    PrefetchModel model;
+    for (int i = 0; i < 4; ++i) {
+        std::string session = "s" + std::to_string(i);
+        model.observe(make_event(session, "fmt"));
+        model.observe(make_event(session, i == 3 ? "gtest" : "spdlog"));
+        model.observe(make_event(session, "catch2"));
+    }
+
+    PrefetchOptions options;
+    options.min_confidence = 0.0;
+    auto candidates = model.predict({"fmt"}, options);
+    std::map<std::string, PrefetchCandidate> by_name;
+    for (const auto& candidate : candidates) {
+        by_name[candidate.package] = candidate;
+    }
+    ASSERT_EQ(by_name.size(), 3u);
+    EXPECT_DOUBLE_EQ(by_name["spdlog"].markov, 0.75);
+    EXPECT_DOUBLE_EQ(by_name["gtest"].markov, 0.25);
+    EXPECT_DOUBLE_EQ(by_name["catch2"].markov, 0.0);
+    EXPECT_DOUBLE_EQ(by_name["catch2"].association, 1.0);
+    EXPECT_GT(by_name["spdlog"].confidence, by_name["gtest"].confidence);
+    EXPECT_EQ(by_name["spdlog"].expected_bytes, 1000u);
+
+    // 已请求的包不再预测；catch2 在已结束的三个会话中都与 spdlog 同时出现
+    candidates = model.predict({"fmt", "spdlog"}, options);
+    ASSERT_FALSE(candidates.empty());
+    EXPECT_EQ(candidates[0].package, "catch2");
+    EXPECT_DOUBLE_EQ(candidates[0].association, 1.0);
+    for (const auto& candidate : candidates) {
+        EXPECT_NE(candidate.package, "fmt");
+        EXPECT_NE(candidate.package, "spdlog");
+    }
+
+    // 没有上下文时从上一个请求跨会话转移
+    options.min_confidence = 0.5;
+    candidates = model.predict({}, options);
+    ASSERT_EQ(candidates.size(), 1u);
+    EXPECT_EQ(candidates[0].package, "fmt");
+}
+
+TEST_F(PrefetchModelTest, TraceIsReadIncrementallyAndModelRoundTrips) {
+    PrefetchTrace trace(dir_);
+    auto events = ci_workload(20);
+    for (size_t i = 0; i < events.size() / 2; ++i) {
+        ASSERT_TRUE(trace.append(events[i]));
+    }
+
+    PrefetchModel model;
+    size_t first = model.update_from_trace(trace);
+    EXPECT_EQ(first, events.size() / 2);
+    for (size_t i = events.size() / 2; i < events.size(); ++i) {
+        ASSERT_TRUE(trace.append(events[i]));
+    }
+    // 不完整的末行留到下次
+    std::ofstream(trace.trace_path(), std::ios::app) << "123\tjob-x\tfm";
+    EXPECT_EQ(model.update_from_trace(trace), events.size() - first);
+    EXPECT_EQ(model.update_from_trace(trace), 0u);
+
+    ASSERT_TRUE(model.save(trace.model_path()));
+    EXPECT_LT(fs::file_size(trace.model_path()), 1024u);
+
+    PrefetchModel loaded;
+    ASSERT_TRUE(loaded.load(trace.model_path()));
+    EXPECT_EQ(loaded.trained_offset(), model.trained_offset());
+    EXPECT_EQ(loaded.package_count(), model.package_count());
+
+    PrefetchOptions options;
+    for (const std::vector<std::string>& context :
+         {std::vector<std::string>{}, {"fmt"}, {"zlib", "openssl"}}) {
+        auto expected = model.predict(context, options);
+        auto actual = loaded.predict(context, options);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            EXPECT_EQ(actual[i].package, expected[i].package);
+            EXPECT_DOUBLE_EQ(actual[i].confidence, expected[i].confidence);
+        }
+    }
+
+    std::ofstream(dir_ + "/broken.bin") << "PKPF\x01";
+    EXPECT_FALSE(loaded.load(dir_ + "/broken.bin"));
+    EXPECT_EQ(loaded.package_count(), model.package_count());
+}
+
+TEST_F(PrefetchModelTest, TraceRotatesAndKeepsLatestSegments) {
+    // 旧版本留下的 trace.log 作为第 0 段读取
+    fs::create_directories(dir_);
+    std::ofstream(dir_ + "/trace.log") << "1\told\tlegacy\t10\n";
+
+    PrefetchTrace trace(dir_, 256, 3);
+    PrefetchModel model;
+    EXPECT_EQ(model.update_from_trace(trace), 1u);
+
+    auto events = ci_workload(40);
+    for (size_t i = 0; i < events.size() / 2; ++i) {
+        ASSERT_TRUE(trace.append(events[i]));
+    }
+    // 写入量超过保留上限，只能学到仍保留的部分
+    size_t first = model.update_from_trace(trace);
+    EXPECT_GT(first, 0u);
+    EXPECT_LT(first, events.size() / 2);
+    for (size_t i = events.size() / 2; i < events.size(); ++i) {
+        ASSERT_TRUE(trace.append(events[i]));
+    }
+
+    // 只保留最新的 3 段，每段不超过上限
+    auto segments = trace.list_segments();
+    ASSERT_EQ(segments.size(), 3u);
+    EXPECT_FALSE(fs::exists(dir_ + "/trace.log"));
+    EXPECT_EQ(trace.trace_path(), trace.segment_path(segments.back()));
+    for (uint32_t segment : segments) {
+        EXPECT_LE(fs::file_size(trace.segment_path(segment)), 256u);
+    }
+
+    // 已读位置所在的段被删除后从现存最早的段继续，不会停住
+    size_t learned = model.update_from_trace(trace);
+    EXPECT_GT(learned, 0u);
+    EXPECT_LE(learned, events.size() - events.size() / 2);
+    EXPECT_EQ(model.update_from_trace(trace), 0u);
+
+    std::vector<PrefetchEvent> all;
+    trace.read(all);
+    EXPECT_EQ(all.back().package, events.back().package);
+}
+
+TEST_F(PrefetchModelTest, ReplayMeasuresPrecisionRecallAndWaste) {
+    auto events = ci_workload(40);
+    PrefetchOptions options;
+    options.min_confidence = 0.5;
+    PrefetchReplayResult result = PrefetchModel::replay(events, options);
+
+    EXPECT_EQ(result.sessions, 40u);
+    EXPECT_EQ(result.requests, events.size());
+    EXPECT_GT(result.recall(), 0.8);
+    EXPECT_GT(result.precision(), 0.8);
+    EXPECT_LE(result.useful, result.prefetched);
+    EXPECT_LE(result.wasted_bytes, result.prefetched_bytes);
+
+    // 阈值越高预取越少
+    options.min_confidence = 0.99;
+    PrefetchReplayResult strict = PrefetchModel::replay(events, options);
+    EXPECT_LE(strict.prefetched, result.prefetched);
+}
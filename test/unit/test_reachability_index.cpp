@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "Paker/dependency/reachability_index.h"
+#include "Paker/dependency/dependency_graph.h"
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace Paker;
+
+namespace {
+
+// 随机图：大部分边指向编号更大的节点，少量回边形成环
+std::shared_ptr<const CSRDependencyGraph> build_random_graph(size_t nodes, size_t edges, size_t back_edges) {
+    CSRGraphBuilder builder;
+    for (size_t i = 0; i < nodes; ++i) {
+        builder.add_node("pkg" + std::to_string(i));
+    }
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(nodes - 1));
+    for (size_t i = 0; i < edges; ++i) {
+        uint32_t a = pick(rng), b = pick(rng);
+        if (a == b) continue;
+        builder.add_edge(std::min(a, b), std::max(a, b));
+    }
+    for (size_t i = 0; i < back_edges; ++i) {
+        uint32_t a = pick(rng), b = pick(rng);
+        builder.add_edge(std::max(a, b), std::min(a, b));
+    }
+    return std::make_shared<const CSRDependencyGraph>(builder.build());
+}
+
+// 以 BFS 结果为基准校验索引
+void expect_matches_bfs(const ReachabilityIndex& index) {
+    const auto& graph = index.graph();
+    for (uint32_t node = 0; node < graph.node_count(); ++node) {
+        auto expected = graph.reachable_from(node);
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::remove(expected.begin(), expected.end(), node), expected.end());
+        EXPECT_EQ(index.transitive_dependencies(node), expected) << "node " << node;
+        EXPECT_EQ(index.count_transitive_dependencies(node), expected.size());
+
+        auto expected_dependents = graph.reachable_to(node);
+        expected_dependents.erase(std::remove(expected_dependents.begin(), expected_dependents.end(), node),
+                                  expected_dependents.end());
+        EXPECT_EQ(index.count_transitive_dependents(node), expected_dependents.size());
+
+        for (uint32_t other = 0; other < graph.node_count(); other += 7) {
+            bool reachable = std::binary_search(expected.begin(), expected.end(), other);
+            if (other == node) continue;
+            EXPECT_EQ(index.reaches(node, other), reachable) << node << " -> " << other;
+        }
+    }
+}
+
+} // namespace
+
+TEST(ReachabilityIndexTest, BitsetModeMatchesBfs) {
+    auto graph = build_random_graph(300, 900, 10);
+    ReachabilityIndex index(graph);
+    EXPECT_EQ(index.mode(), ReachabilityIndex::Mode::BITSET);
+    expect_matches_bfs(index);
+}
+
+TEST(ReachabilityIndexTest, IntervalModeMatchesBfs) {
+    auto graph = build_random_graph(300, 900, 10);
+    ReachabilityIndex index(graph, 0);
+    EXPECT_EQ(index.mode(), ReachabilityIndex::Mode::INTERVAL);
+    expect_matches_bfs(index);
+}
+
+TEST(ReachabilityIndexTest, CommonDependencies) {
+    CSRGraphBuilder builder;
+    builder.add_edge("app", "net");
+    builder.add_edge("app", "json");
+    builder.add_edge("net", "ssl");
+    builder.add_edge("net", "core");
+    builder.add_edge("json", "core");
+    builder.add_edge("core", "alloc");
+    auto graph = std::make_shared<const CSRDependencyGraph>(builder.build());
+
+    for (size_t limit : {ReachabilityIndex::DEFAULT_MAX_BITSET_COMPONENTS, size_t(0)}) {
+        ReachabilityIndex index(graph, limit);
+        auto common = graph->to_names(index.common_dependencies(graph->find("net"), graph->find("json")));
+        std::sort(common.begin(), common.end());
+        EXPECT_EQ(common, (std::vector<std::string>{"alloc", "core"}));
+        EXPECT_TRUE(index.reaches("app", "alloc"));
+        EXPECT_FALSE(index.reaches("ssl", "core"));
+    }
+}
+
+TEST(ReachabilityIndexTest, DependencyGraphRebuildsLazily) {
+    DependencyGraph graph;
+    for (const auto* name : {"app", "net", "core"}) {
+        graph.add_node(DependencyNode(name));
+    }
+    graph.add_dependency("app", "net");
+
+    auto first = graph.reachability_index();
+    EXPECT_EQ(graph.reachability_index(), first);
+    EXPECT_FALSE(graph.depends_on("app", "core"));
+
+    graph.add_dependency("net", "core");
+    EXPECT_NE(graph.reachability_index(), first);
+    EXPECT_TRUE(graph.depends_on("app", "core"));
+    EXPECT_EQ(graph.get_transitive_dependents("core"), (std::vector<std::string>{"app", "net"}));
+    EXPECT_EQ(graph.get_transitive_dependencies("app"), (std::vector<std::string>{"core", "net"}));
+}
+
+TEST(ReachabilityIndexTest, ConcurrentQueriesShareOneIndex) {
+    DependencyGraph graph;
+    for (const auto* name : {"app", "net", "core"}) {
+        graph.add_node(DependencyNode(name));
+    }
+    graph.add_dependency("app", "net");
+    graph.add_dependency("net", "core");
+
+    std::atomic<int> reachable{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; ++i) {
+        readers.emplace_back([&] { reachable += graph.depends_on("app", "core") ? 1 : 0; });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(reachable, 8);
+    EXPECT_EQ(graph.reachability_index(), graph.reachability_index());
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/cache_monitor.h"
+#include "Paker/cache/remote_cache.h"
+#include "Paker/cache/remote_cache_server.h"
+#include "Paker/simd/simd_hash.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+} // namespace
+
+class RemoteCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_remote_cache_test";
+        fs::remove_all(test_dir_);
+        source_ = test_dir_ / "source" / "fmt" / "10.2.1";
+        fs::create_directories(source_ / "include" / "fmt");
+        std::ofstream(source_ / "include" / "fmt" / "core.h") << "#pragma once\nnamespace fmt { int answer(); }\n";
+        std::ofstream(source_ / "CMakeLists.txt") << "project(fmt)\n";
+        std::string large;
+        for (int i = 0; i < 20000; ++i) {
+            large += "inline int value_" + std::to_string(i) + "() { return " + std::to_string(i) + "; }\n";
+        }
+        std::ofstream(source_ / "include" / "fmt" / "format.h") << large;
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    // 另一台机器上的缓存：独立的暂存目录
+    std::unique_ptr<RemoteCache> machine(const std::string& name, const std::string& location) {
+        return std::make_unique<RemoteCache>(create_remote_cache_backend(location),
+                                             (test_dir_ / name / "staging").string());
+    }
+
+    void expect_same_tree(const fs::path& actual) {
+        for (const char* file : {"CMakeLists.txt", "include/fmt/core.h", "include/fmt/format.h"}) {
+            EXPECT_EQ(read_file(actual / file), read_file(source_ / file)) << file;
+        }
+    }
+
+    fs::path test_dir_;
+    fs::path source_;
+};
+
+TEST_F(RemoteCacheTest, SharedDirectoryReadThroughAndWriteBack) {
+    std::string shared = (test_dir_ / "nfs").string();
+    auto builder = machine("builder", shared);
+    ASSERT_TRUE(builder->publish("fmt", "10.2.1", source_.string()));
+    EXPECT_TRUE(fs::exists(test_dir_ / "nfs" / "refs" / "fmt" / "10.2.1"));
+
+    // 对象按标准 SHA-256 命名
+    size_t objects = 0;
+    for (const auto& item : fs::recursive_directory_iterator(test_dir_ / "nfs" / "objects")) {
+        if (item.is_regular_file()) {
+            SIMDHashCalculator::IncrementalSHA256 hasher;
+            hasher.update(read_file(item.path()));
+            EXPECT_EQ(item.path().filename().string(), hasher.finalize());
+            objects++;
+        }
+    }
+    EXPECT_EQ(objects, 1u);
+
+    // 内容相同的版本只写引用
+    ASSERT_TRUE(builder->publish("fmt", "10.2.1-rc", source_.string()));
+    EXPECT_EQ(builder->get_stats().already_present, 1u);
+
+    auto runner = machine("runner", "file://" + shared);
+    fs::path dest = test_dir_ / "runner" / "cache" / "fmt" / "10.2.1";
+    ASSERT_TRUE(runner->fetch("fmt", "10.2.1", dest.string()));
+    expect_same_tree(dest);
+    EXPECT_FALSE(runner->fetch("fmt", "9.0.0", (test_dir_ / "runner" / "cache" / "fmt" / "9.0.0").string()));
+    EXPECT_FALSE(runner->fetch("..", "10.2.1", (test_dir_ / "runner" / "escape").string()));
+
+    RemoteCacheStats stats = runner->get_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_GT(stats.bytes_downloaded, 0u);
+    EXPECT_TRUE(fs::is_empty(test_dir_ / "runner" / "staging"));
+}
+
+TEST_F(RemoteCacheTest, CorruptedObjectFailsIntegrityCheck) {
+    std::string shared = (test_dir_ / "nfs").string();
+    ASSERT_TRUE(machine("builder", shared)->publish("fmt", "10.2.1", source_.string()));
+
+    for (const auto& item : fs::recursive_directory_iterator(test_dir_ / "nfs" / "objects")) {
+        if (item.is_regular_file()) {
+            std::fstream object(item.path(), std::ios::in | std::ios::out | std::ios::binary);
+            object.seekp(100);
+            object.write("corrupted", 9);
+        }
+    }
+
+    auto runner = machine("runner", shared);
+    fs::path dest = test_dir_ / "runner" / "cache" / "fmt" / "10.2.1";
+    EXPECT_FALSE(runner->fetch("fmt", "10.2.1", dest.string()));
+    EXPECT_FALSE(fs::exists(dest));
+    EXPECT_EQ(runner->get_stats().integrity_failures, 1u);
+}
+
+TEST_F(RemoteCacheTest, HttpBackendAgainstLocalServer) {
+    RemoteCacheServer server((test_dir_ / "server").string());
+    ASSERT_TRUE(server.bind());
+    std::thread serving([&server] { server.run(); });
+
+    {
+        auto builder = machine("builder", server.get_url());
+        builder->publish_async("fmt", "10.2.1", source_.string());
+        builder->flush();
+        RemoteCacheStats uploaded = builder->get_stats();
+        EXPECT_EQ(uploaded.uploads, 1u);
+        EXPECT_GT(uploaded.bytes_uploaded, 0u);
+        EXPECT_TRUE(fs::exists(test_dir_ / "server" / "refs" / "fmt" / "10.2.1"));
+
+        auto runner = machine("runner", server.get_url() + "/");
+        fs::path dest = test_dir_ / "runner" / "cache" / "fmt" / "10.2.1";
+        ASSERT_TRUE(runner->fetch("fmt", "10.2.1", dest.string()));
+        expect_same_tree(dest);
+        EXPECT_FALSE(runner->fetch("spdlog", "1.0.0", (test_dir_ / "runner" / "spdlog").string()));
+        EXPECT_EQ(runner->get_stats().misses, 1u);
+    }
+
+    server.request_stop();
+    serving.join();
+    EXPECT_GE(server.get_requests_served(), 5u);
+}
+
+TEST_F(RemoteCacheTest, MonitorReportsPerTierHitRates) {
+    CacheMonitor monitor;
+    monitor.record_tier_miss("local", "fmt");
+    monitor.record_tier_hit("remote", "fmt", 4096);
+    monitor.record_tier_hit("local", "spdlog");
+    monitor.record_tier_miss("local", "zlib");
+    monitor.record_tier_miss("remote", "zlib");
+
+    auto tiers = monitor.get_tier_stats();
+    ASSERT_EQ(tiers.size(), 2u);
+    EXPECT_NEAR(tiers["local"].hit_rate(), 1.0 / 3.0, 1e-9);
+    EXPECT_DOUBLE_EQ(tiers["remote"].hit_rate(), 0.5);
+    EXPECT_EQ(tiers["remote"].bytes_served, 4096u);
+    EXPECT_NE(monitor.generate_performance_report().find("remote"), std::string::npos);
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "Paker/core/version_history.h"
 #include "Paker/core/output.h"
+#include "Paker/cache/generation_manager.h"
+#include "Paker/commands/rollback.h"
 #include <filesystem>
 #include <fstream>
 
@@ -36,7 +38,7 @@ TEST_F(RollbackTest, VersionHistoryManagerCreation) {
     // 测试版本历史管理器创建
     Paker::VersionHistoryManager manager(test_dir_.string());
     EXPECT_TRUE(fs::exists(test_dir_ / ".paker"));
-    EXPECT_TRUE(fs::exists(test_dir_ / ".paker" / "version_history.json"));
+    EXPECT_TRUE(fs::exists(test_dir_ / ".paker" / "history"));
 }
 
 TEST_F(RollbackTest, RecordVersionChange) {
@@ -176,6 +178,40 @@ TEST_F(RollbackTest, HistoryExportImport) {
     EXPECT_EQ(history.size(), 2);
 }
 
+TEST_F(RollbackTest, RollbackCommandSwitchesGeneration) {
+    // 未初始化全局缓存管理器时，目标版本仍在某一代中也应通过链接代切换回滚
+    fs::path cache = test_dir_ / "cache" / "fmt";
+    for (const std::string version : {"1.0.0", "2.0.0"}) {
+        fs::create_directories(cache / version);
+        std::ofstream(cache / version / "version.h") << version;
+    }
+    fs::path original_cwd = fs::current_path();
+    fs::current_path(test_dir_);
+    Paker::cleanup_history_manager();
+
+    Paker::GenerationManager generations(test_dir_.string());
+    uint64_t installed = generations.create_generation({{"fmt", {"1.0.0", (cache / "1.0.0").string()}}}, {}, "install");
+    ASSERT_TRUE(generations.switch_to(installed).success);
+    uint64_t upgraded = generations.create_generation({{"fmt", {"2.0.0", (cache / "2.0.0").string()}}}, {}, "upgrade");
+    ASSERT_TRUE(generations.switch_to(upgraded).success);
+    auto* history = Paker::get_history_manager();
+    history->record_version_change("fmt", "", "1.0.0", "https://github.com/fmtlib/fmt.git");
+    history->record_version_change("fmt", "1.0.0", "2.0.0", "https://github.com/fmtlib/fmt.git");
+
+    Paker::pm_rollback_to_version("fmt", "1.0.0", true);
+
+    std::string linked;
+    std::ifstream(test_dir_ / ".paker" / "links" / "fmt" / "version.h") >> linked;
+    EXPECT_EQ(linked, "1.0.0");
+    EXPECT_GT(generations.current(), upgraded);
+    auto fmt_history = history->get_package_history("fmt");
+    ASSERT_FALSE(fmt_history.empty());
+    EXPECT_TRUE(fmt_history.back().is_rollback);
+
+    Paker::cleanup_history_manager();
+    fs::current_path(original_cwd);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/seekable_archive.h"
+#include <sys/stat.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class SeekableArchiveTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_seekable_archive_test";
+        fs::remove_all(test_dir_);
+        source_ = test_dir_ / "fmt" / "source";
+        fs::create_directories(source_ / "include" / "fmt");
+        fs::create_directories(source_ / "empty_dir");
+
+        // 200 个相似的小头文件，加一个跨多帧的大文件和一个空文件
+        for (int i = 0; i < 200; ++i) {
+            std::string content = "#pragma once\nnamespace fmt {\ninline int value_" + std::to_string(i) +
+                                  "() { return " + std::to_string(i * 7) + "; }\n}  // namespace fmt\n";
+            write("include/fmt/header_" + std::to_string(i) + ".h", content);
+        }
+        std::string large;
+        for (int i = 0; i < 200000; ++i) {
+            large += std::to_string(i * 2654435761u % 1000003) + ",";
+        }
+        write("src/large_table.inc", large);
+        write("include/fmt/empty.h", "");
+        fs::create_symlink("include/fmt/header_1.h", source_ / "alias.h");
+        fs::permissions(source_ / "src" / "large_table.inc", fs::perms::owner_exec, fs::perm_options::add);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    void write(const std::string& relative, const std::string& content) {
+        fs::path path = source_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+        contents_[relative] = content;
+    }
+
+    static std::string read_back(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    ArchiveWriteOptions small_frames() const {
+        ArchiveWriteOptions options;
+        options.frame_size = 16 * 1024;
+        options.threads = 4;
+        return options;
+    }
+
+    fs::path test_dir_;
+    fs::path source_;
+    std::map<std::string, std::string> contents_;
+};
+
+TEST_F(SeekableArchiveTest, ReadsSingleFileWithoutInflatingArchive) {
+    std::string archive = (test_dir_ / "fmt" / "1.0.0.pkar").string();
+    ArchiveWriteStats stats;
+    ASSERT_TRUE(SeekableArchiveWriter::create(source_.string(), archive, small_frames(), &stats));
+    EXPECT_GT(stats.frames, 10u);
+    EXPECT_LT(stats.archive_bytes, stats.uncompressed_bytes);
+
+    SeekableArchiveReader reader;
+    ASSERT_TRUE(reader.open(archive));
+    EXPECT_EQ(reader.codec(), default_archive_codec());
+
+    std::string content;
+    ASSERT_TRUE(reader.read_file("include/fmt/header_42.h", content));
+    EXPECT_EQ(content, contents_["include/fmt/header_42.h"]);
+    EXPECT_EQ(reader.frames_decompressed(), 1u);
+
+    // 同一帧内的相邻文件复用已解压的帧
+    ASSERT_TRUE(reader.read_file("include/fmt/header_43.h", content));
+    EXPECT_EQ(content, contents_["include/fmt/header_43.h"]);
+    EXPECT_LE(reader.frames_decompressed(), 2u);
+
+    ASSERT_TRUE(reader.read_file("src/large_table.inc", content));
+    EXPECT_EQ(content, contents_["src/large_table.inc"]);
+    ASSERT_TRUE(reader.read_file("include/fmt/empty.h", content));
+    EXPECT_TRUE(content.empty());
+    EXPECT_FALSE(reader.read_file("include/fmt/missing.h", content));
+    EXPECT_FALSE(reader.read_file("alias.h", content));
+}
+
+TEST_F(SeekableArchiveTest, ParallelExtractionRestoresTree) {
+    std::string archive = (test_dir_ / "fmt" / "1.0.0.pkar").string();
+    ASSERT_TRUE(SeekableArchiveWriter::create(source_.string(), archive, small_frames()));
+
+    SeekableArchiveReader reader;
+    ASSERT_TRUE(reader.open(archive));
+    fs::path dest = test_dir_ / "extracted";
+    ASSERT_TRUE(reader.extract_all(dest.string(), 4));
+
+    for (const auto& [relative, content] : contents_) {
+        EXPECT_EQ(read_back(dest / relative), content) << relative;
+    }
+    EXPECT_TRUE(fs::is_directory(dest / "empty_dir"));
+    EXPECT_TRUE(fs::is_symlink(dest / "alias.h"));
+    EXPECT_EQ(fs::read_symlink(dest / "alias.h"), fs::path("include/fmt/header_1.h"));
+    EXPECT_NE(fs::status(dest / "src" / "large_table.inc").permissions() & fs::perms::owner_exec, fs::perms::none);
+}
+
+TEST_F(SeekableArchiveTest, DictionaryIsSharedAndVerified) {
+    if (default_archive_codec() != ArchiveCodec::ZSTD) {
+        GTEST_SKIP() << "built without zstd";
+    }
+    std::string dictionary = SeekableArchiveWriter::train_dictionary(source_.string(), 16 * 1024);
+    ASSERT_FALSE(dictionary.empty());
+    std::ofstream(test_dir_ / "fmt" / ".zdict", std::ios::binary) << dictionary;
+
+    ArchiveWriteOptions options = small_frames();
+    options.dictionary = dictionary;
+    std::string archive = (test_dir_ / "fmt" / "1.0.0.pkar").string();
+    ASSERT_TRUE(SeekableArchiveWriter::create(source_.string(), archive, options));
+
+    SeekableArchiveReader reader;
+    ASSERT_TRUE(reader.open(archive));
+    std::string content;
+    ASSERT_TRUE(reader.read_file("include/fmt/header_7.h", content));
+    EXPECT_EQ(content, contents_["include/fmt/header_7.h"]);
+
+    // 字典被替换后拒绝打开，而不是解出错误内容
+    std::ofstream(test_dir_ / "fmt" / ".zdict", std::ios::binary) << "not a dictionary";
+    SeekableArchiveReader mismatched;
+    EXPECT_FALSE(mismatched.open(archive));
+}
+
+TEST_F(SeekableArchiveTest, RejectsCorruptArchive) {
+    std::string archive = (test_dir_ / "fmt" / "1.0.0.pkar").string();
+    ASSERT_TRUE(SeekableArchiveWriter::create(source_.string(), archive, small_frames()));
+
+    fs::resize_file(archive, fs::file_size(archive) - 3);
+    SeekableArchiveReader truncated;
+    EXPECT_FALSE(truncated.open(archive));
+
+    std::ofstream(archive, std::ios::binary) << "PKAR";
+    SeekableArchiveReader tiny;
+    EXPECT_FALSE(tiny.open(archive));
+}
+
+TEST_F(SeekableArchiveTest, RejectsFramesNotMatchingFrameSize) {
+    std::string clean = (test_dir_ / "fmt" / "1.0.0.pkar").string();
+    ASSERT_TRUE(SeekableArchiveWriter::create(source_.string(), clean, small_frames()));
+    std::string original = read_back(clean);
+
+    // 尾部 40 字节：magic、version、codec、dict_id、frame_size、reserved、index_offset、index_size
+    uint64_t index_offset = 0;
+    std::memcpy(&index_offset, original.data() + original.size() - 16, sizeof(index_offset));
+    uint32_t frame_count = 0;
+    std::memcpy(&frame_count, original.data() + index_offset, sizeof(frame_count));
+    ASSERT_GT(frame_count, 2u);
+
+    // 帧表每项为 offset(8) + compressed_size(4) + size(4)
+    auto size_field = [&](uint32_t frame) { return static_cast<size_t>(index_offset + 4 + frame * 16 + 12); };
+    const uint32_t frame_size = static_cast<uint32_t>(small_frames().frame_size);
+    std::vector<std::pair<uint32_t, uint32_t>> crafted = {
+        {0, frame_size - 1},                // 非最后一帧短于 frame_size，后续偏移会落到错误的帧
+        {frame_count - 1, frame_size + 1},  // 最后一帧超出 frame_size
+        {frame_count - 1, 0},
+    };
+    for (const auto& [frame, size] : crafted) {
+        std::string bytes = original;
+        std::memcpy(&bytes[size_field(frame)], &size, sizeof(size));
+        std::string archive = (test_dir_ / "crafted.pkar").string();
+        std::ofstream(archive, std::ios::binary | std::ios::trunc) << bytes;
+
+        SeekableArchiveReader reader;
+        EXPECT_FALSE(reader.open(archive)) << "frame " << frame << " size " << size;
+        EXPECT_FALSE(reader.extract_all((test_dir_ / "dest").string()));
+    }
+
+    SeekableArchiveReader reader;
+    ASSERT_TRUE(reader.open(clean));
+    std::string data;
+    ASSERT_TRUE(reader.read_file("src/large_table.inc", data));
+    EXPECT_EQ(data, contents_["src/large_table.inc"]);
+}
+
+TEST_F(SeekableArchiveTest, RejectsEntriesEscapingDestination) {
+    // 构造归档：目录 aa 下有文件 x，另有指向目标目录之外的符号链接 ab
+    fs::path evil = test_dir_ / "evil";
+    fs::path outside = test_dir_ / "outside";
+    fs::create_directories(evil / "aa");
+    fs::create_directories(outside);
+    std::ofstream(evil / "aa" / "x", std::ios::binary) << "payload";
+    fs::create_symlink(outside, evil / "ab");
+    std::string clean = (test_dir_ / "clean.pkar").string();
+    ASSERT_TRUE(SeekableArchiveWriter::create(evil.string(), clean, small_frames()));
+
+    std::string original = read_back(clean);
+    size_t at = original.rfind("aa/x");
+    ASSERT_NE(at, std::string::npos);
+
+    // 改写索引中的条目路径，长度不变
+    for (const char* crafted : {"ab/x", "../x", "/a/x", "aa//"}) {
+        std::string bytes = original;
+        bytes.replace(at, 4, crafted);
+        std::string archive = (test_dir_ / "crafted.pkar").string();
+        std::ofstream(archive, std::ios::binary | std::ios::trunc) << bytes;
+
+        SeekableArchiveReader reader;
+        EXPECT_FALSE(reader.open(archive)) << crafted;
+        EXPECT_FALSE(reader.extract_all((test_dir_ / "dest").string())) << crafted;
+    }
+    EXPECT_FALSE(fs::exists(outside / "x"));
+    EXPECT_FALSE(fs::exists(test_dir_ / "x"));
+
+    SeekableArchiveReader reader;
+    ASSERT_TRUE(reader.open(clean));
+    ASSERT_TRUE(reader.extract_all((test_dir_ / "dest").string()));
+    EXPECT_EQ(read_back(test_dir_ / "dest" / "aa" / "x"), "payload");
+    EXPECT_TRUE(fs::is_symlink(test_dir_ / "dest" / "ab"));
+}
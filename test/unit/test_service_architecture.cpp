@@ -234,6 +234,112 @@ TEST_F(ServiceArchitectureTest, ServiceReinitialization) {
     EXPECT_NE(resolver1, resolver2);
 }
 
+// 测试延迟服务：按依赖顺序初始化，未使用的服务不创建
+namespace {
+std::vector<std::string> g_init_order;
+
+class LazyTestService : public IService {
+public:
+    explicit LazyTestService(std::string name) : name_(std::move(name)) {}
+    bool initialize() override { g_init_order.push_back(name_); return true; }
+    void shutdown() override {}
+    std::string get_name() const override { return name_; }
+private:
+    std::string name_;
+};
+
+class LazyBaseService : public LazyTestService {
+public:
+    LazyBaseService() : LazyTestService("base") {}
+};
+
+class LazyDependentService : public LazyTestService {
+public:
+    LazyDependentService() : LazyTestService("dependent") {}
+};
+
+class LazyUnusedService : public LazyTestService {
+public:
+    LazyUnusedService() : LazyTestService("unused") {}
+};
+} // namespace
+
+TEST_F(ServiceArchitectureTest, LazyServicesInitializeOnDemand) {
+    g_init_order.clear();
+    ServiceLocator::get_container()->clear();
+    ServiceManager manager;
+    manager.register_lazy_service<LazyDependentService>(
+        []() { return std::make_shared<LazyDependentService>(); },
+        {std::type_index(typeid(LazyBaseService))});
+    manager.register_lazy_service<LazyBaseService>(
+        []() { return std::make_shared<LazyBaseService>(); });
+    manager.register_lazy_service<LazyUnusedService>(
+        []() { return std::make_shared<LazyUnusedService>(); });
+    
+    EXPECT_EQ(manager.get_registered_count(), 3u);
+    EXPECT_TRUE(manager.get_service_names().empty());
+    EXPECT_TRUE(ServiceLocator::has<LazyUnusedService>());
+    
+    auto dependent = ServiceLocator::get<LazyDependentService>();
+    ASSERT_NE(dependent, nullptr);
+    EXPECT_EQ(g_init_order, (std::vector<std::string>{"base", "dependent"}));
+    EXPECT_EQ(ServiceLocator::get<LazyDependentService>(), dependent);
+    EXPECT_EQ(g_init_order.size(), 2u);
+    
+    auto profile = manager.get_init_profile();
+    ASSERT_EQ(profile.size(), 2u);
+    EXPECT_EQ(profile[0].name, "base");
+    EXPECT_TRUE(profile[1].success);
+    
+    manager.shutdown_all();
+    ServiceLocator::get_container()->clear();
+}
+
+TEST_F(ServiceArchitectureTest, ResetServiceRecreatesOnNextAccess) {
+    g_init_order.clear();
+    ServiceLocator::get_container()->clear();
+    ServiceManager manager;
+    manager.register_lazy_service<LazyBaseService>(
+        []() { return std::make_shared<LazyBaseService>(); });
+    
+    auto first = ServiceLocator::get<LazyBaseService>();
+    ASSERT_NE(first, nullptr);
+    manager.reset_service<LazyBaseService>();
+    EXPECT_TRUE(manager.get_service_names().empty());
+    
+    auto second = ServiceLocator::get<LazyBaseService>();
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(g_init_order, (std::vector<std::string>{"base", "base"}));
+    EXPECT_EQ(manager.get_service_names(), (std::vector<std::string>{"base"}));
+    
+    manager.shutdown_all();
+    ServiceLocator::get_container()->clear();
+}
+
+TEST_F(ServiceArchitectureTest, LazySingletonRetriesAfterFailedFactory) {
+    ServiceContainer container;
+    int attempts = 0;
+    container.register_lazy_singleton(std::type_index(typeid(int)), [&attempts]() -> std::shared_ptr<void> {
+        ++attempts;
+        if (attempts == 1) {
+            throw std::runtime_error("transient failure");
+        }
+        if (attempts == 2) {
+            return nullptr;
+        }
+        return std::make_shared<int>(7);
+    });
+    
+    EXPECT_THROW(container.get(std::type_index(typeid(int))), std::runtime_error);
+    EXPECT_EQ(container.get(std::type_index(typeid(int))), nullptr);
+    auto instance = container.get(std::type_index(typeid(int)));
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(*std::static_pointer_cast<int>(instance), 7);
+    EXPECT_EQ(container.get(std::type_index(typeid(int))), instance);
+    EXPECT_EQ(attempts, 3);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include "Paker/core/slab_allocator.h"
+#include "Paker/core/memory_pool.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Paker;
+
+TEST(SlabAllocatorTest, SizeClassesAndAlignment) {
+    EXPECT_EQ(SlabAllocator::size_class_of(1), 0u);
+    EXPECT_EQ(SlabAllocator::size_class_of(16), 0u);
+    EXPECT_EQ(SlabAllocator::size_class_of(17), 1u);
+    EXPECT_EQ(SlabAllocator::size_class_of(4096), 8u);
+    EXPECT_EQ(SlabAllocator::size_class_of(SlabAllocator::kMaxBlockSize), SlabAllocator::kSizeClassCount - 1);
+
+    auto& allocator = SlabAllocator::instance();
+    void* small = allocator.allocate(24);
+    EXPECT_EQ(allocator.usable_size(small), 32u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % alignof(std::max_align_t), 0u);
+
+    void* aligned = allocator.allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+
+    // 大块和超出小块对齐能力的请求
+    void* large = allocator.allocate(100 * 1024);
+    EXPECT_EQ(allocator.usable_size(large), 100u * 1024);
+    std::memset(large, 0xab, 100 * 1024);
+    void* over_aligned = allocator.allocate(32, 4096);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(over_aligned) % 4096, 0u);
+
+    allocator.deallocate(small);
+    allocator.deallocate(aligned);
+    allocator.deallocate(large);
+    allocator.deallocate(over_aligned);
+}
+
+TEST(SlabAllocatorTest, ReusesFreedBlocks) {
+    auto& allocator = SlabAllocator::instance();
+    std::vector<void*> blocks;
+    std::set<void*> unique;
+    for (int i = 0; i < 2000; ++i) {
+        void* ptr = allocator.allocate(48);
+        std::memset(ptr, i & 0xff, 48);
+        blocks.push_back(ptr);
+        unique.insert(ptr);
+    }
+    EXPECT_EQ(unique.size(), blocks.size());
+
+    // 当前 slab 中释放的块立即被同尺寸类的下一次分配复用
+    void* freed = blocks.back();
+    allocator.deallocate(freed);
+    EXPECT_EQ(allocator.allocate(40), freed);
+
+    for (void* ptr : blocks) {
+        allocator.deallocate(ptr);
+    }
+}
+
+TEST(SlabAllocatorTest, CrossThreadFreesReturnToOwner) {
+    auto& allocator = SlabAllocator::instance();
+    std::vector<void*> blocks;
+    for (int i = 0; i < 5000; ++i) {
+        blocks.push_back(allocator.allocate(128));
+    }
+    auto before = allocator.get_statistics();
+
+    std::thread([&]() {
+        for (void* ptr : blocks) {
+            allocator.deallocate(ptr);
+        }
+    }).join();
+
+    auto after_free = allocator.get_statistics();
+    EXPECT_GE(after_free.remote_free_count - before.remote_free_count, blocks.size());
+
+    // 远程释放的块被所属线程收回，不需要新的 slab
+    std::set<void*> previous(blocks.begin(), blocks.end());
+    size_t reused = 0;
+    std::vector<void*> again;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        void* ptr = allocator.allocate(128);
+        reused += previous.count(ptr);
+        again.push_back(ptr);
+    }
+    EXPECT_GT(reused, blocks.size() / 2);
+    EXPECT_LE(allocator.get_statistics().slabs_in_use, after_free.slabs_in_use);
+
+    for (void* ptr : again) {
+        allocator.deallocate(ptr);
+    }
+}
+
+TEST(SlabAllocatorTest, OrphanedSlabsAreAdopted) {
+    auto& allocator = SlabAllocator::instance();
+    std::vector<void*> blocks;
+    std::thread([&]() {
+        for (int i = 0; i < 100; ++i) {
+            blocks.push_back(allocator.allocate(2048));
+        }
+    }).join();
+
+    auto orphaned = allocator.get_statistics();
+    EXPECT_GE(orphaned.orphan_slabs, 1u);
+
+    // 线程已退出，释放全部走远程路径
+    for (void* ptr : blocks) {
+        allocator.deallocate(ptr);
+    }
+
+    std::set<void*> previous(blocks.begin(), blocks.end());
+    bool adopted = false;
+    std::thread([&]() {
+        void* ptr = allocator.allocate(2048);
+        adopted = previous.count(ptr) > 0;
+        allocator.deallocate(ptr);
+    }).join();
+    EXPECT_TRUE(adopted);
+    EXPECT_LT(allocator.get_statistics().orphan_slabs, orphaned.orphan_slabs);
+}
+
+TEST(SlabAllocatorTest, MemoryResourceAdapter) {
+    std::pmr::memory_resource* resource = get_slab_memory_resource();
+    SlabMemoryResource other;
+    EXPECT_TRUE(resource->is_equal(other));
+    EXPECT_FALSE(resource->is_equal(*std::pmr::new_delete_resource()));
+
+    std::pmr::vector<std::pmr::string> names(resource);
+    for (int i = 0; i < 1000; ++i) {
+        names.emplace_back("package-with-a-reasonably-long-name-" + std::to_string(i));
+    }
+    EXPECT_EQ(names[999], "package-with-a-reasonably-long-name-999");
+    EXPECT_EQ(names[0].get_allocator().resource(), resource);
+}
+
+TEST(SlabAllocatorTest, SmartMemoryPoolUsesSlabs) {
+    SmartMemoryPool pool;
+
+    void* ptr = pool.allocate(100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(pool.get_current_usage(), 128u);
+
+    std::memset(ptr, 0x5a, 100);
+    void* grown = pool.reallocate(ptr, 1000);
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(static_cast<unsigned char*>(grown)[99], 0x5a);
+    EXPECT_EQ(pool.get_current_usage(), 1024u);
+
+    pool.deallocate(grown);
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.current_usage, 0u);
+    EXPECT_EQ(stats.peak_usage, 1024u + 128u);
+    EXPECT_EQ(stats.allocation_count, 2u);
+    EXPECT_EQ(stats.free_count, 2u);
+}
+
+TEST(SlabAllocatorTest, OwnsOnlyItsOwnBlocks) {
+    auto& allocator = SlabAllocator::instance();
+    void* small = allocator.allocate(48);
+    void* large = allocator.allocate(SlabAllocator::kSlabSize * 2);
+    EXPECT_TRUE(allocator.owns(small));
+    EXPECT_TRUE(allocator.owns(large));
+
+    void* foreign = std::malloc(64);
+    int on_stack = 0;
+    EXPECT_FALSE(allocator.owns(foreign));
+    EXPECT_FALSE(allocator.owns(&on_stack));
+    EXPECT_FALSE(allocator.owns(nullptr));
+
+    allocator.deallocate(large);
+    allocator.deallocate(small);
+    std::free(foreign);
+}
+
+TEST(SlabAllocatorTest, SmartMemoryPoolIgnoresForeignPointers) {
+    SmartMemoryPool pool;
+    void* foreign = std::malloc(64);
+    std::memset(foreign, 0x11, 64);
+
+    // 不是池分配的指针只记录警告，不触碰其内存，也不计入统计
+    pool.deallocate(foreign);
+    EXPECT_EQ(pool.reallocate(foreign, 256), nullptr);
+    EXPECT_EQ(static_cast<unsigned char*>(foreign)[63], 0x11);
+    EXPECT_EQ(pool.get_statistics().free_count, 0u);
+    std::free(foreign);
+}
+
+TEST(SlabAllocatorTest, RejectsDoubleFreeAndInteriorPointers) {
+    auto& allocator = SlabAllocator::instance();
+    // 两个块在同一 slab：a 被重复释放时不能让 slab 误以为已全部空闲
+    char* a = static_cast<char*>(allocator.allocate(64));
+    char* b = static_cast<char*>(allocator.allocate(64));
+    std::memset(b, 0x5a, 64);
+
+    EXPECT_FALSE(allocator.deallocate(a + 8));
+    EXPECT_TRUE(allocator.deallocate(a));
+    EXPECT_FALSE(allocator.deallocate(a));
+    EXPECT_EQ(static_cast<unsigned char>(b[63]), 0x5a);
+
+    char* large = static_cast<char*>(allocator.allocate(SlabAllocator::kSlabSize));
+    EXPECT_FALSE(allocator.deallocate(large + 64));
+    EXPECT_TRUE(allocator.deallocate(large));
+    EXPECT_TRUE(allocator.deallocate(b));
+}
+
+TEST(SlabAllocatorTest, SmartMemoryPoolIgnoresDoubleFree) {
+    SmartMemoryPool pool;
+    void* ptr = pool.allocate(48);
+    void* other = pool.allocate(48);
+    pool.deallocate(ptr);
+    pool.deallocate(ptr);
+    pool.deallocate(static_cast<char*>(other) + 16);
+    EXPECT_EQ(pool.get_statistics().free_count, 1u);
+    pool.deallocate(other);
+    EXPECT_EQ(pool.get_statistics().free_count, 2u);
+}
+
+TEST(SlabAllocatorTest, GlobalManagerFallsBackToMallocBeforeInitialize) {
+    GlobalMemoryManager::shutdown_global_pools();
+    auto& allocator = SlabAllocator::instance();
+
+    // 未初始化时的块来自 malloc，不属于 slab
+    void* early = GlobalMemoryManager::global_allocate(128);
+    ASSERT_NE(early, nullptr);
+    EXPECT_FALSE(allocator.owns(early));
+    char* early_string = GlobalMemoryManager::allocate_string(16);
+    ASSERT_NE(early_string, nullptr);
+
+    ASSERT_TRUE(GlobalMemoryManager::initialize_global_pools());
+    void* pooled = GlobalMemoryManager::global_allocate(128);
+    ASSERT_NE(pooled, nullptr);
+    EXPECT_TRUE(allocator.owns(pooled));
+
+    // 初始化前的块在初始化后释放时交还 free，不进入内存池
+    size_t frees_before = GlobalMemoryManager::get_global_stats().free_count;
+    GlobalMemoryManager::global_deallocate(early);
+    GlobalMemoryManager::deallocate_string(early_string);
+    EXPECT_EQ(GlobalMemoryManager::get_global_stats().free_count, frees_before);
+
+    // 内存池关闭后，池里分配的块仍还给 slab
+    GlobalMemoryManager::shutdown_global_pools();
+    GlobalMemoryManager::global_deallocate(pooled);
+    EXPECT_FALSE(allocator.deallocate(pooled));
+}
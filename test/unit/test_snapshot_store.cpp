@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "Paker/core/snapshot_store.h"
+#include "Paker/cache/blob_store.h"
+#include <sys/stat.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+class SnapshotStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "paker_snapshot_store_test";
+        remove_tree(test_dir_);
+        package_ = test_dir_ / "packages" / "fmt";
+        root_ = (test_dir_ / ".paker" / "backups").string();
+        blobs_ = std::make_unique<BlobStore>((test_dir_ / "cache" / ".store").string());
+
+        for (int i = 0; i < 50; ++i) {
+            write("include/fmt/header_" + std::to_string(i) + ".h", "// header " + std::to_string(i) + "\n");
+        }
+        write("src/format.cc", std::string(8192, 'f'));
+        fs::create_directories(package_ / "doc");
+        fs::create_symlink("include/fmt/header_0.h", package_ / "fmt.h");
+    }
+
+    void TearDown() override {
+        remove_tree(test_dir_);
+    }
+
+    static void remove_tree(const fs::path& path) {
+        std::error_code ec;
+        for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+            if (!entry.is_symlink()) {
+                fs::permissions(entry.path(), fs::perms::owner_write, fs::perm_options::add, ec);
+            }
+        }
+        fs::remove_all(path, ec);
+    }
+
+    void write(const std::string& relative, const std::string& content) {
+        fs::path path = package_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    std::string read_back(const std::string& relative) const {
+        std::ifstream file(package_ / relative, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::string manifest(const std::string& name) const {
+        return root_ + "/fmt_" + name + ".snapshot";
+    }
+
+    fs::path test_dir_;
+    fs::path package_;
+    std::string root_;
+    std::unique_ptr<BlobStore> blobs_;
+};
+
+TEST_F(SnapshotStoreTest, OnlyChangedFilesAreHashedAndStored) {
+    SnapshotStore store(root_, blobs_.get());
+    SnapshotCaptureResult first = store.capture(package_.string(), manifest("1.0.0"));
+    ASSERT_TRUE(first.success);
+    EXPECT_EQ(first.files, 51u);
+    EXPECT_EQ(first.hashed, 51u);
+    EXPECT_EQ(first.new_objects, 51u);
+
+    write("include/fmt/header_3.h", "// header 3, patched\n");
+    write("include/fmt/new.h", "// new\n");
+    fs::remove(package_ / "include" / "fmt" / "header_4.h");
+
+    SnapshotCaptureResult second = store.capture(package_.string(), manifest("1.1.0"));
+    ASSERT_TRUE(second.success);
+    EXPECT_EQ(second.files, 51u);
+    EXPECT_EQ(second.hashed, 2u);
+    EXPECT_EQ(second.new_objects, 2u);
+    EXPECT_TRUE(store.verify(manifest("1.1.0")));
+
+    std::vector<SnapshotEntry> before, after;
+    ASSERT_TRUE(SnapshotStore::load_manifest(manifest("1.0.0"), before));
+    ASSERT_TRUE(SnapshotStore::load_manifest(manifest("1.1.0"), after));
+    SnapshotDiff diff = SnapshotStore::diff(before, after);
+    EXPECT_EQ(diff.added, std::vector<std::string>{"include/fmt/new.h"});
+    EXPECT_EQ(diff.modified, std::vector<std::string>{"include/fmt/header_3.h"});
+    EXPECT_EQ(diff.removed, std::vector<std::string>{"include/fmt/header_4.h"});
+}
+
+TEST_F(SnapshotStoreTest, RestoreRewritesOnlyDifferences) {
+    SnapshotStore store(root_, blobs_.get());
+    ASSERT_TRUE(store.capture(package_.string(), manifest("1.0.0")).success);
+
+    write("include/fmt/header_3.h", "// header 3, patched\n");
+    write("include/fmt/extra.h", "// extra\n");
+    fs::remove(package_ / "src" / "format.cc");
+    fs::remove(package_ / "fmt.h");
+    fs::remove_all(package_ / "doc");
+
+    SnapshotRestoreResult restored = store.restore(manifest("1.0.0"), package_.string(), 4);
+    ASSERT_TRUE(restored.success);
+    EXPECT_EQ(restored.written, 3u);    // header_3.h、format.cc、fmt.h
+    EXPECT_EQ(restored.removed, 1u);    // extra.h
+    EXPECT_EQ(read_back("include/fmt/header_3.h"), "// header 3\n");
+    EXPECT_EQ(read_back("src/format.cc"), std::string(8192, 'f'));
+    EXPECT_FALSE(fs::exists(package_ / "include" / "fmt" / "extra.h"));
+    EXPECT_TRUE(fs::is_directory(package_ / "doc"));
+    EXPECT_EQ(fs::read_symlink(package_ / "fmt.h"), fs::path("include/fmt/header_0.h"));
+
+    // 恢复出的文件可写，且再次恢复时没有任何改动
+    struct stat st {};
+    ASSERT_EQ(::stat((package_ / "src" / "format.cc").c_str(), &st), 0);
+    EXPECT_NE(st.st_mode & S_IWUSR, 0u);
+    SnapshotRestoreResult again = store.restore(manifest("1.0.0"), package_.string());
+    ASSERT_TRUE(again.success);
+    EXPECT_EQ(again.written, 0u);
+    EXPECT_EQ(again.removed, 0u);
+}
+
+TEST_F(SnapshotStoreTest, RestoreReplacesSymlinkedPackageDirectory) {
+    SnapshotStore store(root_, blobs_.get());
+    ASSERT_TRUE(store.capture(package_.string(), manifest("1.0.0")).success);
+
+    // 包目录软链接到缓存时，恢复不能改写缓存中的文件
+    fs::path cached = test_dir_ / "cache" / "fmt" / "2.0.0";
+    fs::create_directories(cached);
+    std::ofstream(cached / "core.h") << "// 2.0.0\n";
+    remove_tree(package_);
+    fs::create_directory_symlink(cached, package_);
+
+    ASSERT_TRUE(store.restore(manifest("1.0.0"), package_.string()).success);
+    EXPECT_FALSE(fs::is_symlink(package_));
+    EXPECT_EQ(read_back("include/fmt/header_7.h"), "// header 7\n");
+    EXPECT_FALSE(fs::exists(package_ / "core.h"));
+    EXPECT_TRUE(fs::exists(cached / "core.h"));
+}
+
+TEST_F(SnapshotStoreTest, GarbageCollectionKeepsReferencedObjects) {
+    SnapshotStore store(root_, blobs_.get());
+    ASSERT_TRUE(store.capture(package_.string(), manifest("1.0.0")).success);
+    write("include/fmt/header_3.h", "// header 3, patched\n");
+    ASSERT_TRUE(store.capture(package_.string(), manifest("1.1.0")).success);
+
+    EXPECT_EQ(store.collect_garbage(), 0u);
+    fs::remove(manifest("1.0.0"));
+    EXPECT_EQ(store.collect_garbage(), std::string("// header 3\n").size());
+    EXPECT_TRUE(store.verify(manifest("1.1.0")));
+    EXPECT_FALSE(SnapshotStore::is_snapshot(root_ + "/state.json"));
+
+    // 对象存放在内容存储中，重新加载的存储做全量回收也不会删除快照引用的 blob 和正在写入的临时文件
+    EXPECT_FALSE(fs::exists(fs::path(root_) / "objects"));
+    fs::path in_progress = fs::path(store.object_path(std::string(64, 'e')) + ".tmp4242");
+    fs::create_directories(in_progress.parent_path());
+    std::ofstream(in_progress) << "partial";
+    BlobStore reloaded(blobs_->get_root());
+    EXPECT_EQ(reloaded.collect_garbage(true), 0u);
+    EXPECT_TRUE(fs::exists(in_progress));
+    EXPECT_TRUE(store.verify(manifest("1.1.0")));
+}
+
+TEST_F(SnapshotStoreTest, LastByteChangeIsDetected) {
+    // 内容哈希是真正的 SHA-256
+    write("abc.txt", "abc");
+    EXPECT_EQ(BlobStore::hash_file((package_ / "abc.txt").string()),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    // 只有最后一个字节不同的 1 KB 以上文件必须得到不同的哈希并能各自恢复
+    std::string original(2048, 'q');
+    write("data.bin", original);
+    SnapshotStore store(root_, blobs_.get());
+    ASSERT_TRUE(store.capture(package_.string(), manifest("1.0.0")).success);
+
+    std::string patched = original;
+    patched.back() = 'r';
+    write("data.bin", patched);
+    fs::last_write_time(package_ / "data.bin", fs::last_write_time(package_ / "data.bin") + std::chrono::seconds(5));
+    SnapshotCaptureResult second = store.capture(package_.string(), manifest("1.1.0"));
+    ASSERT_TRUE(second.success);
+    EXPECT_EQ(second.new_objects, 1u);
+
+    std::vector<SnapshotEntry> before, after;
+    ASSERT_TRUE(SnapshotStore::load_manifest(manifest("1.0.0"), before));
+    ASSERT_TRUE(SnapshotStore::load_manifest(manifest("1.1.0"), after));
+    EXPECT_EQ(SnapshotStore::diff(before, after).modified, std::vector<std::string>{"data.bin"});
+
+    ASSERT_TRUE(store.restore(manifest("1.0.0"), package_.string()).success);
+    EXPECT_EQ(read_back("data.bin"), original);
+    ASSERT_TRUE(store.restore(manifest("1.1.0"), package_.string()).success);
+    EXPECT_EQ(read_back("data.bin"), patched);
+}
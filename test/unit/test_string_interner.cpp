@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "Paker/core/string_interner.h"
+#include "Paker/cache/lru_cache_manager.h"
+#include "Paker/dependency/csr_dependency_graph.h"
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+TEST(StringInternerTest, SameContentSameSymbol) {
+    std::string name = "interner-test-package";
+    Symbol a(name);
+    Symbol b(std::string("interner-test-") + "package");
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(a.view().data(), b.view().data());
+    EXPECT_EQ(a, name);
+    EXPECT_EQ(std::string(a.c_str()), name);
+    EXPECT_NE(a, Symbol("interner-test-other"));
+
+    // 空字符串固定为 ID 0
+    EXPECT_TRUE(Symbol().empty());
+    EXPECT_EQ(Symbol(""), Symbol());
+    EXPECT_EQ(Symbol().view(), "");
+}
+
+TEST(StringInternerTest, FindDoesNotIntern) {
+    auto& interner = StringInterner::instance();
+    EXPECT_FALSE(interner.find("interner-test-never-interned").has_value());
+    size_t before = interner.get_statistics().symbol_count;
+    EXPECT_FALSE(interner.find("interner-test-never-interned").has_value());
+    EXPECT_EQ(interner.get_statistics().symbol_count, before);
+
+    Symbol symbol("interner-test-found");
+    auto found = interner.find("interner-test-found");
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(*found, symbol);
+}
+
+TEST(StringInternerTest, OrderingAndHashing) {
+    std::map<Symbol, int> ordered;
+    ordered[Symbol("interner-test-c")] = 3;
+    ordered[Symbol("interner-test-a")] = 1;
+    ordered[Symbol("interner-test-b")] = 2;
+    std::vector<std::string> keys;
+    for (const auto& [key, value] : ordered) {
+        keys.push_back(key.str());
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"interner-test-a", "interner-test-b", "interner-test-c"}));
+
+    std::unordered_map<Symbol, int> hashed;
+    hashed[Symbol("interner-test-a")] = 1;
+    EXPECT_EQ(hashed.count(Symbol("interner-test-a")), 1u);
+}
+
+TEST(StringInternerTest, ConcurrentInterningIsConsistent) {
+    const size_t thread_count = 8;
+    const size_t names = 5000;
+    std::vector<std::vector<Symbol::Id>> ids(thread_count, std::vector<Symbol::Id>(names));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            // 各线程从不同位置开始驻留同一批字符串
+            for (size_t i = 0; i < names; ++i) {
+                size_t index = (i + t * 617) % names;
+                ids[t][index] = Symbol("interner-concurrent-" + std::to_string(index)).id();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < names; ++i) {
+        for (size_t t = 1; t < thread_count; ++t) {
+            ASSERT_EQ(ids[t][i], ids[0][i]);
+        }
+        EXPECT_EQ(StringInterner::instance().view(ids[0][i]), "interner-concurrent-" + std::to_string(i));
+    }
+}
+
+TEST(StringInternerTest, CSRGraphKeepsNodeNamesLocal) {
+    Symbol existing("interner-graph-shared");
+    size_t before = StringInterner::instance().get_statistics().symbol_count;
+
+    CSRGraphBuilder builder;
+    builder.add_edge("interner-graph-app", "interner-graph-lib");
+    builder.add_edge("interner-graph-app", "interner-graph-lib");
+    builder.add_edge("interner-graph-app", "interner-graph-shared");
+    auto graph = builder.build();
+
+    EXPECT_EQ(graph.node_count(), 3u);
+    EXPECT_EQ(graph.edge_count(), 2u);
+    EXPECT_EQ(graph.name(graph.find("interner-graph-lib")), "interner-graph-lib");
+    EXPECT_EQ(graph.find("interner-graph-missing"), CSRDependencyGraph::INVALID_NODE);
+
+    // 构建图不会驻留节点名；已驻留的名字仍可查到对应符号
+    EXPECT_EQ(StringInterner::instance().get_statistics().symbol_count, before);
+    EXPECT_FALSE(StringInterner::instance().find("interner-graph-lib").has_value());
+    EXPECT_FALSE(graph.find_symbol(graph.find("interner-graph-lib")).has_value());
+    EXPECT_EQ(graph.find_symbol(graph.find("interner-graph-shared")), existing);
+    EXPECT_FALSE(graph.find_symbol(CSRDependencyGraph::INVALID_NODE).has_value());
+}
+
+TEST(StringInternerTest, LRUCacheUsesInternedKeys) {
+    fs::path dir = fs::temp_directory_path() / "paker_interner_lru_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "fmt-10.1.0");
+    {
+        LRUCacheManager cache(dir.string());
+        ASSERT_TRUE(cache.add_item("fmt", "10.1.0", (dir / "fmt-10.1.0").string()));
+        EXPECT_TRUE(cache.has_item("fmt", "10.1.0"));
+        EXPECT_FALSE(cache.has_item("fmt", "9.0.0"));
+        EXPECT_EQ(cache.get_item_path("fmt", "10.1.0"), (dir / "fmt-10.1.0").string());
+        EXPECT_EQ(cache.get_package_versions("fmt"), std::vector<std::string>{"10.1.0"});
+
+        // 只驻留包名和版本，组合键和未命中的查询都不进入驻留表
+        EXPECT_FALSE(StringInterner::instance().find("fmt:10.1.0").has_value());
+        EXPECT_FALSE(StringInterner::instance().find("fmt:9.0.0").has_value());
+
+        auto items = cache.get_oldest_items(1);
+        ASSERT_EQ(items.size(), 1u);
+        EXPECT_EQ(items[0].package_name, Symbol("fmt"));
+    }
+
+    // 索引在析构时保存，重新加载后键保持一致
+    LRUCacheManager reloaded(dir.string());
+    ASSERT_TRUE(reloaded.load_cache_index());
+    EXPECT_TRUE(reloaded.has_item("fmt", "10.1.0"));
+    EXPECT_FALSE(StringInterner::instance().find("fmt:10.1.0").has_value());
+    fs::remove_all(dir);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "Paker/cache/warmup_scheduler.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace Paker;
+namespace fs = std::filesystem;
+
+namespace {
+
+PackageWarmupInfo make_package(const std::string& name, WarmupPriority priority, double popularity = 0.0) {
+    PackageWarmupInfo info;
+    info.package_name = name;
+    info.version = "1.0.0";
+    info.priority = priority;
+    info.popularity_score = popularity;
+    info.estimated_size = 1024;
+    return info;
+}
+
+} // namespace
+
+class WarmupSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        foreground_dir_ = (fs::temp_directory_path() / "paker_warmup_scheduler_test").string();
+        fs::remove_all(foreground_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(foreground_dir_);
+    }
+
+    std::string foreground_dir_;
+};
+
+TEST_F(WarmupSchedulerTest, PopsByPriorityThenPopularity) {
+    WarmupScheduler scheduler(WarmupBudget(), foreground_dir_);
+    scheduler.schedule(make_package("boost", WarmupPriority::BACKGROUND));
+    scheduler.schedule(make_package("fmt", WarmupPriority::NORMAL, 1.0));
+    scheduler.schedule(make_package("spdlog", WarmupPriority::NORMAL, 5.0));
+    scheduler.schedule(make_package("glog", WarmupPriority::CRITICAL));
+    scheduler.schedule(make_package("zlib", WarmupPriority::NORMAL, 5.0));
+
+    std::vector<std::string> order;
+    WarmupTask task;
+    while (scheduler.next(task)) {
+        order.push_back(task.info.package_name);
+    }
+    EXPECT_EQ(order, (std::vector<std::string>{"glog", "spdlog", "zlib", "fmt", "boost"}));
+    EXPECT_EQ(scheduler.get_stats().started, 5u);
+}
+
+TEST_F(WarmupSchedulerTest, CancelledRescheduledAndExpiredTasksAreSkipped) {
+    WarmupScheduler scheduler(WarmupBudget(), foreground_dir_);
+    scheduler.schedule(make_package("fmt", WarmupPriority::HIGH));
+    scheduler.schedule(make_package("spdlog", WarmupPriority::HIGH));
+    scheduler.schedule(make_package("gtest", WarmupPriority::CRITICAL),
+                       std::chrono::steady_clock::now() - std::chrono::seconds(1));
+    // 以更低的优先级重新加入，堆中旧条目作废
+    scheduler.schedule(make_package("fmt", WarmupPriority::LOW));
+    EXPECT_TRUE(scheduler.cancel("spdlog@1.0.0"));
+    EXPECT_FALSE(scheduler.cancel("spdlog@1.0.0"));
+    EXPECT_EQ(scheduler.pending(), 2u);
+
+    WarmupTask task;
+    ASSERT_TRUE(scheduler.next(task));
+    EXPECT_EQ(task.info.package_name, "fmt");
+    EXPECT_EQ(task.info.priority, WarmupPriority::LOW);
+    EXPECT_FALSE(scheduler.next(task));
+
+    WarmupSchedulerStats stats = scheduler.get_stats();
+    EXPECT_EQ(stats.cancelled, 1u);
+    EXPECT_EQ(stats.expired, 1u);
+    EXPECT_EQ(stats.started, 1u);
+}
+
+TEST_F(WarmupSchedulerTest, TokenBucketLimitsThroughput) {
+    TokenBucket bucket(100 * 1024);   // 100KB/s，初始一秒的突发
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(5);
+    ASSERT_TRUE(bucket.acquire(100 * 1024, deadline));
+    EXPECT_FALSE(bucket.try_acquire(20 * 1024));
+    ASSERT_TRUE(bucket.acquire(20 * 1024, deadline));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+
+    // 期限内补不足令牌时立即放弃
+    auto quick = std::chrono::steady_clock::now();
+    EXPECT_FALSE(bucket.acquire(100 * 1024, quick + std::chrono::milliseconds(10)));
+    EXPECT_LT(std::chrono::steady_clock::now() - quick, std::chrono::milliseconds(100));
+
+    TokenBucket unlimited;
+    EXPECT_TRUE(unlimited.try_acquire(1ULL << 40));
+}
+
+TEST_F(WarmupSchedulerTest, BacksOffWhileForegroundInstallIsActive) {
+    WarmupBudget budget;
+    budget.backoff_initial = std::chrono::milliseconds(10);
+    budget.backoff_max = std::chrono::milliseconds(40);
+    WarmupScheduler scheduler(budget, foreground_dir_);
+    scheduler.schedule(make_package("fmt", WarmupPriority::HIGH));
+
+    auto foreground = std::make_unique<ForegroundActivity::Scope>("install fmt", foreground_dir_);
+    EXPECT_TRUE(ForegroundActivity::active(foreground_dir_));
+    std::thread release([&foreground] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        foreground.reset();
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    WarmupTask task;
+    ASSERT_TRUE(scheduler.next(task));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    release.join();
+    EXPECT_FALSE(ForegroundActivity::active(foreground_dir_));
+    EXPECT_EQ(scheduler.get_stats().backoffs, 1u);
+
+    // 已退出进程留下的标记不会阻止预热
+    fs::create_directories(foreground_dir_);
+    std::ofstream(foreground_dir_ + "/999999999.0") << "install\n";
+    EXPECT_FALSE(ForegroundActivity::active(foreground_dir_));
+    EXPECT_FALSE(fs::exists(foreground_dir_ + "/999999999.0"));
+}
+
+TEST_F(WarmupSchedulerTest, ChargesBudgetPerChunk) {
+    WarmupBudget budget;
+    budget.disk_write_bytes_per_second = 4 * WarmupScheduler::kChunkSize;
+    WarmupScheduler scheduler(budget, foreground_dir_);
+    scheduler.schedule(make_package("fmt", WarmupPriority::HIGH));
+
+    // 开始任务本身不扣预算
+    WarmupTask task;
+    ASSERT_TRUE(scheduler.next(task));
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(scheduler.charge(task, 4 * WarmupScheduler::kChunkSize, false));   // 初始突发
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    ASSERT_TRUE(scheduler.charge(task, 2 * WarmupScheduler::kChunkSize, false));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+
+    // 只扣磁盘预算时不受带宽限制
+    budget.network_bytes_per_second = 1;
+    budget.disk_write_bytes_per_second = 0;
+    scheduler.set_budget(budget);
+    start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(scheduler.charge(task, 8 * WarmupScheduler::kChunkSize, false));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+TEST_F(WarmupSchedulerTest, BacksOffBetweenChunksWhileForegroundIsActive) {
+    WarmupBudget budget;
+    budget.backoff_initial = std::chrono::milliseconds(10);
+    budget.backoff_max = std::chrono::milliseconds(40);
+    WarmupScheduler scheduler(budget, foreground_dir_);
+    scheduler.schedule(make_package("fmt", WarmupPriority::HIGH));
+    WarmupTask task;
+    ASSERT_TRUE(scheduler.next(task));
+
+    // 任务开始后出现的前台安装会暂停后续分块
+    auto foreground = std::make_unique<ForegroundActivity::Scope>("install fmt", foreground_dir_);
+    std::thread release([&foreground] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        foreground.reset();
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(scheduler.charge(task, 3 * WarmupScheduler::kChunkSize, false));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    release.join();
+    EXPECT_EQ(scheduler.get_stats().backoffs, 1u);
+}
+
+TEST_F(WarmupSchedulerTest, StopWakesWaitingWorkers) {
+    WarmupBudget budget;
+    budget.disk_write_bytes_per_second = 1024;
+    WarmupScheduler scheduler(budget, foreground_dir_);
+    scheduler.schedule(make_package("fmt", WarmupPriority::HIGH));
+
+    WarmupTask task;
+    ASSERT_TRUE(scheduler.next(task));
+    ASSERT_TRUE(scheduler.charge(task, 1024, false));   // 消耗掉初始突发
+    std::thread stopper([&scheduler] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        scheduler.stop();
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(scheduler.charge(task, 64 * 1024 * 1024, false));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    stopper.join();
+}